@@ -18,14 +18,64 @@
 #ifndef ROS_PUBQUEUE_H
 #define ROS_PUBQUEUE_H
 
+#include <boost/atomic.hpp>
 #include <boost/thread.hpp>
 #include <boost/bind.hpp>
+#include <boost/scoped_array.hpp>
+#include <algorithm>
 #include <deque>
 #include <list>
+#include <utility>
 #include <vector>
 
 #include <ros/ros.h>
 
+#include <gazebo_ros/backlog_registry.h>
+#include <gazebo_ros/latency_tracer.h>
+#include <gazebo_ros/thread_policy.h>
+
+#include <gazebo_plugins/pub_service_pool.h>
+
+/// \brief Suggested number of preallocated slots of a ring backed PubQueue,
+/// see PubMultiQueue::PubMultiQueue().
+#define PUBQUEUE_DEFAULT_CAPACITY 32
+
+/// \brief What a bounded PubQueue does when push() finds every slot in use.
+enum PubQueueOverflowPolicy
+{
+  /// \brief Discard the oldest unpublished message to make room.
+  PUBQUEUE_DROP_OLDEST,
+  /// \brief Discard the message being pushed.
+  PUBQUEUE_DROP_NEWEST
+};
+
+/// \brief Let go of what a consumed PubRingBuffer slot still holds.  Plain
+/// messages keep their storage for the next push; shared pointers, e.g. to
+/// MessagePool messages, are released so the message can be recycled.
+template<class T>
+inline void releaseSlotMessage(T&) {}
+template<class M>
+inline void releaseSlotMessage(boost::shared_ptr<M>& _msg)
+{
+  _msg.reset();
+}
+
+/// \brief Header stamp of a queued message for the LatencyTracer.
+/// \return false if the message has no header
+template<class T>
+inline bool latencyStamp(const T& _msg, ros::Time& _stamp)
+{
+  const ros::Time *stamp = ros::message_traits::TimeStamp<T>::pointer(_msg);
+  if (!stamp)
+    return false;
+  _stamp = *stamp;
+  return true;
+}
+template<class M>
+inline bool latencyStamp(const boost::shared_ptr<M>& _msg, ros::Time& _stamp)
+{
+  return _msg && latencyStamp(*_msg, _stamp);
+}
 
 /// \brief Container for a (ROS publisher, outgoing message) pair.
 /// We'll have queues of these.  Templated on a ROS message type.
@@ -41,15 +91,207 @@ class PubMessagePair
       msg_(msg), pub_(pub) {}
 };
 
+/// \brief Bounded single-producer ring of preallocated (message, publisher)
+/// slots.  The producer never blocks on or locks against the consumer: each
+/// slot carries a sequence number telling whose turn it is (Vyukov style),
+/// so the message storage of a slot is reused scan after scan instead of
+/// being reallocated on every push.
+template<class T>
+class PubRingBuffer
+{
+  private:
+    struct Slot
+    {
+      boost::atomic<size_t> seq_;
+      T msg_;
+      ros::Publisher pub_;
+    };
+
+    /// \brief Preallocated slots, at least two so that a filled and a free
+    /// slot never share a sequence number.
+    boost::scoped_array<Slot> slots_;
+    size_t slot_count_;
+    /// \brief Maximum number of unpublished messages.
+    size_t capacity_;
+    PubQueueOverflowPolicy policy_;
+
+    /// \brief Next sequence number to consume, shared by consumer and producer
+    /// (the producer claims from here when dropping the oldest message).
+    char pad0_[64];
+    boost::atomic<size_t> head_;
+    /// \brief Next sequence number to produce, only written by the producer.
+    char pad1_[64];
+    boost::atomic<size_t> tail_;
+    char pad2_[64];
+    boost::atomic<unsigned long> pushed_;
+    boost::atomic<unsigned long> dropped_;
+
+    /// \brief Claim the oldest filled slot, hand it to _f, then release it.
+    /// \return false if no slot was ready.
+    template <class F>
+    bool consumeOne(F &_f)
+    {
+      size_t h = this->head_.load(boost::memory_order_relaxed);
+      for (;;)
+      {
+        Slot &s = this->slots_[h % this->slot_count_];
+        size_t seq = s.seq_.load(boost::memory_order_acquire);
+        long diff = static_cast<long>(seq) - static_cast<long>(h + 1);
+        if (diff == 0)
+        {
+          if (this->head_.compare_exchange_weak(h, h + 1,
+                boost::memory_order_relaxed))
+          {
+            _f(s.msg_, s.pub_);
+            releaseSlotMessage(s.msg_);
+            s.seq_.store(h + this->slot_count_, boost::memory_order_release);
+            return true;
+          }
+        }
+        else if (diff < 0)
+        {
+          return false;
+        }
+        else
+        {
+          h = this->head_.load(boost::memory_order_relaxed);
+        }
+      }
+    }
+
+    static void discard(T&, ros::Publisher&) {}
+
+    /// \brief Wait for the tail slot to become writable.
+    /// \return Slot to fill, or NULL if the message has to be dropped.
+    Slot *acquireTail(size_t _t)
+    {
+      Slot &s = this->slots_[_t % this->slot_count_];
+      for (;;)
+      {
+        if (_t - this->head_.load(boost::memory_order_acquire) >= this->capacity_)
+        {
+          if (this->policy_ == PUBQUEUE_DROP_NEWEST)
+          {
+            ++this->dropped_;
+            return NULL;
+          }
+          void (*f)(T&, ros::Publisher&) = &PubRingBuffer<T>::discard;
+          if (this->consumeOne(f))
+            ++this->dropped_;
+          else
+            boost::this_thread::yield();
+        }
+        else if (s.seq_.load(boost::memory_order_acquire) == _t)
+        {
+          return &s;
+        }
+        else
+        {
+          // the consumer is still publishing out of this slot
+          boost::this_thread::yield();
+        }
+      }
+    }
+
+  public:
+    /// \param[in] _capacity Number of slots, at least 1
+    /// \param[in] _policy Behaviour of push() when every slot is in use
+    PubRingBuffer(size_t _capacity, PubQueueOverflowPolicy _policy) :
+      slot_count_(std::max<size_t>(_capacity, 2)),
+      capacity_(std::max<size_t>(_capacity, 1)), policy_(_policy),
+      head_(0), tail_(0), pushed_(0), dropped_(0)
+    {
+      this->slots_.reset(new Slot[this->slot_count_]);
+      for (size_t i = 0; i < this->slot_count_; ++i)
+        this->slots_[i].seq_.store(i, boost::memory_order_relaxed);
+    }
+
+    /// \brief Copy a message into the next slot, reusing the slot's storage.
+    /// Must only be called from one thread at a time.
+    /// \return false if the message was dropped
+    bool push(const T& _msg, const ros::Publisher& _pub)
+    {
+      ++this->pushed_;
+      size_t t = this->tail_.load(boost::memory_order_relaxed);
+      Slot *s = this->acquireTail(t);
+      if (!s)
+        return false;
+      s->msg_ = _msg;
+      s->pub_ = _pub;
+      this->tail_.store(t + 1, boost::memory_order_relaxed);
+      s->seq_.store(t + 1, boost::memory_order_release);
+      return true;
+    }
+
+    /// \brief Move a message into the next slot.
+    /// Must only be called from one thread at a time.
+    /// \return false if the message was dropped
+    bool push(T&& _msg, const ros::Publisher& _pub)
+    {
+      ++this->pushed_;
+      size_t t = this->tail_.load(boost::memory_order_relaxed);
+      Slot *s = this->acquireTail(t);
+      if (!s)
+        return false;
+      s->msg_ = std::move(_msg);
+      s->pub_ = _pub;
+      this->tail_.store(t + 1, boost::memory_order_relaxed);
+      s->seq_.store(t + 1, boost::memory_order_release);
+      return true;
+    }
+
+    /// \brief Hand every ready message, oldest first, to _f(msg, pub).
+    /// The message stays owned by its slot, _f must not keep a reference.
+    /// \return Number of messages consumed
+    template <class F>
+    size_t consume(F _f)
+    {
+      size_t n = 0;
+      while (this->consumeOne(_f))
+        ++n;
+      return n;
+    }
+
+    /// \brief Number of messages handed to push().
+    unsigned long pushed() const
+    {
+      return this->pushed_.load(boost::memory_order_relaxed);
+    }
+
+    /// \brief Number of messages discarded by the overflow policy, i.e.
+    /// overwritten before they were published when dropping the oldest.
+    unsigned long dropped() const
+    {
+      return this->dropped_.load(boost::memory_order_relaxed);
+    }
+
+    size_t capacity() const
+    {
+      return this->capacity_;
+    }
+
+    /// \brief Number of messages waiting to be published.
+    size_t depth() const
+    {
+      return this->tail_.load(boost::memory_order_relaxed) -
+             this->head_.load(boost::memory_order_relaxed);
+    }
+};
+
 /// \brief A queue of outgoing messages.  Instead of calling publish() directly,
 /// you can push() messages here to defer ROS serialization and locking.
 /// Templated on a ROS message type.
+///
+/// A queue either pushes into the unbounded, mutex protected deque (the
+/// default), which never loses a message, or, when created with a capacity,
+/// into a bounded PubRingBuffer, which drops messages once full.
 template<class T>
 class PubQueue
 {
   public:
     typedef boost::shared_ptr<std::deque<boost::shared_ptr<
       PubMessagePair<T> > > > QueuePtr;
+    typedef boost::shared_ptr<PubRingBuffer<T> > RingPtr;
     typedef boost::shared_ptr<PubQueue<T> > Ptr;
 
   private:
@@ -57,31 +299,93 @@ class PubQueue
     QueuePtr queue_;
     /// \brief Mutex to control access to the queue.
     boost::shared_ptr<boost::mutex> queue_lock_;
+    /// \brief Preallocated ring used instead of queue_ when set.
+    RingPtr ring_;
     /// \brief Function that will be called when a new message is pushed on.
     boost::function<void()> notify_func_;
+    /// \brief LatencyTracer id of the topic, -1 if not traced
+    int latency_topic_;
+
+    /// \brief Trace point of a pushed or published message
+    static void traceLatency(int _topic, gazebo::LatencyTracer::Point _point,
+                             const T& _msg)
+    {
+      ros::Time stamp;
+      if (_topic >= 0 && gazebo::LatencyTracer::enabled() &&
+          latencyStamp(_msg, stamp))
+      {
+        gazebo::LatencyTracer::instance().record(_topic, _point,
+          stamp.toNSec(), ros::Time::now().toNSec());
+      }
+    }
+
+    static void copyPair(std::vector<boost::shared_ptr<PubMessagePair<T> > >*
+                         _els, T& _msg, ros::Publisher& _pub)
+    {
+      _els->push_back(boost::shared_ptr<PubMessagePair<T> >(
+        new PubMessagePair<T>(_msg, _pub)));
+    }
 
   public:
     PubQueue(QueuePtr queue,
              boost::shared_ptr<boost::mutex> queue_lock,
              boost::function<void()> notify_func) :
-      queue_(queue), queue_lock_(queue_lock), notify_func_(notify_func) {}
+      queue_(queue), queue_lock_(queue_lock), notify_func_(notify_func),
+      latency_topic_(-1) {}
+    PubQueue(RingPtr ring,
+             boost::function<void()> notify_func) :
+      ring_(ring), notify_func_(notify_func), latency_topic_(-1) {}
     ~PubQueue() {}
 
+    /// \brief Record the ENQUEUED and PUBLISHED LatencyTracer points of the
+    /// messages with a header under _topic.  Call before the first push().
+    void setLatencyTopic(const std::string& _topic)
+    {
+      this->latency_topic_ = gazebo::LatencyTracer::instance().topic(_topic);
+    }
+
     /// \brief Push a new message onto the queue.
     /// \param[in] msg The outgoing message
     /// \param[in] pub The ROS publisher to use to publish the message
     void push(T& msg, ros::Publisher& pub)
     {
+      traceLatency(this->latency_topic_, gazebo::LatencyTracer::ENQUEUED, msg);
+      if (this->ring_)
+      {
+        if (this->ring_->push(msg, pub))
+          notify_func_();
+        return;
+      }
       boost::shared_ptr<PubMessagePair<T> > el(new PubMessagePair<T>(msg, pub));
       boost::mutex::scoped_lock lock(*queue_lock_);
       queue_->push_back(el);
       notify_func_();
     }
 
+    /// \brief Push a new message onto the queue, moving it into its slot.
+    /// \param[in] msg The outgoing message, left in a valid unspecified state
+    /// \param[in] pub The ROS publisher to use to publish the message
+    void push(T&& msg, ros::Publisher& pub)
+    {
+      if (this->ring_)
+      {
+        traceLatency(this->latency_topic_, gazebo::LatencyTracer::ENQUEUED, msg);
+        if (this->ring_->push(std::move(msg), pub))
+          notify_func_();
+        return;
+      }
+      this->push(msg, pub);
+    }
+
     /// \brief Pop all waiting messages off the queue.
     /// \param[out] els Place to store the popped messages
     void pop(std::vector<boost::shared_ptr<PubMessagePair<T> > >& els)
     {
+      if (this->ring_)
+      {
+        this->ring_->consume(boost::bind(&PubQueue<T>::copyPair, &els, _1, _2));
+        return;
+      }
       boost::mutex::scoped_lock lock(*queue_lock_);
       while(!queue_->empty())
       {
@@ -89,6 +393,56 @@ class PubQueue
         queue_->pop_front();
       }
     }
+
+    /// \brief Publish all waiting messages in order, straight out of their
+    /// slots when the queue is ring backed.
+    /// \return Number of messages published
+    size_t publishAll()
+    {
+      if (this->ring_)
+      {
+        return this->ring_->consume(
+          boost::bind(&PubQueue<T>::publishPair, this->latency_topic_, _1, _2));
+      }
+
+      std::vector<boost::shared_ptr<PubMessagePair<T> > > els;
+      this->pop(els);
+      for(typename std::vector<boost::shared_ptr<PubMessagePair<T> > >::iterator it = els.begin();
+          it != els.end();
+          ++it)
+      {
+        publishPair(this->latency_topic_, (*it)->msg_, (*it)->pub_);
+      }
+      return els.size();
+    }
+
+    /// \brief Number of messages discarded because the queue was full.
+    unsigned long dropped() const
+    {
+      return this->ring_ ? this->ring_->dropped() : 0;
+    }
+
+    /// \brief Number of messages pushed onto a ring backed queue.
+    unsigned long pushed() const
+    {
+      return this->ring_ ? this->ring_->pushed() : 0;
+    }
+
+    /// \brief Number of messages waiting to be published.
+    size_t depth()
+    {
+      if (this->ring_)
+        return this->ring_->depth();
+      boost::mutex::scoped_lock lock(*queue_lock_);
+      return queue_->size();
+    }
+
+  private:
+    static void publishPair(int _latency_topic, T& _msg, ros::Publisher& _pub)
+    {
+      _pub.publish(_msg);
+      traceLatency(_latency_topic, gazebo::LatencyTracer::PUBLISHED, _msg);
+    }
 };
 
 /// \brief A collection of PubQueue objects, potentially of different types.
@@ -98,36 +452,79 @@ class PubMultiQueue
   private:
     /// \brief List of functions to be called to service our queues.
     std::list<boost::function<void()> > service_funcs_;
+    /// \brief Drop counters of our queues, guarded by service_funcs_lock_
+    std::list<boost::function<unsigned long()> > dropped_funcs_;
     /// \brief Mutex to lock access to service_funcs_
     boost::mutex service_funcs_lock_;
     /// \brief If started, the thread that will call the service functions
     boost::thread service_thread_;
     /// \brief Boolean flag to shutdown the service thread if PubMultiQueue is destructed
-    bool service_thread_running_;
+    boost::atomic<bool> service_thread_running_;
     /// \brief Condition variable used to block and resume service_thread_
     boost::condition_variable service_cond_var_;
     /// \brief Mutex to accompany service_cond_var_
     boost::mutex service_cond_var_lock_;
+    /// \brief Set by producers when there is something to publish
+    boost::atomic<bool> service_pending_;
+    /// \brief Set while service_thread_ sleeps on service_cond_var_, so that
+    /// producers only take service_cond_var_lock_ when a wakeup is needed
+    boost::atomic<bool> service_waiting_;
+
+    /// \brief Pool task of each of our queues, guarded by service_funcs_lock_
+    std::list<PubServiceTask::Ptr> tasks_;
+    /// \brief BacklogRegistry handles of our queues, guarded by
+    /// service_funcs_lock_
+    std::list<int> backlog_ids_;
+    /// \brief Set once attached to the process-wide publisher pool, the
+    /// queues are then serviced by it instead of service_thread_
+    boost::atomic<PubServicePool*> pool_;
+
+    /// \brief Slots of each newly added queue, 0 for the parameter
+    /// gazebo/pub_queue_capacity
+    size_t capacity_;
+    /// \brief Overflow policy of each newly added queue
+    PubQueueOverflowPolicy overflow_policy_;
 
     /// \brief Service a given queue by popping outgoing message off it and
     /// publishing them.
     template <class T>
     void serviceFunc(boost::shared_ptr<PubQueue<T> > pq)
     {
-      std::vector<boost::shared_ptr<PubMessagePair<T> > > els;
-      pq->pop(els);
-      for(typename std::vector<boost::shared_ptr<PubMessagePair<T> > >::iterator it = els.begin();
-          it != els.end();
-          ++it)
-      {
-        (*it)->pub_.publish((*it)->msg_);
-      }
+      pq->publishAll();
     }
 
   public:
-    PubMultiQueue() {}
+    /// \param[in] _capacity Number of preallocated slots per queue, e.g.
+    /// PUBQUEUE_DEFAULT_CAPACITY.  0 takes it from the ROS parameter
+    /// gazebo/pub_queue_capacity when a queue is added, whose default 0 keeps
+    /// the unbounded, mutex protected queues that never drop a message.
+    /// \param[in] _policy What push() does when a queue is full
+    PubMultiQueue(size_t _capacity = 0,
+                  PubQueueOverflowPolicy _policy = PUBQUEUE_DROP_OLDEST) :
+      service_thread_running_(false), service_pending_(false),
+      service_waiting_(false), pool_(NULL), capacity_(_capacity),
+      overflow_policy_(_policy) {}
     ~PubMultiQueue()
     {
+      {
+        boost::mutex::scoped_lock lock(service_funcs_lock_);
+        for(std::list<int>::iterator it = backlog_ids_.begin();
+            it != backlog_ids_.end();
+            ++it)
+        {
+          gazebo::BacklogRegistry::instance().remove(*it);
+        }
+      }
+      if (PubServicePool *pool = pool_.load())
+      {
+        boost::mutex::scoped_lock lock(service_funcs_lock_);
+        for(std::list<PubServiceTask::Ptr>::iterator it = tasks_.begin();
+            it != tasks_.end();
+            ++it)
+        {
+          pool->cancel(*it);
+        }
+      }
       if(service_thread_.joinable())
       {
         service_thread_running_ = false;
@@ -142,17 +539,88 @@ class PubMultiQueue
     template <class T>
     boost::shared_ptr<PubQueue<T> > addPub()
     {
-      typename PubQueue<T>::QueuePtr queue(new std::deque<boost::shared_ptr<PubMessagePair<T> > >);
-      boost::shared_ptr<boost::mutex> queue_lock(new boost::mutex);
-      boost::shared_ptr<PubQueue<T> > pq(new PubQueue<T>(queue, queue_lock, boost::bind(&PubMultiQueue::notifyServiceThread, this)));
+      size_t capacity = this->capacity_;
+      if (capacity == 0)
+        capacity = defaultCapacity();
+      return this->addPub<T>(capacity, this->overflow_policy_);
+    }
+
+    /// \brief Slots of the queues of a PubMultiQueue constructed without a
+    /// capacity, from the ROS parameter gazebo/pub_queue_capacity (default 0,
+    /// unbounded).  A bounded queue drops messages once full, counted by
+    /// dropped().
+    static size_t defaultCapacity()
+    {
+      int capacity = 0;
+      if (ros::isInitialized())
+        ros::param::param<int>("gazebo/pub_queue_capacity", capacity, 0);
+      return static_cast<size_t>(std::max(capacity, 0));
+    }
+
+    /// \brief Add a new latest-value queue holding at most _keep_latest
+    /// unpublished messages.  When the service thread falls behind, the
+    /// oldest unpublished sample is overwritten in place instead of being
+    /// published late; see PubQueue::dropped() for how many were.
+    /// \param[in] _keep_latest Number of samples kept, typically 1
+    /// \return Pointer to the newly created queue, good for calling push() on.
+    template <class T>
+    boost::shared_ptr<PubQueue<T> > addPub(size_t _keep_latest)
+    {
+      return this->addPub<T>(std::max<size_t>(_keep_latest, 1),
+                             PUBQUEUE_DROP_OLDEST);
+    }
+
+    /// \brief Total number of messages dropped by all of our queues.
+    unsigned long dropped()
+    {
+      unsigned long total = 0;
+      boost::mutex::scoped_lock lock(service_funcs_lock_);
+      for(std::list<boost::function<unsigned long()> >::iterator it = dropped_funcs_.begin();
+          it != dropped_funcs_.end();
+          ++it)
+      {
+        total += (*it)();
+      }
+      return total;
+    }
+
+  private:
+    template <class T>
+    boost::shared_ptr<PubQueue<T> > addPub(size_t _capacity,
+                                           PubQueueOverflowPolicy _policy)
+    {
+      boost::shared_ptr<PubQueue<T> > pq;
+      // the task owns the queue, the queue only points back at the task
+      PubServiceTask::Ptr task(new PubServiceTask(boost::function<void()>()));
+      boost::function<void()> notify =
+        boost::bind(&PubMultiQueue::notifyQueue, this, task.get());
+      if (_capacity > 0)
+      {
+        typename PubQueue<T>::RingPtr ring(
+          new PubRingBuffer<T>(_capacity, _policy));
+        pq.reset(new PubQueue<T>(ring, notify));
+      }
+      else
+      {
+        typename PubQueue<T>::QueuePtr queue(new std::deque<boost::shared_ptr<PubMessagePair<T> > >);
+        boost::shared_ptr<boost::mutex> queue_lock(new boost::mutex);
+        pq.reset(new PubQueue<T>(queue, queue_lock, notify));
+      }
       boost::function<void()> f = boost::bind(&PubMultiQueue::serviceFunc<T>, this, pq);
+      task->run_ = boost::bind(&PubQueue<T>::publishAll, pq);
       {
         boost::mutex::scoped_lock lock(service_funcs_lock_);
         service_funcs_.push_back(f);
+        dropped_funcs_.push_back(boost::bind(&PubQueue<T>::dropped, pq));
+        tasks_.push_back(task);
+        backlog_ids_.push_back(gazebo::BacklogRegistry::instance().add(
+          "PubMultiQueue", boost::bind(&PubQueue<T>::depth, pq)));
       }
       return pq;
     }
 
+  public:
+
     /// \brief Service each queue one time.
     void spinOnce()
     {
@@ -169,10 +637,17 @@ class PubMultiQueue
     /// in between cycles.
     void spin()
     {
+      gazebo::ThreadPolicy::instance().apply("publishing", "gzros_pubqueue");
       while(ros::ok() && service_thread_running_)
       {
-        boost::unique_lock<boost::mutex> lock(service_cond_var_lock_);
-        service_cond_var_.wait(lock);
+        {
+          boost::unique_lock<boost::mutex> lock(service_cond_var_lock_);
+          service_waiting_ = true;
+          while (!service_pending_ && service_thread_running_)
+            service_cond_var_.wait(lock);
+          service_waiting_ = false;
+        }
+        service_pending_ = false;
         spinOnce();
       }
     }
@@ -184,11 +659,55 @@ class PubMultiQueue
       service_thread_ = boost::thread(boost::bind(&PubMultiQueue::spin, this));
     }
 
+    /// \brief Have the process-wide PubServicePool service our queues instead
+    /// of a thread of our own.  Each queue becomes a pool task, so a queue
+    /// that is slow to serialize does not hold up the others; messages of one
+    /// queue are still published in order.
+    void attachServicePool()
+    {
+      PubServicePool &pool = PubServicePool::instance();
+      pool_ = &pool;
+      // flush whatever was pushed before attaching
+      boost::mutex::scoped_lock lock(service_funcs_lock_);
+      for(std::list<PubServiceTask::Ptr>::iterator it = tasks_.begin();
+          it != tasks_.end();
+          ++it)
+      {
+        pool.submit(it->get());
+      }
+    }
+
+    /// \brief Start servicing our queues, with the shared PubServicePool if
+    /// the ROS parameter gazebo/use_pub_service_pool is set, otherwise with
+    /// startServiceThread().
+    void startService()
+    {
+      if (PubServicePool::enabled())
+        attachServicePool();
+      else
+        startServiceThread();
+    }
+
+    /// \brief Called by a queue after a push, hands it to the pool when
+    /// attached, otherwise wakes up the service thread.
+    void notifyQueue(PubServiceTask *_task)
+    {
+      if (PubServicePool *pool = pool_.load())
+        pool->submit(_task);
+      else
+        notifyServiceThread();
+    }
+
     /// \brief Wake up the queue serive thread (e.g., after having pushed a
     /// message onto one of the queues).
     void notifyServiceThread()
     {
-      service_cond_var_.notify_one();
+      service_pending_ = true;
+      if (service_waiting_)
+      {
+        boost::mutex::scoped_lock lock(service_cond_var_lock_);
+        service_cond_var_.notify_one();
+      }
     }
 };
 
@@ -0,0 +1,128 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GAZEBO_ROS_ASYNC_IMAGE_PUBLISHER_HH
+#define GAZEBO_ROS_ASYNC_IMAGE_PUBLISHER_HH
+
+#include <deque>
+
+#include <boost/thread/mutex.hpp>
+
+#include <ros/ros.h>
+#include <sensor_msgs/Image.h>
+#include <sensor_msgs/CameraInfo.h>
+#include <image_transport/image_transport.h>
+
+#include <gazebo_ros/latency_tracer.h>
+
+#include <gazebo_plugins/pub_service_pool.h>
+
+namespace gazebo
+{
+  /// \brief Bounded hand-off between a camera's render callback and the
+  /// PubServicePool workers.
+  ///
+  /// The render thread only queues the (pooled, already filled) frame and
+  /// its CameraInfo; image_transport plugin encoding (compressed, theora,
+  /// ...) and publishing happen on a pool worker.  Frames of one camera are
+  /// published in order.  When the workers fall behind by more than the queue
+  /// depth the oldest queued frame is dropped, the render thread never waits.
+  class AsyncImagePublisher
+  {
+    /// \brief Constructor
+    /// \param[in] _image_pub Publisher of the images
+    /// \param[in] _depth Maximum number of queued images, at least 1
+    public: AsyncImagePublisher(const image_transport::Publisher &_image_pub,
+                                size_t _depth);
+
+    /// \brief Destructor, waits for a worker publishing our queue to
+    /// return.  Queued messages are discarded.
+    public: ~AsyncImagePublisher();
+
+    /// \brief Queue an image for publishing.
+    public: void PushImage(const sensor_msgs::ImageConstPtr &_image);
+
+    /// \brief Queue a CameraInfo, published in order with the images.
+    public: void PushCameraInfo(const ros::Publisher &_pub,
+                                const sensor_msgs::CameraInfoConstPtr &_info);
+
+    /// \brief Number of images queued since construction.
+    public: unsigned long Pushed();
+
+    /// \brief Number of images dropped because the queue was full.
+    public: unsigned long Dropped();
+
+    /// \brief Number of images currently waiting.
+    public: size_t Depth();
+
+    /// \brief Highest number of images seen waiting at once.
+    public: size_t MaxDepth();
+
+    /// \brief Images waiting or being published, for the BacklogRegistry.
+    private: size_t Backlog();
+
+    /// \brief Remove the oldest queued image, or camera info if !_image.
+    /// Call with lock_ held.
+    private: void EraseOldest(bool _image);
+
+    /// \brief Publish everything queued so far, run by a pool worker.
+    private: void Drain();
+
+    private: struct Item
+    {
+      sensor_msgs::ImageConstPtr image_;
+      sensor_msgs::CameraInfoConstPtr info_;
+      ros::Publisher info_pub_;
+    };
+
+    private: image_transport::Publisher image_pub_;
+
+    /// \brief LatencyTracer id of the image topic, PUBLISHED is recorded
+    /// here.
+    private: uint32_t latency_topic_;
+
+    /// \brief Protects the members below.
+    private: boost::mutex lock_;
+
+    /// \brief Queued images and camera infos, oldest first.
+    private: std::deque<Item> items_;
+
+    private: size_t depth_;
+
+    /// \brief Images in items_.
+    private: size_t images_;
+
+    /// \brief Camera infos in items_, bounded by depth_ as well.
+    private: size_t infos_;
+
+    private: size_t max_images_;
+
+    /// \brief Images taken by Drain() and not published yet.
+    private: size_t draining_;
+
+    private: unsigned long pushed_;
+
+    private: unsigned long dropped_;
+
+    /// \brief Pool task draining items_.
+    private: PubServiceTask::Ptr task_;
+
+    /// \brief BacklogRegistry handle.
+    private: int backlog_id_;
+  };
+}
+#endif
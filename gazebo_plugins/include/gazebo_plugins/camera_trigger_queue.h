@@ -0,0 +1,133 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GAZEBO_ROS_CAMERA_TRIGGER_QUEUE_HH
+#define GAZEBO_ROS_CAMERA_TRIGGER_QUEUE_HH
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <gazebo/common/Time.hh>
+
+namespace gazebo
+{
+  /// \brief Sim time stamped triggers of a triggered camera.
+  ///
+  /// A trigger is due once the sim time reaches its stamp, and the camera
+  /// renders while one is due. Rendered() hands each frame to the earliest
+  /// due trigger, so triggers with the same stamp each get a frame.
+  ///
+  /// An exact trigger also holds the physics while its frame renders. The
+  /// render thread only runs after the sim time advanced, so the physics
+  /// cannot be held as soon as a trigger is due: Arm(), called by the render
+  /// thread before each render pass, marks the due triggers as rendering,
+  /// and WaitExact(), called at the start of each world update, blocks only
+  /// while such a trigger is exact and not rendered yet. The frame thus
+  /// shows the world at the first render pass at or after the stamp.
+  /// Triggers that do not fit into the queue, and exact triggers that were
+  /// not rendered within the timeout, count as missed. The cameras of a
+  /// multicamera share one queue.
+  class CameraTriggerQueue
+  {
+    /// \brief Constructor.
+    /// \param[in] _capacity Maximum number of queued triggers.
+    public: explicit CameraTriggerQueue(size_t _capacity = 64);
+
+    /// \brief Set the maximum number of queued triggers.
+    public: void SetCapacity(size_t _capacity);
+
+    /// \brief Queue a trigger.
+    /// \param[in] _time Sim time to render at.
+    /// \param[in] _exact Hold the physics at _time until the frame rendered.
+    /// \return False, and the trigger counts as missed, if the queue is full.
+    public: bool Push(const common::Time &_time, bool _exact);
+
+    /// \brief Queue a burst of triggers, all or none.
+    /// \param[in] _times Sim times to render at, in any order.
+    /// \param[in] _exact Hold the physics at each time until it rendered.
+    /// \param[out] _error Reason if nothing was queued.
+    /// \return True if the triggers were queued.
+    public: bool PushBurst(const std::vector<common::Time> &_times,
+                           bool _exact, std::string &_error);
+
+    /// \brief Whether a trigger is due at a sim time.
+    public: bool Due(const common::Time &_simTime);
+
+    /// \brief Called by the render thread before a render pass: mark the
+    /// triggers due at _simTime as rendering, so WaitExact() holds the
+    /// physics for them.
+    /// \return Whether a trigger is due, i.e. the camera has to render.
+    public: bool Arm(const common::Time &_simTime);
+
+    /// \brief Hand a rendered frame to the due triggers.
+    /// \param[in] _measurement Measurement time of the frame. A frame with
+    /// the same time as the previous one, e.g. the second camera of a
+    /// multicamera, is not handed out again.
+    /// \param[out] _requested Stamp of the trigger the frame is for.
+    /// \return True if the frame was for a trigger.
+    public: bool Rendered(const common::Time &_measurement,
+                          common::Time &_requested);
+
+    /// \brief Block while an exact trigger that Arm() marked as rendering is
+    /// not rendered, for at most _timeout wall seconds. Triggers that are
+    /// due but not armed yet never block, the render thread needs the
+    /// physics to advance to get to them. On timeout, the armed triggers
+    /// render late and count as missed.
+    /// \return False if the wait timed out.
+    public: bool WaitExact(const common::Time &_simTime, double _timeout);
+
+    /// \brief Number of queued triggers.
+    public: size_t Depth();
+
+    /// \brief Number of dropped triggers and exact triggers rendered late.
+    public: uint64_t Missed() const;
+
+    /// \brief Drop all queued triggers, e.g. after a world reset.
+    public: void Clear();
+
+    /// \brief Queued triggers by stamp, with whether they are exact.
+    private: std::multimap<common::Time, bool> triggers_;
+
+    /// \brief Number of exact triggers in triggers_, read without the lock.
+    private: std::atomic<int> exact_;
+
+    /// \brief Maximum size of triggers_.
+    private: size_t capacity_;
+
+    /// \brief Measurement time of the last frame handed out.
+    private: common::Time last_measurement_;
+
+    /// \brief Sim time of the last render pass that saw a due trigger,
+    /// triggers up to it are rendering.
+    private: common::Time armed_;
+
+    /// \brief Dropped triggers and exact triggers rendered late.
+    private: std::atomic<uint64_t> missed_;
+
+    /// \brief Protects triggers_, capacity_, last_measurement_ and armed_.
+    private: std::mutex mutex_;
+
+    /// \brief Signalled by Rendered() and Clear().
+    private: std::condition_variable cond_;
+  };
+}
+#endif
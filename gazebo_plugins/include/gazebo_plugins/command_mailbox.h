@@ -0,0 +1,127 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GAZEBO_ROS_COMMAND_MAILBOX_HH
+#define GAZEBO_ROS_COMMAND_MAILBOX_HH
+
+#include <stdint.h>
+
+#include <atomic>
+#include <chrono>
+
+#include <gazebo_ros/plugin_timing.h>
+
+namespace gazebo
+{
+  /// \brief Latest command of a plugin, handed from its subscription
+  /// callback to the world update without a lock.
+  ///
+  /// A seqlock over _N doubles with a single writer, the callback, and a
+  /// single reader, the update: Write() never waits, and Read() only
+  /// retries while a write is in progress.  Each write is stamped with the
+  /// steady clock, and the first Read() of it records the time since then,
+  /// the command-to-actuation latency, into a TimingStage of the
+  /// TimingRegistry if one is set.
+  template<unsigned int _N>
+  class CommandMailbox
+  {
+    /// \brief Constructor
+    public: CommandMailbox()
+      : seq_(0), stamp_(0), read_seq_(0), latency_(NULL)
+    {
+      for (unsigned int i = 0; i < _N; ++i)
+        this->values_[i].store(0, std::memory_order_relaxed);
+    }
+
+    /// \brief Record the latency of each command into _stage, none if null.
+    /// Call before the subscription is made.
+    public: void SetLatencyStage(TimingStage *_stage)
+    {
+      this->latency_ = _stage;
+    }
+
+    /// \brief Replace the command, from the writer thread only.
+    public: void Write(const double (&_values)[_N])
+    {
+      uint64_t seq = this->seq_.load(std::memory_order_relaxed);
+      this->seq_.store(seq + 1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+      for (unsigned int i = 0; i < _N; ++i)
+        this->values_[i].store(_values[i], std::memory_order_relaxed);
+      this->stamp_.store(Now(), std::memory_order_relaxed);
+      this->seq_.store(seq + 2, std::memory_order_release);
+    }
+
+    /// \brief Get the command if it changed since the last Read(), from the
+    /// reader thread only.
+    /// \param[out] _values The command, left alone if there is none new
+    /// \return true if _values was set
+    public: bool Read(double (&_values)[_N])
+    {
+      int64_t stamp;
+      uint64_t seq;
+      for (;;)
+      {
+        seq = this->seq_.load(std::memory_order_acquire);
+        if (seq == this->read_seq_)
+          return false;
+        if (seq & 1)
+          continue;
+        for (unsigned int i = 0; i < _N; ++i)
+          _values[i] = this->values_[i].load(std::memory_order_relaxed);
+        stamp = this->stamp_.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (this->seq_.load(std::memory_order_relaxed) == seq)
+          break;
+      }
+      this->read_seq_ = seq;
+      if (this->latency_)
+        this->latency_->record(Now() - stamp);
+      return true;
+    }
+
+    /// \brief Treat the current command as read, from the reader thread
+    /// only.  Read() returns false until the next Write().
+    public: void Skip()
+    {
+      uint64_t seq = this->seq_.load(std::memory_order_acquire);
+      // a write in progress is still read once it completes
+      if (!(seq & 1))
+        this->read_seq_ = seq;
+    }
+
+    private: static int64_t Now()
+    {
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /// \brief Odd while Write() runs, 0 until the first command.
+    private: std::atomic<uint64_t> seq_;
+
+    private: std::atomic<double> values_[_N];
+
+    /// \brief Steady clock time of the last Write() [ns].
+    private: std::atomic<int64_t> stamp_;
+
+    /// \brief seq_ of the command last read.
+    private: uint64_t read_seq_;
+
+    private: TimingStage *latency_;
+  };
+}
+#endif
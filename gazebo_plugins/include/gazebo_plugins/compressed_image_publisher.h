@@ -0,0 +1,134 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GAZEBO_ROS_COMPRESSED_IMAGE_PUBLISHER_HH
+#define GAZEBO_ROS_COMPRESSED_IMAGE_PUBLISHER_HH
+
+#include <string>
+#include <vector>
+
+#include <boost/thread/mutex.hpp>
+
+#include <ros/ros.h>
+#include <sensor_msgs/Image.h>
+#include <sensor_msgs/CompressedImage.h>
+
+#include <gazebo_plugins/pub_service_pool.h>
+
+namespace gazebo
+{
+  /// \brief Encodes the frames of a camera into sensor_msgs/CompressedImage
+  /// on the PubServicePool workers and publishes them.
+  ///
+  /// compressed_image_transport encodes in the thread calling publish(),
+  /// one frame at a time.  Here each frame gets one of a fixed number of
+  /// slots, and the slots are encoded by different workers at once, so a
+  /// camera whose encoding takes longer than its frame period still keeps
+  /// up when there are cores to spare.  Encoded frames are published in the
+  /// order they were pushed.  When all slots are busy the new frame is
+  /// dropped, the render thread never waits.
+  ///
+  /// The images are encoded with OpenCV, i.e. with whatever JPEG and PNG
+  /// libraries it was built against, typically libjpeg-turbo.
+  class CompressedImagePublisher
+  {
+    public: enum Format
+    {
+      JPEG,
+      PNG
+    };
+
+    /// \brief Constructor
+    /// \param[in] _pub Publisher of sensor_msgs/CompressedImage
+    /// \param[in] _format Encoding of the frames
+    /// \param[in] _level JPEG quality 1-100, or PNG compression level 0-9
+    /// \param[in] _slots Frames encoded at once, at least 1
+    public: CompressedImagePublisher(const ros::Publisher &_pub,
+                                     Format _format, int _level,
+                                     size_t _slots);
+
+    /// \brief Destructor, waits for the workers encoding our frames to
+    /// return.  Frames not published yet are discarded.
+    public: ~CompressedImagePublisher();
+
+    /// \brief Queue a frame for encoding, it must not change afterwards.
+    public: void Push(const sensor_msgs::ImageConstPtr &_image);
+
+    /// \brief Number of frames queued since construction.
+    public: unsigned long Pushed();
+
+    /// \brief Number of frames dropped because all slots were busy.
+    public: unsigned long Dropped();
+
+    /// \brief Number of frames OpenCV failed to encode.
+    public: unsigned long Failed();
+
+    /// \brief Frames being encoded or waiting to be published, for the
+    /// BacklogRegistry.
+    private: size_t Backlog();
+
+    /// \brief Encode the frame of a slot, run by a pool worker.
+    private: void Encode(size_t _slot);
+
+    /// \brief Encode _image into _msg.
+    /// \return False if the encoding of the image is not supported.
+    private: bool EncodeImage(const sensor_msgs::ImageConstPtr &_image,
+                              sensor_msgs::CompressedImage &_msg);
+
+    /// \brief Publish the encoded frames that are next in order.
+    private: void PublishEncoded();
+
+    private: struct Slot
+    {
+      PubServiceTask::Ptr task_;
+      sensor_msgs::ImageConstPtr image_;
+      sensor_msgs::CompressedImagePtr out_;
+      unsigned long seq_;
+      bool busy_;
+      bool done_;
+    };
+
+    private: ros::Publisher pub_;
+
+    private: Format format_;
+
+    private: int level_;
+
+    /// \brief Protects the members below.
+    private: boost::mutex lock_;
+
+    private: std::vector<Slot> slots_;
+
+    /// \brief Sequence number of the next frame pushed.
+    private: unsigned long next_seq_;
+
+    /// \brief Sequence number of the next frame to publish.
+    private: unsigned long next_publish_;
+
+    private: unsigned long dropped_;
+
+    private: unsigned long failed_;
+
+    /// \brief Held while taking frames out of slots_ and publishing them,
+    /// so that two workers never publish out of order.
+    private: boost::mutex publish_lock_;
+
+    /// \brief BacklogRegistry handle.
+    private: int backlog_id_;
+  };
+}
+#endif
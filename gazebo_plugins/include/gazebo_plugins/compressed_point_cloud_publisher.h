@@ -0,0 +1,128 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GAZEBO_ROS_COMPRESSED_POINT_CLOUD_PUBLISHER_HH
+#define GAZEBO_ROS_COMPRESSED_POINT_CLOUD_PUBLISHER_HH
+
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <ros/ros.h>
+#include <gazebo_msgs/CompressedPointCloud.h>
+#include <sensor_msgs/PointCloud2.h>
+
+#include <gazebo_plugins/point_cloud_codec.h>
+#include <gazebo_plugins/pub_service_pool.h>
+
+namespace gazebo
+{
+  /// \brief Encodes point clouds into gazebo_msgs/CompressedPointCloud on
+  /// the PubServicePool workers and publishes them, like the
+  /// CompressedImagePublisher does for camera frames: a fixed number of
+  /// slots encoded at once, published in the order they were pushed, and
+  /// a cloud pushed while all slots are busy is dropped.
+  class CompressedPointCloudPublisher
+  {
+    /// \brief Constructor
+    /// \param[in] _pub Publisher of gazebo_msgs/CompressedPointCloud
+    /// \param[in] _resolution Quantization of the positions [m]
+    /// \param[in] _entropy Whether to compress with bzip2
+    /// \param[in] _slots Clouds encoded at once, at least 1
+    public: CompressedPointCloudPublisher(const ros::Publisher &_pub,
+                                          float _resolution, bool _entropy,
+                                          size_t _slots);
+
+    /// \brief Destructor, waits for the workers encoding our clouds to
+    /// return.  Clouds not published yet are discarded.
+    public: ~CompressedPointCloudPublisher();
+
+    /// \brief Queue a cloud for encoding, it must not change afterwards.
+    public: void Push(const sensor_msgs::PointCloud2ConstPtr &_cloud);
+
+    /// \brief Queue a copy of a cloud the caller reuses, e.g. the member
+    /// message of a depth camera.  The copy goes into storage of the slot,
+    /// kept from one cloud to the next.
+    public: void Push(const sensor_msgs::PointCloud2 &_cloud);
+
+    /// \brief Number of clouds queued since construction.
+    public: unsigned long Pushed();
+
+    /// \brief Number of clouds dropped because all slots were busy.
+    public: unsigned long Dropped();
+
+    /// \brief Number of clouds without float32 x, y and z.
+    public: unsigned long Failed();
+
+    /// \brief Clouds being encoded or waiting to be published, for the
+    /// BacklogRegistry.
+    private: size_t Backlog();
+
+    /// \brief Take a free slot for the next cloud.
+    /// \return The slot, or -1 if all are busy
+    private: int Reserve();
+
+    /// \brief Hand a reserved slot to the pool.
+    private: void Submit(int _slot);
+
+    /// \brief Encode the cloud of a slot, run by a pool worker.
+    private: void Encode(size_t _slot);
+
+    /// \brief Publish the encoded clouds that are next in order.
+    private: void PublishEncoded();
+
+    private: struct Slot
+    {
+      PubServiceTask::Ptr task_;
+      boost::shared_ptr<PointCloudCodec> codec_;
+      sensor_msgs::PointCloud2ConstPtr cloud_;
+      /// \brief Copy of the clouds pushed by reference.
+      sensor_msgs::PointCloud2 copy_;
+      bool copied_;
+      gazebo_msgs::CompressedPointCloudPtr out_;
+      unsigned long seq_;
+      bool busy_;
+      bool done_;
+    };
+
+    private: ros::Publisher pub_;
+
+    /// \brief Protects the members below.
+    private: boost::mutex lock_;
+
+    private: std::vector<Slot> slots_;
+
+    /// \brief Sequence number of the next cloud pushed.
+    private: unsigned long next_seq_;
+
+    /// \brief Sequence number of the next cloud to publish.
+    private: unsigned long next_publish_;
+
+    private: unsigned long dropped_;
+
+    private: unsigned long failed_;
+
+    /// \brief Held while taking clouds out of slots_ and publishing them,
+    /// so that two workers never publish out of order.
+    private: boost::mutex publish_lock_;
+
+    /// \brief BacklogRegistry handle.
+    private: int backlog_id_;
+  };
+}
+#endif
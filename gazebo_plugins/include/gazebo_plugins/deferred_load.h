@@ -0,0 +1,119 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GAZEBO_ROS_DEFERRED_LOAD_HH
+#define GAZEBO_ROS_DEFERRED_LOAD_HH
+
+#include <deque>
+#include <string>
+
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <sdf/sdf.hh>
+
+namespace gazebo
+{
+  /// \brief Shared pool of threads for the ROS side of plugin loads.
+  ///
+  /// Gazebo loads the plugins of a world one after the other, so a plugin
+  /// that creates its node, reads parameters and advertises topics in Load
+  /// holds up every plugin after it. A plugin can hand that part to Run()
+  /// instead: the tasks of all plugins run in parallel on up to
+  /// GAZEBO_ROS_LOAD_THREADS threads (8 by default), which exit once the
+  /// queue is empty. Each task is recorded as the "deferred load" phase of
+  /// its plugin in the StartupTrace, and counts as pending from the time
+  /// it is queued, so the startup report waits for it.
+  ///
+  /// The plugins that always deferred their ROS setup use it, and the
+  /// others do with <deferredLoad>true</deferredLoad>. A task runs while
+  /// gazebo keeps loading the world, so it connects the update event of
+  /// its plugin last, and the plugin waits for it before destruction.
+  class DeferredLoad
+  {
+    /// \brief A queued load.
+    public: class Task
+    {
+      /// \brief Constructor.
+      public: Task();
+
+      /// \brief Wait until the load ran.
+      public: void Wait();
+
+      /// \brief Mark the load as done and wake up Wait().
+      private: void Done();
+
+      /// \brief True once the load ran.
+      private: bool done_;
+
+      /// \brief Protects done_.
+      private: boost::mutex mutex_;
+
+      /// \brief Signalled by Done().
+      private: boost::condition_variable cond_;
+
+      friend class DeferredLoad;
+    };
+
+    /// \brief Handle of a queued load.
+    public: typedef boost::shared_ptr<Task> TaskPtr;
+
+    /// \brief The pool shared by all plugins of the process.
+    public: static DeferredLoad &Instance();
+
+    /// \brief Whether the SDF of a plugin asks for <deferredLoad>.
+    /// \param[in] _sdf SDF of the plugin.
+    /// \param[in] _default Value if the element is missing.
+    public: static bool Requested(sdf::ElementPtr _sdf, bool _default = false);
+
+    /// \brief Queue the ROS load of a plugin.
+    /// \param[in] _plugin Name of the plugin in the startup trace.
+    /// \param[in] _load The load. An exception it throws is logged.
+    /// \return Handle to wait for the load with.
+    public: TaskPtr Run(const std::string &_plugin,
+                        const boost::function<void()> &_load);
+
+    /// \brief Constructor, use Instance().
+    private: DeferredLoad();
+
+    /// \brief Run the queued loads until there are none left.
+    private: void Worker();
+
+    /// \brief A load with its plugin name and handle.
+    private: struct Entry
+    {
+      std::string plugin;
+      boost::function<void()> load;
+      TaskPtr task;
+    };
+
+    /// \brief Loads not started yet.
+    private: std::deque<Entry> queue_;
+
+    /// \brief Running worker threads.
+    private: unsigned int workers_;
+
+    /// \brief Maximum number of worker threads.
+    private: unsigned int max_workers_;
+
+    /// \brief Protects queue_ and workers_.
+    private: boost::mutex mutex_;
+  };
+}
+#endif
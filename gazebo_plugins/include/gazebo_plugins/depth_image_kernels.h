@@ -0,0 +1,79 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GAZEBO_ROS_DEPTH_IMAGE_KERNELS_HH
+#define GAZEBO_ROS_DEPTH_IMAGE_KERNELS_HH
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <boost/function.hpp>
+
+namespace gazebo
+{
+  /// \brief Per-pixel conversions of float32 depth images shared by the
+  /// depth camera plugins.
+  ///
+  /// Every kernel has a scalar implementation and SSE2 / AVX2 (x86) or NEON
+  /// (ARM) ones.  The fastest one the CPU supports is picked at the first
+  /// call; set the environment variable GAZEBO_ROS_DEPTH_KERNELS to
+  /// "scalar", "sse2", "avx2" or "neon" to force one.  A depth d is valid
+  /// when _min < d < _max, NaN depths are never valid.
+  namespace depth_kernels
+  {
+    /// \brief Name of the implementation in use.
+    const char *Implementation();
+
+    /// \brief Force an implementation, for tests.
+    /// \return false if _name is unknown or not supported by this CPU
+    bool SetImplementation(const char *_name);
+
+    /// \brief _dst[i] = _src[i] if valid, NaN otherwise.
+    void ClipDepth(const float *_src, float *_dst, size_t _n,
+                   float _min, float _max);
+
+    /// \brief _dst[i] = _src[i] in millimetres, truncated and saturated to
+    /// 65535, if valid, 0 otherwise (REP 118 16UC1).
+    void DepthToMillimeters(const float *_src, uint16_t *_dst, size_t _n,
+                            float _min, float _max);
+
+    /// \brief _dst[i] = _baseline_focal / _src[i] if valid, NaN otherwise.
+    void DepthToDisparity(const float *_src, float *_dst, size_t _n,
+                          float _baseline_focal, float _min, float _max);
+
+    /// \brief Interleave one row of unprojected points and their colors into
+    /// PointCloud2 data with float x, y, z at offsets 0, 4, 8 and the color
+    /// bytes at _rgb_offset, the fourth color byte is zeroed.  When
+    /// _rgb_offset >= 16 the bytes 12 to 15 are padding and are zeroed too,
+    /// which lets the vector implementations store a point in one write.
+    /// \param[in] _x, _y, _z Coordinates, NaN for invalid points
+    /// \param[in] _color _n * _channels color bytes, or NULL for black
+    /// \param[in] _channels 3 for RGB, 1 for mono
+    /// \param[out] _out First point of the row
+    /// \return Number of invalid (NaN) points
+    size_t PackXYZRGB(const float *_x, const float *_y, const float *_z,
+                      const uint8_t *_color, int _channels, size_t _n,
+                      uint8_t *_out, size_t _point_step, size_t _rgb_offset);
+
+    /// \brief Call _f(first_row, end_row) over [0, _rows), split across a
+    /// process-wide pool of worker threads when the image is large enough
+    /// to be worth it.  Returns when every row is done.
+    void ParallelRows(size_t _rows, size_t _cols,
+                      const boost::function<void(size_t, size_t)> &_f);
+  }
+}
+#endif
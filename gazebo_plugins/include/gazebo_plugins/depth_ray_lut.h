@@ -0,0 +1,65 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GAZEBO_ROS_DEPTH_RAY_LUT_HH
+#define GAZEBO_ROS_DEPTH_RAY_LUT_HH
+
+#include <vector>
+
+namespace gazebo
+{
+  /// \brief Per-camera table of pixel ray slopes used to unproject a depth
+  /// image into the camera optical frame.
+  ///
+  /// A pixel (col, row) at depth d maps to
+  /// (d * X()[col], d * Y()[row], d), so after Update() the unprojection is
+  /// two multiplies per pixel.  The slopes are kept in separate contiguous
+  /// float arrays, one per axis, so the per-row loops over them vectorize.
+  class DepthRayLUT
+  {
+    /// \brief Constructor
+    public: DepthRayLUT();
+
+    /// \brief Rebuild the table if the resolution or field of view changed.
+    /// \param[in] _rows Image height
+    /// \param[in] _cols Image width
+    /// \param[in] _hfov Horizontal field of view [rad]
+    /// \return true if the table was rebuilt
+    public: bool Update(unsigned int _rows, unsigned int _cols, double _hfov);
+
+    /// \brief Slope of each column, tan of the yaw angle of its ray.
+    public: const float *X() const;
+
+    /// \brief Slope of each row, tan of the pitch angle of its ray.
+    public: const float *Y() const;
+
+    /// \brief Unproject one row of depths.
+    /// \param[in] _row Row index
+    /// \param[in] _depth _cols depths of that row
+    /// \param[out] _x _cols x coordinates
+    /// \param[out] _y _cols y coordinates
+    public: void UnprojectRow(unsigned int _row, const float *_depth,
+                              float *_x, float *_y) const;
+
+    private: unsigned int rows_;
+    private: unsigned int cols_;
+    private: double hfov_;
+    private: std::vector<float> x_;
+    private: std::vector<float> y_;
+  };
+}
+#endif
@@ -23,30 +23,33 @@
 #ifndef GAZEBO_ROS_BLOCK_LASER_HH
 #define GAZEBO_ROS_BLOCK_LASER_HH
 
-// Custom Callback Queue
-#include <ros/ros.h>
-#include <ros/callback_queue.h>
-#include <ros/advertise_options.h>
+#include <string>
+#include <vector>
 
-#include <sdf/Param.hh>
 #include <gazebo/physics/physics.hh>
 #include <gazebo/transport/TransportTypes.hh>
 #include <gazebo/msgs/MessageTypes.hh>
 #include <gazebo/common/Time.hh>
-#include <gazebo/common/Plugin.hh>
-#include <gazebo/sensors/SensorTypes.hh>
+#include <gazebo/sensors/RaySensor.hh>
 #include <gazebo/plugins/RayPlugin.hh>
 
-#include <boost/bind.hpp>
-#include <boost/thread.hpp>
+#include <boost/shared_ptr.hpp>
 #include <boost/thread/mutex.hpp>
 
+#include <gazebo_msgs/CompressedPointCloud.h>
 #include <sensor_msgs/PointCloud.h>
+#include <sensor_msgs/PointCloud2.h>
+#include <gazebo_plugins/compressed_point_cloud_publisher.h>
+#include <gazebo_plugins/gazebo_ros_sensor_plugin.h>
+#include <gazebo_plugins/gazebo_ros_noise.h>
+#include <gazebo_plugins/laser_intensity.h>
 
 namespace gazebo
 {
 
-  class GazeboRosBlockLaser : public RayPlugin
+  class GazeboRosBlockLaser
+    : public GazeboRosSensorPlugin<GazeboRosBlockLaser, RayPlugin,
+                                   sensors::RaySensor>
   {
     /// \brief Constructor
     /// \param parent The parent entity, must be a Model or a Sensor
@@ -55,39 +58,139 @@ namespace gazebo
     /// \brief Destructor
     public: ~GazeboRosBlockLaser();
 
-    /// \brief Load the plugin
-    /// \param take in SDF root element
-    public: void Load(sensors::SensorPtr _parent, sdf::ElementPtr _sdf);
-
     /// \brief Update the controller
     protected: virtual void OnNewLaserScans();
 
+    /// \brief Read the plugin parameters
+    private: bool LoadSdf(sdf::ElementPtr _sdf);
+
+    /// \brief Advertise the cloud topics
+    private: void LoadRos();
+
+    private: friend SensorPluginBase;
+
     /// \brief Put laser data to the ROS topic
     private: void PutLaserData(common::Time &_updateTime);
 
-    private: common::Time last_update_time_;
-
-    /// \brief Keep track of number of connctions
-    private: int laser_connect_count_;
-    private: void LaserConnect();
-    private: void LaserDisconnect();
+    /// \brief Convert the ranges [_begin, _end) of vertical row _j of the
+    /// last scan into the scratch rows: range, x, y, z and intensity, noise
+    /// included
+    private: void ConvertRow(int _j, int _begin, int _end);
 
-    // Pointer to the model
-    private: physics::WorldPtr world_;
-    /// \brief The parent sensor
-    private: sensors::SensorPtr parent_sensor_;
-    private: sensors::RaySensorPtr parent_ray_sensor_;
+    /// \brief Publish the packets of the spinning lidar swept since the
+    /// last update
+    /// \param[in] _intensities False to leave the intensities 0, the
+    /// packets keep the velodyne_pointcloud layout
+    private: void PutPackets(const common::Time &_updateTime,
+                             bool _intensities);
 
-    /// \brief pointer to ros node
-    private: ros::NodeHandle* rosnode_;
-    private: ros::Publisher pub_;
+    private: common::Time last_update_time_;
 
-    /// \brief ros message
-    private: sensor_msgs::PointCloud cloud_msg_;
+    private: SensorPublication<sensor_msgs::PointCloud2>::Ptr cloud_pub_;
+
+    /// \brief Only advertised with a legacy_topic_name_
+    private: SensorPublication<sensor_msgs::PointCloud>::Ptr legacy_pub_;
+
+    /// \brief Only advertised with a compressed_topic_name_.  Its messages
+    /// are published by compressed_publisher_, from the clouds or packets
+    /// of topic_name_, which are built while either topic has subscribers.
+    private: SensorPublication<gazebo_msgs::CompressedPointCloud>::Ptr
+        compressed_pub_;
+    private: boost::shared_ptr<CompressedPointCloudPublisher>
+        compressed_publisher_;
+
+    /// \brief Layout of the cloud messages, organized rangeCount x
+    /// verticalRangeCount, without data; the pooled messages are given its
+    /// size and keep the capacity of their data from scan to scan
+    private: sensor_msgs::PointCloud2 cloud_msg_;
+
+    /// \brief Whether and how the intensities are published
+    private: LaserIntensity intensity_;
+
+    /// \brief Build the interpolation tables for the current sensor
+    /// resolution and size the messages
+    private: void UpdateTables();
+
+    /// \brief Ray resolution the tables were built for
+    private: int ray_count_;
+    private: int vertical_ray_count_;
+
+    /// \brief Per range: the rays it is interpolated from, the weight of
+    /// the upper ray and the direction of the point
+    private: std::vector<int> h_lo_;
+    private: std::vector<int> h_hi_;
+    private: std::vector<float> h_frac_;
+    private: std::vector<float> cos_yaw_;
+    private: std::vector<float> sin_yaw_;
+
+    /// \brief Per vertical range, as above
+    private: std::vector<int> v_lo_;
+    private: std::vector<int> v_hi_;
+    private: std::vector<float> v_frac_;
+    private: std::vector<float> cos_pitch_;
+    private: std::vector<float> sin_pitch_;
+
+    /// \brief Ranges and retro values of all rays of the last scan
+    private: std::vector<float> ray_ranges_;
+    private: std::vector<float> ray_retros_;
+
+    /// \brief Scratch rows of PutLaserData
+    private: std::vector<float> row_ranges_;
+    private: std::vector<float> row_retros_;
+    private: std::vector<float> scan_row_;
+    private: std::vector<float> noise_row_;
+
+    /// \brief Spinning lidar mode: topic_name_ carries packets of
+    /// x, y, z, intensity, ring and time instead of whole scans.  The sensor
+    /// is taken to turn at spin_rate_ from AngleMin to AngleMax, a packet is
+    /// the part of the revolution swept in 1 / (spin_rate_ *
+    /// packets_per_revolution_).
+    private: bool spinning_;
+
+    /// \brief Revolutions per second
+    private: double spin_rate_;
+
+    /// \brief Number of packets a revolution is split into
+    private: int packets_per_revolution_;
+
+    /// \brief Number of the last packet published since sim time 0, -1 if
+    /// none was
+    private: int64_t last_packet_;
+
+    /// \brief Ranges [packet_begin_[p], packet_begin_[p + 1]) belong to
+    /// packet p
+    private: std::vector<int> packet_begin_;
+
+    /// \brief Per range: the time it is swept at, relative to the start of
+    /// its packet
+    private: std::vector<float> range_time_;
+
+    /// \brief Layout of the packet messages, organized verticalRangeCount
+    /// rows (the rings) of the ranges of the packet, without data
+    private: std::vector<sensor_msgs::PointCloud2> packet_msgs_;
 
     /// \brief topic name
     private: std::string topic_name_;
 
+    /// \brief sensor_msgs::PointCloud topic name, empty to not advertise it
+    private: std::string legacy_topic_name_;
+
+    /// \brief gazebo_msgs::CompressedPointCloud topic name (sdf
+    /// <compressedPointCloudTopicName>), empty to not advertise it
+    private: std::string compressed_topic_name_;
+
+    /// \brief Position quantization [m], bzip2 entropy coding and clouds
+    /// encoded at once, the publisher pool threads if not positive (sdf
+    /// <compressedPointCloudResolution>, <compressedPointCloudEntropyCoding>,
+    /// <compressedPointCloudThreads>)
+    private: double compressed_resolution_;
+    private: bool compressed_entropy_;
+    private: int compressed_threads_;
+
+    /// \brief Hand a cloud or packet to compressed_publisher_ if the
+    /// compressed topic has subscribers
+    private: void PushCompressed(const sensor_msgs::PointCloud2ConstPtr &_msg);
+
     /// \brief frame transform name, should match link name
     private: std::string frame_name_;
 
@@ -95,7 +198,7 @@ namespace gazebo
     private: double gaussian_noise_;
 
     /// \brief Gaussian noise generator
-    private: double GaussianKernel(double mu,double sigma);
+    private: GaussianNoise noise_;
 
     /// \brief A mutex to lock access to fields that are used in message callbacks
     private: boost::mutex lock;
@@ -107,14 +210,6 @@ namespace gazebo
     /// update rate of this sensor
     private: double update_rate_;
 
-    /// \brief for setting ROS name space
-    private: std::string robot_namespace_;
-
-    // Custom Callback Queue
-    private: ros::CallbackQueue laser_queue_;
-    private: void LaserQueueThread();
-    private: boost::thread callback_laser_queue_thread_;
-
     // subscribe to world stats
     private: transport::NodePtr node_;
     private: common::Time sim_time_;
@@ -46,10 +46,21 @@
 #include <gazebo/sensors/SensorTypes.hh>
 #include <gazebo/sensors/ContactSensor.hh>
 #include <gazebo/common/Plugin.hh>
+#include <gazebo_plugins/shared_callback_executor.h>
 
 namespace gazebo
 {
   /// \brief A Bumper controller
+  ///
+  /// Publishes the contacts of a contact sensor as gazebo_msgs/ContactsState,
+  /// one state per contact between two collisions. The message is reused
+  /// from update to update. Options for contact heavy scenes:
+  /// - <aggregateContacts>: publish one state per collision pair with only
+  ///   its total wrench, without the contact points (default false).
+  /// - <contactPointStride>: report only every Nth contact point of a
+  ///   contact, the total wrench still sums all of them (default 1).
+  /// - <contactInfo>: fill the debug info string of each state (default
+  ///   true).
   class GazeboRosBumper : public SensorPlugin
   {
     /// Constructor
@@ -82,9 +93,16 @@ namespace gazebo
     /// \brief for setting ROS name space
     private: std::string robot_namespace_;
 
-    private: ros::CallbackQueue contact_queue_;
-    private: void ContactQueueThread();
-    private: boost::thread callback_queue_thread_;
+    /// \brief One state per collision pair, with its total wrench only
+    private: bool aggregate_contacts_;
+
+    /// \brief Report every contact_point_stride_-th contact point
+    private: unsigned int contact_point_stride_;
+
+    /// \brief Fill ContactState::info
+    private: bool contact_info_;
+
+    private: SharedCallbackQueue contact_queue_;
 
     // Pointer to the update event connection
     private: event::ConnectionPtr update_connection_;
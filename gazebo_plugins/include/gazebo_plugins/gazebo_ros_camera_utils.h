@@ -19,6 +19,7 @@
 #define GAZEBO_ROS_CAMERA_UTILS_HH
 
 #include <string>
+#include <vector>
 // boost stuff
 #include <boost/thread.hpp>
 #include <boost/thread/mutex.hpp>
@@ -47,7 +48,13 @@
 #include <gazebo/msgs/MessageTypes.hh>
 #include <gazebo/common/Time.hh>
 #include <gazebo/sensors/SensorTypes.hh>
+#include <gazebo_ros/latency_tracer.h>
 #include <gazebo_plugins/gazebo_ros_utils.h>
+#include <gazebo_plugins/async_image_publisher.h>
+#include <gazebo_plugins/compressed_image_publisher.h>
+#include <gazebo_plugins/image_buffer_pool.h>
+#include <gazebo_plugins/sensor_recorder.h>
+#include <gazebo_plugins/shared_callback_executor.h>
 
 namespace gazebo
 {
@@ -95,6 +102,27 @@ namespace gazebo
     protected: void ImageConnect();
     protected: void ImageDisconnect();
 
+    /// \brief Subscribers of any topic fed by the sensor: images, camera
+    /// infos, and the depth and point cloud topics of the depth cameras.
+    /// Shared by the cameras of a multicamera, guarded by
+    /// image_connect_count_lock_.  The sensor only renders while it is
+    /// positive.
+    protected: boost::shared_ptr<int> sensor_connect_count_;
+    /// \brief Count a subscriber of any topic, activates the sensor on the
+    /// first one.
+    protected: void SensorConnect();
+    /// \brief Uncount a subscriber, deactivates the sensor after the last
+    /// one unless it was active before.
+    protected: void SensorDisconnect();
+    /// \brief SensorConnect() and SensorDisconnect() with
+    /// image_connect_count_lock_ already held.
+    private: void UpdateSensorActivation(int _delta);
+
+    /// \brief Hand the frame buffers to the SensorBufferPool once the
+    /// sensor lost its last subscriber, called with lock_ held.  Derived
+    /// plugins release their own buffers, then call this.
+    protected: virtual void ReleaseBuffers();
+
     /// \brief Keep track when we activate this camera through ros
     /// subscription, was it already active?  resume state when
     /// unsubscribed.
@@ -113,6 +141,123 @@ namespace gazebo
     /// \brief ROS image message
     protected: sensor_msgs::Image image_msg_;
 
+    /// \brief If true (sdf <useImagePool>), PutCameraData() fills a pooled
+    /// sensor_msgs::ImagePtr and publishes it as a const shared pointer
+    /// instead of copying image_msg_ into the publisher, so intra-process
+    /// subscribers get the frame without another copy.
+    protected: bool use_image_pool_;
+
+    /// \brief Recycled frames handed out by PutCameraData() in pooled mode.
+    protected: ImageBufferPoolPtr image_pool_;
+
+    /// \brief Last frame published in pooled mode, guarded by lock_.
+    protected: sensor_msgs::ImageConstPtr last_image_;
+
+    /// \brief If true (sdf <asyncPublish>), PutCameraData() and
+    /// PublishCameraInfo() only queue pooled messages, encoding and
+    /// publishing happen on the shared publisher pool.  Implies
+    /// use_image_pool_.
+    protected: bool async_publish_;
+
+    /// \brief Images queued at most before the oldest is dropped (sdf
+    /// <asyncPublishQueueDepth>).
+    protected: int async_queue_depth_;
+
+    /// \brief Hand-off to the publisher pool in asynchronous mode.
+    protected: boost::shared_ptr<AsyncImagePublisher> async_publisher_;
+
+    /// \brief sensor_msgs/CompressedImage topic encoded on the publisher
+    /// pool (sdf <compressedImageTopicName>), none if empty.  Implies
+    /// use_image_pool_.
+    private: std::string compressed_topic_name_;
+
+    /// \brief jpeg or png (sdf <compressionFormat>)
+    private: std::string compression_format_;
+
+    /// \brief sdf <jpegQuality> and <pngLevel>
+    private: int jpeg_quality_;
+    private: int png_level_;
+
+    /// \brief Frames encoded at once (sdf <compressionThreads>), the
+    /// number of publisher pool threads if not positive.
+    private: int compression_threads_;
+
+    private: ros::Publisher compressed_pub_;
+    private: boost::shared_ptr<CompressedImagePublisher> compressed_publisher_;
+
+    /// \brief Subscribers of compressed_pub_, guarded by
+    /// image_connect_count_lock_.  They activate the sensor but do not count
+    /// as image subscribers.
+    protected: int compressed_connect_count_;
+    private: void CompressedConnect();
+    private: void CompressedDisconnect();
+
+    /// \brief Downscaled copy of the image, level k of the pyramid (sdf
+    /// <pyramidLevels>) halves the resolution of level k - 1.
+    private: struct PyramidLevel
+    {
+      image_transport::Publisher image_pub_;
+      ros::Publisher camera_info_pub_;
+      /// \brief Subscribers of either topic, guarded by
+      /// image_connect_count_lock_
+      int connect_count_;
+      ImageBufferPoolPtr pool_;
+    };
+    private: std::vector<PyramidLevel> pyramid_;
+    private: int pyramid_levels_;
+    private: void PyramidConnect(size_t _level);
+    private: void PyramidDisconnect(size_t _level);
+
+    /// \brief Deepest level with subscribers, 0 if none.
+    private: size_t PyramidDepth() const;
+
+    /// \brief Compute the levels up to PyramidDepth() from _image, each from
+    /// the one above it, and publish those with subscribers.
+    private: void PutPyramid(const sensor_msgs::Image &_image);
+
+    /// \brief Fixed crop of the image (sdf <roi>), published as
+    /// <name>/image_raw with a camera_info whose roi field locates it in
+    /// the full image.
+    private: struct RoiOutput
+    {
+      std::string name_;
+      uint32_t x_offset_;
+      uint32_t y_offset_;
+      uint32_t width_;
+      uint32_t height_;
+      image_transport::Publisher image_pub_;
+      ros::Publisher camera_info_pub_;
+      /// \brief Subscribers of either topic, guarded by
+      /// image_connect_count_lock_
+      int connect_count_;
+      ImageBufferPoolPtr pool_;
+    };
+    private: std::vector<RoiOutput> rois_;
+    private: void RoiConnect(size_t _roi);
+    private: void RoiDisconnect(size_t _roi);
+
+    /// \brief Whether any of rois_ has subscribers.
+    private: bool RoiSubscribed() const;
+
+    /// \brief Copy the subscribed crops out of the rendered frame _src,
+    /// converting them to the output encoding row by row, and publish them.
+    private: void PutRois(const unsigned char *_src, const ros::Time &_stamp);
+
+    /// \brief Whether the image, its compressed copy, a pyramid level or a
+    /// crop has subscribers, i.e. whether PutCameraData() has anything to do.
+    protected: bool ImageSubscribed() const;
+
+    /// \brief Registration with SensorRecorder, which connects to the image
+    /// like a subscriber while the image topic is recorded, -1 if none.
+    private: int recorder_source_;
+
+    /// \brief LatencyTracer id of the image topic
+    private: uint32_t latency_topic_;
+
+    /// \brief Last image put, i.e. last_image_ in pooled mode and image_msg_
+    /// otherwise.  Call with lock_ held.
+    protected: const sensor_msgs::Image &CurrentImage() const;
+
     /// \brief for setting ROS name space
     private: std::string robot_namespace_;
 
@@ -129,13 +274,29 @@ namespace gazebo
     protected: void PublishCameraInfo(ros::Publisher camera_info_publisher);
     protected: void PublishCameraInfo(common::Time &last_update_time);
     protected: void PublishCameraInfo();
-    /// \brief Keep track of number of connctions for CameraInfo
+    /// \brief Drop the cached CameraInfo, the next publish rebuilds it from
+    /// camera_info_manager_.  Call after changing the camera model.
+    protected: void InvalidateCameraInfo();
+    /// \brief Keep track of number of connctions for CameraInfo, which
+    /// activate the sensor but do not count as image subscribers
     private: void InfoConnect();
     private: void InfoDisconnect();
+    private: int info_connect_count_;
     /// \brief camera info
     protected: ros::Publisher camera_info_pub_;
     protected: std::string camera_info_topic_name_;
     protected: common::Time last_info_update_time_;
+    /// \brief CameraInfo published last, reused with only the stamp changed
+    /// while nobody else holds it.  Guarded by camera_info_cache_lock_.
+    private: sensor_msgs::CameraInfoPtr camera_info_cache_;
+    /// \brief When camera_info_cache_ was read from camera_info_manager_.
+    private: ros::WallTime camera_info_cache_time_;
+    private: boost::mutex camera_info_cache_lock_;
+
+    /// \brief camera_info_cache_, refreshed if needed, stamped with
+    /// sensor_update_time_ and safe to change.  Call with
+    /// camera_info_cache_lock_ held.
+    private: sensor_msgs::CameraInfoPtr StampedCameraInfo();
 
     /// \brief ROS frame transform name to use in the image message header.
     ///        This should typically match the link name the sensor is attached.
@@ -170,6 +331,37 @@ namespace gazebo
     protected: std::string type_;
     protected: int skip_;
 
+    /// \brief Encoding of the published images (sdf <outputEncoding>),
+    /// converted from type_ while copying the frame, see image_kernels.
+    /// Same as type_ unless a conversion is set up.
+    private: std::string output_type_;
+
+    /// \brief Bytes per pixel of output_type_
+    private: int output_skip_;
+
+    private: enum OutputConversion
+    {
+      CONVERT_NONE,
+      CONVERT_SWAP_RED_BLUE,
+      CONVERT_MONO,
+      CONVERT_BAYER,
+      CONVERT_EXPAND_16
+    };
+    private: OutputConversion output_conversion_;
+
+    /// \brief Byte of the source pixel kept by even and odd pixels of even
+    /// and odd rows, for CONVERT_BAYER
+    private: int bayer_channel_[2][2];
+
+    /// \brief Choose the conversion from type_ to the requested
+    /// output_type_, call once type_ is known.
+    private: void InitOutputConversion();
+
+    /// \brief Copy frame _src into _image, converted to output_type_ in the
+    /// same pass.
+    private: void FillOutputImage(sensor_msgs::Image &_image,
+                                  const unsigned char *_src);
+
     private: ros::Subscriber cameraHFOVSubscriber_;
     private: ros::Subscriber cameraUpdateRateSubscriber_;
 
@@ -181,9 +373,7 @@ namespace gazebo
     void configCallback(gazebo_plugins::GazeboRosCameraConfig &config,
       uint32_t level);
 
-    protected: ros::CallbackQueue camera_queue_;
-    protected: void CameraQueueThread();
-    protected: boost::thread callback_queue_thread_;
+    protected: SharedCallbackQueue camera_queue_;
 
 
     // copied from CameraPlugin
@@ -206,7 +396,7 @@ namespace gazebo
     // deferred load in case ros is blocking
     private: sdf::ElementPtr sdf;
     private: void LoadThread();
-    private: boost::thread deferred_load_thread_;
+    private: DeferredLoad::TaskPtr deferred_load_task_;
     private: event::EventT<void()> load_event_;
 
     // make a trigger function that the child classes can override
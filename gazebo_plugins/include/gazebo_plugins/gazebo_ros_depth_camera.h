@@ -55,11 +55,11 @@
 #include <boost/thread/mutex.hpp>
 
 // camera stuff
-#include <gazebo_plugins/gazebo_ros_camera_utils.h>
+#include <gazebo_plugins/gazebo_ros_depth_camera_utils.h>
 
 namespace gazebo
 {
-  class GazeboRosDepthCamera : public DepthCameraPlugin, GazeboRosCameraUtils
+  class GazeboRosDepthCamera : public DepthCameraPlugin, GazeboRosDepthCameraUtils
   {
     /// \brief Constructor
     /// \param parent The parent entity, must be a Model or a Sensor
@@ -100,18 +100,21 @@ namespace gazebo
     protected: virtual void OnNewNormalsFrame(const float * _normals,
                    unsigned int _width, unsigned int _height,
                    unsigned int _depth, const std::string &_format) override;
-#endif
 
-    /// \brief Put camera data to the ROS topic
-    private: void FillPointdCloud(const float *_src);
+    /// \brief Fill normals_marker_array_ from points_ and _normals.  Call
+    /// with lock_ held.
+    private: void FillNormalsMarker(const float *_normals, unsigned int _count);
+
+    /// \brief Fill normals_cloud_msg_ from points_ and _normals.  Call
+    /// with lock_ held.
+    private: void FillNormalsCloud(const float *_normals, unsigned int _count);
+#endif
 
-    /// \brief push depth image data into ros topic
-    private: void FillDepthImage(const float *_src);
+    /// \brief Keep the unprojected points while normals are subscribed
+    protected: virtual bool KeepPoints() override;
 
-    /// \brief Keep track of number of connctions for point clouds
-    private: int point_cloud_connect_count_;
-    private: void PointCloudConnect();
-    private: void PointCloudDisconnect();
+    /// \brief Release the reflectance and normals buffers too
+    protected: virtual void ReleaseBuffers() override;
 
     /// \brief Keep track of number of connections for reflectance
     private: int reflectance_connect_count_;
@@ -127,41 +130,24 @@ namespace gazebo
     /// \brief Decrease the counter which count the subscribers are connected
     private: void NormalsDisconnect();
 
-    /// \brief Keep track of number of connctions for point clouds
-    private: int depth_image_connect_count_;
-    private: void DepthImageConnect();
-    private: void DepthImageDisconnect();
-    private: common::Time last_depth_image_camera_info_update_time_;
-
-    private: bool FillPointCloudHelper(sensor_msgs::PointCloud2 &point_cloud_msg,
-                                  uint32_t rows_arg, uint32_t cols_arg,
-                                  uint32_t step_arg, void* data_arg);
-
-    private: bool FillDepthImageHelper( sensor_msgs::Image& image_msg,
-                                  uint32_t rows_arg, uint32_t cols_arg,
-                                  uint32_t step_arg, void* data_arg);
-
-    /// \brief A pointer to the ROS node.  A node will be instantiated if it does not exist.
-    private: ros::Publisher point_cloud_pub_;
-    private: ros::Publisher depth_image_pub_;
     private: ros::Publisher reflectance_pub_;
     private: ros::Publisher normal_pub_;
 
-    /// \brief PointCloud2 point cloud message
-    private: sensor_msgs::PointCloud2 point_cloud_msg_;
-    private: sensor_msgs::Image depth_image_msg_;
     private: sensor_msgs::Image reflectance_msg_;
 
-    /// \brief copy of the pointcloud data, used to place normals in the world
-    private: float * pcd_ = nullptr;
+    /// \brief publish every reduce_normals_-th normal
+    private: int reduce_normals_;
 
-    private: double point_cloud_cutoff_;
+    /// \brief Publish the normals as a PointCloud2 with normal_x/y/z fields
+    /// instead of a LINE_LIST marker (sdf <normalsFormat>cloud)
+    private: bool normals_as_cloud_;
 
-    /// \brief adding one value each reduce_normals_ to the array marker
-    private: int reduce_normals_;
+    /// \brief Length of the marker lines [m]
+    private: double normals_length_;
 
-    /// \brief ROS image topic name
-    private: std::string point_cloud_topic_name_;
+    /// \brief Normals messages, reused from frame to frame
+    private: visualization_msgs::MarkerArray normals_marker_array_;
+    private: sensor_msgs::PointCloud2 normals_cloud_msg_;
 
     /// \brief ROS reflectance topic name
     private: std::string reflectance_topic_name_;
@@ -169,24 +155,6 @@ namespace gazebo
     /// \brief ROS normals topic name
     private: std::string normals_topic_name_;
 
-    private: void InfoConnect();
-    private: void InfoDisconnect();
-
-    using GazeboRosCameraUtils::PublishCameraInfo;
-    protected: virtual void PublishCameraInfo();
-
-    /// \brief image where each pixel contains the depth information
-    private: std::string depth_image_topic_name_;
-    private: std::string depth_image_camera_info_topic_name_;
-    private: int depth_info_connect_count_;
-    private: void DepthInfoConnect();
-    private: void DepthInfoDisconnect();
-    private: bool use_depth_image_16UC1_format_;
-
-    // overload with our own
-    private: common::Time depth_sensor_update_time_;
-    protected: ros::Publisher depth_image_camera_info_pub_;
-
     private: event::ConnectionPtr load_connection_;
   };
 
@@ -0,0 +1,228 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GAZEBO_ROS_DEPTH_CAMERA_UTILS_HH
+#define GAZEBO_ROS_DEPTH_CAMERA_UTILS_HH
+
+#include <string>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+// ros stuff
+#include <ros/ros.h>
+#include <ros/advertise_options.h>
+
+// ros messages stuff
+#include <sensor_msgs/PointCloud2.h>
+#include <sensor_msgs/Image.h>
+#include <sensor_msgs/CameraInfo.h>
+#include <sensor_msgs/CompressedImage.h>
+#include <stereo_msgs/DisparityImage.h>
+
+// gazebo stuff
+#include <sdf/sdf.hh>
+#include <gazebo/common/Time.hh>
+
+// camera stuff
+#include <gazebo_plugins/gazebo_ros_camera_utils.h>
+#include <gazebo_plugins/compressed_point_cloud_publisher.h>
+#include <gazebo_plugins/depth_ray_lut.h>
+#include <gazebo_plugins/depth_image_kernels.h>
+#include <gazebo_plugins/sensor_lod.h>
+
+namespace gazebo
+{
+  /// \brief Outputs shared by the depth camera plugins: point cloud,
+  /// compressed point cloud, depth image, RVL compressed depth image, depth
+  /// camera info and disparity image.
+  ///
+  /// Each output is only computed while it has subscribers.  The outputs of
+  /// one depth frame are computed in a single pass over its rows, so a row
+  /// is clipped and unprojected once for all of them.
+  class GazeboRosDepthCameraUtils : public GazeboRosCameraUtils
+  {
+    /// \brief Constructor
+    public: GazeboRosDepthCameraUtils();
+
+    /// \brief Destructor
+    public: ~GazeboRosDepthCameraUtils();
+
+    /// \brief Read the depth outputs' SDF parameters, call before
+    /// GazeboRosCameraUtils::Load.
+    /// \param[in] _sdf SDF values
+    /// \param[in] _cutoff_max Default of <pointCloudCutoffMax>
+    protected: void LoadDepth(sdf::ElementPtr _sdf, double _cutoff_max);
+
+    /// \brief Advertise point cloud, compressed point cloud, depth image,
+    /// compressed depth image, depth camera info and disparity, call from
+    /// the OnLoad callback.
+    protected: void AdvertiseDepth();
+
+    /// \brief Whether anybody subscribes to an output of PutDepthData().
+    protected: bool DepthSubscribed() const;
+
+    /// \brief Compute and publish every output of the depth frame _src
+    /// that has subscribers, stamped with depth_sensor_update_time_.
+    protected: void PutDepthData(const float *_src);
+
+    /// \brief Whether PutDepthData() should also fill points_, e.g. for
+    /// placing normals.  Default false.
+    protected: virtual bool KeepPoints();
+
+    /// \brief Release the depth outputs' buffers and the image buffers
+    protected: virtual void ReleaseBuffers() override;
+
+    using GazeboRosCameraUtils::PublishCameraInfo;
+    /// \brief Publish the camera info and the depth camera info
+    protected: virtual void PublishCameraInfo();
+
+    /// \brief Keep track of number of connections for point clouds
+    protected: int point_cloud_connect_count_;
+    private: void PointCloudConnect();
+    private: void PointCloudDisconnect();
+
+    /// \brief Keep track of number of connections for depth images
+    protected: int depth_image_connect_count_;
+    private: void DepthImageConnect();
+    private: void DepthImageDisconnect();
+
+    /// \brief Keep track of number of connections for depth camera info
+    protected: int depth_info_connect_count_;
+    private: void DepthInfoConnect();
+    private: void DepthInfoDisconnect();
+
+    /// \brief Keep track of number of connections for disparity images
+    protected: int disparity_connect_count_;
+    private: void DisparityConnect();
+    private: void DisparityDisconnect();
+
+    /// \brief Keep track of number of connections for compressed depth
+    protected: int compressed_depth_connect_count_;
+    private: void CompressedDepthConnect();
+    private: void CompressedDepthDisconnect();
+
+    /// \brief Keep track of number of connections for compressed point
+    /// clouds.  They need the point cloud computed, but not published.
+    protected: int compressed_point_cloud_connect_count_;
+    private: void CompressedPointCloudConnect();
+    private: void CompressedPointCloudDisconnect();
+
+    /// \brief Whether a point cloud is needed, raw or compressed.
+    protected: bool PointCloudSubscribed() const;
+
+    /// \brief Publish point_cloud_msg_ to the subscribed point cloud
+    /// outputs.
+    protected: void PublishPointCloud();
+
+    protected: ros::Publisher point_cloud_pub_;
+    protected: ros::Publisher depth_image_pub_;
+    protected: ros::Publisher depth_image_camera_info_pub_;
+    protected: ros::Publisher disparity_pub_;
+    protected: ros::Publisher compressed_depth_pub_;
+    protected: ros::Publisher compressed_point_cloud_pub_;
+
+    /// \brief Encodes point_cloud_msg_ on the publisher pool, exists while
+    /// compressed_point_cloud_topic_name_ is set.
+    private: boost::shared_ptr<CompressedPointCloudPublisher>
+        compressed_point_cloud_publisher_;
+
+    /// \brief LatencyTracer ids of the point cloud and depth image topics
+    protected: uint32_t point_cloud_latency_topic_;
+    protected: uint32_t depth_image_latency_topic_;
+
+    /// \brief PointCloud2 point cloud message
+    protected: sensor_msgs::PointCloud2 point_cloud_msg_;
+    protected: sensor_msgs::Image depth_image_msg_;
+    protected: stereo_msgs::DisparityImage disparity_msg_;
+
+    /// \brief Depth in millimetres, RVL coded as the "rvl" format of
+    /// compressed_depth_image_transport, whatever use_depth_image_16UC1_format_
+    protected: sensor_msgs::CompressedImage compressed_depth_msg_;
+
+    /// \brief x, y, z, 0 of each pixel of the last depth frame, z = 0 for
+    /// invalid points.  Only filled while KeepPoints().
+    protected: std::vector<float> points_;
+
+    /// \brief Minimum range of the point cloud
+    protected: double point_cloud_cutoff_;
+
+    /// \brief Maximum range of the point cloud
+    protected: double point_cloud_cutoff_max_;
+
+    /// \brief Baseline used for the disparity image [m]
+    protected: double disparity_baseline_;
+
+    /// \brief Publish depth images as 16UC1 instead of 32FC1
+    protected: bool use_depth_image_16UC1_format_;
+
+    /// \brief The point cloud only gets every point_cloud_stride_-th pixel
+    /// of every point_cloud_stride_-th row (sdf <pointCloudStride>)
+    protected: unsigned int point_cloud_stride_;
+
+    /// \brief Extra point cloud decimation set by GazeboRosSensorLod,
+    /// multiplies point_cloud_stride_
+    private: SensorLod::Factor lod_decimation_;
+
+    /// \brief Point cloud region of interest (sdf <pointCloudRoiX>,
+    /// <pointCloudRoiY>, <pointCloudRoiWidth>, <pointCloudRoiHeight>), a
+    /// width or height of 0 extends it to the image border
+    protected: unsigned int point_cloud_roi_x_;
+    protected: unsigned int point_cloud_roi_y_;
+    protected: unsigned int point_cloud_roi_width_;
+    protected: unsigned int point_cloud_roi_height_;
+
+    /// \brief Publish only the valid points, as an unorganized cloud (sdf
+    /// <pointCloudDropNaN>)
+    protected: bool point_cloud_drop_nan_;
+
+    protected: std::string point_cloud_topic_name_;
+    protected: std::string depth_image_topic_name_;
+    protected: std::string depth_image_camera_info_topic_name_;
+    protected: std::string disparity_topic_name_;
+
+    /// \brief sdf <compressedDepthTopicName>, not advertised if empty.  Set
+    /// it to <depthImageTopicName>/compressedDepth for image_transport
+    /// subscribers of the depth image with the compressedDepth transport.
+    protected: std::string compressed_depth_topic_name_;
+
+    /// \brief sdf <compressedPointCloudTopicName> of the
+    /// gazebo_msgs/CompressedPointCloud output, not advertised if empty
+    protected: std::string compressed_point_cloud_topic_name_;
+
+    /// \brief Position quantization [m] (sdf
+    /// <compressedPointCloudResolution>), bzip2 entropy coding (sdf
+    /// <compressedPointCloudEntropyCoding>) and clouds encoded at once,
+    /// the publisher pool threads if not positive (sdf
+    /// <compressedPointCloudThreads>)
+    protected: double compressed_point_cloud_resolution_;
+    protected: bool compressed_point_cloud_entropy_;
+    protected: int compressed_point_cloud_threads_;
+
+    protected: common::Time depth_sensor_update_time_;
+    protected: common::Time last_depth_image_camera_info_update_time_;
+
+    /// \brief Ray slopes of the depth image pixels, see PutDepthData
+    private: DepthRayLUT ray_lut_;
+
+    /// \brief Slopes of the point cloud columns and points per point cloud
+    /// row of a reduced cloud, see PutDepthData
+    private: std::vector<float> cloud_slope_x_;
+    private: std::vector<size_t> cloud_row_points_;
+  };
+}
+#endif
@@ -47,6 +47,7 @@
 #include <gazebo/common/common.hh>
 #include <gazebo/physics/physics.hh>
 #include <gazebo_plugins/gazebo_ros_utils.h>
+#include <gazebo_plugins/gazebo_ros_drive_base.h>
 
 // ROS
 #include <ros/ros.h>
@@ -70,7 +71,7 @@ namespace gazebo {
   class Joint;
   class Entity;
 
-  class GazeboRosDiffDrive : public ModelPlugin {
+  class GazeboRosDiffDrive : public GazeboRosDriveBase {
 
     enum OdomSource
     {
@@ -88,16 +89,15 @@ namespace gazebo {
       virtual void FiniChild();
 
     private:
-      void publishOdometry(double step_time);
       void getWheelVelocities();
-      void publishWheelTF(); /// publishes the wheel tf's
-      void publishWheelJointState();
-      void UpdateOdometryEncoder();
+      void publishWheelTF(const ros::Time &current_time); /// queues the wheel tf's
+      void LoadThread(); /// advertises, subscribes and connects the update, maybe deferred
 
 
       GazeboRosPtr gazebo_ros_;
       physics::ModelPtr parent;
       event::ConnectionPtr update_connection_;
+      DeferredLoad::TaskPtr deferred_load_task_;
 
       double wheel_separation_;
       double wheel_diameter_;
@@ -107,34 +107,19 @@ namespace gazebo {
       double wheel_speed_instr_[2];
 
       std::vector<physics::JointPtr> joints_;
+      std::string wheel_frames_[2];
+      std::string wheel_parent_frames_[2];
 
       // ROS STUFF
-      ros::Publisher odometry_publisher_;
-      ros::Subscriber cmd_vel_subscriber_;
-      boost::shared_ptr<tf::TransformBroadcaster> transform_broadcaster_;
-      sensor_msgs::JointState joint_state_;
-      ros::Publisher joint_state_publisher_;
-      nav_msgs::Odometry odom_;
       std::string tf_prefix_;
 
-      boost::mutex lock;
-
       std::string robot_namespace_;
       std::string command_topic_;
       std::string odometry_topic_;
       std::string odometry_frame_;
       std::string robot_base_frame_;
       bool publish_tf_;
-      // Custom Callback Queue
-      ros::CallbackQueue queue_;
-      boost::thread callback_queue_thread_;
-      void QueueThread();
-
-      // DiffDrive stuff
-      void cmdVelCallback(const geometry_msgs::Twist::ConstPtr& cmd_msg);
 
-      double x_;
-      double rot_;
       bool alive_;
 
       // Update Rate
@@ -143,8 +128,6 @@ namespace gazebo {
       common::Time last_update_time_;
 
       OdomSource odom_source_;
-      geometry_msgs::Pose2D pose_encoder_;
-      common::Time last_odom_update_;
 
     // Flags
     bool publishWheelTF_;
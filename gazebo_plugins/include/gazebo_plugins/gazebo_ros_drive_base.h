@@ -0,0 +1,225 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GAZEBO_ROS_DRIVE_BASE_HH
+#define GAZEBO_ROS_DRIVE_BASE_HH
+
+#include <string>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include <gazebo/common/common.hh>
+#include <gazebo/physics/physics.hh>
+#include <ignition/math/Pose3.hh>
+#include <ignition/math/Vector3.hh>
+
+#include <ros/ros.h>
+#include <tf/transform_broadcaster.h>
+#include <geometry_msgs/Pose2D.h>
+#include <geometry_msgs/Twist.h>
+#include <nav_msgs/Odometry.h>
+#include <sensor_msgs/JointState.h>
+
+#include <gazebo_plugins/command_mailbox.h>
+#include <gazebo_plugins/deferred_load.h>
+#include <gazebo_plugins/shared_callback_executor.h>
+
+namespace gazebo
+{
+  /// \brief Common part of the mobile base plugins (diff drive, skid steer,
+  /// tricycle drive and planar move).
+  ///
+  /// It owns the velocity command subscription, which is served by the
+  /// shared callback executor and hands the command to the world update
+  /// through a CommandMailbox, and the odometry, joint state and tf
+  /// output. The messages are set up once at load: frame ids, joint names
+  /// and covariances are not touched again, and each update only writes
+  /// the values that change. The transforms of an update are collected and
+  /// sent as one tf message by publishTF(). While a
+  /// GazeboRosOdometryAggregator has subscribers, the odometry is also
+  /// submitted to the OdometryAggregator of the world.
+  ///
+  /// A drive plugin parses its own SDF parameters, calls loadDrive() once
+  /// the ROS node exists, and then only provides its wheel kinematics.
+  /// With <deferredLoad>true</deferredLoad>, it does so from a DeferredLoad
+  /// task.
+  class GazeboRosDriveBase : public ModelPlugin
+  {
+    /// \brief Constructor
+    public: GazeboRosDriveBase();
+
+    /// \brief Destructor
+    public: virtual ~GazeboRosDriveBase();
+
+    /// \brief Subscribe to the velocity command and advertise odometry.
+    /// \param[in] _model Model that is driven.
+    /// \param[in] _node Node handle of the plugin namespace.
+    /// \param[in] _command_topic Velocity command topic, usually cmd_vel.
+    /// \param[in] _odometry_topic Odometry topic, empty to not publish
+    /// odometry.
+    /// \param[in] _odom_frame Resolved odometry frame id.
+    /// \param[in] _base_frame Resolved robot base frame id.
+    protected: void loadDrive(physics::ModelPtr _model,
+                              ros::NodeHandle &_node,
+                              const std::string &_command_topic,
+                              const std::string &_odometry_topic,
+                              const std::string &_odom_frame,
+                              const std::string &_base_frame);
+
+    /// \brief Stop serving callbacks and shut the node down.
+    /// \param[in] _node Node handle passed to loadDrive().
+    protected: void finiDrive(ros::NodeHandle &_node);
+
+    /// \brief Give up on a command older than _timeout seconds, and drive
+    /// with a zero command until the next one. Disabled if negative.
+    protected: void setCommandTimeout(double _timeout);
+
+    /// \brief Take the <transportHints> of the command subscription from
+    /// the plugin sdf, see GetSubscriptionHints().  Call before loadDrive().
+    protected: void setTransportHints(sdf::ElementPtr _sdf);
+
+    /// \brief Latest velocity command, or zero if it timed out.  Call from
+    /// the world update only.
+    protected: geometry_msgs::Twist command();
+
+    /// \brief Forget the latest velocity command.  Call from the world
+    /// update, or before loadDrive().
+    protected: void resetCommand();
+
+    /// \brief Set the diagonal of the odometry pose covariance, and of the
+    /// twist covariance if _twist is true. z, roll and pitch are unknown.
+    protected: void setOdometryCovariance(double _x, double _y, double _yaw,
+                                          bool _twist);
+
+    /// \brief Set the odometry from the world pose and velocity of the
+    /// model, with the velocity in the base frame.
+    protected: void setOdometryFromWorld();
+
+    /// \brief Set the odometry pose.
+    protected: void setOdometryPose(const ignition::math::Pose3d &_pose);
+
+    /// \brief Set the odometry twist from a velocity in the odometry frame.
+    /// \param[in] _yaw Heading of the base.
+    /// \param[in] _linear Linear velocity in the odometry frame.
+    /// \param[in] _angular_z Yaw rate.
+    protected: void setOdometryVelocity(double _yaw,
+                                        const ignition::math::Vector3d &_linear,
+                                        double _angular_z);
+
+    /// \brief Integrate the encoders of a differential base into the
+    /// odometry, over the simulation time since the last call.
+    /// \param[in] _vl Surface speed of the left wheel [m/s].
+    /// \param[in] _vr Surface speed of the right wheel [m/s].
+    /// \param[in] _separation Distance between the wheels [m].
+    protected: void integrateEncoder(double _vl, double _vr,
+                                     double _separation);
+
+    /// \brief Restart encoder integration at the origin.
+    protected: void resetEncoder();
+
+    /// \brief Publish the odometry message.
+    /// \param[in] _stamp Time stamp of the message.
+    /// \param[in] _tf Also queue the odometry transform for publishTF().
+    protected: void publishOdometry(const ros::Time &_stamp, bool _tf);
+
+    /// \brief Queue the pose of a link relative to its parent link for
+    /// publishTF().
+    protected: void addLinkTF(const physics::LinkPtr &_link,
+                              const std::string &_parent_frame,
+                              const std::string &_child_frame,
+                              const ros::Time &_stamp);
+
+    /// \brief Send the queued transforms as one tf message.
+    protected: void publishTF();
+
+    /// \brief Advertise joint_states for the given joints.
+    /// \param[in] _node Node handle of the plugin namespace.
+    /// \param[in] _joints Joints to publish, in order.
+    /// \param[in] _velocity_effort Publish velocity and effort as well as
+    /// position.
+    protected: void advertiseJointStates(ros::NodeHandle &_node,
+                   const std::vector<physics::JointPtr> &_joints,
+                   bool _velocity_effort);
+
+    /// \brief Publish the state of the joints passed to
+    /// advertiseJointStates().
+    protected: void publishJointStates(const ros::Time &_stamp);
+
+    /// \brief Velocity command callback.
+    private: void cmdVelCallback(const geometry_msgs::Twist::ConstPtr &_msg);
+
+    /// \brief Model that is driven.
+    protected: physics::ModelPtr drive_model_;
+
+    /// \brief Odometry message, published by publishOdometry().
+    protected: nav_msgs::Odometry odom_;
+
+    /// \brief Pose integrated by integrateEncoder().
+    protected: geometry_msgs::Pose2D pose_encoder_;
+
+    /// \brief Callback queue of the command subscription, served by the
+    /// shared callback executor.
+    protected: SharedCallbackQueue queue_;
+
+    /// \brief Velocity command subscriber.
+    private: ros::Subscriber cmd_vel_subscriber_;
+
+    /// \brief Plugin sdf holding the <transportHints>, may be null.
+    private: sdf::ElementPtr transport_hints_sdf_;
+
+    /// \brief Odometry publisher.
+    private: ros::Publisher odometry_publisher_;
+
+    /// \brief Joint state publisher.
+    private: ros::Publisher joint_state_publisher_;
+
+    /// \brief Joint state message, sized and named at advertise time.
+    private: sensor_msgs::JointState joint_state_;
+
+    /// \brief Joints of joint_state_.
+    private: std::vector<physics::JointPtr> joint_state_joints_;
+
+    /// \brief Broadcaster of the queued transforms.
+    private: boost::shared_ptr<tf::TransformBroadcaster>
+             transform_broadcaster_;
+
+    /// \brief Transforms queued for publishTF().
+    private: std::vector<tf::StampedTransform> transforms_;
+
+    /// \brief Velocity command (linear x, y, z, angular x, y, z) and its
+    /// reception time in seconds, written by cmdVelCallback().
+    private: CommandMailbox<7> cmd_mailbox_;
+
+    /// \brief Latest velocity command read from cmd_mailbox_.
+    private: geometry_msgs::Twist cmd_;
+
+    /// \brief Reception time of cmd_.
+    private: ros::Time last_cmd_time_;
+
+    /// \brief Command timeout [s], disabled if negative.
+    private: double cmd_timeout_;
+
+    /// \brief Simulation time of the last integrateEncoder() call.
+    private: common::Time last_encoder_update_;
+
+    /// \brief Slot in the OdometryAggregator, -1 until the first
+    /// submission.
+    private: int aggregator_slot_;
+  };
+}
+#endif
@@ -28,6 +28,7 @@
 #include <std_msgs/String.h>
 #include <ros/callback_queue.h>
 #include <ros/advertise_options.h>
+#include <gazebo_plugins/shared_callback_executor.h>
 
 namespace gazebo
 {
@@ -49,9 +50,6 @@ namespace gazebo
     /// \param[in] _msg The string message that contains a command.
     public: void OnElevator(const std_msgs::String::ConstPtr &_msg);
 
-    /// \brief Queu to handle callbacks.
-    private: void QueueThread();
-
     /// \brief for setting ROS name space
     private: std::string robotNamespace_;
 
@@ -62,10 +60,7 @@ namespace gazebo
     private: ros::Subscriber elevatorSub_;
 
     /// \brief Custom Callback Queue
-    private: ros::CallbackQueue queue_;
-
-    // \brief Custom Callback Queue thread
-    private: boost::thread callbackQueueThread_;
+    private: SharedCallbackQueue queue_;
   };
 }
 #endif
@@ -36,6 +36,8 @@
 #include <boost/thread.hpp>
 #include <boost/thread/mutex.hpp>
 #include <geometry_msgs/WrenchStamped.h>
+#include <gazebo_plugins/shared_callback_executor.h>
+#include <gazebo_plugins/wrench_filter.h>
 
 namespace gazebo
 {
@@ -86,15 +88,22 @@ class GazeboRosF3D : public ModelPlugin
   /// \brief A mutex to lock access to fields that are used in message callbacks
   private: boost::mutex lock_;
 
+  /// \brief save last_time
+  private: common::Time last_time_;
+
+  /// \brief Publish rate, 0 for every step
+  private: double update_rate_;
+
+  /// \brief Filter of the wrench between two messages
+  private: WrenchFilter filter_;
+
   /// \brief: keep track of number of connections
   private: int f3d_connect_count_;
   private: void F3DConnect();
   private: void F3DDisconnect();
 
   // Custom Callback Queue
-  private: ros::CallbackQueue queue_;
-  private: void QueueThread();
-  private: boost::thread callback_queue_thread_;
+  private: SharedCallbackQueue queue_;
 
   // Pointer to the update event connection
   private: event::ConnectionPtr update_connection_;
@@ -32,12 +32,13 @@
 
 #include <ros/ros.h>
 #include <boost/thread.hpp>
-#include <boost/thread/mutex.hpp>
 
 #include <gazebo/physics/physics.hh>
 #include <gazebo/transport/TransportTypes.hh>
 #include <gazebo/common/Plugin.hh>
 #include <gazebo/common/Events.hh>
+#include <gazebo_plugins/command_mailbox.h>
+#include <gazebo_plugins/shared_callback_executor.h>
 
 
 namespace gazebo
@@ -86,9 +87,6 @@ class GazeboRosForce : public ModelPlugin
   /// \param[in] _msg The Incoming ROS message representing the new force to exert.
   private: void UpdateObjectForce(const geometry_msgs::Wrench::ConstPtr& _msg);
 
-  /// \brief The custom callback queue thread function.
-  private: void QueueThread();
-
   /// \brief A pointer to the gazebo world.
   private: physics::WorldPtr world_;
 
@@ -99,9 +97,6 @@ class GazeboRosForce : public ModelPlugin
   private: ros::NodeHandle* rosnode_;
   private: ros::Subscriber sub_;
 
-  /// \brief A mutex to lock access to fields that are used in ROS message callbacks
-  private: boost::mutex lock_;
-
   /// \brief ROS Wrench topic name inputs
   private: std::string topic_name_;
   /// \brief The Link this plugin is attached to, and will exert forces on.
@@ -111,11 +106,14 @@ class GazeboRosForce : public ModelPlugin
   private: std::string robot_namespace_;
 
   // Custom Callback Queue
-  private: ros::CallbackQueue queue_;
-  /// \brief Thead object for the running callback Thread.
-  private: boost::thread callback_queue_thread_;
-  /// \brief Container for the wrench force that this plugin exerts on the body.
-  private: geometry_msgs::Wrench wrench_msg_;
+  private: SharedCallbackQueue queue_;
+  /// \brief Wrench (force x, y, z, torque x, y, z) written by
+  /// UpdateObjectForce().
+  private: CommandMailbox<6> wrench_mailbox_;
+
+  /// \brief The wrench this plugin exerts on the body.
+  private: ignition::math::Vector3d force_;
+  private: ignition::math::Vector3d torque_;
 
   // Pointer to the update event connection
   private: event::ConnectionPtr update_connection_;
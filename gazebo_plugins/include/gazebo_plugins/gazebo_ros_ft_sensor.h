@@ -36,6 +36,9 @@
 #include <boost/thread.hpp>
 #include <boost/thread/mutex.hpp>
 #include <geometry_msgs/WrenchStamped.h>
+#include <gazebo_plugins/shared_callback_executor.h>
+#include <gazebo_plugins/gazebo_ros_noise.h>
+#include <gazebo_plugins/wrench_filter.h>
 
 namespace gazebo
 {
@@ -62,6 +65,9 @@ Example Usage:
 <updateRate>100.0</updateRate>
 <topicName>ft_sensor_topic</topicName>
 <jointName>JOINT_NAME</jointName>
+<!-- optional: sample every step, publish the mean at updateRate -->
+<filterType>mean</filterType>
+<rawTopicName>ft_sensor_raw</rawTopicName>
 </plugin>
 </gazebo>
 \endverbatim
@@ -90,7 +96,7 @@ class GazeboRosFT : public ModelPlugin
   private: double gaussian_noise_;
 
   /// \brief Gaussian noise generator
-  private: double GaussianKernel(double mu, double sigma);
+  private: GaussianNoise noise_;
 
   /// \brief A pointer to the Gazebo joint
   private: physics::JointPtr joint_;
@@ -136,15 +142,16 @@ class GazeboRosFT : public ModelPlugin
   // rate control
   private: double update_rate_;
 
+  /// \brief Filter of the wrench between two messages
+  private: WrenchFilter filter_;
+
   /// \brief: keep track of number of connections
   private: int ft_connect_count_;
   private: void FTConnect();
   private: void FTDisconnect();
 
   // Custom Callback Queue
-  private: ros::CallbackQueue queue_;
-  private: void QueueThread();
-  private: boost::thread callback_queue_thread_;
+  private: SharedCallbackQueue queue_;
 
   // Pointer to the update event connection
   private: event::ConnectionPtr update_connection_;
@@ -20,29 +20,22 @@
 
 #include <string>
 
-#include <boost/bind.hpp>
-#include <boost/thread.hpp>
-
-#include <ros/ros.h>
-#include <ros/advertise_options.h>
 #include <sensor_msgs/LaserScan.h>
+#include <sensor_msgs/PointCloud2.h>
 
-#include <gazebo/physics/physics.hh>
 #include <gazebo/transport/TransportTypes.hh>
 #include <gazebo/msgs/MessageTypes.hh>
-#include <gazebo/common/Time.hh>
-#include <gazebo/common/Plugin.hh>
-#include <gazebo/common/Events.hh>
-#include <gazebo/sensors/SensorTypes.hh>
+#include <gazebo/sensors/GpuRaySensor.hh>
 #include <gazebo/plugins/GpuRayPlugin.hh>
 
-#include <sdf/sdf.hh>
-
-#include <gazebo_plugins/PubQueue.h>
+#include <gazebo_plugins/gazebo_ros_sensor_plugin.h>
+#include <gazebo_plugins/laser_scan_projector.h>
 
 namespace gazebo
 {
-  class GazeboRosLaser : public GpuRayPlugin
+  class GazeboRosLaser : public GazeboRosSensorPlugin<GazeboRosLaser,
+                                                      GpuRayPlugin,
+                                                      sensors::GpuRaySensor>
   {
     /// \brief Constructor
     public: GazeboRosLaser();
@@ -50,25 +43,31 @@ namespace gazebo
     /// \brief Destructor
     public: ~GazeboRosLaser();
 
-    /// \brief Load the plugin
-    /// \param take in SDF root element
-    public: void Load(sensors::SensorPtr _parent, sdf::ElementPtr _sdf);
+    /// \brief Read the plugin parameters
+    private: bool LoadSdf(sdf::ElementPtr _sdf);
+
+    /// \brief Advertise the scan and point cloud topics
+    private: void LoadRos();
+
+    /// \brief Subscribe to the scans of the sensor on the first subscriber
+    private: void Activate();
+
+    /// \brief Unsubscribe after the last subscriber left
+    private: void Deactivate();
+
+    private: friend SensorPluginBase;
 
-    /// \brief Keep track of number of connctions
-    private: int laser_connect_count_;
-    private: void LaserConnect();
-    private: void LaserDisconnect();
+    private: SensorPublication<sensor_msgs::LaserScan>::Ptr scan_pub_;
 
-    // Pointer to the model
-    private: std::string world_name_;
-    private: physics::WorldPtr world_;
-    /// \brief The parent sensor
-    private: sensors::GpuRaySensorPtr parent_ray_sensor_;
+    /// \brief Optional point cloud of the scan in the laser frame
+    private: SensorPublication<sensor_msgs::PointCloud2>::Ptr cloud_pub_;
+    private: LaserScanProjector projector_;
 
-    /// \brief pointer to ros node
-    private: ros::NodeHandle* rosnode_;
-    private: ros::Publisher pub_;
-    private: PubQueue<sensor_msgs::LaserScan>::Ptr pub_queue_;
+    /// \brief Whether and how the intensities are published
+    private: LaserIntensity intensity_;
+
+    /// \brief point cloud topic name, empty to not advertise it
+    private: std::string cloud_topic_name_;
 
     /// \brief topic name
     private: std::string topic_name_;
@@ -76,23 +75,9 @@ namespace gazebo
     /// \brief frame transform name, should match link name
     private: std::string frame_name_;
 
-    /// \brief tf prefix
-    private: std::string tf_prefix_;
-
-    /// \brief for setting ROS name space
-    private: std::string robot_namespace_;
-
-    // deferred load in case ros is blocking
-    private: sdf::ElementPtr sdf;
-    private: void LoadThread();
-    private: boost::thread deferred_load_thread_;
-
     private: gazebo::transport::NodePtr gazebo_node_;
     private: gazebo::transport::SubscriberPtr laser_scan_sub_;
     private: void OnScan(ConstLaserScanStampedPtr &_msg);
-
-    /// \brief prevents blocking
-    private: PubMultiQueue pmq;
   };
 }
 #endif
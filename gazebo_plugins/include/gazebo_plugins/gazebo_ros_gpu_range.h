@@ -0,0 +1,86 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GAZEBO_ROS_GPU_RANGE_HH
+#define GAZEBO_ROS_GPU_RANGE_HH
+
+#include <string>
+
+#include <sensor_msgs/Range.h>
+
+#include <gazebo/common/Time.hh>
+#include <gazebo/transport/TransportTypes.hh>
+#include <gazebo/msgs/MessageTypes.hh>
+#include <gazebo/sensors/GpuRaySensor.hh>
+#include <gazebo/plugins/GpuRayPlugin.hh>
+
+#include <gazebo_plugins/gazebo_ros_sensor_plugin.h>
+#include <gazebo_plugins/range_cone.h>
+
+namespace gazebo
+{
+  /// \brief gazebo_ros_range on a gpu_ray sensor: the cone of rays is
+  /// rendered instead of ray cast by the physics engine, which is much
+  /// cheaper for dense cones or many sensors.  Takes the same parameters
+  /// as gazebo_ros_range.
+  class GazeboRosGpuRange : public GazeboRosSensorPlugin<GazeboRosGpuRange,
+                                                         GpuRayPlugin,
+                                                         sensors::GpuRaySensor>
+  {
+    /// \brief Constructor
+    public: GazeboRosGpuRange();
+
+    /// \brief Destructor
+    public: ~GazeboRosGpuRange();
+
+    /// \brief Read the plugin parameters
+    private: bool LoadSdf(sdf::ElementPtr _sdf);
+
+    /// \brief Advertise the range topic
+    private: void LoadRos();
+
+    /// \brief Subscribe to the scans of the sensor on the first subscriber
+    private: void Activate();
+
+    /// \brief Unsubscribe after the last subscriber left
+    private: void Deactivate();
+
+    private: friend SensorPluginBase;
+
+    /// \brief Reduce a scan of the cone to a range and publish it
+    private: void OnScan(ConstLaserScanStampedPtr &_msg);
+
+    private: SensorPublication<sensor_msgs::Range>::Ptr range_pub_;
+
+    /// \brief topic name
+    private: std::string topic_name_;
+
+    /// \brief frame transform name, should match link name
+    private: std::string frame_name_;
+
+    /// \brief radiation type, field of view and noise of the messages
+    private: RangeCone cone_;
+
+    /// \brief scans closer than this to the last published one are dropped
+    private: double update_period_;
+    private: common::Time last_update_time_;
+
+    private: gazebo::transport::NodePtr gazebo_node_;
+    private: gazebo::transport::SubscriberPtr laser_scan_sub_;
+  };
+}
+#endif
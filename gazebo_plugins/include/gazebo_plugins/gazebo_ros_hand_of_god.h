@@ -23,7 +23,11 @@
 #ifndef GAZEBO_ROS_TEMPLATE_HH
 #define GAZEBO_ROS_TEMPLATE_HH
 
+#include <string>
+
 #include <ros/ros.h>
+#include <geometry_msgs/PoseStamped.h>
+#include <geometry_msgs/TransformStamped.h>
 
 #include <gazebo/physics/physics.hh>
 #include <gazebo/transport/TransportTypes.hh>
@@ -34,9 +38,21 @@
 #include <tf2_ros/transform_listener.h>
 #include <tf2_ros/transform_broadcaster.h>
 
+#include <gazebo_plugins/command_mailbox.h>
+#include <gazebo_plugins/shared_callback_executor.h>
+
 namespace gazebo
 {
 
+  /// \brief Drives a floating link to a desired pose with a PD law.
+  ///
+  /// The desired pose is the tf frame <frameId>_desired in world, looked
+  /// up at <targetLookupRate> (default 0, every step), or, if
+  /// <targetTopic> is set, the latest geometry_msgs/PoseStamped received
+  /// on it, in world. Topic targets are handed to the physics thread
+  /// through a lock-free slot, so a step costs no tf buffer lock.
+  /// The pose of the link is broadcast as <frameId>_actual at
+  /// <actualTfRate> (default 0, every step).
   class GazeboRosHandOfGod : public ModelPlugin
   {
   /// \brief Constructor
@@ -51,6 +67,16 @@ namespace gazebo
   /// \brief Update the controller
   protected: virtual void GazeboUpdate();
 
+  /// \brief Target topic callback, writes the target slot.
+  private: void OnTarget(const geometry_msgs::PoseStamped::ConstPtr &_msg);
+
+  /// \brief Copy the target slot to hog_desired_ if it changed.
+  private: void ReadTarget();
+
+  /// \brief Look the target up in tf.
+  /// \return False if there is no target.
+  private: bool LookupTarget();
+
   /// Pointer to the update event connection
   private: event::ConnectionPtr update_connection_;
            boost::shared_ptr<tf2_ros::Buffer> tf_buffer_;
@@ -63,6 +89,42 @@ namespace gazebo
            std::string frame_id_;
            double kl_, ka_;
            double cl_, ca_;
+
+  /// \brief ROS node, for the target topic.
+  private: ros::NodeHandle *rosnode_;
+
+  /// \brief Target topic, empty if the target comes from tf.
+  private: std::string target_topic_;
+
+  /// \brief Target subscriber.
+  private: ros::Subscriber target_sub_;
+
+  /// \brief Serves target_sub_.
+  private: SharedCallbackQueue queue_;
+
+  /// \brief Target position and orientation (x, y, z, qw, qx, qy, qz)
+  /// written by OnTarget().
+  private: CommandMailbox<7> target_;
+
+  /// \brief Desired pose of the link.
+  private: ignition::math::Pose3d hog_desired_;
+
+  /// \brief True while hog_desired_ is valid.
+  private: bool has_target_;
+
+  /// \brief True once a failed lookup was reported.
+  private: bool errored_;
+
+  /// \brief tf lookup rate [Hz], 0 for every step.
+  private: double lookup_rate_;
+  private: common::Time last_lookup_time_;
+
+  /// \brief Broadcast rate of the actual pose [Hz], 0 for every step.
+  private: double actual_rate_;
+  private: common::Time last_actual_time_;
+
+  /// \brief Actual pose transform, frames set at load.
+  private: geometry_msgs::TransformStamped hog_actual_tform_;
   };
 
 }
@@ -26,6 +26,7 @@
 #include <std_msgs/Bool.h>
 
 #include <gazebo/plugins/HarnessPlugin.hh>
+#include <gazebo_plugins/shared_callback_executor.h>
 
 namespace gazebo
 {
@@ -59,9 +60,6 @@ class GazeboRosHarness : public HarnessPlugin
     /// true.
     private: virtual void OnDetach(const std_msgs::Bool::ConstPtr &msg);
 
-    /// \brief Custom callback queue thread
-    private: void QueueThread();
-
     /// \brief pointer to ros node
     private: ros::NodeHandle *rosnode_;
 
@@ -73,8 +71,7 @@ class GazeboRosHarness : public HarnessPlugin
 
     /// \brief for setting ROS name space
     private: std::string robotNamespace_;
-    private: ros::CallbackQueue queue_;
-    private: boost::thread callbackQueueThread_;
+    private: SharedCallbackQueue queue_;
 };
 }
 #endif
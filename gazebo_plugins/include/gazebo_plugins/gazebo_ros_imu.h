@@ -33,6 +33,10 @@
 #include <gazebo/common/common.hh>
 
 #include <gazebo_plugins/PubQueue.h>
+#include <gazebo_plugins/shared_callback_executor.h>
+#include <gazebo_plugins/deferred_load.h>
+#include <gazebo_plugins/gazebo_ros_noise.h>
+#include <gazebo_plugins/imu_batch.h>
 
 namespace gazebo
 {
@@ -62,6 +66,9 @@ namespace gazebo
     private: ros::Publisher pub_;
     private: PubQueue<sensor_msgs::Imu>::Ptr pub_Queue;
 
+    /// \brief Batched and decimated output
+    private: ImuBatch batch_;
+
     /// \brief ros message
     private: sensor_msgs::Imu imu_msg_;
 
@@ -98,7 +105,7 @@ namespace gazebo
     private: double gaussian_noise_;
 
     /// \brief Gaussian noise generator
-    private: double GaussianKernel(double mu, double sigma);
+    private: GaussianNoise noise_;
 
     /// \brief for setting ROS name space
     private: std::string robot_namespace_;
@@ -110,9 +117,7 @@ namespace gazebo
     private: ros::ServiceServer srv_;
     private: std::string service_name_;
 
-    private: ros::CallbackQueue imu_queue_;
-    private: void IMUQueueThread();
-    private: boost::thread callback_queue_thread_;
+    private: SharedCallbackQueue imu_queue_;
 
     // Pointer to the update event connection
     private: event::ConnectionPtr update_connection_;
@@ -120,7 +125,7 @@ namespace gazebo
     // deferred load in case ros is blocking
     private: sdf::ElementPtr sdf;
     private: void LoadThread();
-    private: boost::thread deferred_load_thread_;
+    private: DeferredLoad::TaskPtr deferred_load_task_;
 
     // ros publish multi queue, prevents publish() blocking
     private: PubMultiQueue pmq;
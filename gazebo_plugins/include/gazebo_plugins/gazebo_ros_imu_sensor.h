@@ -25,6 +25,10 @@
 #include <sensor_msgs/Imu.h>
 #include <string>
 
+#include <gazebo_plugins/deferred_load.h>
+#include <gazebo_plugins/gazebo_ros_noise.h>
+#include <gazebo_plugins/imu_batch.h>
+
 namespace gazebo
 {
   namespace sensors
@@ -58,17 +62,22 @@ namespace gazebo
   private:
     /// \brief Load the parameters from the sdf file.
     bool LoadParameters();
+    /// \brief Create the node, advertise and connect the update, run by
+    /// DeferredLoad with <deferredLoad>true</deferredLoad>.
+    void LoadThread();
+    /// \brief LoadThread, if deferred.
+    DeferredLoad::TaskPtr deferred_load_task;
     /// \brief Gaussian noise generator.
-    /// \param mu offset value.
-    /// \param sigma scaling value.
-    double GuassianKernel(double mu, double sigma);
-    
+    GaussianNoise noise;
+
     /// \brief Ros NodeHandle pointer.
     ros::NodeHandle* node;
     /// \brief Ros Publisher for imu data.
     ros::Publisher imu_data_publisher;
     /// \brief Ros IMU message.
     sensor_msgs::Imu imu_msg;
+    /// \brief Batched and decimated output.
+    ImuBatch batch;
 
     /// \brief last time on which the data was published.
     common::Time last_time;
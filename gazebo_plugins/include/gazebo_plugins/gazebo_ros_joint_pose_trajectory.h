@@ -28,6 +28,7 @@
 
 #include <boost/thread.hpp>
 #include <boost/thread/mutex.hpp>
+#include <boost/shared_ptr.hpp>
 
 #include <ros/ros.h>
 #include <ros/callback_queue.h>
@@ -47,9 +48,20 @@
 #include <gazebo/common/Time.hh>
 #include <gazebo/common/Plugin.hh>
 #include <gazebo/common/Events.hh>
+#include <gazebo_plugins/shared_callback_executor.h>
+#include <gazebo_plugins/deferred_load.h>
 
 namespace gazebo
 {
+  /// \brief Plays joint trajectories by setting the joint positions.
+  ///
+  /// Point i is applied at the header stamp plus the time_from_start of
+  /// the points before it. A received trajectory is prepared once: its
+  /// joints are resolved and its setpoints are computed, resampled to
+  /// <playbackRate> [Hz] by linear interpolation if that is set (default
+  /// 0, the points as they are). The prepared trajectory replaces the one
+  /// playing in a single pointer swap, and an update applies the latest
+  /// setpoint that is due.
   class GazeboRosJointPoseTrajectory : public ModelPlugin // replaced with GazeboROSJointPoseTrajectory
   {
     /// \brief Constructor
@@ -71,6 +83,48 @@ namespace gazebo
 #endif
     private: void UpdateStates();
 
+    /// \brief A trajectory prepared for playback.
+    private: struct Playback
+    {
+      /// \brief Joints of the trajectory, NULL if not found
+      std::vector<physics::JointPtr> joints;
+
+      /// \brief Model whose pose is kept
+      physics::ModelPtr model;
+
+      /// \brief Link kept stationary, the model root if NULL
+      physics::LinkPtr reference_link;
+
+      /// \brief Simulation time of the first setpoint
+      common::Time start;
+
+      /// \brief Time of each setpoint from start
+      std::vector<common::Time> times;
+
+      /// \brief Joint positions of each setpoint, one row per time
+      std::vector<double> positions;
+
+      /// \brief Time from start when playback ends
+      common::Time end;
+    };
+    private: typedef boost::shared_ptr<const Playback> PlaybackConstPtr;
+
+    /// \brief Set the joints to setpoint _index of _playback.
+    private: void ApplySetpoint(const Playback &_playback, size_t _index);
+
+    /// \brief Trajectory to play, swapped in by SetTrajectory(), guarded by
+    /// update_mutex.
+    private: PlaybackConstPtr playback_;
+
+    /// \brief Trajectory playing, owned by UpdateStates().
+    private: PlaybackConstPtr playing_;
+
+    /// \brief Next setpoint of playing_.
+    private: size_t next_setpoint_;
+
+    /// \brief Resampling rate of the trajectories [Hz], 0 to not resample.
+    private: double playback_rate_;
+
     private: physics::WorldPtr world_;
     private: physics::ModelPtr model_;
 
@@ -112,12 +166,8 @@ namespace gazebo
     /// \brief for setting ROS name space
     private: std::string robot_namespace_;
 
-    private: ros::CallbackQueue queue_;
-    private: void QueueThread();
-    private: boost::thread callback_queue_thread_;
+    private: SharedCallbackQueue queue_;
 
-    private: std::vector<gazebo::physics::JointPtr> joints_;
-    private: std::vector<trajectory_msgs::JointTrajectoryPoint> points_;
 
     // Pointer to the update event connection
     private: event::ConnectionPtr update_connection_;
@@ -127,7 +177,7 @@ namespace gazebo
     // deferred load in case ros is blocking
     private: sdf::ElementPtr sdf;
     private: void LoadThread();
-    private: boost::thread deferred_load_thread_;
+    private: DeferredLoad::TaskPtr deferred_load_task_;
   };
 }
 #endif
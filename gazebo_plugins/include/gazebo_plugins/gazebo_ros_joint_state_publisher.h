@@ -41,6 +41,8 @@
 #include <tf/transform_broadcaster.h>
 #include <sensor_msgs/JointState.h>
 
+#include <gazebo_plugins/message_pool.h>
+
 // Usage in URDF:
 //   <gazebo>
 //       <plugin name="joint_state_publisher" filename="libgazebo_ros_joint_state_publisher.so">
@@ -48,8 +50,17 @@
 // 		<jointName>chassis_swivel_joint, swivel_wheel_joint, left_hub_joint, right_hub_joint</jointName>
 // 		<updateRate>100.0</updateRate>
 // 		<alwaysOn>true</alwaysOn>
+// 		<publishOnChange>false</publishOnChange>
+// 		<changeTolerance>0.0</changeTolerance>
+// 		<useMessagePool>false</useMessagePool>
+// 		<queueSize>1000</queueSize>
 //       </plugin>
 //   </gazebo>
+//
+// With publishOnChange, a state is only published if a position or velocity moved by more
+// than changeTolerance since the last published one, and joint_states is latched.
+// With useMessagePool, states are published as shared pointers from a message pool, which
+// intra-process subscribers receive without serialization.
 
 
 
@@ -70,8 +81,9 @@ private:
 
     // ROS STUFF
     boost::shared_ptr<ros::NodeHandle> rosnode_;
-    sensor_msgs::JointState joint_state_;
+    sensor_msgs::JointState joint_state_;  // sized and named once at load
     ros::Publisher joint_state_publisher_;
+    boost::shared_ptr<MessagePool<sensor_msgs::JointState> > joint_state_pool_;
     std::string tf_prefix_;
     std::string robot_namespace_;
     std::vector<std::string> joint_names_;
@@ -81,6 +93,13 @@ private:
     double update_period_;
     common::Time last_update_time_;
 
+    // Change detection
+    bool publish_on_change_;
+    double change_tolerance_;
+    bool published_once_;
+    std::vector<double> positions_;   // latest reads, swapped into joint_state_ on publish
+    std::vector<double> velocities_;
+
 };
 
 // Register this plugin with the simulator
@@ -0,0 +1,151 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GAZEBO_ROS_KINEMATIC_CROWD_PLUGIN_HH
+#define GAZEBO_ROS_KINEMATIC_CROWD_PLUGIN_HH
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <boost/thread/mutex.hpp>
+
+#include <ros/ros.h>
+#include <gazebo_msgs/AgentVelocities.h>
+#include <gazebo_msgs/ModelStates.h>
+
+#include <gazebo/common/Events.hh>
+#include <gazebo/common/Plugin.hh>
+#include <gazebo/common/Time.hh>
+#include <gazebo/physics/physics.hh>
+
+#include <gazebo_plugins/shared_callback_executor.h>
+
+namespace gazebo
+{
+  /// \brief Moves many simple agents, e.g. pedestrians, kinematically in
+  /// the plane from a single plugin.
+  ///
+  /// Every model whose name starts with <agentPrefix> is an agent, including
+  /// the ones spawned or deleted later.  Agents follow planar velocity
+  /// commands like with gazebo_ros_planar_move, but all of them are
+  /// commanded through one gazebo_msgs/AgentVelocities topic and their
+  /// states are published as one gazebo_msgs/ModelStates, instead of a node
+  /// handle, queue, odometry topic and transform per agent.
+  ///
+  /// Poses and velocities are kept in arrays, one per component, which are
+  /// integrated and then written to the models in one pass at the
+  /// beginning of each world update.  The height, roll and pitch of an agent
+  /// stay as they were when it was found, so agents should be static or
+  /// have gravity disabled.
+  class GazeboRosKinematicCrowd : public WorldPlugin
+  {
+    /// \brief Constructor
+    public: GazeboRosKinematicCrowd();
+
+    /// \brief Destructor
+    public: virtual ~GazeboRosKinematicCrowd();
+
+    /// \brief Load the plugin
+    public: void Load(physics::WorldPtr _world, sdf::ElementPtr _sdf);
+
+    /// \brief Move the agents before the physics step
+    private: void OnWorldUpdate();
+
+    /// \brief A model was added or deleted
+    private: void OnEntityEvent(const std::string &_name);
+
+    /// \brief Keep the latest command for the next world update
+    private: void OnCommand(const gazebo_msgs::AgentVelocities::ConstPtr &_msg);
+
+    /// \brief Rebuild the arrays from the models of the world, keeping the
+    /// state of the agents found before
+    private: void FindAgents();
+
+    /// \brief Copy a command into the velocity arrays
+    private: void ApplyCommand(const gazebo_msgs::AgentVelocities &_msg,
+                               double _now);
+
+    private: void PublishStates();
+
+    private: physics::WorldPtr world_;
+    private: event::ConnectionPtr update_connection_;
+    private: event::ConnectionPtr add_entity_connection_;
+    private: event::ConnectionPtr delete_entity_connection_;
+
+    /// \brief pointer to ros node
+    private: ros::NodeHandle* rosnode_;
+    private: ros::Subscriber sub_;
+    private: ros::Publisher pub_;
+
+    /// \brief Models whose name starts with this are agents
+    private: std::string agent_prefix_;
+
+    /// \brief Set by OnEntityEvent(), both run in the world thread
+    private: bool agents_changed_;
+
+    /// \brief Agents, in the order of the state message
+    private: std::vector<std::string> names_;
+    private: std::vector<physics::ModelPtr> models_;
+    private: std::map<std::string, size_t> index_;
+
+    /// \brief World pose of the agents
+    private: std::vector<double> x_;
+    private: std::vector<double> y_;
+    private: std::vector<double> z_;
+    private: std::vector<double> roll_;
+    private: std::vector<double> pitch_;
+    private: std::vector<double> yaw_;
+
+    /// \brief Commanded velocity of the agents, in their frame
+    private: std::vector<double> vx_;
+    private: std::vector<double> vy_;
+    private: std::vector<double> wz_;
+
+    /// \brief Sim time of the last command of each agent [s]
+    private: std::vector<double> cmd_time_;
+
+    /// \brief Names of the last named command and the agent of each, which
+    /// are reused while the names repeat
+    private: std::vector<std::string> cmd_names_;
+    private: std::vector<size_t> cmd_index_;
+
+    /// \brief Latest command, handed over by OnCommand()
+    private: gazebo_msgs::AgentVelocities::ConstPtr pending_cmd_;
+    private: boost::mutex cmd_lock_;
+
+    /// \brief Agents stop without a command for this long [s], never if
+    /// negative
+    private: double cmd_timeout_;
+
+    /// \brief ros message, reused from cycle to cycle
+    private: gazebo_msgs::ModelStates states_msg_;
+
+    private: common::Time last_update_time_;
+
+    /// update rate of the states, 0 to publish after every update
+    private: double update_rate_;
+    private: double update_period_;
+    private: common::Time last_publish_time_;
+
+    /// \brief for setting ROS name space
+    private: std::string robot_namespace_;
+
+    private: SharedCallbackQueue queue_;
+  };
+}
+#endif
@@ -0,0 +1,131 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GAZEBO_ROS_LINK_WRENCHES_HH
+#define GAZEBO_ROS_LINK_WRENCHES_HH
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include <boost/thread/mutex.hpp>
+
+#include <ros/ros.h>
+#include <gazebo_msgs/LinkWrenches.h>
+
+#include <gazebo/common/Events.hh>
+#include <gazebo/common/Plugin.hh>
+#include <gazebo/physics/physics.hh>
+
+#include <gazebo_ros/plugin_timing.h>
+#include <gazebo_plugins/shared_callback_executor.h>
+
+namespace gazebo
+{
+/// @addtogroup gazebo_dynamic_plugins Gazebo ROS Dynamic Plugins
+/// @{
+/** \defgroup GazeboRosLinkWrenches Plugin XML Reference and Example
+
+  \brief Ros Link Wrenches Plugin.
+
+  Applies the wrenches of a gazebo_msgs/LinkWrenches message to many links
+  of a model, e.g. aerodynamic or buoyancy forces from an external solver,
+  in place of one GazeboRosForce and topic per link.
+
+  The links are numbered in the order of the <link> elements, or in the
+  order of the model's links if there are none; the names are also set as
+  the parameter <topicName>/links.  Like GazeboRosForce, the wrenches of
+  the latest message are applied at every world update until the next
+  message replaces all of them.
+
+  Example Usage:
+  \verbatim
+      <gazebo>
+        <plugin filename="libgazebo_ros_link_wrenches.so" name="gazebo_ros_link_wrenches">
+          <topicName>wing_wrenches</topicName>
+          <link>left_wing</link>
+          <link>right_wing</link>
+        </plugin>
+      </gazebo>
+  \endverbatim
+
+\{
+*/
+
+class GazeboRosLinkWrenches : public ModelPlugin
+{
+  /// \brief Constructor
+  public: GazeboRosLinkWrenches();
+
+  /// \brief Destructor
+  public: virtual ~GazeboRosLinkWrenches();
+
+  // Documentation inherited
+  protected: void Load(physics::ModelPtr _model, sdf::ElementPtr _sdf);
+
+  // Documentation inherited
+  protected: virtual void UpdateChild();
+
+  /// \brief Resolve the links of a message and hand it to UpdateChild()
+  private: void OnWrenches(const gazebo_msgs::LinkWrenches::ConstPtr& _msg);
+
+  /// \brief Wrenches of one message, with their links resolved
+  private: struct Batch
+  {
+    std::vector<physics::Link*> links;
+    std::vector<ignition::math::Vector3d> forces;
+    std::vector<ignition::math::Vector3d> torques;
+    std::vector<uint8_t> relative;
+    /// \brief Steady clock time the message arrived [ns]
+    int64_t stamp;
+  };
+
+  /// \brief The links wrenches can be applied to, by index
+  private: physics::Link_V links_;
+
+  /// \brief Wrenches applied at every update
+  private: Batch active_;
+
+  /// \brief Wrenches of the latest message, not yet applied
+  private: Batch pending_;
+  private: bool pending_ready_;
+  private: boost::mutex lock_;
+
+  /// \brief Time from the arrival of a message to its first update
+  private: TimingStage *latency_;
+
+  /// \brief A pointer to the ROS node.  A node will be instantiated if it does not exist.
+  private: ros::NodeHandle* rosnode_;
+  private: ros::Subscriber sub_;
+
+  /// \brief ROS LinkWrenches topic name inputs
+  private: std::string topic_name_;
+
+  /// \brief for setting ROS name space
+  private: std::string robot_namespace_;
+
+  // Custom Callback Queue
+  private: SharedCallbackQueue queue_;
+
+  // Pointer to the update event connection
+  private: event::ConnectionPtr update_connection_;
+};
+/** \} */
+/// @}
+}
+#endif
@@ -21,12 +21,24 @@
 #include <string>
 #include <vector>
 
+#include <sensor_msgs/Image.h>
+
 // library for processing camera data for gazebo / ros conversions
 #include <gazebo_plugins/gazebo_ros_camera_utils.h>
 #include <gazebo_plugins/MultiCameraPlugin.h>
 
 namespace gazebo
 {
+  /// \brief ROS interface of a left/right multicamera sensor.
+  ///
+  /// By default every camera publishes its frame from its own new frame
+  /// event. With <pairedOutput>pair</pairedOutput>, the frames of one
+  /// sensor update are collected first, and the cameras then convert and
+  /// publish them together, in parallel and with the same stamp, so stereo
+  /// matchers can pair them exactly. <pairedOutput>side_by_side</pairedOutput>
+  /// additionally publishes image_side_by_side in the camera namespace, a
+  /// single frame with the left image on the left, for cameras of equal
+  /// height and encoding.
   class GazeboRosMultiCamera : public MultiCameraPlugin
   {
     /// \brief Constructor
@@ -59,6 +71,55 @@ namespace gazebo
     private: boost::shared_ptr<int> image_connect_count_;
     private: boost::shared_ptr<boost::mutex> image_connect_count_lock_;
     private: boost::shared_ptr<bool> was_active_;
+
+    /// \brief Output modes of <pairedOutput>.
+    private: enum PairedOutput
+    {
+      PAIRED_NONE,
+      PAIRED_PAIR,
+      PAIRED_SIDE_BY_SIDE
+    };
+
+    /// \brief Collect the frame of a camera, and publish the pair once all
+    /// cameras of the update delivered.
+    /// \param[in] _image Frame, valid until the next render of the camera.
+    /// \param[in] _index Index of the camera in utils.
+    private: void OnPairedFrame(const unsigned char *_image, size_t _index);
+
+    /// \brief Publish the collected frames with one stamp.
+    private: void PublishPair(common::Time _stamp);
+
+    /// \brief Fill side_by_side_image_ from the collected frames.
+    /// \return False if the cameras cannot be combined.
+    private: bool FillSideBySide(const common::Time &_stamp);
+
+    /// \brief Side by side subscriber count changes.
+    private: void SideBySideConnect();
+    private: void SideBySideDisconnect();
+
+    /// \brief Output mode.
+    private: PairedOutput paired_output_;
+
+    /// \brief Frames of the current sensor update, by camera.
+    private: std::vector<const unsigned char *> paired_frames_;
+
+    /// \brief Measurement time of paired_frames_.
+    private: common::Time paired_time_;
+
+    /// \brief Node of the side by side output, in the camera namespace.
+    private: boost::shared_ptr<ros::NodeHandle> pair_node_;
+
+    /// \brief Serves the subscriber callbacks of pair_node_.
+    private: SharedCallbackQueue pair_queue_;
+
+    /// \brief Side by side publisher.
+    private: ros::Publisher side_by_side_pub_;
+
+    /// \brief Side by side frame, reused across updates.
+    private: sensor_msgs::Image side_by_side_image_;
+
+    /// \brief True once the cameras were found not to be combinable.
+    private: bool side_by_side_failed_;
   };
 }
 #endif
@@ -0,0 +1,86 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GAZEBO_ROS_NOISE_H
+#define GAZEBO_ROS_NOISE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+#include <sdf/sdf.hh>
+
+namespace gazebo
+{
+  /// \brief Gaussian noise source of one plugin.
+  ///
+  /// Uniform numbers come from a xoshiro256** generator, normals from a
+  /// 128 layer ziggurat, so a sample usually costs one generator step and a
+  /// multiply.  Each plugin owns its generator: there is no shared state and
+  /// no lock, and a given seed always produces the same sequence.
+  ///
+  /// Not thread safe, use one instance per thread.
+  class GaussianNoise
+  {
+    /// \brief Constructor
+    /// \param[in] _seed Seed, see Seed()
+    public: explicit GaussianNoise(uint64_t _seed = 0);
+
+    /// \brief Restart the sequence from _seed
+    public: void Seed(uint64_t _seed);
+
+    /// \brief Seed of a plugin: <noiseSeed> if the plugin sets it, otherwise
+    /// a hash of _scope and the plugin name, so runs are reproducible and
+    /// two plugins never share a sequence.
+    /// \param[in] _sdf The plugin's SDF
+    /// \param[in] _scope Scoped name of the plugin's parent sensor or model
+    public: static uint64_t SeedFromSdf(sdf::ElementPtr _sdf,
+                                        const std::string &_scope);
+
+    /// \brief Standard normal sample
+    public: double Normal();
+
+    /// \brief Normal sample of mean _mu and standard deviation _sigma
+    public: double Gaussian(double _mu, double _sigma)
+    {
+      return _mu + _sigma * this->Normal();
+    }
+
+    /// \brief Uniform sample in (0, 1)
+    public: double Uniform();
+
+    /// \brief Fill _out with _n samples of mean _mu and standard deviation
+    /// _sigma, e.g. the noise of a whole scan.
+    public: void Fill(float *_out, size_t _n, double _mu, double _sigma);
+    public: void Fill(double *_out, size_t _n, double _mu, double _sigma);
+
+    /// \brief Add zero mean noise of standard deviation _sigma to the _n
+    /// values of _data.
+    public: void Add(float *_data, size_t _n, double _sigma);
+    public: void Add(double *_data, size_t _n, double _sigma);
+
+    /// \brief Next 64 random bits
+    private: uint64_t Next();
+
+    /// \brief Sample from the tail of the ziggurat base layer
+    private: double Tail(bool _negative);
+
+    /// \brief Generator state
+    private: uint64_t state_[4];
+  };
+}
+#endif
@@ -0,0 +1,96 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GAZEBO_ROS_ODOMETRY_AGGREGATOR_PLUGIN_HH
+#define GAZEBO_ROS_ODOMETRY_AGGREGATOR_PLUGIN_HH
+
+#include <string>
+
+#include <boost/thread/mutex.hpp>
+
+#include <ros/ros.h>
+#include <gazebo_msgs/OdometryArray.h>
+
+#include <gazebo/common/Events.hh>
+#include <gazebo/common/Plugin.hh>
+#include <gazebo/common/Time.hh>
+#include <gazebo/physics/physics.hh>
+
+#include <gazebo_plugins/shared_callback_executor.h>
+
+namespace gazebo
+{
+  /// \brief Publishes the odometry of all mobile bases of the world as one
+  /// gazebo_msgs/OdometryArray per cycle.
+  ///
+  /// The drive plugins (diff drive, skid steer, tricycle drive and planar
+  /// move) keep publishing their own odometry topics; while someone
+  /// subscribes to the array they also submit their odometry to
+  /// OdometryAggregator. At the end of a world update in which any
+  /// odometry was submitted, or with <updateRate> once per period, the
+  /// latest odometry of every robot is published.
+  ///
+  /// A fleet manager then needs one subscription instead of one per
+  /// robot.
+  class GazeboRosOdometryAggregator : public WorldPlugin
+  {
+    /// \brief Constructor
+    public: GazeboRosOdometryAggregator();
+
+    /// \brief Destructor
+    public: virtual ~GazeboRosOdometryAggregator();
+
+    /// \brief Load the plugin
+    public: void Load(physics::WorldPtr _world, sdf::ElementPtr _sdf);
+
+    /// \brief Publish the array at the end of a world update
+    private: void OnWorldUpdateEnd();
+
+    /// \brief Keep track of number of connections
+    private: int connect_count_;
+    private: void Connect();
+    private: void Disconnect();
+
+    private: physics::WorldPtr world_;
+    private: event::ConnectionPtr update_connection_;
+
+    /// \brief pointer to ros node
+    private: ros::NodeHandle* rosnode_;
+    private: ros::Publisher pub_;
+
+    /// \brief ros message, reused from cycle to cycle
+    private: gazebo_msgs::OdometryArray array_msg_;
+
+    /// \brief topic name
+    private: std::string topic_name_;
+
+    /// \brief Protects connect_count_
+    private: boost::mutex lock_;
+
+    /// update rate of the array, 0 to publish after every update with new
+    /// odometry
+    private: double update_rate_;
+    private: double update_period_;
+    private: common::Time last_publish_time_;
+
+    /// \brief for setting ROS name space
+    private: std::string robot_namespace_;
+
+    private: SharedCallbackQueue queue_;
+  };
+}
+#endif
@@ -53,11 +53,11 @@
 #include <boost/thread/mutex.hpp>
 
 // camera stuff
-#include <gazebo_plugins/gazebo_ros_camera_utils.h>
+#include <gazebo_plugins/gazebo_ros_depth_camera_utils.h>
 
 namespace gazebo
 {
-  class GazeboRosOpenniKinect : public DepthCameraPlugin, GazeboRosCameraUtils
+  class GazeboRosOpenniKinect : public DepthCameraPlugin, GazeboRosDepthCameraUtils
   {
     /// \brief Constructor
     /// \param parent The parent entity, must be a Model or a Sensor
@@ -83,63 +83,6 @@ namespace gazebo
                    unsigned int _width, unsigned int _height,
                    unsigned int _depth, const std::string &_format);
 
-    /// \brief push point cloud data into ros topic
-    private: void FillPointdCloud(const float *_src);
-
-    /// \brief push depth image data into ros topic
-    private: void FillDepthImage(const float *_src);
-
-    /// \brief Keep track of number of connctions for point clouds
-    private: int point_cloud_connect_count_;
-    private: void PointCloudConnect();
-    private: void PointCloudDisconnect();
-
-    /// \brief Keep track of number of connctions for point clouds
-    private: int depth_image_connect_count_;
-    private: void DepthImageConnect();
-    private: void DepthImageDisconnect();
-
-    private: bool FillPointCloudHelper(sensor_msgs::PointCloud2 &point_cloud_msg,
-                                  uint32_t rows_arg, uint32_t cols_arg,
-                                  uint32_t step_arg, void* data_arg);
-
-    private: bool FillDepthImageHelper( sensor_msgs::Image& image_msg,
-                                  uint32_t height, uint32_t width,
-                                  uint32_t step, void* data_arg);
-
-    /// \brief A pointer to the ROS node.  A node will be instantiated if it does not exist.
-    private: ros::Publisher point_cloud_pub_;
-    private: ros::Publisher depth_image_pub_;
-
-    /// \brief PointCloud2 point cloud message
-    private: sensor_msgs::PointCloud2 point_cloud_msg_;
-    private: sensor_msgs::Image depth_image_msg_;
-
-    /// \brief Minimum range of the point cloud
-    private: double point_cloud_cutoff_;
-    /// \brief Maximum range of the point cloud
-    private: double point_cloud_cutoff_max_;
-
-    /// \brief ROS image topic name
-    private: std::string point_cloud_topic_name_;
-
-
-    /// \brief image where each pixel contains the depth data
-    private: std::string depth_image_topic_name_;
-    private: common::Time depth_sensor_update_time_;
-
-    // overload with our own
-    private: std::string depth_image_camera_info_topic_name_;
-    private: int depth_info_connect_count_;
-    private: void DepthInfoConnect();
-    private: void DepthInfoDisconnect();
-    private: common::Time last_depth_image_camera_info_update_time_;
-    private: bool use_depth_image_16UC1_format_;
-    protected: ros::Publisher depth_image_camera_info_pub_;
-
-    using GazeboRosCameraUtils::PublishCameraInfo;
-    protected: virtual void PublishCameraInfo();
-
     private: event::ConnectionPtr load_connection_;
   };
 
@@ -25,12 +25,14 @@
 #define GAZEBO_ROS_P3D_HH
 
 #include <string>
+#include <vector>
 
 #include <boost/thread.hpp>
 #include <boost/thread/mutex.hpp>
 
 #include <ros/ros.h>
 #include <nav_msgs/Odometry.h>
+#include <gazebo_msgs/OdometryArray.h>
 
 #include <ros/callback_queue.h>
 #include <ros/advertise_options.h>
@@ -42,9 +44,24 @@
 #include <gazebo/common/Events.hh>
 
 #include <gazebo_plugins/PubQueue.h>
+#include <gazebo_plugins/deferred_load.h>
+#include <gazebo_plugins/shared_callback_executor.h>
+#include <gazebo_plugins/gazebo_ros_noise.h>
+
+#include <gazebo_ros/plugin_timing.h>
 
 namespace gazebo
 {
+  /// \brief Ground truth pose and twist of one or more links of a model.
+  ///
+  /// The link given by <bodyName> is published on <topicName>. More links
+  /// are added with one <body> element each, holding <name> and optional
+  /// <topicName>, <xyzOffset> and <rpyOffset>; the offsets default to
+  /// those of the plugin. With <batchTopicName>, all links are also
+  /// published together as one gazebo_msgs/OdometryArray.
+  ///
+  /// All links share <frameName>, <updateRate> and <gaussianNoise>, and
+  /// are read in a single pass of the world update.
   class GazeboRosP3D : public ModelPlugin
   {
     /// \brief Constructor
@@ -59,11 +76,45 @@ namespace gazebo
     /// \brief Update the controller
     protected: virtual void UpdateChild();
 
+    /// \brief The ROS part of Load, run by DeferredLoad with
+    /// <deferredLoad>true</deferredLoad>
+    private: void LoadThread(sdf::ElementPtr _sdf,
+                             const std::string &_link_name,
+                             const std::string &_topic_name);
+
+    /// \brief Add a tracked link, false if it does not exist
+    private: bool AddBody(const std::string &_link_name,
+                          const std::string &_topic_name,
+                          const ignition::math::Pose3d &_offset);
+
+    /// \brief A tracked link
+    private: struct Body
+    {
+      /// \brief The link and its name
+      physics::LinkPtr link;
+      std::string link_name;
+
+      /// \brief topic name, empty to publish in the batch only
+      std::string topic_name;
+
+      /// \brief constant xyz and rpy offsets
+      ignition::math::Pose3d offset;
+
+      ros::Publisher pub;
+      PubQueue<nav_msgs::Odometry>::Ptr pub_queue;
+
+      /// \brief last rates, to differentiate
+      ignition::math::Vector3d last_vpos;
+      ignition::math::Vector3d last_veul;
+      ignition::math::Vector3d apos;
+      ignition::math::Vector3d aeul;
+    };
+
     private: physics::WorldPtr world_;
     private: physics::ModelPtr model_;
 
-    /// \brief The parent Model
-    private: physics::LinkPtr link_;
+    /// \brief The tracked links, in the order of batch_msg_
+    private: std::vector<Body> bodies_;
 
     /// \brief The body of the frame to display pose, twist
     private: physics::LinkPtr reference_link_;
@@ -71,24 +122,22 @@ namespace gazebo
 
     /// \brief pointer to ros node
     private: ros::NodeHandle* rosnode_;
-    private: ros::Publisher pub_;
-    private: PubQueue<nav_msgs::Odometry>::Ptr pub_Queue;
-
-    /// \brief ros message
-    private: nav_msgs::Odometry pose_msg_;
 
-    /// \brief store bodyname
-    private: std::string link_name_;
+    /// \brief ros messages. The message of each link is its entry in
+    /// batch_msg_, whether the batch is published or not.
+    private: gazebo_msgs::OdometryArray batch_msg_;
+    private: ros::Publisher batch_pub_;
+    private: PubQueue<gazebo_msgs::OdometryArray>::Ptr batch_pub_queue_;
 
-    /// \brief topic name
-    private: std::string topic_name_;
+    /// \brief topic name of the batch, empty if not published
+    private: std::string batch_topic_name_;
 
     /// \brief frame transform name, should match link name
     /// FIXME: extract link name directly?
     private: std::string frame_name_;
     private: std::string tf_frame_name_;
 
-    /// \brief allow specifying constant xyz and rpy offsets
+    /// \brief default xyz and rpy offsets of the links
     private: ignition::math::Pose3d offset_;
 
     /// \brief mutex to lock access to fields used in message callbacks
@@ -96,10 +145,6 @@ namespace gazebo
 
     /// \brief save last_time
     private: common::Time last_time_;
-    private: ignition::math::Vector3d last_vpos_;
-    private: ignition::math::Vector3d last_veul_;
-    private: ignition::math::Vector3d apos_;
-    private: ignition::math::Vector3d aeul_;
     private: ignition::math::Vector3d last_frame_vpos_;
     private: ignition::math::Vector3d last_frame_veul_;
     private: ignition::math::Vector3d frame_apos_;
@@ -112,20 +157,25 @@ namespace gazebo
     private: double gaussian_noise_;
 
     /// \brief Gaussian noise generator
-    private: double GaussianKernel(double mu, double sigma);
+    private: GaussianNoise noise_;
 
     /// \brief for setting ROS name space
     private: std::string robot_namespace_;
 
-    private: ros::CallbackQueue p3d_queue_;
-    private: void P3DQueueThread();
-    private: boost::thread callback_queue_thread_;
+    private: SharedCallbackQueue p3d_queue_;
 
     // Pointer to the update event connection
     private: event::ConnectionPtr update_connection_;
 
+    /// \brief LoadThread, if deferred
+    private: DeferredLoad::TaskPtr deferred_load_task_;
+
     // ros publish multi queue, prevents publish() blocking
     private: PubMultiQueue pmq;
+
+    /// \brief Timing of UpdateChild and of the publish queue push
+    private: TimingStage *update_timing_;
+    private: TimingStage *publish_timing_;
   };
 }
 #endif
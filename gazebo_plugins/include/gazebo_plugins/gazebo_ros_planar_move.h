@@ -41,10 +41,11 @@
 #include <ros/ros.h>
 #include <tf/transform_broadcaster.h>
 #include <tf/transform_listener.h>
+#include <gazebo_plugins/gazebo_ros_drive_base.h>
 
 namespace gazebo {
 
-  class GazeboRosPlanarMove : public ModelPlugin {
+  class GazeboRosPlanarMove : public GazeboRosDriveBase {
 
     public:
       GazeboRosPlanarMove();
@@ -56,20 +57,16 @@ namespace gazebo {
       virtual void FiniChild();
 
     private:
-      void publishOdometry(double step_time);
+      void updateOdometry(double step_time);
+      void LoadThread(); /// creates the node, subscribes and connects the update, maybe deferred
 
       physics::ModelPtr parent_;
       event::ConnectionPtr update_connection_;
+      DeferredLoad::TaskPtr deferred_load_task_;
 
       boost::shared_ptr<ros::NodeHandle> rosnode_;
-      ros::Publisher odometry_pub_;
-      ros::Subscriber vel_sub_;
-      boost::shared_ptr<tf::TransformBroadcaster> transform_broadcaster_;
-      nav_msgs::Odometry odom_;
       std::string tf_prefix_;
 
-      boost::mutex lock;
-
       std::string robot_namespace_;
       std::string command_topic_;
       std::string odometry_topic_;
@@ -78,19 +75,9 @@ namespace gazebo {
       bool publish_tf_;
       double odometry_rate_;
       double cmd_timeout_;
-      ros::Time last_cmd_received_time_;
-
-      // Custom Callback Queue
-      ros::CallbackQueue queue_;
-      boost::thread callback_queue_thread_;
-      void QueueThread();
-
-      // command velocity callback
-      void cmdVelCallback(const geometry_msgs::Twist::ConstPtr& cmd_msg);
 
-      double x_;
-      double y_;
-      double rot_;
+      // velocity command of the current update
+      geometry_msgs::Twist cmd_vel_;
       bool alive_;
       common::Time last_odom_publish_time_;
       ignition::math::Pose3d last_odom_pose_;
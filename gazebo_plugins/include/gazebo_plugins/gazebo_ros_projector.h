@@ -17,6 +17,16 @@
 #include <gazebo/physics/physics.hh>
 #include <gazebo/transport/TransportTypes.hh>
 #include <gazebo/transport/Node.hh>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
 #include <gazebo/common/Time.hh>
 #include <gazebo/common/Plugin.hh>
 #include <gazebo/common/Events.hh>
@@ -28,9 +38,11 @@
 #include <OgrePrerequisites.h>
 #include <OgreTexture.h>
 #include <OgreFrameListener.h>
+#include <gazebo_plugins/shared_callback_executor.h>
 
 namespace Ogre
 {
+  class Image;
   class PlaneBoundedVolumeListSceneQuery;
   class Frustum;
   class Pass;
@@ -48,6 +60,14 @@ namespace gazebo
 
   This is a controller that controls texture projection into the world from a given body.
 
+  The textures of the <pattern> elements are loaded ahead, and a pattern is
+  switched to by its index on the pattern topic. A texture published by name
+  that is not loaded yet is loaded the same way, and the projector switches
+  to it once it is. Files are read and decoded by a loader thread and
+  uploaded one per frame on the render thread, so a switch to a loaded
+  pattern only renames the projector texture. Without rendering in the
+  server, textures are switched by name and loaded by the projector itself.
+
   Example Usage:
   \verbatim
   <projector name="projector_model">
@@ -60,6 +80,9 @@ namespace gazebo
         <filterTextureName>stereo_projection_pattern_filter.png</filterTextureName>
         <textureTopicName>projector_controller/image</textureTopicName>
         <projectorTopicName>projector_controller/projector</projectorTopicName>
+        <patternTopicName>projector_controller/pattern</patternTopicName>
+        <pattern>stereo_projection_pattern_alpha.png</pattern>
+        <pattern>stereo_projection_pattern_high_res_red.png</pattern>
         <fov>0.785398163</fov>
         <nearClipDist>0.1</nearClipDist>
         <farClipDist>10</farClipDist>
@@ -94,6 +117,72 @@ class GazeboRosProjector : public ModelPlugin
   /// \brief Callbakc when a projector toggle is published
   private: void ToggleProjector(const std_msgs::Int32::ConstPtr& projectorMsg);
 
+  /// \brief Callback when a pattern index is published
+  private: void SwitchPattern(const std_msgs::Int32::ConstPtr& patternMsg);
+
+  /// \brief Index of a pattern, added and queued for loading if new.
+  private: size_t FindPattern(const std::string &_name);
+
+  /// \brief Tell the projector to use a texture.
+  private: void PublishTexture(const std::string &_name);
+
+  /// \brief Read and decode the queued patterns.
+  private: void LoaderThread();
+
+  /// \brief Upload a decoded pattern and apply the requested switch.
+  private: void PreRender();
+
+  /// \brief A decoded pattern, waiting for its upload.
+  private: struct LoadedPattern
+  {
+    size_t index;
+    std::string name;
+    /// \brief Null if the file was not found or not decoded.
+    boost::shared_ptr<Ogre::Image> image;
+  };
+
+  /// \brief Pattern names by index.
+  private: std::vector<std::string> patterns_;
+
+  /// \brief Protects patterns_, load_queue_ and stop_.
+  private: std::mutex patterns_mutex_;
+
+  /// \brief Indices of the patterns to load.
+  private: std::deque<size_t> load_queue_;
+
+  /// \brief Signalled when load_queue_ grows or on stop.
+  private: std::condition_variable load_cond_;
+
+  /// \brief True to end the loader thread.
+  private: bool stop_;
+
+  private: std::thread loader_thread_;
+
+  /// \brief Decoded patterns, only try-locked by the render thread.
+  private: std::deque<LoadedPattern> loaded_;
+  private: std::mutex loaded_mutex_;
+
+  /// \brief Names of the uploaded patterns by index, empty if not
+  /// uploaded yet. Render thread only.
+  private: std::vector<std::string> ready_;
+
+  /// \brief Pattern index asked for, -1 if none.
+  private: std::atomic<int> requested_pattern_;
+
+  /// \brief Requested pattern waiting for its upload, -1 if none. Render
+  /// thread only.
+  private: int pending_pattern_;
+
+  /// \brief True once the render thread ran.
+  private: std::atomic<bool> rendering_;
+
+  private: ros::Subscriber patternSubscriber_;
+
+  /// \brief ROS pattern topic name
+  private: std::string pattern_topic_name_;
+
+  private: event::ConnectionPtr pre_render_connection_;
+
   /// \brief A pointer to the ROS node.  A node will be instantiated if it does not exist.
   private: ros::NodeHandle* rosnode_;
   private: ros::Subscriber imageSubscriber_;
@@ -109,9 +198,7 @@ class GazeboRosProjector : public ModelPlugin
   private: std::string robot_namespace_;
 
   // Custom Callback Queue
-  private: ros::CallbackQueue queue_;
-  private: void QueueThread();
-  private: boost::thread callback_queue_thread_;
+  private: SharedCallbackQueue queue_;
 
   private: event::ConnectionPtr add_model_event_;
 
@@ -18,7 +18,10 @@
 #ifndef GAZEBO_ROS_PROSILICA_CAMERA_HH
 #define GAZEBO_ROS_PROSILICA_CAMERA_HH
 
+#include <vector>
+
 #include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
 
 // library for processing camera data for gazebo / ros conversions
 #include <gazebo_plugins/gazebo_ros_camera_utils.h>
@@ -75,6 +78,12 @@ class GazeboRosProsilica : public CameraPlugin, GazeboRosCameraUtils
                              polled_camera::GetPolledImage::Response& rsp,
                              sensor_msgs::Image& image, sensor_msgs::CameraInfo& info);
 
+  /// \brief Fill _image with the region _roi of frame_, binned by
+  /// _binning_x by _binning_y pixel averaging. frame_mutex_ must be held.
+  private: void fillRoiImage(const sensor_msgs::RegionOfInterest &_roi,
+                             unsigned int _binning_x, unsigned int _binning_y,
+                             sensor_msgs::Image &_image);
+
   /// \brief ros message
   /// \brief construct raw stereo message
   private: sensor_msgs::Image *roiImageMsg;
@@ -84,6 +93,25 @@ class GazeboRosProsilica : public CameraPlugin, GazeboRosCameraUtils
   private: std::string pollServiceName;
 
   private: void Advertise();
+
+  /// \brief Latest frame, copied by OnNewImageFrame while a poll waits
+  /// for it. Poll responses are cropped and binned directly from it.
+  private: std::vector<unsigned char> frame_;
+
+  /// \brief Measurement time of frame_.
+  private: common::Time frame_time_;
+
+  /// \brief Number of frames copied into frame_.
+  private: unsigned int frame_seq_;
+
+  /// \brief Number of poll requests waiting for a new frame.
+  private: unsigned int polls_waiting_;
+
+  /// \brief Protects frame_, frame_time_, frame_seq_ and polls_waiting_.
+  private: boost::mutex frame_mutex_;
+
+  /// \brief Signalled when a new frame is copied into frame_.
+  private: boost::condition_variable frame_cond_;
   private: event::ConnectionPtr load_connection_;
 
   // subscribe to world stats
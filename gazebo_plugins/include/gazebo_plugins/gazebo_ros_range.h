@@ -39,31 +39,23 @@
 
 
 #include <string>
+#include <vector>
 
-#include <boost/bind.hpp>
-#include <boost/thread.hpp>
-#include <boost/thread/mutex.hpp>
-
-#include <ros/ros.h>
-#include <ros/callback_queue.h>
-#include <ros/advertise_options.h>
 #include <sensor_msgs/Range.h>
 
-#include <gazebo/physics/physics.hh>
-#include <gazebo/transport/TransportTypes.hh>
-#include <gazebo/msgs/MessageTypes.hh>
 #include <gazebo/common/Time.hh>
-#include <gazebo/common/Plugin.hh>
-#include <gazebo/common/Events.hh>
-#include <gazebo/sensors/SensorTypes.hh>
+#include <gazebo/sensors/RaySensor.hh>
 #include <gazebo/plugins/RayPlugin.hh>
 
-#include <sdf/Param.hh>
+#include <gazebo_plugins/gazebo_ros_sensor_plugin.h>
+#include <gazebo_plugins/range_cone.h>
 
 namespace gazebo
 {
 
-class GazeboRosRange : public RayPlugin
+class GazeboRosRange : public GazeboRosSensorPlugin<GazeboRosRange,
+                                                    RayPlugin,
+                                                    sensors::RaySensor>
 {
 
     /// \brief Constructor
@@ -72,33 +64,21 @@ class GazeboRosRange : public RayPlugin
     /// \brief Destructor
     public: ~GazeboRosRange();
 
-    /// \brief Load the plugin
-    /// \param take in SDF root element
-    public: void Load(sensors::SensorPtr _parent, sdf::ElementPtr _sdf);
-
     /// \brief Update the controller
     protected: virtual void OnNewLaserScans();
 
-    /// \brief Put range data to the ROS topic
-    private: void PutRangeData(common::Time &_updateTime);
+    /// \brief Read the plugin parameters
+    private: bool LoadSdf(sdf::ElementPtr _sdf);
 
-    /// \brief Keep track of number of connctions
-    private: int range_connect_count_;
-    private: void RangeConnect();
-    private: void RangeDisconnect();
+    /// \brief Advertise the range topic
+    private: void LoadRos();
 
-    // Pointer to the model
-    private: physics::WorldPtr world_;
-    /// \brief The parent sensor
-    private: sensors::SensorPtr parent_sensor_;
-    private: sensors::RaySensorPtr parent_ray_sensor_;
+    private: friend SensorPluginBase;
 
-    /// \brief pointer to ros node
-    private: ros::NodeHandle* rosnode_;
-    private: ros::Publisher pub_;
+    /// \brief Put range data to the ROS topic
+    private: void PutRangeData(common::Time &_updateTime);
 
-    /// \brief ros message
-    private: sensor_msgs::Range range_msg_;
+    private: SensorPublication<sensor_msgs::Range>::Ptr range_pub_;
 
     /// \brief topic name
     private: std::string topic_name_;
@@ -106,39 +86,16 @@ class GazeboRosRange : public RayPlugin
     /// \brief frame transform name, should match link name
     private: std::string frame_name_;
 
-    /// \brief radiation type : ultrasound or infrared
-    private: std::string radiation_;
+    /// \brief radiation type, field of view and noise of the messages
+    private: RangeCone cone_;
 
-    /// \brief sensor field of view
-    private: double fov_;
-    /// \brief Gaussian noise
-    private: double gaussian_noise_;
-
-    /// \brief Gaussian noise generator
-    private: double GaussianKernel(double mu, double sigma);
-
-    /// \brief mutex to lock access to fields that are used in message callbacks
-    private: boost::mutex lock_;
-
-    /// \brief hack to mimic hokuyo intensity cutoff of 100
-    private: double hokuyo_min_intensity_;
+    /// \brief ranges of the rays, gathered for the reduction
+    private: std::vector<float> ranges_;
 
     /// update rate of this sensor
     private: double update_rate_;
     private: double update_period_;
     private: common::Time last_update_time_;
-
-    /// \brief for setting ROS name space
-    private: std::string robot_namespace_;
-
-    private: ros::CallbackQueue range_queue_;
-    private: void RangeQueueThread();
-    private: boost::thread callback_queue_thread_;
-
-    // deferred load in case ros is blocking
-    private: sdf::ElementPtr sdf;
-    private: void LoadThread();
-    private: boost::thread deferred_load_thread_;
 };
 }
 #endif // GAZEBO_ROS_RANGE_H
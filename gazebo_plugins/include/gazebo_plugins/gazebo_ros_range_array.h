@@ -0,0 +1,150 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GAZEBO_ROS_RANGE_ARRAY_HH
+#define GAZEBO_ROS_RANGE_ARRAY_HH
+
+#include <string>
+#include <vector>
+
+#include <boost/thread/mutex.hpp>
+
+#include <ros/ros.h>
+#include <ros/advertise_options.h>
+#include <gazebo_msgs/RangeArray.h>
+#include <gazebo_msgs/RangeArrayInfo.h>
+
+#include <gazebo/physics/physics.hh>
+#include <gazebo/common/Time.hh>
+#include <gazebo/common/Plugin.hh>
+#include <gazebo/common/Events.hh>
+#include <gazebo/sensors/SensorTypes.hh>
+
+#include <gazebo_plugins/shared_callback_executor.h>
+#include <gazebo_plugins/gazebo_ros_noise.h>
+
+namespace gazebo
+{
+  /// \brief Publishes the ranges of many ray sensors of a model, e.g. a
+  /// sonar ring, as one gazebo_msgs/RangeArray per cycle.
+  ///
+  /// Each sensor gives one range, the shortest of its rays, as
+  /// GazeboRosRange does.  The sensors are listed by name with one
+  /// <sensor> element each and are looked up among the sensors of the
+  /// model.  What does not change, frames, radiation type, field of view and
+  /// range limits, is published once on a latched gazebo_msgs/RangeArrayInfo.
+  ///
+  /// There is no thread per sensor: the ranges are taken in the sensors'
+  /// update callbacks and the array is published by the update completing
+  /// the cycle, when every sensor has reported or, with <updateRate>, when
+  /// the period has elapsed.
+  class GazeboRosRangeArray : public ModelPlugin
+  {
+    /// \brief Constructor
+    public: GazeboRosRangeArray();
+
+    /// \brief Destructor
+    public: virtual ~GazeboRosRangeArray();
+
+    /// \brief Load the plugin
+    public: void Load(physics::ModelPtr _parent, sdf::ElementPtr _sdf);
+
+    /// \brief Look the sensors up until all of them are created
+    private: void OnWorldUpdate();
+
+    /// \brief Find the sensors, true once all of them are found
+    private: bool ResolveSensors();
+
+    /// \brief Take the range of sensor _index
+    private: void OnSensorUpdate(size_t _index);
+
+    /// \brief Keep track of number of connections
+    private: int connect_count_;
+    private: void Connect();
+    private: void Disconnect();
+
+    /// \brief Activate the sensors while someone listens
+    private: void SetSensorsActive(bool _active);
+
+    private: physics::WorldPtr world_;
+    private: physics::ModelPtr model_;
+
+    /// \brief Names of the sensors in the order of the array
+    private: std::vector<std::string> sensor_names_;
+
+    /// \brief The sensors, empty until all of them are found
+    private: std::vector<sensors::RaySensorPtr> sensors_;
+
+    /// \brief Connections to the sensors' updates
+    private: std::vector<event::ConnectionPtr> sensor_connections_;
+
+    /// \brief Looks the sensors up
+    private: event::ConnectionPtr update_connection_;
+
+    /// \brief Sensors that reported since the last array was published
+    private: std::vector<bool> updated_;
+    private: size_t updated_count_;
+
+    /// \brief Rays of the sensor being read
+    private: std::vector<double> rays_;
+
+    /// \brief pointer to ros node
+    private: ros::NodeHandle* rosnode_;
+    private: ros::Publisher pub_;
+    private: ros::Publisher info_pub_;
+
+    /// \brief ros messages, the array is reused from cycle to cycle
+    private: gazebo_msgs::RangeArray array_msg_;
+    private: gazebo_msgs::RangeArrayInfo info_msg_;
+
+    /// \brief topic names
+    private: std::string topic_name_;
+    private: std::string info_topic_name_;
+
+    /// \brief frame of the array, the sensors' frames are their links
+    private: std::string frame_name_;
+
+    /// \brief tf prefix of the sensors' frames
+    private: std::string tf_prefix_;
+
+    /// \brief radiation type : ultrasound or infrared
+    private: std::string radiation_;
+
+    /// \brief sensor field of view
+    private: double fov_;
+
+    /// \brief Gaussian noise
+    private: double gaussian_noise_;
+
+    /// \brief Gaussian noise generator
+    private: GaussianNoise noise_;
+
+    /// \brief Protects the sensors, the array and the connection count
+    private: boost::mutex lock_;
+
+    /// update rate of the array, 0 to publish once every sensor reported
+    private: double update_rate_;
+    private: double update_period_;
+    private: common::Time last_publish_time_;
+
+    /// \brief for setting ROS name space
+    private: std::string robot_namespace_;
+
+    private: SharedCallbackQueue range_queue_;
+  };
+}
+#endif
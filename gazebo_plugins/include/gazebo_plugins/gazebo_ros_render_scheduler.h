@@ -0,0 +1,77 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GAZEBO_ROS_RENDER_SCHEDULER_PLUGIN_HH
+#define GAZEBO_ROS_RENDER_SCHEDULER_PLUGIN_HH
+
+#include <set>
+#include <string>
+
+#include <gazebo/common/Events.hh>
+#include <gazebo/common/Plugin.hh>
+#include <gazebo/common/Time.hh>
+#include <gazebo/physics/physics.hh>
+
+namespace gazebo
+{
+  /// \brief Staggers the renders of the cameras, depth cameras and GPU
+  /// lasers of the world over the physics steps.
+  ///
+  /// Every rendering sensor of the world with a positive update rate is
+  /// handed to RenderScheduler, which renders it once per period like a
+  /// triggered camera, on the step chosen to even out the render cost of
+  /// the steps. Sensors spawned later are picked up every <rescanPeriod>
+  /// seconds of simulation time. Rate changes made through
+  /// GazeboRosCameraUtils keep the sensor scheduled.
+  ///
+  /// Example:
+  /// \verbatim
+  ///   <plugin name="render_scheduler" filename="libgazebo_ros_render_scheduler.so">
+  ///     <sensorTypes>camera depth multicamera gpu_ray</sensorTypes>
+  ///     <rescanPeriod>1.0</rescanPeriod>
+  ///   </plugin>
+  /// \endverbatim
+  class GazeboRosRenderScheduler : public WorldPlugin
+  {
+    /// \brief Constructor
+    public: GazeboRosRenderScheduler();
+
+    /// \brief Destructor, gives the sensors back their own rates.
+    public: virtual ~GazeboRosRenderScheduler();
+
+    /// \brief Load the plugin
+    public: void Load(physics::WorldPtr _world, sdf::ElementPtr _sdf);
+
+    /// \brief Pick up new sensors and arm the sensors due at this step.
+    private: void OnWorldUpdateBegin();
+
+    /// \brief Add the sensors of the world that are not scheduled yet.
+    private: void Scan();
+
+    private: physics::WorldPtr world_;
+    private: event::ConnectionPtr update_connection_;
+
+    /// \brief Sensor types that are scheduled.
+    private: std::set<std::string> sensor_types_;
+
+    /// \brief Simulation time between two scans for new sensors [s].
+    private: double rescan_period_;
+    private: common::Time last_scan_time_;
+    private: bool scanned_;
+  };
+}
+#endif
@@ -0,0 +1,145 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GAZEBO_ROS_SENSOR_LOD_PLUGIN_HH
+#define GAZEBO_ROS_SENSOR_LOD_PLUGIN_HH
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <ros/ros.h>
+#include <gazebo_msgs/PerformanceMetrics.h>
+#include <gazebo_msgs/SensorLevelOfDetailArray.h>
+
+#include <gazebo/common/Plugin.hh>
+#include <gazebo/physics/physics.hh>
+#include <gazebo/sensors/Sensor.hh>
+
+#include <gazebo_plugins/sensor_lod.h>
+#include <gazebo_plugins/shared_callback_executor.h>
+
+namespace gazebo
+{
+  /// \brief Lowers the level of detail of selected sensors while the real
+  /// time factor is below a target, and restores it when it recovers.
+  ///
+  /// The real time factor is read from the performance metrics published
+  /// by gazebo_ros_api_plugin (Gazebo 9.15 or 11.2 and later). Each listed
+  /// sensor has <levels> levels of detail below the full one. Going down
+  /// a level lowers its update rate geometrically towards
+  /// <minUpdateRate>, and raises the decimation of its points (depth
+  /// camera point clouds) geometrically towards <maxDecimation>.
+  ///
+  /// While the real time factor is below <targetRealTimeFactor>, the
+  /// sensor at the highest level of detail goes down one level, the first
+  /// listed first. Above <restoreRealTimeFactor> the most degraded sensor
+  /// goes up one level, the last listed first. There are <holdTime> wall
+  /// seconds between two changes, so the effect of one is measured before
+  /// the next. The level of every sensor is published, latched, on
+  /// <lodTopicName> whenever one changes.
+  ///
+  /// Example:
+  /// \verbatim
+  ///   <plugin name="sensor_lod" filename="libgazebo_ros_sensor_lod.so">
+  ///     <targetRealTimeFactor>0.9</targetRealTimeFactor>
+  ///     <restoreRealTimeFactor>0.98</restoreRealTimeFactor>
+  ///     <holdTime>3.0</holdTime>
+  ///     <sensor>
+  ///       <name>head_camera</name>
+  ///       <levels>3</levels>
+  ///       <minUpdateRate>5.0</minUpdateRate>
+  ///       <maxDecimation>4</maxDecimation>
+  ///     </sensor>
+  ///   </plugin>
+  /// \endverbatim
+  class GazeboRosSensorLod : public WorldPlugin
+  {
+    /// \brief Constructor
+    public: GazeboRosSensorLod();
+
+    /// \brief Destructor, restores the full detail.
+    public: virtual ~GazeboRosSensorLod();
+
+    /// \brief Load the plugin
+    public: void Load(physics::WorldPtr _world, sdf::ElementPtr _sdf);
+
+    /// \brief A sensor whose level of detail is managed.
+    private: struct Sensor
+    {
+      /// \brief Name or scoped name from the SDF.
+      std::string name;
+      unsigned int levels;
+      double min_update_rate;
+      unsigned int max_decimation;
+
+      /// \brief Current level, 0 at full detail.
+      unsigned int level;
+
+      /// \brief Set once the sensor is found.
+      std::weak_ptr<sensors::Sensor> sensor;
+      std::string scoped_name;
+      SensorLod::Factor decimation;
+
+      /// \brief Update rate at full detail, 0 if the rate is not managed.
+      double full_update_rate;
+    };
+
+    /// \brief Adjust the level of detail to a new real time factor.
+    private: void OnMetrics(const gazebo_msgs::PerformanceMetrics::ConstPtr &_msg);
+
+    /// \brief Find the sensor of an entry.
+    /// \return True if it is found.
+    private: bool Resolve(Sensor &_sensor);
+
+    /// \brief Update rate and decimation of a sensor at its level.
+    private: void Detail(const Sensor &_sensor, double &_update_rate,
+                         unsigned int &_decimation) const;
+
+    /// \brief Apply the level of a sensor.
+    private: void Apply(Sensor &_sensor);
+
+    /// \brief Publish the level of every sensor.
+    private: void Publish(double _real_time_factor);
+
+    private: physics::WorldPtr world_;
+
+    private: std::vector<Sensor> sensors_;
+
+    private: double target_rtf_;
+    private: double restore_rtf_;
+    private: double hold_time_;
+    private: ros::WallTime last_change_;
+
+    /// \brief pointer to ros node
+    private: ros::NodeHandle* rosnode_;
+    private: ros::Subscriber metrics_sub_;
+    private: ros::Publisher lod_pub_;
+
+    /// \brief ros message, reused
+    private: gazebo_msgs::SensorLevelOfDetailArray lod_msg_;
+
+    private: std::string metrics_topic_name_;
+    private: std::string lod_topic_name_;
+
+    /// \brief for setting ROS name space
+    private: std::string robot_namespace_;
+
+    private: SharedCallbackQueue queue_;
+  };
+}
+#endif
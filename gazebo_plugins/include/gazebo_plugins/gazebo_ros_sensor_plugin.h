@@ -0,0 +1,382 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GAZEBO_ROS_SENSOR_PLUGIN_HH
+#define GAZEBO_ROS_SENSOR_PLUGIN_HH
+
+#include <atomic>
+#include <list>
+#include <string>
+
+#include <boost/bind.hpp>
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <ros/ros.h>
+#include <ros/advertise_options.h>
+#include <tf/tf.h>
+
+#include <sdf/sdf.hh>
+#include <gazebo/common/Exception.hh>
+#include <gazebo/physics/World.hh>
+#include <gazebo/sensors/Sensor.hh>
+#include <gazebo/sensors/SensorTypes.hh>
+
+#include <gazebo_ros/latency_tracer.h>
+#include <gazebo_ros/plugin_timing.h>
+#include <gazebo_ros/profiler.h>
+
+#include <gazebo_plugins/PubQueue.h>
+#include <gazebo_plugins/deferred_load.h>
+#include <gazebo_plugins/gazebo_ros_utils.h>
+#include <gazebo_plugins/message_pool.h>
+#include <gazebo_plugins/sensor_recorder.h>
+#include <gazebo_plugins/shared_callback_executor.h>
+
+namespace gazebo
+{
+  template<class Derived, class PluginT, class SensorT>
+  class GazeboRosSensorPlugin;
+
+  /// \brief A topic of a GazeboRosSensorPlugin. Messages are taken from a
+  /// pool, filled and handed to Publish(), which queues them by pointer for
+  /// the publisher threads.
+  template<class M>
+  class SensorPublication
+  {
+    public: typedef boost::shared_ptr<SensorPublication> Ptr;
+    public: typedef boost::shared_ptr<M> MessagePtr;
+    public: typedef boost::shared_ptr<M const> MessageConstPtr;
+
+    /// \brief Constructor, use GazeboRosSensorPlugin::Advertise().
+    public: SensorPublication()
+      : pool_(new MessagePool<M>()), subscribers_(0), recorder_source_(-1),
+        publish_timing_(NULL), latency_topic_(0) {}
+
+    /// \brief Subscribers of the topic, the recorder counting as one.
+    public: int Subscribers() const
+    {
+      return this->subscribers_.load(std::memory_order_relaxed);
+    }
+
+    /// \brief A recycled message, its arrays keep their capacity.
+    public: MessagePtr Acquire()
+    {
+      return this->pool_->Acquire();
+    }
+
+    /// \brief Queue _msg for publishing, releasing the caller's reference so
+    /// it goes back to the pool once sent.
+    public: void Publish(MessagePtr &_msg)
+    {
+      ScopedTiming timing(this->publish_timing_);
+      MessageConstPtr msg(_msg);
+      _msg.reset();
+      SensorRecorder::Instance().Record(this->pub_, msg);
+      this->queue_->push(std::move(msg), this->pub_);
+    }
+
+    /// \brief Record a LatencyTracer point, SENSOR_CALLBACK or CONVERTED, of
+    /// the message stamped _stamp.  The queue records the later ones.
+    public: void TraceLatency(LatencyTracer::Point _point,
+                              const ros::Time &_stamp) const
+    {
+      if (LatencyTracer::enabled())
+        LatencyTracer::instance().record(this->latency_topic_, _point,
+          _stamp.toNSec(), ros::Time::now().toNSec());
+    }
+
+    /// \brief The ROS publisher, e.g. for its topic name.
+    public: const ros::Publisher &Publisher() const
+    {
+      return this->pub_;
+    }
+
+    private: ros::Publisher pub_;
+    private: typename PubQueue<MessageConstPtr>::Ptr queue_;
+    private: boost::shared_ptr<MessagePool<M> > pool_;
+    private: std::atomic<int> subscribers_;
+    private: int recorder_source_;
+    private: TimingStage *publish_timing_;
+    private: uint32_t latency_topic_;
+
+    template<class D, class P, class S> friend class GazeboRosSensorPlugin;
+  };
+
+  /// \brief Base of the ROS sensor plugins, holding what each of them used
+  /// to implement on its own.
+  ///
+  /// - Load() casts the parent sensor to SensorT, reads <robotNamespace>
+  ///   and defers the ROS setup to a DeferredLoad task.
+  /// - Advertise() creates a SensorPublication, publishing pooled messages
+  ///   through a PubMultiQueue, its connection callbacks served by the shared
+  ///   callback executor.
+  /// - The sensor only runs while some topic has subscribers, or is being
+  ///   recorded by the SensorRecorder, and frees its recycled messages
+  ///   after the last subscriber left.
+  /// - Update and publish times go to the TimingRegistry.
+  ///
+  /// PluginT is the gazebo plugin class providing Load(), e.g. RayPlugin or
+  /// GpuRayPlugin, SensorT the sensor it runs on.
+  ///
+  /// Derived passes itself as first template argument and provides, with
+  /// GazeboRosSensorPlugin as friend:
+  /// - bool LoadSdf(sdf::ElementPtr): read the plugin parameters, false to
+  ///   not load
+  /// - void LoadRos(): advertise the topics, in the DeferredLoad task
+  /// and may replace:
+  /// - void Activate(), void Deactivate(): start and stop the sensor on the
+  ///   first subscriber and after the last one, SetActive() by default
+  ///
+  /// Derived destructors call ShutdownRos() first, so that no connection
+  /// callback reaches a partly destroyed plugin.
+  template<class Derived, class PluginT, class SensorT>
+  class GazeboRosSensorPlugin : public PluginT
+  {
+    protected: typedef GazeboRosSensorPlugin SensorPluginBase;
+    protected: typedef boost::shared_ptr<SensorT> SensorPtrT;
+
+    /// \brief Constructor
+    /// \param[in] _name Logger name, e.g. "laser", also used in the
+    /// TimingRegistry
+    public: explicit GazeboRosSensorPlugin(const char *_name)
+      : name_(_name), rosnode_(NULL), update_timing_(NULL),
+        publish_timing_(NULL), subscribers_(0), ros_loaded_(false) {}
+
+    /// \brief Destructor
+    public: virtual ~GazeboRosSensorPlugin()
+    {
+      this->ShutdownRos();
+    }
+
+    /// \brief Load the plugin
+    public: virtual void Load(sensors::SensorPtr _parent, sdf::ElementPtr _sdf)
+    {
+      GAZEBO_ROS_STARTUP_PHASE("load");
+      PluginT::Load(_parent, _sdf);
+      this->sdf = _sdf;
+      this->world_name_ = _parent->WorldName();
+      this->world_ = physics::get_world(this->world_name_);
+
+      GAZEBO_SENSORS_USING_DYNAMIC_POINTER_CAST;
+      this->parent_sensor_ = dynamic_pointer_cast<SensorT>(_parent);
+      if (!this->parent_sensor_)
+        gzthrow("The " << this->name_ << " plugin does not support the "
+                << _parent->Type() << " sensor " << _parent->ScopedName());
+
+      this->robot_namespace_ = GetRobotNamespace(_parent, _sdf, this->name_);
+
+      const std::string timing_name = std::string("gazebo_ros_") + this->name_ +
+        " " + _parent->ScopedName();
+      this->update_timing_ =
+        TimingRegistry::instance().stage(timing_name, "update");
+      this->publish_timing_ =
+        TimingRegistry::instance().stage(timing_name, "publish");
+
+      if (!this->derived().LoadSdf(_sdf))
+        return;
+
+      // Make sure the ROS node for Gazebo has already been initialized
+      if (!ros::isInitialized())
+      {
+        ROS_FATAL_STREAM_NAMED(this->name_, "A ROS node for Gazebo has not been initialized, unable to load plugin. "
+          << "Load the Gazebo system plugin 'libgazebo_ros_api_plugin.so' in the gazebo_ros package)");
+        return;
+      }
+
+      ROS_INFO_NAMED(this->name_, "Starting %s plugin (ns = %s)", this->name_,
+                     this->robot_namespace_.c_str());
+      this->deferred_load_task_ = DeferredLoad::Instance().Run(
+        this->handleName, boost::bind(&GazeboRosSensorPlugin::LoadThread, this));
+    }
+
+    /// \brief Advertise a topic whose subscribers activate the sensor.
+    protected: template<class M> typename SensorPublication<M>::Ptr
+               Advertise(const std::string &_topic, uint32_t _queue_size = 1)
+    {
+      typename SensorPublication<M>::Ptr pub(new SensorPublication<M>());
+      pub->queue_ =
+        this->pmq.template addPub<typename SensorPublication<M>::MessageConstPtr>();
+      pub->publish_timing_ = this->publish_timing_;
+      std::atomic<int> *count = &pub->subscribers_;
+      ros::AdvertiseOptions ao = ros::AdvertiseOptions::create<M>(
+        _topic, _queue_size,
+        boost::bind(&GazeboRosSensorPlugin::Connect, this, count),
+        boost::bind(&GazeboRosSensorPlugin::Disconnect, this, count),
+        ros::VoidPtr(), &this->queue_);
+      pub->pub_ = this->rosnode_->advertise(ao);
+      pub->queue_->setLatencyTopic(pub->pub_.getTopic());
+      pub->latency_topic_ =
+        LatencyTracer::instance().topic(pub->pub_.getTopic());
+
+      // a recorded topic runs the sensor as a subscriber would
+      pub->recorder_source_ = SensorRecorder::Instance().AddSource(
+        pub->pub_.getTopic(),
+        boost::bind(&GazeboRosSensorPlugin::Connect, this, count),
+        boost::bind(&GazeboRosSensorPlugin::Disconnect, this, count));
+      this->recorder_sources_.push_back(pub->recorder_source_);
+
+      boost::mutex::scoped_lock lock(this->activation_mutex_);
+      this->pool_trims_.push_back(
+        boost::bind(&MessagePool<M>::Trim, pub->pool_));
+      return pub;
+    }
+
+    /// \brief Sensor frame resolved against the tf_prefix parameter.
+    protected: std::string ResolveFrame(const std::string &_frame) const
+    {
+      return tf::resolve(this->tf_prefix_, _frame);
+    }
+
+    /// \brief True while any topic has subscribers.
+    protected: bool Subscribed() const
+    {
+      return this->subscribers_.load(std::memory_order_relaxed) > 0;
+    }
+
+    /// \brief Stop serving the ROS callbacks and the recorder, call first in
+    /// the destructor of Derived.
+    protected: void ShutdownRos()
+    {
+      if (this->deferred_load_task_)
+        this->deferred_load_task_->Wait();
+      for (std::list<int>::iterator it = this->recorder_sources_.begin();
+           it != this->recorder_sources_.end(); ++it)
+        SensorRecorder::Instance().RemoveSource(*it);
+      this->recorder_sources_.clear();
+      if (!this->rosnode_)
+        return;
+      this->queue_.clear();
+      this->queue_.disable();
+      this->rosnode_->shutdown();
+      this->queue_.Stop();
+      delete this->rosnode_;
+      this->rosnode_ = NULL;
+    }
+
+    /// \brief Start the sensor on the first subscriber.
+    protected: void Activate()
+    {
+      this->parent_sensor_->SetActive(true);
+    }
+
+    /// \brief Stop the sensor after the last subscriber left.
+    protected: void Deactivate()
+    {
+      this->parent_sensor_->SetActive(false);
+    }
+
+    /// \brief Create the ROS node and let Derived advertise its topics.
+    private: void LoadThread()
+    {
+      this->pmq.startService();
+      this->rosnode_ = new ros::NodeHandle(this->robot_namespace_);
+
+      this->tf_prefix_ = tf::getPrefixParam(*this->rosnode_);
+      ROS_DEBUG_NAMED(this->name_, "%s plugin (ns = %s) <tf_prefix>, set to \"%s\"",
+        this->name_, this->robot_namespace_.c_str(), this->tf_prefix_.c_str());
+
+      this->derived().LoadRos();
+
+      // sensor generation off until someone subscribes
+      boost::mutex::scoped_lock lock(this->activation_mutex_);
+      this->ros_loaded_ = true;
+      if (this->subscribers_ == 0)
+        this->derived().Deactivate();
+    }
+
+    /// \brief A topic got a subscriber.
+    private: void Connect(std::atomic<int> *_count)
+    {
+      boost::mutex::scoped_lock lock(this->activation_mutex_);
+      ++*_count;
+      if (++this->subscribers_ == 1)
+        this->derived().Activate();
+    }
+
+    /// \brief A topic lost a subscriber.
+    private: void Disconnect(std::atomic<int> *_count)
+    {
+      boost::mutex::scoped_lock lock(this->activation_mutex_);
+      --*_count;
+      if (--this->subscribers_ == 0 && this->ros_loaded_)
+        this->derived().Deactivate();
+
+      // an idle sensor keeps no recycled messages
+      if (this->subscribers_ == 0)
+      {
+        for (std::list<boost::function<void()> >::iterator it =
+             this->pool_trims_.begin(); it != this->pool_trims_.end(); ++it)
+          (*it)();
+      }
+    }
+
+    private: Derived &derived()
+    {
+      return *static_cast<Derived *>(this);
+    }
+
+    /// \brief Logger name
+    protected: const char *name_;
+
+    protected: std::string world_name_;
+    protected: physics::WorldPtr world_;
+
+    /// \brief The parent sensor
+    protected: SensorPtrT parent_sensor_;
+
+    /// \brief The plugin SDF
+    protected: sdf::ElementPtr sdf;
+
+    /// \brief for setting ROS name space
+    protected: std::string robot_namespace_;
+
+    /// \brief tf prefix
+    protected: std::string tf_prefix_;
+
+    /// \brief pointer to ros node
+    protected: ros::NodeHandle *rosnode_;
+
+    /// \brief Time spent filling messages, for Derived to record with
+    /// ScopedTiming
+    protected: TimingStage *update_timing_;
+    private: TimingStage *publish_timing_;
+
+    /// \brief prevents blocking
+    private: PubMultiQueue pmq;
+
+    /// \brief Serves the connection callbacks on the shared executor
+    private: SharedCallbackQueue queue_;
+
+    private: DeferredLoad::TaskPtr deferred_load_task_;
+
+    /// \brief SensorRecorder handles of the topics
+    private: std::list<int> recorder_sources_;
+
+    /// \brief MessagePool::Trim() of each topic, guarded by activation_mutex_
+    private: std::list<boost::function<void()> > pool_trims_;
+
+    /// \brief Subscribers of all topics, changed with activation_mutex_ held
+    private: std::atomic<int> subscribers_;
+
+    /// \brief Set once LoadRos() returned, guarded by activation_mutex_
+    private: bool ros_loaded_;
+    private: boost::mutex activation_mutex_;
+  };
+}
+#endif
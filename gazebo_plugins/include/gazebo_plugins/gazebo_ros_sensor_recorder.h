@@ -0,0 +1,82 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GAZEBO_ROS_SENSOR_RECORDER_PLUGIN_HH
+#define GAZEBO_ROS_SENSOR_RECORDER_PLUGIN_HH
+
+#include <string>
+
+#include <ros/ros.h>
+#include <std_srvs/SetBool.h>
+
+#include <gazebo/common/Plugin.hh>
+#include <gazebo/physics/physics.hh>
+
+#include <gazebo_plugins/sensor_recorder.h>
+#include <gazebo_plugins/shared_callback_executor.h>
+
+namespace gazebo
+{
+  /// \brief Records the sensor output of the plugins in process, into
+  /// memory mapped bag files, see SensorRecorder.
+  ///
+  /// Unlike rosbag record, nothing goes over TCP, and topics are recorded
+  /// even when nobody subscribes to them: the camera plugins render while
+  /// their image topic is recorded.
+  ///
+  /// SDF parameters:
+  /// - <prefix>: path prefix of the chunk files, default "sensors"
+  /// - <topics>: space separated topics to record, all if empty; a topic
+  ///   ending in '*' records every topic it is a prefix of
+  /// - <chunkSize>: MB of messages per chunk file, default 64
+  /// - <chunkCount>: chunk files mapped ahead, default 4
+  /// - <compression>: none or bz2, default none
+  /// - <compressionThreads>: background threads, default 2
+  /// - <autoStart>: record from the start, default true
+  ///
+  /// The std_srvs/SetBool service <serviceName> (default
+  /// "sensor_recorder/record") starts and stops recording.
+  class GazeboRosSensorRecorder : public WorldPlugin
+  {
+    /// \brief Constructor
+    public: GazeboRosSensorRecorder();
+
+    /// \brief Destructor, stops recording
+    public: virtual ~GazeboRosSensorRecorder();
+
+    /// \brief Load the plugin
+    public: void Load(physics::WorldPtr _world, sdf::ElementPtr _sdf);
+
+    /// \brief Start or stop recording
+    private: bool Record(std_srvs::SetBool::Request &_req,
+                         std_srvs::SetBool::Response &_res);
+
+    /// \brief pointer to ros node
+    private: ros::NodeHandle* rosnode_;
+    private: ros::ServiceServer record_service_;
+
+    /// \brief Settings read from the SDF
+    private: SensorRecorder::Options options_;
+
+    /// \brief for setting ROS name space
+    private: std::string robot_namespace_;
+
+    /// \brief Dedicated, stopping a recording flushes the chunk files
+    private: SharedCallbackQueue queue_;
+  };
+}
+#endif
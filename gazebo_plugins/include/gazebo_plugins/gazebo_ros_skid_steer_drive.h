@@ -59,13 +59,14 @@
 // Boost
 #include <boost/thread.hpp>
 #include <boost/bind.hpp>
+#include <gazebo_plugins/gazebo_ros_drive_base.h>
 
 namespace gazebo {
 
   class Joint;
   class Entity;
 
-  class GazeboRosSkidSteerDrive : public ModelPlugin {
+  class GazeboRosSkidSteerDrive : public GazeboRosDriveBase {
 
     public:
 	  GazeboRosSkidSteerDrive();
@@ -77,12 +78,13 @@ namespace gazebo {
       virtual void FiniChild();
 
     private:
-      void publishOdometry(double step_time);
       void getWheelVelocities();
+      void LoadThread(); /// creates the node, subscribes and connects the update, maybe deferred
 
       physics::WorldPtr world;
       physics::ModelPtr parent;
       event::ConnectionPtr update_connection_;
+      DeferredLoad::TaskPtr deferred_load_task_;
 
       std::string left_front_joint_name_;
       std::string right_front_joint_name_;
@@ -98,31 +100,15 @@ namespace gazebo {
 
       // ROS STUFF
       ros::NodeHandle* rosnode_;
-      ros::Publisher odometry_publisher_;
-      ros::Subscriber cmd_vel_subscriber_;
-      tf::TransformBroadcaster *transform_broadcaster_;
-      nav_msgs::Odometry odom_;
       std::string tf_prefix_;
       bool broadcast_tf_;
 
-      boost::mutex lock;
-
       std::string robot_namespace_;
       std::string command_topic_;
       std::string odometry_topic_;
       std::string odometry_frame_;
       std::string robot_base_frame_;
 
-      // Custom Callback Queue
-      ros::CallbackQueue queue_;
-      boost::thread callback_queue_thread_;
-      void QueueThread();
-
-      // DiffDrive stuff
-      void cmdVelCallback(const geometry_msgs::Twist::ConstPtr& cmd_msg);
-
-      double x_;
-      double rot_;
       bool alive_;
 
       // Update Rate
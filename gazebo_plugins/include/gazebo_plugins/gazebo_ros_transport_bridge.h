@@ -0,0 +1,177 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GAZEBO_ROS_TRANSPORT_BRIDGE_HH
+#define GAZEBO_ROS_TRANSPORT_BRIDGE_HH
+
+#include <string>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <ros/ros.h>
+#include <ros/advertise_options.h>
+
+#include <gazebo/common/Plugin.hh>
+#include <gazebo/physics/physics.hh>
+#include <gazebo/transport/transport.hh>
+
+#include <gazebo_ros/profiler.h>
+
+#include <gazebo_plugins/PubQueue.h>
+#include <gazebo_plugins/gazebo_ros_transport_bridge_converters.h>
+#include <gazebo_plugins/gazebo_ros_utils.h>
+#include <gazebo_plugins/message_pool.h>
+#include <gazebo_plugins/sensor_recorder.h>
+
+namespace gazebo
+{
+  /// \brief One gazebo topic republished on one ROS topic.
+  class TransportBridgeChannel
+  {
+    public: typedef boost::shared_ptr<TransportBridgeChannel> Ptr;
+
+    public: virtual ~TransportBridgeChannel() {}
+  };
+
+  /// \brief Republishes gazebo topic messages of type G as ROS messages of
+  /// type R, converted by TransportBridgeConverter<G, R>.
+  ///
+  /// As in GazeboRosLaser, the gazebo topic is only subscribed while the ROS
+  /// topic has subscribers. Messages are converted straight out of the
+  /// protobuf handed over by the gazebo transport into a recycled message of
+  /// a MessagePool, and published by pointer through a PubQueue.
+  template<class G, class R>
+  class TransportBridgeChannelT : public TransportBridgeChannel
+  {
+    /// \brief Constructor, advertises _ros_topic.
+    public: TransportBridgeChannelT(ros::NodeHandle &_rosnode,
+                                    transport::NodePtr _gazebo_node,
+                                    PubMultiQueue &_pmq,
+                                    const std::string &_gazebo_topic,
+                                    const std::string &_ros_topic,
+                                    const std::string &_frame_name,
+                                    unsigned int _queue_size)
+      : gazebo_node_(_gazebo_node), gazebo_topic_(_gazebo_topic),
+        frame_name_(_frame_name), connect_count_(0),
+        pool_(new MessagePool<R>())
+    {
+      this->pub_queue_ = _pmq.addPub<boost::shared_ptr<R const> >();
+      ros::AdvertiseOptions ao = ros::AdvertiseOptions::create<R>(
+        _ros_topic, _queue_size,
+        boost::bind(&TransportBridgeChannelT::Connect, this),
+        boost::bind(&TransportBridgeChannelT::Disconnect, this),
+        ros::VoidPtr(), NULL);
+      this->pub_ = _rosnode.advertise(ao);
+    }
+
+    /// \brief Destructor, stops the gazebo subscription.
+    public: virtual ~TransportBridgeChannelT()
+    {
+      this->pub_.shutdown();
+      boost::mutex::scoped_lock lock(this->mutex_);
+      this->sub_.reset();
+    }
+
+    /// \brief Subscribe to the gazebo topic on the first ROS subscriber.
+    private: void Connect()
+    {
+      boost::mutex::scoped_lock lock(this->mutex_);
+      if (++this->connect_count_ == 1)
+        this->sub_ = this->gazebo_node_->Subscribe(this->gazebo_topic_,
+          &TransportBridgeChannelT::OnMessage, this);
+    }
+
+    /// \brief Unsubscribe when the last ROS subscriber leaves.
+    private: void Disconnect()
+    {
+      boost::mutex::scoped_lock lock(this->mutex_);
+      if (--this->connect_count_ == 0)
+        this->sub_.reset();
+    }
+
+    /// \brief Convert a gazebo message and publish it.
+    private: void OnMessage(const boost::shared_ptr<G const> &_msg)
+    {
+      GAZEBO_ROS_PROFILE("TransportBridge::OnMessage");
+      boost::shared_ptr<R> msg = this->pool_->Acquire();
+      TransportBridgeConverter<G, R>::Convert(*_msg, this->frame_name_, *msg);
+      boost::shared_ptr<R const> out(msg);
+      msg.reset();
+      SensorRecorder::Instance().Record(this->pub_, out);
+      this->pub_queue_->push(std::move(out), this->pub_);
+    }
+
+    private: transport::NodePtr gazebo_node_;
+    private: transport::SubscriberPtr sub_;
+    private: std::string gazebo_topic_;
+    private: std::string frame_name_;
+
+    /// \brief Number of ROS subscribers, guarded by mutex_ with sub_
+    private: int connect_count_;
+    private: boost::mutex mutex_;
+
+    private: ros::Publisher pub_;
+    private: typename PubQueue<boost::shared_ptr<R const> >::Ptr pub_queue_;
+    private: boost::shared_ptr<MessagePool<R> > pool_;
+  };
+
+  /// \brief Republishes gazebo transport topics on ROS topics, for topics
+  /// that have no dedicated plugin.
+  ///
+  /// A separate converter node subscribing to the gazebo topic deserializes
+  /// every message twice, once out of the gazebo transport and once out of
+  /// ROS. The bridge converts in process with a converter compiled for each
+  /// pair of types, see TransportBridgeConverter.
+  ///
+  /// Each <bridge> element of the plugin SDF adds a channel:
+  /// - <gazeboTopic>: gazebo topic, e.g. ~/robot/link/imu/imu
+  /// - <rosTopic>: ROS topic, relative to <robotNamespace>
+  /// - <type>: one of imu, laser_scan, pose, wrench, image, clock, gps or
+  ///   magnetometer
+  /// - <frameName>: header frame_id, default "world"
+  /// - <queueSize>: ROS publisher queue size, default 1
+  class GazeboRosTransportBridge : public WorldPlugin
+  {
+    /// \brief Constructor
+    public: GazeboRosTransportBridge();
+
+    /// \brief Destructor
+    public: virtual ~GazeboRosTransportBridge();
+
+    /// \brief Load the plugin
+    public: void Load(physics::WorldPtr _world, sdf::ElementPtr _sdf);
+
+    /// \brief Add the channel described by a <bridge> element.
+    /// \return False if the element is incomplete or of an unknown type.
+    private: bool AddChannel(sdf::ElementPtr _elem);
+
+    /// \brief pointer to ros node
+    private: ros::NodeHandle* rosnode_;
+    private: transport::NodePtr gazebo_node_;
+
+    /// \brief for setting ROS name space
+    private: std::string robot_namespace_;
+
+    private: PubMultiQueue pmq;
+
+    private: std::vector<TransportBridgeChannel::Ptr> channels_;
+  };
+}
+#endif
@@ -0,0 +1,248 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GAZEBO_ROS_TRANSPORT_BRIDGE_CONVERTERS_HH
+#define GAZEBO_ROS_TRANSPORT_BRIDGE_CONVERTERS_HH
+
+#include <string>
+
+#include <ros/ros.h>
+#include <geometry_msgs/PoseStamped.h>
+#include <geometry_msgs/WrenchStamped.h>
+#include <rosgraph_msgs/Clock.h>
+#include <sensor_msgs/Imu.h>
+#include <sensor_msgs/Image.h>
+#include <sensor_msgs/LaserScan.h>
+#include <sensor_msgs/MagneticField.h>
+#include <sensor_msgs/NavSatFix.h>
+#include <sensor_msgs/image_encodings.h>
+
+#include <gazebo/common/Image.hh>
+#include <gazebo/msgs/msgs.hh>
+
+namespace gazebo
+{
+  /// \brief Fills the ROS message R from the gazebo message G.
+  ///
+  /// Only the specializations below exist, one per pair of types, so each
+  /// conversion is compiled as plain field copies straight out of the
+  /// protobuf, without reflection or a second deserialization. Convert()
+  /// overwrites every field, the ROS message may be a recycled one from a
+  /// MessagePool; arrays are assigned to keep their capacity.
+  ///
+  /// Add a specialization, and an entry in the table of
+  /// GazeboRosTransportBridge, to bridge another pair.
+  template<class G, class R>
+  struct TransportBridgeConverter;
+
+  /// \brief Stamp of a gazebo time message.
+  inline ros::Time TransportBridgeStamp(const msgs::Time &_time)
+  {
+    return ros::Time(_time.sec(), _time.nsec());
+  }
+
+  template<>
+  struct TransportBridgeConverter<msgs::IMU, sensor_msgs::Imu>
+  {
+    static void Convert(const msgs::IMU &_in, const std::string &_frame,
+                        sensor_msgs::Imu &_out)
+    {
+      _out.header.stamp = TransportBridgeStamp(_in.stamp());
+      _out.header.frame_id = _frame;
+      _out.orientation.x = _in.orientation().x();
+      _out.orientation.y = _in.orientation().y();
+      _out.orientation.z = _in.orientation().z();
+      _out.orientation.w = _in.orientation().w();
+      _out.angular_velocity.x = _in.angular_velocity().x();
+      _out.angular_velocity.y = _in.angular_velocity().y();
+      _out.angular_velocity.z = _in.angular_velocity().z();
+      _out.linear_acceleration.x = _in.linear_acceleration().x();
+      _out.linear_acceleration.y = _in.linear_acceleration().y();
+      _out.linear_acceleration.z = _in.linear_acceleration().z();
+      // the gazebo message carries no covariance
+      _out.orientation_covariance.fill(0.0);
+      _out.angular_velocity_covariance.fill(0.0);
+      _out.linear_acceleration_covariance.fill(0.0);
+    }
+  };
+
+  template<>
+  struct TransportBridgeConverter<msgs::LaserScanStamped, sensor_msgs::LaserScan>
+  {
+    static void Convert(const msgs::LaserScanStamped &_in,
+                        const std::string &_frame,
+                        sensor_msgs::LaserScan &_out)
+    {
+      _out.header.stamp = TransportBridgeStamp(_in.time());
+      _out.header.frame_id = _frame;
+      _out.angle_min = _in.scan().angle_min();
+      _out.angle_max = _in.scan().angle_max();
+      _out.angle_increment = _in.scan().angle_step();
+      _out.time_increment = 0;  // instantaneous simulator scan
+      _out.scan_time = 0;
+      _out.range_min = _in.scan().range_min();
+      _out.range_max = _in.scan().range_max();
+      _out.ranges.assign(_in.scan().ranges().begin(),
+                         _in.scan().ranges().end());
+      _out.intensities.assign(_in.scan().intensities().begin(),
+                              _in.scan().intensities().end());
+    }
+  };
+
+  template<>
+  struct TransportBridgeConverter<msgs::PoseStamped, geometry_msgs::PoseStamped>
+  {
+    static void Convert(const msgs::PoseStamped &_in,
+                        const std::string &_frame,
+                        geometry_msgs::PoseStamped &_out)
+    {
+      _out.header.stamp = TransportBridgeStamp(_in.time());
+      _out.header.frame_id = _frame;
+      _out.pose.position.x = _in.pose().position().x();
+      _out.pose.position.y = _in.pose().position().y();
+      _out.pose.position.z = _in.pose().position().z();
+      _out.pose.orientation.x = _in.pose().orientation().x();
+      _out.pose.orientation.y = _in.pose().orientation().y();
+      _out.pose.orientation.z = _in.pose().orientation().z();
+      _out.pose.orientation.w = _in.pose().orientation().w();
+    }
+  };
+
+  template<>
+  struct TransportBridgeConverter<msgs::WrenchStamped,
+                                  geometry_msgs::WrenchStamped>
+  {
+    static void Convert(const msgs::WrenchStamped &_in,
+                        const std::string &_frame,
+                        geometry_msgs::WrenchStamped &_out)
+    {
+      _out.header.stamp = TransportBridgeStamp(_in.time());
+      _out.header.frame_id = _frame;
+      _out.wrench.force.x = _in.wrench().force().x();
+      _out.wrench.force.y = _in.wrench().force().y();
+      _out.wrench.force.z = _in.wrench().force().z();
+      _out.wrench.torque.x = _in.wrench().torque().x();
+      _out.wrench.torque.y = _in.wrench().torque().y();
+      _out.wrench.torque.z = _in.wrench().torque().z();
+    }
+  };
+
+  template<>
+  struct TransportBridgeConverter<msgs::ImageStamped, sensor_msgs::Image>
+  {
+    static void Convert(const msgs::ImageStamped &_in,
+                        const std::string &_frame,
+                        sensor_msgs::Image &_out)
+    {
+      _out.header.stamp = TransportBridgeStamp(_in.time());
+      _out.header.frame_id = _frame;
+      _out.height = _in.image().height();
+      _out.width = _in.image().width();
+      _out.step = _in.image().step();
+      _out.is_bigendian = 0;
+      _out.encoding = Encoding(_in.image().pixel_format());
+      const std::string &data = _in.image().data();
+      _out.data.assign(data.begin(), data.end());
+    }
+
+    /// \brief ROS encoding of a common::Image::PixelFormat.
+    static std::string Encoding(unsigned int _format)
+    {
+      switch (_format)
+      {
+        case common::Image::L_INT8:
+          return sensor_msgs::image_encodings::MONO8;
+        case common::Image::L_INT16:
+          return sensor_msgs::image_encodings::MONO16;
+        case common::Image::RGB_INT8:
+          return sensor_msgs::image_encodings::RGB8;
+        case common::Image::RGBA_INT8:
+          return sensor_msgs::image_encodings::RGBA8;
+        case common::Image::BGRA_INT8:
+          return sensor_msgs::image_encodings::BGRA8;
+        case common::Image::RGB_INT16:
+          return sensor_msgs::image_encodings::RGB16;
+        case common::Image::BGR_INT8:
+          return sensor_msgs::image_encodings::BGR8;
+        case common::Image::BGR_INT16:
+          return sensor_msgs::image_encodings::BGR16;
+        case common::Image::R_FLOAT32:
+          return sensor_msgs::image_encodings::TYPE_32FC1;
+        case common::Image::RGB_FLOAT32:
+          return sensor_msgs::image_encodings::TYPE_32FC3;
+        case common::Image::BAYER_RGGB8:
+          return sensor_msgs::image_encodings::BAYER_RGGB8;
+        case common::Image::BAYER_BGGR8:
+          return sensor_msgs::image_encodings::BAYER_BGGR8;
+        case common::Image::BAYER_GBRG8:
+          return sensor_msgs::image_encodings::BAYER_GBRG8;
+        case common::Image::BAYER_GRBG8:
+          return sensor_msgs::image_encodings::BAYER_GRBG8;
+        default:
+          return sensor_msgs::image_encodings::MONO8;
+      }
+    }
+  };
+
+  template<>
+  struct TransportBridgeConverter<msgs::WorldStatistics, rosgraph_msgs::Clock>
+  {
+    static void Convert(const msgs::WorldStatistics &_in,
+                        const std::string &/*_frame*/,
+                        rosgraph_msgs::Clock &_out)
+    {
+      _out.clock = TransportBridgeStamp(_in.sim_time());
+    }
+  };
+
+  template<>
+  struct TransportBridgeConverter<msgs::GPS, sensor_msgs::NavSatFix>
+  {
+    static void Convert(const msgs::GPS &_in, const std::string &_frame,
+                        sensor_msgs::NavSatFix &_out)
+    {
+      _out.header.stamp = TransportBridgeStamp(_in.time());
+      _out.header.frame_id = _frame;
+      _out.status.status = sensor_msgs::NavSatStatus::STATUS_FIX;
+      _out.status.service = sensor_msgs::NavSatStatus::SERVICE_GPS;
+      _out.latitude = _in.latitude_deg();
+      _out.longitude = _in.longitude_deg();
+      _out.altitude = _in.altitude();
+      _out.position_covariance.fill(0.0);
+      _out.position_covariance_type =
+        sensor_msgs::NavSatFix::COVARIANCE_TYPE_UNKNOWN;
+    }
+  };
+
+  template<>
+  struct TransportBridgeConverter<msgs::Magnetometer,
+                                  sensor_msgs::MagneticField>
+  {
+    static void Convert(const msgs::Magnetometer &_in,
+                        const std::string &_frame,
+                        sensor_msgs::MagneticField &_out)
+    {
+      _out.header.stamp = TransportBridgeStamp(_in.time());
+      _out.header.frame_id = _frame;
+      _out.magnetic_field.x = _in.field_tesla().x();
+      _out.magnetic_field.y = _in.field_tesla().y();
+      _out.magnetic_field.z = _in.field_tesla().z();
+      _out.magnetic_field_covariance.fill(0.0);
+    }
+  };
+}
+#endif
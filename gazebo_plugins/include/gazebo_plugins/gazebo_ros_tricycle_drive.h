@@ -45,6 +45,7 @@
 
 // Gazebo
 #include <gazebo_plugins/gazebo_ros_utils.h>
+#include <gazebo_plugins/gazebo_ros_drive_base.h>
 
 // ROS
 #include <ros/ros.h>
@@ -70,14 +71,7 @@ class Joint;
 class Entity;
 
 
-class GazeboRosTricycleDrive : public ModelPlugin {
-
-    class TricycleDriveCmd {
-    public:
-        TricycleDriveCmd():speed(0), angle(0) {};
-        double speed;
-        double angle;
-    };
+class GazeboRosTricycleDrive : public GazeboRosDriveBase {
 
     enum OdomSource
     {
@@ -96,17 +90,20 @@ protected:
 private:
     GazeboRosPtr gazebo_ros_;
     physics::ModelPtr parent;
-    void publishOdometry(double step_time);
-    void publishWheelTF(); /// publishes the wheel tf's
-    void publishWheelJointState();
+    void publishWheelTF(const ros::Time &current_time); /// queues the wheel tf's
+    void LoadThread(); /// advertises, subscribes and connects the update, maybe deferred
     void motorController(double target_speed, double target_angle, double dt);
 
     event::ConnectionPtr update_connection_;
+    DeferredLoad::TaskPtr deferred_load_task_;
 
     physics::JointPtr joint_steering_;
     physics::JointPtr joint_wheel_actuated_;
     physics::JointPtr joint_wheel_encoder_left_;
     physics::JointPtr joint_wheel_encoder_right_;
+    std::vector<physics::JointPtr> joints_;
+    std::vector<std::string> joint_frames_;
+    std::vector<std::string> joint_parent_frames_;
 
     double diameter_encoder_wheel_;
     double diameter_actuated_wheel_;
@@ -126,32 +123,7 @@ private:
     std::string odometry_frame_;
     std::string robot_base_frame_;
 
-    // ROS STUFF
-    ros::Publisher odometry_publisher_;
-    ros::Subscriber cmd_vel_subscriber_;
-    boost::shared_ptr<tf::TransformBroadcaster> transform_broadcaster_;
-    sensor_msgs::JointState joint_state_;
-    ros::Publisher joint_state_publisher_;
-    nav_msgs::Odometry odom_;
-
-    boost::mutex lock;
-
-
-    // Custom Callback Queue
-    ros::CallbackQueue queue_;
-    boost::thread callback_queue_thread_;
-    void QueueThread();
-
-    // DiffDrive stuff
-    void cmdVelCallback(const geometry_msgs::Twist::ConstPtr& cmd_msg);
-
-    /// updates the relative robot pose based on the wheel encoders
-    void UpdateOdometryEncoder();
-
-    TricycleDriveCmd cmd_;
     bool alive_;
-    geometry_msgs::Pose2D pose_encoder_;
-    common::Time last_odom_update_;
 
     // Update Rate
     double update_rate_;
@@ -24,11 +24,24 @@
 // library for processing camera data for gazebo / ros conversions
 #include <gazebo/plugins/CameraPlugin.hh>
 
+#include <gazebo_msgs/TriggerCameraBurst.h>
+
 #include <gazebo_plugins/gazebo_ros_camera_utils.h>
+#include <gazebo_plugins/camera_trigger_queue.h>
 
 namespace gazebo
 {
   class GazeboRosTriggeredMultiCamera;
+
+  /// \brief Camera that renders a frame per trigger.
+  ///
+  /// An std_msgs/Empty on image_trigger renders the next frame. The
+  /// image_trigger_burst service queues renders at given sim times, and
+  /// holds the physics at each of them while its frame renders, unless
+  /// asked for best effort. Every triggered frame is reported on
+  /// image_trigger_status with the queue depth and the number of missed
+  /// triggers. <triggerQueueDepth> (64) limits the queued triggers, and
+  /// <triggerTimeout> (1 s wall time) the time the physics is held.
   class GazeboRosTriggeredCamera : public CameraPlugin, GazeboRosCameraUtils
   {
     /// \brief Constructor
@@ -66,7 +79,37 @@ namespace gazebo
 
     protected: void PreRender();
 
-    protected: int triggered = 0;
+    /// \brief Read the trigger queue settings and connect its events.
+    private: void LoadTriggerQueue(sdf::ElementPtr _sdf);
+
+    /// \brief Advertise the burst service and status topic, once the ROS
+    /// node of the camera exists.
+    private: void AdvertiseTriggerQueue();
+
+    /// \brief Queue a burst of triggers.
+    private: bool TriggerBurst(gazebo_msgs::TriggerCameraBurst::Request &_req,
+                               gazebo_msgs::TriggerCameraBurst::Response &_res);
+
+    /// \brief Arm the sensor for due triggers, and hold the physics while
+    /// an exact trigger renders.
+    private: void OnWorldUpdateBegin();
+
+    /// \brief Current sim time.
+    private: common::Time SimTime() const;
+
+    /// \brief Queued triggers, shared by the cameras of a multicamera.
+    protected: boost::shared_ptr<CameraTriggerQueue> trigger_queue_;
+
+    /// \brief Longest time the physics is held for a trigger [s].
+    private: double trigger_timeout_;
+
+    private: ros::ServiceServer burst_service_;
+
+    private: ros::Publisher status_publisher_;
+
+    private: event::ConnectionPtr load_connection_;
+
+    private: event::ConnectionPtr update_connection_;
 
     protected: std::mutex mutex;
 
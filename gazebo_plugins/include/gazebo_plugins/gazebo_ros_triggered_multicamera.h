@@ -58,6 +58,9 @@ namespace gazebo
     private: boost::shared_ptr<boost::mutex> image_connect_count_lock_;
     private: boost::shared_ptr<bool> was_active_;
 
+    /// \brief Trigger queue shared by the cameras.
+    private: boost::shared_ptr<CameraTriggerQueue> trigger_queue_;
+
     protected: event::ConnectionPtr preRenderConnection_;
     protected: void SetCameraEnabled(const bool _enabled);
     protected: void PreRender();
@@ -42,6 +42,20 @@
 #include <gazebo/gazebo_config.h>
 #include <ros/ros.h>
 
+// GAZEBO_ROS_PROFILE macros of the ROS plugins
+#include <gazebo_ros/profiler.h>
+
+// startup trace of the plugin loads, and their shared deferred load pool
+#include <gazebo_ros/startup_trace.h>
+// transport_hints of the topics the plugins subscribe to
+#include <gazebo_ros/subscription_hints.h>
+#include <gazebo_plugins/deferred_load.h>
+
+/// \brief Record the rest of the enclosing scope of a plugin method as a
+/// phase of its load, under the handle name of the plugin
+#define GAZEBO_ROS_STARTUP_PHASE(phase) \
+  gazebo::ScopedStartupPhase GAZEBO_ROS_PROFILE_CONCAT(gazebo_ros_startup_, __LINE__)(this->handleName, phase)
+
 #ifndef GAZEBO_SENSORS_USING_DYNAMIC_POINTER_CAST
 # if GAZEBO_MAJOR_VERSION >= 7
 #define GAZEBO_SENSORS_USING_DYNAMIC_POINTER_CAST using std::dynamic_pointer_cast
@@ -101,6 +115,22 @@ inline std::string GetRobotNamespace ( const sensors::SensorPtr &parent, const s
     return name_space;
 }
 
+/**
+* Reads the transport hints of the subscriptions of a plugin: the
+* transport_hints parameter in the namespace of _node, overridden field by
+* field by the <transportHints> element of the plugin sdf, e.g.
+*   <transportHints>
+*     <tcpNoDelay>true</tcpNoDelay>
+*     <udp>false</udp>
+*     <maxDatagramSize>0</maxDatagramSize>
+*     <queueSize>0</queueSize>
+*   </transportHints>
+* @param _node node handle the plugin subscribes with
+* @param _sdf sdf of the plugin, may be null
+* @return hints to apply() to every ros::SubscribeOptions of the plugin
+**/
+SubscriptionHints GetSubscriptionHints ( const ros::NodeHandle &_node, const sdf::ElementPtr &_sdf );
+
 /**
  * Gazebo ros helper class
  * The class simplifies the parameter and rosnode handling
@@ -24,6 +24,7 @@
 #define GAZEBO_ROS_VACUUM_GRIPPER_HH
 
 #include <string>
+#include <vector>
 
 // Custom Callback Queue
 #include <ros/callback_queue.h>
@@ -39,6 +40,7 @@
 #include <gazebo/transport/TransportTypes.hh>
 #include <gazebo/common/Plugin.hh>
 #include <gazebo/common/Events.hh>
+#include <gazebo_plugins/shared_callback_executor.h>
 
 
 namespace gazebo
@@ -83,6 +85,9 @@ namespace gazebo
         <robotNamespace>/robot/left_vacuum_gripper</robotNamespace>
         <bodyName>left_end_effector</bodyName>
         <topicName>grasping</topicName>
+        <!-- optional, see below -->
+        <searchSkin>0.5</searchSkin>
+        <searchPeriod>0.1</searchPeriod>
       </plugin>
     </gazebo>
   \endverbatim
@@ -106,14 +111,17 @@ class GazeboRosVacuumGripper : public ModelPlugin
   // Documentation inherited
   protected: virtual void UpdateChild();
 
-  /// \brief The custom callback queue thread function.
-  private: void QueueThread();
-
   private: bool OnServiceCallback(std_srvs::Empty::Request &req,
                                 std_srvs::Empty::Response &res);
   private: bool OffServiceCallback(std_srvs::Empty::Request &req,
                                 std_srvs::Empty::Response &res);
 
+  /// \brief Rebuild candidates_ from the links of the world.
+  /// \param[in] _origin Position of the power point.
+  /// \param[in] _time Current simulation time.
+  private: void SearchCandidates(const ignition::math::Vector3d &_origin,
+                                 const common::Time &_time);
+
   private: bool status_;
 
   private: physics::ModelPtr parent_;
@@ -143,13 +151,35 @@ class GazeboRosVacuumGripper : public ModelPlugin
   private: std::string robot_namespace_;
 
   // Custom Callback Queue
-  private: ros::CallbackQueue queue_;
-  /// \brief Thead object for the running callback Thread.
-  private: boost::thread callback_queue_thread_;
+  private: SharedCallbackQueue queue_;
 
   // Pointer to the update event connection
   private: event::ConnectionPtr update_connection_;
 
+  /// \brief Links of other models near the power point.
+  private: std::vector<physics::LinkPtr> candidates_;
+
+  /// \brief Position of the power point when candidates_ was built.
+  private: ignition::math::Vector3d search_origin_;
+
+  /// \brief Simulation time when candidates_ was built.
+  private: common::Time search_time_;
+
+  /// \brief Number of models of the world when candidates_ was built.
+  private: unsigned int search_model_count_;
+
+  /// \brief False until candidates_ is built.
+  private: bool search_valid_;
+
+  /// \brief Margin of the candidate list beyond the grasp distance [m].
+  private: double search_skin_;
+
+  /// \brief Rebuild period of the candidate list while idle [s].
+  private: double search_period_;
+
+  /// \brief Number of links grasped at the last update.
+  private: unsigned int grasped_count_;
+
   /// \brief: keep track of number of connections
   private: int connect_count_;
   private: void Connect();
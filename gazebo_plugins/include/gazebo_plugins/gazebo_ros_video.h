@@ -38,10 +38,12 @@
 #include <gazebo/common/Time.hh>
 #include <gazebo/rendering/rendering.hh>
 #include <gazebo/transport/TransportTypes.hh>
+#include <gazebo_plugins/shared_callback_executor.h>
 
 namespace gazebo
 {
 
+  /// \brief A textured quad showing a video.
   class VideoVisual : public rendering::Visual
   {
     public:
@@ -49,6 +51,8 @@ namespace gazebo
           const std::string &name, rendering::VisualPtr parent,
           int height, int width);
       virtual ~VideoVisual();
+      /// \brief Upload a BGRA image to the texture, the image is resized
+      /// first if it does not have the size of the texture.
       void render(const cv::Mat& image);
     private:
       Ogre::TexturePtr texture_;
@@ -56,6 +60,13 @@ namespace gazebo
       int width_;
   };
 
+  /// \brief Shows a ROS image topic on a visual.
+  ///
+  /// Images are converted to BGRA and resized to the texture on the callback
+  /// queue worker, so the render thread only uploads them. Three buffers
+  /// rotate between the worker, the latest complete frame and the render
+  /// thread, which only takes a frame it has not shown yet. Images with the
+  /// stamp of the previous one are dropped.
   class GazeboRosVideo : public VisualPlugin
   {
     public:
@@ -77,10 +88,26 @@ namespace gazebo
 
       boost::shared_ptr<VideoVisual> video_visual_;
 
-      cv_bridge::CvImagePtr image_;
+      // Convert an image message to BGRA of the texture size into _image
+      void convertImage(const sensor_msgs::ImageConstPtr &msg, cv::Mat &_image);
+
+      // Image being converted, owned by the callback queue
+      cv::Mat converted_image_;
+      // Intermediate BGRA image when resizing, owned by the callback queue
+      cv::Mat bgra_image_;
+      // Stamp of the last image received
+      ros::Time last_stamp_;
+      // Latest complete image, guarded by m_image_
+      cv::Mat ready_image_;
+      // Image being uploaded, owned by the render thread
+      cv::Mat render_image_;
       boost::mutex m_image_;
       bool new_image_available_;
 
+      // Texture size
+      int height_;
+      int width_;
+
       /// \brief A pointer to the ROS node.  A node will be instantiated if it does not exist.
       ros::NodeHandle* rosnode_;
 
@@ -89,9 +116,7 @@ namespace gazebo
       std::string robot_namespace_;
       std::string topic_name_;
 
-      ros::CallbackQueue queue_;
-      boost::thread callback_queue_thread_;
-      void QueueThread();
+      SharedCallbackQueue queue_;
 
   };
 
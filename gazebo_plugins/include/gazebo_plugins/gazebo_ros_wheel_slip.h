@@ -17,17 +17,27 @@
 #ifndef GAZEBO_ROS_WHEEL_SLIP_H
 #define GAZEBO_ROS_WHEEL_SLIP_H
 
+#include <string>
+#include <vector>
+
 // Custom Callback Queue
 #include <ros/callback_queue.h>
 #include <ros/subscribe_options.h>
 
 #include <ros/ros.h>
 #include <std_msgs/Bool.h>
+#include <gazebo_msgs/WheelContacts.h>
+#include <gazebo_msgs/WheelSlipCompliance.h>
+
+#include <boost/thread/mutex.hpp>
 
 // dynamic reconfigure stuff
 #include <gazebo_plugins/WheelSlipConfig.h>
+#include <gazebo_plugins/shared_callback_executor.h>
 #include <dynamic_reconfigure/server.h>
 
+#include <gazebo/common/Time.hh>
+#include <gazebo/physics/ode/ODESurfaceParams.hh>
 #include <gazebo/plugins/WheelSlipPlugin.hh>
 
 namespace gazebo
@@ -46,6 +56,21 @@ namespace gazebo
 ///      - Description: Unitless slip compliance (slip / friction) in the
 ///           longitudinal direction. This value is applied to all wheels declared
 ///           in the WheelSlipPlugin.
+///
+/// The compliance of each wheel can also be streamed, e.g. by a terrain
+/// model, as gazebo_msgs/WheelSlipCompliance on the topic <complianceTopic>
+/// (default "slip_compliance").  It is applied at the next world update.
+/// The wheels are numbered in the order of the <wheel> elements, whose
+/// link names are set as the parameter "wheels".
+///
+/// While someone subscribes to <contactTopic> (default "wheel_contacts"),
+/// the collision each wheel touches and its slip velocities are published
+/// for all wheels in one gazebo_msgs/WheelContacts at <contactUpdateRate>
+/// (default 50 Hz, 0 for every update).
+///
+/// WheelSlipPlugin keeps one compliance for all wheels; this plugin sets it
+/// to 1 and scales the slip of each wheel's ODE surface by the wheel's own
+/// compliance after the WheelSlipPlugin update.
 class GazeboRosWheelSlip : public WheelSlipPlugin
 {
     /// \brief Constructor
@@ -57,14 +82,58 @@ class GazeboRosWheelSlip : public WheelSlipPlugin
     /// \brief Load the plugin
     public: virtual void Load(physics::ModelPtr _parent, sdf::ElementPtr _sdf);
 
-    /// \brief Custom callback queue thread
-    private: void QueueThread();
+    /// \brief Apply the compliance of each wheel and publish the contacts
+    protected: virtual void Update();
 
     // Allow dynamic reconfiguration of wheel slip params
     private: void configCallback(
                     gazebo_plugins::WheelSlipConfig &config,
                     uint32_t level);
 
+    /// \brief Set the compliance of some wheels from a topic
+    private: void OnCompliance(
+                    const gazebo_msgs::WheelSlipCompliance::ConstPtr &_msg);
+
+    /// \brief Publish the contacts and slips of all wheels
+    private: void PublishContacts(const common::Time &_time);
+
+    private: void ContactConnect();
+    private: void ContactDisconnect();
+
+    /// \brief Wheel links, in the order of the <wheel> elements
+    private: std::vector<std::string> wheel_names_;
+
+    /// \brief ODE surface of each wheel, null if it has none
+    private: std::vector<physics::ODESurfaceParams *> surfaces_;
+
+    /// \brief Collision of each wheel, and its scoped name
+    private: std::vector<physics::Collision *> collisions_;
+    private: std::vector<std::string> collision_names_;
+
+    /// \brief Compliance applied to each wheel, used by Update()
+    private: std::vector<double> lateral_;
+    private: std::vector<double> longitudinal_;
+
+    /// \brief Compliance requested by the callbacks, copied to lateral_ and
+    /// longitudinal_ at the next update
+    private: std::vector<double> requested_lateral_;
+    private: std::vector<double> requested_longitudinal_;
+    private: bool requested_;
+    private: boost::mutex lock_;
+
+    private: ros::Subscriber compliance_sub_;
+    private: ros::Publisher contact_pub_;
+
+    /// \brief Subscribers of contact_pub_, protected by lock_
+    private: int contact_connect_count_;
+
+    /// \brief Name of the contact filter, empty while there is none
+    private: std::string contact_filter_;
+
+    private: gazebo_msgs::WheelContacts contact_msg_;
+    private: double contact_update_period_;
+    private: common::Time last_contact_time_;
+
     /// \brief pointer to ros node
     private: ros::NodeHandle *rosnode_;
 
@@ -74,8 +143,7 @@ class GazeboRosWheelSlip : public WheelSlipPlugin
 
     /// \brief for setting ROS name space
     private: std::string robotNamespace_;
-    private: ros::CallbackQueue queue_;
-    private: boost::thread callbackQueueThread_;
+    private: SharedCallbackQueue queue_;
 };
 }
 #endif
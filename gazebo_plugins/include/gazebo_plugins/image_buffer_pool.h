@@ -0,0 +1,34 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GAZEBO_ROS_IMAGE_BUFFER_POOL_HH
+#define GAZEBO_ROS_IMAGE_BUFFER_POOL_HH
+
+#include <boost/shared_ptr.hpp>
+
+#include <sensor_msgs/Image.h>
+
+#include <gazebo_plugins/message_pool.h>
+
+namespace gazebo
+{
+  /// \brief Recycles sensor_msgs::Image messages, data buffers included,
+  /// see MessagePool.
+  typedef MessagePool<sensor_msgs::Image> ImageBufferPool;
+  typedef boost::shared_ptr<ImageBufferPool> ImageBufferPoolPtr;
+}
+#endif
@@ -0,0 +1,71 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GAZEBO_ROS_IMAGE_FORMAT_KERNELS_HH
+#define GAZEBO_ROS_IMAGE_FORMAT_KERNELS_HH
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace gazebo
+{
+  /// \brief Pixel format conversions of rendered 8 bit camera frames, done
+  /// while copying them into the outgoing image.
+  ///
+  /// As in depth_kernels, every kernel has a scalar implementation and
+  /// SSSE3 (x86) or NEON (ARM) ones.  The fastest one the CPU supports is
+  /// picked at the first call; set the environment variable
+  /// GAZEBO_ROS_IMAGE_KERNELS to "scalar", "ssse3" or "neon" to force one.
+  /// Source and destination must not overlap.
+  namespace image_kernels
+  {
+    /// \brief Name of the implementation in use.
+    const char *Implementation();
+
+    /// \brief Force an implementation, for tests.
+    /// \return false if _name is unknown or not supported by this CPU
+    bool SetImplementation(const char *_name);
+
+    /// \brief Swap the first and third byte of _n 3 byte pixels, i.e.
+    /// RGB to BGR and back.
+    void SwapRedBlue(const uint8_t *_src, uint8_t *_dst, size_t _n);
+
+    /// \brief ITU-R BT.601 luma of _n RGB pixels, or BGR pixels if _bgr,
+    /// in 8 bit fixed point.
+    void ColorToMono(const uint8_t *_src, uint8_t *_dst, size_t _n,
+                     bool _bgr);
+
+    /// \brief One row of a bayer mosaic from _n 3 byte pixels: even pixels
+    /// keep byte _even of their pixel, odd pixels byte _odd.
+    void ColorToBayerRow(const uint8_t *_src, uint8_t *_dst, size_t _n,
+                         int _even, int _odd);
+
+    /// \brief _dst[i] = _src[i] * 257, i.e. 0-255 to the full 16 bit range.
+    void Expand8To16(const uint8_t *_src, uint16_t *_dst, size_t _n);
+
+    /// \brief One row of a half resolution image: each of the _n pixels of
+    /// _dst is the rounded mean of a 2x2 block of the rows _row0 and _row1,
+    /// which hold at least 2 * _n pixels of _channels bytes.
+    void Downsample2x2(const uint8_t *_row0, const uint8_t *_row1,
+                       uint8_t *_dst, size_t _n, int _channels);
+
+    /// \brief Downsample2x2() of 16 bit channels, scalar only.
+    void Downsample2x2(const uint16_t *_row0, const uint16_t *_row1,
+                       uint16_t *_dst, size_t _n, int _channels);
+  }
+}
+#endif
@@ -0,0 +1,87 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GAZEBO_ROS_IMU_BATCH_HH
+#define GAZEBO_ROS_IMU_BATCH_HH
+
+#include <string>
+
+#include <ros/ros.h>
+#include <sdf/sdf.hh>
+#include <sensor_msgs/Imu.h>
+#include <gazebo_msgs/ImuArray.h>
+
+namespace gazebo
+{
+  /// \brief Batched output of the IMU plugins.
+  ///
+  /// High rate IMUs publish one small message per sample. With
+  /// <batchSize> set, the samples are also copied into a preallocated
+  /// gazebo_msgs/ImuArray, published on <batchTopicName> every
+  /// <batchSize> samples. <sampleDecimation> publishes only one sample out
+  /// of that many on the single sample topic, for consumers that only need
+  /// the latest one.
+  class ImuBatch
+  {
+    /// \brief Constructor
+    public: ImuBatch();
+
+    /// \brief Read <batchSize> (default 0, no batching), <batchTopicName>
+    /// (default <topicName>_batch) and <sampleDecimation> (default 1, every
+    /// sample).
+    /// \param[in] _sdf SDF of the plugin.
+    /// \param[in] _topic_name Single sample topic.
+    public: void Load(sdf::ElementPtr _sdf, const std::string &_topic_name);
+
+    /// \brief Advertise the batch topic, if batching is enabled.
+    public: void Advertise(ros::NodeHandle &_node);
+
+    /// \brief True if the batch topic has subscribers, and Add() should be
+    /// given samples.
+    public: bool Active() const;
+
+    /// \brief Count a sample for the single sample topic.
+    /// \return True if this sample should be published there.
+    public: bool SingleDue();
+
+    /// \brief Copy a sample into the batch, and publish the batch once it
+    /// is full. A sample with the stamp of the previous one is ignored.
+    public: void Add(const sensor_msgs::Imu &_sample);
+
+    /// \brief Drop the samples of the current batch.
+    public: void Reset();
+
+    /// \brief Batch publisher.
+    private: ros::Publisher pub_;
+
+    /// \brief Batch topic.
+    private: std::string topic_name_;
+
+    /// \brief Batch being filled, sized to the batch size at load.
+    private: gazebo_msgs::ImuArray msg_;
+
+    /// \brief Number of samples in msg_.
+    private: size_t count_;
+
+    /// \brief Publish one sample out of decimation_ on the single topic.
+    private: unsigned int decimation_;
+
+    /// \brief Samples counted by SingleDue() since the last due one.
+    private: unsigned int skipped_;
+  };
+}
+#endif
@@ -0,0 +1,121 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GAZEBO_ROS_LASER_INTENSITY_HH
+#define GAZEBO_ROS_LASER_INTENSITY_HH
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <string>
+
+#include <sdf/sdf.hh>
+
+#include <sensor_msgs/PointCloud2.h>
+#include <sensor_msgs/PointField.h>
+
+namespace gazebo
+{
+  /// \brief Intensity output of the laser plugins, read from sdf:
+  ///
+  ///   <intensities>true</intensities>
+  ///     true to always publish them, false to never read them from the
+  ///     sensor, auto to leave them out of scans where they are all 0
+  ///   <intensityType>float32</intensityType>
+  ///     field type of the intensity in point clouds, uint16 or uint8
+  ///     store the intensity times <intensityScale>, rounded and clamped
+  ///   <intensityScale>1.0</intensityScale>
+  ///
+  /// A sensor_msgs::LaserScan without intensities has an empty array, a
+  /// point cloud no intensity field.
+  class LaserIntensity
+  {
+    public: enum Mode { ALWAYS, NEVER, NONZERO };
+
+    /// \brief Constructor, intensities always published as float32
+    public: LaserIntensity()
+      : mode_(ALWAYS), datatype_(sensor_msgs::PointField::FLOAT32),
+        scale_(1.0f) {}
+
+    /// \brief Read the sdf parameters
+    /// \param[in] _logger Logger name of the plugin
+    public: void Load(sdf::ElementPtr _sdf, const std::string &_logger);
+
+    /// \brief Whether intensities are read from the sensor at all
+    public: bool Enabled() const
+    {
+      return this->mode_ != NEVER;
+    }
+
+    /// \brief Whether the intensities [_begin, _end) of a scan are
+    /// published, false if there are none
+    public: template <class It> bool Output(It _begin, It _end) const
+    {
+      if (this->mode_ == NEVER || _begin == _end)
+        return false;
+      if (this->mode_ == ALWAYS)
+        return true;
+      for (It it = _begin; it != _end; ++it)
+      {
+        if (*it != 0)
+          return true;
+      }
+      return false;
+    }
+
+    /// \brief Set the float32 x, y, z fields of _cloud, followed by the
+    /// intensity if _intensity, and its point_step.  Nothing changes if
+    /// _cloud has that layout already.
+    public: void SetFields(sensor_msgs::PointCloud2 &_cloud,
+                           bool _intensity) const;
+
+    /// \brief Write _value into the intensity field at _dst
+    public: void Write(uint8_t *_dst, float _value) const
+    {
+      switch (this->datatype_)
+      {
+        case sensor_msgs::PointField::UINT8:
+        {
+          const uint8_t v = static_cast<uint8_t>(
+            std::min(std::max(std::round(_value * this->scale_), 0.0f), 255.0f));
+          *_dst = v;
+          break;
+        }
+        case sensor_msgs::PointField::UINT16:
+        {
+          const uint16_t v = static_cast<uint16_t>(
+            std::min(std::max(std::round(_value * this->scale_), 0.0f), 65535.0f));
+          memcpy(_dst, &v, sizeof(v));
+          break;
+        }
+        default:
+          memcpy(_dst, &_value, sizeof(_value));
+          break;
+      }
+    }
+
+    private: Mode mode_;
+
+    /// \brief sensor_msgs::PointField type of the intensity field
+    private: uint8_t datatype_;
+
+    private: float scale_;
+  };
+}
+#endif
@@ -0,0 +1,71 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GAZEBO_ROS_LASER_SCAN_PROJECTOR_HH
+#define GAZEBO_ROS_LASER_SCAN_PROJECTOR_HH
+
+#include <vector>
+
+#include <gazebo/msgs/MessageTypes.hh>
+
+#include <sensor_msgs/PointCloud2.h>
+
+#include <gazebo_plugins/laser_intensity.h>
+
+namespace gazebo
+{
+  /// \brief Projects Gazebo laser scans into x, y, z, intensity point
+  /// clouds in the sensor frame, the way laser_geometry::LaserProjection
+  /// does: beams outside [range_min, range_max] are left out.
+  ///
+  /// The sin/cos of every beam is computed once from angle_min and
+  /// angle_step and reused until the scan geometry changes.  Scans with
+  /// several vertical rows (count * vertical_count ranges) are projected
+  /// row by row.
+  class LaserScanProjector
+  {
+    /// \brief Constructor
+    public: LaserScanProjector();
+
+    /// \brief Fill _cloud with the points of _scan.  Only the header is
+    /// left untouched, _cloud keeps its storage when it is reused.
+    /// \param[in] _intensity Whether, and as which type, the intensities
+    /// go into the cloud
+    public: void Project(const msgs::LaserScan &_scan,
+                         sensor_msgs::PointCloud2 &_cloud,
+                         const LaserIntensity &_intensity);
+
+    /// \brief Rebuild the tables if the geometry of _scan changed
+    private: void UpdateTables(const msgs::LaserScan &_scan, int _count,
+                               int _vertical_count);
+
+    /// \brief Geometry the tables were built for
+    private: int count_;
+    private: int vertical_count_;
+    private: double angle_min_;
+    private: double angle_step_;
+    private: double vertical_angle_min_;
+    private: double vertical_angle_step_;
+
+    /// \brief Per beam and per vertical row
+    private: std::vector<float> cos_yaw_;
+    private: std::vector<float> sin_yaw_;
+    private: std::vector<float> cos_pitch_;
+    private: std::vector<float> sin_pitch_;
+  };
+}
+#endif
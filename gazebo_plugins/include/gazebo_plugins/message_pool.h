@@ -0,0 +1,140 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GAZEBO_ROS_MESSAGE_POOL_HH
+#define GAZEBO_ROS_MESSAGE_POOL_HH
+
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/enable_shared_from_this.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
+namespace gazebo
+{
+  /// \brief Recycles ROS messages of type M, their arrays included.
+  ///
+  /// Acquire() hands out a fresh shared pointer whose deleter gives the
+  /// message back to the pool once the last holder (a PubQueue slot, our
+  /// own publisher, an intra-process subscriber) releases it, so a message
+  /// can be published as a const shared pointer without ever being copied
+  /// again, and without reallocating its arrays from message to message.
+  ///
+  /// Must be held by a boost::shared_ptr, messages in flight keep the pool
+  /// alive.
+  template <class M>
+  class MessagePool : public boost::enable_shared_from_this<MessagePool<M> >
+  {
+    public: typedef boost::shared_ptr<M> MessagePtr;
+
+    /// \brief Constructor
+    /// \param[in] _max_free Number of released messages kept for reuse,
+    /// messages released beyond that are freed
+    public: explicit MessagePool(size_t _max_free = 4)
+      : max_free_(_max_free), in_flight_(0), allocated_(0)
+    {
+    }
+
+    /// \brief Destructor
+    public: ~MessagePool()
+    {
+      for (size_t i = 0; i < this->free_.size(); ++i)
+        delete this->free_[i];
+    }
+
+    /// \brief Get a message to fill, recycled if one is available.  Its
+    /// arrays keep the size they had when it was released.
+    public: MessagePtr Acquire()
+    {
+      M *msg = NULL;
+      {
+        boost::mutex::scoped_lock lock(this->lock_);
+        if (!this->free_.empty())
+        {
+          msg = this->free_.back();
+          this->free_.pop_back();
+        }
+        else
+        {
+          ++this->allocated_;
+        }
+        ++this->in_flight_;
+      }
+      if (!msg)
+        msg = new M();
+      return MessagePtr(msg,
+        boost::bind(&MessagePool<M>::Release, this->shared_from_this(), _1));
+    }
+
+    /// \brief Free the messages kept for reuse, e.g. once nobody subscribes
+    /// any more.  Messages in flight still come back to the pool.
+    public: void Trim()
+    {
+      std::vector<M *> free;
+      {
+        boost::mutex::scoped_lock lock(this->lock_);
+        free.swap(this->free_);
+      }
+      for (size_t i = 0; i < free.size(); ++i)
+        delete free[i];
+    }
+
+    /// \brief Number of messages handed out and not yet released.
+    public: size_t InFlight()
+    {
+      boost::mutex::scoped_lock lock(this->lock_);
+      return this->in_flight_;
+    }
+
+    /// \brief Number of messages allocated since construction.
+    public: size_t Allocated()
+    {
+      boost::mutex::scoped_lock lock(this->lock_);
+      return this->allocated_;
+    }
+
+    /// \brief Deleter of the pointers returned by Acquire().
+    private: static void Release(boost::shared_ptr<MessagePool<M> > _pool,
+                                 M *_msg)
+    {
+      {
+        boost::mutex::scoped_lock lock(_pool->lock_);
+        --_pool->in_flight_;
+        if (_pool->free_.size() < _pool->max_free_)
+        {
+          _pool->free_.push_back(_msg);
+          return;
+        }
+      }
+      delete _msg;
+    }
+
+    /// \brief Protects the members below.
+    private: boost::mutex lock_;
+
+    /// \brief Messages ready for reuse.
+    private: std::vector<M *> free_;
+
+    private: size_t max_free_;
+
+    private: size_t in_flight_;
+
+    private: size_t allocated_;
+  };
+}
+#endif
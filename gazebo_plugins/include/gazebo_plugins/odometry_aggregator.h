@@ -0,0 +1,91 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GAZEBO_ROS_ODOMETRY_AGGREGATOR_HH
+#define GAZEBO_ROS_ODOMETRY_AGGREGATOR_HH
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include <boost/thread/mutex.hpp>
+
+#include <nav_msgs/Odometry.h>
+#include <gazebo_msgs/OdometryArray.h>
+
+namespace gazebo
+{
+  /// \brief Process-wide collection of the odometry of the mobile bases, so
+  /// that a world with many robots can publish all of it as one
+  /// gazebo_msgs/OdometryArray instead of one topic per robot.
+  ///
+  /// The drive plugins submit their odometry while the aggregator is
+  /// active, which GazeboRosOdometryAggregator makes it while someone
+  /// subscribes to the array. Otherwise submitting is a single atomic load.
+  class OdometryAggregator
+  {
+    /// \brief The aggregator shared by all plugins of the process.
+    public: static OdometryAggregator &Instance();
+
+    /// \brief True if odometry should be submitted.
+    public: bool Active() const;
+
+    /// \brief Start or stop collecting odometry.
+    public: void SetActive(bool _active);
+
+    /// \brief Add a model to the array.
+    /// \param[in] _name Model name, reported with its odometry.
+    /// \return Slot to submit the odometry of the model to.
+    public: int Register(const std::string &_name);
+
+    /// \brief Remove a model from the array.
+    public: void Unregister(int _slot);
+
+    /// \brief Store the latest odometry of a model.
+    public: void Submit(int _slot, const nav_msgs::Odometry &_odom);
+
+    /// \brief Fill _msg with the latest odometry of every model that
+    /// submitted any. The vectors of _msg are reused.
+    /// \return False if nothing was submitted since the last call.
+    public: bool Collect(gazebo_msgs::OdometryArray &_msg);
+
+    /// \brief Constructor, use Instance().
+    private: OdometryAggregator();
+
+    /// \brief A registered model.
+    private: struct Slot
+    {
+      std::string name;
+      nav_msgs::Odometry odom;
+      bool used;
+      bool valid;
+    };
+
+    /// \brief Registered models, reused after Unregister().
+    private: std::vector<Slot> slots_;
+
+    /// \brief True if odometry was submitted since the last Collect().
+    private: bool updated_;
+
+    /// \brief Protects slots_ and updated_.
+    private: boost::mutex mutex_;
+
+    /// \brief True while odometry is collected.
+    private: std::atomic<bool> active_;
+  };
+}
+#endif
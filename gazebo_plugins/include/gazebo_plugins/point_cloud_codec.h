@@ -0,0 +1,83 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GAZEBO_ROS_POINT_CLOUD_CODEC_HH
+#define GAZEBO_ROS_POINT_CLOUD_CODEC_HH
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include <gazebo_msgs/CompressedPointCloud.h>
+#include <sensor_msgs/PointCloud2.h>
+
+namespace gazebo
+{
+  /// \brief Encoder and decoder of gazebo_msgs/CompressedPointCloud, in the
+  /// gazebo_ros_point_cloud_codec library, which needs neither Gazebo nor
+  /// the plugins, for the receiving side.
+  ///
+  /// The float32 x, y, z of each point are quantized to the resolution,
+  /// the points sorted in Morton order, i.e. the depth first order of an
+  /// octree, and each position coded as the zigzag varint difference to the
+  /// previous one, which is small for neighbours.  The other fields follow
+  /// as byte planes, each byte of a field for all points in turn.  With
+  /// entropy coding the whole is then compressed with bzip2.
+  ///
+  /// A decoded cloud is unorganized and dense: points whose position was
+  /// not finite are not coded.
+  class PointCloudCodec
+  {
+    /// \brief Constructor
+    /// \param[in] _resolution Quantization of the positions [m]
+    /// \param[in] _entropy Whether to compress with bzip2
+    public: explicit PointCloudCodec(float _resolution = 0.001f,
+                                     bool _entropy = true);
+
+    /// \brief Encode _cloud into _msg, header included.  The work buffers
+    /// are kept for the next cloud.
+    /// \return False if the cloud has no float32 x, y and z fields
+    public: bool Encode(const sensor_msgs::PointCloud2 &_cloud,
+                        gazebo_msgs::CompressedPointCloud &_msg);
+
+    /// \brief Decode _msg into _cloud.
+    /// \param[out] _error Why the message could not be decoded
+    /// \return False if the message is not a valid encoded cloud
+    public: static bool Decode(const gazebo_msgs::CompressedPointCloud &_msg,
+                               sensor_msgs::PointCloud2 &_cloud,
+                               std::string &_error);
+
+    private: struct Point
+    {
+      uint64_t key_;
+      int32_t q_[3];
+      uint32_t index_;
+    };
+
+    private: float resolution_;
+
+    private: bool entropy_;
+
+    /// \brief Quantized points of the cloud being encoded.
+    private: std::vector<Point> points_;
+
+    /// \brief Stream before entropy coding.
+    private: std::vector<uint8_t> raw_;
+  };
+}
+#endif
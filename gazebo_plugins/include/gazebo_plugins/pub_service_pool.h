@@ -0,0 +1,126 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef ROS_PUB_SERVICE_POOL_H
+#define ROS_PUB_SERVICE_POOL_H
+
+#include <deque>
+
+#include <boost/atomic.hpp>
+#include <boost/function.hpp>
+#include <boost/scoped_array.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/enable_shared_from_this.hpp>
+#include <boost/thread.hpp>
+
+/// \brief Unit of work of the PubServicePool: servicing one PubQueue.
+/// A task is run by at most one worker at a time, so the messages of a queue
+/// are still published in the order they were pushed.
+class PubServiceTask : public boost::enable_shared_from_this<PubServiceTask>
+{
+  public:
+    typedef boost::shared_ptr<PubServiceTask> Ptr;
+
+    enum State
+    {
+      /// \brief Nothing to publish.
+      IDLE,
+      /// \brief Sitting in a worker deque.
+      SCHEDULED,
+      /// \brief Being run by a worker.
+      RUNNING,
+      /// \brief Being run, and rescheduled by a push since it started.
+      RUNNING_DIRTY,
+      /// \brief Never run again.
+      CANCELLED
+    };
+
+    explicit PubServiceTask(const boost::function<void()>& _run) :
+      run_(_run), state_(IDLE) {}
+
+    /// \brief Publishes everything waiting in the queue.
+    boost::function<void()> run_;
+    boost::atomic<int> state_;
+};
+
+/// \brief Process-wide pool of publishing threads that PubMultiQueue
+/// instances can attach to instead of starting one service thread each.
+///
+/// Every worker owns a deque of ready tasks.  Tasks submitted from the sensor
+/// threads are spread round-robin across the deques; a worker that runs out
+/// of work steals from the back of the others' deques, so a queue that takes
+/// long to serialize (e.g. a block laser point cloud) only occupies one worker
+/// while light topics keep flowing through the rest.
+///
+/// The pool size defaults to the number of cores and can be set with the ROS
+/// parameter gazebo/pub_service_pool_threads before the first use.  Like
+/// every parameter of the pool it is relative to the namespace of the
+/// process, i.e. /gazebo/... unless gzserver runs in a namespace.
+class PubServicePool
+{
+  public:
+    /// \brief Get the pool shared by all plugins of this process, starting it
+    /// on first use.
+    static PubServicePool& instance();
+
+    /// \brief Whether PubMultiQueue::startService() should use the pool,
+    /// from the ROS parameter gazebo/use_pub_service_pool (default false).
+    static bool enabled();
+
+    ~PubServicePool();
+
+    /// \brief Make sure _task gets run, unless it still has to run anyway.
+    void submit(PubServiceTask *_task);
+
+    /// \brief Prevent _task from being run again and wait for a worker
+    /// currently running it to return.
+    void cancel(const PubServiceTask::Ptr& _task);
+
+    size_t threadCount() const;
+
+  private:
+    struct Worker
+    {
+      boost::mutex lock_;
+      std::deque<PubServiceTask::Ptr> tasks_;
+    };
+
+    explicit PubServicePool(size_t _threads);
+
+    void enqueue(size_t _worker, const PubServiceTask::Ptr& _task);
+
+    /// \brief Pop from our own deque, or steal from another one.
+    PubServiceTask::Ptr take(size_t _worker);
+
+    void work(size_t _worker);
+
+    boost::scoped_array<Worker> workers_;
+    size_t worker_count_;
+    boost::thread_group threads_;
+
+    /// \brief Next deque for tasks submitted from outside the pool.
+    boost::atomic<size_t> next_;
+    /// \brief Number of tasks sitting in the deques.
+    boost::atomic<long> pending_;
+    /// \brief Number of workers sleeping on sleep_cond_.
+    boost::atomic<int> sleepers_;
+    boost::mutex sleep_lock_;
+    boost::condition_variable sleep_cond_;
+    boost::atomic<bool> stop_;
+};
+
+#endif
@@ -0,0 +1,75 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GAZEBO_ROS_RANGE_CONE_HH
+#define GAZEBO_ROS_RANGE_CONE_HH
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+
+#include <sdf/sdf.hh>
+
+#include <sensor_msgs/Range.h>
+
+#include <gazebo_plugins/gazebo_ros_noise.h>
+
+namespace gazebo
+{
+  /// \brief The cone of rays of a range sensor reduced to one
+  /// sensor_msgs::Range, shared by gazebo_ros_range (CPU rays) and
+  /// gazebo_ros_gpu_range (GPU rays).  Reads from sdf:
+  ///
+  ///   <radiation>ultrasound</radiation>  or infrared
+  ///   <fov>0.05</fov>
+  ///   <gaussianNoise>0.0</gaussianNoise>
+  ///   <noiseSeed>, see GaussianNoise::SeedFromSdf()
+  class RangeCone
+  {
+    /// \brief Constructor
+    public: RangeCone();
+
+    /// \brief Read the sdf parameters
+    /// \param[in] _scope Scoped name of the sensor, seeds the noise
+    /// \param[in] _logger Logger name of the plugin
+    public: void Load(sdf::ElementPtr _sdf, const std::string &_scope,
+                      const std::string &_logger);
+
+    /// \brief Fill everything but the header of _msg from the _n ranges of
+    /// the cone: the shortest one, clamped to _range_max, plus noise if it
+    /// hit something.
+    public: void Fill(const float *_ranges, size_t _n, float _range_min,
+                      float _range_max, sensor_msgs::Range &_msg);
+
+    /// \brief Shortest of the _n ranges, NaN ranges ignored, +inf if there
+    /// are none.  SSE2 / AVX2 on x86, NEON on ARM, picked at the first call.
+    public: static float MinRange(const float *_ranges, size_t _n);
+
+    /// \brief radiation type of the messages, ULTRASOUND or INFRARED
+    private: uint8_t radiation_type_;
+
+    /// \brief sensor field of view
+    private: double fov_;
+
+    /// \brief standard deviation of the range noise
+    private: double gaussian_noise_;
+
+    private: GaussianNoise noise_;
+  };
+}
+#endif
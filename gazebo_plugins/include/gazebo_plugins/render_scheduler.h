@@ -0,0 +1,132 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GAZEBO_ROS_RENDER_SCHEDULER_HH
+#define GAZEBO_ROS_RENDER_SCHEDULER_HH
+
+#include <stdint.h>
+#include <memory>
+#include <vector>
+
+#include <boost/thread/mutex.hpp>
+
+#include <gazebo/common/Time.hh>
+#include <gazebo/sensors/Sensor.hh>
+
+namespace gazebo
+{
+  /// \brief Process-wide scheduler that spreads the renders of the
+  /// rendering sensors evenly over the physics steps.
+  ///
+  /// Sensors that share an update rate otherwise all render on the same
+  /// step, which makes that step long and the real time factor dip. A
+  /// scheduled sensor is parked like GazeboRosTriggeredCamera parks its
+  /// camera, with an update rate of DBL_MIN. On the step of its phase it
+  /// is armed with twice its rate, so that it renders once before it is
+  /// parked again at the first step after its measurement. The phases are
+  /// chosen so that the estimated render cost of each step, the pixel or
+  /// ray count of the sensors armed on it, is as even as possible.
+  ///
+  /// A sensor that would render at every step, or faster, is left at its
+  /// own rate. GazeboRosRenderScheduler adds the sensors and calls Step()
+  /// at every world update.
+  class RenderScheduler
+  {
+    /// \brief The scheduler shared by all plugins of the process.
+    public: static RenderScheduler &Instance();
+
+    /// \brief Schedule a sensor at its current update rate.
+    /// \return False if the sensor is scheduled already, or does not
+    /// have a positive update rate.
+    public: bool Add(const sensors::SensorPtr &_sensor);
+
+    /// \brief Stop scheduling a sensor and give it back its update rate.
+    public: void Remove(const sensors::SensorPtr &_sensor);
+
+    /// \brief Stop scheduling all sensors.
+    public: void Clear();
+
+    /// \brief True if _sensor is scheduled.
+    public: bool Contains(const sensors::SensorPtr &_sensor);
+
+    /// \brief Number of scheduled sensors.
+    public: size_t Size();
+
+    /// \brief Change the update rate of a scheduled sensor. An unlimited
+    /// rate, 0, cannot be staggered and removes the sensor.
+    /// \return False if the sensor is not scheduled, the caller sets
+    /// the rate of the sensor itself then.
+    public: bool SetUpdateRate(const sensors::SensorPtr &_sensor,
+                               double _rate);
+
+    /// \brief Update rate of a scheduled sensor, whose own rate reads as
+    /// parked or armed.
+    /// \return False if the sensor is not scheduled.
+    public: bool UpdateRate(const sensors::SensorPtr &_sensor,
+                            double &_rate);
+
+    /// \brief Arm the sensors whose phase is this step.
+    /// \param[in] _iteration World iteration count.
+    /// \param[in] _step_size Physics step size [s].
+    public: void Step(uint64_t _iteration, double _step_size);
+
+    /// \brief Constructor, use Instance().
+    private: RenderScheduler();
+
+    /// \brief A scheduled sensor.
+    private: struct Entry
+    {
+      std::weak_ptr<sensors::Sensor> sensor;
+
+      /// \brief Update rate of the sensor [Hz].
+      double rate;
+
+      /// \brief Estimated render cost, pixels or rays.
+      double cost;
+
+      /// \brief Steps between two renders, and step of the first one.
+      uint64_t period;
+      uint64_t phase;
+
+      /// \brief True from arming until the next measurement.
+      bool armed;
+
+      /// \brief Last measurement time of the sensor when it was armed.
+      common::Time armed_measurement;
+    };
+
+    /// \brief Assign the period and phase of every entry, and park the
+    /// sensors that are staggered.
+    private: void Assign();
+
+    /// \brief Give the sensor of an entry back its update rate.
+    private: static void Release(const Entry &_entry);
+
+    /// \brief Scheduled sensors.
+    private: std::vector<Entry> entries_;
+
+    /// \brief True if the phases have to be assigned again.
+    private: bool dirty_;
+
+    /// \brief Step size of the last assignment [s].
+    private: double step_size_;
+
+    /// \brief Protects entries_, dirty_ and step_size_.
+    private: boost::mutex mutex_;
+  };
+}
+#endif
@@ -0,0 +1,78 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GAZEBO_ROS_RVL_ENCODER_HH
+#define GAZEBO_ROS_RVL_ENCODER_HH
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+namespace gazebo
+{
+  /// \brief RVL (run length / variable length) encoder of 16 bit depth
+  /// images, as decoded by the "rvl" format of
+  /// compressed_depth_image_transport.
+  ///
+  /// RVL codes runs of zero and non zero pixels, and the non zero pixels as
+  /// differences to the previous non zero one, in a stream of 4 bit nibbles.
+  /// The stream of an image can be encoded in pieces: an encoder started
+  /// with the last non zero pixel before its rows produces the nibbles of
+  /// those rows, and Join() concatenates the pieces of consecutive rows into
+  /// the stream of the whole image.  A run never continues past the end of
+  /// the pixels handed to one Encode() call, which costs a few nibbles per
+  /// call and decodes to the same pixels.
+  class RvlEncoder
+  {
+    /// \brief Constructor
+    /// \param[in] _previous Last non zero pixel before the first one encoded,
+    /// 0 at the start of the image
+    public: explicit RvlEncoder(uint16_t _previous = 0);
+
+    /// \brief Append _n pixels to the stream.
+    public: void Encode(const uint16_t *_depth, size_t _n);
+
+    /// \brief Number of nibbles encoded.
+    public: size_t Nibbles() const;
+
+    /// \brief Last non zero pixel encoded, or the one given to the
+    /// constructor.
+    public: uint16_t Previous() const;
+
+    /// \brief Write the streams of _encoders one after the other, as the
+    /// 32 bit words RVL decoders read.
+    /// \param[out] _out Receives the words, resized to fit
+    /// \param[in] _offset Bytes of _out before the stream, left as they are
+    public: static void Join(const std::vector<const RvlEncoder *> &_encoders,
+                             std::vector<uint8_t> &_out, size_t _offset);
+
+    /// \brief Append the variable length code of _value.
+    private: void EncodeVLE(uint32_t _value);
+
+    /// \brief Full words, first nibble in the high bits.
+    private: std::vector<uint32_t> words_;
+
+    /// \brief Partial word, nibbles_ % 8 nibbles in the low bits.
+    private: uint32_t word_;
+
+    private: size_t nibbles_;
+
+    private: uint16_t previous_;
+  };
+}
+#endif
@@ -0,0 +1,60 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GAZEBO_ROS_SENSOR_LOD_HH
+#define GAZEBO_ROS_SENSOR_LOD_HH
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <string>
+
+#include <boost/thread/mutex.hpp>
+
+namespace gazebo
+{
+  /// \brief Process-wide level of detail knobs of the sensor plugins,
+  /// keyed by scoped sensor name.
+  ///
+  /// GazeboRosSensorLod lowers the detail of sensors while the real time
+  /// factor is too low. The update rate is set on the sensor itself; the
+  /// point decimation is read by the plugins that publish points, which
+  /// multiply their own stride by it at every frame.
+  class SensorLod
+  {
+    /// \brief A decimation factor, 1 at full detail.
+    public: typedef std::shared_ptr<std::atomic<unsigned int> > Factor;
+
+    /// \brief The registry shared by all plugins of the process.
+    public: static SensorLod &Instance();
+
+    /// \brief Decimation factor of a sensor, created at 1 on first use by
+    /// either side.
+    /// \param[in] _sensor Scoped sensor name.
+    public: Factor Decimation(const std::string &_sensor);
+
+    /// \brief Constructor, use Instance().
+    private: SensorLod();
+
+    /// \brief Decimation of each sensor.
+    private: std::map<std::string, Factor> decimation_;
+
+    /// \brief Protects decimation_.
+    private: boost::mutex mutex_;
+  };
+}
+#endif
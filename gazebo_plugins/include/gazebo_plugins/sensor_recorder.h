@@ -0,0 +1,275 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GAZEBO_ROS_SENSOR_RECORDER_HH
+#define GAZEBO_ROS_SENSOR_RECORDER_HH
+
+#include <stdint.h>
+
+#include <atomic>
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+
+#include <ros/ros.h>
+#include <ros/message_traits.h>
+#include <ros/serialization.h>
+
+namespace gazebo
+{
+  /// \brief Process-wide recorder writing the messages published by the
+  /// plugins straight into bag files, without serializing them over TCP to a
+  /// rosbag record process.
+  ///
+  /// Messages are serialized directly into preallocated, memory mapped chunk
+  /// files. Each chunk file is a complete, indexed rosbag 2.0 bag holding a
+  /// single chunk, so the files can be played, inspected or merged with the
+  /// usual rosbag tools. Full chunks are compressed, indexed and closed by
+  /// background threads, which also preallocate the next files; the
+  /// recording thread never touches the disk.
+  ///
+  /// The publishing plugins hand their messages to Record() just before
+  /// queueing them for publishing; unless Recording() is true this is a
+  /// single atomic load. GazeboRosSensorRecorder starts and stops it.
+  class SensorRecorder
+  {
+    /// \brief Compression of the chunks.
+    public: enum Compression
+    {
+      COMPRESSION_NONE,
+      COMPRESSION_BZ2
+    };
+
+    /// \brief Recording settings.
+    public: struct Options
+    {
+      Options();
+
+      /// \brief Chunk files are named <prefix>_<sequence>.bag
+      std::string prefix;
+
+      /// \brief Bytes of uncompressed messages per chunk file.
+      size_t chunk_size;
+
+      /// \brief Chunk files kept mapped, ready to be filled. When all of
+      /// them wait for the background threads, messages are dropped.
+      size_t chunk_count;
+
+      Compression compression;
+
+      /// \brief Threads compressing and closing full chunks.
+      size_t threads;
+
+      /// \brief Topics to record, all if empty. A name ending in '*'
+      /// matches every topic starting with the rest of it.
+      std::vector<std::string> topics;
+    };
+
+    /// \brief The recorder shared by all plugins of the process.
+    public: static SensorRecorder &Instance();
+
+    /// \brief Map the first chunk files and start recording.
+    /// \return False if already recording or the files could not be created.
+    public: bool Start(const Options &_options);
+
+    /// \brief Stop recording and wait for the last chunks to be written.
+    public: void Stop();
+
+    /// \brief True while messages should be handed to Record().
+    public: bool Recording() const;
+
+    /// \brief True if _topic is recorded while Recording().
+    public: bool Wants(const std::string &_topic) const;
+
+    /// \brief Register a producer that only publishes while it has
+    /// subscribers. _connect is called while _topic is being recorded, as
+    /// if someone subscribed, and _disconnect when recording stops.
+    /// \return Handle for RemoveSource().
+    public: int AddSource(const std::string &_topic,
+                          const boost::function<void()> &_connect,
+                          const boost::function<void()> &_disconnect);
+
+    /// \brief Unregister a producer, calling its _disconnect if connected.
+    public: void RemoveSource(int _source);
+
+    /// \brief Record a message published on _topic, stamped with the
+    /// current ROS time.
+    public: template<class M>
+            void Record(const std::string &_topic, const M &_msg)
+    {
+      if (!this->Recording())
+        return;
+      uint32_t len = ros::serialization::serializationLength(_msg);
+      Reservation r = this->Reserve(_topic,
+          ros::message_traits::DataType<M>::value(),
+          ros::message_traits::MD5Sum<M>::value(),
+          ros::message_traits::Definition<M>::value(), len);
+      if (!r.data)
+        return;
+      ros::serialization::OStream stream(r.data, len);
+      ros::serialization::serialize(stream, _msg);
+      this->Commit(r);
+    }
+
+    /// \brief Record a message held by a shared pointer, e.g. from a
+    /// MessagePool.
+    public: template<class M>
+            void Record(const std::string &_topic,
+                        const boost::shared_ptr<M> &_msg)
+    {
+      if (_msg)
+        this->Record(_topic, *_msg);
+    }
+
+    /// \brief Record a message about to be published with _pub.
+    public: template<class M>
+            void Record(const ros::Publisher &_pub, const M &_msg)
+    {
+      if (this->Recording() && _pub)
+        this->Record(_pub.getTopic(), _msg);
+    }
+
+    /// \brief Number of messages recorded since Start().
+    public: unsigned long Recorded() const;
+
+    /// \brief Number of messages dropped since Start() because no chunk was
+    /// free or a message was larger than a chunk.
+    public: unsigned long Dropped() const;
+
+    /// \brief Number of chunk files written since Start().
+    public: unsigned long ChunksWritten() const;
+
+    /// \brief Constructor, use Instance().
+    private: SensorRecorder();
+
+    private: struct Chunk;
+
+    /// \brief Space reserved for a serialized message.
+    private: struct Reservation
+    {
+      uint8_t *data;
+      Chunk *chunk;
+    };
+
+    /// \brief Reserve room for a message of _len bytes in the current chunk,
+    /// moving on to the next free chunk if it does not fit.
+    /// \return Reservation with data NULL if the message is not recorded.
+    private: Reservation Reserve(const std::string &_topic,
+                                 const std::string &_type,
+                                 const std::string &_md5sum,
+                                 const std::string &_definition,
+                                 uint32_t _len);
+
+    /// \brief Mark a reserved message as serialized.
+    private: void Commit(const Reservation &_reservation);
+
+    /// \brief A topic seen while recording.
+    private: struct Connection
+    {
+      uint32_t id;
+      std::string topic;
+      bool wanted;
+      /// \brief Serialized connection record.
+      std::vector<uint8_t> record;
+    };
+
+    /// \brief Create and map the chunk file with sequence number _seq.
+    /// \return NULL on failure.
+    private: Chunk *OpenChunk(unsigned int _seq);
+
+    /// \brief Write a connection record into the data of _chunk.
+    private: void WriteConnection(Chunk *_chunk, const Connection &_conn);
+
+    /// \brief Hand the current chunk to the background threads.
+    /// Call with mutex_ held.
+    private: void SealCurrent();
+
+    /// \brief Compress, index and close a full chunk.
+    private: void Finish(Chunk *_chunk);
+
+    /// \brief Background thread loop.
+    private: void Work();
+
+    /// \brief Wants() with mutex_ held.
+    private: bool WantsLocked(const std::string &_topic) const;
+
+    /// \brief Unmap and close a chunk that was never filled, removing
+    /// its file.
+    private: static void DiscardChunk(Chunk *_chunk);
+
+    /// \brief Call the connect or disconnect callbacks of the sources.
+    private: void NotifySources(bool _recording);
+
+    private: Options options_;
+
+    /// \brief Connections by topic, kept across chunks.
+    private: std::map<std::string, Connection> connections_;
+
+    /// \brief Chunk being filled, NULL if none was free.
+    private: Chunk *current_;
+
+    /// \brief Mapped chunks ready to be filled.
+    private: std::deque<Chunk *> free_;
+
+    /// \brief Full chunks waiting for the background threads.
+    private: std::deque<Chunk *> sealed_;
+
+    /// \brief Chunks being finished by the background threads.
+    private: size_t finishing_;
+
+    /// \brief Sequence number of the next chunk file created.
+    private: unsigned int next_seq_;
+
+    /// \brief Protects everything above.
+    private: mutable boost::mutex mutex_;
+
+    /// \brief Wakes the background threads, and Stop() when they are done.
+    private: boost::condition_variable cond_;
+
+    private: boost::thread_group threads_;
+
+    /// \brief Set to stop the background threads.
+    private: bool stop_;
+
+    /// \brief A registered producer.
+    private: struct Source
+    {
+      std::string topic;
+      boost::function<void()> connect;
+      boost::function<void()> disconnect;
+      bool connected;
+    };
+
+    /// \brief Producers by handle.
+    private: std::map<int, Source> sources_;
+    private: int next_source_;
+
+    /// \brief Protects sources_, taken before mutex_ if both are needed.
+    private: boost::mutex sources_mutex_;
+
+    private: std::atomic<bool> recording_;
+    private: std::atomic<unsigned long> recorded_;
+    private: std::atomic<unsigned long> dropped_;
+    private: std::atomic<unsigned long> chunks_written_;
+  };
+}
+#endif
@@ -0,0 +1,175 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GAZEBO_ROS_SHARED_CALLBACK_EXECUTOR_HH
+#define GAZEBO_ROS_SHARED_CALLBACK_EXECUTOR_HH
+
+#include <deque>
+#include <set>
+
+#include <boost/atomic.hpp>
+#include <boost/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+#include <ros/ros.h>
+#include <ros/callback_queue.h>
+
+namespace gazebo
+{
+  class SharedCallbackQueue;
+
+  /// \brief Process-wide pool of worker threads servicing every
+  /// SharedCallbackQueue of the plugins loaded in gzserver.
+  ///
+  /// Workers sleep until a callback is added to one of the queues, so idle
+  /// plugins cost no wakeups.  The callbacks of one queue are never run
+  /// concurrently, plugins therefore keep the single threaded semantics they
+  /// had with a dedicated QueueThread.
+  ///
+  /// The pool starts with gazebo/shared_callback_threads workers (default 2)
+  /// and grows by one whenever a queue becomes ready while every worker is
+  /// busy, e.g. in a slow service callback, up to one worker per registered
+  /// queue, or gazebo/shared_callback_max_threads if set.  A plugin whose
+  /// callbacks are known to block therefore slows down the others at most
+  /// until the next worker is started; such plugins should rather construct
+  /// their queue dedicated, see SharedCallbackQueue().  Both parameters are
+  /// relative to the namespace of the process and read the first time the
+  /// executor is used.
+  class SharedCallbackExecutor
+  {
+    /// \brief Get the executor shared by all plugins of this process.
+    public: static SharedCallbackExecutor &Instance();
+
+    /// \brief Destructor, stops and joins the workers.
+    public: ~SharedCallbackExecutor();
+
+    /// \brief Number of worker threads.
+    public: size_t ThreadCount() const;
+
+    /// \brief Constructor
+    /// \param[in] _threads Number of worker threads to start, at least one
+    /// \param[in] _max_threads Upper bound of the pool, 0 for one worker per
+    /// registered queue
+    private: SharedCallbackExecutor(size_t _threads, size_t _max_threads);
+
+    /// \brief Count a queue serviced by the pool, which may then grow by
+    /// one worker.
+    private: void Register();
+
+    /// \brief Uncount a queue serviced by the pool.
+    private: void Unregister();
+
+    /// \brief Queue _queue for servicing unless it is already queued.
+    private: void Schedule(SharedCallbackQueue *_queue);
+
+    /// \brief Stop servicing _queue, waiting for a running worker to
+    /// return from it.
+    private: void Cancel(SharedCallbackQueue *_queue);
+
+    /// \brief Worker thread body.
+    private: void Worker();
+
+    /// \brief Start a worker if none is idle and the pool may still grow.
+    /// Call with mutex_ held.
+    private: void Grow();
+
+    /// \brief Protects ready_, running_, stop_, the counters and the
+    /// queues' flags.
+    private: boost::mutex mutex_;
+
+    /// \brief Signaled when ready_ gets a new queue or on shutdown.
+    private: boost::condition_variable ready_cond_;
+
+    /// \brief Signaled when a worker returns from a queue.
+    private: boost::condition_variable idle_cond_;
+
+    /// \brief Queues with pending callbacks, in arrival order.
+    private: std::deque<SharedCallbackQueue *> ready_;
+
+    /// \brief Queues currently being serviced by a worker.
+    private: std::set<SharedCallbackQueue *> running_;
+
+    /// \brief Set when the workers have to exit.
+    private: bool stop_;
+
+    /// \brief Workers waiting for a ready queue.
+    private: size_t idle_;
+
+    /// \brief Queues serviced by the pool.
+    private: size_t queue_count_;
+
+    /// \brief gazebo/shared_callback_max_threads, 0 if unset.
+    private: size_t max_threads_;
+
+    private: boost::thread_group workers_;
+
+    friend class SharedCallbackQueue;
+  };
+
+  /// \brief Drop-in replacement of ros::CallbackQueue that is serviced by
+  /// the SharedCallbackExecutor instead of a QueueThread spinning on
+  /// callAvailable().  Pass it to ros::SubscribeOptions,
+  /// ros::AdvertiseOptions, NodeHandle::setCallbackQueue(), etc. as usual.
+  class SharedCallbackQueue : public ros::CallbackQueue
+  {
+    /// \brief Constructor
+    /// \param[in] _dedicated Service the queue with a thread of its own
+    /// instead of the executor, for callbacks that block for long, e.g.
+    /// services flushing files or waiting for the simulation
+    public: explicit SharedCallbackQueue(bool _dedicated = false);
+
+    /// \brief Destructor, calls Stop().
+    public: virtual ~SharedCallbackQueue();
+
+    /// \brief Add a callback and wake up a worker to run it.
+    public: virtual void addCallback(
+                const ros::CallbackInterfacePtr &_callback,
+                uint64_t _owner_id = 0);
+
+    /// \brief Stop running callbacks of this queue and block until a
+    /// callback currently in progress returns.  This is what joining the
+    /// QueueThread used to do, call it before tearing down the state the
+    /// callbacks use.
+    public: void Stop();
+
+    /// \brief Body of thread_ of a dedicated queue.
+    private: void Spin();
+
+    /// \brief Executor servicing this queue.
+    private: SharedCallbackExecutor &executor_;
+
+    /// \brief Whether thread_ services the queue instead of executor_.
+    private: const bool dedicated_;
+
+    /// \brief Thread servicing a dedicated queue.
+    private: boost::thread thread_;
+
+    /// \brief True while the queue is in the executor's ready list or being
+    /// serviced, guarded by the executor's mutex.
+    private: bool scheduled_;
+
+    /// \brief True once Stop() was called, guarded by the executor's mutex.
+    private: bool stopped_;
+
+    /// \brief Set by Stop() to end thread_.
+    private: boost::atomic<bool> spinning_;
+
+    friend class SharedCallbackExecutor;
+  };
+}
+#endif
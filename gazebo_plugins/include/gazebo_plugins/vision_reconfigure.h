@@ -35,15 +35,28 @@
 #ifndef VISION_RECONFIGURE_HH
 #define VISION_RECONFIGURE_HH
 
+#include <string>
+#include <vector>
+
 #include <ros/ros.h>
+#include <std_msgs/Empty.h>
 #include <std_msgs/Header.h>
 #include <std_msgs/Int32.h>
 #include <dynamic_reconfigure/server.h>
-#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
 #include <gazebo_plugins/CameraSynchronizerConfig.h>
 
-#include <ros/callback_queue.h>
-
+/// Simulated camera synchronizer. A reconfigure request sets the projector
+/// and reschedules the camera triggers at once. While the projector is on or
+/// a camera is externally triggered, one timer steps through slots at twice
+/// the projector rate: the even slots are the projector pulses, the odd slots
+/// lie between them, and every camera that is due in a slot is triggered by
+/// the same timer event. The timer skips the slots in which nothing is
+/// published, and no timer runs if nothing is triggered.
+///
+/// The camera_synchronizer node runs outside of gzserver, so there is no
+/// world update to hook: like the projector controller it simulates, the
+/// timer is the source of the triggers.
 class VisionReconfigure
 {
   public:
@@ -52,18 +65,37 @@ class VisionReconfigure
     ~VisionReconfigure();
 
     void ReconfigureCallback(gazebo_plugins::CameraSynchronizerConfig &config, uint32_t level);
-    void QueueThread();
-    void spinOnce();
-    void spin(double spin_frequency);
+    void spin();
 
   private:
+    // cameras that share a trigger mode and rate, e.g. both sides of a stereo pair
+    struct TriggeredCamera
+    {
+      std::string name;
+      std::vector<ros::Publisher> trigger_pubs;
+      int trig_mode;
+      // trigger every divisor-th projector pulse
+      int divisor;
+    };
+
+    void AddCamera(const std::string &name, const std::vector<std::string> &default_topics);
+    void SetCamera(TriggeredCamera &camera, int trig_mode, double rate, double projector_rate);
+    void TriggerTimer(const ros::TimerEvent &event);
+
     ros::NodeHandle nh_;
     ros::Publisher pub_projector_;
     ros::Publisher pub_header_;
     dynamic_reconfigure::Server<gazebo_plugins::CameraSynchronizerConfig> srv_;
     std_msgs::Int32 projector_msg_;
-    ros::CallbackQueue queue_;
-    boost::thread callback_queue_thread_;
+
+    // trigger schedule, written by ReconfigureCallback and read by TriggerTimer
+    boost::mutex mutex_;
+    std::vector<TriggeredCamera> cameras_;
+    ros::Timer trigger_timer_;
+    bool projector_on_;
+    unsigned int slot_;
+    // slots advanced per timer event
+    unsigned int slot_step_;
 
 };
 
@@ -0,0 +1,158 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GAZEBO_ROS_WRENCH_FILTER_HH
+#define GAZEBO_ROS_WRENCH_FILTER_HH
+
+#include <string>
+#include <vector>
+
+#include <gazebo/common/Time.hh>
+#include <ignition/math/Vector3.hh>
+#include <ros/ros.h>
+#include <sdf/sdf.hh>
+#include <gazebo_msgs/WrenchArray.h>
+
+namespace gazebo
+{
+  /// \brief Filtered, decimated output of the wrench plugins (ft_sensor
+  /// and f3d).
+  ///
+  /// Without a filter, the plugins sample the wrench only when they
+  /// publish, and drop everything in between, which aliases short contact
+  /// spikes. With <filterType> set, the wrench is sampled at every physics
+  /// step into this filter, and the plugin publishes its output at
+  /// <updateRate>:
+  ///
+  /// - mean: mean of the samples since the last output.
+  /// - max: per axis, the sample of largest magnitude since the last
+  ///   output, with its sign.
+  /// - lowpass: first order low-pass of cutoff <filterCutoff> [Hz].
+  /// - fir: FIR filter of coefficients <filterCoefficients>, newest sample
+  ///   first, over a ring buffer of the latest samples.
+  ///
+  /// <rawTopicName> also publishes the raw samples since the last output
+  /// as one gazebo_msgs/WrenchArray, keeping at most <rawBufferSize> of
+  /// them (default 1000).
+  class WrenchFilter
+  {
+    /// \brief Constructor
+    public: WrenchFilter();
+
+    /// \brief Read the filter parameters.
+    /// \param[in] _sdf SDF of the plugin.
+    /// \param[in] _log_name Name of the plugin in log output.
+    public: void Load(sdf::ElementPtr _sdf, const std::string &_log_name);
+
+    /// \brief Advertise the raw sample topic, if there is one.
+    /// \param[in] _node Node handle of the plugin namespace.
+    /// \param[in] _frame_name Frame of the samples.
+    public: void Advertise(ros::NodeHandle &_node,
+                           const std::string &_frame_name);
+
+    /// \brief True if the wrench should be given to Add() at every step.
+    public: bool Enabled() const;
+
+    /// \brief True if the raw sample topic has subscribers.
+    public: bool RawActive() const;
+
+    /// \brief Add a sample.
+    public: void Add(const common::Time &_stamp,
+                     const ignition::math::Vector3d &_force,
+                     const ignition::math::Vector3d &_torque);
+
+    /// \brief Get the filtered wrench, start a new output window, and
+    /// publish the raw samples of the last one.
+    /// \return False if no sample was added since the last output.
+    public: bool Output(ignition::math::Vector3d &_force,
+                        ignition::math::Vector3d &_torque);
+
+    /// \brief Forget the samples and the filter state.
+    public: void Reset();
+
+    /// \brief Filter types.
+    private: enum FilterType
+    {
+      NONE,
+      MEAN,
+      MAX,
+      LOWPASS,
+      FIR
+    };
+
+    /// \brief Force and torque, as one vector of 6.
+    private: struct Sample
+    {
+      ignition::math::Vector3d force;
+      ignition::math::Vector3d torque;
+    };
+
+    /// \brief Filter type.
+    private: FilterType type_;
+
+    /// \brief Samples added since the last output.
+    private: unsigned int count_;
+
+    /// \brief MEAN: sum of the window, MAX: extremum of the window,
+    /// LOWPASS: filter state.
+    private: Sample state_;
+
+    /// \brief LOWPASS cutoff frequency [Hz].
+    private: double cutoff_;
+
+    /// \brief Stamp of the previous sample.
+    private: common::Time last_stamp_;
+
+    /// \brief True once the filter state holds a sample.
+    private: bool primed_;
+
+    /// \brief FIR coefficients, newest sample first.
+    private: std::vector<double> coefficients_;
+
+    /// \brief FIR ring buffer, history_[head_] is the newest sample.
+    private: std::vector<Sample> history_;
+
+    /// \brief Newest sample of history_.
+    private: size_t head_;
+
+    /// \brief Raw sample publisher.
+    private: ros::Publisher raw_pub_;
+
+    /// \brief Raw sample topic.
+    private: std::string raw_topic_name_;
+
+    /// \brief Raw sample message, its arrays keep their capacity.
+    private: gazebo_msgs::WrenchArray raw_msg_;
+
+    /// \brief Stamps of the raw samples since the last output, in a ring
+    /// of the size of the raw buffer.
+    private: std::vector<ros::Time> raw_stamps_;
+
+    /// \brief Raw samples, in the ring of raw_stamps_.
+    private: std::vector<Sample> raw_samples_;
+
+    /// \brief Next slot of the ring to write.
+    private: size_t raw_head_;
+
+    /// \brief Number of samples in the ring.
+    private: size_t raw_count_;
+
+    /// \brief Raw samples are recorded while true, updated at each output.
+    private: bool raw_active_;
+  };
+}
+#endif
@@ -6,7 +6,8 @@ Test plugin gazebo_ros_block_laser using gazebo_ros_block_laser_clipping.world.
 
 import math
 import rospy
-from sensor_msgs.msg import PointCloud
+from sensor_msgs.msg import PointCloud2
+from sensor_msgs import point_cloud2
 
 import unittest
 
@@ -15,9 +16,9 @@ class TestBlockLaserClippingPlugin(unittest.TestCase):
     MAX_RANGE = 1.0
 
     def _ranges(self):
-        msg = rospy.wait_for_message('test_block_laser', PointCloud)
-        for point in msg.points:
-            yield math.sqrt(point.x**2 + point.y**2 + point.z**2)
+        msg = rospy.wait_for_message('test_block_laser', PointCloud2)
+        for x, y, z in point_cloud2.read_points(msg, field_names=('x', 'y', 'z')):
+            yield math.sqrt(x**2 + y**2 + z**2)
 
     def test_points_at_all_depths(self):
         # Make sure there are points at all depths
@@ -0,0 +1,163 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+
+#include <boost/bind.hpp>
+
+#include <gazebo_ros/backlog_registry.h>
+
+#include <gazebo_plugins/async_image_publisher.h>
+
+namespace gazebo
+{
+////////////////////////////////////////////////////////////////////////////////
+AsyncImagePublisher::AsyncImagePublisher(
+  const image_transport::Publisher &_image_pub, size_t _depth)
+  : image_pub_(_image_pub),
+    latency_topic_(LatencyTracer::instance().topic(_image_pub.getTopic())),
+    depth_(std::max<size_t>(_depth, 1)), images_(0),
+    infos_(0), max_images_(0), draining_(0), pushed_(0), dropped_(0)
+{
+  this->task_.reset(new PubServiceTask(
+    boost::bind(&AsyncImagePublisher::Drain, this)));
+  this->backlog_id_ = BacklogRegistry::instance().add(
+    this->image_pub_.getTopic(),
+    boost::bind(&AsyncImagePublisher::Backlog, this));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+AsyncImagePublisher::~AsyncImagePublisher()
+{
+  BacklogRegistry::instance().remove(this->backlog_id_);
+  PubServicePool::instance().cancel(this->task_);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void AsyncImagePublisher::PushImage(const sensor_msgs::ImageConstPtr &_image)
+{
+  {
+    boost::mutex::scoped_lock lock(this->lock_);
+    if (this->images_ >= this->depth_)
+    {
+      this->EraseOldest(true);
+      --this->images_;
+      ++this->dropped_;
+    }
+    Item item;
+    item.image_ = _image;
+    this->items_.push_back(item);
+    ++this->images_;
+    ++this->pushed_;
+    this->max_images_ = std::max(this->max_images_, this->images_);
+  }
+  PubServicePool::instance().submit(this->task_.get());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void AsyncImagePublisher::PushCameraInfo(const ros::Publisher &_pub,
+  const sensor_msgs::CameraInfoConstPtr &_info)
+{
+  {
+    boost::mutex::scoped_lock lock(this->lock_);
+    if (this->infos_ >= this->depth_)
+      this->EraseOldest(false);
+    else
+      ++this->infos_;
+    Item item;
+    item.info_ = _info;
+    item.info_pub_ = _pub;
+    this->items_.push_back(item);
+  }
+  PubServicePool::instance().submit(this->task_.get());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void AsyncImagePublisher::EraseOldest(bool _image)
+{
+  for (std::deque<Item>::iterator it = this->items_.begin();
+       it != this->items_.end(); ++it)
+  {
+    if (static_cast<bool>(it->image_) == _image)
+    {
+      this->items_.erase(it);
+      return;
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void AsyncImagePublisher::Drain()
+{
+  std::deque<Item> items;
+  {
+    boost::mutex::scoped_lock lock(this->lock_);
+    items.swap(this->items_);
+    this->draining_ += this->images_;
+    this->images_ = 0;
+    this->infos_ = 0;
+  }
+  for (std::deque<Item>::iterator it = items.begin(); it != items.end(); ++it)
+  {
+    if (it->image_)
+    {
+      this->image_pub_.publish(it->image_);
+      GAZEBO_ROS_LATENCY_TRACE(this->latency_topic_, PUBLISHED,
+                               it->image_->header.stamp);
+      boost::mutex::scoped_lock lock(this->lock_);
+      --this->draining_;
+    }
+    else
+      it->info_pub_.publish(it->info_);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+unsigned long AsyncImagePublisher::Pushed()
+{
+  boost::mutex::scoped_lock lock(this->lock_);
+  return this->pushed_;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+unsigned long AsyncImagePublisher::Dropped()
+{
+  boost::mutex::scoped_lock lock(this->lock_);
+  return this->dropped_;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+size_t AsyncImagePublisher::Depth()
+{
+  boost::mutex::scoped_lock lock(this->lock_);
+  return this->images_;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+size_t AsyncImagePublisher::Backlog()
+{
+  boost::mutex::scoped_lock lock(this->lock_);
+  return this->images_ + this->draining_;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+size_t AsyncImagePublisher::MaxDepth()
+{
+  boost::mutex::scoped_lock lock(this->lock_);
+  return this->max_images_;
+}
+}
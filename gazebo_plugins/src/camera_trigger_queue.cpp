@@ -0,0 +1,189 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gazebo_plugins/camera_trigger_queue.h>
+
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+
+namespace gazebo
+{
+////////////////////////////////////////////////////////////////////////////////
+CameraTriggerQueue::CameraTriggerQueue(size_t _capacity)
+  : exact_(0), capacity_(_capacity), last_measurement_(-1, 0),
+    armed_(-1, 0), missed_(0)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void CameraTriggerQueue::SetCapacity(size_t _capacity)
+{
+  std::lock_guard<std::mutex> lock(this->mutex_);
+  this->capacity_ = _capacity;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool CameraTriggerQueue::Push(const common::Time &_time, bool _exact)
+{
+  std::lock_guard<std::mutex> lock(this->mutex_);
+  if (this->triggers_.size() >= this->capacity_)
+  {
+    ++this->missed_;
+    return false;
+  }
+  this->triggers_.insert(std::make_pair(_time, _exact));
+  if (_exact)
+    ++this->exact_;
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool CameraTriggerQueue::PushBurst(const std::vector<common::Time> &_times,
+                                   bool _exact, std::string &_error)
+{
+  std::lock_guard<std::mutex> lock(this->mutex_);
+  if (this->triggers_.size() + _times.size() > this->capacity_)
+  {
+    std::ostringstream ss;
+    ss << "burst of " << _times.size() << " triggers does not fit, "
+       << this->triggers_.size() << " of " << this->capacity_
+       << " queue slots are taken";
+    _error = ss.str();
+    return false;
+  }
+  for (size_t i = 0; i < _times.size(); ++i)
+    this->triggers_.insert(std::make_pair(_times[i], _exact));
+  if (_exact)
+    this->exact_ += static_cast<int>(_times.size());
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool CameraTriggerQueue::Due(const common::Time &_simTime)
+{
+  std::lock_guard<std::mutex> lock(this->mutex_);
+  return !this->triggers_.empty() && this->triggers_.begin()->first <= _simTime;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool CameraTriggerQueue::Arm(const common::Time &_simTime)
+{
+  std::lock_guard<std::mutex> lock(this->mutex_);
+  if (this->triggers_.empty() || this->triggers_.begin()->first > _simTime)
+    return false;
+  this->armed_ = std::max(this->armed_, _simTime);
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool CameraTriggerQueue::Rendered(const common::Time &_measurement,
+                                  common::Time &_requested)
+{
+  std::unique_lock<std::mutex> lock(this->mutex_);
+  if (_measurement == this->last_measurement_)
+    return false;
+  this->last_measurement_ = _measurement;
+
+  if (this->triggers_.empty() ||
+      _measurement < this->triggers_.begin()->first)
+  {
+    return false;
+  }
+
+  _requested = this->triggers_.begin()->first;
+  if (this->triggers_.begin()->second)
+    --this->exact_;
+  this->triggers_.erase(this->triggers_.begin());
+  lock.unlock();
+  this->cond_.notify_all();
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool CameraTriggerQueue::WaitExact(const common::Time &_simTime,
+                                   double _timeout)
+{
+  if (this->exact_ == 0)
+    return true;
+
+  std::unique_lock<std::mutex> lock(this->mutex_);
+  std::chrono::steady_clock::time_point deadline =
+    std::chrono::steady_clock::now() +
+    std::chrono::microseconds(static_cast<int64_t>(_timeout * 1e6));
+  while (true)
+  {
+    // the triggers are sorted, only the ones a render pass is rendering can
+    // hold the physics, and a trigger with the same stamp as the last frame
+    // renders at the next pass instead
+    const common::Time held = std::min(_simTime, this->armed_);
+    std::multimap<common::Time, bool>::iterator it = this->triggers_.begin();
+    bool holding = false;
+    for (; it != this->triggers_.end() && it->first <= held; ++it)
+    {
+      if (it->second && this->last_measurement_ < it->first)
+      {
+        holding = true;
+        break;
+      }
+    }
+    if (!holding)
+      return true;
+
+    if (this->cond_.wait_until(lock, deadline) == std::cv_status::timeout)
+    {
+      for (it = this->triggers_.begin();
+           it != this->triggers_.end() && it->first <= held; ++it)
+      {
+        if (it->second)
+        {
+          it->second = false;
+          --this->exact_;
+          ++this->missed_;
+        }
+      }
+      return false;
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+size_t CameraTriggerQueue::Depth()
+{
+  std::lock_guard<std::mutex> lock(this->mutex_);
+  return this->triggers_.size();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+uint64_t CameraTriggerQueue::Missed() const
+{
+  return this->missed_;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void CameraTriggerQueue::Clear()
+{
+  {
+    std::lock_guard<std::mutex> lock(this->mutex_);
+    this->triggers_.clear();
+    this->exact_ = 0;
+    this->last_measurement_ = common::Time(-1, 0);
+    this->armed_ = common::Time(-1, 0);
+  }
+  this->cond_.notify_all();
+}
+}
@@ -0,0 +1,229 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+
+#include <boost/bind.hpp>
+#include <boost/make_shared.hpp>
+
+#include <cv_bridge/cv_bridge.h>
+#include <opencv2/highgui.hpp>
+#include <sensor_msgs/image_encodings.h>
+
+#include <gazebo_ros/backlog_registry.h>
+
+#include <gazebo_plugins/compressed_image_publisher.h>
+
+namespace enc = sensor_msgs::image_encodings;
+
+namespace gazebo
+{
+////////////////////////////////////////////////////////////////////////////////
+CompressedImagePublisher::CompressedImagePublisher(const ros::Publisher &_pub,
+  Format _format, int _level, size_t _slots)
+  : pub_(_pub), format_(_format), level_(_level), next_seq_(0),
+    next_publish_(0), dropped_(0), failed_(0)
+{
+  this->slots_.resize(std::max<size_t>(_slots, 1));
+  for (size_t i = 0; i < this->slots_.size(); ++i)
+  {
+    Slot &slot = this->slots_[i];
+    slot.task_.reset(new PubServiceTask(
+      boost::bind(&CompressedImagePublisher::Encode, this, i)));
+    slot.seq_ = 0;
+    slot.busy_ = false;
+    slot.done_ = false;
+  }
+  this->backlog_id_ = BacklogRegistry::instance().add(this->pub_.getTopic(),
+    boost::bind(&CompressedImagePublisher::Backlog, this));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+CompressedImagePublisher::~CompressedImagePublisher()
+{
+  BacklogRegistry::instance().remove(this->backlog_id_);
+  for (size_t i = 0; i < this->slots_.size(); ++i)
+    PubServicePool::instance().cancel(this->slots_[i].task_);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void CompressedImagePublisher::Push(const sensor_msgs::ImageConstPtr &_image)
+{
+  PubServiceTask *task = NULL;
+  {
+    boost::mutex::scoped_lock lock(this->lock_);
+    for (size_t i = 0; i < this->slots_.size(); ++i)
+    {
+      Slot &slot = this->slots_[i];
+      if (slot.busy_)
+        continue;
+      slot.image_ = _image;
+      slot.seq_ = this->next_seq_++;
+      slot.busy_ = true;
+      slot.done_ = false;
+      task = slot.task_.get();
+      break;
+    }
+    if (!task)
+    {
+      ++this->dropped_;
+      return;
+    }
+  }
+  PubServicePool::instance().submit(task);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void CompressedImagePublisher::Encode(size_t _slot)
+{
+  sensor_msgs::ImageConstPtr image;
+  {
+    boost::mutex::scoped_lock lock(this->lock_);
+    image = this->slots_[_slot].image_;
+  }
+
+  sensor_msgs::CompressedImagePtr out =
+    boost::make_shared<sensor_msgs::CompressedImage>();
+  bool encoded = image && this->EncodeImage(image, *out);
+
+  {
+    boost::mutex::scoped_lock lock(this->lock_);
+    Slot &slot = this->slots_[_slot];
+    slot.image_.reset();
+    if (encoded)
+      slot.out_ = out;
+    else
+      ++this->failed_;
+    slot.done_ = true;
+  }
+  this->PublishEncoded();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool CompressedImagePublisher::EncodeImage(
+  const sensor_msgs::ImageConstPtr &_image, sensor_msgs::CompressedImage &_msg)
+{
+  // like compressed_image_transport: JPEG only takes 8 bit, PNG keeps
+  // 16 bit images
+  const std::string &encoding = _image->encoding;
+  bool color = enc::isColor(encoding) || enc::isBayer(encoding);
+  std::string target;
+  if (this->format_ == JPEG || enc::bitDepth(encoding) != 16)
+    target = color ? enc::BGR8 : enc::MONO8;
+  else
+    target = color ? enc::BGR16 : enc::MONO16;
+
+  std::vector<int> params;
+  if (this->format_ == JPEG)
+  {
+    params.push_back(cv::IMWRITE_JPEG_QUALITY);
+    params.push_back(this->level_);
+  }
+  else
+  {
+    params.push_back(cv::IMWRITE_PNG_COMPRESSION);
+    params.push_back(this->level_);
+  }
+
+  try
+  {
+    cv_bridge::CvImageConstPtr cv_image = cv_bridge::toCvShare(_image, target);
+    if (!cv::imencode(this->format_ == JPEG ? ".jpg" : ".png",
+                      cv_image->image, _msg.data, params))
+      return false;
+  }
+  catch (cv_bridge::Exception &e)
+  {
+    ROS_ERROR_THROTTLE_NAMED(1.0, "camera_utils", "Unable to compress %s "
+      "image on %s: %s", encoding.c_str(), this->pub_.getTopic().c_str(),
+      e.what());
+    return false;
+  }
+  catch (cv::Exception &e)
+  {
+    ROS_ERROR_THROTTLE_NAMED(1.0, "camera_utils", "Unable to compress %s "
+      "image on %s: %s", encoding.c_str(), this->pub_.getTopic().c_str(),
+      e.what());
+    return false;
+  }
+
+  _msg.header = _image->header;
+  _msg.format = encoding + (this->format_ == JPEG ? "; jpeg compressed " :
+    "; png compressed ") + target;
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void CompressedImagePublisher::PublishEncoded()
+{
+  boost::mutex::scoped_lock publish_lock(this->publish_lock_);
+  while (true)
+  {
+    sensor_msgs::CompressedImagePtr out;
+    {
+      boost::mutex::scoped_lock lock(this->lock_);
+      size_t i = 0;
+      for (; i < this->slots_.size(); ++i)
+      {
+        const Slot &slot = this->slots_[i];
+        if (slot.busy_ && slot.seq_ == this->next_publish_)
+          break;
+      }
+      if (i == this->slots_.size() || !this->slots_[i].done_)
+        return;
+      Slot &slot = this->slots_[i];
+      out.swap(slot.out_);
+      slot.busy_ = false;
+      ++this->next_publish_;
+    }
+    // a frame that failed to encode is skipped
+    if (out)
+      this->pub_.publish(sensor_msgs::CompressedImageConstPtr(out));
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+unsigned long CompressedImagePublisher::Pushed()
+{
+  boost::mutex::scoped_lock lock(this->lock_);
+  return this->next_seq_;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+unsigned long CompressedImagePublisher::Dropped()
+{
+  boost::mutex::scoped_lock lock(this->lock_);
+  return this->dropped_;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+unsigned long CompressedImagePublisher::Failed()
+{
+  boost::mutex::scoped_lock lock(this->lock_);
+  return this->failed_;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+size_t CompressedImagePublisher::Backlog()
+{
+  boost::mutex::scoped_lock lock(this->lock_);
+  size_t busy = 0;
+  for (size_t i = 0; i < this->slots_.size(); ++i)
+    busy += this->slots_[i].busy_ ? 1 : 0;
+  return busy;
+}
+}
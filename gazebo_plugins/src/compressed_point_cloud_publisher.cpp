@@ -0,0 +1,217 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+
+#include <boost/bind.hpp>
+#include <boost/make_shared.hpp>
+
+#include <gazebo_ros/backlog_registry.h>
+
+#include <gazebo_plugins/compressed_point_cloud_publisher.h>
+
+namespace gazebo
+{
+////////////////////////////////////////////////////////////////////////////////
+CompressedPointCloudPublisher::CompressedPointCloudPublisher(
+  const ros::Publisher &_pub, float _resolution, bool _entropy, size_t _slots)
+  : pub_(_pub), next_seq_(0), next_publish_(0), dropped_(0), failed_(0)
+{
+  this->slots_.resize(std::max<size_t>(_slots, 1));
+  for (size_t i = 0; i < this->slots_.size(); ++i)
+  {
+    Slot &slot = this->slots_[i];
+    slot.task_.reset(new PubServiceTask(
+      boost::bind(&CompressedPointCloudPublisher::Encode, this, i)));
+    slot.codec_.reset(new PointCloudCodec(_resolution, _entropy));
+    slot.copied_ = false;
+    slot.seq_ = 0;
+    slot.busy_ = false;
+    slot.done_ = false;
+  }
+  this->backlog_id_ = BacklogRegistry::instance().add(this->pub_.getTopic(),
+    boost::bind(&CompressedPointCloudPublisher::Backlog, this));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+CompressedPointCloudPublisher::~CompressedPointCloudPublisher()
+{
+  BacklogRegistry::instance().remove(this->backlog_id_);
+  for (size_t i = 0; i < this->slots_.size(); ++i)
+    PubServicePool::instance().cancel(this->slots_[i].task_);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int CompressedPointCloudPublisher::Reserve()
+{
+  boost::mutex::scoped_lock lock(this->lock_);
+  for (size_t i = 0; i < this->slots_.size(); ++i)
+  {
+    Slot &slot = this->slots_[i];
+    if (slot.busy_)
+      continue;
+    slot.seq_ = this->next_seq_++;
+    slot.busy_ = true;
+    slot.done_ = false;
+    return static_cast<int>(i);
+  }
+  ++this->dropped_;
+  return -1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void CompressedPointCloudPublisher::Submit(int _slot)
+{
+  PubServicePool::instance().submit(this->slots_[_slot].task_.get());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void CompressedPointCloudPublisher::Push(
+  const sensor_msgs::PointCloud2ConstPtr &_cloud)
+{
+  const int slot = this->Reserve();
+  if (slot < 0)
+    return;
+  {
+    boost::mutex::scoped_lock lock(this->lock_);
+    this->slots_[slot].cloud_ = _cloud;
+    this->slots_[slot].copied_ = false;
+  }
+  this->Submit(slot);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void CompressedPointCloudPublisher::Push(const sensor_msgs::PointCloud2 &_cloud)
+{
+  const int slot = this->Reserve();
+  if (slot < 0)
+    return;
+  // a busy slot is only touched by us until it is submitted, copy unlocked
+  Slot &s = this->slots_[slot];
+  s.copy_.header = _cloud.header;
+  s.copy_.height = _cloud.height;
+  s.copy_.width = _cloud.width;
+  s.copy_.fields = _cloud.fields;
+  s.copy_.is_bigendian = _cloud.is_bigendian;
+  s.copy_.point_step = _cloud.point_step;
+  s.copy_.row_step = _cloud.row_step;
+  s.copy_.data.assign(_cloud.data.begin(), _cloud.data.end());
+  s.copy_.is_dense = _cloud.is_dense;
+  {
+    boost::mutex::scoped_lock lock(this->lock_);
+    s.cloud_.reset();
+    s.copied_ = true;
+  }
+  this->Submit(slot);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void CompressedPointCloudPublisher::Encode(size_t _slot)
+{
+  Slot &slot = this->slots_[_slot];
+  sensor_msgs::PointCloud2ConstPtr cloud;
+  bool copied;
+  {
+    boost::mutex::scoped_lock lock(this->lock_);
+    cloud = slot.cloud_;
+    copied = slot.copied_;
+  }
+
+  gazebo_msgs::CompressedPointCloudPtr out =
+    boost::make_shared<gazebo_msgs::CompressedPointCloud>();
+  bool encoded = false;
+  if (copied)
+    encoded = slot.codec_->Encode(slot.copy_, *out);
+  else if (cloud)
+    encoded = slot.codec_->Encode(*cloud, *out);
+
+  {
+    boost::mutex::scoped_lock lock(this->lock_);
+    slot.cloud_.reset();
+    if (encoded)
+      slot.out_ = out;
+    else
+      ++this->failed_;
+    slot.done_ = true;
+  }
+  if (!encoded)
+    ROS_WARN_THROTTLE_NAMED(1.0, "point_cloud_codec", "Unable to compress "
+      "a point cloud without float32 x, y and z on %s",
+      this->pub_.getTopic().c_str());
+  this->PublishEncoded();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void CompressedPointCloudPublisher::PublishEncoded()
+{
+  boost::mutex::scoped_lock publish_lock(this->publish_lock_);
+  while (true)
+  {
+    gazebo_msgs::CompressedPointCloudPtr out;
+    {
+      boost::mutex::scoped_lock lock(this->lock_);
+      size_t i = 0;
+      for (; i < this->slots_.size(); ++i)
+      {
+        const Slot &slot = this->slots_[i];
+        if (slot.busy_ && slot.seq_ == this->next_publish_)
+          break;
+      }
+      if (i == this->slots_.size() || !this->slots_[i].done_)
+        return;
+      Slot &slot = this->slots_[i];
+      out.swap(slot.out_);
+      slot.busy_ = false;
+      ++this->next_publish_;
+    }
+    // a cloud that failed to encode is skipped
+    if (out)
+      this->pub_.publish(gazebo_msgs::CompressedPointCloudConstPtr(out));
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+unsigned long CompressedPointCloudPublisher::Pushed()
+{
+  boost::mutex::scoped_lock lock(this->lock_);
+  return this->next_seq_;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+unsigned long CompressedPointCloudPublisher::Dropped()
+{
+  boost::mutex::scoped_lock lock(this->lock_);
+  return this->dropped_;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+unsigned long CompressedPointCloudPublisher::Failed()
+{
+  boost::mutex::scoped_lock lock(this->lock_);
+  return this->failed_;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+size_t CompressedPointCloudPublisher::Backlog()
+{
+  boost::mutex::scoped_lock lock(this->lock_);
+  size_t busy = 0;
+  for (size_t i = 0; i < this->slots_.size(); ++i)
+    busy += this->slots_[i].busy_ ? 1 : 0;
+  return busy;
+}
+}
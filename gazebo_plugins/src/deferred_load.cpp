@@ -0,0 +1,133 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <cstdlib>
+#include <exception>
+
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <ros/console.h>
+
+#include <gazebo_ros/startup_trace.h>
+#include <gazebo_ros/thread_policy.h>
+#include <gazebo_plugins/deferred_load.h>
+
+namespace gazebo
+{
+////////////////////////////////////////////////////////////////////////////////
+DeferredLoad::Task::Task()
+  : done_(false)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void DeferredLoad::Task::Wait()
+{
+  boost::mutex::scoped_lock lock(this->mutex_);
+  while (!this->done_)
+    this->cond_.wait(lock);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void DeferredLoad::Task::Done()
+{
+  boost::mutex::scoped_lock lock(this->mutex_);
+  this->done_ = true;
+  this->cond_.notify_all();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+DeferredLoad &DeferredLoad::Instance()
+{
+  static DeferredLoad instance;
+  return instance;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+DeferredLoad::DeferredLoad()
+  : workers_(0), max_workers_(8)
+{
+  const char *threads = getenv("GAZEBO_ROS_LOAD_THREADS");
+  if (threads && atoi(threads) > 0)
+    this->max_workers_ = atoi(threads);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool DeferredLoad::Requested(sdf::ElementPtr _sdf, bool _default)
+{
+  if (!_sdf || !_sdf->HasElement("deferredLoad"))
+    return _default;
+  return _sdf->Get<bool>("deferredLoad");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+DeferredLoad::TaskPtr DeferredLoad::Run(const std::string &_plugin,
+  const boost::function<void()> &_load)
+{
+  Entry entry;
+  entry.plugin = _plugin;
+  entry.load = _load;
+  entry.task.reset(new Task());
+  StartupTrace::instance().addPending();
+
+  boost::mutex::scoped_lock lock(this->mutex_);
+  this->queue_.push_back(entry);
+  // workers never idle, they exit once the queue is empty
+  if (this->workers_ < this->max_workers_)
+  {
+    ++this->workers_;
+    boost::thread(boost::bind(&DeferredLoad::Worker, this)).detach();
+  }
+  return entry.task;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void DeferredLoad::Worker()
+{
+  ThreadPolicy::instance().apply("io", "gzros_loader");
+  while (true)
+  {
+    Entry entry;
+    {
+      boost::mutex::scoped_lock lock(this->mutex_);
+      if (this->queue_.empty())
+      {
+        --this->workers_;
+        return;
+      }
+      entry = this->queue_.front();
+      this->queue_.pop_front();
+    }
+
+    {
+      ScopedStartupPhase phase(entry.plugin, "deferred load");
+      try
+      {
+        entry.load();
+      }
+      catch (const std::exception &e)
+      {
+        ROS_ERROR_NAMED("deferred_load", "Deferred load of [%s] failed: %s",
+                        entry.plugin.c_str(), e.what());
+      }
+    }
+    StartupTrace::instance().removePending();
+    entry.task->Done();
+  }
+}
+}
@@ -0,0 +1,683 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <limits>
+
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+#include <boost/thread/once.hpp>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define DEPTH_KERNELS_X86 1
+#include <immintrin.h>
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define DEPTH_KERNELS_NEON 1
+#include <arm_neon.h>
+#endif
+
+#include <gazebo_plugins/depth_image_kernels.h>
+#include <gazebo_ros/thread_policy.h>
+
+namespace gazebo
+{
+namespace depth_kernels
+{
+namespace
+{
+////////////////////////////////////////////////////////////////////////////////
+// scalar reference implementations, also used for the tails of the vector
+// ones
+void ClipDepthScalar(const float *_src, float *_dst, size_t _n,
+                     float _min, float _max)
+{
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  for (size_t i = 0; i < _n; ++i)
+  {
+    float d = _src[i];
+    _dst[i] = (d > _min && d < _max) ? d : nan;
+  }
+}
+
+void DepthToMillimetersScalar(const float *_src, uint16_t *_dst, size_t _n,
+                              float _min, float _max)
+{
+  for (size_t i = 0; i < _n; ++i)
+  {
+    float d = _src[i];
+    if (d > _min && d < _max)
+      _dst[i] = static_cast<uint16_t>(std::min(d * 1000.0f, 65535.0f));
+    else
+      _dst[i] = 0;
+  }
+}
+
+void DepthToDisparityScalar(const float *_src, float *_dst, size_t _n,
+                            float _baseline_focal, float _min, float _max)
+{
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  for (size_t i = 0; i < _n; ++i)
+  {
+    float d = _src[i];
+    _dst[i] = (d > _min && d < _max) ? _baseline_focal / d : nan;
+  }
+}
+
+/// \brief Write the 4 color bytes of point _i, the last one is zeroed.
+inline void StoreColor(uint8_t *_rgb, const uint8_t *_color, int _channels,
+                       size_t _i)
+{
+  uint32_t rgb = 0;
+  if (_color && _channels == 3)
+  {
+    rgb = _color[3 * _i] | (_color[3 * _i + 1] << 8) |
+          (_color[3 * _i + 2] << 16);
+  }
+  else if (_color)
+  {
+    rgb = _color[_i] * 0x010101u;
+  }
+  // little endian, so the bytes land in color order
+  memcpy(_rgb, &rgb, sizeof(rgb));
+}
+
+/// \brief True if the vector packers may store x, y, z and a zero pad as
+/// one 16 byte write per point.
+inline bool PaddedLayout(size_t _point_step, size_t _rgb_offset)
+{
+  return _rgb_offset >= 16 && _point_step >= _rgb_offset + 4;
+}
+
+size_t PackXYZRGBScalar(const float *_x, const float *_y, const float *_z,
+                        const uint8_t *_color, int _channels, size_t _n,
+                        uint8_t *_out, size_t _point_step, size_t _rgb_offset)
+{
+  const bool padded = PaddedLayout(_point_step, _rgb_offset);
+  size_t invalid = 0;
+  for (size_t i = 0; i < _n; ++i, _out += _point_step)
+  {
+    float *xyz = reinterpret_cast<float *>(_out);
+    xyz[0] = _x[i];
+    xyz[1] = _y[i];
+    xyz[2] = _z[i];
+    if (padded)
+      xyz[3] = 0.0f;
+    invalid += (_z[i] != _z[i]);
+    StoreColor(_out + _rgb_offset, _color, _channels, i);
+  }
+  return invalid;
+}
+
+#ifdef DEPTH_KERNELS_X86
+////////////////////////////////////////////////////////////////////////////////
+// SSE2 is part of x86-64, no target attribute needed
+void ClipDepthSSE2(const float *_src, float *_dst, size_t _n,
+                   float _min, float _max)
+{
+  const __m128 vmin = _mm_set1_ps(_min);
+  const __m128 vmax = _mm_set1_ps(_max);
+  const __m128 vnan = _mm_set1_ps(std::numeric_limits<float>::quiet_NaN());
+  size_t i = 0;
+  for (; i + 4 <= _n; i += 4)
+  {
+    __m128 d = _mm_loadu_ps(_src + i);
+    __m128 valid = _mm_and_ps(_mm_cmpgt_ps(d, vmin), _mm_cmplt_ps(d, vmax));
+    _mm_storeu_ps(_dst + i,
+      _mm_or_ps(_mm_and_ps(valid, d), _mm_andnot_ps(valid, vnan)));
+  }
+  ClipDepthScalar(_src + i, _dst + i, _n - i, _min, _max);
+}
+
+void DepthToMillimetersSSE2(const float *_src, uint16_t *_dst, size_t _n,
+                            float _min, float _max)
+{
+  const __m128 vmin = _mm_set1_ps(_min);
+  const __m128 vmax = _mm_set1_ps(_max);
+  const __m128 vscale = _mm_set1_ps(1000.0f);
+  const __m128 vsat = _mm_set1_ps(65535.0f);
+  const __m128i vbias = _mm_set1_epi32(32768);
+  const __m128i vunbias = _mm_set1_epi16(static_cast<int16_t>(0x8000));
+  size_t i = 0;
+  for (; i + 8 <= _n; i += 8)
+  {
+    __m128 d0 = _mm_loadu_ps(_src + i);
+    __m128 d1 = _mm_loadu_ps(_src + i + 4);
+    __m128 valid0 = _mm_and_ps(_mm_cmpgt_ps(d0, vmin), _mm_cmplt_ps(d0, vmax));
+    __m128 valid1 = _mm_and_ps(_mm_cmpgt_ps(d1, vmin), _mm_cmplt_ps(d1, vmax));
+    // valid depths are positive, invalid lanes become 0 before converting
+    __m128 mm0 = _mm_and_ps(valid0, _mm_min_ps(_mm_mul_ps(d0, vscale), vsat));
+    __m128 mm1 = _mm_and_ps(valid1, _mm_min_ps(_mm_mul_ps(d1, vscale), vsat));
+    // SSE2 has no unsigned 32 -> 16 bit pack, go through the signed one
+    __m128i i0 = _mm_sub_epi32(_mm_cvttps_epi32(mm0), vbias);
+    __m128i i1 = _mm_sub_epi32(_mm_cvttps_epi32(mm1), vbias);
+    __m128i packed = _mm_xor_si128(_mm_packs_epi32(i0, i1), vunbias);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(_dst + i), packed);
+  }
+  DepthToMillimetersScalar(_src + i, _dst + i, _n - i, _min, _max);
+}
+
+void DepthToDisparitySSE2(const float *_src, float *_dst, size_t _n,
+                          float _baseline_focal, float _min, float _max)
+{
+  const __m128 vmin = _mm_set1_ps(_min);
+  const __m128 vmax = _mm_set1_ps(_max);
+  const __m128 vbf = _mm_set1_ps(_baseline_focal);
+  const __m128 vnan = _mm_set1_ps(std::numeric_limits<float>::quiet_NaN());
+  size_t i = 0;
+  for (; i + 4 <= _n; i += 4)
+  {
+    __m128 d = _mm_loadu_ps(_src + i);
+    __m128 valid = _mm_and_ps(_mm_cmpgt_ps(d, vmin), _mm_cmplt_ps(d, vmax));
+    __m128 disp = _mm_div_ps(vbf, d);
+    _mm_storeu_ps(_dst + i,
+      _mm_or_ps(_mm_and_ps(valid, disp), _mm_andnot_ps(valid, vnan)));
+  }
+  DepthToDisparityScalar(_src + i, _dst + i, _n - i, _baseline_focal,
+                         _min, _max);
+}
+
+size_t PackXYZRGBSSE2(const float *_x, const float *_y, const float *_z,
+                      const uint8_t *_color, int _channels, size_t _n,
+                      uint8_t *_out, size_t _point_step, size_t _rgb_offset)
+{
+  if (!PaddedLayout(_point_step, _rgb_offset))
+  {
+    return PackXYZRGBScalar(_x, _y, _z, _color, _channels, _n, _out,
+                            _point_step, _rgb_offset);
+  }
+  const __m128 zero = _mm_setzero_ps();
+  size_t invalid = 0;
+  size_t i = 0;
+  for (; i + 4 <= _n; i += 4)
+  {
+    __m128 x = _mm_loadu_ps(_x + i);
+    __m128 y = _mm_loadu_ps(_y + i);
+    __m128 z = _mm_loadu_ps(_z + i);
+    invalid += __builtin_popcount(_mm_movemask_ps(_mm_cmpunord_ps(z, z)));
+
+    // transpose to x y z 0 per point
+    __m128 xz_lo = _mm_unpacklo_ps(x, z);
+    __m128 xz_hi = _mm_unpackhi_ps(x, z);
+    __m128 y0_lo = _mm_unpacklo_ps(y, zero);
+    __m128 y0_hi = _mm_unpackhi_ps(y, zero);
+    uint8_t *out = _out + i * _point_step;
+    _mm_storeu_ps(reinterpret_cast<float *>(out),
+                  _mm_unpacklo_ps(xz_lo, y0_lo));
+    _mm_storeu_ps(reinterpret_cast<float *>(out + _point_step),
+                  _mm_unpackhi_ps(xz_lo, y0_lo));
+    _mm_storeu_ps(reinterpret_cast<float *>(out + 2 * _point_step),
+                  _mm_unpacklo_ps(xz_hi, y0_hi));
+    _mm_storeu_ps(reinterpret_cast<float *>(out + 3 * _point_step),
+                  _mm_unpackhi_ps(xz_hi, y0_hi));
+    for (size_t k = 0; k < 4; ++k)
+      StoreColor(out + k * _point_step + _rgb_offset, _color, _channels, i + k);
+  }
+  return invalid + PackXYZRGBScalar(_x + i, _y + i, _z + i,
+      _color ? _color + i * _channels : NULL, _channels, _n - i,
+      _out + i * _point_step, _point_step, _rgb_offset);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// AVX2, compiled for that target only and picked at runtime
+__attribute__((target("avx2")))
+void ClipDepthAVX2(const float *_src, float *_dst, size_t _n,
+                   float _min, float _max)
+{
+  const __m256 vmin = _mm256_set1_ps(_min);
+  const __m256 vmax = _mm256_set1_ps(_max);
+  const __m256 vnan = _mm256_set1_ps(std::numeric_limits<float>::quiet_NaN());
+  size_t i = 0;
+  for (; i + 8 <= _n; i += 8)
+  {
+    __m256 d = _mm256_loadu_ps(_src + i);
+    __m256 valid = _mm256_and_ps(_mm256_cmp_ps(d, vmin, _CMP_GT_OQ),
+                                 _mm256_cmp_ps(d, vmax, _CMP_LT_OQ));
+    _mm256_storeu_ps(_dst + i, _mm256_blendv_ps(vnan, d, valid));
+  }
+  ClipDepthScalar(_src + i, _dst + i, _n - i, _min, _max);
+}
+
+__attribute__((target("avx2")))
+void DepthToMillimetersAVX2(const float *_src, uint16_t *_dst, size_t _n,
+                            float _min, float _max)
+{
+  const __m256 vmin = _mm256_set1_ps(_min);
+  const __m256 vmax = _mm256_set1_ps(_max);
+  const __m256 vscale = _mm256_set1_ps(1000.0f);
+  const __m256 vsat = _mm256_set1_ps(65535.0f);
+  size_t i = 0;
+  for (; i + 16 <= _n; i += 16)
+  {
+    __m256 d0 = _mm256_loadu_ps(_src + i);
+    __m256 d1 = _mm256_loadu_ps(_src + i + 8);
+    __m256 valid0 = _mm256_and_ps(_mm256_cmp_ps(d0, vmin, _CMP_GT_OQ),
+                                  _mm256_cmp_ps(d0, vmax, _CMP_LT_OQ));
+    __m256 valid1 = _mm256_and_ps(_mm256_cmp_ps(d1, vmin, _CMP_GT_OQ),
+                                  _mm256_cmp_ps(d1, vmax, _CMP_LT_OQ));
+    __m256 mm0 = _mm256_and_ps(valid0,
+      _mm256_min_ps(_mm256_mul_ps(d0, vscale), vsat));
+    __m256 mm1 = _mm256_and_ps(valid1,
+      _mm256_min_ps(_mm256_mul_ps(d1, vscale), vsat));
+    // packus works per 128 bit lane, restore the order afterwards
+    __m256i packed = _mm256_packus_epi32(_mm256_cvttps_epi32(mm0),
+                                         _mm256_cvttps_epi32(mm1));
+    packed = _mm256_permute4x64_epi64(packed, 0xD8);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(_dst + i), packed);
+  }
+  DepthToMillimetersScalar(_src + i, _dst + i, _n - i, _min, _max);
+}
+
+__attribute__((target("avx2")))
+void DepthToDisparityAVX2(const float *_src, float *_dst, size_t _n,
+                          float _baseline_focal, float _min, float _max)
+{
+  const __m256 vmin = _mm256_set1_ps(_min);
+  const __m256 vmax = _mm256_set1_ps(_max);
+  const __m256 vbf = _mm256_set1_ps(_baseline_focal);
+  const __m256 vnan = _mm256_set1_ps(std::numeric_limits<float>::quiet_NaN());
+  size_t i = 0;
+  for (; i + 8 <= _n; i += 8)
+  {
+    __m256 d = _mm256_loadu_ps(_src + i);
+    __m256 valid = _mm256_and_ps(_mm256_cmp_ps(d, vmin, _CMP_GT_OQ),
+                                 _mm256_cmp_ps(d, vmax, _CMP_LT_OQ));
+    _mm256_storeu_ps(_dst + i,
+      _mm256_blendv_ps(vnan, _mm256_div_ps(vbf, d), valid));
+  }
+  DepthToDisparityScalar(_src + i, _dst + i, _n - i, _baseline_focal,
+                         _min, _max);
+}
+
+__attribute__((target("avx2")))
+size_t PackXYZRGBAVX2(const float *_x, const float *_y, const float *_z,
+                      const uint8_t *_color, int _channels, size_t _n,
+                      uint8_t *_out, size_t _point_step, size_t _rgb_offset)
+{
+  if (!PaddedLayout(_point_step, _rgb_offset))
+  {
+    return PackXYZRGBScalar(_x, _y, _z, _color, _channels, _n, _out,
+                            _point_step, _rgb_offset);
+  }
+  const __m256 zero = _mm256_setzero_ps();
+  size_t invalid = 0;
+  size_t i = 0;
+  for (; i + 8 <= _n; i += 8)
+  {
+    __m256 x = _mm256_loadu_ps(_x + i);
+    __m256 y = _mm256_loadu_ps(_y + i);
+    __m256 z = _mm256_loadu_ps(_z + i);
+    invalid += __builtin_popcount(
+        _mm256_movemask_ps(_mm256_cmp_ps(z, z, _CMP_UNORD_Q)));
+
+    // unpack works per 128 bit lane, so the low lane holds points 0-3 and
+    // the high one points 4-7
+    __m256 xz_lo = _mm256_unpacklo_ps(x, z);
+    __m256 xz_hi = _mm256_unpackhi_ps(x, z);
+    __m256 y0_lo = _mm256_unpacklo_ps(y, zero);
+    __m256 y0_hi = _mm256_unpackhi_ps(y, zero);
+    __m256 p[4] = {_mm256_unpacklo_ps(xz_lo, y0_lo),
+                   _mm256_unpackhi_ps(xz_lo, y0_lo),
+                   _mm256_unpacklo_ps(xz_hi, y0_hi),
+                   _mm256_unpackhi_ps(xz_hi, y0_hi)};
+    uint8_t *out = _out + i * _point_step;
+    for (size_t k = 0; k < 4; ++k)
+    {
+      _mm_storeu_ps(reinterpret_cast<float *>(out + k * _point_step),
+                    _mm256_castps256_ps128(p[k]));
+      _mm_storeu_ps(reinterpret_cast<float *>(out + (k + 4) * _point_step),
+                    _mm256_extractf128_ps(p[k], 1));
+    }
+    for (size_t k = 0; k < 8; ++k)
+      StoreColor(out + k * _point_step + _rgb_offset, _color, _channels, i + k);
+  }
+  return invalid + PackXYZRGBScalar(_x + i, _y + i, _z + i,
+      _color ? _color + i * _channels : NULL, _channels, _n - i,
+      _out + i * _point_step, _point_step, _rgb_offset);
+}
+#endif
+
+#ifdef DEPTH_KERNELS_NEON
+////////////////////////////////////////////////////////////////////////////////
+void ClipDepthNEON(const float *_src, float *_dst, size_t _n,
+                   float _min, float _max)
+{
+  const float32x4_t vmin = vdupq_n_f32(_min);
+  const float32x4_t vmax = vdupq_n_f32(_max);
+  const float32x4_t vnan = vdupq_n_f32(std::numeric_limits<float>::quiet_NaN());
+  size_t i = 0;
+  for (; i + 4 <= _n; i += 4)
+  {
+    float32x4_t d = vld1q_f32(_src + i);
+    uint32x4_t valid = vandq_u32(vcgtq_f32(d, vmin), vcltq_f32(d, vmax));
+    vst1q_f32(_dst + i, vbslq_f32(valid, d, vnan));
+  }
+  ClipDepthScalar(_src + i, _dst + i, _n - i, _min, _max);
+}
+
+void DepthToMillimetersNEON(const float *_src, uint16_t *_dst, size_t _n,
+                            float _min, float _max)
+{
+  const float32x4_t vmin = vdupq_n_f32(_min);
+  const float32x4_t vmax = vdupq_n_f32(_max);
+  const float32x4_t vscale = vdupq_n_f32(1000.0f);
+  size_t i = 0;
+  for (; i + 8 <= _n; i += 8)
+  {
+    float32x4_t d0 = vld1q_f32(_src + i);
+    float32x4_t d1 = vld1q_f32(_src + i + 4);
+    uint32x4_t valid0 = vandq_u32(vcgtq_f32(d0, vmin), vcltq_f32(d0, vmax));
+    uint32x4_t valid1 = vandq_u32(vcgtq_f32(d1, vmin), vcltq_f32(d1, vmax));
+    // vcvtq_u32_f32 truncates and saturates, vqmovn saturates to 16 bits
+    uint32x4_t mm0 = vandq_u32(valid0, vcvtq_u32_f32(vmulq_f32(d0, vscale)));
+    uint32x4_t mm1 = vandq_u32(valid1, vcvtq_u32_f32(vmulq_f32(d1, vscale)));
+    vst1q_u16(_dst + i, vcombine_u16(vqmovn_u32(mm0), vqmovn_u32(mm1)));
+  }
+  DepthToMillimetersScalar(_src + i, _dst + i, _n - i, _min, _max);
+}
+
+void DepthToDisparityNEON(const float *_src, float *_dst, size_t _n,
+                          float _baseline_focal, float _min, float _max)
+{
+  // NEON has no vector divide on 32 bit ARM, the tail loop does the work
+  // there and the compiler is free to vectorize it on aarch64
+  DepthToDisparityScalar(_src, _dst, _n, _baseline_focal, _min, _max);
+}
+
+size_t PackXYZRGBNEON(const float *_x, const float *_y, const float *_z,
+                      const uint8_t *_color, int _channels, size_t _n,
+                      uint8_t *_out, size_t _point_step, size_t _rgb_offset)
+{
+  if (!PaddedLayout(_point_step, _rgb_offset))
+  {
+    return PackXYZRGBScalar(_x, _y, _z, _color, _channels, _n, _out,
+                            _point_step, _rgb_offset);
+  }
+  const float32x4_t zero = vdupq_n_f32(0.0f);
+  size_t invalid = 0;
+  size_t i = 0;
+  for (; i + 4 <= _n; i += 4)
+  {
+    float32x4_t x = vld1q_f32(_x + i);
+    float32x4_t y = vld1q_f32(_y + i);
+    float32x4_t z = vld1q_f32(_z + i);
+    // 1 per NaN lane, summed pairwise (vaddvq is aarch64 only)
+    uint32x4_t nan = vshrq_n_u32(vmvnq_u32(vceqq_f32(z, z)), 31);
+    uint32x2_t sum = vadd_u32(vget_low_u32(nan), vget_high_u32(nan));
+    invalid += vget_lane_u32(vpadd_u32(sum, sum), 0);
+
+    // transpose to x y z 0 per point
+    float32x4x2_t xz = vzipq_f32(x, z);
+    float32x4x2_t y0 = vzipq_f32(y, zero);
+    float32x4x2_t p01 = vzipq_f32(xz.val[0], y0.val[0]);
+    float32x4x2_t p23 = vzipq_f32(xz.val[1], y0.val[1]);
+    uint8_t *out = _out + i * _point_step;
+    vst1q_f32(reinterpret_cast<float *>(out), p01.val[0]);
+    vst1q_f32(reinterpret_cast<float *>(out + _point_step), p01.val[1]);
+    vst1q_f32(reinterpret_cast<float *>(out + 2 * _point_step), p23.val[0]);
+    vst1q_f32(reinterpret_cast<float *>(out + 3 * _point_step), p23.val[1]);
+    for (size_t k = 0; k < 4; ++k)
+      StoreColor(out + k * _point_step + _rgb_offset, _color, _channels, i + k);
+  }
+  return invalid + PackXYZRGBScalar(_x + i, _y + i, _z + i,
+      _color ? _color + i * _channels : NULL, _channels, _n - i,
+      _out + i * _point_step, _point_step, _rgb_offset);
+}
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+struct Kernels
+{
+  const char *name;
+  void (*clip)(const float *, float *, size_t, float, float);
+  void (*millimeters)(const float *, uint16_t *, size_t, float, float);
+  void (*disparity)(const float *, float *, size_t, float, float, float);
+  size_t (*pack)(const float *, const float *, const float *, const uint8_t *,
+                 int, size_t, uint8_t *, size_t, size_t);
+};
+
+const Kernels kScalar = {"scalar", &ClipDepthScalar,
+  &DepthToMillimetersScalar, &DepthToDisparityScalar, &PackXYZRGBScalar};
+#ifdef DEPTH_KERNELS_X86
+const Kernels kSSE2 = {"sse2", &ClipDepthSSE2,
+  &DepthToMillimetersSSE2, &DepthToDisparitySSE2, &PackXYZRGBSSE2};
+const Kernels kAVX2 = {"avx2", &ClipDepthAVX2,
+  &DepthToMillimetersAVX2, &DepthToDisparityAVX2, &PackXYZRGBAVX2};
+#endif
+#ifdef DEPTH_KERNELS_NEON
+const Kernels kNEON = {"neon", &ClipDepthNEON,
+  &DepthToMillimetersNEON, &DepthToDisparityNEON, &PackXYZRGBNEON};
+#endif
+
+const Kernels *Find(const char *_name)
+{
+  if (!strcmp(_name, "scalar"))
+    return &kScalar;
+#ifdef DEPTH_KERNELS_X86
+  if (!strcmp(_name, "sse2") && __builtin_cpu_supports("sse2"))
+    return &kSSE2;
+  if (!strcmp(_name, "avx2") && __builtin_cpu_supports("avx2"))
+    return &kAVX2;
+#endif
+#ifdef DEPTH_KERNELS_NEON
+  if (!strcmp(_name, "neon"))
+    return &kNEON;
+#endif
+  return NULL;
+}
+
+const Kernels *g_kernels = NULL;
+boost::once_flag g_kernels_once = BOOST_ONCE_INIT;
+
+void SelectKernels()
+{
+  const char *forced = getenv("GAZEBO_ROS_DEPTH_KERNELS");
+  if (forced && Find(forced))
+  {
+    g_kernels = Find(forced);
+    return;
+  }
+  const char *best[] = {"avx2", "sse2", "neon"};
+  for (size_t i = 0; i < sizeof(best) / sizeof(best[0]); ++i)
+  {
+    if (const Kernels *k = Find(best[i]))
+    {
+      g_kernels = k;
+      return;
+    }
+  }
+  g_kernels = &kScalar;
+}
+
+const Kernels &Get()
+{
+  boost::call_once(&SelectKernels, g_kernels_once);
+  return *g_kernels;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Workers running the row chunks of ParallelRows().
+class RowPool
+{
+  public: explicit RowPool(size_t _threads)
+  {
+    for (size_t i = 0; i < _threads; ++i)
+      this->threads_.create_thread(boost::bind(&RowPool::Work, this));
+  }
+
+  public: size_t Size()
+  {
+    return this->threads_.size();
+  }
+
+  public: void Post(const boost::function<void()> &_job)
+  {
+    {
+      boost::mutex::scoped_lock lock(this->lock_);
+      this->jobs_.push_back(_job);
+    }
+    this->cond_.notify_one();
+  }
+
+  private: void Work()
+  {
+    ThreadPolicy::instance().apply("compute", "gzros_kernels");
+    boost::mutex::scoped_lock lock(this->lock_);
+    while (true)
+    {
+      while (this->jobs_.empty())
+        this->cond_.wait(lock);
+      boost::function<void()> job = this->jobs_.front();
+      this->jobs_.pop_front();
+      lock.unlock();
+      job();
+      lock.lock();
+    }
+  }
+
+  private: boost::mutex lock_;
+  private: boost::condition_variable cond_;
+  private: std::deque<boost::function<void()> > jobs_;
+  private: boost::thread_group threads_;
+};
+
+RowPool *g_row_pool = NULL;
+boost::once_flag g_row_pool_once = BOOST_ONCE_INIT;
+
+void CreateRowPool()
+{
+  // the calling thread takes a chunk as well; intentionally leaked, the
+  // workers block forever on an empty queue
+  unsigned int cores = std::max(1u, boost::thread::hardware_concurrency());
+  g_row_pool = new RowPool(std::min(cores, 8u) - 1);
+}
+
+/// \brief Counts down finished chunks.
+struct Latch
+{
+  boost::mutex lock;
+  boost::condition_variable cond;
+  size_t remaining;
+};
+
+void RunChunk(const boost::function<void(size_t, size_t)> *_f,
+              size_t _begin, size_t _end, Latch *_latch)
+{
+  (*_f)(_begin, _end);
+  boost::mutex::scoped_lock lock(_latch->lock);
+  if (--_latch->remaining == 0)
+    _latch->cond.notify_all();
+}
+
+/// \brief Below this many pixels a frame is converted on the calling thread.
+const size_t kParallelPixels = 1 << 17;
+
+/// \brief Fewest rows handed to one worker.
+const size_t kMinChunkRows = 16;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+const char *Implementation()
+{
+  return Get().name;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool SetImplementation(const char *_name)
+{
+  Get();
+  const Kernels *k = Find(_name);
+  if (!k)
+    return false;
+  g_kernels = k;
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ClipDepth(const float *_src, float *_dst, size_t _n,
+               float _min, float _max)
+{
+  Get().clip(_src, _dst, _n, _min, _max);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void DepthToMillimeters(const float *_src, uint16_t *_dst, size_t _n,
+                        float _min, float _max)
+{
+  Get().millimeters(_src, _dst, _n, _min, _max);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void DepthToDisparity(const float *_src, float *_dst, size_t _n,
+                      float _baseline_focal, float _min, float _max)
+{
+  Get().disparity(_src, _dst, _n, _baseline_focal, _min, _max);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+size_t PackXYZRGB(const float *_x, const float *_y, const float *_z,
+                  const uint8_t *_color, int _channels, size_t _n,
+                  uint8_t *_out, size_t _point_step, size_t _rgb_offset)
+{
+  return Get().pack(_x, _y, _z, _color, _channels, _n, _out, _point_step,
+                    _rgb_offset);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ParallelRows(size_t _rows, size_t _cols,
+                  const boost::function<void(size_t, size_t)> &_f)
+{
+  if (_rows * _cols < kParallelPixels || _rows < 2 * kMinChunkRows)
+  {
+    _f(0, _rows);
+    return;
+  }
+
+  boost::call_once(&CreateRowPool, g_row_pool_once);
+  size_t chunks = std::min(g_row_pool->Size() + 1, _rows / kMinChunkRows);
+  if (chunks < 2)
+  {
+    _f(0, _rows);
+    return;
+  }
+
+  size_t per_chunk = (_rows + chunks - 1) / chunks;
+  Latch latch;
+  latch.remaining = chunks - 1;
+  for (size_t c = 1; c < chunks; ++c)
+  {
+    size_t begin = c * per_chunk;
+    size_t end = std::min(_rows, begin + per_chunk);
+    if (begin >= end)
+    {
+      boost::mutex::scoped_lock lock(latch.lock);
+      --latch.remaining;
+      continue;
+    }
+    g_row_pool->Post(boost::bind(&RunChunk, &_f, begin, end, &latch));
+  }
+  _f(0, std::min(_rows, per_chunk));
+
+  boost::mutex::scoped_lock lock(latch.lock);
+  while (latch.remaining > 0)
+    latch.cond.wait(lock);
+}
+}
+}
@@ -0,0 +1,92 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <cmath>
+
+#include <gazebo_plugins/depth_ray_lut.h>
+
+namespace gazebo
+{
+////////////////////////////////////////////////////////////////////////////////
+DepthRayLUT::DepthRayLUT()
+  : rows_(0), cols_(0), hfov_(0.0)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool DepthRayLUT::Update(unsigned int _rows, unsigned int _cols, double _hfov)
+{
+  if (_rows == this->rows_ && _cols == this->cols_ && _hfov == this->hfov_)
+    return false;
+
+  this->rows_ = _rows;
+  this->cols_ = _cols;
+  this->hfov_ = _hfov;
+
+  // same model the plugins always used: square pixels, principal point in
+  // the image center, focal length from the horizontal field of view
+  double fl = static_cast<double>(_cols) / (2.0 * tan(_hfov / 2.0));
+
+  this->x_.resize(_cols);
+  for (unsigned int i = 0; i < _cols; ++i)
+  {
+    double yAngle = 0.0;
+    if (_cols > 1)
+      yAngle = atan2(static_cast<double>(i) - 0.5 * (_cols - 1), fl);
+    this->x_[i] = static_cast<float>(tan(yAngle));
+  }
+
+  this->y_.resize(_rows);
+  for (unsigned int j = 0; j < _rows; ++j)
+  {
+    double pAngle = 0.0;
+    if (_rows > 1)
+      pAngle = atan2(static_cast<double>(j) - 0.5 * (_rows - 1), fl);
+    this->y_[j] = static_cast<float>(tan(pAngle));
+  }
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+const float *DepthRayLUT::X() const
+{
+  return this->x_.empty() ? NULL : &this->x_[0];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+const float *DepthRayLUT::Y() const
+{
+  return this->y_.empty() ? NULL : &this->y_[0];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void DepthRayLUT::UnprojectRow(unsigned int _row, const float *_depth,
+                               float *_x, float *_y) const
+{
+  const float *__restrict__ depth = _depth;
+  const float *__restrict__ slope_x = &this->x_[0];
+  float *__restrict__ x = _x;
+  float *__restrict__ y = _y;
+  const float slope_y = this->y_[_row];
+  const unsigned int cols = this->cols_;
+  for (unsigned int i = 0; i < cols; ++i)
+  {
+    x[i] = depth[i] * slope_x[i];
+    y[i] = depth[i] * slope_y;
+  }
+}
+}
@@ -22,71 +22,64 @@
 
 #include <algorithm>
 #include <assert.h>
+#include <cmath>
+#include <cstring>
 #include <limits>
 
 #include <gazebo_plugins/gazebo_ros_block_laser.h>
-#include <gazebo_plugins/gazebo_ros_utils.h>
-
-#include <gazebo/physics/World.hh>
-#include <gazebo/physics/HingeJoint.hh>
-#include <gazebo/sensors/Sensor.hh>
-#include <sdf/sdf.hh>
-#include <sdf/Param.hh>
-#include <gazebo/common/Exception.hh>
-#include <gazebo/sensors/RaySensor.hh>
-#include <gazebo/sensors/SensorTypes.hh>
-#include <gazebo/transport/Node.hh>
 
-#ifdef ENABLE_PROFILER
-#include <ignition/common/Profiler.hh>
-#endif
+#include <gazebo/transport/Node.hh>
 
 #include <geometry_msgs/Point32.h>
 #include <sensor_msgs/ChannelFloat32.h>
-
-#include <tf/tf.h>
+#include <sensor_msgs/point_cloud2_iterator.h>
 
 #define EPSILON_DIFF 0.000001
 
 namespace gazebo
 {
+namespace
+{
+/// \brief Give a pooled cloud the layout of _layout, its data keeps its
+/// capacity
+void CopyLayout(const sensor_msgs::PointCloud2 &_layout,
+                sensor_msgs::PointCloud2 &_msg)
+{
+  _msg.fields = _layout.fields;
+  _msg.height = _layout.height;
+  _msg.width = _layout.width;
+  _msg.point_step = _layout.point_step;
+  _msg.row_step = _layout.row_step;
+  _msg.is_bigendian = _layout.is_bigendian;
+  _msg.data.resize(_layout.row_step * _layout.height);
+}
+}
+
 // Register this plugin with the simulator
 GZ_REGISTER_SENSOR_PLUGIN(GazeboRosBlockLaser)
 
 ////////////////////////////////////////////////////////////////////////////////
 // Constructor
 GazeboRosBlockLaser::GazeboRosBlockLaser()
+  : SensorPluginBase("block_laser")
 {
+  this->ray_count_ = 0;
+  this->vertical_ray_count_ = 0;
+  this->last_packet_ = -1;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 // Destructor
 GazeboRosBlockLaser::~GazeboRosBlockLaser()
 {
-  ////////////////////////////////////////////////////////////////////////////////
-  // Finalize the controller / Custom Callback Queue
-  this->laser_queue_.clear();
-  this->laser_queue_.disable();
-  this->rosnode_->shutdown();
-  this->callback_laser_queue_thread_.join();
-
-  delete this->rosnode_;
+  this->ShutdownRos();
+  this->compressed_publisher_.reset();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-// Load the controller
-void GazeboRosBlockLaser::Load(sensors::SensorPtr _parent, sdf::ElementPtr _sdf)
+// Read the plugin parameters
+bool GazeboRosBlockLaser::LoadSdf(sdf::ElementPtr _sdf)
 {
-  // load plugin
-  RayPlugin::Load(_parent, _sdf);
-
-  // Get then name of the parent sensor
-  this->parent_sensor_ = _parent;
-
-  // Get the world name.
-  std::string worldName = _parent->WorldName();
-  this->world_ = physics::get_world(worldName);
-
 #if GAZEBO_MAJOR_VERSION >= 8
   last_update_time_ = this->world_->SimTime();
 #else
@@ -94,17 +87,7 @@ void GazeboRosBlockLaser::Load(sensors::SensorPtr _parent, sdf::ElementPtr _sdf)
 #endif
 
   this->node_ = transport::NodePtr(new transport::Node());
-  this->node_->Init(worldName);
-
-  GAZEBO_SENSORS_USING_DYNAMIC_POINTER_CAST;
-  this->parent_ray_sensor_ = dynamic_pointer_cast<sensors::RaySensor>(this->parent_sensor_);
-
-  if (!this->parent_ray_sensor_)
-    gzthrow("GazeboRosBlockLaser controller requires a Ray Sensor as its parent");
-
-  this->robot_namespace_ = "";
-  if (_sdf->HasElement("robotNamespace"))
-    this->robot_namespace_ = _sdf->GetElement("robotNamespace")->Get<std::string>() + "/";
+  this->node_->Init(this->world_name_);
 
   if (!_sdf->HasElement("frameName"))
   {
@@ -122,6 +105,33 @@ void GazeboRosBlockLaser::Load(sensors::SensorPtr _parent, sdf::ElementPtr _sdf)
   else
     this->topic_name_ = _sdf->GetElement("topicName")->Get<std::string>();
 
+  // the deprecated sensor_msgs::PointCloud is only published on request
+  if (!_sdf->HasElement("legacyTopicName"))
+    this->legacy_topic_name_ = "";
+  else
+    this->legacy_topic_name_ = _sdf->GetElement("legacyTopicName")->Get<std::string>();
+
+  // the compressed clouds too
+  if (!_sdf->HasElement("compressedPointCloudTopicName"))
+    this->compressed_topic_name_ = "";
+  else
+    this->compressed_topic_name_ = _sdf->GetElement("compressedPointCloudTopicName")->Get<std::string>();
+
+  if (!_sdf->HasElement("compressedPointCloudResolution"))
+    this->compressed_resolution_ = 0.001;
+  else
+    this->compressed_resolution_ = _sdf->GetElement("compressedPointCloudResolution")->Get<double>();
+
+  if (!_sdf->HasElement("compressedPointCloudEntropyCoding"))
+    this->compressed_entropy_ = true;
+  else
+    this->compressed_entropy_ = _sdf->GetElement("compressedPointCloudEntropyCoding")->Get<bool>();
+
+  if (!_sdf->HasElement("compressedPointCloudThreads"))
+    this->compressed_threads_ = 0;
+  else
+    this->compressed_threads_ = _sdf->GetElement("compressedPointCloudThreads")->Get<int>();
+
   if (!_sdf->HasElement("gaussianNoise"))
   {
     ROS_INFO_NAMED("block_laser", "Block laser plugin missing <gaussianNoise>, defaults to 0.0");
@@ -129,6 +139,7 @@ void GazeboRosBlockLaser::Load(sensors::SensorPtr _parent, sdf::ElementPtr _sdf)
   }
   else
     this->gaussian_noise_ = _sdf->GetElement("gaussianNoise")->Get<double>();
+  this->noise_.Seed(GaussianNoise::SeedFromSdf(_sdf, this->parent_sensor_->ScopedName()));
 
   if (!_sdf->HasElement("hokuyoMinIntensity"))
   {
@@ -149,73 +160,219 @@ void GazeboRosBlockLaser::Load(sensors::SensorPtr _parent, sdf::ElementPtr _sdf)
     this->update_rate_ = _sdf->GetElement("updateRate")->Get<double>();
   // FIXME:  update the update_rate_
 
+  if (!_sdf->HasElement("spinning"))
+    this->spinning_ = false;
+  else
+    this->spinning_ = _sdf->GetElement("spinning")->Get<bool>();
 
-  this->laser_connect_count_ = 0;
+  if (!_sdf->HasElement("spinRate"))
+  {
+    if (this->spinning_)
+      ROS_INFO_NAMED("block_laser", "Block laser plugin missing <spinRate>, defaults to 10");
+    this->spin_rate_ = 10;
+  }
+  else
+    this->spin_rate_ = _sdf->GetElement("spinRate")->Get<double>();
 
-  // Make sure the ROS node for Gazebo has already been initialized
-  if (!ros::isInitialized())
+  if (!_sdf->HasElement("packetsPerRevolution"))
+    this->packets_per_revolution_ = 1;
+  else
+    this->packets_per_revolution_ = _sdf->GetElement("packetsPerRevolution")->Get<int>();
+
+  if (this->spinning_ && this->spin_rate_ <= 0)
   {
-    ROS_FATAL_STREAM_NAMED("block_laser", "A ROS node for Gazebo has not been initialized, unable to load plugin. "
-      << "Load the Gazebo system plugin 'libgazebo_ros_api_plugin.so' in the gazebo_ros package)");
-    return;
+    ROS_WARN_NAMED("block_laser", "Block laser plugin <spinRate> must be positive, defaults to 10");
+    this->spin_rate_ = 10;
+  }
+  if (this->packets_per_revolution_ < 1)
+  {
+    ROS_WARN_NAMED("block_laser", "Block laser plugin <packetsPerRevolution> must be at least 1, defaults to 1");
+    this->packets_per_revolution_ = 1;
   }
+  if (this->spinning_ && this->update_rate_ > 0 &&
+      this->update_rate_ < this->spin_rate_ * this->packets_per_revolution_)
+    ROS_WARN_NAMED("block_laser", "Block laser plugin <updateRate> %f is below <spinRate> * "
+      "<packetsPerRevolution>, packets swept between two updates are built from the same scan",
+      this->update_rate_);
 
-  this->rosnode_ = new ros::NodeHandle(this->robot_namespace_);
+  this->intensity_.Load(_sdf, "block_laser");
 
-  // resolve tf prefix
-  std::string prefix;
-  this->rosnode_->getParam(std::string("tf_prefix"), prefix);
-  this->frame_name_ = tf::resolve(prefix, this->frame_name_);
+  // build the interpolation tables and the message layouts once,
+  // PutLaserData only rebuilds them if the sensor resolution changes
+  this->UpdateTables();
 
-  // set size of cloud message, starts at 0!! FIXME: not necessary
-  this->cloud_msg_.points.clear();
-  this->cloud_msg_.channels.clear();
-  this->cloud_msg_.channels.push_back(sensor_msgs::ChannelFloat32());
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Load the controller
+void GazeboRosBlockLaser::LoadRos()
+{
+  // resolve tf prefix
+  this->frame_name_ = this->ResolveFrame(this->frame_name_);
 
   if (this->topic_name_ != "")
   {
-    // Custom Callback Queue
-    ros::AdvertiseOptions ao = ros::AdvertiseOptions::create<sensor_msgs::PointCloud>(
-      this->topic_name_,1,
-      boost::bind( &GazeboRosBlockLaser::LaserConnect,this),
-      boost::bind( &GazeboRosBlockLaser::LaserDisconnect,this), ros::VoidPtr(), &this->laser_queue_);
-    this->pub_ = this->rosnode_->advertise(ao);
-  }
-
-
-  // Initialize the controller
+    this->cloud_pub_ =
+      this->Advertise<sensor_msgs::PointCloud2>(this->topic_name_);
 
-  // sensor generation off by default
-  this->parent_ray_sensor_->SetActive(false);
-  // start custom queue for laser
-  this->callback_laser_queue_thread_ = boost::thread( boost::bind( &GazeboRosBlockLaser::LaserQueueThread,this ) );
+    if (this->legacy_topic_name_ != "")
+      this->legacy_pub_ =
+        this->Advertise<sensor_msgs::PointCloud>(this->legacy_topic_name_);
 
+    if (this->compressed_topic_name_ != "")
+    {
+      const int threads = this->compressed_threads_ > 0 ?
+        this->compressed_threads_ :
+        static_cast<int>(PubServicePool::instance().threadCount());
+      this->compressed_pub_ = this->Advertise<gazebo_msgs::CompressedPointCloud>(
+        this->compressed_topic_name_, 2);
+      this->compressed_publisher_.reset(new CompressedPointCloudPublisher(
+        this->compressed_pub_->Publisher(), this->compressed_resolution_,
+        this->compressed_entropy_, static_cast<size_t>(std::max(threads, 1))));
+    }
+  }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-// Increment count
-void GazeboRosBlockLaser::LaserConnect()
+// Compress a cloud or packet
+void GazeboRosBlockLaser::PushCompressed(
+  const sensor_msgs::PointCloud2ConstPtr &_msg)
 {
-  this->laser_connect_count_++;
-  this->parent_ray_sensor_->SetActive(true);
+  if (this->compressed_publisher_ && this->compressed_pub_->Subscribers() > 0)
+    this->compressed_publisher_->Push(_msg);
 }
+
 ////////////////////////////////////////////////////////////////////////////////
-// Decrement count
-void GazeboRosBlockLaser::LaserDisconnect()
+// Build the interpolation tables and size the cloud messages
+void GazeboRosBlockLaser::UpdateTables()
 {
-  this->laser_connect_count_--;
+  const int rayCount = this->parent_sensor_->RayCount();
+  const int rangeCount = this->parent_sensor_->RangeCount();
+  const int verticalRayCount = this->parent_sensor_->VerticalRayCount();
+  const int verticalRangeCount = this->parent_sensor_->VerticalRangeCount();
+  const double minAngle = this->parent_sensor_->AngleMin().Radian();
+  const double maxAngle = this->parent_sensor_->AngleMax().Radian();
+  const double verticalMinAngle = this->parent_sensor_->VerticalAngleMin().Radian();
+  const double verticalMaxAngle = this->parent_sensor_->VerticalAngleMax().Radian();
+
+  this->ray_count_ = rayCount;
+  this->vertical_ray_count_ = verticalRayCount;
+
+  // horizontal: each range lies between rays h_lo_ and h_hi_, h_frac_ of
+  // the way from h_lo_.  The point is placed mid-way between the two rays.
+  this->h_lo_.resize(rangeCount);
+  this->h_hi_.resize(rangeCount);
+  this->h_frac_.resize(rangeCount);
+  this->cos_yaw_.resize(rangeCount);
+  this->sin_yaw_.resize(rangeCount);
+  this->range_time_.resize(rangeCount);
+  this->packet_begin_.assign(this->packets_per_revolution_ + 1, rangeCount);
+  const double packetPeriod = 1.0 / (this->spin_rate_ * this->packets_per_revolution_);
+  for (int i = 0; i < rangeCount; ++i)
+  {
+    double hb = (rangeCount == 1) ? 0 : (double) i * (rayCount - 1) / (rangeCount - 1);
+    int hja = (int) floor(hb);
+    int hjb = std::min(hja + 1, rayCount - 1);
+    assert(hja >= 0 && hja < rayCount);
+    assert(hjb >= 0 && hjb < rayCount);
+    this->h_lo_[i] = hja;
+    this->h_hi_[i] = hjb;
+    this->h_frac_[i] = hb - floor(hb);
+
+    double yAngle = minAngle;
+    if (rayCount > 1)
+      yAngle += 0.5*(hja+hjb) * (maxAngle - minAngle) / (rayCount -1);
+    this->cos_yaw_[i] = cos(yAngle);
+    this->sin_yaw_[i] = sin(yAngle);
+
+    // spinning: the part of the revolution swept when the range is reached,
+    // ranges are in increasing yaw so the packets are contiguous
+    double phase = (yAngle - minAngle) / (2 * M_PI);
+    int packet = std::min(std::max((int) floor(phase * this->packets_per_revolution_), 0),
+                          this->packets_per_revolution_ - 1);
+    for (int p = packet; p >= 0 && this->packet_begin_[p] > i; --p)
+      this->packet_begin_[p] = i;
+    this->range_time_[i] = phase / this->spin_rate_ - packet * packetPeriod;
+  }
+
+  // vertical
+  this->v_lo_.resize(verticalRangeCount);
+  this->v_hi_.resize(verticalRangeCount);
+  this->v_frac_.resize(verticalRangeCount);
+  this->cos_pitch_.resize(verticalRangeCount);
+  this->sin_pitch_.resize(verticalRangeCount);
+  for (int j = 0; j < verticalRangeCount; ++j)
+  {
+    double vb = (verticalRangeCount == 1) ? 0 : (double) j * (verticalRayCount - 1) / (verticalRangeCount - 1);
+    int vja = (int) floor(vb);
+    int vjb = std::min(vja + 1, verticalRayCount - 1);
+    assert(vja >= 0 && vja < verticalRayCount);
+    assert(vjb >= 0 && vjb < verticalRayCount);
+    this->v_lo_[j] = vja;
+    this->v_hi_[j] = vjb;
+    this->v_frac_[j] = vb - floor(vb);
+
+    double pAngle = verticalMinAngle;
+    if (verticalRayCount > 1)
+      pAngle += 0.5*(vja+vjb) * (verticalMaxAngle - verticalMinAngle) / (verticalRayCount -1);
+    this->cos_pitch_[j] = cos(pAngle);
+    this->sin_pitch_[j] = sin(pAngle);
+  }
 
-  if (this->laser_connect_count_ == 0)
-    this->parent_ray_sensor_->SetActive(false);
+  this->ray_ranges_.resize(rayCount * verticalRayCount);
+  this->ray_retros_.resize(rayCount * verticalRayCount);
+  this->row_ranges_.resize(rayCount);
+  this->row_retros_.resize(rayCount);
+  this->scan_row_.resize(5 * rangeCount);
+  this->noise_row_.resize(4 * rangeCount);
+
+  // the cloud layout
+  sensor_msgs::PointCloud2Modifier modifier(this->cloud_msg_);
+  modifier.setPointCloud2Fields(4,
+      "x", 1, sensor_msgs::PointField::FLOAT32,
+      "y", 1, sensor_msgs::PointField::FLOAT32,
+      "z", 1, sensor_msgs::PointField::FLOAT32,
+      "intensity", 1, sensor_msgs::PointField::FLOAT32);
+  modifier.resize(rangeCount * verticalRangeCount);
+  this->cloud_msg_.height = verticalRangeCount;
+  this->cloud_msg_.width = rangeCount;
+  this->cloud_msg_.row_step = this->cloud_msg_.point_step * rangeCount;
+  this->cloud_msg_.is_bigendian = false;
+  std::vector<uint8_t>().swap(this->cloud_msg_.data);
+
+  // the packets: the fields of velodyne_pointcloud's PointXYZIRT, each on
+  // its natural alignment
+  this->packet_msgs_.resize(this->spinning_ ? this->packets_per_revolution_ : 0);
+  for (size_t p = 0; p < this->packet_msgs_.size(); ++p)
+  {
+    sensor_msgs::PointCloud2 &packet = this->packet_msgs_[p];
+    const char *names[] = {"x", "y", "z", "intensity", "ring", "time"};
+    const uint8_t types[] = {sensor_msgs::PointField::FLOAT32, sensor_msgs::PointField::FLOAT32,
+                             sensor_msgs::PointField::FLOAT32, sensor_msgs::PointField::FLOAT32,
+                             sensor_msgs::PointField::UINT16, sensor_msgs::PointField::FLOAT32};
+    const uint32_t offsets[] = {0, 4, 8, 12, 16, 20};
+    packet.fields.resize(6);
+    for (int f = 0; f < 6; ++f)
+    {
+      packet.fields[f].name = names[f];
+      packet.fields[f].offset = offsets[f];
+      packet.fields[f].datatype = types[f];
+      packet.fields[f].count = 1;
+    }
+    packet.point_step = 24;
+    packet.height = verticalRangeCount;
+    packet.width = this->packet_begin_[p + 1] - this->packet_begin_[p];
+    packet.row_step = packet.point_step * packet.width;
+    packet.is_bigendian = false;
+  }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 // Update the controller
 void GazeboRosBlockLaser::OnNewLaserScans()
 {
-#ifdef ENABLE_PROFILER
-  IGN_PROFILE("GazeboRosBlockLaser::OnNewLaserScans");
-#endif
+  GAZEBO_ROS_PROFILE("GazeboRosBlockLaser::OnNewLaserScans");
   if (this->topic_name_ != "")
   {
     common::Time sensor_update_time = this->parent_sensor_->LastUpdateTime();
@@ -227,13 +384,9 @@ void GazeboRosBlockLaser::OnNewLaserScans()
 
     if (last_update_time_ < sensor_update_time)
     {
-#ifdef ENABLE_PROFILER
-      IGN_PROFILE_BEGIN("PutLaserData");
-#endif
+      GAZEBO_ROS_PROFILE_BEGIN("PutLaserData");
       this->PutLaserData(sensor_update_time);
-#ifdef ENABLE_PROFILER
-      IGN_PROFILE_END();
-#endif
+      GAZEBO_ROS_PROFILE_END();
       last_update_time_ = sensor_update_time;
     }
   }
@@ -247,175 +400,302 @@ void GazeboRosBlockLaser::OnNewLaserScans()
 // Put laser data to the interface
 void GazeboRosBlockLaser::PutLaserData(common::Time &_updateTime)
 {
-  int i, hja, hjb;
-  int j, vja, vjb;
-  double vb, hb;
-  int    j1, j2, j3, j4; // four corners indices
-  double r1, r2, r3, r4, r; // four corner values + interpolated range
-  double intensity;
-
-  this->parent_ray_sensor_->SetActive(false);
-
-  auto maxAngle = this->parent_ray_sensor_->AngleMax();
-  auto minAngle = this->parent_ray_sensor_->AngleMin();
-
-  double maxRange = this->parent_ray_sensor_->RangeMax();
-  double minRange = this->parent_ray_sensor_->RangeMin();
-  int rayCount = this->parent_ray_sensor_->RayCount();
-  int rangeCount = this->parent_ray_sensor_->RangeCount();
-
-  int verticalRayCount = this->parent_ray_sensor_->VerticalRayCount();
-  int verticalRangeCount = this->parent_ray_sensor_->VerticalRangeCount();
-  auto verticalMaxAngle = this->parent_ray_sensor_->VerticalAngleMax();
-  auto verticalMinAngle = this->parent_ray_sensor_->VerticalAngleMin();
-
-  double yDiff = maxAngle.Radian() - minAngle.Radian();
-  double pDiff = verticalMaxAngle.Radian() - verticalMinAngle.Radian();
-
+  const int rangeCount = this->parent_sensor_->RangeCount();
+  const int verticalRangeCount = this->parent_sensor_->VerticalRangeCount();
+
+  // the tables only change with the sensor resolution
+  if (this->cloud_msg_.width != static_cast<uint32_t>(rangeCount) ||
+      this->cloud_msg_.height != static_cast<uint32_t>(verticalRangeCount) ||
+      this->ray_count_ != this->parent_sensor_->RayCount() ||
+      this->vertical_ray_count_ != this->parent_sensor_->VerticalRayCount())
+    this->UpdateTables();
+
+  // copy the rays out while the sensor is paused, the conversion below
+  // runs with the sensor active again.  Without intensities the retros
+  // are not read and stay 0.
+  const bool retros = this->intensity_.Enabled();
+  this->parent_sensor_->SetActive(false);
+  {
+    boost::mutex::scoped_lock sclock(this->lock);
+    physics::MultiRayShapePtr shape = this->parent_sensor_->LaserShape();
+    for (size_t k = 0; k < this->ray_ranges_.size(); ++k)
+      this->ray_ranges_[k] = shape->GetRange(k);
+    if (retros)
+    {
+      for (size_t k = 0; k < this->ray_retros_.size(); ++k)
+        this->ray_retros_[k] = shape->GetRetro(k);
+    }
+  }
+  this->parent_sensor_->SetActive(true);
+  const bool intensities = this->intensity_.Output(this->ray_retros_.begin(),
+                                                   this->ray_retros_.end());
 
-  // set size of cloud message everytime!
-  //int r_size = rangeCount * verticalRangeCount;
-  this->cloud_msg_.points.clear();
-  this->cloud_msg_.channels.clear();
-  this->cloud_msg_.channels.push_back(sensor_msgs::ChannelFloat32());
+  const bool legacy = this->legacy_pub_ && this->legacy_pub_->Subscribers() > 0;
+  // the compressed topic is encoded from the clouds of cloud_pub_
+  const bool cloud = this->cloud_pub_ && (this->cloud_pub_->Subscribers() > 0 ||
+    (this->compressed_pub_ && this->compressed_pub_->Subscribers() > 0));
+  ScopedTiming timing(this->update_timing_);
+  const ros::Time stamp(_updateTime.sec, _updateTime.nsec);
 
   /***************************************************************/
   /*                                                             */
   /*  point scan from laser                                      */
   /*                                                             */
   /***************************************************************/
-  boost::mutex::scoped_lock sclock(this->lock);
-  // Add Frame Name
-  this->cloud_msg_.header.frame_id = this->frame_name_;
-  this->cloud_msg_.header.stamp.sec = _updateTime.sec;
-  this->cloud_msg_.header.stamp.nsec = _updateTime.nsec;
+  // in spinning mode the whole scan is only built for the legacy topic
+  if (this->spinning_ && cloud)
+    this->PutPackets(_updateTime, intensities);
+  const bool scan = cloud && !this->spinning_;
+  if (!scan && !legacy)
+    return;
 
-  for (j = 0; j<verticalRangeCount; j++)
+  // recycled messages, filled in place
+  sensor_msgs::PointCloud2Ptr cloud_msg;
+  uint8_t *out = NULL;
+  if (scan)
   {
-    // interpolating in vertical direction
-    vb = (verticalRangeCount == 1) ? 0 : (double) j * (verticalRayCount - 1) / (verticalRangeCount - 1);
-    vja = (int) floor(vb);
-    vjb = std::min(vja + 1, verticalRayCount - 1);
-    vb = vb - floor(vb); // fraction from min
+    this->cloud_pub_->TraceLatency(LatencyTracer::SENSOR_CALLBACK, stamp);
+    cloud_msg = this->cloud_pub_->Acquire();
+    // x, y, z and the intensity, if any, in its own type
+    this->intensity_.SetFields(*cloud_msg, intensities);
+    cloud_msg->height = verticalRangeCount;
+    cloud_msg->width = rangeCount;
+    cloud_msg->row_step = cloud_msg->point_step * rangeCount;
+    cloud_msg->is_bigendian = false;
+    cloud_msg->data.resize(cloud_msg->row_step * verticalRangeCount);
+    cloud_msg->header.frame_id = this->frame_name_;
+    cloud_msg->header.stamp = stamp;
+    out = &cloud_msg->data[0];
+  }
 
-    assert(vja >= 0 && vja < verticalRayCount);
-    assert(vjb >= 0 && vjb < verticalRayCount);
+  sensor_msgs::PointCloudPtr legacy_msg;
+  if (legacy)
+  {
+    this->legacy_pub_->TraceLatency(LatencyTracer::SENSOR_CALLBACK, stamp);
+    legacy_msg = this->legacy_pub_->Acquire();
+    legacy_msg->header.frame_id = this->frame_name_;
+    legacy_msg->header.stamp = stamp;
+    legacy_msg->points.resize(rangeCount * verticalRangeCount);
+    legacy_msg->channels.resize(intensities ? 1 : 0);
+    if (intensities)
+    {
+      legacy_msg->channels[0].name = "intensity";
+      legacy_msg->channels[0].values.resize(rangeCount * verticalRangeCount);
+    }
+  }
 
-    for (i = 0; i<rangeCount; i++)
+  const float *r = &this->scan_row_[0];
+  const float *x = r + rangeCount;
+  const float *y = x + rangeCount;
+  const float *z = y + rangeCount;
+  const float *intensity = z + rangeCount;
+  bool dense = true;
+
+  for (int j = 0; j < verticalRangeCount; j++)
+  {
+    this->ConvertRow(j, 0, rangeCount);
+
+    if (scan)
     {
-      // Interpolate the range readings from the rays in horizontal direction
-      hb = (rangeCount == 1)? 0 : (double) i * (rayCount - 1) / (rangeCount - 1);
-      hja = (int) floor(hb);
-      hjb = std::min(hja + 1, rayCount - 1);
-      hb = hb - floor(hb); // fraction from min
-
-      assert(hja >= 0 && hja < rayCount);
-      assert(hjb >= 0 && hjb < rayCount);
-
-      // indices of 4 corners
-      j1 = hja + vja * rayCount;
-      j2 = hjb + vja * rayCount;
-      j3 = hja + vjb * rayCount;
-      j4 = hjb + vjb * rayCount;
-      // range readings of 4 corners
-      r1 = this->parent_ray_sensor_->LaserShape()->GetRange(j1);
-      r2 = this->parent_ray_sensor_->LaserShape()->GetRange(j2);
-      r3 = this->parent_ray_sensor_->LaserShape()->GetRange(j3);
-      r4 = this->parent_ray_sensor_->LaserShape()->GetRange(j4);
-
-      // Range is linear interpolation if values are close,
-      // and min if they are very different
-      r = (1-vb)*((1 - hb) * r1 + hb * r2)
-         +   vb *((1 - hb) * r3 + hb * r4);
-
-      // REP 117 says readings too close to the sensor become -inf, and too far away +inf
-      if (r < minRange)
+      const uint32_t step = cloud_msg->point_step;
+      uint8_t *row_out = out + j * cloud_msg->row_step;
+      for (int i = 0; i < rangeCount; i++)
       {
-        r = -std::numeric_limits<double>::infinity();
-      }
-      else if ( r > maxRange)
-      {
-        r = std::numeric_limits<double>::infinity();
+        uint8_t *point = row_out + i * step;
+        memcpy(point, &x[i], sizeof(float));
+        memcpy(point + 4, &y[i], sizeof(float));
+        memcpy(point + 8, &z[i], sizeof(float));
+        if (intensities)
+          this->intensity_.Write(point + 12, intensity[i]);
+        if (!std::isfinite(r[i]))
+          dense = false;
       }
+    }
 
-      // Intensity is averaged
-      intensity = 0.25*(this->parent_ray_sensor_->LaserShape()->GetRetro(j1) +
-                        this->parent_ray_sensor_->LaserShape()->GetRetro(j2) +
-                        this->parent_ray_sensor_->LaserShape()->GetRetro(j3) +
-                        this->parent_ray_sensor_->LaserShape()->GetRetro(j4));
-
-      // std::cout << " block debug "
-      //           << "  ij("<<i<<","<<j<<")"
-      //           << "  j1234("<<j1<<","<<j2<<","<<j3<<","<<j4<<")"
-      //           << "  r1234("<<r1<<","<<r2<<","<<r3<<","<<r4<<")"
-      //           << std::endl;
-
-      // get angles of ray to get xyz for point
-      double yAngle = 0.5*(hja+hjb) * yDiff / (rayCount -1) + minAngle.Radian();
-      double pAngle = 0.5*(vja+vjb) * pDiff / (verticalRayCount -1) + verticalMinAngle.Radian();
-
-      /***************************************************************/
-      /*                                                             */
-      /*  point scan from laser                                      */
-      /*                                                             */
-      /***************************************************************/
-      geometry_msgs::Point32 point;
-      //pAngle is rotated by yAngle:
-      point.x = r * cos(pAngle) * cos(yAngle);
-      point.y = r * cos(pAngle) * sin(yAngle);
-      point.z = r * sin(pAngle);
-
-      if (fabs(maxRange - r) > EPSILON_DIFF)
+    if (legacy)
+    {
+      for (int i = 0; i < rangeCount; i++)
       {
-        // add noise to range only if not at max range
-        point.x += this->GaussianKernel(0, this->gaussian_noise_);
-        point.y += this->GaussianKernel(0, this->gaussian_noise_);
-        point.z += this->GaussianKernel(0, this->gaussian_noise_);
+        geometry_msgs::Point32 &point = legacy_msg->points[i + j * rangeCount];
+        point.x = x[i];
+        point.y = y[i];
+        point.z = z[i];
+        if (intensities)
+          legacy_msg->channels[0].values[i + j * rangeCount] = intensity[i];
       }
-      this->cloud_msg_.points.push_back(point);
-
-      this->cloud_msg_.channels[0].values.push_back(intensity + this->GaussianKernel(0,this->gaussian_noise_)) ;
     }
   }
-  this->parent_ray_sensor_->SetActive(true);
 
   // send data out via ros message
-  this->pub_.publish(this->cloud_msg_);
+  if (scan)
+  {
+    cloud_msg->is_dense = dense;
+    this->cloud_pub_->TraceLatency(LatencyTracer::CONVERTED, stamp);
+    // shared with the encoder, back to the pool once both are done
+    this->PushCompressed(cloud_msg);
+    if (this->cloud_pub_->Subscribers() > 0)
+      this->cloud_pub_->Publish(cloud_msg);
+  }
+  if (legacy)
+  {
+    this->legacy_pub_->TraceLatency(LatencyTracer::CONVERTED, stamp);
+    this->legacy_pub_->Publish(legacy_msg);
+  }
+}
 
+////////////////////////////////////////////////////////////////////////////////
+// Convert part of a vertical row of the last scan
+void GazeboRosBlockLaser::ConvertRow(int _j, int _begin, int _end)
+{
+  const float maxRange = this->parent_sensor_->RangeMax();
+  const float minRange = this->parent_sensor_->RangeMin();
+  const int rangeCount = this->cloud_msg_.width;
+  const int rayCount = this->ray_count_;
+
+  const float inf = std::numeric_limits<float>::infinity();
+  const bool noise = this->gaussian_noise_ != 0.0;
+  float *r = &this->scan_row_[0];
+  float *x = r + rangeCount;
+  float *y = x + rangeCount;
+  float *z = y + rangeCount;
+  float *intensity = z + rangeCount;
+  float *noise_row = &this->noise_row_[0];
+  float *row_range = &this->row_ranges_[0];
+  float *row_retro = &this->row_retros_[0];
+  const int *h_lo = &this->h_lo_[0];
+  const int *h_hi = &this->h_hi_[0];
+  const float *h_frac = &this->h_frac_[0];
+  const float *cos_yaw = &this->cos_yaw_[0];
+  const float *sin_yaw = &this->sin_yaw_[0];
+
+  // interpolating in vertical direction, the ranges are bilinear in the
+  // four corners so the vertical pass can run over whole ray rows, or the
+  // part of them the ranges are interpolated from
+  const float vb = this->v_frac_[_j];
+  const float *ra = &this->ray_ranges_[this->v_lo_[_j] * rayCount];
+  const float *rb = &this->ray_ranges_[this->v_hi_[_j] * rayCount];
+  const float *ia = &this->ray_retros_[this->v_lo_[_j] * rayCount];
+  const float *ib = &this->ray_retros_[this->v_hi_[_j] * rayCount];
+  for (int k = h_lo[_begin]; k <= h_hi[_end - 1]; ++k)
+  {
+    row_range[k] = (1 - vb) * ra[k] + vb * rb[k];
+    // Intensity is averaged
+    row_retro[k] = 0.5f * (ia[k] + ib[k]);
+  }
 
+  // then in horizontal direction
+  for (int i = _begin; i < _end; i++)
+    r[i] = (1 - h_frac[i]) * row_range[h_lo[i]] + h_frac[i] * row_range[h_hi[i]];
 
-}
+  // REP 117 says readings too close to the sensor become -inf, and too far away +inf
+  for (int i = _begin; i < _end; i++)
+    r[i] = (r[i] < minRange) ? -inf : ((r[i] > maxRange) ? inf : r[i]);
 
+  //pAngle is rotated by yAngle:
+  const float cos_pitch = this->cos_pitch_[_j];
+  const float sin_pitch = this->sin_pitch_[_j];
+  for (int i = _begin; i < _end; i++)
+  {
+    x[i] = r[i] * cos_pitch * cos_yaw[i];
+    y[i] = r[i] * cos_pitch * sin_yaw[i];
+    z[i] = r[i] * sin_pitch;
+    intensity[i] = 0.5f * (row_retro[h_lo[i]] + row_retro[h_hi[i]]);
+  }
 
-//////////////////////////////////////////////////////////////////////////////
-// Utility for adding noise
-double GazeboRosBlockLaser::GaussianKernel(double mu,double sigma)
-{
-  // using Box-Muller transform to generate two independent standard normally disbributed normal variables
-  // see wikipedia
-  double U = (double)rand()/(double)RAND_MAX; // normalized uniform random variable
-  double V = (double)rand()/(double)RAND_MAX; // normalized uniform random variable
-  double X = sqrt(-2.0 * ::log(U)) * cos( 2.0*M_PI * V);
-  //double Y = sqrt(-2.0 * ::log(U)) * sin( 2.0*M_PI * V); // the other indep. normal variable
-  // we'll just use X
-  // scale to our mu and sigma
-  X = sigma * X + mu;
-  return X;
+  if (!noise)
+    return;
+
+  // noise of the whole row in one go, x, y, z and intensity per point
+  this->noise_.Fill(noise_row, 4 * (_end - _begin), 0, this->gaussian_noise_);
+  for (int i = _begin; i < _end; i++)
+  {
+    const float *n = noise_row + 4 * (i - _begin);
+    if (fabs(maxRange - r[i]) > EPSILON_DIFF)
+    {
+      // add noise to range only if not at max range
+      x[i] += n[0];
+      y[i] += n[1];
+      z[i] += n[2];
+    }
+    intensity[i] += n[3];
+  }
 }
 
-// Custom Callback Queue
 ////////////////////////////////////////////////////////////////////////////////
-// custom callback queue thread
-void GazeboRosBlockLaser::LaserQueueThread()
+// Publish the packets swept since the last update
+void GazeboRosBlockLaser::PutPackets(const common::Time &_updateTime,
+                                     bool _intensities)
 {
-  static const double timeout = 0.01;
-
-  while (this->rosnode_->ok())
+  const int packets = this->packets_per_revolution_;
+  const double packetPeriod = 1.0 / (this->spin_rate_ * packets);
+  const int64_t current = (int64_t) floor(_updateTime.Double() / packetPeriod);
+
+  // a world reset takes sim time back
+  if (current < this->last_packet_)
+    this->last_packet_ = current - 1;
+
+  // at most one revolution, the older packets would repeat the same ranges
+  int64_t first = std::max(this->last_packet_ + 1, current - packets + 1);
+  this->last_packet_ = current;
+
+  const int rangeCount = this->cloud_msg_.width;
+  const int verticalRangeCount = this->cloud_msg_.height;
+  const float *r = &this->scan_row_[0];
+  const float *x = r + rangeCount;
+  const float *y = x + rangeCount;
+  const float *z = y + rangeCount;
+  const float *intensity = z + rangeCount;
+
+  for (int64_t n = first; n <= current; ++n)
   {
-    this->laser_queue_.callAvailable(ros::WallDuration(timeout));
+    const int p = (int) (n % packets);
+    const int begin = this->packet_begin_[p];
+    const int end = this->packet_begin_[p + 1];
+    // the field of view does not reach this part of the revolution
+    if (begin == end)
+      continue;
+
+    const common::Time time(n * packetPeriod);
+    const ros::Time stamp(time.sec, time.nsec);
+    this->cloud_pub_->TraceLatency(LatencyTracer::SENSOR_CALLBACK, stamp);
+    sensor_msgs::PointCloud2Ptr msg = this->cloud_pub_->Acquire();
+    sensor_msgs::PointCloud2 &packet = *msg;
+    CopyLayout(this->packet_msgs_[p], packet);
+    packet.header.frame_id = this->frame_name_;
+    packet.header.stamp = stamp;
+
+    bool dense = true;
+    for (int j = 0; j < verticalRangeCount; j++)
+    {
+      this->ConvertRow(j, begin, end);
+
+      uint8_t *row_out = &packet.data[j * packet.row_step];
+      const uint16_t ring = j;
+      for (int i = begin; i < end; i++)
+      {
+        uint8_t *point = row_out + (i - begin) * packet.point_step;
+        memcpy(point, &x[i], sizeof(float));
+        memcpy(point + 4, &y[i], sizeof(float));
+        memcpy(point + 8, &z[i], sizeof(float));
+        const float value = _intensities ? intensity[i] : 0.0f;
+        memcpy(point + 12, &value, sizeof(float));
+        memcpy(point + 16, &ring, sizeof(uint16_t));
+        memcpy(point + 20, &this->range_time_[i], sizeof(float));
+        if (!std::isfinite(r[i]))
+          dense = false;
+      }
+    }
+    packet.is_dense = dense;
+
+    this->cloud_pub_->TraceLatency(LatencyTracer::CONVERTED, stamp);
+    this->PushCompressed(msg);
+    if (this->cloud_pub_->Subscribers() > 0)
+      this->cloud_pub_->Publish(msg);
   }
 }
 
+
+
 void GazeboRosBlockLaser::OnStats( const boost::shared_ptr<msgs::WorldStatistics const> &_msg)
 {
   this->sim_time_  = msgs::Convert( _msg->sim_time() );
@@ -22,7 +22,9 @@
  */
 
 #include <map>
+#include <sstream>
 #include <string>
+#include <vector>
 
 #include <gazebo/physics/World.hh>
 #include <gazebo/physics/HingeJoint.hh>
@@ -36,9 +38,7 @@
 #include <ignition/math/Quaternion.hh>
 #include <ignition/math/Vector3.hh>
 
-#ifdef ENABLE_PROFILER
-#include <ignition/common/Profiler.hh>
-#endif
+#include <gazebo_ros/profiler.h>
 
 #include <tf/tf.h>
 
@@ -52,7 +52,8 @@ GZ_REGISTER_SENSOR_PLUGIN(GazeboRosBumper)
 
 ////////////////////////////////////////////////////////////////////////////////
 // Constructor
-GazeboRosBumper::GazeboRosBumper() : SensorPlugin()
+GazeboRosBumper::GazeboRosBumper() : SensorPlugin(),
+  aggregate_contacts_(false), contact_point_stride_(1), contact_info_(true)
 {
 }
 
@@ -61,7 +62,7 @@ GazeboRosBumper::GazeboRosBumper() : SensorPlugin()
 GazeboRosBumper::~GazeboRosBumper()
 {
   this->rosnode_->shutdown();
-  this->callback_queue_thread_.join();
+  this->contact_queue_.Stop();
 
   delete this->rosnode_;
 }
@@ -70,6 +71,7 @@ GazeboRosBumper::~GazeboRosBumper()
 // Load the controller
 void GazeboRosBumper::Load(sensors::SensorPtr _parent, sdf::ElementPtr _sdf)
 {
+  GAZEBO_ROS_STARTUP_PHASE("load");
   GAZEBO_SENSORS_USING_DYNAMIC_POINTER_CAST;
   this->parentSensor = dynamic_pointer_cast<sensors::ContactSensor>(_parent);
   if (!this->parentSensor)
@@ -100,6 +102,18 @@ void GazeboRosBumper::Load(sensors::SensorPtr _parent, sdf::ElementPtr _sdf)
   else
     this->frame_name_ = _sdf->GetElement("frameName")->Get<std::string>();
 
+  if (_sdf->HasElement("aggregateContacts"))
+    this->aggregate_contacts_ = _sdf->Get<bool>("aggregateContacts");
+
+  if (_sdf->HasElement("contactPointStride"))
+  {
+    int stride = _sdf->Get<int>("contactPointStride");
+    this->contact_point_stride_ = stride > 1 ? stride : 1;
+  }
+
+  if (_sdf->HasElement("contactInfo"))
+    this->contact_info_ = _sdf->Get<bool>("contactInfo");
+
   // Make sure the ROS node for Gazebo has already been initialized
   if (!ros::isInitialized())
   {
@@ -119,9 +133,6 @@ void GazeboRosBumper::Load(sensors::SensorPtr _parent, sdf::ElementPtr _sdf)
     std::string(this->bumper_topic_name_), 1);
 
   // Initialize
-  // start custom queue for contact bumper
-  this->callback_queue_thread_ = boost::thread(
-      boost::bind(&GazeboRosBumper::ContactQueueThread, this));
 
   // Listen to the update event. This event is broadcast every
   // simulation iteration.
@@ -136,15 +147,11 @@ void GazeboRosBumper::Load(sensors::SensorPtr _parent, sdf::ElementPtr _sdf)
 // Update the controller
 void GazeboRosBumper::OnContact()
 {
-#ifdef ENABLE_PROFILER
-  IGN_PROFILE("GazeboRosBumper::OnContact");
-#endif
+  GAZEBO_ROS_PROFILE("GazeboRosBumper::OnContact");
   if (this->contact_pub_.getNumSubscribers() <= 0)
     return;
 
-#ifdef ENABLE_PROFILER
-  IGN_PROFILE_BEGIN("fill message");
-#endif
+  GAZEBO_ROS_PROFILE_BEGIN("fill message");
   msgs::Contacts contacts;
   contacts = this->parentSensor->Contacts();
   /// \TODO: need a time for each Contact in i-loop, they may differ
@@ -209,85 +216,104 @@ void GazeboRosBumper::OnContact()
 
 
 
-  // set contact states size
-  this->contact_state_msg_.states.clear();
-
-  // GetContacts returns all contacts on the collision body
+  // GetContacts returns all contacts on the collision body.
+  // The states and their arrays are reused, and keep their capacity.
   unsigned int contactsPacketSize = contacts.contact_size();
+  std::vector<gazebo_msgs::ContactState> &states =
+    this->contact_state_msg_.states;
+  states.reserve(contactsPacketSize);
+  size_t num_states = 0;
   for (unsigned int i = 0; i < contactsPacketSize; ++i)
   {
-
     // For each collision contact
-    // Create a ContactState
-    gazebo_msgs::ContactState state;
-    /// \TODO:
-    gazebo::msgs::Contact contact = contacts.contact(i);
-
-    state.collision1_name = contact.collision1();
-    state.collision2_name = contact.collision2();
-    std::ostringstream stream;
-    stream << "Debug:  i:(" << i << "/" << contactsPacketSize
-      << ")     my geom:" << state.collision1_name
-      << "   other geom:" << state.collision2_name
-      << "         time:" << ros::Time(contact.time().sec(), contact.time().nsec())
-      << std::endl;
-    state.info = stream.str();
-
-    state.wrenches.clear();
-    state.contact_positions.clear();
-    state.contact_normals.clear();
-    state.depths.clear();
-
-    // sum up all wrenches for each DOF
-    geometry_msgs::Wrench total_wrench;
-    total_wrench.force.x = 0;
-    total_wrench.force.y = 0;
-    total_wrench.force.z = 0;
-    total_wrench.torque.x = 0;
-    total_wrench.torque.y = 0;
-    total_wrench.torque.z = 0;
+    // Fill a ContactState
+    const gazebo::msgs::Contact &contact = contacts.contact(i);
+
+    // in aggregate mode, add up the contacts of a collision pair
+    size_t index = num_states;
+    if (this->aggregate_contacts_)
+    {
+      for (size_t k = 0; k < num_states; ++k)
+      {
+        if (states[k].collision1_name == contact.collision1() &&
+            states[k].collision2_name == contact.collision2())
+        {
+          index = k;
+          break;
+        }
+      }
+    }
+    if (index == num_states)
+    {
+      if (states.size() <= num_states)
+        states.resize(num_states + 1);
+      gazebo_msgs::ContactState &state = states[num_states++];
+      state.collision1_name = contact.collision1();
+      state.collision2_name = contact.collision2();
+      if (this->contact_info_ && !this->aggregate_contacts_)
+      {
+        std::ostringstream stream;
+        stream << "Debug:  i:(" << i << "/" << contactsPacketSize
+          << ")     my geom:" << state.collision1_name
+          << "   other geom:" << state.collision2_name
+          << "         time:" << ros::Time(contact.time().sec(), contact.time().nsec())
+          << std::endl;
+        state.info = stream.str();
+      }
+      else
+        state.info.clear();
+
+      // sum up all wrenches for each DOF
+      state.total_wrench = geometry_msgs::Wrench();
+    }
+    gazebo_msgs::ContactState &state = states[index];
 
     unsigned int contactGroupSize = contact.position_size();
+    size_t num_points = 0;
+    if (!this->aggregate_contacts_)
+      num_points = (contactGroupSize + this->contact_point_stride_ - 1) /
+        this->contact_point_stride_;
+    state.wrenches.resize(num_points);
+    state.contact_positions.resize(num_points);
+    state.contact_normals.resize(num_points);
+    state.depths.resize(num_points);
+
+    geometry_msgs::Wrench &total_wrench = state.total_wrench;
     for (unsigned int j = 0; j < contactGroupSize; ++j)
     {
       // loop through individual contacts between collision1 and collision2
-      // gzerr << j << "  Position:"
-      //       << contact.position(j).x() << " "
-      //       << contact.position(j).y() << " "
-      //       << contact.position(j).z() << "\n";
-      // gzerr << "   Normal:"
-      //       << contact.normal(j).x() << " "
-      //       << contact.normal(j).y() << " "
-      //       << contact.normal(j).z() << "\n";
-      // gzerr << "   Depth:" << contact.depth(j) << "\n";
 
       // Get force, torque and rotate into user specified frame.
       // frame_rot is identity if world is used (default for now)
+      const gazebo::msgs::Wrench &body_1_wrench = contact.wrench(j).body_1_wrench();
       ignition::math::Vector3d force = frame_rot.RotateVectorReverse(ignition::math::Vector3d(
-                              contact.wrench(j).body_1_wrench().force().x(),
-                            contact.wrench(j).body_1_wrench().force().y(),
-                            contact.wrench(j).body_1_wrench().force().z()));
+                            body_1_wrench.force().x(),
+                            body_1_wrench.force().y(),
+                            body_1_wrench.force().z()));
       ignition::math::Vector3d torque = frame_rot.RotateVectorReverse(ignition::math::Vector3d(
-                            contact.wrench(j).body_1_wrench().torque().x(),
-                            contact.wrench(j).body_1_wrench().torque().y(),
-                            contact.wrench(j).body_1_wrench().torque().z()));
+                            body_1_wrench.torque().x(),
+                            body_1_wrench.torque().y(),
+                            body_1_wrench.torque().z()));
+
+      total_wrench.force.x  += force.X();
+      total_wrench.force.y  += force.Y();
+      total_wrench.force.z  += force.Z();
+      total_wrench.torque.x += torque.X();
+      total_wrench.torque.y += torque.Y();
+      total_wrench.torque.z += torque.Z();
+
+      if (num_points == 0 || j % this->contact_point_stride_ != 0)
+        continue;
+      size_t point = j / this->contact_point_stride_;
 
       // set wrenches
-      geometry_msgs::Wrench wrench;
+      geometry_msgs::Wrench &wrench = state.wrenches[point];
       wrench.force.x  = force.X();
       wrench.force.y  = force.Y();
       wrench.force.z  = force.Z();
       wrench.torque.x = torque.X();
       wrench.torque.y = torque.Y();
       wrench.torque.z = torque.Z();
-      state.wrenches.push_back(wrench);
-
-      total_wrench.force.x  += wrench.force.x;
-      total_wrench.force.y  += wrench.force.y;
-      total_wrench.force.z  += wrench.force.z;
-      total_wrench.torque.x += wrench.torque.x;
-      total_wrench.torque.y += wrench.torque.y;
-      total_wrench.torque.z += wrench.torque.z;
 
       // transform contact positions into relative frame
       // set contact positions
@@ -295,11 +321,10 @@ void GazeboRosBumper::OnContact()
           ignition::math::Vector3d(contact.position(j).x(),
                                    contact.position(j).y(),
                                    contact.position(j).z()) - frame_pos);
-      geometry_msgs::Vector3 contact_position;
+      geometry_msgs::Vector3 &contact_position = state.contact_positions[point];
       contact_position.x = position.X();
       contact_position.y = position.Y();
       contact_position.z = position.Z();
-      state.contact_positions.push_back(contact_position);
 
       // rotate normal into user specified frame.
       // frame_rot is identity if world is used.
@@ -308,39 +333,20 @@ void GazeboRosBumper::OnContact()
                                    contact.normal(j).y(),
                                    contact.normal(j).z()));
       // set contact normals
-      geometry_msgs::Vector3 contact_normal;
+      geometry_msgs::Vector3 &contact_normal = state.contact_normals[point];
       contact_normal.x = normal.X();
       contact_normal.y = normal.Y();
       contact_normal.z = normal.Z();
-      state.contact_normals.push_back(contact_normal);
 
       // set contact depth, interpenetration
-      state.depths.push_back(contact.depth(j));
+      state.depths[point] = contact.depth(j);
     }
-
-    state.total_wrench = total_wrench;
-    this->contact_state_msg_.states.push_back(state);
   }
-#ifdef ENABLE_PROFILER
-  IGN_PROFILE_END();
-  IGN_PROFILE_BEGIN("publish");
-#endif
+  states.resize(num_states);
+  GAZEBO_ROS_PROFILE_END();
+  GAZEBO_ROS_PROFILE_BEGIN("publish");
   this->contact_pub_.publish(this->contact_state_msg_);
-#ifdef ENABLE_PROFILER
-  IGN_PROFILE_END();
-#endif
+  GAZEBO_ROS_PROFILE_END();
 }
 
-
-////////////////////////////////////////////////////////////////////////////////
-// Put laser data to the interface
-void GazeboRosBumper::ContactQueueThread()
-{
-  static const double timeout = 0.01;
-
-  while (this->rosnode_->ok())
-  {
-    this->contact_queue_.callAvailable(ros::WallDuration(timeout));
-  }
-}
 }
@@ -30,9 +30,7 @@
 #include <gazebo/sensors/CameraSensor.hh>
 #include <gazebo/sensors/SensorTypes.hh>
 
-#ifdef ENABLE_PROFILER
-#include <ignition/common/Profiler.hh>
-#endif
+#include <gazebo_ros/profiler.h>
 
 namespace gazebo
 {
@@ -54,6 +52,7 @@ GazeboRosCamera::~GazeboRosCamera()
 
 void GazeboRosCamera::Load(sensors::SensorPtr _parent, sdf::ElementPtr _sdf)
 {
+  GAZEBO_ROS_STARTUP_PHASE("load");
   // Make sure the ROS node for Gazebo has already been initialized
   if (!ros::isInitialized())
   {
@@ -80,9 +79,7 @@ void GazeboRosCamera::OnNewFrame(const unsigned char *_image,
     unsigned int _width, unsigned int _height, unsigned int _depth,
     const std::string &_format)
 {
-#ifdef ENABLE_PROFILER
-  IGN_PROFILE("GazeboRosCamera::OnNewFrame");
-#endif
+  GAZEBO_ROS_PROFILE("GazeboRosCamera::OnNewFrame");
 
 # if GAZEBO_MAJOR_VERSION >= 7
   common::Time sensor_update_time = this->parentSensor_->LastMeasurementTime();
@@ -90,45 +87,32 @@ void GazeboRosCamera::OnNewFrame(const unsigned char *_image,
   common::Time sensor_update_time = this->parentSensor_->GetLastMeasurementTime();
 # endif
 
-  if (!this->parentSensor->IsActive())
+  // the subscribers activate the sensor, see SensorConnect(); camera_info
+  // only subscribers get no image, PutCameraData() checks for that
+  if ((*this->sensor_connect_count_) > 0)
   {
-    if ((*this->image_connect_count_) > 0)
-      // do this first so there's chance for sensor to run once after activated
-      this->parentSensor->SetActive(true);
-  }
-  else
-  {
-    if ((*this->image_connect_count_) > 0)
+    if (sensor_update_time < this->last_update_time_)
     {
-      if (sensor_update_time < this->last_update_time_)
-      {
-          ROS_WARN_NAMED("camera", "Negative sensor update time difference detected.");
-          this->last_update_time_ = sensor_update_time;
-      }
+      ROS_WARN_NAMED("camera", "Negative sensor update time difference detected.");
+      this->last_update_time_ = sensor_update_time;
+    }
 
-      // OnNewFrame is triggered at the gazebo sensor <update_rate>
-      // while there is also a plugin <updateRate> that can throttle the
-      // rate down further (but then why not reduce the sensor rate?
-      // what is the use case?).
-      // Setting the <updateRate> to zero will make this plugin
-      // update at the gazebo sensor <update_rate>, update_period_ will be
-      // zero and the conditional always will be true.
-      if (sensor_update_time - this->last_update_time_ >= this->update_period_)
-      {
-#ifdef ENABLE_PROFILER
-        IGN_PROFILE_BEGIN("PutCameraData");
-#endif
-        this->PutCameraData(_image, sensor_update_time);
-#ifdef ENABLE_PROFILER
-        IGN_PROFILE_END();
-        IGN_PROFILE_BEGIN("PublishCameraInfo");
-#endif
-        this->PublishCameraInfo(sensor_update_time);
-#ifdef ENABLE_PROFILER
-        IGN_PROFILE_END();
-#endif
-        this->last_update_time_ = sensor_update_time;
-      }
+    // OnNewFrame is triggered at the gazebo sensor <update_rate>
+    // while there is also a plugin <updateRate> that can throttle the
+    // rate down further (but then why not reduce the sensor rate?
+    // what is the use case?).
+    // Setting the <updateRate> to zero will make this plugin
+    // update at the gazebo sensor <update_rate>, update_period_ will be
+    // zero and the conditional always will be true.
+    if (sensor_update_time - this->last_update_time_ >= this->update_period_)
+    {
+      GAZEBO_ROS_PROFILE_BEGIN("PutCameraData");
+      this->PutCameraData(_image, sensor_update_time);
+      GAZEBO_ROS_PROFILE_END();
+      GAZEBO_ROS_PROFILE_BEGIN("PublishCameraInfo");
+      this->PublishCameraInfo(sensor_update_time);
+      GAZEBO_ROS_PROFILE_END();
+      this->last_update_time_ = sensor_update_time;
     }
   }
 }
@@ -16,15 +16,19 @@
 */
 
 #include <string>
+#include <cstring>
 #include <algorithm>
 #include <assert.h>
 #include <boost/thread/thread.hpp>
 #include <boost/bind.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/make_shared.hpp>
 
 #include <tf/tf.h>
 #include <tf/transform_listener.h>
 #include <sensor_msgs/Image.h>
 #include <sensor_msgs/fill_image.h>
+#include <sensor_msgs/image_encodings.h>
 #include <image_transport/image_transport.h>
 #include <geometry_msgs/Point32.h>
 #include <sensor_msgs/ChannelFloat32.h>
@@ -42,6 +46,10 @@
 #include <gazebo/rendering/Distortion.hh>
 
 #include "gazebo_plugins/gazebo_ros_camera_utils.h"
+#include "gazebo_plugins/render_scheduler.h"
+#include "gazebo_plugins/image_format_kernels.h"
+#include "gazebo_ros/sensor_buffer_pool.h"
+#include "gazebo_ros/thread_policy.h"
 
 namespace gazebo
 {
@@ -56,6 +64,19 @@ GazeboRosCameraUtils::GazeboRosCameraUtils()
   this->skip_ = 0;
   this->format_ = "";
   this->initialized_ = false;
+  this->use_image_pool_ = false;
+  this->async_publish_ = false;
+  this->async_queue_depth_ = 2;
+  this->recorder_source_ = -1;
+  this->latency_topic_ = 0;
+  this->info_connect_count_ = 0;
+  this->compressed_connect_count_ = 0;
+  this->jpeg_quality_ = 80;
+  this->png_level_ = 3;
+  this->compression_threads_ = 0;
+  this->pyramid_levels_ = 0;
+  this->output_skip_ = 0;
+  this->output_conversion_ = CONVERT_NONE;
 }
 
 void GazeboRosCameraUtils::configCallback(
@@ -65,7 +86,10 @@ void GazeboRosCameraUtils::configCallback(
   {
     ROS_INFO_NAMED("camera_utils", "Reconfigure request for the gazebo ros camera_: %s. New rate: %.2f",
              this->camera_name_.c_str(), config.imager_rate);
-    this->parentSensor_->SetUpdateRate(config.imager_rate);
+    if (!RenderScheduler::Instance().SetUpdateRate(this->parentSensor_,
+                                                   config.imager_rate))
+      this->parentSensor_->SetUpdateRate(config.imager_rate);
+    this->InvalidateCameraInfo();
   }
 }
 
@@ -73,11 +97,33 @@ void GazeboRosCameraUtils::configCallback(
 // Destructor
 GazeboRosCameraUtils::~GazeboRosCameraUtils()
 {
+  if (this->deferred_load_task_)
+    this->deferred_load_task_->Wait();
   this->parentSensor_->SetActive(false);
+  if (this->async_publisher_)
+  {
+    ROS_DEBUG_NAMED("camera_utils", "Camera [%s] published asynchronously "
+      "%lu images, dropped %lu, max queue depth %lu",
+      this->camera_name_.c_str(), this->async_publisher_->Pushed(),
+      this->async_publisher_->Dropped(),
+      static_cast<unsigned long>(this->async_publisher_->MaxDepth()));
+    this->async_publisher_.reset();
+  }
+  if (this->compressed_publisher_)
+  {
+    ROS_DEBUG_NAMED("camera_utils", "Camera [%s] compressed %lu images, "
+      "dropped %lu, failed %lu", this->camera_name_.c_str(),
+      this->compressed_publisher_->Pushed(),
+      this->compressed_publisher_->Dropped(),
+      this->compressed_publisher_->Failed());
+    this->compressed_publisher_.reset();
+  }
+  if (this->recorder_source_ >= 0)
+    SensorRecorder::Instance().RemoveSource(this->recorder_source_);
   this->rosnode_->shutdown();
   this->camera_queue_.clear();
   this->camera_queue_.disable();
-  this->callback_queue_thread_.join();
+  this->camera_queue_.Stop();
   delete this->rosnode_;
 }
 
@@ -253,14 +299,99 @@ void GazeboRosCameraUtils::Load(sensors::SensorPtr _parent,
   else
     this->border_crop_ = this->sdf->Get<bool>("borderCrop");
 
+  if (!this->sdf->HasElement("useImagePool"))
+  {
+    ROS_DEBUG_NAMED("camera_utils", "Camera plugin missing <useImagePool>, defaults to false");
+    this->use_image_pool_ = false;
+  }
+  else
+    this->use_image_pool_ = this->sdf->Get<bool>("useImagePool");
+
+  if (!this->sdf->HasElement("asyncPublish"))
+  {
+    ROS_DEBUG_NAMED("camera_utils", "Camera plugin missing <asyncPublish>, defaults to false");
+    this->async_publish_ = false;
+  }
+  else
+    this->async_publish_ = this->sdf->Get<bool>("asyncPublish");
+
+  if (this->sdf->HasElement("asyncPublishQueueDepth"))
+    this->async_queue_depth_ = this->sdf->Get<int>("asyncPublishQueueDepth");
+
+  if (this->sdf->HasElement("outputEncoding"))
+    this->output_type_ = this->sdf->Get<std::string>("outputEncoding");
+
+  if (this->sdf->HasElement("compressedImageTopicName"))
+    this->compressed_topic_name_ = this->sdf->Get<std::string>("compressedImageTopicName");
+
+  if (!this->sdf->HasElement("compressionFormat"))
+    this->compression_format_ = "jpeg";
+  else
+    this->compression_format_ = this->sdf->Get<std::string>("compressionFormat");
+  if (this->compression_format_ != "jpeg" && this->compression_format_ != "png")
+  {
+    ROS_WARN_NAMED("camera_utils", "Unknown <compressionFormat> [%s], using jpeg",
+      this->compression_format_.c_str());
+    this->compression_format_ = "jpeg";
+  }
+
+  if (this->sdf->HasElement("jpegQuality"))
+    this->jpeg_quality_ = std::min(std::max(this->sdf->Get<int>("jpegQuality"), 1), 100);
+
+  if (this->sdf->HasElement("pngLevel"))
+    this->png_level_ = std::min(std::max(this->sdf->Get<int>("pngLevel"), 0), 9);
+
+  if (this->sdf->HasElement("compressionThreads"))
+    this->compression_threads_ = this->sdf->Get<int>("compressionThreads");
+
+  if (this->sdf->HasElement("pyramidLevels"))
+    this->pyramid_levels_ = std::min(std::max(this->sdf->Get<int>("pyramidLevels"), 0), 8);
+
+  // the crops are clamped to the image in Init(), once its size is known
+  this->rois_.clear();
+  if (this->sdf->HasElement("roi"))
+  {
+    for (sdf::ElementPtr elem = this->sdf->GetElement("roi"); elem;
+         elem = elem->GetNextElement("roi"))
+    {
+      RoiOutput roi;
+      if (!elem->HasElement("name"))
+      {
+        ROS_ERROR_NAMED("camera_utils", "Camera [%s] <roi> without <name>, "
+          "ignored", this->camera_name_.c_str());
+        continue;
+      }
+      roi.name_ = elem->GetElement("name")->Get<std::string>();
+      roi.x_offset_ = roi.y_offset_ = roi.width_ = roi.height_ = 0;
+      roi.connect_count_ = 0;
+      roi.pool_.reset(new ImageBufferPool());
+      if (elem->HasElement("xOffset"))
+        roi.x_offset_ = elem->GetElement("xOffset")->Get<unsigned int>();
+      if (elem->HasElement("yOffset"))
+        roi.y_offset_ = elem->GetElement("yOffset")->Get<unsigned int>();
+      if (elem->HasElement("width"))
+        roi.width_ = elem->GetElement("width")->Get<unsigned int>();
+      if (elem->HasElement("height"))
+        roi.height_ = elem->GetElement("height")->Get<unsigned int>();
+      this->rois_.push_back(roi);
+    }
+  }
+
+  // the frame handed off has to outlive PutCameraData()
+  if (this->async_publish_ || !this->compressed_topic_name_.empty())
+    this->use_image_pool_ = true;
+  if (this->use_image_pool_ && !this->image_pool_)
+    this->image_pool_.reset(new ImageBufferPool());
+
   // initialize shared_ptr members
   if (!this->image_connect_count_) this->image_connect_count_ = boost::shared_ptr<int>(new int(0));
   if (!this->image_connect_count_lock_) this->image_connect_count_lock_ = boost::shared_ptr<boost::mutex>(new boost::mutex);
+  if (!this->sensor_connect_count_) this->sensor_connect_count_ = boost::shared_ptr<int>(new int(0));
   if (!this->was_active_) this->was_active_ = boost::shared_ptr<bool>(new bool(false));
 
   // ros callback queue for processing subscription
-  this->deferred_load_thread_ = boost::thread(
-    boost::bind(&GazeboRosCameraUtils::LoadThread, this));
+  this->deferred_load_task_ = DeferredLoad::Instance().Run(
+    this->camera_name_, boost::bind(&GazeboRosCameraUtils::LoadThread, this));
 }
 
 event::ConnectionPtr GazeboRosCameraUtils::OnLoad(const boost::function<void()>& load_function)
@@ -323,6 +454,15 @@ void GazeboRosCameraUtils::LoadThread()
     boost::bind(&GazeboRosCameraUtils::ImageConnect, this),
     boost::bind(&GazeboRosCameraUtils::ImageDisconnect, this),
     ros::VoidPtr(), true);
+  this->latency_topic_ =
+    LatencyTracer::instance().topic(this->image_pub_.getTopic());
+
+  // render while the in-process recorder wants the images, even without
+  // subscribers
+  this->recorder_source_ = SensorRecorder::Instance().AddSource(
+    this->image_pub_.getTopic(),
+    boost::bind(&GazeboRosCameraUtils::ImageConnect, this),
+    boost::bind(&GazeboRosCameraUtils::ImageDisconnect, this));
 
   // camera info publish rate will be synchronized to image sensor
   // publish rates.
@@ -334,11 +474,74 @@ void GazeboRosCameraUtils::LoadThread()
   ros::AdvertiseOptions cio =
     ros::AdvertiseOptions::create<sensor_msgs::CameraInfo>(
     this->camera_info_topic_name_, 2,
-    boost::bind(&GazeboRosCameraUtils::ImageConnect, this),
-    boost::bind(&GazeboRosCameraUtils::ImageDisconnect, this),
+    boost::bind(&GazeboRosCameraUtils::InfoConnect, this),
+    boost::bind(&GazeboRosCameraUtils::InfoDisconnect, this),
     ros::VoidPtr(), &this->camera_queue_);
   this->camera_info_pub_ = this->rosnode_->advertise(cio);
 
+  if (this->async_publish_)
+  {
+    this->async_publisher_.reset(new AsyncImagePublisher(this->image_pub_,
+      static_cast<size_t>(std::max(this->async_queue_depth_, 1))));
+  }
+
+  if (!this->compressed_topic_name_.empty())
+  {
+    int threads = this->compression_threads_ > 0 ? this->compression_threads_ :
+      static_cast<int>(PubServicePool::instance().threadCount());
+    bool jpeg = this->compression_format_ == "jpeg";
+    ros::AdvertiseOptions cao =
+      ros::AdvertiseOptions::create<sensor_msgs::CompressedImage>(
+      this->compressed_topic_name_, 2,
+      boost::bind(&GazeboRosCameraUtils::CompressedConnect, this),
+      boost::bind(&GazeboRosCameraUtils::CompressedDisconnect, this),
+      ros::VoidPtr(), &this->camera_queue_);
+    this->compressed_pub_ = this->rosnode_->advertise(cao);
+    this->compressed_publisher_.reset(new CompressedImagePublisher(
+      this->compressed_pub_,
+      jpeg ? CompressedImagePublisher::JPEG : CompressedImagePublisher::PNG,
+      jpeg ? this->jpeg_quality_ : this->png_level_,
+      static_cast<size_t>(std::max(threads, 1))));
+  }
+
+  // level k is published as level<k>/image_raw with its own camera_info,
+  // which image_geometry scales by binning_x/y
+  this->pyramid_.resize(this->pyramid_levels_);
+  for (size_t k = 0; k < this->pyramid_.size(); ++k)
+  {
+    PyramidLevel &level = this->pyramid_[k];
+    std::string ns = "level" + boost::lexical_cast<std::string>(k + 1) + "/";
+    level.connect_count_ = 0;
+    level.pool_.reset(new ImageBufferPool());
+    level.image_pub_ = this->itnode_->advertise(ns + "image_raw", 2,
+      boost::bind(&GazeboRosCameraUtils::PyramidConnect, this, k),
+      boost::bind(&GazeboRosCameraUtils::PyramidDisconnect, this, k));
+    ros::AdvertiseOptions pio =
+      ros::AdvertiseOptions::create<sensor_msgs::CameraInfo>(
+      ns + "camera_info", 2,
+      boost::bind(&GazeboRosCameraUtils::PyramidConnect, this, k),
+      boost::bind(&GazeboRosCameraUtils::PyramidDisconnect, this, k),
+      ros::VoidPtr(), &this->camera_queue_);
+    level.camera_info_pub_ = this->rosnode_->advertise(pio);
+  }
+
+  // crop <name> is published as <name>/image_raw with its own camera_info
+  for (size_t k = 0; k < this->rois_.size(); ++k)
+  {
+    RoiOutput &roi = this->rois_[k];
+    std::string ns = roi.name_ + "/";
+    roi.image_pub_ = this->itnode_->advertise(ns + "image_raw", 2,
+      boost::bind(&GazeboRosCameraUtils::RoiConnect, this, k),
+      boost::bind(&GazeboRosCameraUtils::RoiDisconnect, this, k));
+    ros::AdvertiseOptions rio =
+      ros::AdvertiseOptions::create<sensor_msgs::CameraInfo>(
+      ns + "camera_info", 2,
+      boost::bind(&GazeboRosCameraUtils::RoiConnect, this, k),
+      boost::bind(&GazeboRosCameraUtils::RoiDisconnect, this, k),
+      ros::VoidPtr(), &this->camera_queue_);
+    roi.camera_info_pub_ = this->rosnode_->advertise(rio);
+  }
+
   /* disabling fov and rate setting for each camera
   ros::SubscribeOptions zoom_so =
     ros::SubscribeOptions::create<std_msgs::Float64>(
@@ -362,6 +565,7 @@ void GazeboRosCameraUtils::LoadThread()
           this->trigger_topic_name_, 1,
           boost::bind(&GazeboRosCameraUtils::TriggerCameraInternal, this, _1),
           ros::VoidPtr(), &this->camera_queue_);
+    GetSubscriptionHints(*this->rosnode_, this->sdf).apply(trigger_so);
     this->trigger_subscriber_ = this->rosnode_->subscribe(trigger_so);
   }
 
@@ -392,6 +596,7 @@ void GazeboRosCameraUtils::SetHFOV(const std_msgs::Float64::ConstPtr& hfov)
 #else
   this->camera_->SetHFOV(gazebo::math::Angle(hfov->data));
 #endif
+  this->InvalidateCameraInfo();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -399,7 +604,10 @@ void GazeboRosCameraUtils::SetHFOV(const std_msgs::Float64::ConstPtr& hfov)
 void GazeboRosCameraUtils::SetUpdateRate(
   const std_msgs::Float64::ConstPtr& update_rate)
 {
-  this->parentSensor_->SetUpdateRate(update_rate->data);
+  // a sensor staggered by the render scheduler keeps its rate there
+  if (!RenderScheduler::Instance().SetUpdateRate(this->parentSensor_,
+                                                 update_rate->data))
+    this->parentSensor_->SetUpdateRate(update_rate->data);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -407,28 +615,177 @@ void GazeboRosCameraUtils::SetUpdateRate(
 void GazeboRosCameraUtils::ImageConnect()
 {
   boost::mutex::scoped_lock lock(*this->image_connect_count_lock_);
+  (*this->image_connect_count_)++;
+  this->UpdateSensorActivation(1);
+}
+////////////////////////////////////////////////////////////////////////////////
+// Decrement count
+void GazeboRosCameraUtils::ImageDisconnect()
+{
+  boost::mutex::scoped_lock lock(*this->image_connect_count_lock_);
+  (*this->image_connect_count_)--;
+  this->UpdateSensorActivation(-1);
+}
 
-  // upon first connection, remember if camera was active.
-  if ((*this->image_connect_count_) == 0)
-    *this->was_active_ = this->parentSensor_->IsActive();
+////////////////////////////////////////////////////////////////////////////////
+// Increment count
+void GazeboRosCameraUtils::InfoConnect()
+{
+  boost::mutex::scoped_lock lock(*this->image_connect_count_lock_);
+  this->info_connect_count_++;
+  this->UpdateSensorActivation(1);
+}
 
-  (*this->image_connect_count_)++;
+////////////////////////////////////////////////////////////////////////////////
+// Decrement count
+void GazeboRosCameraUtils::InfoDisconnect()
+{
+  boost::mutex::scoped_lock lock(*this->image_connect_count_lock_);
+  this->info_connect_count_--;
+  this->UpdateSensorActivation(-1);
+}
 
-  this->parentSensor_->SetActive(true);
+////////////////////////////////////////////////////////////////////////////////
+// Increment count
+void GazeboRosCameraUtils::CompressedConnect()
+{
+  boost::mutex::scoped_lock lock(*this->image_connect_count_lock_);
+  this->compressed_connect_count_++;
+  this->UpdateSensorActivation(1);
 }
+
 ////////////////////////////////////////////////////////////////////////////////
 // Decrement count
-void GazeboRosCameraUtils::ImageDisconnect()
+void GazeboRosCameraUtils::CompressedDisconnect()
 {
   boost::mutex::scoped_lock lock(*this->image_connect_count_lock_);
+  this->compressed_connect_count_--;
+  this->UpdateSensorActivation(-1);
+}
 
-  (*this->image_connect_count_)--;
+////////////////////////////////////////////////////////////////////////////////
+// Increment count
+void GazeboRosCameraUtils::PyramidConnect(size_t _level)
+{
+  boost::mutex::scoped_lock lock(*this->image_connect_count_lock_);
+  this->pyramid_[_level].connect_count_++;
+  this->UpdateSensorActivation(1);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Decrement count
+void GazeboRosCameraUtils::PyramidDisconnect(size_t _level)
+{
+  boost::mutex::scoped_lock lock(*this->image_connect_count_lock_);
+  this->pyramid_[_level].connect_count_--;
+  this->UpdateSensorActivation(-1);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+size_t GazeboRosCameraUtils::PyramidDepth() const
+{
+  for (size_t k = this->pyramid_.size(); k > 0; --k)
+  {
+    if (this->pyramid_[k - 1].connect_count_ > 0)
+      return k;
+  }
+  return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Increment count
+void GazeboRosCameraUtils::RoiConnect(size_t _roi)
+{
+  boost::mutex::scoped_lock lock(*this->image_connect_count_lock_);
+  this->rois_[_roi].connect_count_++;
+  this->UpdateSensorActivation(1);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Decrement count
+void GazeboRosCameraUtils::RoiDisconnect(size_t _roi)
+{
+  boost::mutex::scoped_lock lock(*this->image_connect_count_lock_);
+  this->rois_[_roi].connect_count_--;
+  this->UpdateSensorActivation(-1);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool GazeboRosCameraUtils::RoiSubscribed() const
+{
+  for (size_t k = 0; k < this->rois_.size(); ++k)
+  {
+    if (this->rois_[k].connect_count_ > 0)
+      return true;
+  }
+  return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool GazeboRosCameraUtils::ImageSubscribed() const
+{
+  return (*this->image_connect_count_) > 0 ||
+         this->compressed_connect_count_ > 0 || this->PyramidDepth() > 0 ||
+         this->RoiSubscribed();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Count a subscriber of any topic fed by the sensor
+void GazeboRosCameraUtils::SensorConnect()
+{
+  boost::mutex::scoped_lock lock(*this->image_connect_count_lock_);
+  this->UpdateSensorActivation(1);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Uncount a subscriber of any topic fed by the sensor
+void GazeboRosCameraUtils::SensorDisconnect()
+{
+  boost::mutex::scoped_lock lock(*this->image_connect_count_lock_);
+  this->UpdateSensorActivation(-1);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Activate the sensor while anything is subscribed
+void GazeboRosCameraUtils::UpdateSensorActivation(int _delta)
+{
+  int &count = *this->sensor_connect_count_;
+
+  // upon first connection, remember if camera was active.
+  if (count == 0 && _delta > 0)
+  {
+    *this->was_active_ = this->parentSensor_->IsActive();
+    this->parentSensor_->SetActive(true);
+  }
+
+  count += _delta;
 
   // if there are no more subscribers, but camera was active to begin with,
   // leave it active.  Use case:  this could be a multicamera, where
   // each camera shares the same parentSensor_.
-  if ((*this->image_connect_count_) <= 0 && !*this->was_active_)
+  if (count <= 0 && _delta < 0 && !*this->was_active_)
     this->parentSensor_->SetActive(false);
+
+  // an idle sensor keeps no frame sized memory
+  if (count <= 0 && _delta < 0)
+  {
+    boost::mutex::scoped_lock lock(this->lock_);
+    this->ReleaseBuffers();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Give the image buffers back
+void GazeboRosCameraUtils::ReleaseBuffers()
+{
+  SensorBufferPool::instance().release(this->image_msg_.data);
+  this->last_image_.reset();
+  if (this->image_pool_)
+    this->image_pool_->Trim();
+  for (size_t k = 0; k < this->pyramid_.size(); ++k)
+    this->pyramid_[k].pool_->Trim();
+  for (size_t k = 0; k < this->rois_.size(); ++k)
+    this->rois_[k].pool_->Trim();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -500,6 +857,38 @@ void GazeboRosCameraUtils::Init()
     this->skip_ = 3;
   }
 
+  this->InitOutputConversion();
+  if (!this->pyramid_.empty() &&
+      sensor_msgs::image_encodings::isBayer(this->output_type_))
+  {
+    ROS_WARN_NAMED("camera_utils", "Camera [%s] can not downscale %s images, "
+      "its <pyramidLevels> stay empty", this->camera_name_.c_str(),
+      this->output_type_.c_str());
+  }
+
+  // an empty <width> or <height> extends the crop to the border, a bayer
+  // crop starts on an even pixel to keep the pattern of the encoding
+  const bool bayer = sensor_msgs::image_encodings::isBayer(this->output_type_);
+  for (size_t k = 0; k < this->rois_.size(); ++k)
+  {
+    RoiOutput &roi = this->rois_[k];
+    const uint32_t x = std::min(roi.x_offset_, this->width_ - 1);
+    const uint32_t y = std::min(roi.y_offset_, this->height_ - 1);
+    roi.x_offset_ = bayer ? x & ~1u : x;
+    roi.y_offset_ = bayer ? y & ~1u : y;
+    const uint32_t width = this->width_ - roi.x_offset_;
+    const uint32_t height = this->height_ - roi.y_offset_;
+    roi.width_ = roi.width_ > 0 ? std::min(roi.width_, width) : width;
+    roi.height_ = roi.height_ > 0 ? std::min(roi.height_, height) : height;
+    if (roi.x_offset_ != x || roi.y_offset_ != y)
+    {
+      ROS_WARN_NAMED("camera_utils", "Camera [%s] <roi> %s moved to the even "
+        "offset %u %u of the %s pattern", this->camera_name_.c_str(),
+        roi.name_.c_str(), roi.x_offset_, roi.y_offset_,
+        this->output_type_.c_str());
+    }
+  }
+
   /// Compute camera_ parameters if set to 0
   if (this->cx_prime_ == 0)
     this->cx_prime_ = (static_cast<double>(this->width_) + 1.0) /2.0;
@@ -618,10 +1007,7 @@ void GazeboRosCameraUtils::Init()
   camera_info_msg.P[11] = 0.0;
 
   this->camera_info_manager_->setCameraInfo(camera_info_msg);
-
-  // start custom queue for camera_
-  this->callback_queue_thread_ = boost::thread(
-    boost::bind(&GazeboRosCameraUtils::CameraQueueThread, this));
+  this->InvalidateCameraInfo();
 
   load_event_();
   this->initialized_ = true;
@@ -638,28 +1024,365 @@ void GazeboRosCameraUtils::PutCameraData(const unsigned char *_src,
 
 void GazeboRosCameraUtils::PutCameraData(const unsigned char *_src)
 {
+  // the rendering thread is gazebo's, its name is left alone
+  ThreadPolicy::instance().apply("render", "");
   if (!this->initialized_ || this->height_ <=0 || this->width_ <=0)
     return;
 
   /// don't bother if there are no subscribers
-  if ((*this->image_connect_count_) > 0)
+  if (this->ImageSubscribed())
   {
+    const ros::Time stamp(this->sensor_update_time_.sec,
+                          this->sensor_update_time_.nsec);
+    GAZEBO_ROS_LATENCY_TRACE(this->latency_topic_, SENSOR_CALLBACK, stamp);
     boost::mutex::scoped_lock lock(this->lock_);
 
+    // subscribers of the crops alone get no full frame converted
+    this->PutRois(_src, stamp);
+    if ((*this->image_connect_count_) <= 0 &&
+        this->compressed_connect_count_ <= 0 && this->PyramidDepth() == 0)
+      return;
+
+    if (this->image_pool_)
+    {
+      sensor_msgs::ImagePtr image = this->image_pool_->Acquire();
+      image->header.frame_id = this->frame_name_;
+      image->header.stamp = stamp;
+
+      // the only copy of the frame, a recycled image already has the right
+      // data size
+      this->FillOutputImage(*image, _src);
+      GAZEBO_ROS_LATENCY_TRACE(this->latency_topic_, CONVERTED, stamp);
+
+      this->last_image_ = image;
+      this->PutPyramid(*this->last_image_);
+      if (this->compressed_publisher_ && this->compressed_connect_count_ > 0)
+        this->compressed_publisher_->Push(this->last_image_);
+      if ((*this->image_connect_count_) <= 0)
+        return;
+      if (SensorRecorder::Instance().Recording())
+        SensorRecorder::Instance().Record(this->image_pub_.getTopic(),
+                                          this->last_image_);
+      if (this->async_publisher_)
+      {
+        GAZEBO_ROS_LATENCY_TRACE(this->latency_topic_, ENQUEUED, stamp);
+        this->async_publisher_->PushImage(this->last_image_);
+      }
+      else
+      {
+        this->image_pub_.publish(this->last_image_);
+        GAZEBO_ROS_LATENCY_TRACE(this->latency_topic_, PUBLISHED, stamp);
+      }
+      return;
+    }
+
     // copy data into image
     this->image_msg_.header.frame_id = this->frame_name_;
-    this->image_msg_.header.stamp.sec = this->sensor_update_time_.sec;
-    this->image_msg_.header.stamp.nsec = this->sensor_update_time_.nsec;
+    this->image_msg_.header.stamp = stamp;
 
-    // copy from src to image_msg_
-    fillImage(this->image_msg_, this->type_, this->height_, this->width_,
-        this->skip_*this->width_, reinterpret_cast<const void*>(_src));
+    // copy from src to image_msg_, its buffer from the pool after an idle
+    // period
+    const size_t skip = this->output_conversion_ == CONVERT_NONE ?
+      this->skip_ : this->output_skip_;
+    SensorBufferPool::instance().resize(this->image_msg_.data,
+      static_cast<size_t>(skip) * this->width_ * this->height_);
+    this->FillOutputImage(this->image_msg_, _src);
+    GAZEBO_ROS_LATENCY_TRACE(this->latency_topic_, CONVERTED, stamp);
+
+    this->PutPyramid(this->image_msg_);
+    if ((*this->image_connect_count_) <= 0)
+      return;
+
+    if (SensorRecorder::Instance().Recording())
+      SensorRecorder::Instance().Record(this->image_pub_.getTopic(),
+                                        this->image_msg_);
 
     // publish to ros
     this->image_pub_.publish(this->image_msg_);
+    GAZEBO_ROS_LATENCY_TRACE(this->latency_topic_, PUBLISHED, stamp);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Downscale the image for the subscribed pyramid levels
+void GazeboRosCameraUtils::PutPyramid(const sensor_msgs::Image &_image)
+{
+  namespace enc = sensor_msgs::image_encodings;
+
+  const size_t depth = this->PyramidDepth();
+  if (depth == 0 || enc::isBayer(_image.encoding))
+    return;
+
+  const int channels = enc::numChannels(_image.encoding);
+  const bool wide = enc::bitDepth(_image.encoding) == 16;
+  const size_t bytes = channels * (wide ? 2 : 1);
+
+  // levels nobody subscribed to above the deepest one are still computed,
+  // every level is made from the one above it
+  sensor_msgs::ImageConstPtr above;
+  const sensor_msgs::Image *src = &_image;
+  for (size_t k = 0; k < depth; ++k)
+  {
+    PyramidLevel &level = this->pyramid_[k];
+    const size_t cols = src->width / 2;
+    const size_t rows = src->height / 2;
+    if (cols == 0 || rows == 0)
+      return;
+
+    sensor_msgs::ImagePtr image = level.pool_->Acquire();
+    image->header = src->header;
+    image->encoding = src->encoding;
+    image->width = cols;
+    image->height = rows;
+    image->step = cols * bytes;
+    image->is_bigendian = src->is_bigendian;
+    image->data.resize(image->step * rows);
+
+    for (size_t j = 0; j < rows; ++j)
+    {
+      const uint8_t *row0 = &src->data[2 * j * src->step];
+      const uint8_t *row1 = row0 + src->step;
+      uint8_t *dst = &image->data[j * image->step];
+      if (wide)
+      {
+        image_kernels::Downsample2x2(reinterpret_cast<const uint16_t *>(row0),
+          reinterpret_cast<const uint16_t *>(row1),
+          reinterpret_cast<uint16_t *>(dst), cols, channels);
+      }
+      else
+      {
+        image_kernels::Downsample2x2(row0, row1, dst, cols, channels);
+      }
+    }
+
+    if (level.connect_count_ > 0)
+    {
+      sensor_msgs::CameraInfoPtr info;
+      {
+        boost::mutex::scoped_lock lock(this->camera_info_cache_lock_);
+        info = boost::make_shared<sensor_msgs::CameraInfo>(
+          *this->StampedCameraInfo());
+      }
+      info->binning_x = info->binning_y = 1u << (k + 1);
+      level.image_pub_.publish(image);
+      level.camera_info_pub_.publish(info);
+    }
+    above = image;
+    src = above.get();
   }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Crop the rendered frame for the subscribed rois
+void GazeboRosCameraUtils::PutRois(const unsigned char *_src,
+                                   const ros::Time &_stamp)
+{
+  const size_t src_step = this->skip_ * this->width_;
+  const std::string &encoding = this->output_conversion_ == CONVERT_NONE ?
+    this->type_ : this->output_type_;
+  const size_t skip = this->output_conversion_ == CONVERT_NONE ?
+    this->skip_ : this->output_skip_;
+
+  for (size_t k = 0; k < this->rois_.size(); ++k)
+  {
+    RoiOutput &roi = this->rois_[k];
+    if (roi.connect_count_ <= 0)
+      continue;
+
+    const size_t cols = roi.width_;
+    const size_t rows = roi.height_;
+    sensor_msgs::ImagePtr image = roi.pool_->Acquire();
+    image->header.frame_id = this->frame_name_;
+    image->header.stamp = _stamp;
+    image->encoding = encoding;
+    image->width = cols;
+    image->height = rows;
+    image->step = cols * skip;
+    image->is_bigendian = 0;
+    // a recycled image already has the right size, nothing is initialized
+    image->data.resize(image->step * rows);
+
+    // the only copy of the crop, straight from the rendered frame
+    const unsigned char *src =
+      _src + roi.y_offset_ * src_step + roi.x_offset_ * this->skip_;
+    for (size_t j = 0; j < rows; ++j, src += src_step)
+    {
+      uint8_t *dst = &image->data[j * image->step];
+      switch (this->output_conversion_)
+      {
+        case CONVERT_SWAP_RED_BLUE:
+          image_kernels::SwapRedBlue(src, dst, cols);
+          break;
+        case CONVERT_MONO:
+          image_kernels::ColorToMono(src, dst, cols,
+            this->type_ == sensor_msgs::image_encodings::BGR8);
+          break;
+        case CONVERT_BAYER:
+        {
+          // the offsets are even, see Init()
+          const int *channel = this->bayer_channel_[j % 2];
+          image_kernels::ColorToBayerRow(src, dst, cols, channel[0],
+                                         channel[1]);
+          break;
+        }
+        case CONVERT_EXPAND_16:
+          image_kernels::Expand8To16(src, reinterpret_cast<uint16_t *>(dst),
+                                     cols * this->skip_);
+          break;
+        default:
+          memcpy(dst, src, image->step);
+          break;
+      }
+    }
+
+    // image_geometry shifts the principal point by roi and rectifies into
+    // the crop
+    sensor_msgs::CameraInfoPtr info;
+    {
+      boost::mutex::scoped_lock lock(this->camera_info_cache_lock_);
+      info = boost::make_shared<sensor_msgs::CameraInfo>(
+        *this->StampedCameraInfo());
+    }
+    info->roi.x_offset = roi.x_offset_;
+    info->roi.y_offset = roi.y_offset_;
+    info->roi.width = cols;
+    info->roi.height = rows;
+    info->roi.do_rectify = true;
+    roi.image_pub_.publish(image);
+    roi.camera_info_pub_.publish(info);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void GazeboRosCameraUtils::InvalidateCameraInfo()
+{
+  boost::mutex::scoped_lock lock(this->camera_info_cache_lock_);
+  this->camera_info_cache_.reset();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Choose the conversion of the rendered format to <outputEncoding>
+void GazeboRosCameraUtils::InitOutputConversion()
+{
+  namespace enc = sensor_msgs::image_encodings;
+
+  this->output_conversion_ = CONVERT_NONE;
+  if (this->output_type_.empty() || this->output_type_ == this->type_)
+  {
+    this->output_type_ = this->type_;
+    this->output_skip_ = this->skip_;
+    return;
+  }
+
+  const bool rgb = this->type_ == enc::RGB8;
+  const bool bgr = this->type_ == enc::BGR8;
+  // byte of the source pixel holding each color
+  const int red = bgr ? 2 : 0;
+  const int blue = bgr ? 0 : 2;
+  const std::string &out = this->output_type_;
+
+  if ((rgb && out == enc::BGR8) || (bgr && out == enc::RGB8))
+  {
+    this->output_conversion_ = CONVERT_SWAP_RED_BLUE;
+    this->output_skip_ = 3;
+  }
+  else if ((rgb || bgr) && out == enc::MONO8)
+  {
+    this->output_conversion_ = CONVERT_MONO;
+    this->output_skip_ = 1;
+  }
+  else if ((rgb || bgr) && enc::isBayer(out) && enc::bitDepth(out) == 8)
+  {
+    // the 2x2 pattern of the encoding name, e.g. bayer_rggb8
+    const std::string pattern = out.substr(6, 4);
+    for (int k = 0; k < 4; ++k)
+    {
+      char color = pattern[k];
+      this->bayer_channel_[k / 2][k % 2] =
+        color == 'r' ? red : (color == 'b' ? blue : 1);
+    }
+    this->output_conversion_ = CONVERT_BAYER;
+    this->output_skip_ = 1;
+  }
+  else if ((this->type_ == enc::MONO8 && out == enc::MONO16) ||
+           (rgb && out == enc::RGB16) || (bgr && out == enc::BGR16))
+  {
+    this->output_conversion_ = CONVERT_EXPAND_16;
+    this->output_skip_ = 2 * this->skip_;
+  }
+  else
+  {
+    ROS_ERROR_NAMED("camera_utils", "Camera [%s] can not convert %s images "
+      "to <outputEncoding> %s, publishing %s", this->camera_name_.c_str(),
+      this->type_.c_str(), out.c_str(), this->type_.c_str());
+    this->output_type_ = this->type_;
+    this->output_skip_ = this->skip_;
+    return;
+  }
+
+  ROS_DEBUG_NAMED("camera_utils", "Camera [%s] converts %s to %s with the %s "
+    "image kernels", this->camera_name_.c_str(), this->type_.c_str(),
+    out.c_str(), image_kernels::Implementation());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Copy a frame into an image, converting its format on the way
+void GazeboRosCameraUtils::FillOutputImage(sensor_msgs::Image &_image,
+                                           const unsigned char *_src)
+{
+  if (this->output_conversion_ == CONVERT_NONE)
+  {
+    fillImage(_image, this->type_, this->height_, this->width_,
+        this->skip_*this->width_, reinterpret_cast<const void*>(_src));
+    return;
+  }
+
+  const size_t rows = this->height_;
+  const size_t cols = this->width_;
+  const size_t src_step = this->skip_ * cols;
+  _image.encoding = this->output_type_;
+  _image.height = rows;
+  _image.width = cols;
+  _image.step = this->output_skip_ * cols;
+  _image.is_bigendian = 0;
+  // a recycled image already has the right size, nothing is initialized
+  _image.data.resize(_image.step * rows);
+  uint8_t *dst = &_image.data[0];
+
+  switch (this->output_conversion_)
+  {
+    case CONVERT_SWAP_RED_BLUE:
+      image_kernels::SwapRedBlue(_src, dst, rows * cols);
+      break;
+    case CONVERT_MONO:
+      image_kernels::ColorToMono(_src, dst, rows * cols,
+        this->type_ == sensor_msgs::image_encodings::BGR8);
+      break;
+    case CONVERT_BAYER:
+      for (size_t j = 0; j < rows; ++j)
+      {
+        const int *channel = this->bayer_channel_[j % 2];
+        image_kernels::ColorToBayerRow(_src + j * src_step,
+          dst + j * _image.step, cols, channel[0], channel[1]);
+      }
+      break;
+    case CONVERT_EXPAND_16:
+      image_kernels::Expand8To16(_src, reinterpret_cast<uint16_t *>(dst),
+                                 rows * src_step);
+      break;
+    default:
+      break;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+const sensor_msgs::Image &GazeboRosCameraUtils::CurrentImage() const
+{
+  if (this->last_image_)
+    return *this->last_image_;
+  return this->image_msg_;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Put camera_ data to the interface
 void GazeboRosCameraUtils::PublishCameraInfo(common::Time &last_update_time)
@@ -676,7 +1399,8 @@ void GazeboRosCameraUtils::PublishCameraInfo()
   if (!this->initialized_ || this->height_ <=0 || this->width_ <=0)
     return;
 
-  if (this->camera_info_pub_.getNumSubscribers() > 0)
+  if (this->info_connect_count_ > 0 ||
+      SensorRecorder::Instance().Recording())
   {
     this->sensor_update_time_ = this->parentSensor_->LastMeasurementTime();
     if (this->sensor_update_time_ - this->last_info_update_time_ >= this->update_period_)
@@ -690,25 +1414,44 @@ void GazeboRosCameraUtils::PublishCameraInfo()
 void GazeboRosCameraUtils::PublishCameraInfo(
   ros::Publisher camera_info_publisher)
 {
-  sensor_msgs::CameraInfo camera_info_msg = camera_info_manager_->getCameraInfo();
+  boost::mutex::scoped_lock lock(this->camera_info_cache_lock_);
+  sensor_msgs::CameraInfoPtr info = this->StampedCameraInfo();
+  SensorRecorder::Instance().Record(camera_info_publisher, info);
 
-  camera_info_msg.header.stamp.sec = this->sensor_update_time_.sec;
-  camera_info_msg.header.stamp.nsec = this->sensor_update_time_.nsec;
+  if (this->async_publisher_)
+  {
+    this->async_publisher_->PushCameraInfo(camera_info_publisher, info);
+    return;
+  }
 
-  camera_info_publisher.publish(camera_info_msg);
+  camera_info_publisher.publish(info);
 }
 
-
 ////////////////////////////////////////////////////////////////////////////////
-// Put camera_ data to the interface
-void GazeboRosCameraUtils::CameraQueueThread()
+// Latest camera info, safe to stamp and hand out
+sensor_msgs::CameraInfoPtr GazeboRosCameraUtils::StampedCameraInfo()
 {
-  static const double timeout = 0.001;
-
-  while (this->rosnode_->ok())
+  // The set_camera_info service of camera_info_manager_ does not tell us
+  // when it changes the calibration, so re-read it once in a while too.
+  ros::WallTime now = ros::WallTime::now();
+  if (!this->camera_info_cache_ ||
+      (now - this->camera_info_cache_time_).toSec() > 1.0)
   {
-    /// take care of callback queue
-    this->camera_queue_.callAvailable(ros::WallDuration(timeout));
+    this->camera_info_cache_ = boost::make_shared<sensor_msgs::CameraInfo>(
+      this->camera_info_manager_->getCameraInfo());
+    this->camera_info_cache_time_ = now;
   }
+  else if (!this->camera_info_cache_.unique())
+  {
+    // an intra-process subscriber or the async publisher still holds the
+    // last one, never change a message that has been handed out
+    this->camera_info_cache_ = boost::make_shared<sensor_msgs::CameraInfo>(
+      *this->camera_info_cache_);
+  }
+
+  this->camera_info_cache_->header.stamp.sec = this->sensor_update_time_.sec;
+  this->camera_info_cache_->header.stamp.nsec = this->sensor_update_time_.nsec;
+  return this->camera_info_cache_;
 }
+
 }
@@ -0,0 +1,916 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <gazebo/rendering/Camera.hh>
+#include <gazebo/sensors/Sensor.hh>
+
+#include <sensor_msgs/image_encodings.h>
+#include <sensor_msgs/point_cloud2_iterator.h>
+
+#include <gazebo_plugins/gazebo_ros_depth_camera_utils.h>
+#include <gazebo_plugins/rvl_encoder.h>
+#include <gazebo_plugins/pub_service_pool.h>
+#include <gazebo_ros/sensor_buffer_pool.h>
+
+namespace gazebo
+{
+namespace
+{
+/// \brief Everything one depth frame is converted into, shared by the row
+/// chunks of PutDepthData().  NULL outputs are skipped.
+struct DepthPass
+{
+  const DepthRayLUT *lut;
+  const float *depth;
+  size_t cols;
+  float min;
+  float max;
+
+  float *depth_float;
+  uint16_t *depth_uint16;
+
+  float *disparity;
+  float baseline_focal;
+
+  uint8_t *cloud;
+  size_t point_step;
+  size_t rgb_offset;
+  const uint8_t *color;
+  int channels;
+
+  /// \brief The cloud only gets every stride-th pixel of the ROI,
+  /// one cloud_cols wide row slot per sampled row
+  bool reduced;
+  size_t roi_x;
+  size_t roi_y;
+  size_t roi_rows;
+  size_t stride;
+  size_t cloud_cols;
+  /// \brief Slopes of the sampled columns
+  const float *slope_x;
+  /// \brief Leave invalid points out, row_points gets the number of points
+  /// written to each row slot
+  bool drop_nan;
+  size_t *row_points;
+
+  float *points;
+
+  /// \brief RVL encoders of the row chunks of the compressed depth, by
+  /// first row, NULL if not subscribed
+  std::vector<std::pair<size_t, boost::shared_ptr<RvlEncoder> > > *rvl;
+
+  boost::mutex lock;
+  size_t invalid;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Last non zero millimetre depth before row _row, as
+/// depth_kernels::DepthToMillimeters would convert it, 0 if none.
+uint16_t LastMillimetersBefore(const DepthPass *_pass, size_t _row)
+{
+  for (size_t i = _row * _pass->cols; i > 0; --i)
+  {
+    float d = _pass->depth[i - 1];
+    if (!(d > _pass->min && d < _pass->max))
+      continue;
+    uint16_t mm = static_cast<uint16_t>(std::min(d * 1000.0f, 65535.0f));
+    if (mm)
+      return mm;
+  }
+  return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Fill the row slot _row of a reduced cloud from depth row _src_row.
+/// \return Number of invalid points written
+size_t ReducedCloudRow(DepthPass *_pass, size_t _row, size_t _src_row,
+                       float *_scratch, uint8_t *_color)
+{
+  const size_t n = _pass->cloud_cols;
+  const float *src = _pass->depth + _src_row * _pass->cols + _pass->roi_x;
+  const float slope_y = _pass->lut->Y()[_src_row];
+  const uint8_t *color_row = NULL;
+  if (_pass->color)
+    color_row = _pass->color +
+        (_src_row * _pass->cols + _pass->roi_x) * _pass->channels;
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+
+  float *x = _scratch;
+  float *y = x + n;
+  float *z = y + n;
+  size_t count = 0;
+  for (size_t k = 0; k < n; ++k)
+  {
+    float d = src[k * _pass->stride];
+    bool valid = d > _pass->min && d < _pass->max;
+    if (!valid && _pass->drop_nan)
+      continue;
+    d = valid ? d : nan;
+    x[count] = d * _pass->slope_x[k];
+    y[count] = d * slope_y;
+    z[count] = d;
+    if (color_row)
+    {
+      for (int c = 0; c < _pass->channels; ++c)
+      {
+        _color[count * _pass->channels + c] =
+            color_row[k * _pass->stride * _pass->channels + c];
+      }
+    }
+    ++count;
+  }
+
+  _pass->row_points[_row] = count;
+  return depth_kernels::PackXYZRGB(x, y, z, color_row ? _color : NULL,
+      _pass->channels, count, _pass->cloud + _row * n * _pass->point_step,
+      _pass->point_step, _pass->rgb_offset);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void DepthPassRows(DepthPass *_pass, size_t _begin, size_t _end)
+{
+  const size_t cols = _pass->cols;
+  const bool full_cloud = _pass->cloud && !_pass->reduced;
+  const bool unproject = full_cloud || _pass->points;
+  std::vector<float> scratch;
+  if (unproject)
+    scratch.resize(3 * cols);
+  std::vector<float> reduced_scratch;
+  std::vector<uint8_t> reduced_color;
+  // the compressed depth codes the 16UC1 rows, converted here unless the
+  // depth image is 16UC1 already
+  boost::shared_ptr<RvlEncoder> rvl;
+  std::vector<uint16_t> millimeters;
+  if (_pass->rvl)
+  {
+    rvl.reset(new RvlEncoder(LastMillimetersBefore(_pass, _begin)));
+    if (!_pass->depth_uint16)
+      millimeters.resize(cols);
+  }
+  if (_pass->cloud && _pass->reduced)
+  {
+    reduced_scratch.resize(3 * _pass->cloud_cols);
+    reduced_color.resize(_pass->cloud_cols * std::max(_pass->channels, 1));
+  }
+
+  size_t invalid = 0;
+  for (size_t j = _begin; j < _end; ++j)
+  {
+    const float *src = _pass->depth + j * cols;
+
+    if (_pass->depth_float)
+      depth_kernels::ClipDepth(src, _pass->depth_float + j * cols, cols,
+                               _pass->min, _pass->max);
+    else if (_pass->depth_uint16)
+      depth_kernels::DepthToMillimeters(src, _pass->depth_uint16 + j * cols,
+                                        cols, _pass->min, _pass->max);
+
+    if (rvl)
+    {
+      if (_pass->depth_uint16)
+        rvl->Encode(_pass->depth_uint16 + j * cols, cols);
+      else
+      {
+        depth_kernels::DepthToMillimeters(src, &millimeters[0], cols,
+                                          _pass->min, _pass->max);
+        rvl->Encode(&millimeters[0], cols);
+      }
+    }
+
+    if (_pass->disparity)
+      depth_kernels::DepthToDisparity(src, _pass->disparity + j * cols, cols,
+                                      _pass->baseline_focal,
+                                      _pass->min, _pass->max);
+
+    // rows of a reduced cloud are gathered straight from the depth row
+    if (_pass->cloud && _pass->reduced && j >= _pass->roi_y &&
+        j < _pass->roi_y + _pass->roi_rows &&
+        (j - _pass->roi_y) % _pass->stride == 0)
+    {
+      invalid += ReducedCloudRow(_pass, (j - _pass->roi_y) / _pass->stride, j,
+                                 &reduced_scratch[0], &reduced_color[0]);
+    }
+
+    if (!unproject)
+      continue;
+
+    float *x = &scratch[0];
+    float *y = x + cols;
+    float *z = y + cols;
+    // the clipped 32FC1 row is exactly z, reuse it
+    if (_pass->depth_float)
+      z = _pass->depth_float + j * cols;
+    else
+      depth_kernels::ClipDepth(src, z, cols, _pass->min, _pass->max);
+    _pass->lut->UnprojectRow(j, z, x, y);
+
+    if (full_cloud)
+    {
+      const uint8_t *color = NULL;
+      if (_pass->color)
+        color = _pass->color + j * cols * _pass->channels;
+      invalid += depth_kernels::PackXYZRGB(x, y, z, color, _pass->channels,
+          cols, _pass->cloud + j * cols * _pass->point_step,
+          _pass->point_step, _pass->rgb_offset);
+    }
+
+    if (_pass->points)
+    {
+      float *points = _pass->points + 4 * j * cols;
+      for (size_t i = 0; i < cols; ++i)
+      {
+        points[4 * i] = x[i];
+        points[4 * i + 1] = y[i];
+        points[4 * i + 2] = (z[i] == z[i]) ? z[i] : 0.0f;
+        points[4 * i + 3] = 0.0f;
+      }
+    }
+  }
+
+  boost::mutex::scoped_lock lock(_pass->lock);
+  _pass->invalid += invalid;
+  if (rvl)
+    _pass->rvl->push_back(std::make_pair(_begin, rvl));
+}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Constructor
+GazeboRosDepthCameraUtils::GazeboRosDepthCameraUtils()
+{
+  this->point_cloud_connect_count_ = 0;
+  this->depth_image_connect_count_ = 0;
+  this->point_cloud_latency_topic_ = 0;
+  this->depth_image_latency_topic_ = 0;
+  this->depth_info_connect_count_ = 0;
+  this->disparity_connect_count_ = 0;
+  this->compressed_depth_connect_count_ = 0;
+  this->compressed_point_cloud_connect_count_ = 0;
+  this->compressed_point_cloud_resolution_ = 0.001;
+  this->compressed_point_cloud_entropy_ = true;
+  this->compressed_point_cloud_threads_ = 0;
+  this->point_cloud_cutoff_ = 0.4;
+  this->point_cloud_cutoff_max_ = 5.0;
+  this->disparity_baseline_ = 0.075;
+  this->use_depth_image_16UC1_format_ = false;
+  this->point_cloud_stride_ = 1;
+  this->point_cloud_roi_x_ = 0;
+  this->point_cloud_roi_y_ = 0;
+  this->point_cloud_roi_width_ = 0;
+  this->point_cloud_roi_height_ = 0;
+  this->point_cloud_drop_nan_ = false;
+  this->last_depth_image_camera_info_update_time_ = common::Time(0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Destructor
+GazeboRosDepthCameraUtils::~GazeboRosDepthCameraUtils()
+{
+  if (this->compressed_point_cloud_publisher_)
+  {
+    ROS_DEBUG_NAMED("depth_camera", "Camera [%s] compressed %lu point "
+      "clouds, dropped %lu, failed %lu", this->camera_name_.c_str(),
+      this->compressed_point_cloud_publisher_->Pushed(),
+      this->compressed_point_cloud_publisher_->Dropped(),
+      this->compressed_point_cloud_publisher_->Failed());
+    this->compressed_point_cloud_publisher_.reset();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Load the depth outputs' parameters
+void GazeboRosDepthCameraUtils::LoadDepth(sdf::ElementPtr _sdf,
+                                          double _cutoff_max)
+{
+  // using a different default
+  if (!_sdf->HasElement("imageTopicName"))
+    this->image_topic_name_ = "ir/image_raw";
+  if (!_sdf->HasElement("cameraInfoTopicName"))
+    this->camera_info_topic_name_ = "ir/camera_info";
+
+  // point cloud stuff
+  if (!_sdf->HasElement("pointCloudTopicName"))
+    this->point_cloud_topic_name_ = "points";
+  else
+    this->point_cloud_topic_name_ = _sdf->GetElement("pointCloudTopicName")->Get<std::string>();
+
+  // depth image stuff
+  if (!_sdf->HasElement("depthImageTopicName"))
+    this->depth_image_topic_name_ = "depth/image_raw";
+  else
+    this->depth_image_topic_name_ = _sdf->GetElement("depthImageTopicName")->Get<std::string>();
+
+  if (!_sdf->HasElement("depthImageCameraInfoTopicName"))
+    this->depth_image_camera_info_topic_name_ = "depth/camera_info";
+  else
+    this->depth_image_camera_info_topic_name_ = _sdf->GetElement("depthImageCameraInfoTopicName")->Get<std::string>();
+
+  // disparity stuff
+  if (!_sdf->HasElement("disparityTopicName"))
+    this->disparity_topic_name_ = "depth/disparity";
+  else
+    this->disparity_topic_name_ = _sdf->GetElement("disparityTopicName")->Get<std::string>();
+
+  // RVL compressed depth, off unless a topic is given
+  if (_sdf->HasElement("compressedDepthTopicName"))
+    this->compressed_depth_topic_name_ = _sdf->GetElement("compressedDepthTopicName")->Get<std::string>();
+
+  // compressed point cloud, off unless a topic is given
+  if (_sdf->HasElement("compressedPointCloudTopicName"))
+    this->compressed_point_cloud_topic_name_ = _sdf->GetElement("compressedPointCloudTopicName")->Get<std::string>();
+
+  if (!_sdf->HasElement("compressedPointCloudResolution"))
+    this->compressed_point_cloud_resolution_ = 0.001;
+  else
+    this->compressed_point_cloud_resolution_ = _sdf->GetElement("compressedPointCloudResolution")->Get<double>();
+
+  if (!_sdf->HasElement("compressedPointCloudEntropyCoding"))
+    this->compressed_point_cloud_entropy_ = true;
+  else
+    this->compressed_point_cloud_entropy_ = _sdf->GetElement("compressedPointCloudEntropyCoding")->Get<bool>();
+
+  if (!_sdf->HasElement("compressedPointCloudThreads"))
+    this->compressed_point_cloud_threads_ = 0;
+  else
+    this->compressed_point_cloud_threads_ = _sdf->GetElement("compressedPointCloudThreads")->Get<int>();
+
+  if (!_sdf->HasElement("disparityBaseline"))
+    this->disparity_baseline_ = 0.075;
+  else
+    this->disparity_baseline_ = _sdf->GetElement("disparityBaseline")->Get<double>();
+
+  if (!_sdf->HasElement("pointCloudCutoff"))
+    this->point_cloud_cutoff_ = 0.4;
+  else
+    this->point_cloud_cutoff_ = _sdf->GetElement("pointCloudCutoff")->Get<double>();
+  if (!_sdf->HasElement("pointCloudCutoffMax"))
+    this->point_cloud_cutoff_max_ = _cutoff_max;
+  else
+    this->point_cloud_cutoff_max_ = _sdf->GetElement("pointCloudCutoffMax")->Get<double>();
+
+  // allow optional publication of depth images in 16UC1 instead of 32FC1
+  if (!_sdf->HasElement("useDepth16UC1Format"))
+    this->use_depth_image_16UC1_format_ = false;
+  else
+    this->use_depth_image_16UC1_format_ = _sdf->GetElement("useDepth16UC1Format")->Get<bool>();
+
+  // reduced point clouds: every stride-th pixel of a rectangle, a width or
+  // height of 0 extends it to the image border
+  if (!_sdf->HasElement("pointCloudStride"))
+    this->point_cloud_stride_ = 1;
+  else
+    this->point_cloud_stride_ = std::max(1, _sdf->GetElement("pointCloudStride")->Get<int>());
+
+  if (!_sdf->HasElement("pointCloudRoiX"))
+    this->point_cloud_roi_x_ = 0;
+  else
+    this->point_cloud_roi_x_ = _sdf->GetElement("pointCloudRoiX")->Get<unsigned int>();
+
+  if (!_sdf->HasElement("pointCloudRoiY"))
+    this->point_cloud_roi_y_ = 0;
+  else
+    this->point_cloud_roi_y_ = _sdf->GetElement("pointCloudRoiY")->Get<unsigned int>();
+
+  if (!_sdf->HasElement("pointCloudRoiWidth"))
+    this->point_cloud_roi_width_ = 0;
+  else
+    this->point_cloud_roi_width_ = _sdf->GetElement("pointCloudRoiWidth")->Get<unsigned int>();
+
+  if (!_sdf->HasElement("pointCloudRoiHeight"))
+    this->point_cloud_roi_height_ = 0;
+  else
+    this->point_cloud_roi_height_ = _sdf->GetElement("pointCloudRoiHeight")->Get<unsigned int>();
+
+  // publish only the valid points, as an unorganized cloud
+  if (!_sdf->HasElement("pointCloudDropNaN"))
+    this->point_cloud_drop_nan_ = false;
+  else
+    this->point_cloud_drop_nan_ = _sdf->GetElement("pointCloudDropNaN")->Get<bool>();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Advertise the depth outputs
+void GazeboRosDepthCameraUtils::AdvertiseDepth()
+{
+  ros::AdvertiseOptions point_cloud_ao =
+    ros::AdvertiseOptions::create<sensor_msgs::PointCloud2 >(
+      this->point_cloud_topic_name_,1,
+      boost::bind( &GazeboRosDepthCameraUtils::PointCloudConnect,this),
+      boost::bind( &GazeboRosDepthCameraUtils::PointCloudDisconnect,this),
+      ros::VoidPtr(), &this->camera_queue_);
+  this->point_cloud_pub_ = this->rosnode_->advertise(point_cloud_ao);
+  this->point_cloud_latency_topic_ =
+    LatencyTracer::instance().topic(this->point_cloud_pub_.getTopic());
+
+  ros::AdvertiseOptions depth_image_ao =
+    ros::AdvertiseOptions::create< sensor_msgs::Image >(
+      this->depth_image_topic_name_,1,
+      boost::bind( &GazeboRosDepthCameraUtils::DepthImageConnect,this),
+      boost::bind( &GazeboRosDepthCameraUtils::DepthImageDisconnect,this),
+      ros::VoidPtr(), &this->camera_queue_);
+  this->depth_image_pub_ = this->rosnode_->advertise(depth_image_ao);
+  this->depth_image_latency_topic_ =
+    LatencyTracer::instance().topic(this->depth_image_pub_.getTopic());
+
+  ros::AdvertiseOptions depth_image_camera_info_ao =
+    ros::AdvertiseOptions::create<sensor_msgs::CameraInfo>(
+        this->depth_image_camera_info_topic_name_,1,
+        boost::bind( &GazeboRosDepthCameraUtils::DepthInfoConnect,this),
+        boost::bind( &GazeboRosDepthCameraUtils::DepthInfoDisconnect,this),
+        ros::VoidPtr(), &this->camera_queue_);
+  this->depth_image_camera_info_pub_ = this->rosnode_->advertise(depth_image_camera_info_ao);
+
+  ros::AdvertiseOptions disparity_ao =
+    ros::AdvertiseOptions::create<stereo_msgs::DisparityImage>(
+      this->disparity_topic_name_,1,
+      boost::bind( &GazeboRosDepthCameraUtils::DisparityConnect,this),
+      boost::bind( &GazeboRosDepthCameraUtils::DisparityDisconnect,this),
+      ros::VoidPtr(), &this->camera_queue_);
+  this->disparity_pub_ = this->rosnode_->advertise(disparity_ao);
+
+  if (!this->compressed_depth_topic_name_.empty())
+  {
+    ros::AdvertiseOptions compressed_depth_ao =
+      ros::AdvertiseOptions::create<sensor_msgs::CompressedImage>(
+        this->compressed_depth_topic_name_,1,
+        boost::bind( &GazeboRosDepthCameraUtils::CompressedDepthConnect,this),
+        boost::bind( &GazeboRosDepthCameraUtils::CompressedDepthDisconnect,this),
+        ros::VoidPtr(), &this->camera_queue_);
+    this->compressed_depth_pub_ = this->rosnode_->advertise(compressed_depth_ao);
+  }
+
+  if (!this->compressed_point_cloud_topic_name_.empty())
+  {
+    int threads = this->compressed_point_cloud_threads_ > 0 ?
+      this->compressed_point_cloud_threads_ :
+      static_cast<int>(PubServicePool::instance().threadCount());
+    ros::AdvertiseOptions compressed_point_cloud_ao =
+      ros::AdvertiseOptions::create<gazebo_msgs::CompressedPointCloud>(
+        this->compressed_point_cloud_topic_name_,2,
+        boost::bind( &GazeboRosDepthCameraUtils::CompressedPointCloudConnect,this),
+        boost::bind( &GazeboRosDepthCameraUtils::CompressedPointCloudDisconnect,this),
+        ros::VoidPtr(), &this->camera_queue_);
+    this->compressed_point_cloud_pub_ = this->rosnode_->advertise(compressed_point_cloud_ao);
+    this->compressed_point_cloud_publisher_.reset(new CompressedPointCloudPublisher(
+      this->compressed_point_cloud_pub_, this->compressed_point_cloud_resolution_,
+      this->compressed_point_cloud_entropy_,
+      static_cast<size_t>(std::max(threads, 1))));
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Increment count
+void GazeboRosDepthCameraUtils::PointCloudConnect()
+{
+  this->point_cloud_connect_count_++;
+  this->SensorConnect();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Decrement count
+void GazeboRosDepthCameraUtils::PointCloudDisconnect()
+{
+  this->point_cloud_connect_count_--;
+  this->SensorDisconnect();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Increment count
+void GazeboRosDepthCameraUtils::DepthImageConnect()
+{
+  this->depth_image_connect_count_++;
+  this->SensorConnect();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Decrement count
+void GazeboRosDepthCameraUtils::DepthImageDisconnect()
+{
+  this->depth_image_connect_count_--;
+  this->SensorDisconnect();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Increment count
+void GazeboRosDepthCameraUtils::DepthInfoConnect()
+{
+  this->depth_info_connect_count_++;
+  this->SensorConnect();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Decrement count
+void GazeboRosDepthCameraUtils::DepthInfoDisconnect()
+{
+  this->depth_info_connect_count_--;
+  this->SensorDisconnect();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Increment count
+void GazeboRosDepthCameraUtils::DisparityConnect()
+{
+  this->disparity_connect_count_++;
+  this->SensorConnect();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Decrement count
+void GazeboRosDepthCameraUtils::DisparityDisconnect()
+{
+  this->disparity_connect_count_--;
+  this->SensorDisconnect();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Increment count
+void GazeboRosDepthCameraUtils::CompressedDepthConnect()
+{
+  this->compressed_depth_connect_count_++;
+  this->SensorConnect();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Decrement count
+void GazeboRosDepthCameraUtils::CompressedDepthDisconnect()
+{
+  this->compressed_depth_connect_count_--;
+  this->SensorDisconnect();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Increment count
+void GazeboRosDepthCameraUtils::CompressedPointCloudConnect()
+{
+  this->compressed_point_cloud_connect_count_++;
+  this->SensorConnect();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Decrement count
+void GazeboRosDepthCameraUtils::CompressedPointCloudDisconnect()
+{
+  this->compressed_point_cloud_connect_count_--;
+  this->SensorDisconnect();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool GazeboRosDepthCameraUtils::DepthSubscribed() const
+{
+  return this->PointCloudSubscribed() ||
+         this->depth_image_connect_count_ > 0 ||
+         this->disparity_connect_count_ > 0 ||
+         this->compressed_depth_connect_count_ > 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool GazeboRosDepthCameraUtils::PointCloudSubscribed() const
+{
+  return this->point_cloud_connect_count_ > 0 ||
+         this->compressed_point_cloud_connect_count_ > 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void GazeboRosDepthCameraUtils::PublishPointCloud()
+{
+  if (this->point_cloud_connect_count_ > 0)
+    this->point_cloud_pub_.publish(this->point_cloud_msg_);
+  // copied into the publisher, point_cloud_msg_ is reused for the next frame
+  if (this->compressed_point_cloud_publisher_ &&
+      this->compressed_point_cloud_connect_count_ > 0)
+    this->compressed_point_cloud_publisher_->Push(this->point_cloud_msg_);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Give the depth buffers back
+void GazeboRosDepthCameraUtils::ReleaseBuffers()
+{
+  SensorBufferPool &pool = SensorBufferPool::instance();
+  pool.release(this->point_cloud_msg_.data);
+  pool.release(this->depth_image_msg_.data);
+  pool.release(this->disparity_msg_.image.data);
+  pool.release(this->compressed_depth_msg_.data);
+  std::vector<float>().swap(this->points_);
+  GazeboRosCameraUtils::ReleaseBuffers();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool GazeboRosDepthCameraUtils::KeepPoints()
+{
+  return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Convert a depth frame into the subscribed outputs and publish them
+void GazeboRosDepthCameraUtils::PutDepthData(const float *_src)
+{
+  const bool cloud = this->PointCloudSubscribed();
+  const bool depth = this->depth_image_connect_count_ > 0;
+  const bool disparity = this->disparity_connect_count_ > 0;
+  const bool compressed = this->compressed_depth_connect_count_ > 0;
+  const bool points = this->KeepPoints();
+  if (!cloud && !depth && !disparity && !compressed && !points)
+    return;
+
+  boost::mutex::scoped_lock lock(this->lock_);
+
+  const uint32_t rows = this->height_;
+  const uint32_t cols = this->width_;
+  if (rows == 0 || cols == 0)
+    return;
+
+  const ros::Time stamp(this->depth_sensor_update_time_.sec,
+                        this->depth_sensor_update_time_.nsec);
+  if (cloud)
+    GAZEBO_ROS_LATENCY_TRACE(this->point_cloud_latency_topic_, SENSOR_CALLBACK, stamp);
+  if (depth)
+    GAZEBO_ROS_LATENCY_TRACE(this->depth_image_latency_topic_, SENSOR_CALLBACK, stamp);
+
+  this->ray_lut_.Update(rows, cols, this->camera_->HFOV().Radian());
+
+  DepthPass pass;
+  pass.lut = &this->ray_lut_;
+  pass.depth = _src;
+  pass.cols = cols;
+  pass.min = this->point_cloud_cutoff_;
+  pass.max = this->point_cloud_cutoff_max_;
+  pass.depth_float = NULL;
+  pass.depth_uint16 = NULL;
+  pass.disparity = NULL;
+  pass.baseline_focal = 0.0f;
+  pass.cloud = NULL;
+  pass.point_step = 0;
+  pass.rgb_offset = 0;
+  pass.color = NULL;
+  pass.channels = 0;
+  pass.reduced = false;
+  pass.roi_x = 0;
+  pass.roi_y = 0;
+  pass.roi_rows = rows;
+  pass.stride = 1;
+  pass.cloud_cols = cols;
+  pass.slope_x = NULL;
+  pass.drop_nan = false;
+  pass.row_points = NULL;
+  pass.points = NULL;
+  pass.rvl = NULL;
+  pass.invalid = 0;
+
+  if (depth)
+  {
+    sensor_msgs::Image &image_msg = this->depth_image_msg_;
+    image_msg.header.frame_id = this->frame_name_;
+    image_msg.header.stamp.sec = this->depth_sensor_update_time_.sec;
+    image_msg.header.stamp.nsec = this->depth_sensor_update_time_.nsec;
+    image_msg.height = rows;
+    image_msg.width = cols;
+    image_msg.is_bigendian = 0;
+    // deal with the differences in between 32FC1 & 16UC1
+    // http://www.ros.org/reps/rep-0118.html#id4
+    if (!this->use_depth_image_16UC1_format_)
+    {
+      image_msg.encoding = sensor_msgs::image_encodings::TYPE_32FC1;
+      image_msg.step = sizeof(float) * cols;
+      SensorBufferPool::instance().resize(image_msg.data, rows * cols * sizeof(float));
+      pass.depth_float = reinterpret_cast<float*>(&(image_msg.data[0]));
+    }
+    else
+    {
+      image_msg.encoding = sensor_msgs::image_encodings::TYPE_16UC1;
+      image_msg.step = sizeof(uint16_t) * cols;
+      SensorBufferPool::instance().resize(image_msg.data, rows * cols * sizeof(uint16_t));
+      pass.depth_uint16 = reinterpret_cast<uint16_t*>(&(image_msg.data[0]));
+    }
+  }
+
+  if (disparity)
+  {
+    stereo_msgs::DisparityImage &disp_msg = this->disparity_msg_;
+    disp_msg.header.frame_id = this->frame_name_;
+    disp_msg.header.stamp.sec = this->depth_sensor_update_time_.sec;
+    disp_msg.header.stamp.nsec = this->depth_sensor_update_time_.nsec;
+    disp_msg.image.header = disp_msg.header;
+    disp_msg.image.encoding = sensor_msgs::image_encodings::TYPE_32FC1;
+    disp_msg.image.height = rows;
+    disp_msg.image.width = cols;
+    disp_msg.image.is_bigendian = 0;
+    disp_msg.image.step = sizeof(float) * cols;
+    SensorBufferPool::instance().resize(disp_msg.image.data, rows * cols * sizeof(float));
+    disp_msg.f = this->focal_length_;
+    disp_msg.T = this->disparity_baseline_;
+    disp_msg.valid_window.x_offset = 0;
+    disp_msg.valid_window.y_offset = 0;
+    disp_msg.valid_window.width = cols;
+    disp_msg.valid_window.height = rows;
+    // disparities of the valid depth range
+    double baseline_focal = disp_msg.f * disp_msg.T;
+    disp_msg.min_disparity = std::isfinite(this->point_cloud_cutoff_max_) ?
+        baseline_focal / this->point_cloud_cutoff_max_ : 0.0;
+    disp_msg.max_disparity = this->point_cloud_cutoff_ > 0 ?
+        baseline_focal / this->point_cloud_cutoff_ :
+        std::numeric_limits<float>::infinity();
+    disp_msg.delta_d = 0.125;
+    pass.disparity = reinterpret_cast<float*>(&(disp_msg.image.data[0]));
+    pass.baseline_focal = baseline_focal;
+  }
+
+  if (cloud)
+  {
+    sensor_msgs::PointCloud2 &cloud_msg = this->point_cloud_msg_;
+    cloud_msg.header.frame_id = this->frame_name_;
+    cloud_msg.header.stamp.sec = this->depth_sensor_update_time_.sec;
+    cloud_msg.header.stamp.nsec = this->depth_sensor_update_time_.nsec;
+
+    // region of interest, clamped to the image
+    const uint32_t roi_x = std::min(this->point_cloud_roi_x_, cols - 1);
+    const uint32_t roi_y = std::min(this->point_cloud_roi_y_, rows - 1);
+    uint32_t roi_width = cols - roi_x;
+    if (this->point_cloud_roi_width_ > 0)
+      roi_width = std::min(this->point_cloud_roi_width_, roi_width);
+    uint32_t roi_height = rows - roi_y;
+    if (this->point_cloud_roi_height_ > 0)
+      roi_height = std::min(this->point_cloud_roi_height_, roi_height);
+    if (!this->lod_decimation_)
+      this->lod_decimation_ =
+        SensorLod::Instance().Decimation(this->parentSensor_->ScopedName());
+    const uint32_t stride = this->point_cloud_stride_ *
+      std::max(this->lod_decimation_->load(std::memory_order_relaxed), 1u);
+    const uint32_t cloud_rows = (roi_height + stride - 1) / stride;
+    const uint32_t cloud_cols = (roi_width + stride - 1) / stride;
+
+    pass.reduced = stride > 1 || roi_width != cols || roi_height != rows ||
+                   this->point_cloud_drop_nan_;
+    if (pass.reduced)
+    {
+      pass.roi_x = roi_x;
+      pass.roi_y = roi_y;
+      pass.roi_rows = roi_height;
+      pass.stride = stride;
+      pass.cloud_cols = cloud_cols;
+      pass.drop_nan = this->point_cloud_drop_nan_;
+      this->cloud_slope_x_.resize(cloud_cols);
+      for (uint32_t k = 0; k < cloud_cols; ++k)
+        this->cloud_slope_x_[k] = this->ray_lut_.X()[roi_x + k * stride];
+      pass.slope_x = &this->cloud_slope_x_[0];
+      this->cloud_row_points_.resize(cloud_rows);
+      pass.row_points = &this->cloud_row_points_[0];
+    }
+
+    sensor_msgs::PointCloud2Modifier pcd_modifier(cloud_msg);
+    pcd_modifier.setPointCloud2FieldsByString(2, "xyz", "rgb");
+    SensorBufferPool::instance().resize(cloud_msg.data,
+      static_cast<size_t>(cloud_rows) * cloud_cols * cloud_msg.point_step);
+    // convert to flat array shape, we need to reconvert later
+    pcd_modifier.resize(cloud_rows * cloud_cols);
+    // reconvert to original height and width after the flat reshape
+    cloud_msg.height = cloud_rows;
+    cloud_msg.width = cloud_cols;
+    cloud_msg.row_step = cloud_msg.point_step * cloud_msg.width;
+
+    pass.cloud = &(cloud_msg.data[0]);
+    pass.point_step = cloud_msg.point_step;
+    // fields are x, y, z, rgb as set above
+    pass.rgb_offset = cloud_msg.fields[3].offset;
+
+    // put image color data for each point
+    const sensor_msgs::Image &image = this->CurrentImage();
+    if (image.data.size() == rows * cols * 3)
+    {
+      // color
+      pass.color = &(image.data[0]);
+      pass.channels = 3;
+    }
+    else if (image.data.size() == rows * cols)
+    {
+      // mono (or bayer?  @todo; fix for bayer)
+      pass.color = &(image.data[0]);
+      pass.channels = 1;
+    }
+  }
+
+  if (points)
+  {
+    this->points_.resize(4 * rows * cols);
+    pass.points = &this->points_[0];
+  }
+
+  std::vector<std::pair<size_t, boost::shared_ptr<RvlEncoder> > > rvl;
+  if (compressed)
+    pass.rvl = &rvl;
+
+  // in optical frame
+  // hardcoded rotation rpy(-M_PI/2, 0, -M_PI/2) is built-in
+  // to urdf, where the *_optical_frame should have above relative
+  // rotation from the physical camera *_frame
+  depth_kernels::ParallelRows(rows, cols,
+      boost::bind(&DepthPassRows, &pass, _1, _2));
+
+  if (cloud)
+  {
+    sensor_msgs::PointCloud2 &cloud_msg = this->point_cloud_msg_;
+    if (pass.drop_nan)
+    {
+      // close the gaps the dropped points left at the end of each row slot
+      const size_t slot = pass.cloud_cols * cloud_msg.point_step;
+      size_t kept = 0;
+      for (size_t r = 0; r < this->cloud_row_points_.size(); ++r)
+      {
+        if (kept * cloud_msg.point_step != r * slot)
+        {
+          memmove(&cloud_msg.data[kept * cloud_msg.point_step],
+                  &cloud_msg.data[r * slot],
+                  this->cloud_row_points_[r] * cloud_msg.point_step);
+        }
+        kept += this->cloud_row_points_[r];
+      }
+      cloud_msg.data.resize(kept * cloud_msg.point_step);
+      cloud_msg.height = 1;
+      cloud_msg.width = kept;
+      cloud_msg.row_step = cloud_msg.point_step * cloud_msg.width;
+    }
+    cloud_msg.is_dense = (pass.invalid == 0);
+    GAZEBO_ROS_LATENCY_TRACE(this->point_cloud_latency_topic_, CONVERTED, stamp);
+    this->PublishPointCloud();
+    GAZEBO_ROS_LATENCY_TRACE(this->point_cloud_latency_topic_, PUBLISHED, stamp);
+  }
+  if (depth)
+  {
+    GAZEBO_ROS_LATENCY_TRACE(this->depth_image_latency_topic_, CONVERTED, stamp);
+    this->depth_image_pub_.publish(this->depth_image_msg_);
+    GAZEBO_ROS_LATENCY_TRACE(this->depth_image_latency_topic_, PUBLISHED, stamp);
+  }
+  if (disparity)
+    this->disparity_pub_.publish(this->disparity_msg_);
+  if (compressed)
+  {
+    // the row chunks in order, joined behind the header
+    // compressed_depth_image_transport expects: its ConfigHeader (format
+    // RVL, two unused floats) and the image size
+    std::sort(rvl.begin(), rvl.end());
+    std::vector<const RvlEncoder *> encoders;
+    for (size_t i = 0; i < rvl.size(); ++i)
+      encoders.push_back(rvl[i].second.get());
+
+    const int32_t header[3] = {1, 0, 0};
+    const int32_t size[2] = {static_cast<int32_t>(cols),
+                             static_cast<int32_t>(rows)};
+    sensor_msgs::CompressedImage &msg = this->compressed_depth_msg_;
+    RvlEncoder::Join(encoders, msg.data, sizeof(header) + sizeof(size));
+    memcpy(&msg.data[0], header, sizeof(header));
+    memcpy(&msg.data[sizeof(header)], size, sizeof(size));
+    msg.header.frame_id = this->frame_name_;
+    msg.header.stamp.sec = this->depth_sensor_update_time_.sec;
+    msg.header.stamp.nsec = this->depth_sensor_update_time_.nsec;
+    msg.format = sensor_msgs::image_encodings::TYPE_16UC1 +
+        "; compressedDepth rvl";
+    this->compressed_depth_pub_.publish(msg);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Publish the camera info and the depth camera info
+void GazeboRosDepthCameraUtils::PublishCameraInfo()
+{
+  ROS_DEBUG_NAMED("depth_camera", "publishing default camera info, then depth camera info");
+  GazeboRosCameraUtils::PublishCameraInfo();
+
+  if (this->depth_info_connect_count_ > 0)
+  {
+# if GAZEBO_MAJOR_VERSION >= 7
+    common::Time sensor_update_time = this->parentSensor_->LastMeasurementTime();
+# else
+    common::Time sensor_update_time = this->parentSensor_->GetLastMeasurementTime();
+# endif
+    this->sensor_update_time_ = sensor_update_time;
+    if (sensor_update_time - this->last_depth_image_camera_info_update_time_ >= this->update_period_)
+    {
+      this->PublishCameraInfo(this->depth_image_camera_info_pub_);
+      this->last_depth_image_camera_info_update_time_ = sensor_update_time;
+    }
+  }
+}
+}
@@ -52,9 +52,7 @@
 
 #include <gazebo_plugins/gazebo_ros_diff_drive.h>
 
-#ifdef ENABLE_PROFILER
-#include <ignition/common/Profiler.hh>
-#endif
+#include <gazebo_ros/profiler.h>
 
 #include <ignition/math/Angle.hh>
 #include <ignition/math/Pose3.hh>
@@ -77,12 +75,14 @@ GazeboRosDiffDrive::GazeboRosDiffDrive() {}
 // Destructor
 GazeboRosDiffDrive::~GazeboRosDiffDrive()
 {
+    if ( deferred_load_task_ ) deferred_load_task_->Wait();
     FiniChild();
 }
 
 // Load the controller
 void GazeboRosDiffDrive::Load ( physics::ModelPtr _parent, sdf::ElementPtr _sdf )
 {
+    GAZEBO_ROS_STARTUP_PHASE("load");
 
     this->parent = _parent;
     gazebo_ros_ = GazeboRosPtr ( new GazeboRos ( _parent, _sdf, "DiffDrive" ) );
@@ -140,40 +140,45 @@ void GazeboRosDiffDrive::Load ( physics::ModelPtr _parent, sdf::ElementPtr _sdf
     wheel_speed_instr_[RIGHT] = 0;
     wheel_speed_instr_[LEFT] = 0;
 
-    x_ = 0;
-    rot_ = 0;
     alive_ = true;
 
+    // resolve the frames once, they are reused by every update
+    for ( int i = 0; i < 2; i++ ) {
+        wheel_frames_[i] = gazebo_ros_->resolveTF ( joints_[i]->GetChild()->GetName () );
+        wheel_parent_frames_[i] = gazebo_ros_->resolveTF ( joints_[i]->GetParent()->GetName () );
+    }
+
+    setTransportHints ( _sdf );
+    if ( DeferredLoad::Requested ( _sdf ) )
+        deferred_load_task_ = DeferredLoad::Instance().Run ( this->handleName,
+                                  boost::bind ( &GazeboRosDiffDrive::LoadThread, this ) );
+    else
+        LoadThread();
+}
 
+void GazeboRosDiffDrive::LoadThread()
+{
     if (this->publishWheelJointState_)
     {
-        joint_state_publisher_ = gazebo_ros_->node()->advertise<sensor_msgs::JointState>("joint_states", 1000);
+        advertiseJointStates ( *gazebo_ros_->node(), joints_, false );
         ROS_INFO_NAMED("diff_drive", "%s: Advertise joint_states", gazebo_ros_->info());
     }
 
-    transform_broadcaster_ = boost::shared_ptr<tf::TransformBroadcaster>(new tf::TransformBroadcaster());
-
     // ROS: Subscribe to the velocity command topic (usually "cmd_vel")
     ROS_INFO_NAMED("diff_drive", "%s: Try to subscribe to %s", gazebo_ros_->info(), command_topic_.c_str());
 
-    ros::SubscribeOptions so =
-        ros::SubscribeOptions::create<geometry_msgs::Twist>(command_topic_, 1,
-                boost::bind(&GazeboRosDiffDrive::cmdVelCallback, this, _1),
-                ros::VoidPtr(), &queue_);
-
-    cmd_vel_subscriber_ = gazebo_ros_->node()->subscribe(so);
+    loadDrive ( parent, *gazebo_ros_->node(), command_topic_,
+                this->publish_tf_ ? odometry_topic_ : std::string(),
+                gazebo_ros_->resolveTF ( odometry_frame_ ),
+                gazebo_ros_->resolveTF ( robot_base_frame_ ) );
+    setOdometryCovariance ( 0.00001, 0.00001, 0.001, false );
     ROS_INFO_NAMED("diff_drive", "%s: Subscribe to %s", gazebo_ros_->info(), command_topic_.c_str());
 
     if (this->publish_tf_)
     {
-      odometry_publisher_ = gazebo_ros_->node()->advertise<nav_msgs::Odometry>(odometry_topic_, 1);
       ROS_INFO_NAMED("diff_drive", "%s: Advertise odom on %s ", gazebo_ros_->info(), odometry_topic_.c_str());
     }
 
-    // start custom queue for diff drive
-    this->callback_queue_thread_ =
-        boost::thread ( boost::bind ( &GazeboRosDiffDrive::QueueThread, this ) );
-
     // listen to the update event (broadcast every simulation iteration)
     this->update_connection_ =
         event::Events::ConnectWorldUpdateBegin ( boost::bind ( &GazeboRosDiffDrive::UpdateChild, this ) );
@@ -187,66 +192,24 @@ void GazeboRosDiffDrive::Reset()
 #else
   last_update_time_ = parent->GetWorld()->GetSimTime();
 #endif
-  pose_encoder_.x = 0;
-  pose_encoder_.y = 0;
-  pose_encoder_.theta = 0;
-  x_ = 0;
-  rot_ = 0;
+  resetEncoder();
+  resetCommand();
   joints_[LEFT]->SetParam ( "fmax", 0, wheel_torque );
   joints_[RIGHT]->SetParam ( "fmax", 0, wheel_torque );
 }
 
-void GazeboRosDiffDrive::publishWheelJointState()
+void GazeboRosDiffDrive::publishWheelTF ( const ros::Time &current_time )
 {
-    ros::Time current_time = ros::Time::now();
-
-    joint_state_.header.stamp = current_time;
-    joint_state_.name.resize ( joints_.size() );
-    joint_state_.position.resize ( joints_.size() );
-
     for ( int i = 0; i < 2; i++ ) {
-        physics::JointPtr joint = joints_[i];
-#if GAZEBO_MAJOR_VERSION >= 8
-        double position = joint->Position ( 0 );
-#else
-        double position = joint->GetAngle ( 0 ).Radian();
-#endif
-        joint_state_.name[i] = joint->GetName();
-        joint_state_.position[i] = position;
-    }
-    joint_state_publisher_.publish ( joint_state_ );
-}
-
-void GazeboRosDiffDrive::publishWheelTF()
-{
-    ros::Time current_time = ros::Time::now();
-    for ( int i = 0; i < 2; i++ ) {
-
-        std::string wheel_frame = gazebo_ros_->resolveTF(joints_[i]->GetChild()->GetName ());
-        std::string wheel_parent_frame = gazebo_ros_->resolveTF(joints_[i]->GetParent()->GetName ());
-
-#if GAZEBO_MAJOR_VERSION >= 8
-        ignition::math::Pose3d poseWheel = joints_[i]->GetChild()->RelativePose();
-#else
-        ignition::math::Pose3d poseWheel = joints_[i]->GetChild()->GetRelativePose().Ign();
-#endif
-
-        tf::Quaternion qt ( poseWheel.Rot().X(), poseWheel.Rot().Y(), poseWheel.Rot().Z(), poseWheel.Rot().W() );
-        tf::Vector3 vt ( poseWheel.Pos().X(), poseWheel.Pos().Y(), poseWheel.Pos().Z() );
-
-        tf::Transform tfWheel ( qt, vt );
-        transform_broadcaster_->sendTransform (
-            tf::StampedTransform ( tfWheel, current_time, wheel_parent_frame, wheel_frame ) );
+        addLinkTF ( joints_[i]->GetChild(), wheel_parent_frames_[i], wheel_frames_[i], current_time );
     }
 }
 
 // Update the controller
 void GazeboRosDiffDrive::UpdateChild()
 {
-#ifdef ENABLE_PROFILER
-  IGN_PROFILE("GazeboRosDiffDrive::UpdateChild");
-  IGN_PROFILE_BEGIN("update");
-#endif
+  GAZEBO_ROS_PROFILE("GazeboRosDiffDrive::UpdateChild");
+  GAZEBO_ROS_PROFILE_BEGIN("update");
     /* force reset SetParam("fmax") since Joint::Reset reset MaxForce to zero at
        https://bitbucket.org/osrf/gazebo/src/8091da8b3c529a362f39b042095e12c94656a5d1/gazebo/physics/Joint.cc?at=gazebo2_2.2.5#cl-331
        (this has been solved in https://bitbucket.org/osrf/gazebo/diff/gazebo/physics/Joint.cc?diff2=b64ff1b7b6ff&at=issue_964 )
@@ -260,7 +223,11 @@ void GazeboRosDiffDrive::UpdateChild()
     }
 
 
-    if ( odom_source_ == ENCODER ) UpdateOdometryEncoder();
+    if ( odom_source_ == ENCODER ) {
+        integrateEncoder ( joints_[LEFT]->GetVelocity ( 0 ) * ( wheel_diameter_ / 2.0 ),
+                           joints_[RIGHT]->GetVelocity ( 0 ) * ( wheel_diameter_ / 2.0 ),
+                           wheel_separation_ );
+    }
 #if GAZEBO_MAJOR_VERSION >= 8
     common::Time current_time = parent->GetWorld()->SimTime();
 #else
@@ -269,9 +236,14 @@ void GazeboRosDiffDrive::UpdateChild()
     double seconds_since_last_update = ( current_time - last_update_time_ ).Double();
 
     if ( seconds_since_last_update > update_period_ ) {
-        if (this->publish_tf_) publishOdometry ( seconds_since_last_update );
-        if ( publishWheelTF_ ) publishWheelTF();
-        if ( publishWheelJointState_ ) publishWheelJointState();
+        ros::Time current_ros_time = ros::Time::now();
+        if (this->publish_tf_) {
+            if ( odom_source_ == WORLD ) setOdometryFromWorld();
+            publishOdometry ( current_ros_time, publishOdomTF_ );
+        }
+        if ( publishWheelTF_ ) publishWheelTF ( current_ros_time );
+        publishTF();
+        if ( publishWheelJointState_ ) publishJointStates ( current_ros_time );
 
         // Update robot in case new velocities have been requested
         getWheelVelocities();
@@ -306,174 +278,26 @@ void GazeboRosDiffDrive::UpdateChild()
         }
         last_update_time_+= common::Time ( update_period_ );
     }
-#ifdef ENABLE_PROFILER
-    IGN_PROFILE_END();
-#endif
+    GAZEBO_ROS_PROFILE_END();
 }
 
 // Finalize the controller
 void GazeboRosDiffDrive::FiniChild()
 {
     alive_ = false;
-    queue_.clear();
-    queue_.disable();
-    gazebo_ros_->node()->shutdown();
-    callback_queue_thread_.join();
+    finiDrive ( *gazebo_ros_->node() );
 }
 
 void GazeboRosDiffDrive::getWheelVelocities()
 {
-    boost::mutex::scoped_lock scoped_lock ( lock );
+    geometry_msgs::Twist cmd = command();
 
-    double vr = x_;
-    double va = rot_;
+    double vr = cmd.linear.x;
+    double va = cmd.angular.z;
 
     wheel_speed_[LEFT] = vr - va * wheel_separation_ / 2.0;
     wheel_speed_[RIGHT] = vr + va * wheel_separation_ / 2.0;
 }
 
-void GazeboRosDiffDrive::cmdVelCallback ( const geometry_msgs::Twist::ConstPtr& cmd_msg )
-{
-    boost::mutex::scoped_lock scoped_lock ( lock );
-    x_ = cmd_msg->linear.x;
-    rot_ = cmd_msg->angular.z;
-}
-
-void GazeboRosDiffDrive::QueueThread()
-{
-    static const double timeout = 0.01;
-
-    while ( alive_ && gazebo_ros_->node()->ok() ) {
-        queue_.callAvailable ( ros::WallDuration ( timeout ) );
-    }
-}
-
-void GazeboRosDiffDrive::UpdateOdometryEncoder()
-{
-    double vl = joints_[LEFT]->GetVelocity ( 0 );
-    double vr = joints_[RIGHT]->GetVelocity ( 0 );
-#if GAZEBO_MAJOR_VERSION >= 8
-    common::Time current_time = parent->GetWorld()->SimTime();
-#else
-    common::Time current_time = parent->GetWorld()->GetSimTime();
-#endif
-    double seconds_since_last_update = ( current_time - last_odom_update_ ).Double();
-    last_odom_update_ = current_time;
-
-    double b = wheel_separation_;
-
-    // Book: Sigwart 2011 Autonompus Mobile Robots page:337
-    double sl = vl * ( wheel_diameter_ / 2.0 ) * seconds_since_last_update;
-    double sr = vr * ( wheel_diameter_ / 2.0 ) * seconds_since_last_update;
-    double ssum = sl + sr;
-
-    double sdiff = sr - sl;
-
-    double dx = ( ssum ) /2.0 * cos ( pose_encoder_.theta + ( sdiff ) / ( 2.0*b ) );
-    double dy = ( ssum ) /2.0 * sin ( pose_encoder_.theta + ( sdiff ) / ( 2.0*b ) );
-    double dtheta = ( sdiff ) /b;
-
-    pose_encoder_.x += dx;
-    pose_encoder_.y += dy;
-    pose_encoder_.theta += dtheta;
-
-    double w = dtheta/seconds_since_last_update;
-    double v = sqrt ( dx*dx+dy*dy ) /seconds_since_last_update;
-
-    tf::Quaternion qt;
-    tf::Vector3 vt;
-    qt.setRPY ( 0,0,pose_encoder_.theta );
-    vt = tf::Vector3 ( pose_encoder_.x, pose_encoder_.y, 0 );
-
-    odom_.pose.pose.position.x = vt.x();
-    odom_.pose.pose.position.y = vt.y();
-    odom_.pose.pose.position.z = vt.z();
-
-    odom_.pose.pose.orientation.x = qt.x();
-    odom_.pose.pose.orientation.y = qt.y();
-    odom_.pose.pose.orientation.z = qt.z();
-    odom_.pose.pose.orientation.w = qt.w();
-
-    odom_.twist.twist.angular.z = w;
-    odom_.twist.twist.linear.x = v;
-    odom_.twist.twist.linear.y = 0;
-}
-
-void GazeboRosDiffDrive::publishOdometry ( double step_time )
-{
-
-    ros::Time current_time = ros::Time::now();
-    std::string odom_frame = gazebo_ros_->resolveTF ( odometry_frame_ );
-    std::string base_footprint_frame = gazebo_ros_->resolveTF ( robot_base_frame_ );
-
-    tf::Quaternion qt;
-    tf::Vector3 vt;
-
-    if ( odom_source_ == ENCODER ) {
-        // getting data form encoder integration
-        qt = tf::Quaternion ( odom_.pose.pose.orientation.x, odom_.pose.pose.orientation.y, odom_.pose.pose.orientation.z, odom_.pose.pose.orientation.w );
-        vt = tf::Vector3 ( odom_.pose.pose.position.x, odom_.pose.pose.position.y, odom_.pose.pose.position.z );
-
-    }
-    if ( odom_source_ == WORLD ) {
-        // getting data from gazebo world
-#if GAZEBO_MAJOR_VERSION >= 8
-        ignition::math::Pose3d pose = parent->WorldPose();
-#else
-        ignition::math::Pose3d pose = parent->GetWorldPose().Ign();
-#endif
-        qt = tf::Quaternion ( pose.Rot().X(), pose.Rot().Y(), pose.Rot().Z(), pose.Rot().W() );
-        vt = tf::Vector3 ( pose.Pos().X(), pose.Pos().Y(), pose.Pos().Z() );
-
-        odom_.pose.pose.position.x = vt.x();
-        odom_.pose.pose.position.y = vt.y();
-        odom_.pose.pose.position.z = vt.z();
-
-        odom_.pose.pose.orientation.x = qt.x();
-        odom_.pose.pose.orientation.y = qt.y();
-        odom_.pose.pose.orientation.z = qt.z();
-        odom_.pose.pose.orientation.w = qt.w();
-
-        // get velocity in /odom frame
-        ignition::math::Vector3d linear;
-#if GAZEBO_MAJOR_VERSION >= 8
-        linear = parent->WorldLinearVel();
-        odom_.twist.twist.angular.z = parent->WorldAngularVel().Z();
-#else
-        linear = parent->GetWorldLinearVel().Ign();
-        odom_.twist.twist.angular.z = parent->GetWorldAngularVel().Ign().Z();
-#endif
-
-        // convert velocity to child_frame_id (aka base_footprint)
-        float yaw = pose.Rot().Yaw();
-        odom_.twist.twist.linear.x = cosf ( yaw ) * linear.X() + sinf ( yaw ) * linear.Y();
-        odom_.twist.twist.linear.y = cosf ( yaw ) * linear.Y() - sinf ( yaw ) * linear.X();
-    }
-
-    if (publishOdomTF_ == true){
-        tf::Transform base_footprint_to_odom ( qt, vt );
-        transform_broadcaster_->sendTransform (
-            tf::StampedTransform ( base_footprint_to_odom, current_time,
-                                   odom_frame, base_footprint_frame ) );
-    }
-
-
-    // set covariance
-    odom_.pose.covariance[0] = 0.00001;
-    odom_.pose.covariance[7] = 0.00001;
-    odom_.pose.covariance[14] = 1000000000000.0;
-    odom_.pose.covariance[21] = 1000000000000.0;
-    odom_.pose.covariance[28] = 1000000000000.0;
-    odom_.pose.covariance[35] = 0.001;
-
-
-    // set header
-    odom_.header.stamp = current_time;
-    odom_.header.frame_id = odom_frame;
-    odom_.child_frame_id = base_footprint_frame;
-
-    odometry_publisher_.publish ( odom_ );
-}
-
 GZ_REGISTER_MODEL_PLUGIN ( GazeboRosDiffDrive )
 }
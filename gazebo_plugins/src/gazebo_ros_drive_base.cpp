@@ -0,0 +1,349 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <cmath>
+
+#include <boost/bind.hpp>
+
+#include <gazebo_plugins/gazebo_ros_drive_base.h>
+#include <gazebo_plugins/gazebo_ros_utils.h>
+#include <gazebo_plugins/odometry_aggregator.h>
+
+namespace gazebo
+{
+////////////////////////////////////////////////////////////////////////////////
+GazeboRosDriveBase::GazeboRosDriveBase()
+  : cmd_timeout_(-1), aggregator_slot_(-1)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+GazeboRosDriveBase::~GazeboRosDriveBase()
+{
+  if (this->aggregator_slot_ >= 0)
+    OdometryAggregator::Instance().Unregister(this->aggregator_slot_);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void GazeboRosDriveBase::loadDrive(physics::ModelPtr _model,
+                                   ros::NodeHandle &_node,
+                                   const std::string &_command_topic,
+                                   const std::string &_odometry_topic,
+                                   const std::string &_odom_frame,
+                                   const std::string &_base_frame)
+{
+  this->drive_model_ = _model;
+
+  this->odom_.header.frame_id = _odom_frame;
+  this->odom_.child_frame_id = _base_frame;
+  this->odom_.pose.pose.orientation.w = 1.0;
+  this->resetEncoder();
+  this->resetCommand();
+
+  this->transform_broadcaster_.reset(new tf::TransformBroadcaster());
+
+  this->cmd_mailbox_.SetLatencyStage(TimingRegistry::instance().stage(
+      "gazebo_ros_drive " + _node.resolveName(_command_topic),
+      "command_latency"));
+
+  // commands are small messages, by default Nagle does not hold them back
+  ros::SubscribeOptions so =
+    ros::SubscribeOptions::create<geometry_msgs::Twist>(_command_topic, 1,
+        boost::bind(&GazeboRosDriveBase::cmdVelCallback, this, _1),
+        ros::VoidPtr(), &this->queue_);
+  GetSubscriptionHints(_node, this->transport_hints_sdf_).apply(so);
+  this->cmd_vel_subscriber_ = _node.subscribe(so);
+
+  if (!_odometry_topic.empty())
+  {
+    this->odometry_publisher_ =
+      _node.advertise<nav_msgs::Odometry>(_odometry_topic, 1);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void GazeboRosDriveBase::finiDrive(ros::NodeHandle &_node)
+{
+  this->queue_.clear();
+  this->queue_.disable();
+  _node.shutdown();
+  this->queue_.Stop();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void GazeboRosDriveBase::setCommandTimeout(double _timeout)
+{
+  this->cmd_timeout_ = _timeout;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void GazeboRosDriveBase::setTransportHints(sdf::ElementPtr _sdf)
+{
+  this->transport_hints_sdf_ = _sdf;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+geometry_msgs::Twist GazeboRosDriveBase::command()
+{
+  double values[7];
+  if (this->cmd_mailbox_.Read(values))
+  {
+    this->cmd_.linear.x = values[0];
+    this->cmd_.linear.y = values[1];
+    this->cmd_.linear.z = values[2];
+    this->cmd_.angular.x = values[3];
+    this->cmd_.angular.y = values[4];
+    this->cmd_.angular.z = values[5];
+    this->last_cmd_time_.fromSec(values[6]);
+  }
+  if (this->cmd_timeout_ >= 0 &&
+      (ros::Time::now() - this->last_cmd_time_).toSec() > this->cmd_timeout_)
+  {
+    this->cmd_ = geometry_msgs::Twist();
+  }
+  return this->cmd_;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void GazeboRosDriveBase::resetCommand()
+{
+  this->cmd_mailbox_.Skip();
+  this->cmd_ = geometry_msgs::Twist();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void GazeboRosDriveBase::cmdVelCallback(
+    const geometry_msgs::Twist::ConstPtr &_msg)
+{
+  const double values[7] = {_msg->linear.x, _msg->linear.y, _msg->linear.z,
+    _msg->angular.x, _msg->angular.y, _msg->angular.z,
+    ros::Time::now().toSec()};
+  this->cmd_mailbox_.Write(values);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void GazeboRosDriveBase::setOdometryCovariance(double _x, double _y,
+                                               double _yaw, bool _twist)
+{
+  this->odom_.pose.covariance[0] = _x;
+  this->odom_.pose.covariance[7] = _y;
+  this->odom_.pose.covariance[14] = 1000000000000.0;
+  this->odom_.pose.covariance[21] = 1000000000000.0;
+  this->odom_.pose.covariance[28] = 1000000000000.0;
+  this->odom_.pose.covariance[35] = _yaw;
+  if (_twist)
+  {
+    this->odom_.twist.covariance[0] = _x;
+    this->odom_.twist.covariance[7] = _y;
+    this->odom_.twist.covariance[14] = 1000000000000.0;
+    this->odom_.twist.covariance[21] = 1000000000000.0;
+    this->odom_.twist.covariance[28] = 1000000000000.0;
+    this->odom_.twist.covariance[35] = _yaw;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void GazeboRosDriveBase::setOdometryFromWorld()
+{
+#if GAZEBO_MAJOR_VERSION >= 8
+  ignition::math::Pose3d pose = this->drive_model_->WorldPose();
+  ignition::math::Vector3d linear = this->drive_model_->WorldLinearVel();
+  double angular_z = this->drive_model_->WorldAngularVel().Z();
+#else
+  ignition::math::Pose3d pose = this->drive_model_->GetWorldPose().Ign();
+  ignition::math::Vector3d linear =
+    this->drive_model_->GetWorldLinearVel().Ign();
+  double angular_z = this->drive_model_->GetWorldAngularVel().Ign().Z();
+#endif
+  this->setOdometryPose(pose);
+  this->setOdometryVelocity(pose.Rot().Yaw(), linear, angular_z);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void GazeboRosDriveBase::setOdometryPose(const ignition::math::Pose3d &_pose)
+{
+  this->odom_.pose.pose.position.x = _pose.Pos().X();
+  this->odom_.pose.pose.position.y = _pose.Pos().Y();
+  this->odom_.pose.pose.position.z = _pose.Pos().Z();
+  this->odom_.pose.pose.orientation.x = _pose.Rot().X();
+  this->odom_.pose.pose.orientation.y = _pose.Rot().Y();
+  this->odom_.pose.pose.orientation.z = _pose.Rot().Z();
+  this->odom_.pose.pose.orientation.w = _pose.Rot().W();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void GazeboRosDriveBase::setOdometryVelocity(double _yaw,
+    const ignition::math::Vector3d &_linear, double _angular_z)
+{
+  // convert velocity to child_frame_id (aka base_footprint)
+  const double c = std::cos(_yaw);
+  const double s = std::sin(_yaw);
+  this->odom_.twist.twist.linear.x = c * _linear.X() + s * _linear.Y();
+  this->odom_.twist.twist.linear.y = c * _linear.Y() - s * _linear.X();
+  this->odom_.twist.twist.angular.z = _angular_z;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void GazeboRosDriveBase::integrateEncoder(double _vl, double _vr,
+                                          double _separation)
+{
+#if GAZEBO_MAJOR_VERSION >= 8
+  common::Time current_time = this->drive_model_->GetWorld()->SimTime();
+#else
+  common::Time current_time = this->drive_model_->GetWorld()->GetSimTime();
+#endif
+  const double dt = (current_time - this->last_encoder_update_).Double();
+  this->last_encoder_update_ = current_time;
+
+  // Book: Sigwart 2011 Autonompus Mobile Robots page:337
+  const double ssum = (_vl + _vr) * dt;
+  const double sdiff = (_vr - _vl) * dt;
+  const double heading = this->pose_encoder_.theta + sdiff / (2.0 * _separation);
+  const double dtheta = sdiff / _separation;
+
+  this->pose_encoder_.x += ssum / 2.0 * std::cos(heading);
+  this->pose_encoder_.y += ssum / 2.0 * std::sin(heading);
+  this->pose_encoder_.theta += dtheta;
+
+  // the pose is planar, so the orientation is a rotation about z
+  this->odom_.pose.pose.position.x = this->pose_encoder_.x;
+  this->odom_.pose.pose.position.y = this->pose_encoder_.y;
+  this->odom_.pose.pose.position.z = 0;
+  this->odom_.pose.pose.orientation.x = 0;
+  this->odom_.pose.pose.orientation.y = 0;
+  this->odom_.pose.pose.orientation.z =
+    std::sin(this->pose_encoder_.theta / 2.0);
+  this->odom_.pose.pose.orientation.w =
+    std::cos(this->pose_encoder_.theta / 2.0);
+
+  if (dt > 0)
+  {
+    this->odom_.twist.twist.angular.z = dtheta / dt;
+    this->odom_.twist.twist.linear.x = std::fabs(ssum) / (2.0 * dt);
+    this->odom_.twist.twist.linear.y = 0;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void GazeboRosDriveBase::resetEncoder()
+{
+  this->pose_encoder_.x = 0;
+  this->pose_encoder_.y = 0;
+  this->pose_encoder_.theta = 0;
+  if (this->drive_model_)
+  {
+#if GAZEBO_MAJOR_VERSION >= 8
+    this->last_encoder_update_ = this->drive_model_->GetWorld()->SimTime();
+#else
+    this->last_encoder_update_ = this->drive_model_->GetWorld()->GetSimTime();
+#endif
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void GazeboRosDriveBase::publishOdometry(const ros::Time &_stamp, bool _tf)
+{
+  this->odom_.header.stamp = _stamp;
+
+  if (_tf)
+  {
+    const geometry_msgs::Point &p = this->odom_.pose.pose.position;
+    const geometry_msgs::Quaternion &q = this->odom_.pose.pose.orientation;
+    this->transforms_.push_back(tf::StampedTransform(
+        tf::Transform(tf::Quaternion(q.x, q.y, q.z, q.w),
+                      tf::Vector3(p.x, p.y, p.z)),
+        _stamp, this->odom_.header.frame_id, this->odom_.child_frame_id));
+  }
+
+  if (this->odometry_publisher_)
+    this->odometry_publisher_.publish(this->odom_);
+
+  OdometryAggregator &aggregator = OdometryAggregator::Instance();
+  if (aggregator.Active())
+  {
+    if (this->aggregator_slot_ < 0)
+      this->aggregator_slot_ = aggregator.Register(this->drive_model_->GetName());
+    aggregator.Submit(this->aggregator_slot_, this->odom_);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void GazeboRosDriveBase::addLinkTF(const physics::LinkPtr &_link,
+                                   const std::string &_parent_frame,
+                                   const std::string &_child_frame,
+                                   const ros::Time &_stamp)
+{
+#if GAZEBO_MAJOR_VERSION >= 8
+  ignition::math::Pose3d pose = _link->RelativePose();
+#else
+  ignition::math::Pose3d pose = _link->GetRelativePose().Ign();
+#endif
+  this->transforms_.push_back(tf::StampedTransform(
+      tf::Transform(
+        tf::Quaternion(pose.Rot().X(), pose.Rot().Y(), pose.Rot().Z(),
+                       pose.Rot().W()),
+        tf::Vector3(pose.Pos().X(), pose.Pos().Y(), pose.Pos().Z())),
+      _stamp, _parent_frame, _child_frame));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void GazeboRosDriveBase::publishTF()
+{
+  if (this->transforms_.empty())
+    return;
+  this->transform_broadcaster_->sendTransform(this->transforms_);
+  this->transforms_.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void GazeboRosDriveBase::advertiseJointStates(ros::NodeHandle &_node,
+    const std::vector<physics::JointPtr> &_joints, bool _velocity_effort)
+{
+  this->joint_state_joints_ = _joints;
+  this->joint_state_.name.resize(_joints.size());
+  this->joint_state_.position.resize(_joints.size());
+  this->joint_state_.velocity.resize(_velocity_effort ? _joints.size() : 0);
+  this->joint_state_.effort.resize(_velocity_effort ? _joints.size() : 0);
+  for (std::size_t i = 0; i < _joints.size(); ++i)
+    this->joint_state_.name[i] = _joints[i]->GetName();
+
+  this->joint_state_publisher_ =
+    _node.advertise<sensor_msgs::JointState>("joint_states", 1000);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void GazeboRosDriveBase::publishJointStates(const ros::Time &_stamp)
+{
+  this->joint_state_.header.stamp = _stamp;
+  const bool velocity_effort = !this->joint_state_.velocity.empty();
+  for (std::size_t i = 0; i < this->joint_state_joints_.size(); ++i)
+  {
+    const physics::JointPtr &joint = this->joint_state_joints_[i];
+#if GAZEBO_MAJOR_VERSION >= 8
+    this->joint_state_.position[i] = joint->Position(0);
+#else
+    this->joint_state_.position[i] = joint->GetAngle(0).Radian();
+#endif
+    if (velocity_effort)
+    {
+      this->joint_state_.velocity[i] = joint->GetVelocity(0);
+      this->joint_state_.effort[i] = joint->GetForce(0);
+    }
+  }
+  this->joint_state_publisher_.publish(this->joint_state_);
+}
+}
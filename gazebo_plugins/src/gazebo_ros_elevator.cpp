@@ -15,6 +15,7 @@
  *
 */
 #include "gazebo_plugins/gazebo_ros_elevator.h"
+#include <gazebo_plugins/gazebo_ros_utils.h>
 
 using namespace gazebo;
 
@@ -31,7 +32,7 @@ GazeboRosElevator::~GazeboRosElevator()
   this->queue_.clear();
   this->queue_.disable();
   this->rosnode_->shutdown();
-  this->callbackQueueThread_.join();
+  this->queue_.Stop();
 
   delete this->rosnode_;
 }
@@ -39,6 +40,7 @@ GazeboRosElevator::~GazeboRosElevator()
 /////////////////////////////////////////////////
 void GazeboRosElevator::Load(physics::ModelPtr _parent, sdf::ElementPtr _sdf)
 {
+  GAZEBO_ROS_STARTUP_PHASE("load");
   // load parameters
   this->robotNamespace_ = "";
   if (_sdf->HasElement("robotNamespace"))
@@ -68,12 +70,9 @@ void GazeboRosElevator::Load(physics::ModelPtr _parent, sdf::ElementPtr _sdf)
     ros::SubscribeOptions::create<std_msgs::String>(topic, 1,
         boost::bind(&GazeboRosElevator::OnElevator, this, _1),
         ros::VoidPtr(), &this->queue_);
-
+  GetSubscriptionHints(*this->rosnode_, _sdf).apply(so);
   this->elevatorSub_ = this->rosnode_->subscribe(so);
 
-  // start custom queue for elevator
-  this->callbackQueueThread_ =
-    boost::thread(boost::bind(&GazeboRosElevator::QueueThread, this));
 }
 
 /////////////////////////////////////////////////
@@ -82,11 +81,3 @@ void GazeboRosElevator::OnElevator(const std_msgs::String::ConstPtr &_msg)
   this->MoveToFloor(std::stoi(_msg->data));
 }
 
-/////////////////////////////////////////////////
-void GazeboRosElevator::QueueThread()
-{
-  static const double timeout = 0.01;
-
-  while (this->rosnode_->ok())
-    this->queue_.callAvailable(ros::WallDuration(timeout));
-}
@@ -22,9 +22,8 @@
  */
 
 #include <gazebo_plugins/gazebo_ros_f3d.h>
-#ifdef ENABLE_PROFILER
-#include <ignition/common/Profiler.hh>
-#endif
+#include <gazebo_plugins/gazebo_ros_utils.h>
+#include <gazebo_ros/profiler.h>
 #include <tf/tf.h>
 
 namespace gazebo
@@ -36,6 +35,7 @@ GZ_REGISTER_MODEL_PLUGIN(GazeboRosF3D);
 GazeboRosF3D::GazeboRosF3D()
 {
   this->f3d_connect_count_ = 0;
+  this->update_rate_ = 0;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -47,7 +47,7 @@ GazeboRosF3D::~GazeboRosF3D()
   this->queue_.clear();
   this->queue_.disable();
   this->rosnode_->shutdown();
-  this->callback_queue_thread_.join();
+  this->queue_.Stop();
   delete this->rosnode_;
 }
 
@@ -55,6 +55,7 @@ GazeboRosF3D::~GazeboRosF3D()
 // Load the controller
 void GazeboRosF3D::Load( physics::ModelPtr _parent, sdf::ElementPtr _sdf )
 {
+  GAZEBO_ROS_STARTUP_PHASE("load");
   // Get the world name.
   this->world_ = _parent->GetWorld();
 
@@ -98,6 +99,11 @@ void GazeboRosF3D::Load( physics::ModelPtr _parent, sdf::ElementPtr _sdf )
     ROS_INFO_NAMED("f3d", "f3d plugin specifies <frameName> [%s], not used, default to world",this->frame_name_.c_str());
   }
 
+  if (_sdf->HasElement("updateRate"))
+    this->update_rate_ = _sdf->GetElement("updateRate")->Get<double>();
+
+  this->filter_.Load(_sdf, "f3d");
+
 
   // Make sure the ROS node for Gazebo has already been initialized
   if (!ros::isInitialized())
@@ -120,9 +126,13 @@ void GazeboRosF3D::Load( physics::ModelPtr _parent, sdf::ElementPtr _sdf )
     boost::bind( &GazeboRosF3D::F3DConnect,this),
     boost::bind( &GazeboRosF3D::F3DDisconnect,this), ros::VoidPtr(), &this->queue_);
   this->pub_ = this->rosnode_->advertise(ao);
+  this->filter_.Advertise(*this->rosnode_, this->frame_name_);
 
-  // Custom Callback Queue
-  this->callback_queue_thread_ = boost::thread( boost::bind( &GazeboRosF3D::QueueThread,this ) );
+#if GAZEBO_MAJOR_VERSION >= 8
+  this->last_time_ = this->world_->SimTime();
+#else
+  this->last_time_ = this->world_->GetSimTime();
+#endif
 
   // New Mechanism for Updating every World Cycle
   // Listen to the update event. This event is broadcast every
@@ -149,15 +159,27 @@ void GazeboRosF3D::F3DDisconnect()
 // Update the controller
 void GazeboRosF3D::UpdateChild()
 {
-#ifdef ENABLE_PROFILER
-  IGN_PROFILE("GazeboRosF3D::UpdateChild");
+  GAZEBO_ROS_PROFILE("GazeboRosF3D::UpdateChild");
+#if GAZEBO_MAJOR_VERSION >= 8
+  common::Time cur_time = this->world_->SimTime();
+#else
+  common::Time cur_time = this->world_->GetSimTime();
 #endif
-  if (this->f3d_connect_count_ == 0)
+
+  // rate control, a filter samples every step and outputs at the rate
+  const bool filtered = this->filter_.Enabled();
+  const bool due = this->update_rate_ <= 0 ||
+    (cur_time-this->last_time_).Double() >= (1.0/this->update_rate_);
+  if (!filtered && !due)
     return;
 
-#ifdef ENABLE_PROFILER
-  IGN_PROFILE_BEGIN("fill ROS message");
-#endif
+  if (this->f3d_connect_count_ == 0 && !this->filter_.RawActive())
+  {
+    this->filter_.Reset();
+    return;
+  }
+
+  GAZEBO_ROS_PROFILE_BEGIN("fill ROS message");
   ignition::math::Vector3d torque;
   ignition::math::Vector3d force;
 
@@ -170,6 +192,17 @@ void GazeboRosF3D::UpdateChild()
   torque = this->link_->GetWorldTorque().Ign();
 #endif
 
+  if (filtered)
+  {
+    this->filter_.Add(cur_time, force, torque);
+    if (!due)
+    {
+      GAZEBO_ROS_PROFILE_END();
+      return;
+    }
+    this->filter_.Output(force, torque);
+  }
+
   this->lock_.lock();
   // copy data into wrench message
   this->wrench_msg_.header.frame_id = this->frame_name_;
@@ -187,28 +220,16 @@ void GazeboRosF3D::UpdateChild()
   this->wrench_msg_.wrench.torque.x   = torque.X();
   this->wrench_msg_.wrench.torque.y   = torque.Y();
   this->wrench_msg_.wrench.torque.z   = torque.Z();
-#ifdef ENABLE_PROFILER
-  IGN_PROFILE_END();
-  IGN_PROFILE_BEGIN("publish");
-#endif
-  this->pub_.publish(this->wrench_msg_);
-#ifdef ENABLE_PROFILER
-  IGN_PROFILE_END();
-#endif
+  GAZEBO_ROS_PROFILE_END();
+  GAZEBO_ROS_PROFILE_BEGIN("publish");
+  if (this->f3d_connect_count_ > 0)
+    this->pub_.publish(this->wrench_msg_);
+  GAZEBO_ROS_PROFILE_END();
   this->lock_.unlock();
-}
 
-// Custom Callback Queue
-////////////////////////////////////////////////////////////////////////////////
-// custom callback queue thread
-void GazeboRosF3D::QueueThread()
-{
-  static const double timeout = 0.01;
-
-  while (this->rosnode_->ok())
-  {
-    this->queue_.callAvailable(ros::WallDuration(timeout));
-  }
+  // save last time stamp
+  this->last_time_ = cur_time;
 }
 
+
 }
@@ -25,9 +25,8 @@
 #include <assert.h>
 
 #include <gazebo_plugins/gazebo_ros_force.h>
-#ifdef ENABLE_PROFILER
-#include <ignition/common/Profiler.hh>
-#endif
+#include <gazebo_plugins/gazebo_ros_utils.h>
+#include <gazebo_ros/profiler.h>
 
 namespace gazebo
 {
@@ -37,12 +36,8 @@ GZ_REGISTER_MODEL_PLUGIN(GazeboRosForce);
 // Constructor
 GazeboRosForce::GazeboRosForce()
 {
-  this->wrench_msg_.force.x = 0;
-  this->wrench_msg_.force.y = 0;
-  this->wrench_msg_.force.z = 0;
-  this->wrench_msg_.torque.x = 0;
-  this->wrench_msg_.torque.y = 0;
-  this->wrench_msg_.torque.z = 0;
+  this->force_.Set(0, 0, 0);
+  this->torque_.Set(0, 0, 0);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -55,7 +50,7 @@ GazeboRosForce::~GazeboRosForce()
   this->queue_.clear();
   this->queue_.disable();
   this->rosnode_->shutdown();
-  this->callback_queue_thread_.join();
+  this->queue_.Stop();
 
   delete this->rosnode_;
 }
@@ -64,6 +59,7 @@ GazeboRosForce::~GazeboRosForce()
 // Load the controller
 void GazeboRosForce::Load(physics::ModelPtr _model, sdf::ElementPtr _sdf)
 {
+  GAZEBO_ROS_STARTUP_PHASE("load");
   // Get the world name.
   this->world_ = _model->GetWorld();
 
@@ -106,16 +102,18 @@ void GazeboRosForce::Load(physics::ModelPtr _model, sdf::ElementPtr _sdf)
 
   this->rosnode_ = new ros::NodeHandle(this->robot_namespace_);
 
+  this->wrench_mailbox_.SetLatencyStage(TimingRegistry::instance().stage(
+    "gazebo_ros_force " + this->rosnode_->resolveName(this->topic_name_),
+    "command_latency"));
+
   // Custom Callback Queue
   ros::SubscribeOptions so = ros::SubscribeOptions::create<geometry_msgs::Wrench>(
     this->topic_name_,1,
     boost::bind( &GazeboRosForce::UpdateObjectForce,this,_1),
     ros::VoidPtr(), &this->queue_);
+  GetSubscriptionHints(*this->rosnode_, _sdf).apply(so);
   this->sub_ = this->rosnode_->subscribe(so);
 
-  // Custom Callback Queue
-  this->callback_queue_thread_ = boost::thread( boost::bind( &GazeboRosForce::QueueThread,this ) );
-
   // New Mechanism for Updating every World Cycle
   // Listen to the update event. This event is broadcast every
   // simulation iteration.
@@ -127,44 +125,27 @@ void GazeboRosForce::Load(physics::ModelPtr _model, sdf::ElementPtr _sdf)
 // Update the controller
 void GazeboRosForce::UpdateObjectForce(const geometry_msgs::Wrench::ConstPtr& _msg)
 {
-  this->wrench_msg_.force.x = _msg->force.x;
-  this->wrench_msg_.force.y = _msg->force.y;
-  this->wrench_msg_.force.z = _msg->force.z;
-  this->wrench_msg_.torque.x = _msg->torque.x;
-  this->wrench_msg_.torque.y = _msg->torque.y;
-  this->wrench_msg_.torque.z = _msg->torque.z;
+  const double values[6] = {_msg->force.x, _msg->force.y, _msg->force.z,
+    _msg->torque.x, _msg->torque.y, _msg->torque.z};
+  this->wrench_mailbox_.Write(values);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 // Update the controller
 void GazeboRosForce::UpdateChild()
 {
-#ifdef ENABLE_PROFILER
-  IGN_PROFILE("GazeboRosForce::OnNewFrame");
-  IGN_PROFILE_BEGIN("fill ROS message");
-#endif
-  this->lock_.lock();
-  ignition::math::Vector3d force(this->wrench_msg_.force.x,this->wrench_msg_.force.y,this->wrench_msg_.force.z);
-  ignition::math::Vector3d torque(this->wrench_msg_.torque.x,this->wrench_msg_.torque.y,this->wrench_msg_.torque.z);
-  this->link_->AddForce(force);
-  this->link_->AddTorque(torque);
-  this->lock_.unlock();
-#ifdef ENABLE_PROFILER
-  IGN_PROFILE_END();
-#endif
-}
-
-// Custom Callback Queue
-////////////////////////////////////////////////////////////////////////////////
-// custom callback queue thread
-void GazeboRosForce::QueueThread()
-{
-  static const double timeout = 0.01;
-
-  while (this->rosnode_->ok())
+  GAZEBO_ROS_PROFILE("GazeboRosForce::OnNewFrame");
+  GAZEBO_ROS_PROFILE_BEGIN("fill ROS message");
+  double values[6];
+  if (this->wrench_mailbox_.Read(values))
   {
-    this->queue_.callAvailable(ros::WallDuration(timeout));
+    this->force_.Set(values[0], values[1], values[2]);
+    this->torque_.Set(values[3], values[4], values[5]);
   }
+  this->link_->AddForce(this->force_);
+  this->link_->AddTorque(this->torque_);
+  GAZEBO_ROS_PROFILE_END();
 }
 
+
 }
@@ -21,11 +21,9 @@
  */
 
 #include <gazebo_plugins/gazebo_ros_ft_sensor.h>
+#include <gazebo_plugins/gazebo_ros_utils.h>
 #include <tf/tf.h>
-#ifdef ENABLE_PROFILER
-#include <ignition/common/Profiler.hh>
-#endif
-#include <ignition/math/Rand.hh>
+#include <gazebo_ros/profiler.h>
 
 namespace gazebo
 {
@@ -47,7 +45,7 @@ GazeboRosFT::~GazeboRosFT()
   this->queue_.clear();
   this->queue_.disable();
   this->rosnode_->shutdown();
-  this->callback_queue_thread_.join();
+  this->queue_.Stop();
   delete this->rosnode_;
 }
 
@@ -55,6 +53,7 @@ GazeboRosFT::~GazeboRosFT()
 // Load the controller
 void GazeboRosFT::Load( physics::ModelPtr _model, sdf::ElementPtr _sdf )
 {
+  GAZEBO_ROS_STARTUP_PHASE("load");
   // Save pointers
   this->model_ = _model;
   this->world_ = this->model_->GetWorld();
@@ -100,6 +99,7 @@ void GazeboRosFT::Load( physics::ModelPtr _model, sdf::ElementPtr _sdf )
   }
   else
     this->gaussian_noise_ = _sdf->Get<double>("gaussianNoise");
+  this->noise_.Seed(GaussianNoise::SeedFromSdf(_sdf, _model->GetScopedName()));
 
   if (!_sdf->HasElement("updateRate"))
   {
@@ -110,6 +110,8 @@ void GazeboRosFT::Load( physics::ModelPtr _model, sdf::ElementPtr _sdf )
   else
     this->update_rate_ = _sdf->GetElement("updateRate")->Get<double>();
 
+  this->filter_.Load(_sdf, "ft_sensor");
+
   // Make sure the ROS node for Gazebo has already been initialized
   if (!ros::isInitialized())
   {
@@ -131,9 +133,7 @@ void GazeboRosFT::Load( physics::ModelPtr _model, sdf::ElementPtr _sdf )
     boost::bind( &GazeboRosFT::FTConnect,this),
     boost::bind( &GazeboRosFT::FTDisconnect,this), ros::VoidPtr(), &this->queue_);
   this->pub_ = this->rosnode_->advertise(ao);
-
-  // Custom Callback Queue
-  this->callback_queue_thread_ = boost::thread( boost::bind( &GazeboRosFT::QueueThread,this ) );
+  this->filter_.Advertise(*this->rosnode_, this->frame_name_);
 
   // New Mechanism for Updating every World Cycle
   // Listen to the update event. This event is broadcast every
@@ -160,24 +160,27 @@ void GazeboRosFT::FTDisconnect()
 // Update the controller
 void GazeboRosFT::UpdateChild()
 {
-#ifdef ENABLE_PROFILER
-  IGN_PROFILE("GazeboRosFT::UpdateChild");
-  IGN_PROFILE_BEGIN("fill ROS message");
-#endif
+  GAZEBO_ROS_PROFILE("GazeboRosFT::UpdateChild");
 #if GAZEBO_MAJOR_VERSION >= 8
   common::Time cur_time = this->world_->SimTime();
 #else
   common::Time cur_time = this->world_->GetSimTime();
 #endif
 
-  // rate control
-  if (this->update_rate_ > 0 &&
-      (cur_time-this->last_time_).Double() < (1.0/this->update_rate_))
+  // rate control, a filter samples every step and outputs at the rate
+  const bool filtered = this->filter_.Enabled();
+  const bool due = this->update_rate_ <= 0 ||
+    (cur_time-this->last_time_).Double() >= (1.0/this->update_rate_);
+  if (!filtered && !due)
     return;
 
-  if (this->ft_connect_count_ == 0)
+  if (this->ft_connect_count_ == 0 && !this->filter_.RawActive())
+  {
+    this->filter_.Reset();
     return;
+  }
 
+  GAZEBO_ROS_PROFILE_BEGIN("fill ROS message");
   physics::JointWrench wrench;
   ignition::math::Vector3d torque;
   ignition::math::Vector3d force;
@@ -196,6 +199,16 @@ void GazeboRosFT::UpdateChild()
   torque = wrench.body2Torque.Ign();
 #endif
 
+  if (filtered)
+  {
+    this->filter_.Add(cur_time, force, torque);
+    if (!due)
+    {
+      GAZEBO_ROS_PROFILE_END();
+      return;
+    }
+    this->filter_.Output(force, torque);
+  }
 
   this->lock_.lock();
   // copy data into wrench message
@@ -208,59 +221,22 @@ void GazeboRosFT::UpdateChild()
   this->wrench_msg_.header.stamp.nsec = (this->world_->GetSimTime()).nsec;
 #endif
 
-  this->wrench_msg_.wrench.force.x = force.X() + this->GaussianKernel(0, this->gaussian_noise_);
-  this->wrench_msg_.wrench.force.y = force.Y() + this->GaussianKernel(0, this->gaussian_noise_);
-  this->wrench_msg_.wrench.force.z = force.Z() + this->GaussianKernel(0, this->gaussian_noise_);
-  this->wrench_msg_.wrench.torque.x = torque.X() + this->GaussianKernel(0, this->gaussian_noise_);
-  this->wrench_msg_.wrench.torque.y = torque.Y() + this->GaussianKernel(0, this->gaussian_noise_);
-  this->wrench_msg_.wrench.torque.z = torque.Z() + this->GaussianKernel(0, this->gaussian_noise_);
-#ifdef ENABLE_PROFILER
-  IGN_PROFILE_END();
-  IGN_PROFILE_BEGIN("publish");
-#endif
-  this->pub_.publish(this->wrench_msg_);
-#ifdef ENABLE_PROFILER
-  IGN_PROFILE_END();
-#endif
+  this->wrench_msg_.wrench.force.x = force.X() + this->noise_.Gaussian(0, this->gaussian_noise_);
+  this->wrench_msg_.wrench.force.y = force.Y() + this->noise_.Gaussian(0, this->gaussian_noise_);
+  this->wrench_msg_.wrench.force.z = force.Z() + this->noise_.Gaussian(0, this->gaussian_noise_);
+  this->wrench_msg_.wrench.torque.x = torque.X() + this->noise_.Gaussian(0, this->gaussian_noise_);
+  this->wrench_msg_.wrench.torque.y = torque.Y() + this->noise_.Gaussian(0, this->gaussian_noise_);
+  this->wrench_msg_.wrench.torque.z = torque.Z() + this->noise_.Gaussian(0, this->gaussian_noise_);
+  GAZEBO_ROS_PROFILE_END();
+  GAZEBO_ROS_PROFILE_BEGIN("publish");
+  if (this->ft_connect_count_ > 0)
+    this->pub_.publish(this->wrench_msg_);
+  GAZEBO_ROS_PROFILE_END();
   this->lock_.unlock();
 
   // save last time stamp
   this->last_time_ = cur_time;
 }
 
-//////////////////////////////////////////////////////////////////////////////
-// Utility for adding noise
-double GazeboRosFT::GaussianKernel(double mu, double sigma)
-{
-  // using Box-Muller transform to generate two independent standard
-  // normally disbributed normal variables see wikipedia
-
-  // normalized uniform random variable
-  double U = ignition::math::Rand::DblUniform();
-
-  // normalized uniform random variable
-  double V = ignition::math::Rand::DblUniform();
-
-  double X = sqrt(-2.0 * ::log(U)) * cos(2.0*M_PI * V);
-  // double Y = sqrt(-2.0 * ::log(U)) * sin(2.0*M_PI * V);
-
-  // there are 2 indep. vars, we'll just use X
-  // scale to our mu and sigma
-  X = sigma * X + mu;
-  return X;
-}
-
-// Custom Callback Queue
-////////////////////////////////////////////////////////////////////////////////
-// custom callback queue thread
-void GazeboRosFT::QueueThread()
-{
-  static const double timeout = 0.01;
-
-  while (this->rosnode_->ok())
-  {
-    this->queue_.callAvailable(ros::WallDuration(timeout));
-  }
-}
 
 }
@@ -0,0 +1,140 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <string>
+
+#include <gazebo/transport/transport.hh>
+
+#include <gazebo_plugins/gazebo_ros_gpu_range.h>
+
+namespace gazebo
+{
+// Register this plugin with the simulator
+GZ_REGISTER_SENSOR_PLUGIN(GazeboRosGpuRange)
+
+////////////////////////////////////////////////////////////////////////////////
+// Constructor
+GazeboRosGpuRange::GazeboRosGpuRange()
+  : SensorPluginBase("gpu_range"), update_period_(0)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Destructor
+GazeboRosGpuRange::~GazeboRosGpuRange()
+{
+  this->ShutdownRos();
+  this->laser_scan_sub_.reset();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Read the plugin parameters
+bool GazeboRosGpuRange::LoadSdf(sdf::ElementPtr _sdf)
+{
+  this->last_update_time_ = common::Time(0);
+
+  if (!_sdf->HasElement("frameName"))
+  {
+    ROS_INFO_NAMED("gpu_range", "Range plugin missing <frameName>, defaults to /world");
+    this->frame_name_ = "/world";
+  }
+  else
+    this->frame_name_ = _sdf->Get<std::string>("frameName");
+
+  if (!_sdf->HasElement("topicName"))
+  {
+    ROS_INFO_NAMED("gpu_range", "Range plugin missing <topicName>, defaults to /range");
+    this->topic_name_ = "/range";
+  }
+  else
+    this->topic_name_ = _sdf->Get<std::string>("topicName");
+
+  this->cone_.Load(_sdf, this->parent_sensor_->ScopedName(), "gpu_range");
+
+  // the sensor renders at its own <update_rate>, this only thins it out
+  double update_rate = 0;
+  if (_sdf->HasElement("updateRate"))
+    update_rate = _sdf->Get<double>("updateRate");
+  this->update_period_ = update_rate > 0.0 ? 1.0 / update_rate : 0.0;
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Load the controller
+void GazeboRosGpuRange::LoadRos()
+{
+  this->gazebo_node_ = gazebo::transport::NodePtr(new gazebo::transport::Node());
+  this->gazebo_node_->Init(this->world_name_);
+
+  // resolve tf prefix
+  this->frame_name_ = this->ResolveFrame(this->frame_name_);
+
+  if (this->topic_name_ != "")
+    this->range_pub_ = this->Advertise<sensor_msgs::Range>(this->topic_name_);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Subscribe to the scans, the sensor renders while they have a subscriber
+void GazeboRosGpuRange::Activate()
+{
+  this->laser_scan_sub_ =
+    this->gazebo_node_->Subscribe(this->parent_sensor_->Topic(),
+                                  &GazeboRosGpuRange::OnScan, this);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Unsubscribe from the scans
+void GazeboRosGpuRange::Deactivate()
+{
+  this->laser_scan_sub_.reset();
+  this->parent_sensor_->SetActive(false);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Reduce the cone straight out of the protobuf
+void GazeboRosGpuRange::OnScan(ConstLaserScanStampedPtr &_msg)
+{
+  GAZEBO_ROS_PROFILE("GazeboRosGpuRange::OnScan");
+  if (!this->range_pub_ || this->range_pub_->Subscribers() == 0)
+    return;
+
+  const common::Time stamp(_msg->time().sec(), _msg->time().nsec());
+  if (stamp < this->last_update_time_)
+  {
+    ROS_WARN_NAMED("gpu_range", "Negative sensor update time difference detected.");
+    this->last_update_time_ = stamp;
+  }
+  if (stamp - this->last_update_time_ < this->update_period_)
+    return;
+  this->last_update_time_ = stamp;
+
+  ScopedTiming timing(this->update_timing_);
+  const ros::Time ros_stamp(stamp.sec, stamp.nsec);
+  this->range_pub_->TraceLatency(LatencyTracer::SENSOR_CALLBACK, ros_stamp);
+  sensor_msgs::RangePtr range_msg = this->range_pub_->Acquire();
+  range_msg->header.frame_id = this->frame_name_;
+  range_msg->header.stamp = ros_stamp;
+
+  const msgs::LaserScan &scan = _msg->scan();
+  this->cone_.Fill(scan.ranges().data(), scan.ranges_size(),
+                   scan.range_min(), scan.range_max(), *range_msg);
+
+  this->range_pub_->TraceLatency(LatencyTracer::CONVERTED, ros_stamp);
+  this->range_pub_->Publish(range_msg);
+}
+}
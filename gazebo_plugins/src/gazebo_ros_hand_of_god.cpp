@@ -41,9 +41,8 @@
  */
 
 #include <gazebo_plugins/gazebo_ros_hand_of_god.h>
-#ifdef ENABLE_PROFILER
-#include <ignition/common/Profiler.hh>
-#endif
+#include <gazebo_plugins/gazebo_ros_utils.h>
+#include <gazebo_ros/profiler.h>
 #include <ros/ros.h>
 
 namespace gazebo
@@ -58,7 +57,12 @@ namespace gazebo
     robot_namespace_(""),
     frame_id_("hog"),
     kl_(200),
-    ka_(200)
+    ka_(200),
+    rosnode_(NULL),
+    has_target_(false),
+    errored_(false),
+    lookup_rate_(0),
+    actual_rate_(0)
   {
   }
 
@@ -66,12 +70,22 @@ namespace gazebo
   // Destructor
   GazeboRosHandOfGod::~GazeboRosHandOfGod()
   {
+    this->update_connection_.reset();
+    if (this->rosnode_)
+    {
+      this->queue_.clear();
+      this->queue_.disable();
+      this->rosnode_->shutdown();
+      this->queue_.Stop();
+      delete this->rosnode_;
+    }
   }
 
   ////////////////////////////////////////////////////////////////////////////////
   // Load the controller
   void GazeboRosHandOfGod::Load( physics::ModelPtr _parent, sdf::ElementPtr _sdf )
   {
+    GAZEBO_ROS_STARTUP_PHASE("load");
     // Make sure the ROS node for Gazebo has already been initalized
     if (!ros::isInitialized()) {
       ROS_FATAL_STREAM_NAMED("hand_of_god", "A ROS node for Gazebo has not been initialized, unable to load plugin. "
@@ -95,6 +109,16 @@ namespace gazebo
       this->ka_ = _sdf->Get<double>("ka");
     }
 
+    if(_sdf->HasElement("targetTopic")) {
+      this->target_topic_ = _sdf->Get<std::string>("targetTopic");
+    }
+    if(_sdf->HasElement("targetLookupRate")) {
+      this->lookup_rate_ = _sdf->Get<double>("targetLookupRate");
+    }
+    if(_sdf->HasElement("actualTfRate")) {
+      this->actual_rate_ = _sdf->Get<double>("actualTfRate");
+    }
+
     if(_sdf->HasElement("linkName")) {
       this->link_name_ = _sdf->Get<std::string>("linkName");
     } else {
@@ -107,8 +131,6 @@ namespace gazebo
 
     // Get the floating link
     floating_link_ = model_->GetLink(link_name_);
-    // Disable gravity for the hog
-    floating_link_->SetGravityMode(false);
     if(!floating_link_) {
       ROS_ERROR_NAMED("hand_of_god", "Floating link not found");
       const std::vector<physics::LinkPtr> &links = model_->GetLinks();
@@ -117,6 +139,8 @@ namespace gazebo
       }
       return;
     }
+    // Disable gravity for the hog
+    floating_link_->SetGravityMode(false);
 
 #if GAZEBO_MAJOR_VERSION >= 8
     cl_ = 2.0 * sqrt(kl_*floating_link_->GetInertial()->Mass());
@@ -126,45 +150,110 @@ namespace gazebo
     ca_ = 2.0 * sqrt(ka_*floating_link_->GetInertial()->GetIXX());
 #endif
 
-    // Create the TF listener for the desired position of the hog
-    tf_buffer_.reset(new tf2_ros::Buffer());
-    tf_listener_.reset(new tf2_ros::TransformListener(*tf_buffer_));
+    if (this->target_topic_.empty())
+    {
+      // Create the TF listener for the desired position of the hog
+      tf_buffer_.reset(new tf2_ros::Buffer());
+      tf_listener_.reset(new tf2_ros::TransformListener(*tf_buffer_));
+    }
+    else
+    {
+      // Subscribe to the desired pose of the hog
+      this->rosnode_ = new ros::NodeHandle(this->robot_namespace_);
+      this->target_.SetLatencyStage(TimingRegistry::instance().stage(
+        "gazebo_ros_hand_of_god " + this->rosnode_->resolveName(this->target_topic_),
+        "command_latency"));
+      ros::SubscribeOptions so = ros::SubscribeOptions::create<geometry_msgs::PoseStamped>(
+        this->target_topic_, 1,
+        boost::bind(&GazeboRosHandOfGod::OnTarget, this, _1),
+        ros::VoidPtr(), &this->queue_);
+      GetSubscriptionHints(*this->rosnode_, _sdf).apply(so);
+      this->target_sub_ = this->rosnode_->subscribe(so);
+    }
     tf_broadcaster_.reset(new tf2_ros::TransformBroadcaster());
 
+    hog_actual_tform_.header.frame_id = "world";
+    hog_actual_tform_.child_frame_id = frame_id_ + "_actual";
+
     // Register update event handler
     this->update_connection_ = event::Events::ConnectWorldUpdateBegin(
         boost::bind(&GazeboRosHandOfGod::GazeboUpdate, this));
   }
 
   ////////////////////////////////////////////////////////////////////////////////
-  // Update the controller
-  void GazeboRosHandOfGod::GazeboUpdate()
+  // Store a new target
+  void GazeboRosHandOfGod::OnTarget(const geometry_msgs::PoseStamped::ConstPtr &_msg)
+  {
+    const geometry_msgs::Point &p = _msg->pose.position;
+    const geometry_msgs::Quaternion &q = _msg->pose.orientation;
+    const double values[7] = {p.x, p.y, p.z, q.w, q.x, q.y, q.z};
+    this->target_.Write(values);
+  }
+
+  ////////////////////////////////////////////////////////////////////////////////
+  // Read the latest target
+  void GazeboRosHandOfGod::ReadTarget()
+  {
+    double v[7];
+    if (!this->target_.Read(v))
+      return;
+    this->hog_desired_.Set(
+        ignition::math::Vector3d(v[0], v[1], v[2]),
+        ignition::math::Quaterniond(v[3], v[4], v[5], v[6]));
+    this->has_target_ = true;
+  }
+
+  ////////////////////////////////////////////////////////////////////////////////
+  // Look the target up in tf
+  bool GazeboRosHandOfGod::LookupTarget()
   {
-#ifdef ENABLE_PROFILER
-    IGN_PROFILE("GazeboRosHandOfGod::GazeboUpdate");
-#endif
     // Get TF transform relative to the /world link
     geometry_msgs::TransformStamped hog_desired_tform;
-    static bool errored = false;
     try{
       hog_desired_tform = tf_buffer_->lookupTransform("world", frame_id_+"_desired", ros::Time(0));
-      errored = false;
+      errored_ = false;
     } catch (tf2::TransformException ex){
-      if(!errored) {
+      if(!errored_) {
         ROS_ERROR_NAMED("hand_of_god", "%s",ex.what());
-        errored = true;
+        errored_ = true;
       }
-      return;
+      return false;
     }
-#ifdef ENABLE_PROFILER
-    IGN_PROFILE_BEGIN("Convert TF transform to Gazebo Pose");
-#endif
     // Convert TF transform to Gazebo Pose
     const geometry_msgs::Vector3 &p = hog_desired_tform.transform.translation;
     const geometry_msgs::Quaternion &q = hog_desired_tform.transform.rotation;
-    ignition::math::Pose3d hog_desired(
+    hog_desired_.Set(
         ignition::math::Vector3d(p.x, p.y, p.z),
         ignition::math::Quaterniond(q.w, q.x, q.y, q.z));
+    return true;
+  }
+
+  ////////////////////////////////////////////////////////////////////////////////
+  // Update the controller
+  void GazeboRosHandOfGod::GazeboUpdate()
+  {
+    GAZEBO_ROS_PROFILE("GazeboRosHandOfGod::GazeboUpdate");
+#if GAZEBO_MAJOR_VERSION >= 8
+    common::Time cur_time = model_->GetWorld()->SimTime();
+#else
+    common::Time cur_time = model_->GetWorld()->GetSimTime();
+#endif
+
+    if (!target_topic_.empty())
+    {
+      ReadTarget();
+    }
+    else if (!has_target_ || lookup_rate_ <= 0 || cur_time < last_lookup_time_ ||
+             (cur_time - last_lookup_time_).Double() >= 1.0 / lookup_rate_)
+    {
+      has_target_ = LookupTarget();
+      last_lookup_time_ = cur_time;
+    }
+    if (!has_target_)
+      return;
+
+    GAZEBO_ROS_PROFILE_BEGIN("Convert TF transform to Gazebo Pose");
+    const ignition::math::Pose3d &hog_desired = hog_desired_;
 
     // Relative transform from actual to desired pose
 #if GAZEBO_MAJOR_VERSION >= 8
@@ -181,10 +270,7 @@ namespace gazebo
     ignition::math::Quaterniond err_rot =  (ignition::math::Matrix4d(world_pose.Rot()).Inverse()
                                           * ignition::math::Matrix4d(hog_desired.Rot())).Rotation();
     ignition::math::Quaterniond not_a_quaternion = err_rot.Log();
-#ifdef ENABLE_PROFILER
-    IGN_PROFILE_END();
-    IGN_PROFILE_BEGIN("fill ROS message");
-#endif
+    GAZEBO_ROS_PROFILE_END();
     floating_link_->AddForce(
         kl_ * err_pos - cl_ * worldLinearVel);
 
@@ -192,30 +278,28 @@ namespace gazebo
         ka_ * ignition::math::Vector3d(not_a_quaternion.X(), not_a_quaternion.Y(), not_a_quaternion.Z())
       - ca_ * relativeAngularVel);
 
-    // Convert actual pose to TransformStamped message
-    geometry_msgs::TransformStamped hog_actual_tform;
-
-    hog_actual_tform.header.frame_id = "world";
-    hog_actual_tform.header.stamp = ros::Time::now();
+    // rate control of the actual pose
+    if (actual_rate_ > 0 && cur_time >= last_actual_time_ &&
+        (cur_time - last_actual_time_).Double() < 1.0 / actual_rate_)
+      return;
+    last_actual_time_ = cur_time;
 
-    hog_actual_tform.child_frame_id = frame_id_ + "_actual";
+    GAZEBO_ROS_PROFILE_BEGIN("fill ROS message");
+    // Convert actual pose to TransformStamped message
+    hog_actual_tform_.header.stamp = ros::Time::now();
 
-    hog_actual_tform.transform.translation.x = world_pose.Pos().X();
-    hog_actual_tform.transform.translation.y = world_pose.Pos().Y();
-    hog_actual_tform.transform.translation.z = world_pose.Pos().Z();
+    hog_actual_tform_.transform.translation.x = world_pose.Pos().X();
+    hog_actual_tform_.transform.translation.y = world_pose.Pos().Y();
+    hog_actual_tform_.transform.translation.z = world_pose.Pos().Z();
 
-    hog_actual_tform.transform.rotation.w = world_pose.Rot().W();
-    hog_actual_tform.transform.rotation.x = world_pose.Rot().X();
-    hog_actual_tform.transform.rotation.y = world_pose.Rot().Y();
-    hog_actual_tform.transform.rotation.z = world_pose.Rot().Z();
-#ifdef ENABLE_PROFILER
-    IGN_PROFILE_END();
-    IGN_PROFILE_BEGIN("sendTransform");
-#endif
-    tf_broadcaster_->sendTransform(hog_actual_tform);
-#ifdef ENABLE_PROFILER
-    IGN_PROFILE_END();
-#endif
+    hog_actual_tform_.transform.rotation.w = world_pose.Rot().W();
+    hog_actual_tform_.transform.rotation.x = world_pose.Rot().X();
+    hog_actual_tform_.transform.rotation.y = world_pose.Rot().Y();
+    hog_actual_tform_.transform.rotation.z = world_pose.Rot().Z();
+    GAZEBO_ROS_PROFILE_END();
+    GAZEBO_ROS_PROFILE_BEGIN("sendTransform");
+    tf_broadcaster_->sendTransform(hog_actual_tform_);
+    GAZEBO_ROS_PROFILE_END();
   }
 
 }
@@ -16,12 +16,11 @@
 */
 #include <gazebo/physics/World.hh>
 #include <gazebo/physics/Model.hh>
-#ifdef ENABLE_PROFILER
-#include <ignition/common/Profiler.hh>
-#endif
+#include <gazebo_ros/profiler.h>
 #include <sdf/sdf.hh>
 
 #include "gazebo_plugins/gazebo_ros_harness.h"
+#include <gazebo_plugins/gazebo_ros_utils.h>
 
 namespace gazebo
 {
@@ -40,6 +39,7 @@ GazeboRosHarness::~GazeboRosHarness()
   // Custom Callback Queue
   this->queue_.clear();
   this->queue_.disable();
+  this->queue_.Stop();
 
   this->rosnode_->shutdown();
   delete this->rosnode_;
@@ -49,6 +49,7 @@ GazeboRosHarness::~GazeboRosHarness()
 // Load the controller
 void GazeboRosHarness::Load(physics::ModelPtr _parent, sdf::ElementPtr _sdf)
 {
+  GAZEBO_ROS_STARTUP_PHASE("load");
   // Load the plugin
   HarnessPlugin::Load(_parent, _sdf);
 
@@ -66,36 +67,32 @@ void GazeboRosHarness::Load(physics::ModelPtr _parent, sdf::ElementPtr _sdf)
   }
 
   this->rosnode_ = new ros::NodeHandle(this->robotNamespace_);
+  const SubscriptionHints hints = GetSubscriptionHints(*this->rosnode_, _sdf);
 
   ros::SubscribeOptions so = ros::SubscribeOptions::create<std_msgs::Float32>(
       "/" + _parent->GetName() + "/harness/velocity", 1,
     boost::bind(&GazeboRosHarness::OnVelocity, this, _1),
     ros::VoidPtr(), &this->queue_);
+  hints.apply(so);
   this->velocitySub_ = this->rosnode_->subscribe(so);
 
   so = ros::SubscribeOptions::create<std_msgs::Bool>(
     "/" + _parent->GetName() + "/harness/detach", 1,
     boost::bind(&GazeboRosHarness::OnDetach, this, _1),
     ros::VoidPtr(), &this->queue_);
+  hints.apply(so);
   this->detachSub_ = this->rosnode_->subscribe(so);
 
-  // Custom Callback Queue
-  this->callbackQueueThread_ =
-    boost::thread(boost::bind(&GazeboRosHarness::QueueThread, this));
 }
 
 /////////////////////////////////////////////////
 void GazeboRosHarness::OnVelocity(const std_msgs::Float32::ConstPtr &msg)
 {
-#ifdef ENABLE_PROFILER
-  IGN_PROFILE("GazeboRosHarness::OnVelocity");
-  IGN_PROFILE_BEGIN("process ROS message");
-#endif
+  GAZEBO_ROS_PROFILE("GazeboRosHarness::OnVelocity");
+  GAZEBO_ROS_PROFILE_BEGIN("process ROS message");
   // Set the target winch velocity
   this->SetWinchVelocity(msg->data);
-#ifdef ENABLE_PROFILER
-  IGN_PROFILE_END();
-#endif
+  GAZEBO_ROS_PROFILE_END();
 }
 
 /////////////////////////////////////////////////
@@ -106,14 +103,4 @@ void GazeboRosHarness::OnDetach(const std_msgs::Bool::ConstPtr &msg)
     this->Detach();
 }
 
-/////////////////////////////////////////////////
-void GazeboRosHarness::QueueThread()
-{
-  static const double timeout = 0.01;
-
-  while (this->rosnode_->ok())
-  {
-    this->queue_.callAvailable(ros::WallDuration(timeout));
-  }
-}
 }
@@ -21,10 +21,9 @@
  */
 
 #include <gazebo_plugins/gazebo_ros_imu.h>
-#include <ignition/math/Rand.hh>
-#ifdef ENABLE_PROFILER
-#include <ignition/common/Profiler.hh>
-#endif
+#include <gazebo_plugins/gazebo_ros_utils.h>
+#include <gazebo_plugins/sensor_recorder.h>
+#include <gazebo_ros/profiler.h>
 
 namespace gazebo
 {
@@ -41,10 +40,12 @@ GazeboRosIMU::GazeboRosIMU()
 // Destructor
 GazeboRosIMU::~GazeboRosIMU()
 {
+  if (this->deferred_load_task_)
+    this->deferred_load_task_->Wait();
   this->update_connection_.reset();
   // Finalize the controller
   this->rosnode_->shutdown();
-  this->callback_queue_thread_.join();
+  this->imu_queue_.Stop();
   delete this->rosnode_;
 }
 
@@ -52,13 +53,15 @@ GazeboRosIMU::~GazeboRosIMU()
 // Load the controller
 void GazeboRosIMU::Load(physics::ModelPtr _parent, sdf::ElementPtr _sdf)
 {
+  GAZEBO_ROS_STARTUP_PHASE("load");
   // save pointers
   this->world_ = _parent->GetWorld();
   this->sdf = _sdf;
+  this->noise_.Seed(GaussianNoise::SeedFromSdf(_sdf, _parent->GetScopedName()));
 
   // ros callback queue for processing subscription
-  this->deferred_load_thread_ = boost::thread(
-    boost::bind(&GazeboRosIMU::LoadThread, this));
+  this->deferred_load_task_ = DeferredLoad::Instance().Run(
+    this->handleName, boost::bind(&GazeboRosIMU::LoadThread, this));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -85,6 +88,7 @@ void GazeboRosIMU::LoadThread()
   }
   else
     this->topic_name_ = this->sdf->Get<std::string>("topicName");
+  this->batch_.Load(this->sdf, this->topic_name_);
 
   if (!this->sdf->HasElement("gaussianNoise"))
   {
@@ -146,7 +150,7 @@ void GazeboRosIMU::LoadThread()
   this->rosnode_ = new ros::NodeHandle(this->robot_namespace_);
 
   // publish multi queue
-  this->pmq.startServiceThread();
+  this->pmq.startService();
 
   // assert that the body by link_name_ exists
   this->link = boost::dynamic_pointer_cast<physics::Link>(
@@ -176,6 +180,7 @@ void GazeboRosIMU::LoadThread()
       this, _1, _2), ros::VoidPtr(), &this->imu_queue_);
     this->srv_ = this->rosnode_->advertiseService(aso);
   }
+  this->batch_.Advertise(*this->rosnode_);
 
   // Initialize the controller
 #if GAZEBO_MAJOR_VERSION >= 8
@@ -195,11 +200,6 @@ void GazeboRosIMU::LoadThread()
   this->apos_ = 0;
   this->aeul_ = 0;
 
-  // start custom queue for imu
-  this->callback_queue_thread_ =
-    boost::thread(boost::bind(&GazeboRosIMU::IMUQueueThread, this));
-
-
   // New Mechanism for Updating every World Cycle
   // Listen to the update event. This event is broadcast every
   // simulation iteration.
@@ -219,9 +219,7 @@ bool GazeboRosIMU::ServiceCallback(std_srvs::Empty::Request &req,
 // Update the controller
 void GazeboRosIMU::UpdateChild()
 {
-#ifdef ENABLE_PROFILER
-  IGN_PROFILE("GazeboRosIMU::UpdateChild");
-#endif
+  GAZEBO_ROS_PROFILE("GazeboRosIMU::UpdateChild");
 #if GAZEBO_MAJOR_VERSION >= 8
   common::Time cur_time = this->world_->SimTime();
 #else
@@ -233,11 +231,15 @@ void GazeboRosIMU::UpdateChild()
       (cur_time - this->last_time_).Double() < (1.0 / this->update_rate_))
     return;
 
-  if ((this->pub_.getNumSubscribers() > 0 && this->topic_name_ != ""))
+  const bool publish_single =
+    this->pub_.getNumSubscribers() > 0 && this->topic_name_ != "";
+  const bool publish_batch = this->batch_.Active();
+  if (!publish_batch)
+    this->batch_.Reset();
+
+  if (publish_single || publish_batch)
   {
-#ifdef ENABLE_PROFILER
-    IGN_PROFILE_BEGIN("fill ROS message");
-#endif
+    GAZEBO_ROS_PROFILE_BEGIN("fill ROS message");
     ignition::math::Pose3d pose;
     ignition::math::Quaterniond rot;
     ignition::math::Vector3d pos;
@@ -295,9 +297,9 @@ void GazeboRosIMU::UpdateChild()
 
     // pass euler angular rates
     ignition::math::Vector3d linear_velocity(
-      veul.X() + this->GaussianKernel(0, this->gaussian_noise_),
-      veul.Y() + this->GaussianKernel(0, this->gaussian_noise_),
-      veul.Z() + this->GaussianKernel(0, this->gaussian_noise_));
+      veul.X() + this->noise_.Gaussian(0, this->gaussian_noise_),
+      veul.Y() + this->noise_.Gaussian(0, this->gaussian_noise_),
+      veul.Z() + this->noise_.Gaussian(0, this->gaussian_noise_));
     // rotate into local frame
     // @todo: deal with offsets!
     linear_velocity = rot.RotateVector(linear_velocity);
@@ -307,9 +309,9 @@ void GazeboRosIMU::UpdateChild()
 
     // pass accelerations
     ignition::math::Vector3d linear_acceleration(
-      apos_.X() + this->GaussianKernel(0, this->gaussian_noise_),
-      apos_.Y() + this->GaussianKernel(0, this->gaussian_noise_),
-      apos_.Z() + this->GaussianKernel(0, this->gaussian_noise_));
+      apos_.X() + this->noise_.Gaussian(0, this->gaussian_noise_),
+      apos_.Y() + this->noise_.Gaussian(0, this->gaussian_noise_),
+      apos_.Z() + this->noise_.Gaussian(0, this->gaussian_noise_));
     // rotate into local frame
     // @todo: deal with offsets!
     linear_acceleration = rot.RotateVector(linear_acceleration);
@@ -334,50 +336,20 @@ void GazeboRosIMU::UpdateChild()
     {
       boost::mutex::scoped_lock lock(this->lock_);
       // publish to ros
-      if (this->pub_.getNumSubscribers() > 0 && this->topic_name_ != "")
-          this->pub_Queue->push(this->imu_msg_, this->pub_);
+      if (publish_batch)
+        this->batch_.Add(this->imu_msg_);
+      if (this->batch_.SingleDue() && publish_single)
+      {
+        SensorRecorder::Instance().Record(this->pub_, this->imu_msg_);
+        this->pub_Queue->push(this->imu_msg_, this->pub_);
+      }
     }
 
     // save last time stamp
     this->last_time_ = cur_time;
-#ifdef ENABLE_PROFILER
-    IGN_PROFILE_END();
-#endif
+    GAZEBO_ROS_PROFILE_END();
   }
 }
 
 
-//////////////////////////////////////////////////////////////////////////////
-// Utility for adding noise
-double GazeboRosIMU::GaussianKernel(double mu, double sigma)
-{
-  // using Box-Muller transform to generate two independent standard
-  // normally disbributed normal variables see wikipedia
-
-  // normalized uniform random variable
-  double U = ignition::math::Rand::DblUniform();
-
-  // normalized uniform random variable
-  double V = ignition::math::Rand::DblUniform();
-
-  double X = sqrt(-2.0 * ::log(U)) * cos(2.0*M_PI * V);
-  // double Y = sqrt(-2.0 * ::log(U)) * sin(2.0*M_PI * V);
-
-  // there are 2 indep. vars, we'll just use X
-  // scale to our mu and sigma
-  X = sigma * X + mu;
-  return X;
-}
-
-////////////////////////////////////////////////////////////////////////////////
-// Put laser data to the interface
-void GazeboRosIMU::IMUQueueThread()
-{
-  static const double timeout = 0.01;
-
-  while (this->rosnode_->ok())
-  {
-    this->imu_queue_.callAvailable(ros::WallDuration(timeout));
-  }
-}
 }
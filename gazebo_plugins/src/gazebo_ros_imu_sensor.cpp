@@ -15,13 +15,11 @@
  * limitations under the License.*/
 
 #include <gazebo_plugins/gazebo_ros_imu_sensor.h>
+#include <gazebo_plugins/gazebo_ros_utils.h>
 #include <iostream>
 #include <gazebo/sensors/ImuSensor.hh>
 #include <gazebo/physics/World.hh>
-#ifdef ENABLE_PROFILER
-#include <ignition/common/Profiler.hh>
-#endif
-#include <ignition/math/Rand.hh>
+#include <gazebo_ros/profiler.h>
 
 GZ_REGISTER_SENSOR_PLUGIN(gazebo::GazeboRosImuSensor)
 
@@ -35,7 +33,9 @@ gazebo::GazeboRosImuSensor::GazeboRosImuSensor(): SensorPlugin()
 
 void gazebo::GazeboRosImuSensor::Load(gazebo::sensors::SensorPtr sensor_, sdf::ElementPtr sdf_)
 {
+  GAZEBO_ROS_STARTUP_PHASE("load");
   sdf=sdf_;
+  noise.Seed(gazebo::GaussianNoise::SeedFromSdf(sdf, sensor_->ScopedName()));
   sensor=dynamic_cast<gazebo::sensors::ImuSensor*>(sensor_.get());
 
   if(sensor==NULL)
@@ -80,47 +80,58 @@ void gazebo::GazeboRosImuSensor::Load(gazebo::sensors::SensorPtr sensor_, sdf::E
     return;
   }
 
+  if (DeferredLoad::Requested(sdf))
+    deferred_load_task = DeferredLoad::Instance().Run(this->handleName,
+      boost::bind(&GazeboRosImuSensor::LoadThread, this));
+  else
+    LoadThread();
+}
+
+void gazebo::GazeboRosImuSensor::LoadThread()
+{
   node = new ros::NodeHandle(this->robot_namespace);
 
   imu_data_publisher = node->advertise<sensor_msgs::Imu>(topic_name,1);
-
-  connection = gazebo::event::Events::ConnectWorldUpdateBegin(boost::bind(&GazeboRosImuSensor::UpdateChild, this, _1));
+  batch.Advertise(*node);
 
   last_time = sensor->LastUpdateTime();
+
+  connection = gazebo::event::Events::ConnectWorldUpdateBegin(boost::bind(&GazeboRosImuSensor::UpdateChild, this, _1));
 }
 
 void gazebo::GazeboRosImuSensor::UpdateChild(const gazebo::common::UpdateInfo &/*_info*/)
 {
-#ifdef ENABLE_PROFILER
-  IGN_PROFILE("GazeboRosImuSensor::UpdateChild");
-#endif
+  GAZEBO_ROS_PROFILE("GazeboRosImuSensor::UpdateChild");
   common::Time current_time = sensor->LastUpdateTime();
 
   if(update_rate>0 && (current_time-last_time).Double() < 1.0/update_rate) //update rate check
     return;
 
-  if(imu_data_publisher.getNumSubscribers() > 0)
+  const bool publish_single = imu_data_publisher.getNumSubscribers() > 0;
+  const bool publish_batch = batch.Active();
+  if(!publish_batch)
+    batch.Reset();
+
+  if(publish_single || publish_batch)
   {
-#ifdef ENABLE_PROFILER
-    IGN_PROFILE_BEGIN("fill ROS message");
-#endif
+    GAZEBO_ROS_PROFILE_BEGIN("fill ROS message");
     orientation = offset.Rot()*sensor->Orientation(); //applying offsets to the orientation measurement
     accelerometer_data = sensor->LinearAcceleration();
     gyroscope_data = sensor->AngularVelocity();
 
     //Guassian noise is applied to all measurements
-    imu_msg.orientation.x = orientation.X() + GuassianKernel(0,gaussian_noise);
-    imu_msg.orientation.y = orientation.Y() + GuassianKernel(0,gaussian_noise);
-    imu_msg.orientation.z = orientation.Z() + GuassianKernel(0,gaussian_noise);
-    imu_msg.orientation.w = orientation.W() + GuassianKernel(0,gaussian_noise);
+    imu_msg.orientation.x = orientation.X() + noise.Gaussian(0,gaussian_noise);
+    imu_msg.orientation.y = orientation.Y() + noise.Gaussian(0,gaussian_noise);
+    imu_msg.orientation.z = orientation.Z() + noise.Gaussian(0,gaussian_noise);
+    imu_msg.orientation.w = orientation.W() + noise.Gaussian(0,gaussian_noise);
 
-    imu_msg.linear_acceleration.x = accelerometer_data.X() + GuassianKernel(0,gaussian_noise);
-    imu_msg.linear_acceleration.y = accelerometer_data.Y() + GuassianKernel(0,gaussian_noise);
-    imu_msg.linear_acceleration.z = accelerometer_data.Z() + GuassianKernel(0,gaussian_noise);
+    imu_msg.linear_acceleration.x = accelerometer_data.X() + noise.Gaussian(0,gaussian_noise);
+    imu_msg.linear_acceleration.y = accelerometer_data.Y() + noise.Gaussian(0,gaussian_noise);
+    imu_msg.linear_acceleration.z = accelerometer_data.Z() + noise.Gaussian(0,gaussian_noise);
 
-    imu_msg.angular_velocity.x = gyroscope_data.X() + GuassianKernel(0,gaussian_noise);
-    imu_msg.angular_velocity.y = gyroscope_data.Y() + GuassianKernel(0,gaussian_noise);
-    imu_msg.angular_velocity.z = gyroscope_data.Z() + GuassianKernel(0,gaussian_noise);
+    imu_msg.angular_velocity.x = gyroscope_data.X() + noise.Gaussian(0,gaussian_noise);
+    imu_msg.angular_velocity.y = gyroscope_data.Y() + noise.Gaussian(0,gaussian_noise);
+    imu_msg.angular_velocity.z = gyroscope_data.Z() + noise.Gaussian(0,gaussian_noise);
 
     //covariance is related to the Gaussian noise
     double gn2 = gaussian_noise*gaussian_noise;
@@ -138,35 +149,20 @@ void gazebo::GazeboRosImuSensor::UpdateChild(const gazebo::common::UpdateInfo &/
     imu_msg.header.frame_id = body_name;
     imu_msg.header.stamp.sec = current_time.sec;
     imu_msg.header.stamp.nsec = current_time.nsec;
-#ifdef ENABLE_PROFILER
-    IGN_PROFILE_END();
+    GAZEBO_ROS_PROFILE_END();
     //publishing data
-    IGN_PROFILE_BEGIN("publish");
-#endif
-    imu_data_publisher.publish(imu_msg);
-#ifdef ENABLE_PROFILER
-    IGN_PROFILE_END();
-#endif
+    GAZEBO_ROS_PROFILE_BEGIN("publish");
+    if(publish_batch)
+      batch.Add(imu_msg);
+    if(batch.SingleDue() && publish_single)
+      imu_data_publisher.publish(imu_msg);
+    GAZEBO_ROS_PROFILE_END();
     ros::spinOnce();
   }
 
   last_time = current_time;
 }
 
-double gazebo::GazeboRosImuSensor::GuassianKernel(double mu, double sigma)
-{
-  // generation of two normalized uniform random variables
-  double U1 = ignition::math::Rand::DblUniform();
-  double U2 = ignition::math::Rand::DblUniform();
-
-  // using Box-Muller transform to obtain a varaible with a standard normal distribution
-  double Z0 = sqrt(-2.0 * ::log(U1)) * cos(2.0*M_PI * U2);
-
-  // scaling
-  Z0 = sigma * Z0 + mu;
-  return Z0;
-}
-
 bool gazebo::GazeboRosImuSensor::LoadParameters()
 {
   //loading parameters from the sdf file
@@ -197,6 +193,7 @@ bool gazebo::GazeboRosImuSensor::LoadParameters()
     topic_name = "imu_data";
     ROS_WARN_STREAM("missing <topicName>, set to /namespace/default: " << topic_name);
   }
+  batch.Load(sdf, topic_name);
 
   //BODY NAME
   if (sdf->HasElement("frameName"))
@@ -263,6 +260,9 @@ bool gazebo::GazeboRosImuSensor::LoadParameters()
 
 gazebo::GazeboRosImuSensor::~GazeboRosImuSensor()
 {
+  if (deferred_load_task)
+    deferred_load_task->Wait();
+
   if (connection.get())
   {
     connection.reset();
@@ -21,15 +21,15 @@
  * Date: 1 June 2008
  */
 
+#include <algorithm>
 #include <string>
 #include <stdlib.h>
 #include <tf/tf.h>
 
 #include <gazebo_plugins/gazebo_ros_joint_pose_trajectory.h>
+#include <gazebo_plugins/gazebo_ros_utils.h>
 
-#ifdef ENABLE_PROFILER
-#include <ignition/common/Profiler.hh>
-#endif
+#include <gazebo_ros/profiler.h>
 
 namespace gazebo
 {
@@ -45,18 +45,22 @@ ROS_DEPRECATED GazeboRosJointPoseTrajectory::GazeboRosJointPoseTrajectory()  //
   this->joint_trajectory_.points.clear();
   this->physics_engine_enabled_ = true;
   this->disable_physics_updates_ = true;
+  this->next_setpoint_ = 0;
+  this->playback_rate_ = 0;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 // Destructor
 GazeboRosJointPoseTrajectory::~GazeboRosJointPoseTrajectory()
 {
+  if (this->deferred_load_task_)
+    this->deferred_load_task_->Wait();
   this->update_connection_.reset();
   // Finalize the controller
   this->rosnode_->shutdown();
   this->queue_.clear();
   this->queue_.disable();
-  this->callback_queue_thread_.join();
+  this->queue_.Stop();
   delete this->rosnode_;
 }
 
@@ -65,6 +69,7 @@ GazeboRosJointPoseTrajectory::~GazeboRosJointPoseTrajectory()
 void GazeboRosJointPoseTrajectory::Load(physics::ModelPtr _model,
   sdf::ElementPtr _sdf)
 {
+  GAZEBO_ROS_STARTUP_PHASE("load");
   // save pointers
   this->model_ = _model;
   this->sdf = _sdf;
@@ -102,6 +107,9 @@ void GazeboRosJointPoseTrajectory::Load(physics::ModelPtr _model,
   else
     this->update_rate_ = this->sdf->Get<double>("updateRate");
 
+  if (this->sdf->HasElement("playbackRate"))
+    this->playback_rate_ = this->sdf->Get<double>("playbackRate");
+
   // Make sure the ROS node for Gazebo has already been initialized
   if (!ros::isInitialized())
   {
@@ -110,8 +118,8 @@ void GazeboRosJointPoseTrajectory::Load(physics::ModelPtr _model,
     return;
   }
 
-  this->deferred_load_thread_ = boost::thread(
-    boost::bind(&GazeboRosJointPoseTrajectory::LoadThread, this));
+  this->deferred_load_task_ = DeferredLoad::Instance().Run(
+    this->handleName, boost::bind(&GazeboRosJointPoseTrajectory::LoadThread, this));
 
 }
 
@@ -132,6 +140,7 @@ void GazeboRosJointPoseTrajectory::LoadThread()
       this->topic_name_, 100, boost::bind(
       &GazeboRosJointPoseTrajectory::SetTrajectory, this, _1),
       ros::VoidPtr(), &this->queue_);
+    GetSubscriptionHints(*this->rosnode_, this->sdf).apply(trajectory_so);
     this->sub_ = this->rosnode_->subscribe(trajectory_so);
   }
 
@@ -153,10 +162,6 @@ void GazeboRosJointPoseTrajectory::LoadThread()
   this->last_time_ = this->world_->GetSimTime();
 #endif
 
-  // start custom queue for joint trajectory plugin ros topics
-  this->callback_queue_thread_ =
-    boost::thread(boost::bind(&GazeboRosJointPoseTrajectory::QueueThread, this));
-
   // New Mechanism for Updating every World Cycle
   // Listen to the update event. This event is broadcast every
   // simulation iteration.
@@ -169,74 +174,128 @@ void GazeboRosJointPoseTrajectory::LoadThread()
 void GazeboRosJointPoseTrajectory::SetTrajectory(
   const trajectory_msgs::JointTrajectory::ConstPtr& trajectory)
 {
-  boost::mutex::scoped_lock lock(this->update_mutex);
+  // prepare the playback outside of the lock, the update keeps playing
+  boost::shared_ptr<Playback> playback(new Playback);
+  playback->model = this->model_;
 
-  this->reference_link_name_ = trajectory->header.frame_id;
+  std::string reference_link_name = trajectory->header.frame_id;
   // do this every time a new joint trajectory is supplied,
   // use header.frame_id as the reference_link_name_
-  if (this->reference_link_name_ != "world" &&
-      this->reference_link_name_ != "/map" &&
-      this->reference_link_name_ != "map")
+  if (reference_link_name != "world" &&
+      reference_link_name != "/map" &&
+      reference_link_name != "map")
   {
     physics::EntityPtr ent =
 #if GAZEBO_MAJOR_VERSION >= 8
-      this->world_->EntityByName(this->reference_link_name_);
+      this->world_->EntityByName(reference_link_name);
 #else
-      this->world_->GetEntity(this->reference_link_name_);
+      this->world_->GetEntity(reference_link_name);
 #endif
     if (ent)
-      this->reference_link_ = boost::dynamic_pointer_cast<physics::Link>(ent);
-    if (!this->reference_link_)
+      playback->reference_link = boost::dynamic_pointer_cast<physics::Link>(ent);
+    if (!playback->reference_link)
     {
       ROS_ERROR_NAMED("joint_pose_trajectory", "ros_joint_trajectory plugin needs a reference link [%s] as"
-                " frame_id, aborting.\n", this->reference_link_name_.c_str());
+                " frame_id, aborting.\n", reference_link_name.c_str());
       return;
     }
     else
     {
-      this->model_ = this->reference_link_->GetParentModel();
+      playback->model = playback->reference_link->GetParentModel();
       ROS_DEBUG_NAMED("joint_pose_trajectory", "test: update model pose by keeping link [%s] stationary"
-                " inertially", this->reference_link_->GetName().c_str());
+                " inertially", playback->reference_link->GetName().c_str());
     }
   }
 
-  // copy joint configuration into a map
+  // resolve the joints once
   unsigned int chain_size = trajectory->joint_names.size();
-  this->joints_.resize(chain_size);
+  playback->joints.resize(chain_size);
   for (unsigned int i = 0; i < chain_size; ++i)
   {
-    this->joints_[i] = this->model_->GetJoint(trajectory->joint_names[i]);
+    playback->joints[i] = playback->model->GetJoint(trajectory->joint_names[i]);
+    if (!playback->joints[i])
+      ROS_WARN_NAMED("joint_pose_trajectory", "joint [%s] not found, not setting it",
+        trajectory->joint_names[i].c_str());
   }
 
+  // time of each point from start: the time_from_start of the points
+  // before it
   unsigned int points_size = trajectory->points.size();
-  this->points_.resize(points_size);
+  std::vector<common::Time> point_times(points_size);
+  common::Time end;
   for (unsigned int i = 0; i < points_size; ++i)
   {
-    this->points_[i].positions.resize(chain_size);
-    this->points_[i].time_from_start = trajectory->points[i].time_from_start;
-    for (unsigned int j = 0; j < chain_size; ++j)
+    if (trajectory->points[i].positions.size() != chain_size)
     {
-      this->points_[i].positions[j] = trajectory->points[i].positions[j];
+      ROS_ERROR_NAMED("joint_pose_trajectory", "point[%u] in JointTrajectory has different number of"
+                " joint names[%u] and positions[%lu], aborting.", i, chain_size,
+                trajectory->points[i].positions.size());
+      return;
+    }
+    point_times[i] = end;
+    end += common::Time(trajectory->points[i].time_from_start.sec,
+                        trajectory->points[i].time_from_start.nsec);
+  }
+  playback->end = end;
+
+  if (this->playback_rate_ > 0 && points_size > 1)
+  {
+    // resample at the playback rate, by linear interpolation
+    double last = point_times[points_size - 1].Double();
+    size_t samples = static_cast<size_t>(last * this->playback_rate_) + 1;
+    playback->times.reserve(samples + 1);
+    playback->positions.reserve((samples + 1) * chain_size);
+    unsigned int point = 0;
+    for (size_t k = 0; k <= samples; ++k)
+    {
+      double t = std::min(k / this->playback_rate_, last);
+      while (point + 2 < points_size && point_times[point + 1].Double() <= t)
+        ++point;
+      double t0 = point_times[point].Double();
+      double t1 = point_times[point + 1].Double();
+      double alpha = t1 > t0 ? std::min(1.0, std::max(0.0, (t - t0) / (t1 - t0))) : 1.0;
+      const std::vector<double> &p0 = trajectory->points[point].positions;
+      const std::vector<double> &p1 = trajectory->points[point + 1].positions;
+      playback->times.push_back(common::Time(t));
+      for (unsigned int j = 0; j < chain_size; ++j)
+        playback->positions.push_back(p0[j] + alpha * (p1[j] - p0[j]));
+      if (t >= last)
+        break;
+    }
+  }
+  else
+  {
+    playback->times = point_times;
+    playback->positions.reserve(points_size * chain_size);
+    for (unsigned int i = 0; i < points_size; ++i)
+    {
+      playback->positions.insert(playback->positions.end(),
+        trajectory->points[i].positions.begin(),
+        trajectory->points[i].positions.end());
     }
   }
 
   // trajectory start time
-  this->trajectory_start = gazebo::common::Time(trajectory->header.stamp.sec,
-                                                trajectory->header.stamp.nsec);
+  playback->start = gazebo::common::Time(trajectory->header.stamp.sec,
+                                         trajectory->header.stamp.nsec);
 #if GAZEBO_MAJOR_VERSION >= 8
   common::Time cur_time = this->world_->SimTime();
 #else
   common::Time cur_time = this->world_->GetSimTime();
 #endif
-  if (this->trajectory_start < cur_time)
-    this->trajectory_start = cur_time;
+  if (playback->start < cur_time)
+    playback->start = cur_time;
 
-  // update the joint trajectory to play
-  this->has_trajectory_ = true;
-  // reset trajectory_index to beginning of new trajectory
-  this->trajectory_index = 0;
+  boost::mutex::scoped_lock lock(this->update_mutex);
 
-  if (this->disable_physics_updates_)
+  // keep the physics state from before the first trajectory
+  bool was_playing = this->playback_.get() != NULL;
+
+  // update the joint trajectory to play, the update restarts from its
+  // first setpoint
+  this->playback_ = playback;
+
+  if (this->disable_physics_updates_ && !was_playing)
   {
 #if GAZEBO_MAJOR_VERSION >= 8
     this->physics_engine_enabled_ = this->world_->PhysicsEnabled();
@@ -341,100 +400,62 @@ bool GazeboRosJointPoseTrajectory::SetTrajectory(
 // Play the trajectory, update states
 void GazeboRosJointPoseTrajectory::UpdateStates()
 {
-#ifdef ENABLE_PROFILER
-  IGN_PROFILE("GazeboRosJointPoseTrajectory::UpdateStates");
+  GAZEBO_ROS_PROFILE("GazeboRosJointPoseTrajectory::UpdateStates");
 
-  IGN_PROFILE_BEGIN("update");
-#endif
-  boost::mutex::scoped_lock lock(this->update_mutex);
-  if (this->has_trajectory_)
+  GAZEBO_ROS_PROFILE_BEGIN("update");
+  PlaybackConstPtr playback;
+  {
+    boost::mutex::scoped_lock lock(this->update_mutex);
+    playback = this->playback_;
+  }
+  if (playback != this->playing_)
+  {
+    // a new trajectory, or none
+    this->playing_ = playback;
+    this->next_setpoint_ = 0;
+  }
+  if (!playback)
   {
+    GAZEBO_ROS_PROFILE_END();
+    return;
+  }
+
 #if GAZEBO_MAJOR_VERSION >= 8
-    common::Time cur_time = this->world_->SimTime();
+  common::Time cur_time = this->world_->SimTime();
 #else
-    common::Time cur_time = this->world_->GetSimTime();
+  common::Time cur_time = this->world_->GetSimTime();
 #endif
-    // roll out trajectory via set model configuration
-    // gzerr << "i[" << trajectory_index  << "] time "
-    //       << trajectory_start << " now: " << cur_time << " : "<< "\n";
-    if (cur_time >= this->trajectory_start)
+  // roll out trajectory via set model configuration
+  if (cur_time >= playback->start)
+  {
+    common::Time offset = cur_time - playback->start;
+    size_t setpoints = playback->times.size();
+    if (this->next_setpoint_ < setpoints)
     {
-      // @todo:  consider a while loop until the trajectory
-      // catches up to the current time
-      // gzerr << trajectory_index << " : "  << this->points_.size() << "\n";
-      if (this->trajectory_index < this->points_.size())
+      // apply the latest setpoint that is due, skipping the ones it
+      // catches up on
+      size_t index = this->next_setpoint_;
+      if (playback->times[index] <= offset)
       {
-        ROS_INFO_NAMED("joint_pose_trajectory", "time [%f] updating configuration [%d/%lu]",
-          cur_time.Double(), this->trajectory_index, this->points_.size());
-
-        // get reference link pose before updates
-#if GAZEBO_MAJOR_VERSION >= 8
-        ignition::math::Pose3d reference_pose = this->model_->WorldPose();
-#else
-        ignition::math::Pose3d reference_pose = this->model_->GetWorldPose().Ign();
-#endif
-        if (this->reference_link_)
-        {
-#if GAZEBO_MAJOR_VERSION >= 8
-          reference_pose = this->reference_link_->WorldPose();
-#else
-          reference_pose = this->reference_link_->GetWorldPose().Ign();
-#endif
-        }
-
-        // trajectory roll-out based on time:
-        //  set model configuration from trajectory message
-        unsigned int chain_size = this->joints_.size();
-        if (chain_size ==
-          this->points_[this->trajectory_index].positions.size())
-        {
-          for (unsigned int i = 0; i < chain_size; ++i)
-          {
-            // this is not the most efficient way to set things
-            if (this->joints_[i])
-            {
-#if GAZEBO_MAJOR_VERSION >= 9
-              this->joints_[i]->SetPosition(0,
-                this->points_[this->trajectory_index].positions[i], true);
-#else
-              this->joints_[i]->SetPosition(0,
-                this->points_[this->trajectory_index].positions[i]);
-#endif
-            }
-          }
-
-          // set model pose
-          if (this->reference_link_)
-            this->model_->SetLinkWorldPose(reference_pose,
-              this->reference_link_);
-          else
-            this->model_->SetWorldPose(reference_pose);
-        }
-        else
-        {
-          ROS_ERROR_NAMED("joint_pose_trajectory", "point[%u] in JointTrajectory has different number of"
-                    " joint names[%u] and positions[%lu].",
-                    this->trajectory_index, chain_size,
-                    this->points_[this->trajectory_index].positions.size());
-        }
-
-        // this->world_->SetPaused(is_paused);  // resume original pause-state
-        gazebo::common::Time duration(
-          this->points_[this->trajectory_index].time_from_start.sec,
-          this->points_[this->trajectory_index].time_from_start.nsec);
-
-        // reset start time for next trajectory point
-        this->trajectory_start += duration;
-        this->trajectory_index++;  // increment to next trajectory point
+        while (index + 1 < setpoints && playback->times[index + 1] <= offset)
+          ++index;
+        ROS_DEBUG_NAMED("joint_pose_trajectory", "time [%f] updating configuration [%lu/%lu]",
+          cur_time.Double(), index, setpoints);
+        this->ApplySetpoint(*playback, index);
+        this->next_setpoint_ = index + 1;
 
         // save last update time stamp
         this->last_time_ = cur_time;
       }
-      else  // no more trajectory points
+    }
+    else if (offset >= playback->end)  // no more trajectory points
+    {
+      // trajectory finished
+      boost::mutex::scoped_lock lock(this->update_mutex);
+      if (this->playback_ == playback)
       {
-        // trajectory finished
-        this->reference_link_.reset();
-        this->has_trajectory_ = false;
+        this->playback_.reset();
+        this->playing_.reset();
         if (this->disable_physics_updates_)
         {
 #if GAZEBO_MAJOR_VERSION >= 8
@@ -446,19 +467,51 @@ void GazeboRosJointPoseTrajectory::UpdateStates()
       }
     }
   }
-#ifdef ENABLE_PROFILER
-  IGN_PROFILE_END();
-#endif
+  GAZEBO_ROS_PROFILE_END();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-// Put laser data to the interface
-void GazeboRosJointPoseTrajectory::QueueThread()
+// Set the model configuration of a setpoint
+void GazeboRosJointPoseTrajectory::ApplySetpoint(const Playback &_playback,
+  size_t _index)
 {
-  static const double timeout = 0.01;
-  while (this->rosnode_->ok())
+  // get reference link pose before updates
+#if GAZEBO_MAJOR_VERSION >= 8
+  ignition::math::Pose3d reference_pose = _playback.model->WorldPose();
+#else
+  ignition::math::Pose3d reference_pose = _playback.model->GetWorldPose().Ign();
+#endif
+  if (_playback.reference_link)
+  {
+#if GAZEBO_MAJOR_VERSION >= 8
+    reference_pose = _playback.reference_link->WorldPose();
+#else
+    reference_pose = _playback.reference_link->GetWorldPose().Ign();
+#endif
+  }
+
+  // set model configuration from the setpoint
+  size_t chain_size = _playback.joints.size();
+  const double *positions = chain_size > 0 ?
+    &_playback.positions[_index * chain_size] : NULL;
+  for (size_t i = 0; i < chain_size; ++i)
   {
-    this->queue_.callAvailable(ros::WallDuration(timeout));
+    if (_playback.joints[i])
+    {
+#if GAZEBO_MAJOR_VERSION >= 9
+      _playback.joints[i]->SetPosition(0, positions[i], true);
+#else
+      _playback.joints[i]->SetPosition(0, positions[i]);
+#endif
+    }
   }
+
+  // set model pose
+  if (_playback.reference_link)
+    _playback.model->SetLinkWorldPose(reference_pose,
+      _playback.reference_link);
+  else
+    _playback.model->SetWorldPose(reference_pose);
 }
+
 }
@@ -25,17 +25,18 @@
  *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  *
  **/
+#include <cmath>
 #include <boost/algorithm/string.hpp>
 #include <gazebo_plugins/gazebo_ros_joint_state_publisher.h>
-#ifdef ENABLE_PROFILER
-#include <ignition/common/Profiler.hh>
-#endif
+#include <gazebo_plugins/gazebo_ros_utils.h>
+#include <gazebo_ros/profiler.h>
 #include <tf/transform_broadcaster.h>
 #include <tf/transform_listener.h>
 
 using namespace gazebo;
 
-GazeboRosJointStatePublisher::GazeboRosJointStatePublisher() {}
+GazeboRosJointStatePublisher::GazeboRosJointStatePublisher()
+    : publish_on_change_ ( false ), change_tolerance_ ( 0.0 ), published_once_ ( false ) {}
 
 // Destructor
 GazeboRosJointStatePublisher::~GazeboRosJointStatePublisher() {
@@ -43,6 +44,7 @@ GazeboRosJointStatePublisher::~GazeboRosJointStatePublisher() {
 }
 
 void GazeboRosJointStatePublisher::Load ( physics::ModelPtr _parent, sdf::ElementPtr _sdf ) {
+    GAZEBO_ROS_STARTUP_PHASE("load");
     // Store the pointer to the model
     this->parent_ = _parent;
     this->world_ = _parent->GetWorld();
@@ -75,6 +77,23 @@ void GazeboRosJointStatePublisher::Load ( physics::ModelPtr _parent, sdf::Elemen
         this->update_rate_ = _sdf->GetElement ( "updateRate" )->Get<double>();
     }
 
+    this->publish_on_change_ = false;
+    if ( _sdf->HasElement ( "publishOnChange" ) ) {
+        this->publish_on_change_ = _sdf->GetElement ( "publishOnChange" )->Get<bool>();
+    }
+    this->change_tolerance_ = 0.0;
+    if ( _sdf->HasElement ( "changeTolerance" ) ) {
+        this->change_tolerance_ = _sdf->GetElement ( "changeTolerance" )->Get<double>();
+    }
+    bool use_message_pool = false;
+    if ( _sdf->HasElement ( "useMessagePool" ) ) {
+        use_message_pool = _sdf->GetElement ( "useMessagePool" )->Get<bool>();
+    }
+    int queue_size = 1000;
+    if ( _sdf->HasElement ( "queueSize" ) ) {
+        queue_size = _sdf->GetElement ( "queueSize" )->Get<int>();
+    }
+
     // Initialize update rate stuff
     if ( this->update_rate_ > 0.0 ) {
         this->update_period_ = 1.0 / this->update_rate_;
@@ -91,6 +110,7 @@ void GazeboRosJointStatePublisher::Load ( physics::ModelPtr _parent, sdf::Elemen
         physics::JointPtr joint = this->parent_->GetJoint(joint_names_[i]);
         if (!joint) {
             ROS_FATAL_NAMED("joint_state_publisher", "Joint %s does not exist!", joint_names_[i].c_str());
+            continue;
         }
         joints_.push_back ( joint );
         ROS_INFO_NAMED("joint_state_publisher", "GazeboRosJointStatePublisher is going to publish joint: %s", joint_names_[i].c_str() );
@@ -99,7 +119,22 @@ void GazeboRosJointStatePublisher::Load ( physics::ModelPtr _parent, sdf::Elemen
     ROS_INFO_NAMED("joint_state_publisher", "Starting GazeboRosJointStatePublisher Plugin (ns = %s)!, parent name: %s", this->robot_namespace_.c_str(), parent_->GetName ().c_str() );
 
     tf_prefix_ = tf::getPrefixParam ( *rosnode_ );
-    joint_state_publisher_ = rosnode_->advertise<sensor_msgs::JointState> ( "joint_states",1000 );
+    // the message keeps its size and names, each update only writes the values
+    joint_state_.name.resize ( joints_.size() );
+    joint_state_.position.assign ( joints_.size(), 0.0 );
+    joint_state_.velocity.assign ( joints_.size(), 0.0 );
+    positions_.assign ( joints_.size(), 0.0 );
+    velocities_.assign ( joints_.size(), 0.0 );
+    for ( std::size_t i = 0; i < joints_.size(); i++ ) {
+        joint_state_.name[i] = joints_[i]->GetName();
+    }
+    if ( use_message_pool ) {
+        joint_state_pool_.reset ( new MessagePool<sensor_msgs::JointState>() );
+    }
+
+    // a state that does not change is not republished, late subscribers get the last one
+    joint_state_publisher_ = rosnode_->advertise<sensor_msgs::JointState> ( "joint_states", queue_size,
+                                                                            publish_on_change_ );
 
 #if GAZEBO_MAJOR_VERSION >= 8
     last_update_time_ = this->world_->SimTime();
@@ -114,9 +149,7 @@ void GazeboRosJointStatePublisher::Load ( physics::ModelPtr _parent, sdf::Elemen
 
 void GazeboRosJointStatePublisher::OnUpdate ( const common::UpdateInfo & _info )
 {
-#ifdef ENABLE_PROFILER
-  IGN_PROFILE("GazeboRosCamera::OnNewFrame");
-#endif
+  GAZEBO_ROS_PROFILE("GazeboRosJointStatePublisher::OnUpdate");
     // Apply a small linear velocity to the model.
 #if GAZEBO_MAJOR_VERSION >= 8
     common::Time current_time = this->world_->SimTime();
@@ -132,37 +165,50 @@ void GazeboRosJointStatePublisher::OnUpdate ( const common::UpdateInfo & _info )
     double seconds_since_last_update = ( current_time - last_update_time_ ).Double();
 
     if ( seconds_since_last_update > update_period_ ) {
-#ifdef ENABLE_PROFILER
-        IGN_PROFILE_BEGIN("publishJointStates");
-#endif
+        GAZEBO_ROS_PROFILE_BEGIN("publishJointStates");
         publishJointStates();
-#ifdef ENABLE_PROFILER
-        IGN_PROFILE_END();
-#endif
-        last_update_time_+= common::Time ( update_period_ );
+        GAZEBO_ROS_PROFILE_END();
+        // after a stall, skip the missed periods instead of publishing the same state for each
+        if ( update_period_ > 0.0 ) {
+            last_update_time_ += common::Time ( floor ( seconds_since_last_update / update_period_ ) * update_period_ );
+        } else {
+            last_update_time_ = current_time;
+        }
     }
 
 }
 
 void GazeboRosJointStatePublisher::publishJointStates() {
-    ros::Time current_time = ros::Time::now();
-
-    joint_state_.header.stamp = current_time;
-    joint_state_.name.resize ( joints_.size() );
-    joint_state_.position.resize ( joints_.size() );
-    joint_state_.velocity.resize ( joints_.size() );
-
-    for ( int i = 0; i < joints_.size(); i++ ) {
-        physics::JointPtr joint = joints_[i];
+    bool changed = !published_once_;
+    for ( std::size_t i = 0; i < joints_.size(); i++ ) {
+        const physics::JointPtr &joint = joints_[i];
         double velocity = joint->GetVelocity( 0 );
 #if GAZEBO_MAJOR_VERSION >= 8
         double position = joint->Position ( 0 );
 #else
         double position = joint->GetAngle ( 0 ).Radian();
 #endif
-        joint_state_.name[i] = joint->GetName();
-        joint_state_.position[i] = position;
-        joint_state_.velocity[i] = velocity;
+        if ( fabs ( position - joint_state_.position[i] ) > change_tolerance_ ||
+             fabs ( velocity - joint_state_.velocity[i] ) > change_tolerance_ ) {
+            changed = true;
+        }
+        positions_[i] = position;
+        velocities_[i] = velocity;
+    }
+    // compared with the last published state, so that slow drifts are not missed
+    if ( publish_on_change_ && !changed ) {
+        return;
+    }
+    published_once_ = true;
+    joint_state_.position.swap ( positions_ );
+    joint_state_.velocity.swap ( velocities_ );
+
+    joint_state_.header.stamp = ros::Time::now();
+    if ( joint_state_pool_ ) {
+        sensor_msgs::JointStatePtr msg = joint_state_pool_->Acquire();
+        *msg = joint_state_;
+        joint_state_publisher_.publish ( msg );
+    } else {
+        joint_state_publisher_.publish ( joint_state_ );
     }
-    joint_state_publisher_.publish ( joint_state_ );
 }
@@ -0,0 +1,408 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <string>
+
+#include <boost/bind.hpp>
+
+#include <gazebo_plugins/gazebo_ros_kinematic_crowd.h>
+#include <gazebo_plugins/gazebo_ros_utils.h>
+
+#include <gazebo/physics/World.hh>
+
+#include <gazebo_ros/profiler.h>
+
+#include <sdf/sdf.hh>
+
+namespace gazebo
+{
+// Register this plugin with the simulator
+GZ_REGISTER_WORLD_PLUGIN(GazeboRosKinematicCrowd)
+
+namespace
+{
+const size_t kNoAgent = std::numeric_limits<size_t>::max();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Constructor
+GazeboRosKinematicCrowd::GazeboRosKinematicCrowd()
+  : rosnode_(NULL), agents_changed_(false), cmd_timeout_(-1),
+    update_rate_(0), update_period_(0)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Destructor
+GazeboRosKinematicCrowd::~GazeboRosKinematicCrowd()
+{
+  this->update_connection_.reset();
+  this->add_entity_connection_.reset();
+  this->delete_entity_connection_.reset();
+
+  if (!this->rosnode_)
+    return;
+  this->queue_.clear();
+  this->queue_.disable();
+  this->rosnode_->shutdown();
+  this->queue_.Stop();
+  delete this->rosnode_;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Load the plugin
+void GazeboRosKinematicCrowd::Load(physics::WorldPtr _world,
+                                   sdf::ElementPtr _sdf)
+{
+  GAZEBO_ROS_STARTUP_PHASE("load");
+  this->world_ = _world;
+
+  this->robot_namespace_ = "";
+  if (_sdf->HasElement("robotNamespace"))
+    this->robot_namespace_ = _sdf->GetElement("robotNamespace")->Get<std::string>() + "/";
+
+  if (!_sdf->HasElement("agentPrefix"))
+  {
+    ROS_INFO_NAMED("kinematic_crowd", "Kinematic crowd plugin missing <agentPrefix>, defaults to \"agent_\"");
+    this->agent_prefix_ = "agent_";
+  }
+  else
+    this->agent_prefix_ = _sdf->GetElement("agentPrefix")->Get<std::string>();
+
+  std::string command_topic = "crowd/cmd_vel";
+  if (_sdf->HasElement("commandTopic"))
+    command_topic = _sdf->GetElement("commandTopic")->Get<std::string>();
+
+  std::string state_topic = "crowd/states";
+  if (_sdf->HasElement("stateTopic"))
+    state_topic = _sdf->GetElement("stateTopic")->Get<std::string>();
+
+  if (_sdf->HasElement("cmdTimeout"))
+    this->cmd_timeout_ = _sdf->GetElement("cmdTimeout")->Get<double>();
+
+  if (!_sdf->HasElement("updateRate"))
+  {
+    ROS_INFO_NAMED("kinematic_crowd", "Kinematic crowd plugin missing <updateRate>, defaults to 20");
+    this->update_rate_ = 20;
+  }
+  else
+    this->update_rate_ = _sdf->GetElement("updateRate")->Get<double>();
+
+  if (this->update_rate_ > 0.0)
+    this->update_period_ = 1.0/this->update_rate_;
+  else
+    this->update_period_ = 0.0;
+
+  // Make sure the ROS node for Gazebo has already been initialized
+  if (!ros::isInitialized())
+  {
+    ROS_FATAL_STREAM_NAMED("kinematic_crowd", "A ROS node for Gazebo has not been initialized, unable to load plugin. "
+      << "Load the Gazebo system plugin 'libgazebo_ros_api_plugin.so' in the gazebo_ros package)");
+    return;
+  }
+
+  this->rosnode_ = new ros::NodeHandle(this->robot_namespace_);
+
+  this->pub_ = this->rosnode_->advertise<gazebo_msgs::ModelStates>(
+    state_topic, 1);
+
+  ros::SubscribeOptions so =
+    ros::SubscribeOptions::create<gazebo_msgs::AgentVelocities>(
+      command_topic, 1,
+      boost::bind(&GazeboRosKinematicCrowd::OnCommand, this, _1),
+      ros::VoidPtr(), &this->queue_);
+  GetSubscriptionHints(*this->rosnode_, _sdf).apply(so);
+  this->sub_ = this->rosnode_->subscribe(so);
+
+#if GAZEBO_MAJOR_VERSION >= 8
+  this->last_update_time_ = this->world_->SimTime();
+#else
+  this->last_update_time_ = this->world_->GetSimTime();
+#endif
+  this->last_publish_time_ = this->last_update_time_;
+
+  this->FindAgents();
+  ROS_INFO_NAMED("kinematic_crowd", "Kinematic crowd plugin found %lu agents named %s*",
+    static_cast<unsigned long>(this->names_.size()), this->agent_prefix_.c_str());
+
+  this->add_entity_connection_ = event::Events::ConnectAddEntity(
+      boost::bind(&GazeboRosKinematicCrowd::OnEntityEvent, this, _1));
+  this->delete_entity_connection_ = event::Events::ConnectDeleteEntity(
+      boost::bind(&GazeboRosKinematicCrowd::OnEntityEvent, this, _1));
+  this->update_connection_ = event::Events::ConnectWorldUpdateBegin(
+      boost::bind(&GazeboRosKinematicCrowd::OnWorldUpdate, this));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// A model was added or deleted, find the agents again at the next update
+void GazeboRosKinematicCrowd::OnEntityEvent(const std::string &_name)
+{
+  if (_name.compare(0, this->agent_prefix_.size(), this->agent_prefix_) == 0)
+    this->agents_changed_ = true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Rebuild the arrays from the models of the world
+void GazeboRosKinematicCrowd::FindAgents()
+{
+#if GAZEBO_MAJOR_VERSION >= 8
+  physics::Model_V models = this->world_->Models();
+  double now = this->world_->SimTime().Double();
+#else
+  physics::Model_V models = this->world_->GetModels();
+  double now = this->world_->GetSimTime().Double();
+#endif
+
+  std::vector<std::string> names;
+  std::vector<physics::ModelPtr> agents;
+  std::map<std::string, size_t> index;
+  std::vector<double> x, y, z, roll, pitch, yaw, vx, vy, wz, cmd_time;
+  for (physics::Model_V::iterator it = models.begin(); it != models.end(); ++it)
+  {
+    const std::string name = (*it)->GetName();
+    if (name.compare(0, this->agent_prefix_.size(), this->agent_prefix_) != 0)
+      continue;
+
+    index[name] = names.size();
+    names.push_back(name);
+    agents.push_back(*it);
+
+    std::map<std::string, size_t>::const_iterator old = this->index_.find(name);
+    if (old != this->index_.end() && this->models_[old->second] == *it)
+    {
+      size_t i = old->second;
+      x.push_back(this->x_[i]);
+      y.push_back(this->y_[i]);
+      z.push_back(this->z_[i]);
+      roll.push_back(this->roll_[i]);
+      pitch.push_back(this->pitch_[i]);
+      yaw.push_back(this->yaw_[i]);
+      vx.push_back(this->vx_[i]);
+      vy.push_back(this->vy_[i]);
+      wz.push_back(this->wz_[i]);
+      cmd_time.push_back(this->cmd_time_[i]);
+      continue;
+    }
+
+#if GAZEBO_MAJOR_VERSION >= 8
+    ignition::math::Pose3d pose = (*it)->WorldPose();
+#else
+    ignition::math::Pose3d pose = (*it)->GetWorldPose().Ign();
+#endif
+    x.push_back(pose.Pos().X());
+    y.push_back(pose.Pos().Y());
+    z.push_back(pose.Pos().Z());
+    roll.push_back(pose.Rot().Roll());
+    pitch.push_back(pose.Rot().Pitch());
+    yaw.push_back(pose.Rot().Yaw());
+    vx.push_back(0);
+    vy.push_back(0);
+    wz.push_back(0);
+    cmd_time.push_back(now);
+  }
+
+  this->names_.swap(names);
+  this->models_.swap(agents);
+  this->index_.swap(index);
+  this->x_.swap(x);
+  this->y_.swap(y);
+  this->z_.swap(z);
+  this->roll_.swap(roll);
+  this->pitch_.swap(pitch);
+  this->yaw_.swap(yaw);
+  this->vx_.swap(vx);
+  this->vy_.swap(vy);
+  this->wz_.swap(wz);
+  this->cmd_time_.swap(cmd_time);
+
+  // indices of the cached command names are stale
+  this->cmd_names_.clear();
+  this->cmd_index_.clear();
+
+  this->states_msg_.name = this->names_;
+  this->states_msg_.pose.resize(this->names_.size());
+  this->states_msg_.twist.resize(this->names_.size());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Keep the latest command, the update thread copies it into the arrays
+void GazeboRosKinematicCrowd::OnCommand(
+  const gazebo_msgs::AgentVelocities::ConstPtr &_msg)
+{
+  boost::mutex::scoped_lock lock(this->cmd_lock_);
+  this->pending_cmd_ = _msg;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Copy a command into the velocity arrays
+void GazeboRosKinematicCrowd::ApplyCommand(
+  const gazebo_msgs::AgentVelocities &_msg, double _now)
+{
+  if (_msg.name.empty())
+  {
+    size_t n = std::min(_msg.twist.size(), this->names_.size());
+    for (size_t i = 0; i < n; ++i)
+    {
+      this->vx_[i] = _msg.twist[i].linear.x;
+      this->vy_[i] = _msg.twist[i].linear.y;
+      this->wz_[i] = _msg.twist[i].angular.z;
+      this->cmd_time_[i] = _now;
+    }
+    return;
+  }
+
+  if (_msg.name.size() != _msg.twist.size())
+  {
+    ROS_WARN_THROTTLE_NAMED(1.0, "kinematic_crowd", "Kinematic crowd plugin ignores a command of %lu names and %lu twists",
+      static_cast<unsigned long>(_msg.name.size()),
+      static_cast<unsigned long>(_msg.twist.size()));
+    return;
+  }
+
+  // controllers mostly send the same names in the same order
+  if (_msg.name != this->cmd_names_)
+  {
+    this->cmd_names_ = _msg.name;
+    this->cmd_index_.resize(this->cmd_names_.size());
+    for (size_t k = 0; k < this->cmd_names_.size(); ++k)
+    {
+      std::map<std::string, size_t>::const_iterator it =
+        this->index_.find(this->cmd_names_[k]);
+      this->cmd_index_[k] = it == this->index_.end() ? kNoAgent : it->second;
+    }
+  }
+
+  for (size_t k = 0; k < this->cmd_index_.size(); ++k)
+  {
+    size_t i = this->cmd_index_[k];
+    if (i == kNoAgent)
+    {
+      ROS_WARN_THROTTLE_NAMED(1.0, "kinematic_crowd", "Kinematic crowd plugin has no agent [%s]",
+        this->cmd_names_[k].c_str());
+      continue;
+    }
+    this->vx_[i] = _msg.twist[k].linear.x;
+    this->vy_[i] = _msg.twist[k].linear.y;
+    this->wz_[i] = _msg.twist[k].angular.z;
+    this->cmd_time_[i] = _now;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Move all agents
+void GazeboRosKinematicCrowd::OnWorldUpdate()
+{
+  GAZEBO_ROS_PROFILE("GazeboRosKinematicCrowd::OnWorldUpdate");
+#if GAZEBO_MAJOR_VERSION >= 8
+  common::Time cur_time = this->world_->SimTime();
+#else
+  common::Time cur_time = this->world_->GetSimTime();
+#endif
+  double now = cur_time.Double();
+  double dt = (cur_time - this->last_update_time_).Double();
+  this->last_update_time_ = cur_time;
+
+  if (this->agents_changed_)
+  {
+    this->agents_changed_ = false;
+    this->FindAgents();
+  }
+
+  gazebo_msgs::AgentVelocities::ConstPtr cmd;
+  {
+    boost::mutex::scoped_lock lock(this->cmd_lock_);
+    cmd.swap(this->pending_cmd_);
+  }
+  if (cmd)
+    this->ApplyCommand(*cmd, now);
+
+  // a reset moves time back, hold the agents in place then
+  if (dt < 0)
+    dt = 0;
+
+  const size_t n = this->names_.size();
+  for (size_t i = 0; i < n; ++i)
+  {
+    if (this->cmd_timeout_ >= 0 && now - this->cmd_time_[i] > this->cmd_timeout_)
+    {
+      this->vx_[i] = 0;
+      this->vy_[i] = 0;
+      this->wz_[i] = 0;
+    }
+    double c = cos(this->yaw_[i]);
+    double s = sin(this->yaw_[i]);
+    this->x_[i] += (this->vx_[i] * c - this->vy_[i] * s) * dt;
+    this->y_[i] += (this->vx_[i] * s + this->vy_[i] * c) * dt;
+    this->yaw_[i] += this->wz_[i] * dt;
+  }
+
+  for (size_t i = 0; i < n; ++i)
+  {
+    double c = cos(this->yaw_[i]);
+    double s = sin(this->yaw_[i]);
+    physics::Model *model = this->models_[i].get();
+    model->SetWorldPose(ignition::math::Pose3d(
+      this->x_[i], this->y_[i], this->z_[i],
+      this->roll_[i], this->pitch_[i], this->yaw_[i]));
+    model->SetLinearVel(ignition::math::Vector3d(
+      this->vx_[i] * c - this->vy_[i] * s,
+      this->vx_[i] * s + this->vy_[i] * c, 0));
+    model->SetAngularVel(ignition::math::Vector3d(0, 0, this->wz_[i]));
+  }
+
+  if (this->update_period_ > 0 &&
+      (cur_time - this->last_publish_time_).Double() < this->update_period_)
+    return;
+  this->last_publish_time_ = cur_time;
+  this->PublishStates();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Publish the state of all agents in one message
+void GazeboRosKinematicCrowd::PublishStates()
+{
+  if (this->pub_.getNumSubscribers() == 0)
+    return;
+
+  for (size_t i = 0; i < this->names_.size(); ++i)
+  {
+    ignition::math::Quaterniond q(this->roll_[i], this->pitch_[i], this->yaw_[i]);
+    geometry_msgs::Pose &pose = this->states_msg_.pose[i];
+    pose.position.x = this->x_[i];
+    pose.position.y = this->y_[i];
+    pose.position.z = this->z_[i];
+    pose.orientation.w = q.W();
+    pose.orientation.x = q.X();
+    pose.orientation.y = q.Y();
+    pose.orientation.z = q.Z();
+
+    double c = cos(this->yaw_[i]);
+    double s = sin(this->yaw_[i]);
+    geometry_msgs::Twist &twist = this->states_msg_.twist[i];
+    twist.linear.x = this->vx_[i] * c - this->vy_[i] * s;
+    twist.linear.y = this->vx_[i] * s + this->vy_[i] * c;
+    twist.linear.z = 0;
+    twist.angular.x = 0;
+    twist.angular.y = 0;
+    twist.angular.z = this->wz_[i];
+  }
+  this->pub_.publish(this->states_msg_);
+}
+}
@@ -21,29 +21,11 @@
  * Date: 01 Feb 2007
  */
 
-#include <algorithm>
 #include <string>
-#include <assert.h>
-
-#include <gazebo/physics/World.hh>
-#include <gazebo/physics/HingeJoint.hh>
-#include <gazebo/sensors/Sensor.hh>
-#include <sdf/sdf.hh>
-#include <sdf/Param.hh>
-#include <gazebo/common/Exception.hh>
-#include <gazebo/sensors/RaySensor.hh>
-#include <gazebo/sensors/SensorTypes.hh>
-#include <gazebo/transport/transport.hh>
-
-#ifdef ENABLE_PROFILER
-#include <ignition/common/Profiler.hh>
-#endif
 
-#include <tf/tf.h>
-#include <tf/transform_listener.h>
+#include <gazebo/transport/transport.hh>
 
 #include <gazebo_plugins/gazebo_ros_laser.h>
-#include <ignition/math/Rand.hh>
 
 namespace gazebo
 {
@@ -53,6 +35,7 @@ GZ_REGISTER_SENSOR_PLUGIN(GazeboRosLaser)
 ////////////////////////////////////////////////////////////////////////////////
 // Constructor
 GazeboRosLaser::GazeboRosLaser()
+  : SensorPluginBase("laser")
 {
 }
 
@@ -60,152 +43,125 @@ GazeboRosLaser::GazeboRosLaser()
 // Destructor
 GazeboRosLaser::~GazeboRosLaser()
 {
-  this->rosnode_->shutdown();
-  delete this->rosnode_;
+  this->ShutdownRos();
+  this->laser_scan_sub_.reset();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-// Load the controller
-void GazeboRosLaser::Load(sensors::SensorPtr _parent, sdf::ElementPtr _sdf)
+// Read the plugin parameters
+bool GazeboRosLaser::LoadSdf(sdf::ElementPtr _sdf)
 {
-  // load plugin
-  RayPlugin::Load(_parent, this->sdf);
-  // Get the world name.
-  std::string worldName = _parent->WorldName();
-  this->world_ = physics::get_world(worldName);
-  // save pointers
-  this->sdf = _sdf;
-
-  GAZEBO_SENSORS_USING_DYNAMIC_POINTER_CAST;
-  this->parent_ray_sensor_ =
-    dynamic_pointer_cast<sensors::RaySensor>(_parent);
-
-  if (!this->parent_ray_sensor_)
-    gzthrow("GazeboRosLaser controller requires a Ray Sensor as its parent");
-
-  this->robot_namespace_ =  GetRobotNamespace(_parent, _sdf, "Laser");
-
-  if (!this->sdf->HasElement("frameName"))
+  if (!_sdf->HasElement("frameName"))
   {
     ROS_INFO_NAMED("laser", "Laser plugin missing <frameName>, defaults to /world");
     this->frame_name_ = "/world";
   }
   else
-    this->frame_name_ = this->sdf->Get<std::string>("frameName");
-
+    this->frame_name_ = _sdf->Get<std::string>("frameName");
 
-  if (!this->sdf->HasElement("topicName"))
+  if (!_sdf->HasElement("topicName"))
   {
     ROS_INFO_NAMED("laser", "Laser plugin missing <topicName>, defaults to /world");
     this->topic_name_ = "/world";
   }
   else
-    this->topic_name_ = this->sdf->Get<std::string>("topicName");
+    this->topic_name_ = _sdf->Get<std::string>("topicName");
 
-  this->laser_connect_count_ = 0;
-
-    // Make sure the ROS node for Gazebo has already been initialized
-  if (!ros::isInitialized())
-  {
-    ROS_FATAL_STREAM_NAMED("laser", "A ROS node for Gazebo has not been initialized, unable to load plugin. "
-      << "Load the Gazebo system plugin 'libgazebo_ros_api_plugin.so' in the gazebo_ros package)");
-    return;
-  }
+  // the scan projected into a point cloud, only on request
+  if (!_sdf->HasElement("pointCloudTopicName"))
+    this->cloud_topic_name_ = "";
+  else
+    this->cloud_topic_name_ = _sdf->Get<std::string>("pointCloudTopicName");
 
-  ROS_INFO_NAMED("laser", "Starting Laser Plugin (ns = %s)", this->robot_namespace_.c_str() );
-  // ros callback queue for processing subscription
-  this->deferred_load_thread_ = boost::thread(
-    boost::bind(&GazeboRosLaser::LoadThread, this));
+  this->intensity_.Load(_sdf, "laser");
 
+  return true;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 // Load the controller
-void GazeboRosLaser::LoadThread()
+void GazeboRosLaser::LoadRos()
 {
   this->gazebo_node_ = gazebo::transport::NodePtr(new gazebo::transport::Node());
   this->gazebo_node_->Init(this->world_name_);
 
-  this->pmq.startServiceThread();
-
-  this->rosnode_ = new ros::NodeHandle(this->robot_namespace_);
-
-  this->tf_prefix_ = tf::getPrefixParam(*this->rosnode_);
-  ROS_INFO_NAMED("laser", "Laser Plugin (ns = %s)  <tf_prefix_>, set to \"%s\"",
-             this->robot_namespace_.c_str(), this->tf_prefix_.c_str());
-
   // resolve tf prefix
-  this->frame_name_ = tf::resolve(this->tf_prefix_, this->frame_name_);
+  this->frame_name_ = this->ResolveFrame(this->frame_name_);
 
   if (this->topic_name_ != "")
   {
-    ros::AdvertiseOptions ao =
-      ros::AdvertiseOptions::create<sensor_msgs::LaserScan>(
-      this->topic_name_, 1,
-      boost::bind(&GazeboRosLaser::LaserConnect, this),
-      boost::bind(&GazeboRosLaser::LaserDisconnect, this),
-      ros::VoidPtr(), NULL);
-    this->pub_ = this->rosnode_->advertise(ao);
-    this->pub_queue_ = this->pmq.addPub<sensor_msgs::LaserScan>();
-  }
-
-  // Initialize the controller
+    this->scan_pub_ = this->Advertise<sensor_msgs::LaserScan>(this->topic_name_);
 
-  // sensor generation off by default
-  this->parent_ray_sensor_->SetActive(false);
+    if (this->cloud_topic_name_ != "")
+      this->cloud_pub_ =
+        this->Advertise<sensor_msgs::PointCloud2>(this->cloud_topic_name_);
+  }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-// Increment count
-void GazeboRosLaser::LaserConnect()
+// Subscribe to the scans, the sensor runs while they have a subscriber
+void GazeboRosLaser::Activate()
 {
-  this->laser_connect_count_++;
-  if (this->laser_connect_count_ == 1)
-    this->laser_scan_sub_ =
-      this->gazebo_node_->Subscribe(this->parent_ray_sensor_->Topic(),
-                                    &GazeboRosLaser::OnScan, this);
+  this->laser_scan_sub_ =
+    this->gazebo_node_->Subscribe(this->parent_sensor_->Topic(),
+                                  &GazeboRosLaser::OnScan, this);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-// Decrement count
-void GazeboRosLaser::LaserDisconnect()
+// Unsubscribe from the scans
+void GazeboRosLaser::Deactivate()
 {
-  this->laser_connect_count_--;
-  if (this->laser_connect_count_ == 0)
-    this->laser_scan_sub_.reset();
+  this->laser_scan_sub_.reset();
+  this->parent_sensor_->SetActive(false);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 // Convert new Gazebo message to ROS message and publish it
 void GazeboRosLaser::OnScan(ConstLaserScanStampedPtr &_msg)
 {
-#ifdef ENABLE_PROFILER
-  IGN_PROFILE("GazeboRosLaser::OnScan");
-  IGN_PROFILE_BEGIN("fill ROS message");
-#endif
+  GAZEBO_ROS_PROFILE("GazeboRosLaser::OnScan");
+  ScopedTiming timing(this->update_timing_);
+  const ros::Time stamp(_msg->time().sec(), _msg->time().nsec());
   // We got a new message from the Gazebo sensor.  Stuff a
   // corresponding ROS message and publish it.
-  sensor_msgs::LaserScan laser_msg;
-  laser_msg.header.stamp = ros::Time(_msg->time().sec(), _msg->time().nsec());
-  laser_msg.header.frame_id = this->frame_name_;
-  laser_msg.angle_min = _msg->scan().angle_min();
-  laser_msg.angle_max = _msg->scan().angle_max();
-  laser_msg.angle_increment = _msg->scan().angle_step();
-  laser_msg.time_increment = 0;  // instantaneous simulator scan
-  laser_msg.scan_time = 0;  // not sure whether this is correct
-  laser_msg.range_min = _msg->scan().range_min();
-  laser_msg.range_max = _msg->scan().range_max();
-  laser_msg.ranges.resize(_msg->scan().ranges_size());
-  std::copy(_msg->scan().ranges().begin(),
-            _msg->scan().ranges().end(),
-            laser_msg.ranges.begin());
-  laser_msg.intensities.resize(_msg->scan().intensities_size());
-  std::copy(_msg->scan().intensities().begin(),
-            _msg->scan().intensities().end(),
-            laser_msg.intensities.begin());
-  this->pub_queue_->push(laser_msg, this->pub_);
-#ifdef ENABLE_PROFILER
-  IGN_PROFILE_END();
-#endif
+  if (this->scan_pub_ && this->scan_pub_->Subscribers() > 0)
+  {
+    // a recycled message keeps the capacity of its arrays, so the copy out of
+    // the protobuf is the only one and does not allocate
+    this->scan_pub_->TraceLatency(LatencyTracer::SENSOR_CALLBACK, stamp);
+    sensor_msgs::LaserScanPtr laser_msg = this->scan_pub_->Acquire();
+    laser_msg->header.stamp = stamp;
+    laser_msg->header.frame_id = this->frame_name_;
+    laser_msg->angle_min = _msg->scan().angle_min();
+    laser_msg->angle_max = _msg->scan().angle_max();
+    laser_msg->angle_increment = _msg->scan().angle_step();
+    laser_msg->time_increment = 0;  // instantaneous simulator scan
+    laser_msg->scan_time = 0;  // not sure whether this is correct
+    laser_msg->range_min = _msg->scan().range_min();
+    laser_msg->range_max = _msg->scan().range_max();
+    laser_msg->ranges.assign(_msg->scan().ranges().begin(),
+                             _msg->scan().ranges().end());
+    // dropped intensities are not even copied out of the protobuf
+    if (this->intensity_.Output(_msg->scan().intensities().begin(),
+                                _msg->scan().intensities().end()))
+      laser_msg->intensities.assign(_msg->scan().intensities().begin(),
+                                    _msg->scan().intensities().end());
+    else
+      laser_msg->intensities.clear();
+    this->scan_pub_->TraceLatency(LatencyTracer::CONVERTED, stamp);
+    this->scan_pub_->Publish(laser_msg);
+  }
+
+  if (this->cloud_pub_ && this->cloud_pub_->Subscribers() > 0)
+  {
+    // straight from the protobuf to the cartesian cloud
+    this->cloud_pub_->TraceLatency(LatencyTracer::SENSOR_CALLBACK, stamp);
+    sensor_msgs::PointCloud2Ptr cloud_msg = this->cloud_pub_->Acquire();
+    cloud_msg->header.stamp = stamp;
+    cloud_msg->header.frame_id = this->frame_name_;
+    this->projector_.Project(_msg->scan(), *cloud_msg, this->intensity_);
+    this->cloud_pub_->TraceLatency(LatencyTracer::CONVERTED, stamp);
+    this->cloud_pub_->Publish(cloud_msg);
+  }
 }
 }
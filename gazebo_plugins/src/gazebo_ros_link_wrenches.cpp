@@ -0,0 +1,204 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <boost/bind.hpp>
+
+#include <gazebo_plugins/gazebo_ros_link_wrenches.h>
+#include <gazebo_plugins/gazebo_ros_utils.h>
+#include <gazebo_ros/profiler.h>
+
+namespace gazebo
+{
+GZ_REGISTER_MODEL_PLUGIN(GazeboRosLinkWrenches)
+
+namespace
+{
+int64_t SteadyNow()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Constructor
+GazeboRosLinkWrenches::GazeboRosLinkWrenches()
+  : pending_ready_(false), latency_(NULL), rosnode_(NULL)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Destructor
+GazeboRosLinkWrenches::~GazeboRosLinkWrenches()
+{
+  this->update_connection_.reset();
+
+  if (!this->rosnode_)
+    return;
+  this->queue_.clear();
+  this->queue_.disable();
+  this->rosnode_->shutdown();
+  this->queue_.Stop();
+  delete this->rosnode_;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Load the controller
+void GazeboRosLinkWrenches::Load(physics::ModelPtr _model, sdf::ElementPtr _sdf)
+{
+  GAZEBO_ROS_STARTUP_PHASE("load");
+
+  this->robot_namespace_ = "";
+  if (_sdf->HasElement("robotNamespace"))
+    this->robot_namespace_ = _sdf->GetElement("robotNamespace")->Get<std::string>() + "/";
+
+  if (!_sdf->HasElement("topicName"))
+  {
+    ROS_FATAL_NAMED("link_wrenches", "link wrenches plugin missing <topicName>, cannot proceed");
+    return;
+  }
+  else
+    this->topic_name_ = _sdf->GetElement("topicName")->Get<std::string>();
+
+  // the links are resolved once, messages only carry their index
+  if (_sdf->HasElement("link"))
+  {
+    for (sdf::ElementPtr elem = _sdf->GetElement("link"); elem;
+         elem = elem->GetNextElement("link"))
+    {
+      std::string name = elem->Get<std::string>();
+      physics::LinkPtr link = _model->GetLink(name);
+      if (!link)
+      {
+        ROS_FATAL_NAMED("link_wrenches", "gazebo_ros_link_wrenches plugin error: link named: %s does not exist\n", name.c_str());
+        return;
+      }
+      this->links_.push_back(link);
+    }
+  }
+  else
+    this->links_ = _model->GetLinks();
+
+  // Make sure the ROS node for Gazebo has already been initialized
+  if (!ros::isInitialized())
+  {
+    ROS_FATAL_STREAM_NAMED("link_wrenches", "A ROS node for Gazebo has not been initialized, unable to load plugin. "
+      << "Load the Gazebo system plugin 'libgazebo_ros_api_plugin.so' in the gazebo_ros package)");
+    return;
+  }
+
+  this->rosnode_ = new ros::NodeHandle(this->robot_namespace_);
+
+  std::vector<std::string> names;
+  for (size_t i = 0; i < this->links_.size(); ++i)
+    names.push_back(this->links_[i]->GetName());
+  this->rosnode_->setParam(this->topic_name_ + "/links", names);
+
+  this->latency_ = TimingRegistry::instance().stage(
+    "gazebo_ros_link_wrenches " + this->rosnode_->resolveName(this->topic_name_),
+    "command_latency");
+
+  ros::SubscribeOptions so = ros::SubscribeOptions::create<gazebo_msgs::LinkWrenches>(
+    this->topic_name_, 1,
+    boost::bind(&GazeboRosLinkWrenches::OnWrenches, this, _1),
+    ros::VoidPtr(), &this->queue_);
+  GetSubscriptionHints(*this->rosnode_, _sdf).apply(so);
+  this->sub_ = this->rosnode_->subscribe(so);
+
+  this->update_connection_ = event::Events::ConnectWorldUpdateBegin(
+      boost::bind(&GazeboRosLinkWrenches::UpdateChild, this));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Resolve the links of a message off the physics thread
+void GazeboRosLinkWrenches::OnWrenches(
+  const gazebo_msgs::LinkWrenches::ConstPtr& _msg)
+{
+  const size_t n = _msg->link.size();
+  if (_msg->wrench.size() != n || (!_msg->frame.empty() && _msg->frame.size() != n))
+  {
+    ROS_WARN_THROTTLE_NAMED(1.0, "link_wrenches", "link wrenches plugin ignores a message of %lu links, %lu wrenches and %lu frames",
+      static_cast<unsigned long>(n), static_cast<unsigned long>(_msg->wrench.size()),
+      static_cast<unsigned long>(_msg->frame.size()));
+    return;
+  }
+
+  Batch batch;
+  batch.links.reserve(n);
+  batch.forces.reserve(n);
+  batch.torques.reserve(n);
+  batch.relative.reserve(n);
+  for (size_t i = 0; i < n; ++i)
+  {
+    if (_msg->link[i] >= this->links_.size())
+    {
+      ROS_WARN_THROTTLE_NAMED(1.0, "link_wrenches", "link wrenches plugin has no link %u, it has %lu",
+        _msg->link[i], static_cast<unsigned long>(this->links_.size()));
+      continue;
+    }
+    const geometry_msgs::Wrench &wrench = _msg->wrench[i];
+    batch.links.push_back(this->links_[_msg->link[i]].get());
+    batch.forces.push_back(ignition::math::Vector3d(
+      wrench.force.x, wrench.force.y, wrench.force.z));
+    batch.torques.push_back(ignition::math::Vector3d(
+      wrench.torque.x, wrench.torque.y, wrench.torque.z));
+    batch.relative.push_back(!_msg->frame.empty() &&
+      _msg->frame[i] == gazebo_msgs::LinkWrenches::LINK);
+  }
+  batch.stamp = SteadyNow();
+
+  boost::mutex::scoped_lock lock(this->lock_);
+  std::swap(this->pending_, batch);
+  this->pending_ready_ = true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Apply all wrenches
+void GazeboRosLinkWrenches::UpdateChild()
+{
+  GAZEBO_ROS_PROFILE("GazeboRosLinkWrenches::UpdateChild");
+  {
+    boost::mutex::scoped_lock lock(this->lock_);
+    if (this->pending_ready_)
+    {
+      std::swap(this->active_, this->pending_);
+      this->pending_ready_ = false;
+      this->latency_->record(SteadyNow() - this->active_.stamp);
+    }
+  }
+
+  const Batch &batch = this->active_;
+  for (size_t i = 0; i < batch.links.size(); ++i)
+  {
+    if (batch.relative[i])
+    {
+      batch.links[i]->AddRelativeForce(batch.forces[i]);
+      batch.links[i]->AddRelativeTorque(batch.torques[i]);
+    }
+    else
+    {
+      batch.links[i]->AddForce(batch.forces[i]);
+      batch.links[i]->AddTorque(batch.torques[i]);
+    }
+  }
+}
+}
@@ -20,7 +20,11 @@
  * Date: 10 June 2013
  */
 
+#include <algorithm>
+#include <cstring>
+#include <future>
 #include <string>
+#include <vector>
 
 #include <gazebo/sensors/Sensor.hh>
 #include <gazebo/sensors/MultiCameraSensor.hh>
@@ -28,9 +32,7 @@
 
 #include "gazebo_plugins/gazebo_ros_multicamera.h"
 
-#ifdef ENABLE_PROFILER
-#include <ignition/common/Profiler.hh>
-#endif
+#include <gazebo_ros/profiler.h>
 
 namespace gazebo
 {
@@ -40,6 +42,7 @@ GZ_REGISTER_SENSOR_PLUGIN(GazeboRosMultiCamera)
 ////////////////////////////////////////////////////////////////////////////////
 // Constructor
 GazeboRosMultiCamera::GazeboRosMultiCamera()
+  : paired_output_(PAIRED_NONE), side_by_side_failed_(false)
 {
 }
 
@@ -47,11 +50,20 @@ GazeboRosMultiCamera::GazeboRosMultiCamera()
 // Destructor
 GazeboRosMultiCamera::~GazeboRosMultiCamera()
 {
+  if (this->pair_node_)
+  {
+    this->side_by_side_pub_.shutdown();
+    this->pair_node_->shutdown();
+    this->pair_queue_.clear();
+    this->pair_queue_.disable();
+    this->pair_queue_.Stop();
+  }
 }
 
 void GazeboRosMultiCamera::Load(sensors::SensorPtr _parent,
   sdf::ElementPtr _sdf)
 {
+  GAZEBO_ROS_STARTUP_PHASE("load");
   MultiCameraPlugin::Load(_parent, _sdf);
 
   // Make sure the ROS node for Gazebo has already been initialized
@@ -65,6 +77,7 @@ void GazeboRosMultiCamera::Load(sensors::SensorPtr _parent,
   // initialize shared_ptr members
   this->image_connect_count_ = boost::shared_ptr<int>(new int(0));
   this->image_connect_count_lock_ = boost::shared_ptr<boost::mutex>(new boost::mutex);
+  this->sensor_connect_count_ = boost::shared_ptr<int>(new int(0));
   this->was_active_ = boost::shared_ptr<bool>(new bool(false));
 
   // copying from CameraPlugin into GazeboRosCameraUtils
@@ -80,6 +93,7 @@ void GazeboRosMultiCamera::Load(sensors::SensorPtr _parent,
     // Set up a shared connection counter
     util->image_connect_count_ = this->image_connect_count_;
     util->image_connect_count_lock_ = this->image_connect_count_lock_;
+    util->sensor_connect_count_ = this->sensor_connect_count_;
     util->was_active_ = this->was_active_;
     if (this->camera[i]->Name().find("left") != std::string::npos)
     {
@@ -95,6 +109,36 @@ void GazeboRosMultiCamera::Load(sensors::SensorPtr _parent,
     }
     this->utils.push_back(util);
   }
+
+  if (_sdf->HasElement("pairedOutput"))
+  {
+    std::string paired_output = _sdf->Get<std::string>("pairedOutput");
+    if (paired_output == "pair")
+      this->paired_output_ = PAIRED_PAIR;
+    else if (paired_output == "side_by_side")
+      this->paired_output_ = PAIRED_SIDE_BY_SIDE;
+    else if (paired_output != "none")
+      ROS_WARN_NAMED("multicamera", "Unknown <pairedOutput> [%s], expected "
+                     "none, pair or side_by_side", paired_output.c_str());
+  }
+  this->paired_frames_.assign(this->utils.size(), NULL);
+
+  if (this->paired_output_ == PAIRED_SIDE_BY_SIDE)
+  {
+    std::string camera_name;
+    if (_sdf->HasElement("cameraName"))
+      camera_name = _sdf->Get<std::string>("cameraName");
+    this->pair_node_.reset(new ros::NodeHandle(
+        GetRobotNamespace(_parent, _sdf, "Camera") + "/" + camera_name));
+
+    ros::AdvertiseOptions side_by_side_ao =
+      ros::AdvertiseOptions::create<sensor_msgs::Image>(
+        "image_side_by_side", 2,
+        boost::bind(&GazeboRosMultiCamera::SideBySideConnect, this),
+        boost::bind(&GazeboRosMultiCamera::SideBySideDisconnect, this),
+        ros::VoidPtr(), &this->pair_queue_);
+    this->side_by_side_pub_ = this->pair_node_->advertise(side_by_side_ao);
+  }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -102,9 +146,7 @@ void GazeboRosMultiCamera::Load(sensors::SensorPtr _parent,
 void GazeboRosMultiCamera::OnNewFrame(const unsigned char *_image,
     GazeboRosCameraUtils* util)
 {
-#ifdef ENABLE_PROFILER
-  IGN_PROFILE("GazeboRosMultiCamera::OnNewFrame");
-#endif
+  GAZEBO_ROS_PROFILE("GazeboRosMultiCamera::OnNewFrame");
 # if GAZEBO_MAJOR_VERSION >= 7
   common::Time sensor_update_time = util->parentSensor_->LastMeasurementTime();
 # else
@@ -115,18 +157,12 @@ void GazeboRosMultiCamera::OnNewFrame(const unsigned char *_image,
   {
     if (sensor_update_time - util->last_update_time_ >= util->update_period_)
     {
-#ifdef ENABLE_PROFILER
-      IGN_PROFILE_BEGIN("PutCameraData");
-#endif
+      GAZEBO_ROS_PROFILE_BEGIN("PutCameraData");
       util->PutCameraData(_image, sensor_update_time);
-#ifdef ENABLE_PROFILER
-      IGN_PROFILE_END();
-      IGN_PROFILE_BEGIN("PublishCameraInfo");
-#endif
+      GAZEBO_ROS_PROFILE_END();
+      GAZEBO_ROS_PROFILE_BEGIN("PublishCameraInfo");
       util->PublishCameraInfo(sensor_update_time);
-#ifdef ENABLE_PROFILER
-      IGN_PROFILE_END();
-#endif
+      GAZEBO_ROS_PROFILE_END();
       util->last_update_time_ = sensor_update_time;
     }
   }
@@ -137,7 +173,10 @@ void GazeboRosMultiCamera::OnNewFrameLeft(const unsigned char *_image,
     unsigned int _width, unsigned int _height, unsigned int _depth,
     const std::string &_format)
 {
-  OnNewFrame(_image, this->utils[0]);
+  if (this->paired_output_ != PAIRED_NONE)
+    this->OnPairedFrame(_image, 0);
+  else
+    OnNewFrame(_image, this->utils[0]);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -146,6 +185,158 @@ void GazeboRosMultiCamera::OnNewFrameRight(const unsigned char *_image,
     unsigned int _width, unsigned int _height, unsigned int _depth,
     const std::string &_format)
 {
-  OnNewFrame(_image, this->utils[1]);
+  if (this->paired_output_ != PAIRED_NONE)
+    this->OnPairedFrame(_image, 1);
+  else
+    OnNewFrame(_image, this->utils[1]);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void GazeboRosMultiCamera::OnPairedFrame(const unsigned char *_image,
+    size_t _index)
+{
+  if (_index >= this->paired_frames_.size())
+    return;
+
+# if GAZEBO_MAJOR_VERSION >= 7
+  common::Time sensor_update_time = this->parentSensor->LastMeasurementTime();
+# else
+  common::Time sensor_update_time = this->parentSensor->GetLastMeasurementTime();
+# endif
+
+  // the new frame events of one sensor update all carry its measurement
+  // time, and the frames stay valid until the next render
+  if (sensor_update_time != this->paired_time_)
+  {
+    std::fill(this->paired_frames_.begin(), this->paired_frames_.end(),
+              static_cast<const unsigned char *>(NULL));
+    this->paired_time_ = sensor_update_time;
+  }
+  this->paired_frames_[_index] = _image;
+
+  for (size_t i = 0; i < this->paired_frames_.size(); ++i)
+  {
+    if (!this->paired_frames_[i])
+      return;
+  }
+
+  this->PublishPair(sensor_update_time);
+  std::fill(this->paired_frames_.begin(), this->paired_frames_.end(),
+            static_cast<const unsigned char *>(NULL));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void GazeboRosMultiCamera::PublishPair(common::Time _stamp)
+{
+  GAZEBO_ROS_PROFILE("GazeboRosMultiCamera::PublishPair");
+  if (!this->parentSensor->IsActive())
+    return;
+
+  GazeboRosCameraUtils *first = this->utils[0];
+  if (_stamp - first->last_update_time_ < first->update_period_)
+    return;
+
+  // in side by side mode, a camera without subscribers of its own only
+  // contributes to the combined frame
+  bool side_by_side = this->paired_output_ == PAIRED_SIDE_BY_SIDE;
+
+  // the other cameras convert on their own threads while the first one
+  // converts here
+  std::vector<std::future<void> > conversions;
+  for (size_t i = 1; i < this->utils.size(); ++i)
+  {
+    if (side_by_side && this->utils[i]->image_pub_.getNumSubscribers() == 0)
+      continue;
+    conversions.push_back(std::async(std::launch::async,
+      [this, i, _stamp]()
+      {
+        common::Time stamp = _stamp;
+        this->utils[i]->PutCameraData(this->paired_frames_[i], stamp);
+      }));
+  }
+  GAZEBO_ROS_PROFILE_BEGIN("PutCameraData");
+  if (!side_by_side || first->image_pub_.getNumSubscribers() > 0)
+    first->PutCameraData(this->paired_frames_[0], _stamp);
+  GAZEBO_ROS_PROFILE_END();
+
+  if (side_by_side && this->side_by_side_pub_.getNumSubscribers() > 0 &&
+      this->FillSideBySide(_stamp))
+  {
+    GAZEBO_ROS_PROFILE_BEGIN("PublishSideBySide");
+    this->side_by_side_pub_.publish(this->side_by_side_image_);
+    GAZEBO_ROS_PROFILE_END();
+  }
+
+  for (size_t i = 0; i < conversions.size(); ++i)
+    conversions[i].wait();
+
+  GAZEBO_ROS_PROFILE_BEGIN("PublishCameraInfo");
+  for (size_t i = 0; i < this->utils.size(); ++i)
+  {
+    this->utils[i]->PublishCameraInfo(_stamp);
+    this->utils[i]->last_update_time_ = _stamp;
+  }
+  GAZEBO_ROS_PROFILE_END();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool GazeboRosMultiCamera::FillSideBySide(const common::Time &_stamp)
+{
+  if (this->side_by_side_failed_)
+    return false;
+
+  GazeboRosCameraUtils *first = this->utils[0];
+  size_t step = 0;
+  unsigned int width = 0;
+  for (size_t i = 0; i < this->utils.size(); ++i)
+  {
+    GazeboRosCameraUtils *util = this->utils[i];
+    if (util->height_ != first->height_ || util->type_ != first->type_)
+    {
+      ROS_WARN_NAMED("multicamera", "Cameras of [%s] differ in height or "
+                     "encoding, not publishing image_side_by_side",
+                     this->parentSensor->Name().c_str());
+      this->side_by_side_failed_ = true;
+      return false;
+    }
+    step += util->skip_ * util->width_;
+    width += util->width_;
+  }
+
+  sensor_msgs::Image &image = this->side_by_side_image_;
+  image.header.frame_id = first->frame_name_;
+  image.header.stamp.sec = _stamp.sec;
+  image.header.stamp.nsec = _stamp.nsec;
+  image.height = first->height_;
+  image.width = width;
+  image.encoding = first->type_;
+  image.is_bigendian = 0;
+  image.step = step;
+  image.data.resize(step * image.height);
+
+  // row by row, the left camera first
+  for (unsigned int row = 0; row < image.height; ++row)
+  {
+    unsigned char *dst = &image.data[row * step];
+    for (size_t i = 0; i < this->utils.size(); ++i)
+    {
+      size_t camera_step = this->utils[i]->skip_ * this->utils[i]->width_;
+      memcpy(dst, this->paired_frames_[i] + row * camera_step, camera_step);
+      dst += camera_step;
+    }
+  }
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void GazeboRosMultiCamera::SideBySideConnect()
+{
+  this->utils[0]->ImageConnect();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void GazeboRosMultiCamera::SideBySideDisconnect()
+{
+  this->utils[0]->ImageDisconnect();
 }
 }
@@ -0,0 +1,212 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <cmath>
+
+#include <gazebo_plugins/gazebo_ros_noise.h>
+
+namespace gazebo
+{
+namespace
+{
+/// \brief Number of ziggurat layers, a power of two
+const int kLayers = 128;
+/// \brief Start of the tail
+const double kTailStart = 3.442619855899;
+/// \brief Area of each layer
+const double kLayerArea = 9.91256303526217e-3;
+
+/// \brief Ziggurat tables (Marsaglia & Tsang 2000, in the layout of
+/// Doornik 2005): x_[i] is the right edge of layer i, ratio_[i] the part of
+/// layer i that lies entirely under the density.
+struct Ziggurat
+{
+  Ziggurat()
+  {
+    double f = exp(-0.5 * kTailStart * kTailStart);
+    x_[0] = kLayerArea / f;
+    x_[1] = kTailStart;
+    x_[kLayers] = 0;
+    for (int i = 2; i < kLayers; ++i)
+    {
+      x_[i] = sqrt(-2 * log(kLayerArea / x_[i - 1] + f));
+      f = exp(-0.5 * x_[i] * x_[i]);
+    }
+    for (int i = 0; i < kLayers; ++i)
+      ratio_[i] = x_[i + 1] / x_[i];
+  }
+
+  double x_[kLayers + 1];
+  double ratio_[kLayers];
+};
+
+const Ziggurat &Tables()
+{
+  static const Ziggurat tables;
+  return tables;
+}
+
+/// \brief splitmix64, expands a seed into generator state
+uint64_t SplitMix(uint64_t &_x)
+{
+  uint64_t z = (_x += 0x9e3779b97f4a7c15ULL);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+inline uint64_t Rotl(uint64_t _x, int _k)
+{
+  return (_x << _k) | (_x >> (64 - _k));
+}
+
+/// \brief Uniform in (0, 1) from the top 53 bits
+inline double ToUniform(uint64_t _bits)
+{
+  return ((_bits >> 11) + 0.5) * (1.0 / 9007199254740992.0);
+}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+GaussianNoise::GaussianNoise(uint64_t _seed)
+{
+  // build the tables before the first sample
+  Tables();
+  this->Seed(_seed);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void GaussianNoise::Seed(uint64_t _seed)
+{
+  uint64_t x = _seed;
+  for (int i = 0; i < 4; ++i)
+    this->state_[i] = SplitMix(x);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+uint64_t GaussianNoise::SeedFromSdf(sdf::ElementPtr _sdf,
+                                    const std::string &_scope)
+{
+  if (_sdf->HasElement("noiseSeed"))
+    return _sdf->GetElement("noiseSeed")->Get<unsigned int>();
+
+  std::string name = _scope;
+  if (_sdf->HasAttribute("name"))
+    name += "::" + _sdf->GetAttribute("name")->GetAsString();
+
+  // FNV-1a, stable across runs and platforms unlike std::hash
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (size_t i = 0; i < name.size(); ++i)
+  {
+    hash ^= static_cast<unsigned char>(name[i]);
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+uint64_t GaussianNoise::Next()
+{
+  // xoshiro256** (Blackman & Vigna)
+  uint64_t *s = this->state_;
+  const uint64_t result = Rotl(s[1] * 5, 7) * 9;
+  const uint64_t t = s[1] << 17;
+  s[2] ^= s[0];
+  s[3] ^= s[1];
+  s[1] ^= s[2];
+  s[0] ^= s[3];
+  s[2] ^= t;
+  s[3] = Rotl(s[3], 45);
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+double GaussianNoise::Uniform()
+{
+  return ToUniform(this->Next());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+double GaussianNoise::Tail(bool _negative)
+{
+  double x, y;
+  do
+  {
+    x = log(this->Uniform()) / kTailStart;
+    y = log(this->Uniform());
+  } while (-2 * y < x * x);
+  return _negative ? x - kTailStart : kTailStart - x;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+double GaussianNoise::Normal()
+{
+  const Ziggurat &zig = Tables();
+  for (;;)
+  {
+    // the top 53 bits give the position in the layer, the low 7 the layer
+    const uint64_t bits = this->Next();
+    const double u = 2 * ToUniform(bits) - 1;
+    const int i = bits & (kLayers - 1);
+
+    // inside the part of the layer under the density: the common case
+    if (fabs(u) < zig.ratio_[i])
+      return u * zig.x_[i];
+
+    if (i == 0)
+      return this->Tail(u < 0);
+
+    const double x = u * zig.x_[i];
+    const double f0 = exp(-0.5 * (zig.x_[i] * zig.x_[i] - x * x));
+    const double f1 = exp(-0.5 * (zig.x_[i + 1] * zig.x_[i + 1] - x * x));
+    if (f1 + this->Uniform() * (f0 - f1) < 1.0)
+      return x;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void GaussianNoise::Fill(float *_out, size_t _n, double _mu, double _sigma)
+{
+  for (size_t i = 0; i < _n; ++i)
+    _out[i] = _mu + _sigma * this->Normal();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void GaussianNoise::Fill(double *_out, size_t _n, double _mu, double _sigma)
+{
+  for (size_t i = 0; i < _n; ++i)
+    _out[i] = _mu + _sigma * this->Normal();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void GaussianNoise::Add(float *_data, size_t _n, double _sigma)
+{
+  if (_sigma == 0.0)
+    return;
+  for (size_t i = 0; i < _n; ++i)
+    _data[i] += _sigma * this->Normal();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void GaussianNoise::Add(double *_data, size_t _n, double _sigma)
+{
+  if (_sigma == 0.0)
+    return;
+  for (size_t i = 0; i < _n; ++i)
+    _data[i] += _sigma * this->Normal();
+}
+}
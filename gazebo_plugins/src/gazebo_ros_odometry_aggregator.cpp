@@ -0,0 +1,165 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <string>
+
+#include <boost/bind.hpp>
+
+#include <gazebo_plugins/gazebo_ros_odometry_aggregator.h>
+#include <gazebo_plugins/gazebo_ros_utils.h>
+#include <gazebo_plugins/odometry_aggregator.h>
+
+#include <gazebo/physics/World.hh>
+
+#include <gazebo_ros/profiler.h>
+
+#include <sdf/sdf.hh>
+
+namespace gazebo
+{
+// Register this plugin with the simulator
+GZ_REGISTER_WORLD_PLUGIN(GazeboRosOdometryAggregator)
+
+////////////////////////////////////////////////////////////////////////////////
+// Constructor
+GazeboRosOdometryAggregator::GazeboRosOdometryAggregator()
+  : connect_count_(0), rosnode_(NULL), update_rate_(0), update_period_(0)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Destructor
+GazeboRosOdometryAggregator::~GazeboRosOdometryAggregator()
+{
+  this->update_connection_.reset();
+  OdometryAggregator::Instance().SetActive(false);
+
+  if (!this->rosnode_)
+    return;
+  this->queue_.clear();
+  this->queue_.disable();
+  this->rosnode_->shutdown();
+  this->queue_.Stop();
+  delete this->rosnode_;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Load the plugin
+void GazeboRosOdometryAggregator::Load(physics::WorldPtr _world,
+                                       sdf::ElementPtr _sdf)
+{
+  GAZEBO_ROS_STARTUP_PHASE("load");
+  this->world_ = _world;
+
+  this->robot_namespace_ = "";
+  if (_sdf->HasElement("robotNamespace"))
+    this->robot_namespace_ = _sdf->GetElement("robotNamespace")->Get<std::string>() + "/";
+
+  if (!_sdf->HasElement("topicName"))
+  {
+    ROS_INFO_NAMED("odometry_aggregator", "Odometry aggregator plugin missing <topicName>, defaults to /odometry_array");
+    this->topic_name_ = "/odometry_array";
+  }
+  else
+    this->topic_name_ = _sdf->GetElement("topicName")->Get<std::string>();
+
+  if (!_sdf->HasElement("updateRate"))
+  {
+    ROS_INFO_NAMED("odometry_aggregator", "Odometry aggregator plugin missing <updateRate>, defaults to 0");
+    this->update_rate_ = 0;
+  }
+  else
+    this->update_rate_ = _sdf->GetElement("updateRate")->Get<double>();
+
+  if (this->update_rate_ > 0.0)
+    this->update_period_ = 1.0/this->update_rate_;
+  else
+    this->update_period_ = 0.0;
+
+  // Make sure the ROS node for Gazebo has already been initialized
+  if (!ros::isInitialized())
+  {
+    ROS_FATAL_STREAM_NAMED("odometry_aggregator", "A ROS node for Gazebo has not been initialized, unable to load plugin. "
+      << "Load the Gazebo system plugin 'libgazebo_ros_api_plugin.so' in the gazebo_ros package)");
+    return;
+  }
+
+  this->rosnode_ = new ros::NodeHandle(this->robot_namespace_);
+
+  ros::AdvertiseOptions ao = ros::AdvertiseOptions::create<gazebo_msgs::OdometryArray>(
+    this->topic_name_, 1,
+    boost::bind(&GazeboRosOdometryAggregator::Connect, this),
+    boost::bind(&GazeboRosOdometryAggregator::Disconnect, this),
+    ros::VoidPtr(), &this->queue_);
+  this->pub_ = this->rosnode_->advertise(ao);
+
+#if GAZEBO_MAJOR_VERSION >= 8
+  this->last_publish_time_ = this->world_->SimTime();
+#else
+  this->last_publish_time_ = this->world_->GetSimTime();
+#endif
+
+  // the drive plugins submit at the beginning of the update
+  this->update_connection_ = event::Events::ConnectWorldUpdateEnd(
+      boost::bind(&GazeboRosOdometryAggregator::OnWorldUpdateEnd, this));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Publish the latest odometry of all robots
+void GazeboRosOdometryAggregator::OnWorldUpdateEnd()
+{
+  OdometryAggregator &aggregator = OdometryAggregator::Instance();
+  if (!aggregator.Active())
+    return;
+
+  GAZEBO_ROS_PROFILE("GazeboRosOdometryAggregator::OnWorldUpdateEnd");
+#if GAZEBO_MAJOR_VERSION >= 8
+  common::Time cur_time = this->world_->SimTime();
+#else
+  common::Time cur_time = this->world_->GetSimTime();
+#endif
+  if (this->update_period_ > 0 &&
+      (cur_time - this->last_publish_time_).Double() < this->update_period_)
+    return;
+
+  if (!aggregator.Collect(this->array_msg_))
+    return;
+  this->last_publish_time_ = cur_time;
+
+  this->array_msg_.header.stamp.sec = cur_time.sec;
+  this->array_msg_.header.stamp.nsec = cur_time.nsec;
+  this->pub_.publish(this->array_msg_);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Someone subscribes to the array
+void GazeboRosOdometryAggregator::Connect()
+{
+  boost::mutex::scoped_lock lock(this->lock_);
+  if (this->connect_count_++ == 0)
+    OdometryAggregator::Instance().SetActive(true);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Someone unsubscribes from the array
+void GazeboRosOdometryAggregator::Disconnect()
+{
+  boost::mutex::scoped_lock lock(this->lock_);
+  if (--this->connect_count_ == 0)
+    OdometryAggregator::Instance().SetActive(false);
+}
+}
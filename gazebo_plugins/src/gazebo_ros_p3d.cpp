@@ -20,10 +20,9 @@
 #include <stdlib.h>
 
 #include "gazebo_plugins/gazebo_ros_p3d.h"
-#ifdef ENABLE_PROFILER
-#include <ignition/common/Profiler.hh>
-#endif
-#include <ignition/math/Rand.hh>
+#include <gazebo_plugins/gazebo_ros_utils.h>
+#include <gazebo_plugins/sensor_recorder.h>
+#include <gazebo_ros/profiler.h>
 
 namespace gazebo
 {
@@ -31,7 +30,10 @@ GZ_REGISTER_MODEL_PLUGIN(GazeboRosP3D);
 
 ////////////////////////////////////////////////////////////////////////////////
 // Constructor
-GazeboRosP3D::GazeboRosP3D()
+GazeboRosP3D::GazeboRosP3D() :
+  rosnode_(NULL),
+  update_timing_(NULL),
+  publish_timing_(NULL)
 {
 }
 
@@ -39,12 +41,16 @@ GazeboRosP3D::GazeboRosP3D()
 // Destructor
 GazeboRosP3D::~GazeboRosP3D()
 {
+  if (this->deferred_load_task_)
+    this->deferred_load_task_->Wait();
   this->update_connection_.reset();
   // Finalize the controller
+  if (!this->rosnode_)
+    return;
   this->rosnode_->shutdown();
   this->p3d_queue_.clear();
   this->p3d_queue_.disable();
-  this->callback_queue_thread_.join();
+  this->p3d_queue_.Stop();
   delete this->rosnode_;
 }
 
@@ -52,6 +58,7 @@ GazeboRosP3D::~GazeboRosP3D()
 // Load the controller
 void GazeboRosP3D::Load(physics::ModelPtr _parent, sdf::ElementPtr _sdf)
 {
+  GAZEBO_ROS_STARTUP_PHASE("load");
   // Get the world name.
   this->world_ = _parent->GetWorld();
   this->model_ = _parent;
@@ -62,29 +69,26 @@ void GazeboRosP3D::Load(physics::ModelPtr _parent, sdf::ElementPtr _sdf)
     this->robot_namespace_ =
       _sdf->GetElement("robotNamespace")->Get<std::string>() + "/";
 
-  if (!_sdf->HasElement("bodyName"))
-  {
-    ROS_FATAL_NAMED("p3d", "p3d plugin missing <bodyName>, cannot proceed");
-    return;
-  }
-  else
-    this->link_name_ = _sdf->GetElement("bodyName")->Get<std::string>();
+  if (_sdf->HasElement("batchTopicName"))
+    this->batch_topic_name_ = _sdf->GetElement("batchTopicName")->Get<std::string>();
 
-  this->link_ = _parent->GetLink(this->link_name_);
-  if (!this->link_)
+  std::string link_name;
+  std::string topic_name;
+  if (_sdf->HasElement("bodyName"))
+    link_name = _sdf->GetElement("bodyName")->Get<std::string>();
+  else if (!_sdf->HasElement("body"))
   {
-    ROS_FATAL_NAMED("p3d", "gazebo_ros_p3d plugin error: bodyName: %s does not exist\n",
-      this->link_name_.c_str());
+    ROS_FATAL_NAMED("p3d", "p3d plugin missing <bodyName>, cannot proceed");
     return;
   }
 
-  if (!_sdf->HasElement("topicName"))
+  if (_sdf->HasElement("topicName"))
+    topic_name = _sdf->GetElement("topicName")->Get<std::string>();
+  else if (!link_name.empty() && this->batch_topic_name_.empty())
   {
     ROS_FATAL_NAMED("p3d", "p3d plugin missing <topicName>, cannot proceed");
     return;
   }
-  else
-    this->topic_name_ = _sdf->GetElement("topicName")->Get<std::string>();
 
   if (!_sdf->HasElement("frameName"))
   {
@@ -117,6 +121,7 @@ void GazeboRosP3D::Load(physics::ModelPtr _parent, sdf::ElementPtr _sdf)
   }
   else
     this->gaussian_noise_ = _sdf->GetElement("gaussianNoise")->Get<double>();
+  this->noise_.Seed(GaussianNoise::SeedFromSdf(_sdf, _parent->GetScopedName()));
 
   if (!_sdf->HasElement("updateRate"))
   {
@@ -135,21 +140,67 @@ void GazeboRosP3D::Load(physics::ModelPtr _parent, sdf::ElementPtr _sdf)
     return;
   }
 
+  if (DeferredLoad::Requested(_sdf))
+    this->deferred_load_task_ = DeferredLoad::Instance().Run(this->handleName,
+      boost::bind(&GazeboRosP3D::LoadThread, this, _sdf, link_name, topic_name));
+  else
+    this->LoadThread(_sdf, link_name, topic_name);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Create the node, advertise and connect the update
+void GazeboRosP3D::LoadThread(sdf::ElementPtr _sdf,
+                              const std::string &_link_name,
+                              const std::string &_topic_name)
+{
   this->rosnode_ = new ros::NodeHandle(this->robot_namespace_);
 
   // publish multi queue
-  this->pmq.startServiceThread();
+  this->pmq.startService();
 
   // resolve tf prefix
   std::string prefix;
   this->rosnode_->getParam(std::string("tf_prefix"), prefix);
   this->tf_frame_name_ = tf::resolve(prefix, this->frame_name_);
 
-  if (this->topic_name_ != "")
+  // the links, <bodyName> first
+  if (!_link_name.empty() && !this->AddBody(_link_name, _topic_name, this->offset_))
+    return;
+  if (_sdf->HasElement("body"))
   {
-    this->pub_Queue = this->pmq.addPub<nav_msgs::Odometry>();
-    this->pub_ =
-      this->rosnode_->advertise<nav_msgs::Odometry>(this->topic_name_, 1);
+    for (sdf::ElementPtr body = _sdf->GetElement("body"); body;
+         body = body->GetNextElement("body"))
+    {
+      if (!body->HasElement("name"))
+      {
+        ROS_FATAL_NAMED("p3d", "p3d plugin <body> missing <name>, cannot proceed");
+        return;
+      }
+      ignition::math::Pose3d offset = this->offset_;
+      if (body->HasElement("xyzOffset"))
+        offset.Pos() = body->GetElement("xyzOffset")->Get<ignition::math::Vector3d>();
+      if (body->HasElement("rpyOffset"))
+        offset.Rot() = ignition::math::Quaterniond(body->GetElement("rpyOffset")->Get<ignition::math::Vector3d>());
+      std::string body_topic_name;
+      if (body->HasElement("topicName"))
+        body_topic_name = body->GetElement("topicName")->Get<std::string>();
+      if (!this->AddBody(body->GetElement("name")->Get<std::string>(), body_topic_name, offset))
+        return;
+    }
+  }
+
+  TimingRegistry &timing = TimingRegistry::instance();
+  const std::string timing_name = "gazebo_ros_p3d " + this->robot_namespace_ +
+    (this->batch_topic_name_.empty() ? this->bodies_[0].topic_name : this->batch_topic_name_);
+  this->update_timing_ = timing.stage(timing_name, "update");
+  this->publish_timing_ = timing.stage(timing_name, "publish");
+
+  this->batch_msg_.header.frame_id = this->tf_frame_name_;
+  if (this->batch_topic_name_ != "")
+  {
+    this->batch_pub_queue_ = this->pmq.addPub<gazebo_msgs::OdometryArray>();
+    this->batch_pub_ =
+      this->rosnode_->advertise<gazebo_msgs::OdometryArray>(this->batch_topic_name_, 1);
   }
 
 #if GAZEBO_MAJOR_VERSION >= 8
@@ -157,16 +208,6 @@ void GazeboRosP3D::Load(physics::ModelPtr _parent, sdf::ElementPtr _sdf)
 #else
   this->last_time_ = this->world_->GetSimTime();
 #endif
-  // initialize body
-#if GAZEBO_MAJOR_VERSION >= 8
-  this->last_vpos_ = this->link_->WorldLinearVel();
-  this->last_veul_ = this->link_->WorldAngularVel();
-#else
-  this->last_vpos_ = this->link_->GetWorldLinearVel().Ign();
-  this->last_veul_ = this->link_->GetWorldAngularVel().Ign();
-#endif
-  this->apos_ = 0;
-  this->aeul_ = 0;
 
   // if frameName specified is "/world", "world", "/map" or "map" report
   // back inertial values in the gazebo world
@@ -199,11 +240,6 @@ void GazeboRosP3D::Load(physics::ModelPtr _parent, sdf::ElementPtr _sdf)
 #endif
   }
 
-
-  // start custom queue for p3d
-  this->callback_queue_thread_ = boost::thread(
-    boost::bind(&GazeboRosP3D::P3DQueueThread, this));
-
   // New Mechanism for Updating every World Cycle
   // Listen to the update event. This event is broadcast every
   // simulation iteration.
@@ -211,24 +247,85 @@ void GazeboRosP3D::Load(physics::ModelPtr _parent, sdf::ElementPtr _sdf)
       boost::bind(&GazeboRosP3D::UpdateChild, this));
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Add a tracked link
+bool GazeboRosP3D::AddBody(const std::string &_link_name,
+                           const std::string &_topic_name,
+                           const ignition::math::Pose3d &_offset)
+{
+  Body body;
+  body.link_name = _link_name;
+  body.link = this->model_->GetLink(_link_name);
+  if (!body.link)
+  {
+    ROS_FATAL_NAMED("p3d", "gazebo_ros_p3d plugin error: bodyName: %s does not exist\n",
+      _link_name.c_str());
+    return false;
+  }
+  body.topic_name = _topic_name;
+  body.offset = _offset;
+
+  if (body.topic_name != "")
+  {
+    body.pub_queue = this->pmq.addPub<nav_msgs::Odometry>();
+    body.pub =
+      this->rosnode_->advertise<nav_msgs::Odometry>(body.topic_name, 1);
+  }
+
+  // initialize body
+#if GAZEBO_MAJOR_VERSION >= 8
+  body.last_vpos = body.link->WorldLinearVel();
+  body.last_veul = body.link->WorldAngularVel();
+#else
+  body.last_vpos = body.link->GetWorldLinearVel().Ign();
+  body.last_veul = body.link->GetWorldAngularVel().Ign();
+#endif
+  body.apos = 0;
+  body.aeul = 0;
+  this->bodies_.push_back(body);
+
+  // the message of the link, frames and covariance do not change
+  nav_msgs::Odometry pose_msg;
+  pose_msg.header.frame_id = this->tf_frame_name_;
+  pose_msg.child_frame_id = _link_name;
+
+  // fill in covariance matrix
+  /// @todo: let user set separate linear and angular covariance values.
+  double gn2 = this->gaussian_noise_*this->gaussian_noise_;
+  pose_msg.pose.covariance[0] = gn2;
+  pose_msg.pose.covariance[7] = gn2;
+  pose_msg.pose.covariance[14] = gn2;
+  pose_msg.pose.covariance[21] = gn2;
+  pose_msg.pose.covariance[28] = gn2;
+  pose_msg.pose.covariance[35] = gn2;
+
+  pose_msg.twist.covariance[0] = gn2;
+  pose_msg.twist.covariance[7] = gn2;
+  pose_msg.twist.covariance[14] = gn2;
+  pose_msg.twist.covariance[21] = gn2;
+  pose_msg.twist.covariance[28] = gn2;
+  pose_msg.twist.covariance[35] = gn2;
+
+  this->batch_msg_.name.push_back(_link_name);
+  this->batch_msg_.odometry.push_back(pose_msg);
+  return true;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Update the controller
 void GazeboRosP3D::UpdateChild()
 {
-#ifdef ENABLE_PROFILER
-  IGN_PROFILE("GazeboRosP3D::UpdateChild");
-#endif
-  if (!this->link_)
+  GAZEBO_ROS_PROFILE("GazeboRosP3D::UpdateChild");
+  if (this->bodies_.empty())
     return;
+  ScopedTiming timing(this->update_timing_);
 
 #if GAZEBO_MAJOR_VERSION >= 8
   common::Time cur_time = this->world_->SimTime();
 #else
   common::Time cur_time = this->world_->GetSimTime();
 #endif
-#ifdef ENABLE_PROFILER
-  IGN_PROFILE_BEGIN("fill ROS message");
-#endif
+  GAZEBO_ROS_PROFILE_BEGIN("fill ROS message");
   if (cur_time < this->last_time_)
   {
       ROS_WARN_NAMED("p3d", "Negative update time difference detected.");
@@ -240,7 +337,13 @@ void GazeboRosP3D::UpdateChild()
       (cur_time-this->last_time_).Double() < (1.0/this->update_rate_))
     return;
 
-  if (this->pub_.getNumSubscribers() > 0)
+  // only read the links if anyone listens
+  const bool publish_batch = this->batch_pub_ && this->batch_pub_.getNumSubscribers() > 0;
+  bool listened = publish_batch;
+  for (size_t i = 0; i < this->bodies_.size() && !listened; ++i)
+    listened = this->bodies_[i].pub && this->bodies_[i].pub.getNumSubscribers() > 0;
+
+  if (listened)
   {
     // differentiate to get accelerations
     double tmp_dt = cur_time.Double() - this->last_time_.Double();
@@ -248,46 +351,54 @@ void GazeboRosP3D::UpdateChild()
     {
       this->lock.lock();
 
-      if (this->topic_name_ != "")
+      // the reference frame is read once for all links
+      ignition::math::Pose3d frame_pose;
+      ignition::math::Vector3d frame_vpos;
+      ignition::math::Vector3d frame_veul;
+      if (this->reference_link_)
       {
-        // copy data into pose message
-        this->pose_msg_.header.frame_id = this->tf_frame_name_;
-        this->pose_msg_.header.stamp.sec = cur_time.sec;
-        this->pose_msg_.header.stamp.nsec = cur_time.nsec;
+#if GAZEBO_MAJOR_VERSION >= 8
+        frame_pose = this->reference_link_->WorldPose();
+        frame_vpos = this->reference_link_->WorldLinearVel();
+        frame_veul = this->reference_link_->WorldAngularVel();
+#else
+        frame_pose = this->reference_link_->GetWorldPose().Ign();
+        frame_vpos = this->reference_link_->GetWorldLinearVel().Ign();
+        frame_veul = this->reference_link_->GetWorldAngularVel().Ign();
+#endif
+      }
+      this->frame_apos_ = (this->last_frame_vpos_ - frame_vpos) / tmp_dt;
+      this->frame_aeul_ = (this->last_frame_veul_ - frame_veul) / tmp_dt;
+      this->last_frame_vpos_ = frame_vpos;
+      this->last_frame_veul_ = frame_veul;
 
-        this->pose_msg_.child_frame_id = this->link_name_;
+      for (size_t i = 0; i < this->bodies_.size(); ++i)
+      {
+        Body &body = this->bodies_[i];
+        nav_msgs::Odometry &pose_msg = this->batch_msg_.odometry[i];
 
-        ignition::math::Pose3d pose, frame_pose;
-        ignition::math::Vector3d frame_vpos;
-        ignition::math::Vector3d frame_veul;
+        // copy data into pose message
+        pose_msg.header.stamp.sec = cur_time.sec;
+        pose_msg.header.stamp.nsec = cur_time.nsec;
 
         // get inertial Rates
         // Get Pose/Orientation
 #if GAZEBO_MAJOR_VERSION >= 8
-        ignition::math::Vector3d vpos = this->link_->WorldLinearVel();
-        ignition::math::Vector3d veul = this->link_->WorldAngularVel();
+        ignition::math::Vector3d vpos = body.link->WorldLinearVel();
+        ignition::math::Vector3d veul = body.link->WorldAngularVel();
 
-        pose = this->link_->WorldPose();
+        ignition::math::Pose3d pose = body.link->WorldPose();
 #else
-        ignition::math::Vector3d vpos = this->link_->GetWorldLinearVel().Ign();
-        ignition::math::Vector3d veul = this->link_->GetWorldAngularVel().Ign();
+        ignition::math::Vector3d vpos = body.link->GetWorldLinearVel().Ign();
+        ignition::math::Vector3d veul = body.link->GetWorldAngularVel().Ign();
 
-        pose = this->link_->GetWorldPose().Ign();
+        ignition::math::Pose3d pose = body.link->GetWorldPose().Ign();
 #endif
 
         // Apply Reference Frame
         if (this->reference_link_)
         {
           // convert to relative pose, rates
-#if GAZEBO_MAJOR_VERSION >= 8
-          frame_pose = this->reference_link_->WorldPose();
-          frame_vpos = this->reference_link_->WorldLinearVel();
-          frame_veul = this->reference_link_->WorldAngularVel();
-#else
-          frame_pose = this->reference_link_->GetWorldPose().Ign();
-          frame_vpos = this->reference_link_->GetWorldLinearVel().Ign();
-          frame_veul = this->reference_link_->GetWorldAngularVel().Ign();
-#endif
           pose.Pos() = pose.Pos() - frame_pose.Pos();
           pose.Pos() = frame_pose.Rot().RotateVectorReverse(pose.Pos());
           pose.Rot() *= frame_pose.Rot().Inverse();
@@ -298,65 +409,56 @@ void GazeboRosP3D::UpdateChild()
 
         // Apply Constant Offsets
         // apply xyz offsets and get position and rotation components
-        pose.Pos() = pose.Pos() + this->offset_.Pos();
+        pose.Pos() = pose.Pos() + body.offset.Pos();
         // apply rpy offsets
-        pose.Rot() = this->offset_.Rot()*pose.Rot();
+        pose.Rot() = body.offset.Rot()*pose.Rot();
         pose.Rot().Normalize();
 
         // compute accelerations (not used)
-        this->apos_ = (this->last_vpos_ - vpos) / tmp_dt;
-        this->aeul_ = (this->last_veul_ - veul) / tmp_dt;
-        this->last_vpos_ = vpos;
-        this->last_veul_ = veul;
-
-        this->frame_apos_ = (this->last_frame_vpos_ - frame_vpos) / tmp_dt;
-        this->frame_aeul_ = (this->last_frame_veul_ - frame_veul) / tmp_dt;
-        this->last_frame_vpos_ = frame_vpos;
-        this->last_frame_veul_ = frame_veul;
+        body.apos = (body.last_vpos - vpos) / tmp_dt;
+        body.aeul = (body.last_veul - veul) / tmp_dt;
+        body.last_vpos = vpos;
+        body.last_veul = veul;
 
         // Fill out messages
-        this->pose_msg_.pose.pose.position.x    = pose.Pos().X();
-        this->pose_msg_.pose.pose.position.y    = pose.Pos().Y();
-        this->pose_msg_.pose.pose.position.z    = pose.Pos().Z();
-
-        this->pose_msg_.pose.pose.orientation.x = pose.Rot().X();
-        this->pose_msg_.pose.pose.orientation.y = pose.Rot().Y();
-        this->pose_msg_.pose.pose.orientation.z = pose.Rot().Z();
-        this->pose_msg_.pose.pose.orientation.w = pose.Rot().W();
-
-        this->pose_msg_.twist.twist.linear.x  = vpos.X() +
-          this->GaussianKernel(0, this->gaussian_noise_);
-        this->pose_msg_.twist.twist.linear.y  = vpos.Y() +
-          this->GaussianKernel(0, this->gaussian_noise_);
-        this->pose_msg_.twist.twist.linear.z  = vpos.Z() +
-          this->GaussianKernel(0, this->gaussian_noise_);
+        pose_msg.pose.pose.position.x    = pose.Pos().X();
+        pose_msg.pose.pose.position.y    = pose.Pos().Y();
+        pose_msg.pose.pose.position.z    = pose.Pos().Z();
+
+        pose_msg.pose.pose.orientation.x = pose.Rot().X();
+        pose_msg.pose.pose.orientation.y = pose.Rot().Y();
+        pose_msg.pose.pose.orientation.z = pose.Rot().Z();
+        pose_msg.pose.pose.orientation.w = pose.Rot().W();
+
+        pose_msg.twist.twist.linear.x  = vpos.X() +
+          this->noise_.Gaussian(0, this->gaussian_noise_);
+        pose_msg.twist.twist.linear.y  = vpos.Y() +
+          this->noise_.Gaussian(0, this->gaussian_noise_);
+        pose_msg.twist.twist.linear.z  = vpos.Z() +
+          this->noise_.Gaussian(0, this->gaussian_noise_);
         // pass euler angular rates
-        this->pose_msg_.twist.twist.angular.x = veul.X() +
-          this->GaussianKernel(0, this->gaussian_noise_);
-        this->pose_msg_.twist.twist.angular.y = veul.Y() +
-          this->GaussianKernel(0, this->gaussian_noise_);
-        this->pose_msg_.twist.twist.angular.z = veul.Z() +
-          this->GaussianKernel(0, this->gaussian_noise_);
-
-        // fill in covariance matrix
-        /// @todo: let user set separate linear and angular covariance values.
-        double gn2 = this->gaussian_noise_*this->gaussian_noise_;
-        this->pose_msg_.pose.covariance[0] = gn2;
-        this->pose_msg_.pose.covariance[7] = gn2;
-        this->pose_msg_.pose.covariance[14] = gn2;
-        this->pose_msg_.pose.covariance[21] = gn2;
-        this->pose_msg_.pose.covariance[28] = gn2;
-        this->pose_msg_.pose.covariance[35] = gn2;
-
-        this->pose_msg_.twist.covariance[0] = gn2;
-        this->pose_msg_.twist.covariance[7] = gn2;
-        this->pose_msg_.twist.covariance[14] = gn2;
-        this->pose_msg_.twist.covariance[21] = gn2;
-        this->pose_msg_.twist.covariance[28] = gn2;
-        this->pose_msg_.twist.covariance[35] = gn2;
+        pose_msg.twist.twist.angular.x = veul.X() +
+          this->noise_.Gaussian(0, this->gaussian_noise_);
+        pose_msg.twist.twist.angular.y = veul.Y() +
+          this->noise_.Gaussian(0, this->gaussian_noise_);
+        pose_msg.twist.twist.angular.z = veul.Z() +
+          this->noise_.Gaussian(0, this->gaussian_noise_);
 
         // publish to ros
-        this->pub_Queue->push(this->pose_msg_, this->pub_);
+        if (body.pub && body.pub.getNumSubscribers() > 0)
+        {
+          ScopedTiming publish_timing(this->publish_timing_);
+          SensorRecorder::Instance().Record(body.pub, pose_msg);
+          body.pub_queue->push(pose_msg, body.pub);
+        }
+      }
+
+      if (publish_batch)
+      {
+        this->batch_msg_.header.stamp.sec = cur_time.sec;
+        this->batch_msg_.header.stamp.nsec = cur_time.nsec;
+        ScopedTiming publish_timing(this->publish_timing_);
+        this->batch_pub_queue_->push(this->batch_msg_, this->batch_pub_);
       }
 
       this->lock.unlock();
@@ -365,42 +467,7 @@ void GazeboRosP3D::UpdateChild()
       this->last_time_ = cur_time;
     }
   }
-#ifdef ENABLE_PROFILER
-  IGN_PROFILE_END();
-#endif
+  GAZEBO_ROS_PROFILE_END();
 }
 
-//////////////////////////////////////////////////////////////////////////////
-// Utility for adding noise
-double GazeboRosP3D::GaussianKernel(double mu, double sigma)
-{
-  // using Box-Muller transform to generate two independent standard
-  // normally disbributed normal variables see wikipedia
-
-  // normalized uniform random variable
-  double U = ignition::math::Rand::DblUniform();
-
-  // normalized uniform random variable
-  double V = ignition::math::Rand::DblUniform();
-
-  double X = sqrt(-2.0 * ::log(U)) * cos(2.0*M_PI * V);
-  // double Y = sqrt(-2.0 * ::log(U)) * sin(2.0*M_PI * V);
-
-  // there are 2 indep. vars, we'll just use X
-  // scale to our mu and sigma
-  X = sigma * X + mu;
-  return X;
-}
-
-////////////////////////////////////////////////////////////////////////////////
-// Put laser data to the interface
-void GazeboRosP3D::P3DQueueThread()
-{
-  static const double timeout = 0.01;
-
-  while (this->rosnode_->ok())
-  {
-    this->p3d_queue_.callAvailable(ros::WallDuration(timeout));
-  }
-}
 }
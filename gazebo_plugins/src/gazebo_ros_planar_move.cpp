@@ -23,21 +23,25 @@
  */
 
 #include <gazebo_plugins/gazebo_ros_planar_move.h>
-#ifdef ENABLE_PROFILER
-#include <ignition/common/Profiler.hh>
-#endif
+#include <gazebo_plugins/gazebo_ros_utils.h>
+#include <gazebo_ros/profiler.h>
 
 namespace gazebo
 {
 
   GazeboRosPlanarMove::GazeboRosPlanarMove() {}
 
-  GazeboRosPlanarMove::~GazeboRosPlanarMove() {}
+  GazeboRosPlanarMove::~GazeboRosPlanarMove()
+  {
+    if (deferred_load_task_)
+      deferred_load_task_->Wait();
+  }
 
   // Load the controller
   void GazeboRosPlanarMove::Load(physics::ModelPtr parent,
                                  sdf::ElementPtr sdf)
   {
+    GAZEBO_ROS_STARTUP_PHASE("load");
 
     parent_ = parent;
 
@@ -149,9 +153,6 @@ namespace gazebo
 #else
     last_odom_pose_ = parent_->GetWorldPose().Ign();
 #endif
-    x_ = 0;
-    y_ = 0;
-    rot_ = 0;
     alive_ = true;
 
     // Ensure that ROS has been initialized and subscribe to cmd_vel
@@ -163,26 +164,30 @@ namespace gazebo
                                                                       << "'libgazebo_ros_api_plugin.so' in the gazebo_ros package)");
       return;
     }
+
+    setTransportHints(sdf);
+    if (DeferredLoad::Requested(sdf))
+      deferred_load_task_ = DeferredLoad::Instance().Run(this->handleName,
+          boost::bind(&GazeboRosPlanarMove::LoadThread, this));
+    else
+      LoadThread();
+  }
+
+  void GazeboRosPlanarMove::LoadThread()
+  {
     rosnode_.reset(new ros::NodeHandle(robot_namespace_));
 
     ROS_DEBUG_NAMED("planar_move", "OCPlugin (%s) has started",
                     robot_namespace_.c_str());
 
     tf_prefix_ = tf::getPrefixParam(*rosnode_);
-    transform_broadcaster_.reset(new tf::TransformBroadcaster());
-
-    // subscribe to the odometry topic
-    ros::SubscribeOptions so =
-        ros::SubscribeOptions::create<geometry_msgs::Twist>(command_topic_, 1,
-                                                            boost::bind(&GazeboRosPlanarMove::cmdVelCallback, this, _1),
-                                                            ros::VoidPtr(), &queue_);
-
-    vel_sub_ = rosnode_->subscribe(so);
-    odometry_pub_ = rosnode_->advertise<nav_msgs::Odometry>(odometry_topic_, 1);
 
-    // start custom queue for diff drive
-    callback_queue_thread_ =
-        boost::thread(boost::bind(&GazeboRosPlanarMove::QueueThread, this));
+    // subscribe to the velocity command topic and advertise odometry
+    setCommandTimeout(cmd_timeout_);
+    loadDrive(parent_, *rosnode_, command_topic_, odometry_topic_,
+              tf::resolve(tf_prefix_, odometry_frame_),
+              tf::resolve(tf_prefix_, robot_base_frame_));
+    setOdometryCovariance(0.00001, 0.00001, 0.001, false);
 
     // listen to the update event (broadcast every simulation iteration)
     update_connection_ =
@@ -193,20 +198,11 @@ namespace gazebo
   // Update the controller
   void GazeboRosPlanarMove::UpdateChild()
   {
-#ifdef ENABLE_PROFILER
-    IGN_PROFILE("GazeboRosPlanarMove::UpdateChild");
-    IGN_PROFILE_BEGIN("fill ROS message");
-#endif
-    boost::mutex::scoped_lock scoped_lock(lock);
-    if (cmd_timeout_ >= 0)
-    {
-      if ((ros::Time::now() - last_cmd_received_time_).toSec() > cmd_timeout_)
-      {
-        x_ = 0;
-        y_ = 0;
-        rot_ = 0;
-      }
-    }
+    GAZEBO_ROS_PROFILE("GazeboRosPlanarMove::UpdateChild");
+    GAZEBO_ROS_PROFILE_BEGIN("fill ROS message");
+    cmd_vel_ = command();
+    const double x = cmd_vel_.linear.x;
+    const double y = cmd_vel_.linear.y;
 #if GAZEBO_MAJOR_VERSION >= 8
     ignition::math::Pose3d pose = parent_->WorldPose();
 #else
@@ -214,13 +210,11 @@ namespace gazebo
 #endif
     float yaw = pose.Rot().Yaw();
     parent_->SetLinearVel(ignition::math::Vector3d(
-        x_ * cosf(yaw) - y_ * sinf(yaw),
-        y_ * cosf(yaw) + x_ * sinf(yaw),
+        x * cosf(yaw) - y * sinf(yaw),
+        y * cosf(yaw) + x * sinf(yaw),
         0));
-    parent_->SetAngularVel(ignition::math::Vector3d(0, 0, rot_));
-#ifdef ENABLE_PROFILER
-    IGN_PROFILE_END();
-#endif
+    parent_->SetAngularVel(ignition::math::Vector3d(0, 0, cmd_vel_.angular.z));
+    GAZEBO_ROS_PROFILE_END();
     if (odometry_rate_ > 0.0)
     {
 #if GAZEBO_MAJOR_VERSION >= 8
@@ -232,13 +226,9 @@ namespace gazebo
           (current_time - last_odom_publish_time_).Double();
       if (seconds_since_last_update > (1.0 / odometry_rate_))
       {
-#ifdef ENABLE_PROFILER
-        IGN_PROFILE_BEGIN("publishOdometry");
-#endif
-        publishOdometry(seconds_since_last_update);
-#ifdef ENABLE_PROFILER
-        IGN_PROFILE_END();
-#endif
+        GAZEBO_ROS_PROFILE_BEGIN("publishOdometry");
+        updateOdometry(seconds_since_last_update);
+        GAZEBO_ROS_PROFILE_END();
         last_odom_publish_time_ = current_time;
       }
     }
@@ -248,80 +238,28 @@ namespace gazebo
   void GazeboRosPlanarMove::FiniChild()
   {
     alive_ = false;
-    queue_.clear();
-    queue_.disable();
-    rosnode_->shutdown();
-    callback_queue_thread_.join();
+    finiDrive(*rosnode_);
   }
 
-  void GazeboRosPlanarMove::cmdVelCallback(
-      const geometry_msgs::Twist::ConstPtr &cmd_msg)
+  void GazeboRosPlanarMove::updateOdometry(double step_time)
   {
-    boost::mutex::scoped_lock scoped_lock(lock);
-    last_cmd_received_time_ = ros::Time::now();
-    x_ = cmd_msg->linear.x;
-    y_ = cmd_msg->linear.y;
-    rot_ = cmd_msg->angular.z;
-  }
-
-  void GazeboRosPlanarMove::QueueThread()
-  {
-    static const double timeout = 0.01;
-    while (alive_ && rosnode_->ok())
-    {
-      queue_.callAvailable(ros::WallDuration(timeout));
-    }
-  }
-
-  void GazeboRosPlanarMove::publishOdometry(double step_time)
-  {
-
-    ros::Time current_time = ros::Time::now();
-    std::string odom_frame = tf::resolve(tf_prefix_, odometry_frame_);
-    std::string base_footprint_frame =
-        tf::resolve(tf_prefix_, robot_base_frame_);
-
     // getting data for base_footprint to odom transform
 #if GAZEBO_MAJOR_VERSION >= 8
     ignition::math::Pose3d pose = this->parent_->WorldPose();
 #else
     ignition::math::Pose3d pose = this->parent_->GetWorldPose().Ign();
 #endif
-
-    tf::Quaternion qt(pose.Rot().X(), pose.Rot().Y(), pose.Rot().Z(), pose.Rot().W());
-    tf::Vector3 vt(pose.Pos().X(), pose.Pos().Y(), pose.Pos().Z());
-
-    tf::Transform base_footprint_to_odom(qt, vt);
-    if (publish_tf_)
-    {
-      transform_broadcaster_->sendTransform(
-          tf::StampedTransform(base_footprint_to_odom, current_time, odom_frame,
-                               base_footprint_frame));
-    }
-
-    // publish odom topic
-    odom_.pose.pose.position.x = pose.Pos().X();
-    odom_.pose.pose.position.y = pose.Pos().Y();
-
-    odom_.pose.pose.orientation.x = pose.Rot().X();
-    odom_.pose.pose.orientation.y = pose.Rot().Y();
-    odom_.pose.pose.orientation.z = pose.Rot().Z();
-    odom_.pose.pose.orientation.w = pose.Rot().W();
-    odom_.pose.covariance[0] = 0.00001;
-    odom_.pose.covariance[7] = 0.00001;
-    odom_.pose.covariance[14] = 1000000000000.0;
-    odom_.pose.covariance[21] = 1000000000000.0;
-    odom_.pose.covariance[28] = 1000000000000.0;
-    odom_.pose.covariance[35] = 0.001;
+    setOdometryPose(pose);
 
     // get velocity in /odom frame
     ignition::math::Vector3d linear;
     linear.X() = (pose.Pos().X() - last_odom_pose_.Pos().X()) / step_time;
     linear.Y() = (pose.Pos().Y() - last_odom_pose_.Pos().Y()) / step_time;
-    if (rot_ > M_PI / step_time)
+    double angular_z;
+    if (cmd_vel_.angular.z > M_PI / step_time)
     {
       // we cannot calculate the angular velocity correctly
-      odom_.twist.twist.angular.z = rot_;
+      angular_z = cmd_vel_.angular.z;
     }
     else
     {
@@ -332,20 +270,13 @@ namespace gazebo
       while (current_yaw > last_yaw + M_PI)
         current_yaw -= 2 * M_PI;
       float angular_diff = current_yaw - last_yaw;
-      odom_.twist.twist.angular.z = angular_diff / step_time;
+      angular_z = angular_diff / step_time;
     }
     last_odom_pose_ = pose;
 
-    // convert velocity to child_frame_id (aka base_footprint)
-    float yaw = pose.Rot().Yaw();
-    odom_.twist.twist.linear.x = cosf(yaw) * linear.X() + sinf(yaw) * linear.Y();
-    odom_.twist.twist.linear.y = cosf(yaw) * linear.Y() - sinf(yaw) * linear.X();
-
-    odom_.header.stamp = current_time;
-    odom_.header.frame_id = odom_frame;
-    odom_.child_frame_id = base_footprint_frame;
-
-    odometry_pub_.publish(odom_);
+    setOdometryVelocity(pose.Rot().Yaw(), linear, angular_z);
+    publishOdometry(ros::Time::now(), publish_tf_);
+    publishTF();
   }
 
   GZ_REGISTER_MODEL_PLUGIN(GazeboRosPlanarMove)
@@ -23,18 +23,21 @@
 
 #include <algorithm>
 #include <assert.h>
+#include <fstream>
+#include <iterator>
 #include <utility>
 #include <sstream>
 
+#include <gazebo/common/SystemPaths.hh>
 #include <gazebo/rendering/RenderingIface.hh>
 #include <gazebo/rendering/Scene.hh>
 #include <gazebo/rendering/Visual.hh>
 #include <gazebo/rendering/RTShaderSystem.hh>
 #include <gazebo_plugins/gazebo_ros_projector.h>
+#include <gazebo_plugins/gazebo_ros_utils.h>
 
-#ifdef ENABLE_PROFILER
-#include <ignition/common/Profiler.hh>
-#endif
+#include <gazebo_ros/profiler.h>
+#include <gazebo_ros/thread_policy.h>
 
 #include <std_msgs/String.h>
 #include <std_msgs/Int32.h>
@@ -56,6 +59,8 @@ typedef OgrePassMap::iterator OgrePassMapIterator;
 ////////////////////////////////////////////////////////////////////////////////
 // Constructor
 GazeboRosProjector::GazeboRosProjector()
+  : stop_(false), requested_pattern_(-1), pending_pattern_(-1),
+    rendering_(false)
 {
   this->rosnode_ = NULL;
 }
@@ -65,11 +70,23 @@ GazeboRosProjector::GazeboRosProjector()
 // Destructor
 GazeboRosProjector::~GazeboRosProjector()
 {
+  this->pre_render_connection_.reset();
+  {
+    std::lock_guard<std::mutex> lock(this->patterns_mutex_);
+    this->stop_ = true;
+  }
+  this->load_cond_.notify_all();
+  if (this->loader_thread_.joinable())
+    this->loader_thread_.join();
+
+  if (!this->rosnode_)
+    return;
+
   // Custom Callback Queue
   this->queue_.clear();
   this->queue_.disable();
   this->rosnode_->shutdown();
-  this->callback_queue_thread_.join();
+  this->queue_.Stop();
 
   delete this->rosnode_;
 }
@@ -78,6 +95,7 @@ GazeboRosProjector::~GazeboRosProjector()
 // Load the controller
 void GazeboRosProjector::Load( physics::ModelPtr _parent, sdf::ElementPtr _sdf )
 {
+  GAZEBO_ROS_STARTUP_PHASE("load");
   this->world_ = _parent->GetWorld();
 
   // Create a new transport node for talking to the projector
@@ -109,6 +127,10 @@ void GazeboRosProjector::Load( physics::ModelPtr _parent, sdf::ElementPtr _sdf )
   if (_sdf->HasElement("projectorTopicName"))
     this->projector_topic_name_ = _sdf->GetElement("projectorTopicName")->Get<std::string>();
 
+  this->pattern_topic_name_ = "";
+  if (_sdf->HasElement("patternTopicName"))
+    this->pattern_topic_name_ = _sdf->GetElement("patternTopicName")->Get<std::string>();
+
   // Make sure the ROS node for Gazebo has already been initialized
   if (!ros::isInitialized())
   {
@@ -119,25 +141,46 @@ void GazeboRosProjector::Load( physics::ModelPtr _parent, sdf::ElementPtr _sdf )
 
 
   this->rosnode_ = new ros::NodeHandle(this->robot_namespace_);
-
+  const SubscriptionHints hints = GetSubscriptionHints(*this->rosnode_, _sdf);
 
   // Custom Callback Queue
   ros::SubscribeOptions so = ros::SubscribeOptions::create<std_msgs::Int32>(
     this->projector_topic_name_,1,
     boost::bind( &GazeboRosProjector::ToggleProjector,this,_1),
     ros::VoidPtr(), &this->queue_);
+  hints.apply(so);
   this->projectorSubscriber_ = this->rosnode_->subscribe(so);
 
   ros::SubscribeOptions so2 = ros::SubscribeOptions::create<std_msgs::String>(
     this->texture_topic_name_,1,
     boost::bind( &GazeboRosProjector::LoadImage,this,_1),
     ros::VoidPtr(), &this->queue_);
+  hints.apply(so2);
   this->imageSubscriber_ = this->rosnode_->subscribe(so2);
 
+  if (!this->pattern_topic_name_.empty())
+  {
+    ros::SubscribeOptions so3 = ros::SubscribeOptions::create<std_msgs::Int32>(
+      this->pattern_topic_name_,1,
+      boost::bind( &GazeboRosProjector::SwitchPattern,this,_1),
+      ros::VoidPtr(), &this->queue_);
+    hints.apply(so3);
+    this->patternSubscriber_ = this->rosnode_->subscribe(so3);
+  }
 
-  // Custom Callback Queue
-  this->callback_queue_thread_ = boost::thread( boost::bind( &GazeboRosProjector::QueueThread,this ) );
+  // preload the patterns, in the order of their indices
+  this->loader_thread_ = std::thread(&GazeboRosProjector::LoaderThread, this);
+  if (_sdf->HasElement("pattern"))
+  {
+    for (sdf::ElementPtr pattern = _sdf->GetElement("pattern"); pattern;
+         pattern = pattern->GetNextElement("pattern"))
+    {
+      this->FindPattern(pattern->Get<std::string>());
+    }
+  }
 
+  this->pre_render_connection_ = event::Events::ConnectPreRender(
+      std::bind(&GazeboRosProjector::PreRender, this));
 }
 
 
@@ -145,47 +188,189 @@ void GazeboRosProjector::Load( physics::ModelPtr _parent, sdf::ElementPtr _sdf )
 // Load a texture into the projector
 void GazeboRosProjector::LoadImage(const std_msgs::String::ConstPtr& imageMsg)
 {
-#ifdef ENABLE_PROFILER
-  IGN_PROFILE("GazeboRosProjector::LoadImage");
-  IGN_PROFILE_BEGIN("publish");
-#endif
-  msgs::Projector msg;
-  msg.set_name("texture_projector");
-  msg.set_texture(imageMsg->data);
-  this->projector_pub_->Publish(msg);
-#ifdef ENABLE_PROFILER
-  IGN_PROFILE_END();
-#endif
+  GAZEBO_ROS_PROFILE("GazeboRosProjector::LoadImage");
+  if (!this->rendering_)
+  {
+    this->PublishTexture(imageMsg->data);
+    return;
+  }
+
+  // switched to by the render thread once the texture is uploaded
+  this->requested_pattern_ = static_cast<int>(this->FindPattern(imageMsg->data));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-// Toggle the activation of the projector
-void GazeboRosProjector::ToggleProjector(const std_msgs::Int32::ConstPtr& projectorMsg)
+// Switch to a preloaded pattern
+void GazeboRosProjector::SwitchPattern(const std_msgs::Int32::ConstPtr& patternMsg)
 {
-#ifdef ENABLE_PROFILER
-  IGN_PROFILE("GazeboRosProjector::ToggleProjector");
-  IGN_PROFILE_BEGIN("publish");
-#endif
+  std::string name;
+  {
+    std::lock_guard<std::mutex> lock(this->patterns_mutex_);
+    if (patternMsg->data < 0 ||
+        patternMsg->data >= static_cast<int>(this->patterns_.size()))
+    {
+      ROS_WARN_NAMED("projector", "Pattern index %d out of range, %lu patterns",
+                     patternMsg->data,
+                     static_cast<unsigned long>(this->patterns_.size()));
+      return;
+    }
+    name = this->patterns_[patternMsg->data];
+  }
+
+  if (!this->rendering_)
+    this->PublishTexture(name);
+  else
+    this->requested_pattern_ = patternMsg->data;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+size_t GazeboRosProjector::FindPattern(const std::string &_name)
+{
+  size_t index;
+  {
+    std::lock_guard<std::mutex> lock(this->patterns_mutex_);
+    std::vector<std::string>::iterator it =
+      std::find(this->patterns_.begin(), this->patterns_.end(), _name);
+    if (it != this->patterns_.end())
+      return it - this->patterns_.begin();
+
+    index = this->patterns_.size();
+    this->patterns_.push_back(_name);
+    this->load_queue_.push_back(index);
+  }
+  this->load_cond_.notify_one();
+  return index;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void GazeboRosProjector::PublishTexture(const std::string &_name)
+{
+  GAZEBO_ROS_PROFILE_BEGIN("publish");
   msgs::Projector msg;
   msg.set_name("texture_projector");
-  msg.set_enabled(projectorMsg->data);
+  msg.set_texture(_name);
   this->projector_pub_->Publish(msg);
-#ifdef ENABLE_PROFILER
-  IGN_PROFILE_END();
-#endif
+  GAZEBO_ROS_PROFILE_END();
 }
 
+////////////////////////////////////////////////////////////////////////////////
+void GazeboRosProjector::LoaderThread()
+{
+  ThreadPolicy::instance().apply("io", "gzros_projector");
+  while (true)
+  {
+    LoadedPattern loaded;
+    {
+      std::unique_lock<std::mutex> lock(this->patterns_mutex_);
+      while (!this->stop_ && this->load_queue_.empty())
+        this->load_cond_.wait(lock);
+      if (this->stop_)
+        return;
+      loaded.index = this->load_queue_.front();
+      loaded.name = this->patterns_[loaded.index];
+      this->load_queue_.pop_front();
+    }
+
+    // textures are found like the projector finds them, in the media paths
+    std::string path = common::SystemPaths::Instance()->FindFile(loaded.name);
+    if (path.empty())
+      path = common::SystemPaths::Instance()->FindFile(
+          "media/materials/textures/" + loaded.name);
+
+    std::ifstream file(path.c_str(), std::ios::binary);
+    std::string::size_type dot = path.rfind('.');
+    if (path.empty() || !file || dot == std::string::npos)
+    {
+      ROS_WARN_NAMED("projector", "Pattern [%s] not found, the projector "
+                     "loads it on the render thread", loaded.name.c_str());
+    }
+    else
+    {
+      std::vector<char> data((std::istreambuf_iterator<char>(file)),
+                             std::istreambuf_iterator<char>());
+      try
+      {
+        Ogre::DataStreamPtr stream(
+            new Ogre::MemoryDataStream(data.data(), data.size(), false));
+        loaded.image.reset(new Ogre::Image());
+        loaded.image->load(stream, path.substr(dot + 1));
+      }
+      catch (Ogre::Exception &e)
+      {
+        ROS_WARN_NAMED("projector", "Failed to decode pattern [%s]: %s",
+                       path.c_str(), e.getDescription().c_str());
+        loaded.image.reset();
+      }
+    }
+
+    std::lock_guard<std::mutex> lock(this->loaded_mutex_);
+    this->loaded_.push_back(loaded);
+  }
+}
 
 ////////////////////////////////////////////////////////////////////////////////
-// Custom callback queue thread
-void GazeboRosProjector::QueueThread()
+void GazeboRosProjector::PreRender()
 {
-  static const double timeout = 0.01;
+  this->rendering_ = true;
 
-  while (this->rosnode_->ok())
+  // upload at most one pattern per frame, and never wait for the loader
+  LoadedPattern loaded;
+  bool have_loaded = false;
   {
-    this->queue_.callAvailable(ros::WallDuration(timeout));
+    std::unique_lock<std::mutex> lock(this->loaded_mutex_, std::try_to_lock);
+    if (lock.owns_lock() && !this->loaded_.empty())
+    {
+      loaded = this->loaded_.front();
+      this->loaded_.pop_front();
+      have_loaded = true;
+    }
   }
+  if (have_loaded)
+  {
+    GAZEBO_ROS_PROFILE("GazeboRosProjector::UploadPattern");
+    Ogre::TextureManager &textures = Ogre::TextureManager::getSingleton();
+    if (loaded.image && textures.getByName(loaded.name).isNull())
+    {
+      try
+      {
+        textures.loadImage(loaded.name,
+            Ogre::ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME,
+            *loaded.image);
+      }
+      catch (Ogre::Exception &e)
+      {
+        ROS_WARN_NAMED("projector", "Failed to upload pattern [%s]: %s",
+                       loaded.name.c_str(), e.getDescription().c_str());
+      }
+    }
+    if (this->ready_.size() <= loaded.index)
+      this->ready_.resize(loaded.index + 1);
+    this->ready_[loaded.index] = loaded.name;
+  }
+
+  int requested = this->requested_pattern_.exchange(-1);
+  if (requested >= 0)
+    this->pending_pattern_ = requested;
+  if (this->pending_pattern_ >= 0 &&
+      this->pending_pattern_ < static_cast<int>(this->ready_.size()) &&
+      !this->ready_[this->pending_pattern_].empty())
+  {
+    this->PublishTexture(this->ready_[this->pending_pattern_]);
+    this->pending_pattern_ = -1;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Toggle the activation of the projector
+void GazeboRosProjector::ToggleProjector(const std_msgs::Int32::ConstPtr& projectorMsg)
+{
+  GAZEBO_ROS_PROFILE("GazeboRosProjector::ToggleProjector");
+  GAZEBO_ROS_PROFILE_BEGIN("publish");
+  msgs::Projector msg;
+  msg.set_name("texture_projector");
+  msg.set_enabled(projectorMsg->data);
+  this->projector_pub_->Publish(msg);
+  GAZEBO_ROS_PROFILE_END();
 }
 
 }
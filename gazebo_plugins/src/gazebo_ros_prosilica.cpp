@@ -24,6 +24,7 @@
 
 #include <algorithm>
 #include <assert.h>
+#include <cstring>
 
 #include <gazebo_plugins/gazebo_ros_prosilica.h>
 
@@ -35,9 +36,7 @@
 #include <gazebo/sensors/SensorTypes.hh>
 #include <gazebo/rendering/Camera.hh>
 
-#ifdef ENABLE_PROFILER
-#include <ignition/common/Profiler.hh>
-#endif
+#include <gazebo_ros/profiler.h>
 
 #include <sdf/sdf.hh>
 #include <sdf/Param.hh>
@@ -45,10 +44,12 @@
 #include <sensor_msgs/Image.h>
 #include <sensor_msgs/CameraInfo.h>
 #include <sensor_msgs/fill_image.h>
+#include <sensor_msgs/image_encodings.h>
 #include <diagnostic_updater/diagnostic_updater.h>
 #include <sensor_msgs/RegionOfInterest.h>
 
 #include <opencv2/highgui.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
 
 #include <boost/scoped_ptr.hpp>
 #include <boost/bind.hpp>
@@ -65,6 +66,7 @@ namespace gazebo
 ////////////////////////////////////////////////////////////////////////////////
 // Constructor
 GazeboRosProsilica::GazeboRosProsilica()
+  : frame_seq_(0), polls_waiting_(0)
 {
 }
 
@@ -80,6 +82,7 @@ GazeboRosProsilica::~GazeboRosProsilica()
 // Load the controller
 void GazeboRosProsilica::Load(sensors::SensorPtr _parent, sdf::ElementPtr _sdf)
 {
+  GAZEBO_ROS_STARTUP_PHASE("load");
 
   CameraPlugin::Load(_parent, _sdf);
   this->parentSensor_ = this->parentSensor;
@@ -129,9 +132,7 @@ void GazeboRosProsilica::OnNewImageFrame(const unsigned char *_image,
     unsigned int _width, unsigned int _height, unsigned int _depth,
     const std::string &_format)
 {
-#ifdef ENABLE_PROFILER
-  IGN_PROFILE("GazeboRosProsilica::OnNewImageFrame");
-#endif
+  GAZEBO_ROS_PROFILE("GazeboRosProsilica::OnNewImageFrame");
   if (!this->rosnode_->getParam(this->mode_param_name,this->mode_))
       this->mode_ = "streaming";
 
@@ -157,23 +158,30 @@ void GazeboRosProsilica::OnNewImageFrame(const unsigned char *_image,
       {
         if (sensor_update_time - this->last_update_time_ >= this->update_period_)
         {
-#ifdef ENABLE_PROFILER
-          IGN_PROFILE_BEGIN("PutCameraData");
-#endif
+          GAZEBO_ROS_PROFILE_BEGIN("PutCameraData");
           this->PutCameraData(_image, sensor_update_time);
-#ifdef ENABLE_PROFILER
-          IGN_PROFILE_END();
-          IGN_PROFILE_BEGIN("PublishCameraInfo");
-#endif
+          GAZEBO_ROS_PROFILE_END();
+          GAZEBO_ROS_PROFILE_BEGIN("PublishCameraInfo");
           this->PublishCameraInfo(sensor_update_time);
-#ifdef ENABLE_PROFILER
-          IGN_PROFILE_END();
-#endif
+          GAZEBO_ROS_PROFILE_END();
           this->last_update_time_ = sensor_update_time;
         }
       }
     }
-
+    else if (this->mode_ == "polled")
+    {
+      // keep the frame for the polls waiting on it, _image is only valid
+      // during this call
+      boost::mutex::scoped_lock lock(this->frame_mutex_);
+      if (this->polls_waiting_ > 0)
+      {
+        this->frame_.assign(_image,
+            _image + this->skip_ * this->width_ * this->height_);
+        this->frame_time_ = sensor_update_time;
+        this->frame_seq_++;
+        this->frame_cond_.notify_all();
+      }
+    }
   }
 }
 
@@ -187,8 +195,8 @@ void GazeboRosProsilica::pollCallback(polled_camera::GetPolledImage::Request& re
   if (!this->rosnode_->getParam(this->mode_param_name,this->mode_))
       this->mode_ = "streaming";
 
-  /// @todo Support binning (maybe just cv::resize)
-  /// @todo Don't adjust K, P for ROI, set CameraInfo.roi fields instead
+  /// @todo Don't adjust K, P for ROI and binning, set CameraInfo.roi and
+  /// binning fields instead
   /// @todo D parameter order is k1, k2, t1, t2, k3
 
   if (this->mode_ != "polled")
@@ -198,151 +206,192 @@ void GazeboRosProsilica::pollCallback(polled_camera::GetPolledImage::Request& re
     return;
   }
 
-  if (req.binning_x > 1 || req.binning_y > 1)
+  unsigned int binning_x = std::max(req.binning_x, 1u);
+  unsigned int binning_y = std::max(req.binning_y, 1u);
+
+  // averaging neighbouring pixels would mix the colors of a bayer pattern
+  if ((binning_x > 1 || binning_y > 1) &&
+      sensor_msgs::image_encodings::isBayer(this->type_))
   {
     rsp.success = false;
-    rsp.status_message = "Gazebo Prosilica plugin does not support binning";
+    rsp.status_message = "Gazebo Prosilica plugin does not support binning of bayer images";
     return;
   }
 
-  // get region from request
-  if (req.roi.x_offset <= 0 || req.roi.y_offset <= 0 || req.roi.width <= 0 || req.roi.height <= 0)
+  // get region from request, an empty region is the full image
+  if (req.roi.width == 0 || req.roi.height == 0)
   {
     req.roi.x_offset = 0;
     req.roi.y_offset = 0;
     req.roi.width = this->width_;
-    req.roi.height = this->height;
+    req.roi.height = this->height_;
+  }
+  if (req.roi.x_offset + req.roi.width > this->width_ ||
+      req.roi.y_offset + req.roi.height > this->height_)
+  {
+    rsp.success = false;
+    rsp.status_message = "Region of interest is outside of the image";
+    return;
+  }
+  if (req.roi.width < binning_x || req.roi.height < binning_y)
+  {
+    rsp.success = false;
+    rsp.status_message = "Region of interest is smaller than the binning";
+    return;
   }
-  const unsigned char *src = NULL;
-  ROS_ERROR_NAMED("prosilica", "roidebug %d %d %d %d", req.roi.x_offset, req.roi.y_offset, req.roi.width, req.roi.height);
+  ROS_DEBUG_NAMED("prosilica", "roi %d %d %d %d binning %d %d",
+    req.roi.x_offset, req.roi.y_offset, req.roi.width, req.roi.height,
+    binning_x, binning_y);
 
   // signal sensor to start update
-  (*this->image_connect_count_)++;
+  {
+    boost::mutex::scoped_lock lock(*this->image_connect_count_lock_);
+    (*this->image_connect_count_)++;
+    this->parentSensor_->SetActive(true);
+  }
+
+  // wait for a frame rendered after the request
+  boost::mutex::scoped_lock lock(this->frame_mutex_);
+  unsigned int seq = this->frame_seq_;
+  this->polls_waiting_++;
+  while (this->frame_seq_ == seq && this->rosnode_->ok())
+    this->frame_cond_.timed_wait(lock, boost::posix_time::milliseconds(100));
+  this->polls_waiting_--;
 
-  // wait until an image has been returned
-  while(!src)
   {
-    {
-      // Get a pointer to image data
-      src = this->parentSensor->Camera()->ImageData(0);
+    boost::mutex::scoped_lock count_lock(*this->image_connect_count_lock_);
+    (*this->image_connect_count_)--;
+  }
 
-      if (src)
-      {
+  if (this->frame_seq_ == seq)
+  {
+    rsp.success = false;
+    rsp.status_message = "Camera was shut down";
+    return;
+  }
 
-        // fill CameraInfo
-        this->roiCameraInfoMsg = &info;
-        this->roiCameraInfoMsg->header.frame_id = this->frame_name_;
+  // fill CameraInfo, scaled to the binned region
+  this->roiCameraInfoMsg = &info;
+  this->roiCameraInfoMsg->header.frame_id = this->frame_name_;
+  this->roiCameraInfoMsg->header.stamp.sec = this->frame_time_.sec;
+  this->roiCameraInfoMsg->header.stamp.nsec = this->frame_time_.nsec;
 
-        common::Time roiLastRenderTime = this->parentSensor_->LastMeasurementTime();
-        this->roiCameraInfoMsg->header.stamp.sec = roiLastRenderTime.sec;
-        this->roiCameraInfoMsg->header.stamp.nsec = roiLastRenderTime.nsec;
+  double fx = this->focal_length_ / binning_x;
+  double fy = this->focal_length_ / binning_y;
+  double cx = (this->cx_ - req.roi.x_offset) / binning_x;
+  double cy = (this->cy_ - req.roi.y_offset) / binning_y;
 
-        this->roiCameraInfoMsg->width  = req.roi.width; //this->parentSensor->ImageWidth() ;
-        this->roiCameraInfoMsg->height = req.roi.height; //this->parentSensor->ImageHeight();
-        // distortion
+  this->roiCameraInfoMsg->width  = req.roi.width / binning_x;
+  this->roiCameraInfoMsg->height = req.roi.height / binning_y;
+  // distortion
 #if ROS_VERSION_MINIMUM(1, 3, 0)
-        this->roiCameraInfoMsg->distortion_model = "plumb_bob";
-        this->roiCameraInfoMsg->D.resize(5);
+  this->roiCameraInfoMsg->distortion_model = "plumb_bob";
+  this->roiCameraInfoMsg->D.resize(5);
 #endif
-        this->roiCameraInfoMsg->D[0] = this->distortion_k1_;
-        this->roiCameraInfoMsg->D[1] = this->distortion_k2_;
-        this->roiCameraInfoMsg->D[2] = this->distortion_k3_;
-        this->roiCameraInfoMsg->D[3] = this->distortion_t1_;
-        this->roiCameraInfoMsg->D[4] = this->distortion_t2_;
-        // original camera matrix
-        this->roiCameraInfoMsg->K[0] = this->focal_length_;
-        this->roiCameraInfoMsg->K[1] = 0.0;
-        this->roiCameraInfoMsg->K[2] = this->cx_ - req.roi.x_offset;
-        this->roiCameraInfoMsg->K[3] = 0.0;
-        this->roiCameraInfoMsg->K[4] = this->focal_length_;
-        this->roiCameraInfoMsg->K[5] = this->cy_ - req.roi.y_offset;
-        this->roiCameraInfoMsg->K[6] = 0.0;
-        this->roiCameraInfoMsg->K[7] = 0.0;
-        this->roiCameraInfoMsg->K[8] = 1.0;
-        // rectification
-        this->roiCameraInfoMsg->R[0] = 1.0;
-        this->roiCameraInfoMsg->R[1] = 0.0;
-        this->roiCameraInfoMsg->R[2] = 0.0;
-        this->roiCameraInfoMsg->R[3] = 0.0;
-        this->roiCameraInfoMsg->R[4] = 1.0;
-        this->roiCameraInfoMsg->R[5] = 0.0;
-        this->roiCameraInfoMsg->R[6] = 0.0;
-        this->roiCameraInfoMsg->R[7] = 0.0;
-        this->roiCameraInfoMsg->R[8] = 1.0;
-        // camera projection matrix (same as camera matrix due to lack of distortion/rectification) (is this generated?)
-        this->roiCameraInfoMsg->P[0] = this->focal_length_;
-        this->roiCameraInfoMsg->P[1] = 0.0;
-        this->roiCameraInfoMsg->P[2] = this->cx_ - req.roi.x_offset;
-        this->roiCameraInfoMsg->P[3] = -this->focal_length_ * this->hack_baseline_;
-        this->roiCameraInfoMsg->P[4] = 0.0;
-        this->roiCameraInfoMsg->P[5] = this->focal_length_;
-        this->roiCameraInfoMsg->P[6] = this->cy_ - req.roi.y_offset;
-        this->roiCameraInfoMsg->P[7] = 0.0;
-        this->roiCameraInfoMsg->P[8] = 0.0;
-        this->roiCameraInfoMsg->P[9] = 0.0;
-        this->roiCameraInfoMsg->P[10] = 1.0;
-        this->roiCameraInfoMsg->P[11] = 0.0;
-        this->camera_info_pub_.publish(*this->roiCameraInfoMsg);
-
-        // copy data into image_msg_, then convert to roiImageMsg(image)
-        this->image_msg_.header.frame_id    = this->frame_name_;
-
-        common::Time lastRenderTime = this->parentSensor_->LastMeasurementTime();
-        this->image_msg_.header.stamp.sec = lastRenderTime.sec;
-        this->image_msg_.header.stamp.nsec = lastRenderTime.nsec;
-
-        //unsigned char dst[this->width_*this->height];
-
-        /// @todo: don't bother if there are no subscribers
-
-        // copy from src to image_msg_
-        fillImage(this->image_msg_,
-                  this->type_,
-                  this->height_,
-                  this->width_,
-                  this->skip_*this->width_,
-                  (void*)src );
-
-        /// @todo: publish to ros, thumbnails and rect image in the Update call?
-
-        this->image_pub_.publish(this->image_msg_);
-
-        {
-          // copy data into ROI image
-          this->roiImageMsg = &image;
-          this->roiImageMsg->header.frame_id = this->frame_name_;
-          common::Time roiLastRenderTime = this->parentSensor_->LastMeasurementTime();
-          this->roiImageMsg->header.stamp.sec = roiLastRenderTime.sec;
-          this->roiImageMsg->header.stamp.nsec = roiLastRenderTime.nsec;
-
-          // convert image_msg_ to a CvImage using cv_bridge
-          boost::shared_ptr<cv_bridge::CvImage> img_bridge_;
-          img_bridge_ = cv_bridge::toCvCopy(this->image_msg_);
-
-          // for debug
-          //cvNamedWindow("showme",CV_WINDOW_AUTOSIZE);
-          //cvSetMouseCallback("showme", &GazeboRosProsilica::mouse_cb, this);
-          //cvStartWindowThread();
-          //cvShowImage("showme",img_bridge_.toIpl());
-
-          // crop image to roi
-          cv::Mat roi(img_bridge_->image,
-            cv::Rect(req.roi.x_offset, req.roi.y_offset,
-                     req.roi.width, req.roi.height));
-          img_bridge_->image = roi;
-
-          // copy roi'd image into roiImageMsg
-          img_bridge_->toImageMsg(*this->roiImageMsg);
-        }
-      }
-    }
-    std::this_thread::sleep_for(std::chrono::microseconds(100000));
+  this->roiCameraInfoMsg->D[0] = this->distortion_k1_;
+  this->roiCameraInfoMsg->D[1] = this->distortion_k2_;
+  this->roiCameraInfoMsg->D[2] = this->distortion_k3_;
+  this->roiCameraInfoMsg->D[3] = this->distortion_t1_;
+  this->roiCameraInfoMsg->D[4] = this->distortion_t2_;
+  // original camera matrix
+  this->roiCameraInfoMsg->K[0] = fx;
+  this->roiCameraInfoMsg->K[1] = 0.0;
+  this->roiCameraInfoMsg->K[2] = cx;
+  this->roiCameraInfoMsg->K[3] = 0.0;
+  this->roiCameraInfoMsg->K[4] = fy;
+  this->roiCameraInfoMsg->K[5] = cy;
+  this->roiCameraInfoMsg->K[6] = 0.0;
+  this->roiCameraInfoMsg->K[7] = 0.0;
+  this->roiCameraInfoMsg->K[8] = 1.0;
+  // rectification
+  this->roiCameraInfoMsg->R[0] = 1.0;
+  this->roiCameraInfoMsg->R[1] = 0.0;
+  this->roiCameraInfoMsg->R[2] = 0.0;
+  this->roiCameraInfoMsg->R[3] = 0.0;
+  this->roiCameraInfoMsg->R[4] = 1.0;
+  this->roiCameraInfoMsg->R[5] = 0.0;
+  this->roiCameraInfoMsg->R[6] = 0.0;
+  this->roiCameraInfoMsg->R[7] = 0.0;
+  this->roiCameraInfoMsg->R[8] = 1.0;
+  // camera projection matrix (same as camera matrix due to lack of distortion/rectification) (is this generated?)
+  this->roiCameraInfoMsg->P[0] = fx;
+  this->roiCameraInfoMsg->P[1] = 0.0;
+  this->roiCameraInfoMsg->P[2] = cx;
+  this->roiCameraInfoMsg->P[3] = -fx * this->hack_baseline_;
+  this->roiCameraInfoMsg->P[4] = 0.0;
+  this->roiCameraInfoMsg->P[5] = fy;
+  this->roiCameraInfoMsg->P[6] = cy;
+  this->roiCameraInfoMsg->P[7] = 0.0;
+  this->roiCameraInfoMsg->P[8] = 0.0;
+  this->roiCameraInfoMsg->P[9] = 0.0;
+  this->roiCameraInfoMsg->P[10] = 1.0;
+  this->roiCameraInfoMsg->P[11] = 0.0;
+  this->camera_info_pub_.publish(*this->roiCameraInfoMsg);
+
+  // publish the full frame only if someone listens to it
+  if (this->image_pub_.getNumSubscribers() > 0)
+  {
+    this->image_msg_.header.frame_id = this->frame_name_;
+    this->image_msg_.header.stamp.sec = this->frame_time_.sec;
+    this->image_msg_.header.stamp.nsec = this->frame_time_.nsec;
+    fillImage(this->image_msg_,
+              this->type_,
+              this->height_,
+              this->width_,
+              this->skip_*this->width_,
+              &this->frame_[0]);
+    this->image_pub_.publish(this->image_msg_);
   }
-  (*this->image_connect_count_)--;
+
+  // crop and bin straight from the frame into the response
+  this->roiImageMsg = &image;
+  this->roiImageMsg->header.frame_id = this->frame_name_;
+  this->roiImageMsg->header.stamp.sec = this->frame_time_.sec;
+  this->roiImageMsg->header.stamp.nsec = this->frame_time_.nsec;
+  this->fillRoiImage(req.roi, binning_x, binning_y, *this->roiImageMsg);
+
   rsp.success = true;
   return;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Crop and bin the latest frame
+void GazeboRosProsilica::fillRoiImage(const sensor_msgs::RegionOfInterest &_roi,
+    unsigned int _binning_x, unsigned int _binning_y,
+    sensor_msgs::Image &_image)
+{
+  unsigned int width = _roi.width / _binning_x;
+  unsigned int height = _roi.height / _binning_y;
+
+  _image.encoding = this->type_;
+  _image.width = width;
+  _image.height = height;
+  _image.step = this->skip_ * width;
+  _image.is_bigendian = 0;
+  _image.data.resize(_image.step * height);
+
+  size_t frame_step = this->skip_ * this->width_;
+  const unsigned char *src = &this->frame_[0] +
+    _roi.y_offset * frame_step + _roi.x_offset * this->skip_;
+
+  if (_binning_x == 1 && _binning_y == 1)
+  {
+    for (unsigned int row = 0; row < height; ++row)
+      memcpy(&_image.data[row * _image.step], src + row * frame_step,
+             _image.step);
+    return;
+  }
+
+  // wrap the region and the response without copying them. Area
+  // interpolation by an integer factor is a plain block average, which
+  // OpenCV vectorizes. The region is trimmed to a multiple of the binning.
+  int type = cv_bridge::getCvType(this->type_);
+  cv::Mat region(height * _binning_y, width * _binning_x, type,
+                 const_cast<unsigned char*>(src), frame_step);
+  cv::Mat binned(height, width, type, &_image.data[0], _image.step);
+  cv::resize(region, binned, binned.size(), 0, 0, cv::INTER_AREA);
+}
+
 
 /*
 void GazeboRosProsilica::OnStats( const boost::shared_ptr<msgs::WorldStatistics const> &_msg)
@@ -0,0 +1,348 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <limits>
+#include <string>
+
+#include <gazebo_plugins/gazebo_ros_range_array.h>
+#include <gazebo_plugins/gazebo_ros_utils.h>
+
+#include <gazebo/physics/World.hh>
+#include <gazebo/sensors/RaySensor.hh>
+#include <gazebo/sensors/SensorManager.hh>
+
+#include <gazebo_ros/profiler.h>
+
+#include <sdf/sdf.hh>
+
+#include <sensor_msgs/Range.h>
+#include <tf/tf.h>
+
+namespace gazebo
+{
+// Register this plugin with the simulator
+GZ_REGISTER_MODEL_PLUGIN(GazeboRosRangeArray)
+
+////////////////////////////////////////////////////////////////////////////////
+// Constructor
+GazeboRosRangeArray::GazeboRosRangeArray()
+  : connect_count_(0), updated_count_(0), rosnode_(NULL)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Destructor
+GazeboRosRangeArray::~GazeboRosRangeArray()
+{
+  this->update_connection_.reset();
+  this->sensor_connections_.clear();
+
+  if (!this->rosnode_)
+    return;
+  this->range_queue_.clear();
+  this->range_queue_.disable();
+  this->rosnode_->shutdown();
+  this->range_queue_.Stop();
+  delete this->rosnode_;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Load the controller
+void GazeboRosRangeArray::Load(physics::ModelPtr _parent, sdf::ElementPtr _sdf)
+{
+  GAZEBO_ROS_STARTUP_PHASE("load");
+  this->model_ = _parent;
+  this->world_ = _parent->GetWorld();
+
+  this->robot_namespace_ = "";
+  if (_sdf->HasElement("robotNamespace"))
+    this->robot_namespace_ = _sdf->GetElement("robotNamespace")->Get<std::string>() + "/";
+
+  if (_sdf->HasElement("sensor"))
+  {
+    for (sdf::ElementPtr sensor = _sdf->GetElement("sensor"); sensor;
+         sensor = sensor->GetNextElement("sensor"))
+      this->sensor_names_.push_back(sensor->Get<std::string>());
+  }
+  if (this->sensor_names_.empty())
+  {
+    ROS_FATAL_NAMED("range_array", "Range array plugin needs one <sensor> per ray sensor, cannot proceed");
+    return;
+  }
+
+  if (!_sdf->HasElement("frameName"))
+  {
+    ROS_INFO_NAMED("range_array", "Range array plugin missing <frameName>, defaults to /world");
+    this->frame_name_ = "/world";
+  }
+  else
+    this->frame_name_ = _sdf->GetElement("frameName")->Get<std::string>();
+
+  if (!_sdf->HasElement("topicName"))
+  {
+    ROS_INFO_NAMED("range_array", "Range array plugin missing <topicName>, defaults to /range_array");
+    this->topic_name_ = "/range_array";
+  }
+  else
+    this->topic_name_ = _sdf->GetElement("topicName")->Get<std::string>();
+
+  if (!_sdf->HasElement("infoTopicName"))
+    this->info_topic_name_ = this->topic_name_ + "_info";
+  else
+    this->info_topic_name_ = _sdf->GetElement("infoTopicName")->Get<std::string>();
+
+  if (!_sdf->HasElement("radiation"))
+  {
+    ROS_WARN_NAMED("range_array", "Range array plugin missing <radiation>, defaults to ultrasound");
+    this->radiation_ = "ultrasound";
+  }
+  else
+    this->radiation_ = _sdf->GetElement("radiation")->Get<std::string>();
+
+  if (!_sdf->HasElement("fov"))
+  {
+    ROS_WARN_NAMED("range_array", "Range array plugin missing <fov>, defaults to 0.05");
+    this->fov_ = 0.05;
+  }
+  else
+    this->fov_ = _sdf->GetElement("fov")->Get<double>();
+
+  if (!_sdf->HasElement("gaussianNoise"))
+  {
+    ROS_INFO_NAMED("range_array", "Range array plugin missing <gaussianNoise>, defaults to 0.0");
+    this->gaussian_noise_ = 0;
+  }
+  else
+    this->gaussian_noise_ = _sdf->GetElement("gaussianNoise")->Get<double>();
+  this->noise_.Seed(GaussianNoise::SeedFromSdf(_sdf, _parent->GetScopedName()));
+
+  if (!_sdf->HasElement("updateRate"))
+  {
+    ROS_INFO_NAMED("range_array", "Range array plugin missing <updateRate>, defaults to 0");
+    this->update_rate_ = 0;
+  }
+  else
+    this->update_rate_ = _sdf->GetElement("updateRate")->Get<double>();
+
+  if (this->update_rate_ > 0.0)
+    this->update_period_ = 1.0/this->update_rate_;
+  else
+    this->update_period_ = 0.0;
+
+  // Make sure the ROS node for Gazebo has already been initialized
+  if (!ros::isInitialized())
+  {
+    ROS_FATAL_STREAM_NAMED("range_array", "A ROS node for Gazebo has not been initialized, unable to load plugin. "
+      << "Load the Gazebo system plugin 'libgazebo_ros_api_plugin.so' in the gazebo_ros package)");
+    return;
+  }
+
+  this->rosnode_ = new ros::NodeHandle(this->robot_namespace_);
+
+  // resolve tf prefix
+  this->rosnode_->getParam(std::string("tf_prefix"), this->tf_prefix_);
+  this->frame_name_ = tf::resolve(this->tf_prefix_, this->frame_name_);
+
+  this->array_msg_.header.frame_id = this->frame_name_;
+  this->array_msg_.range.resize(this->sensor_names_.size());
+  this->updated_.assign(this->sensor_names_.size(), false);
+
+  ros::AdvertiseOptions ao = ros::AdvertiseOptions::create<gazebo_msgs::RangeArray>(
+    this->topic_name_, 1,
+    boost::bind(&GazeboRosRangeArray::Connect, this),
+    boost::bind(&GazeboRosRangeArray::Disconnect, this),
+    ros::VoidPtr(), &this->range_queue_);
+  this->pub_ = this->rosnode_->advertise(ao);
+
+  // latched, published once the sensors are found
+  ros::AdvertiseOptions info_ao = ros::AdvertiseOptions::create<gazebo_msgs::RangeArrayInfo>(
+    this->info_topic_name_, 1,
+    ros::SubscriberStatusCallback(), ros::SubscriberStatusCallback(),
+    ros::VoidPtr(), &this->range_queue_);
+  info_ao.latch = true;
+  this->info_pub_ = this->rosnode_->advertise(info_ao);
+
+  // the sensors of the model are created after its plugins are loaded
+  if (!this->ResolveSensors())
+    this->update_connection_ = event::Events::ConnectWorldUpdateBegin(
+        boost::bind(&GazeboRosRangeArray::OnWorldUpdate, this));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Look the sensors up
+void GazeboRosRangeArray::OnWorldUpdate()
+{
+  if (this->ResolveSensors())
+    this->update_connection_.reset();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Find the sensors by name among those of the model
+bool GazeboRosRangeArray::ResolveSensors()
+{
+  GAZEBO_SENSORS_USING_DYNAMIC_POINTER_CAST;
+  const std::string prefix = this->model_->GetScopedName() + "::";
+  sensors::Sensor_V all = sensors::SensorManager::Instance()->GetSensors();
+
+  std::vector<sensors::RaySensorPtr> found(this->sensor_names_.size());
+  for (size_t i = 0; i < this->sensor_names_.size(); ++i)
+  {
+    for (size_t k = 0; k < all.size(); ++k)
+    {
+      if (all[k]->Name() == this->sensor_names_[i] &&
+          all[k]->ParentName().compare(0, prefix.size(), prefix) == 0)
+      {
+        found[i] = dynamic_pointer_cast<sensors::RaySensor>(all[k]);
+        if (!found[i])
+        {
+          ROS_FATAL_NAMED("range_array", "Range array plugin: sensor %s is not a ray sensor",
+            this->sensor_names_[i].c_str());
+          // stop looking
+          return true;
+        }
+        break;
+      }
+    }
+    if (!found[i])
+    {
+      ROS_WARN_THROTTLE_NAMED(5, "range_array", "Range array plugin waiting for sensor %s of model %s",
+        this->sensor_names_[i].c_str(), this->model_->GetScopedName().c_str());
+      return false;
+    }
+  }
+
+  // the limits and frames do not change, send them once
+  const size_t n = found.size();
+  this->info_msg_.header.frame_id = this->frame_name_;
+  this->info_msg_.frame_id.resize(n);
+  this->info_msg_.radiation_type.assign(n, this->radiation_ == std::string("ultrasound") ?
+    sensor_msgs::Range::ULTRASOUND : sensor_msgs::Range::INFRARED);
+  this->info_msg_.field_of_view.assign(n, this->fov_);
+  this->info_msg_.min_range.resize(n);
+  this->info_msg_.max_range.resize(n);
+  for (size_t i = 0; i < n; ++i)
+  {
+    // the frame of a sensor is its link
+    std::string link = found[i]->ParentName();
+    size_t scope = link.rfind("::");
+    if (scope != std::string::npos)
+      link = link.substr(scope + 2);
+    this->info_msg_.frame_id[i] = tf::resolve(this->tf_prefix_, link);
+    this->info_msg_.min_range[i] = found[i]->RangeMin();
+    this->info_msg_.max_range[i] = found[i]->RangeMax();
+  }
+#if GAZEBO_MAJOR_VERSION >= 8
+  common::Time now = this->world_->SimTime();
+#else
+  common::Time now = this->world_->GetSimTime();
+#endif
+  this->info_msg_.header.stamp.sec = now.sec;
+  this->info_msg_.header.stamp.nsec = now.nsec;
+  this->info_pub_.publish(this->info_msg_);
+
+  {
+    boost::mutex::scoped_lock lock(this->lock_);
+    this->sensors_ = found;
+    for (size_t i = 0; i < n; ++i)
+      this->sensors_[i]->SetActive(this->connect_count_ > 0);
+  }
+  for (size_t i = 0; i < n; ++i)
+    this->sensor_connections_.push_back(found[i]->ConnectUpdated(
+        boost::bind(&GazeboRosRangeArray::OnSensorUpdate, this, i)));
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Increment count
+void GazeboRosRangeArray::Connect()
+{
+  boost::mutex::scoped_lock lock(this->lock_);
+  this->connect_count_++;
+  this->SetSensorsActive(true);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Decrement count
+void GazeboRosRangeArray::Disconnect()
+{
+  boost::mutex::scoped_lock lock(this->lock_);
+  this->connect_count_--;
+  if (this->connect_count_ == 0)
+    this->SetSensorsActive(false);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Activate the sensors, lock_ held
+void GazeboRosRangeArray::SetSensorsActive(bool _active)
+{
+  for (size_t i = 0; i < this->sensors_.size(); ++i)
+    this->sensors_[i]->SetActive(_active);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Take the range of one sensor, publish the array once the cycle is complete
+void GazeboRosRangeArray::OnSensorUpdate(size_t _index)
+{
+  GAZEBO_ROS_PROFILE("GazeboRosRangeArray::OnSensorUpdate");
+  boost::mutex::scoped_lock lock(this->lock_);
+  if (this->connect_count_ == 0)
+    return;
+
+  const sensors::RaySensorPtr &sensor = this->sensors_[_index];
+  sensor->Ranges(this->rays_);
+
+  // the shortest ray, as GazeboRosRange does
+  float range = std::numeric_limits<float>::max();
+  for (size_t k = 0; k < this->rays_.size(); ++k)
+    range = std::min(range, static_cast<float>(this->rays_[k]));
+
+  // add Gaussian noise and limit to max range
+  const float max_range = this->info_msg_.max_range[_index];
+  if (range < max_range)
+    range = std::min<float>(range + this->noise_.Gaussian(0, this->gaussian_noise_), max_range);
+  this->array_msg_.range[_index] = range;
+
+  if (!this->updated_[_index])
+  {
+    this->updated_[_index] = true;
+    ++this->updated_count_;
+  }
+
+  common::Time stamp = sensor->LastUpdateTime();
+  if (stamp < this->last_publish_time_)
+  {
+    ROS_WARN_NAMED("range_array", "Negative sensor update time difference detected.");
+    this->last_publish_time_ = stamp;
+  }
+
+  // with an update rate the array goes out on time, whether every sensor
+  // reported or not, otherwise once all of them did
+  if (this->update_period_ > 0.0 ?
+      stamp - this->last_publish_time_ < this->update_period_ :
+      this->updated_count_ < this->updated_.size())
+    return;
+
+  this->array_msg_.header.stamp.sec = stamp.sec;
+  this->array_msg_.header.stamp.nsec = stamp.nsec;
+  this->pub_.publish(this->array_msg_);
+
+  this->last_publish_time_ = stamp;
+  this->updated_.assign(this->updated_.size(), false);
+  this->updated_count_ = 0;
+}
+}
@@ -0,0 +1,139 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <sstream>
+#include <string>
+
+#include <boost/bind.hpp>
+
+#include <gazebo_plugins/gazebo_ros_render_scheduler.h>
+#include <gazebo_plugins/gazebo_ros_utils.h>
+#include <gazebo_plugins/render_scheduler.h>
+
+#include <gazebo/physics/PhysicsEngine.hh>
+#include <gazebo/physics/World.hh>
+#include <gazebo/sensors/SensorManager.hh>
+
+#include <gazebo_ros/profiler.h>
+
+#include <ros/ros.h>
+#include <sdf/sdf.hh>
+
+namespace gazebo
+{
+// Register this plugin with the simulator
+GZ_REGISTER_WORLD_PLUGIN(GazeboRosRenderScheduler)
+
+////////////////////////////////////////////////////////////////////////////////
+// Constructor
+GazeboRosRenderScheduler::GazeboRosRenderScheduler()
+  : rescan_period_(1.0), scanned_(false)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Destructor
+GazeboRosRenderScheduler::~GazeboRosRenderScheduler()
+{
+  this->update_connection_.reset();
+  RenderScheduler::Instance().Clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Load the plugin
+void GazeboRosRenderScheduler::Load(physics::WorldPtr _world,
+                                    sdf::ElementPtr _sdf)
+{
+  GAZEBO_ROS_STARTUP_PHASE("load");
+  this->world_ = _world;
+
+  std::string types = "camera depth multicamera wideanglecamera gpu_ray";
+  if (_sdf->HasElement("sensorTypes"))
+    types = _sdf->GetElement("sensorTypes")->Get<std::string>();
+  std::istringstream stream(types);
+  std::string type;
+  while (stream >> type)
+    this->sensor_types_.insert(type);
+
+  if (!_sdf->HasElement("rescanPeriod"))
+  {
+    ROS_INFO_NAMED("render_scheduler", "Render scheduler plugin missing <rescanPeriod>, defaults to 1.0");
+    this->rescan_period_ = 1.0;
+  }
+  else
+    this->rescan_period_ = _sdf->GetElement("rescanPeriod")->Get<double>();
+
+  this->update_connection_ = event::Events::ConnectWorldUpdateBegin(
+      boost::bind(&GazeboRosRenderScheduler::OnWorldUpdateBegin, this));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Arm the sensors due at this step
+void GazeboRosRenderScheduler::OnWorldUpdateBegin()
+{
+  GAZEBO_ROS_PROFILE("GazeboRosRenderScheduler::OnWorldUpdateBegin");
+#if GAZEBO_MAJOR_VERSION >= 8
+  common::Time cur_time = this->world_->SimTime();
+  uint64_t iteration = this->world_->Iterations();
+  double step_size = this->world_->Physics()->GetMaxStepSize();
+#else
+  common::Time cur_time = this->world_->GetSimTime();
+  uint64_t iteration = this->world_->GetIterations();
+  double step_size = this->world_->GetPhysicsEngine()->GetMaxStepSize();
+#endif
+
+  // the sensors are created by the sensor manager after the models, and
+  // models can be spawned at any time
+  if (!this->scanned_ ||
+      (cur_time - this->last_scan_time_).Double() >= this->rescan_period_ ||
+      cur_time < this->last_scan_time_)
+  {
+    this->Scan();
+    this->last_scan_time_ = cur_time;
+    this->scanned_ = true;
+  }
+
+  RenderScheduler::Instance().Step(iteration, step_size);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Add the new sensors of the world
+void GazeboRosRenderScheduler::Scan()
+{
+#if GAZEBO_MAJOR_VERSION >= 8
+  const std::string world_name = this->world_->Name();
+#else
+  const std::string world_name = this->world_->GetName();
+#endif
+  RenderScheduler &scheduler = RenderScheduler::Instance();
+  sensors::Sensor_V all = sensors::SensorManager::Instance()->GetSensors();
+
+  size_t added = 0;
+  for (size_t i = 0; i < all.size(); ++i)
+  {
+    if (all[i]->WorldName() != world_name ||
+        this->sensor_types_.count(all[i]->Type()) == 0)
+      continue;
+    if (scheduler.Add(all[i]))
+      ++added;
+  }
+
+  if (added > 0)
+    ROS_INFO_NAMED("render_scheduler", "Render scheduler: staggering %lu sensors",
+      static_cast<unsigned long>(scheduler.Size()));
+}
+}
@@ -0,0 +1,318 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+#include <boost/bind.hpp>
+
+#include <gazebo_plugins/gazebo_ros_sensor_lod.h>
+#include <gazebo_plugins/gazebo_ros_utils.h>
+#include <gazebo_plugins/render_scheduler.h>
+
+#include <gazebo/sensors/SensorManager.hh>
+
+#include <sdf/sdf.hh>
+
+namespace gazebo
+{
+// Register this plugin with the simulator
+GZ_REGISTER_WORLD_PLUGIN(GazeboRosSensorLod)
+
+////////////////////////////////////////////////////////////////////////////////
+// Constructor
+GazeboRosSensorLod::GazeboRosSensorLod()
+  : target_rtf_(0.9), restore_rtf_(0.98), hold_time_(3.0), rosnode_(NULL)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Destructor
+GazeboRosSensorLod::~GazeboRosSensorLod()
+{
+  if (this->rosnode_)
+  {
+    this->queue_.clear();
+    this->queue_.disable();
+    this->rosnode_->shutdown();
+    this->queue_.Stop();
+    delete this->rosnode_;
+  }
+
+  for (size_t i = 0; i < this->sensors_.size(); ++i)
+  {
+    if (this->sensors_[i].level == 0)
+      continue;
+    this->sensors_[i].level = 0;
+    this->Apply(this->sensors_[i]);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Load the plugin
+void GazeboRosSensorLod::Load(physics::WorldPtr _world, sdf::ElementPtr _sdf)
+{
+  GAZEBO_ROS_STARTUP_PHASE("load");
+  this->world_ = _world;
+
+  this->robot_namespace_ = "";
+  if (_sdf->HasElement("robotNamespace"))
+    this->robot_namespace_ = _sdf->GetElement("robotNamespace")->Get<std::string>() + "/";
+
+  // the topics of gazebo_ros_api_plugin, whose node this process is, e.g.
+  // /gazebo or /sim3/gazebo in a namespace
+  this->metrics_topic_name_ = ros::this_node::getName() + "/performance_metrics";
+  if (_sdf->HasElement("metricsTopicName"))
+    this->metrics_topic_name_ = _sdf->GetElement("metricsTopicName")->Get<std::string>();
+
+  this->lod_topic_name_ = ros::this_node::getName() + "/sensor_lod";
+  if (_sdf->HasElement("lodTopicName"))
+    this->lod_topic_name_ = _sdf->GetElement("lodTopicName")->Get<std::string>();
+
+  if (_sdf->HasElement("targetRealTimeFactor"))
+    this->target_rtf_ = _sdf->GetElement("targetRealTimeFactor")->Get<double>();
+  if (_sdf->HasElement("restoreRealTimeFactor"))
+    this->restore_rtf_ = _sdf->GetElement("restoreRealTimeFactor")->Get<double>();
+  if (this->restore_rtf_ < this->target_rtf_)
+  {
+    ROS_WARN_NAMED("sensor_lod", "Sensor LOD plugin <restoreRealTimeFactor> is below "
+      "<targetRealTimeFactor>, using %f", this->target_rtf_);
+    this->restore_rtf_ = this->target_rtf_;
+  }
+  if (_sdf->HasElement("holdTime"))
+    this->hold_time_ = _sdf->GetElement("holdTime")->Get<double>();
+
+  if (_sdf->HasElement("sensor"))
+  {
+    for (sdf::ElementPtr elem = _sdf->GetElement("sensor"); elem;
+         elem = elem->GetNextElement("sensor"))
+    {
+      Sensor sensor;
+      if (!elem->HasElement("name"))
+      {
+        ROS_ERROR_NAMED("sensor_lod", "Sensor LOD plugin <sensor> without <name>, ignored");
+        continue;
+      }
+      sensor.name = elem->GetElement("name")->Get<std::string>();
+      sensor.levels = 3;
+      if (elem->HasElement("levels"))
+        sensor.levels = std::max(1, elem->GetElement("levels")->Get<int>());
+      sensor.min_update_rate = 0.0;
+      if (elem->HasElement("minUpdateRate"))
+        sensor.min_update_rate = elem->GetElement("minUpdateRate")->Get<double>();
+      sensor.max_decimation = 1;
+      if (elem->HasElement("maxDecimation"))
+        sensor.max_decimation = std::max(1, elem->GetElement("maxDecimation")->Get<int>());
+      sensor.level = 0;
+      sensor.full_update_rate = 0.0;
+      this->sensors_.push_back(sensor);
+    }
+  }
+  if (this->sensors_.empty())
+  {
+    ROS_WARN_NAMED("sensor_lod", "Sensor LOD plugin has no <sensor>, nothing to do");
+    return;
+  }
+
+  // Make sure the ROS node for Gazebo has already been initialized
+  if (!ros::isInitialized())
+  {
+    ROS_FATAL_STREAM_NAMED("sensor_lod", "A ROS node for Gazebo has not been initialized, unable to load plugin. "
+      << "Load the Gazebo system plugin 'libgazebo_ros_api_plugin.so' in the gazebo_ros package)");
+    return;
+  }
+
+  this->rosnode_ = new ros::NodeHandle(this->robot_namespace_);
+
+  ros::AdvertiseOptions ao =
+    ros::AdvertiseOptions::create<gazebo_msgs::SensorLevelOfDetailArray>(
+      this->lod_topic_name_, 1, ros::SubscriberStatusCallback(),
+      ros::SubscriberStatusCallback(), ros::VoidPtr(), &this->queue_);
+  ao.latch = true;
+  this->lod_pub_ = this->rosnode_->advertise(ao);
+
+  // subscribing makes gazebo_ros_api_plugin forward the metrics
+  ros::SubscribeOptions so =
+    ros::SubscribeOptions::create<gazebo_msgs::PerformanceMetrics>(
+      this->metrics_topic_name_, 1,
+      boost::bind(&GazeboRosSensorLod::OnMetrics, this, _1),
+      ros::VoidPtr(), &this->queue_);
+  GetSubscriptionHints(*this->rosnode_, _sdf).apply(so);
+  this->metrics_sub_ = this->rosnode_->subscribe(so);
+
+  this->last_change_ = ros::WallTime::now();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Adjust the level of detail
+void GazeboRosSensorLod::OnMetrics(
+  const gazebo_msgs::PerformanceMetrics::ConstPtr &_msg)
+{
+  const double rtf = _msg->real_time_factor;
+
+  bool resolved = false;
+  for (size_t i = 0; i < this->sensors_.size(); ++i)
+  {
+    Sensor &sensor = this->sensors_[i];
+    if (!sensor.sensor.expired())
+      continue;
+    if (!sensor.scoped_name.empty())
+    {
+      // the sensor was removed, a respawned one starts at full detail
+      sensor.decimation->store(1);
+      sensor.scoped_name.clear();
+      sensor.level = 0;
+      resolved = true;
+    }
+    if (this->Resolve(sensor))
+      resolved = true;
+  }
+
+  ros::WallTime now = ros::WallTime::now();
+  if ((now - this->last_change_).toSec() < this->hold_time_)
+  {
+    if (resolved)
+      this->Publish(rtf);
+    return;
+  }
+
+  // degrade the most detailed sensor, the first listed first, or restore
+  // the most degraded one, the last listed first
+  int chosen = -1;
+  if (rtf < this->target_rtf_)
+  {
+    for (size_t i = 0; i < this->sensors_.size(); ++i)
+    {
+      const Sensor &sensor = this->sensors_[i];
+      if (sensor.scoped_name.empty() || sensor.level >= sensor.levels)
+        continue;
+      if (chosen < 0 || sensor.level < this->sensors_[chosen].level)
+        chosen = static_cast<int>(i);
+    }
+    if (chosen >= 0)
+      this->sensors_[chosen].level++;
+  }
+  else if (rtf > this->restore_rtf_)
+  {
+    for (size_t i = 0; i < this->sensors_.size(); ++i)
+    {
+      const Sensor &sensor = this->sensors_[i];
+      if (sensor.scoped_name.empty() || sensor.level == 0)
+        continue;
+      if (chosen < 0 || sensor.level >= this->sensors_[chosen].level)
+        chosen = static_cast<int>(i);
+    }
+    if (chosen >= 0)
+      this->sensors_[chosen].level--;
+  }
+
+  if (chosen >= 0)
+  {
+    Sensor &sensor = this->sensors_[chosen];
+    this->Apply(sensor);
+    this->last_change_ = now;
+    ROS_INFO_NAMED("sensor_lod", "Sensor LOD: real time factor %f, %s at level %u of %u",
+      rtf, sensor.scoped_name.c_str(), sensor.level, sensor.levels);
+  }
+  if (chosen >= 0 || resolved)
+    this->Publish(rtf);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Find a sensor by name or scoped name
+bool GazeboRosSensorLod::Resolve(Sensor &_sensor)
+{
+  sensors::Sensor_V all = sensors::SensorManager::Instance()->GetSensors();
+  for (size_t i = 0; i < all.size(); ++i)
+  {
+    if (all[i]->Name() != _sensor.name && all[i]->ScopedName() != _sensor.name)
+      continue;
+
+    _sensor.sensor = all[i];
+    _sensor.scoped_name = all[i]->ScopedName();
+    _sensor.decimation = SensorLod::Instance().Decimation(_sensor.scoped_name);
+
+    // a staggered sensor reads as parked, triggered and unlimited sensors
+    // are left alone
+    double rate = 0.0;
+    if (!RenderScheduler::Instance().UpdateRate(all[i], rate))
+      rate = all[i]->UpdateRate();
+    _sensor.full_update_rate = rate > 1e-6 && !std::isinf(rate) ? rate : 0.0;
+    return true;
+  }
+  return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Update rate and decimation at a level
+void GazeboRosSensorLod::Detail(const Sensor &_sensor, double &_update_rate,
+                                unsigned int &_decimation) const
+{
+  const double fraction = static_cast<double>(_sensor.level) / _sensor.levels;
+
+  _update_rate = _sensor.full_update_rate;
+  if (_sensor.full_update_rate > 0.0 && _sensor.min_update_rate > 0.0 &&
+      _sensor.min_update_rate < _sensor.full_update_rate)
+    _update_rate = _sensor.full_update_rate *
+      std::pow(_sensor.min_update_rate / _sensor.full_update_rate, fraction);
+
+  _decimation = static_cast<unsigned int>(
+    std::max(1L, std::lround(std::pow(_sensor.max_decimation, fraction))));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Apply the level of a sensor
+void GazeboRosSensorLod::Apply(Sensor &_sensor)
+{
+  sensors::SensorPtr sensor = _sensor.sensor.lock();
+  if (!sensor)
+    return;
+
+  double update_rate;
+  unsigned int decimation;
+  this->Detail(_sensor, update_rate, decimation);
+
+  if (_sensor.full_update_rate > 0.0 &&
+      !RenderScheduler::Instance().SetUpdateRate(sensor, update_rate))
+    sensor->SetUpdateRate(update_rate);
+  _sensor.decimation->store(decimation);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Publish the level of every sensor
+void GazeboRosSensorLod::Publish(double _real_time_factor)
+{
+  this->lod_msg_.header.stamp = ros::Time::now();
+  this->lod_msg_.real_time_factor = _real_time_factor;
+  this->lod_msg_.sensors.resize(this->sensors_.size());
+  for (size_t i = 0; i < this->sensors_.size(); ++i)
+  {
+    const Sensor &sensor = this->sensors_[i];
+    gazebo_msgs::SensorLevelOfDetail &lod = this->lod_msg_.sensors[i];
+    lod.name = sensor.scoped_name.empty() ? sensor.name : sensor.scoped_name;
+    lod.level = sensor.level;
+    lod.max_level = sensor.levels;
+    double update_rate;
+    unsigned int decimation;
+    this->Detail(sensor, update_rate, decimation);
+    lod.update_rate = update_rate;
+    lod.decimation = decimation;
+  }
+  this->lod_pub_.publish(this->lod_msg_);
+}
+}
@@ -0,0 +1,158 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+
+#include <boost/bind.hpp>
+
+#include <gazebo_plugins/gazebo_ros_sensor_recorder.h>
+#include <gazebo_plugins/gazebo_ros_utils.h>
+
+#include <sdf/sdf.hh>
+
+namespace gazebo
+{
+// Register this plugin with the simulator
+GZ_REGISTER_WORLD_PLUGIN(GazeboRosSensorRecorder)
+
+////////////////////////////////////////////////////////////////////////////////
+// Constructor
+GazeboRosSensorRecorder::GazeboRosSensorRecorder()
+  : rosnode_(NULL), queue_(true)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Destructor
+GazeboRosSensorRecorder::~GazeboRosSensorRecorder()
+{
+  SensorRecorder::Instance().Stop();
+
+  if (!this->rosnode_)
+    return;
+  this->queue_.clear();
+  this->queue_.disable();
+  this->rosnode_->shutdown();
+  this->queue_.Stop();
+  delete this->rosnode_;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Load the plugin
+void GazeboRosSensorRecorder::Load(physics::WorldPtr _world,
+                                   sdf::ElementPtr _sdf)
+{
+  GAZEBO_ROS_STARTUP_PHASE("load");
+
+  this->robot_namespace_ = "";
+  if (_sdf->HasElement("robotNamespace"))
+    this->robot_namespace_ = _sdf->GetElement("robotNamespace")->Get<std::string>() + "/";
+
+  if (_sdf->HasElement("prefix"))
+    this->options_.prefix = _sdf->Get<std::string>("prefix");
+
+  if (_sdf->HasElement("chunkSize"))
+    this->options_.chunk_size = static_cast<size_t>(
+      std::max(_sdf->Get<double>("chunkSize"), 1.0) * (1 << 20));
+
+  if (_sdf->HasElement("chunkCount"))
+    this->options_.chunk_count = std::max(_sdf->Get<int>("chunkCount"), 2);
+
+  if (_sdf->HasElement("compressionThreads"))
+    this->options_.threads = std::max(_sdf->Get<int>("compressionThreads"), 1);
+
+  std::string compression = "none";
+  if (_sdf->HasElement("compression"))
+    compression = _sdf->Get<std::string>("compression");
+  if (compression == "bz2")
+    this->options_.compression = SensorRecorder::COMPRESSION_BZ2;
+  else if (compression != "none")
+    ROS_WARN_NAMED("sensor_recorder", "Unknown <compression> [%s], recording "
+      "uncompressed", compression.c_str());
+
+  bool auto_start = true;
+  if (_sdf->HasElement("autoStart"))
+    auto_start = _sdf->Get<bool>("autoStart");
+
+  std::string service_name = "sensor_recorder/record";
+  if (_sdf->HasElement("serviceName"))
+    service_name = _sdf->Get<std::string>("serviceName");
+
+  // Make sure the ROS node for Gazebo has already been initialized
+  if (!ros::isInitialized())
+  {
+    ROS_FATAL_STREAM_NAMED("sensor_recorder", "A ROS node for Gazebo has not been initialized, unable to load plugin. "
+      << "Load the Gazebo system plugin 'libgazebo_ros_api_plugin.so' in the gazebo_ros package)");
+    return;
+  }
+
+  this->rosnode_ = new ros::NodeHandle(this->robot_namespace_);
+
+  // the publishers report resolved topic names
+  if (_sdf->HasElement("topics"))
+  {
+    std::istringstream topics(_sdf->Get<std::string>("topics"));
+    std::string topic;
+    while (topics >> topic)
+    {
+      bool prefix = topic[topic.size() - 1] == '*';
+      if (prefix)
+        topic.erase(topic.size() - 1);
+      topic = topic.empty() ? "/" : this->rosnode_->resolveName(topic);
+      if (prefix)
+        topic += "*";
+      this->options_.topics.push_back(topic);
+    }
+  }
+
+  ros::AdvertiseServiceOptions aso =
+    ros::AdvertiseServiceOptions::create<std_srvs::SetBool>(
+      service_name, boost::bind(&GazeboRosSensorRecorder::Record, this, _1, _2),
+      ros::VoidPtr(), &this->queue_);
+  this->record_service_ = this->rosnode_->advertiseService(aso);
+
+  if (auto_start && !SensorRecorder::Instance().Start(this->options_))
+    ROS_ERROR_NAMED("sensor_recorder", "Unable to start recording to %s",
+      this->options_.prefix.c_str());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Start or stop recording
+bool GazeboRosSensorRecorder::Record(std_srvs::SetBool::Request &_req,
+                                     std_srvs::SetBool::Response &_res)
+{
+  SensorRecorder &recorder = SensorRecorder::Instance();
+  if (!_req.data)
+  {
+    recorder.Stop();
+    std::ostringstream message;
+    message << "recorded " << recorder.Recorded() << " messages in "
+            << recorder.ChunksWritten() << " chunks, dropped "
+            << recorder.Dropped();
+    _res.success = true;
+    _res.message = message.str();
+    return true;
+  }
+
+  _res.success = recorder.Start(this->options_);
+  _res.message = _res.success ? "recording" :
+    "already recording or unable to create the chunk files";
+  return true;
+}
+}
@@ -41,10 +41,9 @@
 #include <assert.h>
 
 #include <gazebo_plugins/gazebo_ros_skid_steer_drive.h>
+#include <gazebo_plugins/gazebo_ros_utils.h>
 
-#ifdef ENABLE_PROFILER
-#include <ignition/common/Profiler.hh>
-#endif
+#include <gazebo_ros/profiler.h>
 #include <ignition/math/Pose3.hh>
 #include <ignition/math/Vector3.hh>
 #include <sdf/sdf.hh>
@@ -67,16 +66,18 @@ namespace gazebo {
     LEFT_REAR=3,
   };
 
-  GazeboRosSkidSteerDrive::GazeboRosSkidSteerDrive() {}
+  GazeboRosSkidSteerDrive::GazeboRosSkidSteerDrive() : rosnode_(NULL) {}
 
   // Destructor
   GazeboRosSkidSteerDrive::~GazeboRosSkidSteerDrive() {
+    if (deferred_load_task_)
+      deferred_load_task_->Wait();
     delete rosnode_;
-    delete transform_broadcaster_;
   }
 
   // Load the controller
   void GazeboRosSkidSteerDrive::Load(physics::ModelPtr _parent, sdf::ElementPtr _sdf) {
+    GAZEBO_ROS_STARTUP_PHASE("load");
 
     this->parent = _parent;
     this->world = _parent->GetWorld();
@@ -247,8 +248,6 @@ namespace gazebo {
     wheel_speed_[RIGHT_REAR] = 0;
 	wheel_speed_[LEFT_REAR] = 0;
 
-    x_ = 0;
-    rot_ = 0;
     alive_ = true;
 
     joints[LEFT_FRONT] = this->parent->GetJoint(left_front_joint_name_);
@@ -308,26 +307,26 @@ namespace gazebo {
       return;
     }
 
+    setTransportHints(_sdf);
+    if (DeferredLoad::Requested(_sdf))
+      deferred_load_task_ = DeferredLoad::Instance().Run(this->handleName,
+          boost::bind(&GazeboRosSkidSteerDrive::LoadThread, this));
+    else
+      LoadThread();
+  }
+
+  void GazeboRosSkidSteerDrive::LoadThread() {
     rosnode_ = new ros::NodeHandle(this->robot_namespace_);
 
     ROS_INFO_NAMED("skid_steer_drive", "Starting GazeboRosSkidSteerDrive Plugin (ns = %s)", this->robot_namespace_.c_str());
 
     tf_prefix_ = tf::getPrefixParam(*rosnode_);
-    transform_broadcaster_ = new tf::TransformBroadcaster();
 
     // ROS: Subscribe to the velocity command topic (usually "cmd_vel")
-    ros::SubscribeOptions so =
-      ros::SubscribeOptions::create<geometry_msgs::Twist>(command_topic_, 1,
-          boost::bind(&GazeboRosSkidSteerDrive::cmdVelCallback, this, _1),
-          ros::VoidPtr(), &queue_);
-
-    cmd_vel_subscriber_ = rosnode_->subscribe(so);
-
-    odometry_publisher_ = rosnode_->advertise<nav_msgs::Odometry>(odometry_topic_, 1);
-
-    // start custom queue for diff drive
-    this->callback_queue_thread_ =
-      boost::thread(boost::bind(&GazeboRosSkidSteerDrive::QueueThread, this));
+    loadDrive(this->parent, *rosnode_, command_topic_, odometry_topic_,
+        tf::resolve(tf_prefix_, odometry_frame_),
+        tf::resolve(tf_prefix_, robot_base_frame_));
+    setOdometryCovariance(covariance_x_, covariance_y_, covariance_yaw_, true);
 
     // listen to the update event (broadcast every simulation iteration)
     this->update_connection_ =
@@ -339,9 +338,7 @@ namespace gazebo {
   // Update the controller
   void GazeboRosSkidSteerDrive::UpdateChild()
   {
-#ifdef ENABLE_PROFILER
-    IGN_PROFILE("GazeboRosSkidSteerDrive::UpdateChild");
-#endif
+    GAZEBO_ROS_PROFILE("GazeboRosSkidSteerDrive::UpdateChild");
 #if GAZEBO_MAJOR_VERSION >= 8
     common::Time current_time = this->world->SimTime();
 #else
@@ -350,21 +347,18 @@ namespace gazebo {
     double seconds_since_last_update =
       (current_time - last_update_time_).Double();
     if (seconds_since_last_update > update_period_) {
-#ifdef ENABLE_PROFILER
-      IGN_PROFILE_BEGIN("publishOdometry");
-#endif
-      publishOdometry(seconds_since_last_update);
-#ifdef ENABLE_PROFILER
-      IGN_PROFILE_END();
+      GAZEBO_ROS_PROFILE_BEGIN("publishOdometry");
+      // TODO create some non-perfect odometry!
+      setOdometryFromWorld();
+      publishOdometry(ros::Time::now(), this->broadcast_tf_);
+      publishTF();
+      GAZEBO_ROS_PROFILE_END();
 
       // Update robot in case new velocities have been requested
-      IGN_PROFILE_BEGIN("getWheelVelocities");
-#endif
+      GAZEBO_ROS_PROFILE_BEGIN("getWheelVelocities");
       getWheelVelocities();
-#ifdef ENABLE_PROFILER
-      IGN_PROFILE_END();
-      IGN_PROFILE_BEGIN("SetVelocity");
-#endif
+      GAZEBO_ROS_PROFILE_END();
+      GAZEBO_ROS_PROFILE_BEGIN("SetVelocity");
 #if GAZEBO_MAJOR_VERSION > 2
       joints[LEFT_FRONT]->SetParam("vel", 0, wheel_speed_[LEFT_FRONT] / (wheel_diameter_ / 2.0));
       joints[RIGHT_FRONT]->SetParam("vel", 0, wheel_speed_[RIGHT_FRONT] / (wheel_diameter_ / 2.0));
@@ -376,9 +370,7 @@ namespace gazebo {
       joints[LEFT_REAR]->SetVelocity(0, wheel_speed_[LEFT_REAR] / (wheel_diameter_ / 2.0));
       joints[RIGHT_REAR]->SetVelocity(0, wheel_speed_[RIGHT_REAR] / (wheel_diameter_ / 2.0));
 #endif
-#ifdef ENABLE_PROFILER
-      IGN_PROFILE_END();
-#endif
+      GAZEBO_ROS_PROFILE_END();
       last_update_time_+= common::Time(update_period_);
     }
   }
@@ -386,17 +378,14 @@ namespace gazebo {
   // Finalize the controller
   void GazeboRosSkidSteerDrive::FiniChild() {
     alive_ = false;
-    queue_.clear();
-    queue_.disable();
-    rosnode_->shutdown();
-    callback_queue_thread_.join();
+    finiDrive(*rosnode_);
   }
 
   void GazeboRosSkidSteerDrive::getWheelVelocities() {
-    boost::mutex::scoped_lock scoped_lock(lock);
+    geometry_msgs::Twist cmd = command();
 
-    double vr = x_;
-    double va = rot_;
+    double vr = cmd.linear.x;
+    double va = cmd.angular.z;
 
     wheel_speed_[RIGHT_FRONT] = vr + va * wheel_separation_ / 2.0;
     wheel_speed_[RIGHT_REAR] = vr + va * wheel_separation_ / 2.0;
@@ -406,91 +395,5 @@ namespace gazebo {
 
   }
 
-  void GazeboRosSkidSteerDrive::cmdVelCallback(
-      const geometry_msgs::Twist::ConstPtr& cmd_msg) {
-
-    boost::mutex::scoped_lock scoped_lock(lock);
-    x_ = cmd_msg->linear.x;
-    rot_ = cmd_msg->angular.z;
-  }
-
-  void GazeboRosSkidSteerDrive::QueueThread() {
-    static const double timeout = 0.01;
-
-    while (alive_ && rosnode_->ok()) {
-      queue_.callAvailable(ros::WallDuration(timeout));
-    }
-  }
-
-  void GazeboRosSkidSteerDrive::publishOdometry(double step_time) {
-    ros::Time current_time = ros::Time::now();
-    std::string odom_frame =
-      tf::resolve(tf_prefix_, odometry_frame_);
-    std::string base_footprint_frame =
-      tf::resolve(tf_prefix_, robot_base_frame_);
-
-    // TODO create some non-perfect odometry!
-    // getting data for base_footprint to odom transform
-#if GAZEBO_MAJOR_VERSION >= 8
-    ignition::math::Pose3d pose = this->parent->WorldPose();
-#else
-    ignition::math::Pose3d pose = this->parent->GetWorldPose().Ign();
-#endif
-
-    tf::Quaternion qt(pose.Rot().X(), pose.Rot().Y(), pose.Rot().Z(), pose.Rot().W());
-    tf::Vector3 vt(pose.Pos().X(), pose.Pos().Y(), pose.Pos().Z());
-
-    tf::Transform base_footprint_to_odom(qt, vt);
-    if (this->broadcast_tf_) {
-
-    	transform_broadcaster_->sendTransform(
-        tf::StampedTransform(base_footprint_to_odom, current_time,
-            odom_frame, base_footprint_frame));
-
-    }
-
-    // publish odom topic
-    odom_.pose.pose.position.x = pose.Pos().X();
-    odom_.pose.pose.position.y = pose.Pos().Y();
-
-    odom_.pose.pose.orientation.x = pose.Rot().X();
-    odom_.pose.pose.orientation.y = pose.Rot().Y();
-    odom_.pose.pose.orientation.z = pose.Rot().Z();
-    odom_.pose.pose.orientation.w = pose.Rot().W();
-    odom_.pose.covariance[0] = this->covariance_x_;
-    odom_.pose.covariance[7] = this->covariance_y_;
-    odom_.pose.covariance[14] = 1000000000000.0;
-    odom_.pose.covariance[21] = 1000000000000.0;
-    odom_.pose.covariance[28] = 1000000000000.0;
-    odom_.pose.covariance[35] = this->covariance_yaw_;
-
-    // get velocity in /odom frame
-    ignition::math::Vector3d linear;
-#if GAZEBO_MAJOR_VERSION >= 8
-    linear = this->parent->WorldLinearVel();
-    odom_.twist.twist.angular.z = this->parent->WorldAngularVel().Z();
-#else
-    linear = this->parent->GetWorldLinearVel().Ign();
-    odom_.twist.twist.angular.z = this->parent->GetWorldAngularVel().Ign().Z();
-#endif
-
-    // convert velocity to child_frame_id (aka base_footprint)
-    float yaw = pose.Rot().Yaw();
-    odom_.twist.twist.linear.x = cosf(yaw) * linear.X() + sinf(yaw) * linear.Y();
-    odom_.twist.twist.linear.y = cosf(yaw) * linear.Y() - sinf(yaw) * linear.X();
-    odom_.twist.covariance[0] = this->covariance_x_;
-    odom_.twist.covariance[7] = this->covariance_y_;
-    odom_.twist.covariance[14] = 1000000000000.0;
-    odom_.twist.covariance[21] = 1000000000000.0;
-    odom_.twist.covariance[28] = 1000000000000.0;
-    odom_.twist.covariance[35] = this->covariance_yaw_;
-
-    odom_.header.stamp = current_time;
-    odom_.header.frame_id = odom_frame;
-    odom_.child_frame_id = base_footprint_frame;
-
-    odometry_publisher_.publish(odom_);
-  }
-
   GZ_REGISTER_MODEL_PLUGIN(GazeboRosSkidSteerDrive)
 }
@@ -0,0 +1,176 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <string>
+
+#include <gazebo_plugins/gazebo_ros_transport_bridge.h>
+
+#include <sdf/sdf.hh>
+
+namespace gazebo
+{
+// Register this plugin with the simulator
+GZ_REGISTER_WORLD_PLUGIN(GazeboRosTransportBridge)
+
+namespace
+{
+/// \brief Creates the channel of one pair of types.
+typedef TransportBridgeChannel::Ptr (*ChannelFactory)(
+    ros::NodeHandle &, transport::NodePtr, PubMultiQueue &,
+    const std::string &, const std::string &, const std::string &,
+    unsigned int);
+
+template<class G, class R>
+TransportBridgeChannel::Ptr CreateChannel(ros::NodeHandle &_rosnode,
+    transport::NodePtr _gazebo_node, PubMultiQueue &_pmq,
+    const std::string &_gazebo_topic, const std::string &_ros_topic,
+    const std::string &_frame_name, unsigned int _queue_size)
+{
+  return TransportBridgeChannel::Ptr(new TransportBridgeChannelT<G, R>(
+    _rosnode, _gazebo_node, _pmq, _gazebo_topic, _ros_topic, _frame_name,
+    _queue_size));
+}
+
+/// \brief The <type> names of the supported pairs.
+struct ChannelType
+{
+  const char *name;
+  ChannelFactory create;
+};
+
+const ChannelType channel_types[] =
+{
+  {"imu", &CreateChannel<msgs::IMU, sensor_msgs::Imu>},
+  {"laser_scan", &CreateChannel<msgs::LaserScanStamped, sensor_msgs::LaserScan>},
+  {"pose", &CreateChannel<msgs::PoseStamped, geometry_msgs::PoseStamped>},
+  {"wrench", &CreateChannel<msgs::WrenchStamped, geometry_msgs::WrenchStamped>},
+  {"image", &CreateChannel<msgs::ImageStamped, sensor_msgs::Image>},
+  {"clock", &CreateChannel<msgs::WorldStatistics, rosgraph_msgs::Clock>},
+  {"gps", &CreateChannel<msgs::GPS, sensor_msgs::NavSatFix>},
+  {"magnetometer", &CreateChannel<msgs::Magnetometer, sensor_msgs::MagneticField>}
+};
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Constructor
+GazeboRosTransportBridge::GazeboRosTransportBridge()
+  : rosnode_(NULL)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Destructor
+GazeboRosTransportBridge::~GazeboRosTransportBridge()
+{
+  // unsubscribe before the queues and the node go away
+  this->channels_.clear();
+  this->gazebo_node_.reset();
+  if (!this->rosnode_)
+    return;
+  this->rosnode_->shutdown();
+  delete this->rosnode_;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Load the plugin
+void GazeboRosTransportBridge::Load(physics::WorldPtr _world,
+                                    sdf::ElementPtr _sdf)
+{
+  GAZEBO_ROS_STARTUP_PHASE("load");
+
+  this->robot_namespace_ = "";
+  if (_sdf->HasElement("robotNamespace"))
+    this->robot_namespace_ = _sdf->GetElement("robotNamespace")->Get<std::string>() + "/";
+
+  // Make sure the ROS node for Gazebo has already been initialized
+  if (!ros::isInitialized())
+  {
+    ROS_FATAL_STREAM_NAMED("transport_bridge", "A ROS node for Gazebo has not been initialized, unable to load plugin. "
+      << "Load the Gazebo system plugin 'libgazebo_ros_api_plugin.so' in the gazebo_ros package)");
+    return;
+  }
+
+  this->gazebo_node_ = transport::NodePtr(new transport::Node());
+#if GAZEBO_MAJOR_VERSION >= 8
+  this->gazebo_node_->Init(_world->Name());
+#else
+  this->gazebo_node_->Init(_world->GetName());
+#endif
+
+  this->pmq.startService();
+
+  this->rosnode_ = new ros::NodeHandle(this->robot_namespace_);
+
+  if (!_sdf->HasElement("bridge"))
+  {
+    ROS_WARN_NAMED("transport_bridge", "Transport bridge plugin has no "
+      "<bridge> elements, nothing to republish");
+    return;
+  }
+
+  for (sdf::ElementPtr elem = _sdf->GetElement("bridge"); elem;
+       elem = elem->GetNextElement("bridge"))
+  {
+    this->AddChannel(elem);
+  }
+
+  ROS_INFO_NAMED("transport_bridge", "Transport bridge (ns = %s) republishing "
+    "%lu gazebo topics", this->robot_namespace_.c_str(),
+    static_cast<unsigned long>(this->channels_.size()));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Add the channel described by a <bridge> element
+bool GazeboRosTransportBridge::AddChannel(sdf::ElementPtr _elem)
+{
+  if (!_elem->HasElement("gazeboTopic") || !_elem->HasElement("rosTopic") ||
+      !_elem->HasElement("type"))
+  {
+    ROS_ERROR_NAMED("transport_bridge", "<bridge> needs <gazeboTopic>, "
+      "<rosTopic> and <type>, ignored");
+    return false;
+  }
+
+  std::string gazebo_topic = _elem->Get<std::string>("gazeboTopic");
+  std::string ros_topic = _elem->Get<std::string>("rosTopic");
+  std::string type = _elem->Get<std::string>("type");
+
+  std::string frame_name = "world";
+  if (_elem->HasElement("frameName"))
+    frame_name = _elem->Get<std::string>("frameName");
+
+  unsigned int queue_size = 1;
+  if (_elem->HasElement("queueSize"))
+    queue_size = _elem->Get<unsigned int>("queueSize");
+
+  for (size_t i = 0; i < sizeof(channel_types) / sizeof(channel_types[0]); ++i)
+  {
+    if (type != channel_types[i].name)
+      continue;
+    this->channels_.push_back(channel_types[i].create(*this->rosnode_,
+      this->gazebo_node_, this->pmq, gazebo_topic, ros_topic, frame_name,
+      queue_size));
+    ROS_DEBUG_NAMED("transport_bridge", "Bridging %s [%s] to %s",
+      gazebo_topic.c_str(), type.c_str(), ros_topic.c_str());
+    return true;
+  }
+
+  ROS_ERROR_NAMED("transport_bridge", "Unknown <type> [%s] of <bridge> %s, "
+    "ignored", type.c_str(), gazebo_topic.c_str());
+  return false;
+}
+}
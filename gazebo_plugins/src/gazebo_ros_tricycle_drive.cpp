@@ -44,9 +44,7 @@
 
 #include <gazebo_plugins/gazebo_ros_tricycle_drive.h>
 
-#ifdef ENABLE_PROFILER
-#include <ignition/common/Profiler.hh>
-#endif
+#include <gazebo_ros/profiler.h>
 #include <ignition/math/Pose3.hh>
 #include <ignition/math/Vector3.hh>
 #include <sdf/sdf.hh>
@@ -71,11 +69,15 @@ enum {
 GazeboRosTricycleDrive::GazeboRosTricycleDrive() {}
 
 // Destructor
-GazeboRosTricycleDrive::~GazeboRosTricycleDrive() {}
+GazeboRosTricycleDrive::~GazeboRosTricycleDrive()
+{
+    if ( deferred_load_task_ ) deferred_load_task_->Wait();
+}
 
 // Load the controller
 void GazeboRosTricycleDrive::Load ( physics::ModelPtr _parent, sdf::ElementPtr _sdf )
 {
+    GAZEBO_ROS_STARTUP_PHASE("load");
     parent = _parent;
     gazebo_ros_ = GazeboRosPtr ( new GazeboRos ( _parent, _sdf, "TricycleDrive" ) );
     // Make sure the ROS node for Gazebo has already been initialized
@@ -128,103 +130,66 @@ void GazeboRosTricycleDrive::Load ( physics::ModelPtr _parent, sdf::ElementPtr _
     // Initialize velocity stuff
     alive_ = true;
 
+    // resolve the frames once, they are reused by every update
+    joints_.push_back ( joint_steering_ );
+    joints_.push_back ( joint_wheel_actuated_ );
+    joints_.push_back ( joint_wheel_encoder_left_ );
+    joints_.push_back ( joint_wheel_encoder_right_ );
+    for ( std::size_t i = 0; i < joints_.size(); i++ ) {
+        joint_frames_.push_back ( gazebo_ros_->resolveTF ( joints_[i]->GetName() ) );
+        joint_parent_frames_.push_back ( gazebo_ros_->resolveTF ( joints_[i]->GetParent()->GetName() ) );
+    }
+
+    setTransportHints ( _sdf );
+    if ( DeferredLoad::Requested ( _sdf ) )
+        deferred_load_task_ = DeferredLoad::Instance().Run ( this->handleName,
+                                  boost::bind ( &GazeboRosTricycleDrive::LoadThread, this ) );
+    else
+        LoadThread();
+}
+
+void GazeboRosTricycleDrive::LoadThread()
+{
     if ( this->publishWheelJointState_ ) {
-        joint_state_publisher_ = gazebo_ros_->node()->advertise<sensor_msgs::JointState> ( "joint_states", 1000 );
+        advertiseJointStates ( *gazebo_ros_->node(), joints_, true );
         ROS_INFO_NAMED("tricycle_drive", "%s: Advertise joint_states", gazebo_ros_->info() );
     }
 
-    transform_broadcaster_ = boost::shared_ptr<tf::TransformBroadcaster> ( new tf::TransformBroadcaster() );
-
     // ROS: Subscribe to the velocity command topic (usually "cmd_vel")
     ROS_INFO_NAMED("tricycle_drive", "%s: Try to subscribe to %s", gazebo_ros_->info(), command_topic_.c_str() );
 
-    ros::SubscribeOptions so =
-        ros::SubscribeOptions::create<geometry_msgs::Twist> ( command_topic_, 1,
-                boost::bind ( &GazeboRosTricycleDrive::cmdVelCallback, this, _1 ),
-                ros::VoidPtr(), &queue_ );
-
-    cmd_vel_subscriber_ = gazebo_ros_->node()->subscribe ( so );
+    loadDrive ( parent, *gazebo_ros_->node(), command_topic_, odometry_topic_,
+                gazebo_ros_->resolveTF ( odometry_frame_ ),
+                gazebo_ros_->resolveTF ( robot_base_frame_ ) );
+    setOdometryCovariance ( 0.00001, 0.00001, 0.001, false );
     ROS_INFO_NAMED("tricycle_drive", "%s: Subscribe to %s", gazebo_ros_->info(), command_topic_.c_str() );
 
-    odometry_publisher_ = gazebo_ros_->node()->advertise<nav_msgs::Odometry> ( odometry_topic_, 1 );
     ROS_INFO_NAMED("tricycle_drive", "%s: Advertise odom on %s ", gazebo_ros_->info(), odometry_topic_.c_str() );
 
-    // start custom queue for diff drive
-    this->callback_queue_thread_ = boost::thread ( boost::bind ( &GazeboRosTricycleDrive::QueueThread, this ) );
-
     // listen to the update event (broadcast every simulation iteration)
     this->update_connection_ = event::Events::ConnectWorldUpdateBegin ( boost::bind ( &GazeboRosTricycleDrive::UpdateChild, this ) );
 
 }
 
-void GazeboRosTricycleDrive::publishWheelJointState()
+void GazeboRosTricycleDrive::publishWheelTF ( const ros::Time &current_time )
 {
-    std::vector<physics::JointPtr> joints;
-    joints.push_back ( joint_steering_ );
-    joints.push_back ( joint_wheel_actuated_ );
-    joints.push_back ( joint_wheel_encoder_left_ );
-    joints.push_back ( joint_wheel_encoder_right_ );
-
-    ros::Time current_time = ros::Time::now();
-    joint_state_.header.stamp = current_time;
-    joint_state_.name.resize ( joints.size() );
-    joint_state_.position.resize ( joints.size() );
-    joint_state_.velocity.resize ( joints.size() );
-    joint_state_.effort.resize ( joints.size() );
-    for ( std::size_t i = 0; i < joints.size(); i++ ) {
-        joint_state_.name[i] = joints[i]->GetName();
-#if GAZEBO_MAJOR_VERSION >= 8
-        joint_state_.position[i] = joints[i]->Position ( 0 );
-#else
-        joint_state_.position[i] = joints[i]->GetAngle ( 0 ).Radian();
-#endif
-        joint_state_.velocity[i] = joints[i]->GetVelocity ( 0 );
-        joint_state_.effort[i] = joints[i]->GetForce ( 0 );
+    for ( std::size_t i = 0; i < joints_.size(); i++ ) {
+        addLinkTF ( joints_[i]->GetChild(), joint_parent_frames_[i], joint_frames_[i], current_time );
     }
-    joint_state_publisher_.publish ( joint_state_ );
 }
 
-void GazeboRosTricycleDrive::publishWheelTF()
-{
-    ros::Time current_time = ros::Time::now();
-    std::vector<physics::JointPtr> joints;
-    joints.push_back ( joint_steering_ );
-    joints.push_back ( joint_wheel_actuated_ );
-    joints.push_back ( joint_wheel_encoder_left_ );
-    joints.push_back ( joint_wheel_encoder_right_ );
-    for ( std::size_t i = 0; i < joints.size(); i++ ) {
-        std::string frame = gazebo_ros_->resolveTF ( joints[i]->GetName() );
-        std::string parent_frame = gazebo_ros_->resolveTF ( joints[i]->GetParent()->GetName() );
-
-#if GAZEBO_MAJOR_VERSION >= 8
-        ignition::math::Pose3d pose = joints[i]->GetChild()->RelativePose();
-#else
-        ignition::math::Pose3d pose = joints[i]->GetChild()->GetRelativePose().Ign();
-#endif
-
-        tf::Quaternion qt ( pose.Rot().X(), pose.Rot().Y(), pose.Rot().Z(), pose.Rot().W() );
-        tf::Vector3 vt ( pose.Pos().X(), pose.Pos().Y(), pose.Pos().Z() );
-
-        tf::Transform transform ( qt, vt );
-        transform_broadcaster_->sendTransform ( tf::StampedTransform ( transform, current_time, parent_frame, frame ) );
-    }
-
-}
 // Update the controller
 void GazeboRosTricycleDrive::UpdateChild()
 {
-#ifdef ENABLE_PROFILER
-  IGN_PROFILE("GazeboRosTricycleDrive::UpdateChild");
-#endif
+  GAZEBO_ROS_PROFILE("GazeboRosTricycleDrive::UpdateChild");
     if ( odom_source_ == ENCODER )
     {
-#ifdef ENABLE_PROFILER
-      IGN_PROFILE_BEGIN("UpdateOdometryEncoder");
-#endif
-      UpdateOdometryEncoder();
-#ifdef ENABLE_PROFILER
-      IGN_PROFILE_END();
-#endif
+      GAZEBO_ROS_PROFILE_BEGIN("UpdateOdometryEncoder");
+      // the encoder wheels of the tricycle turn the other way round
+      integrateEncoder ( joint_wheel_encoder_right_->GetVelocity ( 0 ) * ( diameter_encoder_wheel_ / 2.0 ),
+                         joint_wheel_encoder_left_->GetVelocity ( 0 ) * ( diameter_encoder_wheel_ / 2.0 ),
+                         separation_encoder_wheel_ );
+      GAZEBO_ROS_PROFILE_END();
     }
 #if GAZEBO_MAJOR_VERSION >= 8
     common::Time current_time = parent->GetWorld()->SimTime();
@@ -233,36 +198,30 @@ void GazeboRosTricycleDrive::UpdateChild()
 #endif
     double seconds_since_last_update = ( current_time - last_actuator_update_ ).Double();
     if ( seconds_since_last_update > update_period_ ) {
-#ifdef ENABLE_PROFILER
-        IGN_PROFILE_BEGIN("publishOdometry");
-#endif
-        publishOdometry ( seconds_since_last_update );
-#ifdef ENABLE_PROFILER
-        IGN_PROFILE_END();
-#endif
+        ros::Time current_ros_time = ros::Time::now();
+        GAZEBO_ROS_PROFILE_BEGIN("publishOdometry");
+        if ( odom_source_ == WORLD ) setOdometryFromWorld();
+        publishOdometry ( current_ros_time, true );
+        GAZEBO_ROS_PROFILE_END();
         if ( publishWheelTF_ )
         {
-#ifdef ENABLE_PROFILER
-          IGN_PROFILE_BEGIN("publishWheelTF");
-#endif
-          publishWheelTF();
-#ifdef ENABLE_PROFILER
-          IGN_PROFILE_END();
-#endif
+          GAZEBO_ROS_PROFILE_BEGIN("publishWheelTF");
+          publishWheelTF ( current_ros_time );
+          GAZEBO_ROS_PROFILE_END();
         }
+        GAZEBO_ROS_PROFILE_BEGIN("publishTF");
+        publishTF();
+        GAZEBO_ROS_PROFILE_END();
         if ( publishWheelJointState_ )
         {
-#ifdef ENABLE_PROFILER
-          IGN_PROFILE_BEGIN("publishWheelJointState");
-#endif
-          publishWheelJointState();
-#ifdef ENABLE_PROFILER
-          IGN_PROFILE_END();
-#endif
+          GAZEBO_ROS_PROFILE_BEGIN("publishWheelJointState");
+          publishJointStates ( current_ros_time );
+          GAZEBO_ROS_PROFILE_END();
         }
 
-        double target_wheel_roation_speed = cmd_.speed / ( diameter_actuated_wheel_ / 2.0 );
-        double target_steering_angle = cmd_.angle;
+        geometry_msgs::Twist cmd = command();
+        double target_wheel_roation_speed = cmd.linear.x / ( diameter_actuated_wheel_ / 2.0 );
+        double target_steering_angle = cmd.angular.z;
 
         motorController ( target_wheel_roation_speed, target_steering_angle, seconds_since_last_update );
 
@@ -369,150 +328,7 @@ void GazeboRosTricycleDrive::motorController ( double target_speed, double targe
 void GazeboRosTricycleDrive::FiniChild()
 {
     alive_ = false;
-    queue_.clear();
-    queue_.disable();
-    gazebo_ros_->node()->shutdown();
-    callback_queue_thread_.join();
-}
-
-void GazeboRosTricycleDrive::cmdVelCallback ( const geometry_msgs::Twist::ConstPtr& cmd_msg )
-{
-    boost::mutex::scoped_lock scoped_lock ( lock );
-    cmd_.speed = cmd_msg->linear.x;
-    cmd_.angle = cmd_msg->angular.z;
-}
-
-void GazeboRosTricycleDrive::QueueThread()
-{
-    static const double timeout = 0.01;
-
-    while ( alive_ && gazebo_ros_->node()->ok() ) {
-        queue_.callAvailable ( ros::WallDuration ( timeout ) );
-    }
-}
-
-void GazeboRosTricycleDrive::UpdateOdometryEncoder()
-{
-    double vl = joint_wheel_encoder_left_->GetVelocity ( 0 );
-    double vr = joint_wheel_encoder_right_->GetVelocity ( 0 );
-#if GAZEBO_MAJOR_VERSION >= 8
-    common::Time current_time = parent->GetWorld()->SimTime();
-#else
-    common::Time current_time = parent->GetWorld()->GetSimTime();
-#endif
-    double seconds_since_last_update = ( current_time - last_odom_update_ ).Double();
-    last_odom_update_ = current_time;
-
-    double b = separation_encoder_wheel_;
-
-    // Book: Sigwart 2011 Autonompus Mobile Robots page:337
-    double sl = vl * ( diameter_encoder_wheel_ / 2.0 ) * seconds_since_last_update;
-    double sr = vr * ( diameter_encoder_wheel_ / 2.0 ) * seconds_since_last_update;
-    double theta = ( sl - sr ) /b;
-
-
-    double dx = ( sl + sr ) /2.0 * cos ( pose_encoder_.theta + ( sl - sr ) / ( 2.0*b ) );
-    double dy = ( sl + sr ) /2.0 * sin ( pose_encoder_.theta + ( sl - sr ) / ( 2.0*b ) );
-    double dtheta = ( sl - sr ) /b;
-
-    pose_encoder_.x += dx;
-    pose_encoder_.y += dy;
-    pose_encoder_.theta += dtheta;
-
-    double w = dtheta/seconds_since_last_update;
-    double v = sqrt ( dx*dx+dy*dy ) /seconds_since_last_update;
-
-    tf::Quaternion qt;
-    tf::Vector3 vt;
-    qt.setRPY ( 0,0,pose_encoder_.theta );
-    vt = tf::Vector3 ( pose_encoder_.x, pose_encoder_.y, 0 );
-
-    odom_.pose.pose.position.x = vt.x();
-    odom_.pose.pose.position.y = vt.y();
-    odom_.pose.pose.position.z = vt.z();
-
-    odom_.pose.pose.orientation.x = qt.x();
-    odom_.pose.pose.orientation.y = qt.y();
-    odom_.pose.pose.orientation.z = qt.z();
-    odom_.pose.pose.orientation.w = qt.w();
-
-    odom_.twist.twist.angular.z = w;
-    odom_.twist.twist.linear.x = dx/seconds_since_last_update;
-    odom_.twist.twist.linear.y = dy/seconds_since_last_update;
-}
-
-void GazeboRosTricycleDrive::publishOdometry ( double step_time )
-{
-
-    ros::Time current_time = ros::Time::now();
-    std::string odom_frame = gazebo_ros_->resolveTF ( odometry_frame_ );
-    std::string base_footprint_frame = gazebo_ros_->resolveTF ( robot_base_frame_ );
-
-    tf::Quaternion qt;
-    tf::Vector3 vt;
-
-    if ( odom_source_ == ENCODER ) {
-        // getting data form encoder integration
-        qt = tf::Quaternion ( odom_.pose.pose.orientation.x, odom_.pose.pose.orientation.y, odom_.pose.pose.orientation.z, odom_.pose.pose.orientation.w );
-        vt = tf::Vector3 ( odom_.pose.pose.position.x, odom_.pose.pose.position.y, odom_.pose.pose.position.z );
-
-    }
-    if ( odom_source_ == WORLD ) {
-        // getting data form gazebo world
-#if GAZEBO_MAJOR_VERSION >= 8
-        ignition::math::Pose3d pose = parent->WorldPose();
-#else
-        ignition::math::Pose3d pose = parent->GetWorldPose().Ign();
-#endif
-        qt = tf::Quaternion ( pose.Rot().X(), pose.Rot().Y(), pose.Rot().Z(), pose.Rot().W() );
-        vt = tf::Vector3 ( pose.Pos().X(), pose.Pos().Y(), pose.Pos().Z() );
-
-        odom_.pose.pose.position.x = vt.x();
-        odom_.pose.pose.position.y = vt.y();
-        odom_.pose.pose.position.z = vt.z();
-
-        odom_.pose.pose.orientation.x = qt.x();
-        odom_.pose.pose.orientation.y = qt.y();
-        odom_.pose.pose.orientation.z = qt.z();
-        odom_.pose.pose.orientation.w = qt.w();
-
-        // get velocity in /odom frame
-        ignition::math::Vector3d linear;
-#if GAZEBO_MAJOR_VERSION >= 8
-        linear = parent->WorldLinearVel();
-        odom_.twist.twist.angular.z = parent->WorldAngularVel().Z();
-#else
-        linear = parent->GetWorldLinearVel().Ign();
-        odom_.twist.twist.angular.z = parent->GetWorldAngularVel().Ign().Z();
-#endif
-
-        // convert velocity to child_frame_id (aka base_footprint)
-        float yaw = pose.Rot().Yaw();
-        odom_.twist.twist.linear.x = cosf ( yaw ) * linear.X() + sinf ( yaw ) * linear.Y();
-        odom_.twist.twist.linear.y = cosf ( yaw ) * linear.Y() - sinf ( yaw ) * linear.X();
-    }
-
-    tf::Transform base_footprint_to_odom ( qt, vt );
-    transform_broadcaster_->sendTransform (
-        tf::StampedTransform ( base_footprint_to_odom, current_time,
-                               odom_frame, base_footprint_frame ) );
-
-
-    // set covariance
-    odom_.pose.covariance[0] = 0.00001;
-    odom_.pose.covariance[7] = 0.00001;
-    odom_.pose.covariance[14] = 1000000000000.0;
-    odom_.pose.covariance[21] = 1000000000000.0;
-    odom_.pose.covariance[28] = 1000000000000.0;
-    odom_.pose.covariance[35] = 0.001;
-
-
-    // set header
-    odom_.header.stamp = current_time;
-    odom_.header.frame_id = odom_frame;
-    odom_.child_frame_id = base_footprint_frame;
-
-    odometry_publisher_.publish ( odom_ );
+    finiDrive ( *gazebo_ros_->node() );
 }
 
 GZ_REGISTER_MODEL_PLUGIN ( GazeboRosTricycleDrive )
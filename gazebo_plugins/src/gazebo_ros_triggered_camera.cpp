@@ -18,15 +18,18 @@
 #include "gazebo_plugins/gazebo_ros_triggered_camera.h"
 
 #include <float.h>
+#include <algorithm>
 #include <string>
+#include <vector>
 
 #include <gazebo/sensors/Sensor.hh>
 #include <gazebo/sensors/CameraSensor.hh>
 #include <gazebo/sensors/SensorTypes.hh>
 
-#ifdef ENABLE_PROFILER
-#include <ignition/common/Profiler.hh>
-#endif
+#include <ros/advertise_service_options.h>
+#include <gazebo_msgs/CameraTriggerStatus.h>
+
+#include <gazebo_ros/profiler.h>
 
 namespace gazebo
 {
@@ -37,6 +40,7 @@ GZ_REGISTER_SENSOR_PLUGIN(GazeboRosTriggeredCamera)
 ////////////////////////////////////////////////////////////////////////////////
 // Constructor
 GazeboRosTriggeredCamera::GazeboRosTriggeredCamera()
+  : trigger_timeout_(1.0)
 {
 }
 
@@ -44,11 +48,14 @@ GazeboRosTriggeredCamera::GazeboRosTriggeredCamera()
 // Destructor
 GazeboRosTriggeredCamera::~GazeboRosTriggeredCamera()
 {
+  this->update_connection_.reset();
+  this->load_connection_.reset();
   ROS_DEBUG_STREAM_NAMED("camera","Unloaded");
 }
 
 void GazeboRosTriggeredCamera::Load(sensors::SensorPtr _parent, sdf::ElementPtr _sdf)
 {
+  GAZEBO_ROS_STARTUP_PHASE("load");
   // Make sure the ROS node for Gazebo has already been initialized
   if (!ros::isInitialized())
   {
@@ -66,12 +73,15 @@ void GazeboRosTriggeredCamera::Load(sensors::SensorPtr _parent, sdf::ElementPtr
   this->format_ = this->format;
   this->camera_ = this->camera;
 
+  this->LoadTriggerQueue(_sdf);
   GazeboRosCameraUtils::Load(_parent, _sdf);
 
   this->SetCameraEnabled(false);
   this->preRenderConnection_ =
       event::Events::ConnectPreRender(
           std::bind(&GazeboRosTriggeredCamera::PreRender, this));
+  this->update_connection_ = event::Events::ConnectWorldUpdateBegin(
+      std::bind(&GazeboRosTriggeredCamera::OnWorldUpdateBegin, this));
 }
 
 void GazeboRosTriggeredCamera::Load(sensors::SensorPtr _parent,
@@ -79,12 +89,98 @@ void GazeboRosTriggeredCamera::Load(sensors::SensorPtr _parent,
   const std::string &_camera_name_suffix,
   double _hack_baseline)
 {
+  this->LoadTriggerQueue(_sdf);
   GazeboRosCameraUtils::Load(_parent, _sdf, _camera_name_suffix, _hack_baseline);
 
   this->SetCameraEnabled(false);
   this->preRenderConnection_ =
       event::Events::ConnectPreRender(
       std::bind(&GazeboRosTriggeredCamera::PreRender, this));
+  this->update_connection_ = event::Events::ConnectWorldUpdateBegin(
+      std::bind(&GazeboRosTriggeredCamera::OnWorldUpdateBegin, this));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void GazeboRosTriggeredCamera::LoadTriggerQueue(sdf::ElementPtr _sdf)
+{
+  // a multicamera hands a shared queue to its cameras
+  if (!this->trigger_queue_)
+    this->trigger_queue_.reset(new CameraTriggerQueue());
+  if (_sdf->HasElement("triggerQueueDepth"))
+    this->trigger_queue_->SetCapacity(
+        std::max(1, _sdf->Get<int>("triggerQueueDepth")));
+  if (_sdf->HasElement("triggerTimeout"))
+    this->trigger_timeout_ = _sdf->Get<double>("triggerTimeout");
+
+  // the trigger topic is subscribed by GazeboRosCameraUtils::LoadThread,
+  // which may run deferred, so the rest is advertised along with it
+  this->load_connection_ = this->OnLoad(
+      boost::bind(&GazeboRosTriggeredCamera::AdvertiseTriggerQueue, this));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void GazeboRosTriggeredCamera::AdvertiseTriggerQueue()
+{
+  ros::AdvertiseServiceOptions burst_aso =
+    ros::AdvertiseServiceOptions::create<gazebo_msgs::TriggerCameraBurst>(
+        this->trigger_topic_name_ + "_burst",
+        boost::bind(&GazeboRosTriggeredCamera::TriggerBurst, this, _1, _2),
+        ros::VoidPtr(), &this->camera_queue_);
+  this->burst_service_ = this->rosnode_->advertiseService(burst_aso);
+
+  this->status_publisher_ =
+    this->rosnode_->advertise<gazebo_msgs::CameraTriggerStatus>(
+        this->trigger_topic_name_ + "_status", 10);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool GazeboRosTriggeredCamera::TriggerBurst(
+    gazebo_msgs::TriggerCameraBurst::Request &_req,
+    gazebo_msgs::TriggerCameraBurst::Response &_res)
+{
+  std::vector<common::Time> times;
+  times.reserve(_req.stamps.size());
+  for (size_t i = 0; i < _req.stamps.size(); ++i)
+    times.push_back(common::Time(_req.stamps[i].sec, _req.stamps[i].nsec));
+
+  std::string error;
+  _res.success = this->trigger_queue_->PushBurst(times, !_req.best_effort,
+                                                 error);
+  _res.status_message = _res.success ? "queued" : error;
+  _res.queue_depth = this->trigger_queue_->Depth();
+  _res.missed = this->trigger_queue_->Missed();
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void GazeboRosTriggeredCamera::OnWorldUpdateBegin()
+{
+  const common::Time sim_time = this->SimTime();
+  {
+    // arm the sensor from the physics thread, the way RenderScheduler does,
+    // so the next render pass renders it whatever its update period
+    std::lock_guard<std::mutex> lock(this->mutex);
+    if (this->trigger_queue_->Due(sim_time))
+      this->SetCameraEnabled(true);
+  }
+
+  // only holds once a render pass is rendering the trigger
+  if (!this->trigger_queue_->WaitExact(sim_time, this->trigger_timeout_))
+  {
+    ROS_WARN_NAMED("camera", "Camera [%s] did not render a triggered frame "
+                   "within %f s, rendering it late",
+                   this->camera_name_.c_str(), this->trigger_timeout_);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+common::Time GazeboRosTriggeredCamera::SimTime() const
+{
+#if GAZEBO_MAJOR_VERSION >= 8
+  return this->world_->SimTime();
+#else
+  return this->world_->GetSimTime();
+#endif
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -93,35 +189,41 @@ void GazeboRosTriggeredCamera::OnNewFrame(const unsigned char *_image,
     unsigned int _width, unsigned int _height, unsigned int _depth,
     const std::string &_format)
 {
-#ifdef ENABLE_PROFILER
-  IGN_PROFILE("GazeboRosTriggeredCamera::OnNewFrame");
-#endif
+  GAZEBO_ROS_PROFILE("GazeboRosTriggeredCamera::OnNewFrame");
   this->sensor_update_time_ = this->parentSensor_->LastMeasurementTime();
 
   if ((*this->image_connect_count_) > 0)
   {
-#ifdef ENABLE_PROFILER
-    IGN_PROFILE_BEGIN("PutCameraData");
-#endif
+    GAZEBO_ROS_PROFILE_BEGIN("PutCameraData");
     this->PutCameraData(_image);
-#ifdef ENABLE_PROFILER
-    IGN_PROFILE_END();
-    IGN_PROFILE_BEGIN("PublishCameraInfo");
-#endif
+    GAZEBO_ROS_PROFILE_END();
+    GAZEBO_ROS_PROFILE_BEGIN("PublishCameraInfo");
     this->PublishCameraInfo();
-#ifdef ENABLE_PROFILER
-    IGN_PROFILE_END();
-#endif
+    GAZEBO_ROS_PROFILE_END();
   }
-#ifdef ENABLE_PROFILER
-  IGN_PROFILE_BEGIN("SetCameraEnabled");
-#endif
+  GAZEBO_ROS_PROFILE_BEGIN("SetCameraEnabled");
   this->SetCameraEnabled(false);
-#ifdef ENABLE_PROFILER
-  IGN_PROFILE_END();
-#endif
-  std::lock_guard<std::mutex> lock(this->mutex);
-  this->triggered = std::max(this->triggered-1, 0);
+  GAZEBO_ROS_PROFILE_END();
+
+  // the cameras of a multicamera get the same frame, only the first one
+  // reports it
+  common::Time requested;
+  if (!this->trigger_queue_->Rendered(this->sensor_update_time_, requested))
+    return;
+
+  uint64_t missed = this->trigger_queue_->Missed();
+  if (this->status_publisher_ && this->status_publisher_.getNumSubscribers() > 0)
+  {
+    gazebo_msgs::CameraTriggerStatus status;
+    status.header.stamp.sec = this->sensor_update_time_.sec;
+    status.header.stamp.nsec = this->sensor_update_time_.nsec;
+    status.header.frame_id = this->frame_name_;
+    status.requested.sec = requested.sec;
+    status.requested.nsec = requested.nsec;
+    status.queue_depth = this->trigger_queue_->Depth();
+    status.missed = missed;
+    this->status_publisher_.publish(status);
+  }
 }
 
 void GazeboRosTriggeredCamera::TriggerCamera()
@@ -129,7 +231,12 @@ void GazeboRosTriggeredCamera::TriggerCamera()
   std::lock_guard<std::mutex> lock(this->mutex);
   if (!this->parentSensor_)
     return;
-  this->triggered++;
+  // render at the next opportunity, without holding the physics
+  if (!this->trigger_queue_->Push(this->SimTime(), false))
+  {
+    ROS_WARN_THROTTLE_NAMED(1.0, "camera", "Trigger queue of camera [%s] is "
+                            "full, dropping trigger", this->camera_name_.c_str());
+  }
 }
 
 bool GazeboRosTriggeredCamera::CanTriggerCamera()
@@ -140,7 +247,7 @@ bool GazeboRosTriggeredCamera::CanTriggerCamera()
 void GazeboRosTriggeredCamera::PreRender()
 {
   std::lock_guard<std::mutex> lock(this->mutex);
-  if (this->triggered > 0)
+  if (this->trigger_queue_->Arm(this->SimTime()))
   {
     this->SetCameraEnabled(true);
   }
@@ -23,9 +23,7 @@
 
 #include "gazebo_plugins/gazebo_ros_triggered_multicamera.h"
 
-#ifdef ENABLE_PROFILER
-#include <ignition/common/Profiler.hh>
-#endif
+#include <gazebo_ros/profiler.h>
 
 namespace gazebo
 {
@@ -47,6 +45,7 @@ GazeboRosTriggeredMultiCamera::~GazeboRosTriggeredMultiCamera()
 void GazeboRosTriggeredMultiCamera::Load(sensors::SensorPtr _parent,
   sdf::ElementPtr _sdf)
 {
+  GAZEBO_ROS_STARTUP_PHASE("load");
   MultiCameraPlugin::Load(_parent, _sdf);
 
   // Make sure the ROS node for Gazebo has already been initialized
@@ -60,7 +59,10 @@ void GazeboRosTriggeredMultiCamera::Load(sensors::SensorPtr _parent,
   // initialize shared_ptr members
   this->image_connect_count_ = boost::shared_ptr<int>(new int(0));
   this->image_connect_count_lock_ = boost::shared_ptr<boost::mutex>(new boost::mutex);
+  this->sensor_connect_count_ = boost::shared_ptr<int>(new int(0));
   this->was_active_ = boost::shared_ptr<bool>(new bool(false));
+  // a trigger renders all cameras of the sensor
+  this->trigger_queue_.reset(new CameraTriggerQueue());
 
   // copying from CameraPlugin into GazeboRosCameraUtils
   for (unsigned i = 0; i < this->camera.size(); ++i)
@@ -75,7 +77,9 @@ void GazeboRosTriggeredMultiCamera::Load(sensors::SensorPtr _parent,
     // Set up a shared connection counter
     cam->image_connect_count_ = this->image_connect_count_;
     cam->image_connect_count_lock_ = this->image_connect_count_lock_;
+    cam->sensor_connect_count_ = this->sensor_connect_count_;
     cam->was_active_ = this->was_active_;
+    cam->trigger_queue_ = this->trigger_queue_;
     if (this->camera[i]->Name().find("left") != std::string::npos)
     {
       // FIXME: hardcoded, left hack_baseline_ 0
@@ -98,17 +102,11 @@ void GazeboRosTriggeredMultiCamera::OnNewFrameLeft(const unsigned char *_image,
     unsigned int _width, unsigned int _height, unsigned int _depth,
     const std::string &_format)
 {
-#ifdef ENABLE_PROFILER
-  IGN_PROFILE("GazeboRosTriggeredMultiCamera::OnNewFrameLeft");
-#endif
+  GAZEBO_ROS_PROFILE("GazeboRosTriggeredMultiCamera::OnNewFrameLeft");
   GazeboRosTriggeredCamera * cam = this->triggered_cameras[0];
-#ifdef ENABLE_PROFILER
-  IGN_PROFILE_BEGIN("OnNewFrame");
-#endif
+  GAZEBO_ROS_PROFILE_BEGIN("OnNewFrame");
   cam->OnNewFrame(_image, _width, _height, _depth, _format);
-#ifdef ENABLE_PROFILER
-  IGN_PROFILE_END();
-#endif
+  GAZEBO_ROS_PROFILE_END();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -117,16 +115,10 @@ void GazeboRosTriggeredMultiCamera::OnNewFrameRight(const unsigned char *_image,
     unsigned int _width, unsigned int _height, unsigned int _depth,
     const std::string &_format)
 {
-#ifdef ENABLE_PROFILER
-  IGN_PROFILE("GazeboRosTriggeredMultiCamera::OnNewFrameRight");
-#endif
+  GAZEBO_ROS_PROFILE("GazeboRosTriggeredMultiCamera::OnNewFrameRight");
   GazeboRosTriggeredCamera * cam = this->triggered_cameras[1];
-#ifdef ENABLE_PROFILER
-  IGN_PROFILE_BEGIN("OnNewFrame");
-#endif
+  GAZEBO_ROS_PROFILE_BEGIN("OnNewFrame");
   cam->OnNewFrame(_image, _width, _height, _depth, _format);
-#ifdef ENABLE_PROFILER
-  IGN_PROFILE_END();
-#endif
+  GAZEBO_ROS_PROFILE_END();
 }
 }
@@ -37,8 +37,37 @@
 #include <sdf/sdf.hh>
 #include <tf/transform_listener.h>
 
+#if GAZEBO_ROS_IGN_PROFILER
+#include <ignition/common/Profiler.hh>
+#endif
+
 using namespace gazebo;
 
+#if GAZEBO_ROS_IGN_PROFILER
+namespace
+{
+void ignitionBeginSample(const char *name)
+{
+  ignition::common::Profiler::Instance()->BeginSample(name);
+}
+
+void ignitionEndSample()
+{
+  ignition::common::Profiler::Instance()->EndSample();
+}
+
+/// \brief Forward the samples of the ROS plugins to the Ignition profiler
+/// once any plugin using gazebo_ros_utils is loaded
+struct IgnitionProfilerSink
+{
+  IgnitionProfilerSink()
+  {
+    Profiler::instance().setSink(&ignitionBeginSample, &ignitionEndSample);
+  }
+} ignition_profiler_sink;
+}
+#endif
+
 const char* GazeboRos::info() const {
     return info_text.c_str();
 }
@@ -145,3 +174,21 @@ void GazeboRos::isInitialized() {
         return;
     }
 }
+
+SubscriptionHints gazebo::GetSubscriptionHints(const ros::NodeHandle &_node, const sdf::ElementPtr &_sdf) {
+    SubscriptionHints hints;
+    hints.readParam(_node);
+    if (!_sdf || !_sdf->HasElement("transportHints"))
+        return hints;
+
+    sdf::ElementPtr elem = _sdf->GetElement("transportHints");
+    if (elem->HasElement("tcpNoDelay"))
+        hints.tcp_no_delay = elem->Get<bool>("tcpNoDelay");
+    if (elem->HasElement("udp"))
+        hints.udp = elem->Get<bool>("udp");
+    if (elem->HasElement("maxDatagramSize"))
+        hints.max_datagram_size = elem->Get<int>("maxDatagramSize");
+    if (elem->HasElement("queueSize"))
+        hints.queue_size = elem->Get<int>("queueSize");
+    return hints;
+}
@@ -26,9 +26,8 @@
 
 #include <std_msgs/Bool.h>
 #include <gazebo_plugins/gazebo_ros_vacuum_gripper.h>
-#ifdef ENABLE_PROFILER
-#include <ignition/common/Profiler.hh>
-#endif
+#include <gazebo_plugins/gazebo_ros_utils.h>
+#include <gazebo_ros/profiler.h>
 
 namespace gazebo
 {
@@ -40,6 +39,11 @@ GazeboRosVacuumGripper::GazeboRosVacuumGripper()
 {
   connect_count_ = 0;
   status_ = false;
+  search_model_count_ = 0;
+  search_valid_ = false;
+  search_skin_ = 0.5;
+  search_period_ = 0.1;
+  grasped_count_ = 0;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -52,7 +56,7 @@ GazeboRosVacuumGripper::~GazeboRosVacuumGripper()
   queue_.clear();
   queue_.disable();
   rosnode_->shutdown();
-  callback_queue_thread_.join();
+  queue_.Stop();
 
   delete rosnode_;
 }
@@ -61,6 +65,7 @@ GazeboRosVacuumGripper::~GazeboRosVacuumGripper()
 // Load the controller
 void GazeboRosVacuumGripper::Load(physics::ModelPtr _model, sdf::ElementPtr _sdf)
 {
+  GAZEBO_ROS_STARTUP_PHASE("load");
   ROS_INFO_NAMED("vacuum_gripper", "Loading gazebo_ros_vacuum_gripper");
 
   // Set attached model;
@@ -104,6 +109,11 @@ void GazeboRosVacuumGripper::Load(physics::ModelPtr _model, sdf::ElementPtr _sdf
   else
     topic_name_ = _sdf->GetElement("topicName")->Get<std::string>();
 
+  if (_sdf->HasElement("searchSkin"))
+    search_skin_ = std::max(0.0, _sdf->Get<double>("searchSkin"));
+  if (_sdf->HasElement("searchPeriod"))
+    search_period_ = _sdf->Get<double>("searchPeriod");
+
   // Make sure the ROS node for Gazebo has already been initialized
   if (!ros::isInitialized())
   {
@@ -134,9 +144,6 @@ void GazeboRosVacuumGripper::Load(physics::ModelPtr _model, sdf::ElementPtr _sdf
     this, _1, _2), ros::VoidPtr(), &queue_);
   srv2_ = rosnode_->advertiseService(aso2);
 
-  // Custom Callback Queue
-  callback_queue_thread_ = boost::thread( boost::bind( &GazeboRosVacuumGripper::QueueThread,this ) );
-
   // New Mechanism for Updating every World Cycle
   // Listen to the update event. This event is broadcast every
   // simulation iteration.
@@ -162,6 +169,7 @@ bool GazeboRosVacuumGripper::OffServiceCallback(std_srvs::Empty::Request &req,
 {
   if (status_) {
     status_ = false;
+    search_valid_ = false;
     ROS_INFO_NAMED("vacuum_gripper", "gazebo_ros_vacuum_gripper: status: on -> off");
   } else {
     ROS_WARN_NAMED("vacuum_gripper", "gazebo_ros_vacuum_gripper: already status is 'off'");
@@ -173,94 +181,113 @@ bool GazeboRosVacuumGripper::OffServiceCallback(std_srvs::Empty::Request &req,
 // Update the controller
 void GazeboRosVacuumGripper::UpdateChild()
 {
-#ifdef ENABLE_PROFILER
-  IGN_PROFILE("GazeboRosVacuumGripper::UpdateChild");
-#endif
+  GAZEBO_ROS_PROFILE("GazeboRosVacuumGripper::UpdateChild");
   std_msgs::Bool grasping_msg;
   grasping_msg.data = false;
   if (!status_) {
-#ifdef ENABLE_PROFILER
-    IGN_PROFILE_BEGIN("publish status");
-#endif
+    GAZEBO_ROS_PROFILE_BEGIN("publish status");
     pub_.publish(grasping_msg);
-#ifdef ENABLE_PROFILER
-    IGN_PROFILE_END();
-#endif
+    GAZEBO_ROS_PROFILE_END();
     return;
   }
   // apply force
   lock_.lock();
-#ifdef ENABLE_PROFILER
-  IGN_PROFILE_BEGIN("apply force");
-#endif
+  GAZEBO_ROS_PROFILE_BEGIN("apply force");
 #if GAZEBO_MAJOR_VERSION >= 8
   ignition::math::Pose3d parent_pose = link_->WorldPose();
-  physics::Model_V models = world_->Models();
+  common::Time cur_time = world_->SimTime();
+  unsigned int model_count = world_->ModelCount();
 #else
   ignition::math::Pose3d parent_pose = link_->GetWorldPose().Ign();
-  physics::Model_V models = world_->GetModels();
+  common::Time cur_time = world_->GetSimTime();
+  unsigned int model_count = world_->GetModelCount();
 #endif
-  for (size_t i = 0; i < models.size(); i++) {
-    if (models[i]->GetName() == link_->GetName() ||
-        models[i]->GetName() == parent_->GetName())
-    {
-      continue;
-    }
-    physics::Link_V links = models[i]->GetLinks();
-    for (size_t j = 0; j < links.size(); j++) {
+
+  // refresh the candidate links if they may be stale
+  if (!search_valid_ || model_count != search_model_count_ ||
+      cur_time < search_time_ ||
+      (parent_pose.Pos() - search_origin_).Length() > 0.5 * search_skin_ ||
+      (grasped_count_ == 0 &&
+       (cur_time - search_time_).Double() >= search_period_))
+  {
+    SearchCandidates(parent_pose.Pos(), cur_time);
+  }
+
+  grasped_count_ = 0;
+  for (size_t j = 0; j < candidates_.size(); j++) {
 #if GAZEBO_MAJOR_VERSION >= 8
-      ignition::math::Pose3d link_pose = links[j]->WorldPose();
+    ignition::math::Pose3d link_pose = candidates_[j]->WorldPose();
 #else
-      ignition::math::Pose3d link_pose = links[j]->GetWorldPose().Ign();
+    ignition::math::Pose3d link_pose = candidates_[j]->GetWorldPose().Ign();
 #endif
-      ignition::math::Pose3d diff = parent_pose - link_pose;
-      double norm = diff.Pos().Length();
-      if (norm < 0.05) {
+    ignition::math::Pose3d diff = parent_pose - link_pose;
+    double norm = diff.Pos().Length();
+    if (norm < 0.05) {
 #if GAZEBO_MAJOR_VERSION >= 8
-        links[j]->SetLinearVel(link_->WorldLinearVel());
-        links[j]->SetAngularVel(link_->WorldAngularVel());
+      candidates_[j]->SetLinearVel(link_->WorldLinearVel());
+      candidates_[j]->SetAngularVel(link_->WorldAngularVel());
 #else
-        links[j]->SetLinearVel(link_->GetWorldLinearVel());
-        links[j]->SetAngularVel(link_->GetWorldAngularVel());
+      candidates_[j]->SetLinearVel(link_->GetWorldLinearVel());
+      candidates_[j]->SetAngularVel(link_->GetWorldAngularVel());
 #endif
-        double norm_force = 1 / norm;
-        if (norm < 0.01) {
-          // apply friction like force
-          // TODO(unknown): should apply friction actually
-          link_pose.Set(parent_pose.Pos(), link_pose.Rot());
-          links[j]->SetWorldPose(link_pose);
-        }
-        if (norm_force > 20) {
-          norm_force = 20;  // max_force
-        }
-        ignition::math::Vector3d force = norm_force * diff.Pos().Normalize();
-        links[j]->AddForce(force);
-        grasping_msg.data = true;
+      double norm_force = 1 / norm;
+      if (norm < 0.01) {
+        // apply friction like force
+        // TODO(unknown): should apply friction actually
+        link_pose.Set(parent_pose.Pos(), link_pose.Rot());
+        candidates_[j]->SetWorldPose(link_pose);
+      }
+      if (norm_force > 20) {
+        norm_force = 20;  // max_force
       }
+      ignition::math::Vector3d force = norm_force * diff.Pos().Normalize();
+      candidates_[j]->AddForce(force);
+      grasping_msg.data = true;
+      grasped_count_++;
     }
   }
-#ifdef ENABLE_PROFILER
-  IGN_PROFILE_END();
-  IGN_PROFILE_BEGIN("publish grasping_msg");
-#endif
+  GAZEBO_ROS_PROFILE_END();
+  GAZEBO_ROS_PROFILE_BEGIN("publish grasping_msg");
   pub_.publish(grasping_msg);
-#ifdef ENABLE_PROFILER
-  IGN_PROFILE_END();
-#endif
+  GAZEBO_ROS_PROFILE_END();
   lock_.unlock();
 }
 
-// Custom Callback Queue
+
 ////////////////////////////////////////////////////////////////////////////////
-// custom callback queue thread
-void GazeboRosVacuumGripper::QueueThread()
+// Find the links of the other models near the power point
+void GazeboRosVacuumGripper::SearchCandidates(
+    const ignition::math::Vector3d &_origin, const common::Time &_time)
 {
-  static const double timeout = 0.01;
-
-  while (rosnode_->ok())
-  {
-    queue_.callAvailable(ros::WallDuration(timeout));
+  GAZEBO_ROS_PROFILE("GazeboRosVacuumGripper::SearchCandidates");
+  const double radius = 0.05 + search_skin_;
+  candidates_.clear();
+#if GAZEBO_MAJOR_VERSION >= 8
+  physics::Model_V models = world_->Models();
+#else
+  physics::Model_V models = world_->GetModels();
+#endif
+  for (size_t i = 0; i < models.size(); i++) {
+    if (models[i]->GetName() == link_->GetName() ||
+        models[i]->GetName() == parent_->GetName())
+    {
+      continue;
+    }
+    const physics::Link_V &links = models[i]->GetLinks();
+    for (size_t j = 0; j < links.size(); j++) {
+#if GAZEBO_MAJOR_VERSION >= 8
+      ignition::math::Vector3d link_pos = links[j]->WorldPose().Pos();
+#else
+      ignition::math::Vector3d link_pos = links[j]->GetWorldPose().Ign().Pos();
+#endif
+      if ((_origin - link_pos).Length() < radius)
+        candidates_.push_back(links[j]);
+    }
   }
+  search_origin_ = _origin;
+  search_time_ = _time;
+  search_model_count_ = models.size();
+  search_valid_ = true;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -21,11 +21,14 @@
  * Date: 26 July 2013
  */
 
+#include <algorithm>
+
 #include <boost/lexical_cast.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+#include <sensor_msgs/image_encodings.h>
 #include <gazebo_plugins/gazebo_ros_video.h>
-#ifdef ENABLE_PROFILER
-#include <ignition/common/Profiler.hh>
-#endif
+#include <gazebo_plugins/gazebo_ros_utils.h>
+#include <gazebo_ros/profiler.h>
 
 namespace gazebo
 {
@@ -92,29 +95,23 @@ namespace gazebo
     // Fix image size if necessary
     const cv::Mat* image_ptr = &image;
     cv::Mat converted_image;
-    if (image_ptr->rows != height_ || image_ptr->cols != width_)
+    if (image_ptr->rows != height_ || image_ptr->cols != width_ ||
+        !image_ptr->isContinuous())
     {
       cv::resize(*image_ptr, converted_image, cv::Size(width_, height_));
       image_ptr = &converted_image;
     }
 
-    // Get the pixel buffer
-    Ogre::HardwarePixelBufferSharedPtr pixelBuffer =
-      texture_->getBuffer();
-
-    // Lock the pixel buffer and get a pixel box
-    pixelBuffer->lock(Ogre::HardwareBuffer::HBL_DISCARD);
-    const Ogre::PixelBox& pixelBox = pixelBuffer->getCurrentLock();
-    uint8_t* pDest = static_cast<uint8_t*>(pixelBox.data);
-
-    memcpy(pDest, image_ptr->data, height_ * width_ * 4);
-
-    // Unlock the pixel buffer
-    pixelBuffer->unlock();
+    // Upload straight from the image, without staging it in a locked
+    // pixel buffer first
+    Ogre::PixelBox pixelBox(width_, height_, 1, Ogre::PF_BYTE_BGRA,
+        image_ptr->data);
+    texture_->getBuffer()->blitFromMemory(pixelBox);
   }
 
   // Constructor
-  GazeboRosVideo::GazeboRosVideo() {}
+  GazeboRosVideo::GazeboRosVideo() :
+      new_image_available_(false), height_(240), width_(320) {}
 
   // Destructor
   GazeboRosVideo::~GazeboRosVideo() {
@@ -124,7 +121,7 @@ namespace gazebo
     queue_.clear();
     queue_.disable();
     rosnode_->shutdown();
-    callback_queue_thread_.join();
+    queue_.Stop();
 
     delete rosnode_;
   }
@@ -133,6 +130,7 @@ namespace gazebo
   void GazeboRosVideo::Load(
       rendering::VisualPtr parent, sdf::ElementPtr sdf)
   {
+    GAZEBO_ROS_STARTUP_PHASE("load");
 
     model_ = parent;
     sdf::ElementPtr p_sdf;
@@ -188,6 +186,9 @@ namespace gazebo
       width = p_sdf->GetElement("width")->Get<int>();
     }
 
+    height_ = height;
+    width_ = width;
+
     std::string name = robot_namespace_ + "_visual";
     video_visual_.reset(
         new VideoVisual(name, parent, height, width));
@@ -209,13 +210,11 @@ namespace gazebo
       ros::SubscribeOptions::create<sensor_msgs::Image>(topic_name_, 1,
           boost::bind(&GazeboRosVideo::processImage, this, _1),
           ros::VoidPtr(), &queue_);
+    GetSubscriptionHints(*rosnode_, p_sdf).apply(so);
     camera_subscriber_ = rosnode_->subscribe(so);
 
     new_image_available_ = false;
 
-    callback_queue_thread_ =
-      boost::thread(boost::bind(&GazeboRosVideo::QueueThread, this));
-
     update_connection_ =
       event::Events::ConnectPreRender(
           boost::bind(&GazeboRosVideo::UpdateChild, this));
@@ -227,40 +226,77 @@ namespace gazebo
   // Update the controller
   void GazeboRosVideo::UpdateChild()
   {
-#ifdef ENABLE_PROFILER
-    IGN_PROFILE("GazeboRosVideo::UpdateChild");
-#endif
-    boost::mutex::scoped_lock scoped_lock(m_image_);
-    if (new_image_available_)
+    GAZEBO_ROS_PROFILE("GazeboRosVideo::UpdateChild");
     {
-#ifdef ENABLE_PROFILER
-      IGN_PROFILE_BEGIN("render");
-#endif
-      video_visual_->render(image_->image);
-#ifdef ENABLE_PROFILER
-      IGN_PROFILE_END();
-#endif
+      // take the latest frame, skip if it was shown already
+      boost::mutex::scoped_lock scoped_lock(m_image_);
+      if (!new_image_available_)
+        return;
+      std::swap(ready_image_, render_image_);
+      new_image_available_ = false;
     }
-    new_image_available_ = false;
+    GAZEBO_ROS_PROFILE_BEGIN("render");
+    video_visual_->render(render_image_);
+    GAZEBO_ROS_PROFILE_END();
   }
 
   void GazeboRosVideo::processImage(const sensor_msgs::ImageConstPtr &msg)
   {
-    // Get a reference to the image from the image message pointer
+    // drop repeated frames
+    if (!last_stamp_.isZero() && msg->header.stamp == last_stamp_)
+      return;
+    last_stamp_ = msg->header.stamp;
+
+    try
+    {
+      convertImage(msg, converted_image_);
+    }
+    catch (cv_bridge::Exception &e)
+    {
+      ROS_ERROR_NAMED("video", "GazeboRosVideo: cannot convert image: %s", e.what());
+      return;
+    }
+
+    // hand the frame to the render thread
     boost::mutex::scoped_lock scoped_lock(m_image_);
-    // We get image with alpha channel as it allows memcpy onto ogre texture
-    image_ = cv_bridge::toCvCopy(msg, "bgra8");
+    std::swap(converted_image_, ready_image_);
     new_image_available_ = true;
   }
 
-  void GazeboRosVideo::QueueThread()
+  void GazeboRosVideo::convertImage(const sensor_msgs::ImageConstPtr &msg,
+      cv::Mat &_image)
   {
-    static const double timeout = 0.01;
-    while (rosnode_->ok())
-    {
-      queue_.callAvailable(ros::WallDuration(timeout));
-    }
+    namespace enc = sensor_msgs::image_encodings;
+
+    // We get image with alpha channel as it allows direct upload onto the
+    // ogre texture. The common encodings are converted into reused buffers.
+    cv_bridge::CvImageConstPtr cv_image = cv_bridge::toCvShare(msg);
+    const bool resize = msg->height != static_cast<unsigned int>(height_) ||
+                        msg->width != static_cast<unsigned int>(width_);
+    cv::Mat &converted = resize ? bgra_image_ : _image;
+    cv::Mat bgra;
+    if (msg->encoding == enc::BGRA8)
+      bgra = cv_image->image;
+    else if (msg->encoding == enc::BGR8)
+      cv::cvtColor(cv_image->image, converted, cv::COLOR_BGR2BGRA);
+    else if (msg->encoding == enc::RGB8)
+      cv::cvtColor(cv_image->image, converted, cv::COLOR_RGB2BGRA);
+    else if (msg->encoding == enc::RGBA8)
+      cv::cvtColor(cv_image->image, converted, cv::COLOR_RGBA2BGRA);
+    else if (msg->encoding == enc::MONO8)
+      cv::cvtColor(cv_image->image, converted, cv::COLOR_GRAY2BGRA);
+    else
+      bgra = cv_bridge::toCvShare(msg, "bgra8")->image;
+    if (bgra.empty())
+      bgra = converted;
+
+    if (resize)
+      cv::resize(bgra, _image, cv::Size(width_, height_));
+    else if (bgra.data != _image.data)
+      // the image still points into the message, copy it out
+      bgra.copyTo(_image);
   }
 
+
   GZ_REGISTER_VISUAL_PLUGIN(GazeboRosVideo);
 }
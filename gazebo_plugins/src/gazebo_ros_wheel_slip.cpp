@@ -14,11 +14,21 @@
  * limitations under the License.
  *
 */
+#include <algorithm>
+#include <map>
+
+#include <gazebo/physics/Collision.hh>
+#include <gazebo/physics/Contact.hh>
+#include <gazebo/physics/ContactManager.hh>
+#include <gazebo/physics/Link.hh>
+#include <gazebo/physics/PhysicsEngine.hh>
 #include <gazebo/physics/World.hh>
 #include <gazebo/physics/Model.hh>
 #include <sdf/sdf.hh>
 
 #include "gazebo_plugins/gazebo_ros_wheel_slip.h"
+#include <gazebo_plugins/gazebo_ros_utils.h>
+#include <gazebo_ros/profiler.h>
 
 namespace gazebo
 {
@@ -28,15 +38,24 @@ GZ_REGISTER_MODEL_PLUGIN(GazeboRosWheelSlip)
 
 /////////////////////////////////////////////////
 GazeboRosWheelSlip::GazeboRosWheelSlip()
+  : requested_(false), contact_connect_count_(0), contact_update_period_(0),
+    rosnode_(NULL), dyn_srv_(NULL)
 {
 }
 
 /////////////////////////////////////////////////
 GazeboRosWheelSlip::~GazeboRosWheelSlip()
 {
+  if (!this->contact_filter_.empty())
+  {
+    this->GetParentModel()->GetWorld()->Physics()->GetContactManager()
+      ->RemoveFilter(this->contact_filter_);
+  }
+
   // Custom Callback Queue
   this->queue_.clear();
   this->queue_.disable();
+  this->queue_.Stop();
 
   delete this->dyn_srv_;
 
@@ -48,29 +67,127 @@ GazeboRosWheelSlip::~GazeboRosWheelSlip()
 void GazeboRosWheelSlip::configCallback(
   gazebo_plugins::WheelSlipConfig &config, uint32_t /*level*/)
 {
+  boost::mutex::scoped_lock lock(this->lock_);
   if (config.slip_compliance_unitless_lateral >= 0)
   {
     ROS_INFO_NAMED("wheel_slip", "Reconfigure request for the gazebo ros wheel_slip: %s. New lateral slip compliance: %.3e",
              this->GetParentModel()->GetScopedName().c_str(),
              config.slip_compliance_unitless_lateral);
-    this->SetSlipComplianceLateral(config.slip_compliance_unitless_lateral);
+    this->requested_lateral_.assign(this->wheel_names_.size(),
+      config.slip_compliance_unitless_lateral);
+    this->requested_ = true;
   }
   if (config.slip_compliance_unitless_longitudinal >= 0)
   {
     ROS_INFO_NAMED("wheel_slip", "Reconfigure request for the gazebo ros wheel_slip: %s. New longitudinal slip compliance: %.3e",
              this->GetParentModel()->GetScopedName().c_str(),
              config.slip_compliance_unitless_longitudinal);
-    this->SetSlipComplianceLongitudinal(config.slip_compliance_unitless_longitudinal);
+    this->requested_longitudinal_.assign(this->wheel_names_.size(),
+      config.slip_compliance_unitless_longitudinal);
+    this->requested_ = true;
   }
 }
 
+/////////////////////////////////////////////////
+// Set the compliance of some wheels, without logging as it streams
+void GazeboRosWheelSlip::OnCompliance(
+  const gazebo_msgs::WheelSlipCompliance::ConstPtr &_msg)
+{
+  const size_t n = _msg->wheel_name.empty() ?
+    this->wheel_names_.size() : _msg->wheel_name.size();
+  if ((!_msg->lateral.empty() && _msg->lateral.size() != n) ||
+      (!_msg->longitudinal.empty() && _msg->longitudinal.size() != n))
+  {
+    ROS_WARN_THROTTLE_NAMED(1.0, "wheel_slip", "gazebo ros wheel_slip %s ignores a compliance message for %lu wheels with %lu lateral and %lu longitudinal values",
+      this->GetParentModel()->GetScopedName().c_str(),
+      static_cast<unsigned long>(n),
+      static_cast<unsigned long>(_msg->lateral.size()),
+      static_cast<unsigned long>(_msg->longitudinal.size()));
+    return;
+  }
+
+  boost::mutex::scoped_lock lock(this->lock_);
+  for (size_t k = 0; k < n; ++k)
+  {
+    size_t i = k;
+    if (!_msg->wheel_name.empty())
+    {
+      i = std::find(this->wheel_names_.begin(), this->wheel_names_.end(),
+        _msg->wheel_name[k]) - this->wheel_names_.begin();
+      if (i == this->wheel_names_.size())
+      {
+        ROS_WARN_THROTTLE_NAMED(1.0, "wheel_slip", "gazebo ros wheel_slip %s has no wheel [%s]",
+          this->GetParentModel()->GetScopedName().c_str(),
+          _msg->wheel_name[k].c_str());
+        continue;
+      }
+    }
+    if (!_msg->lateral.empty() && _msg->lateral[k] >= 0)
+      this->requested_lateral_[i] = _msg->lateral[k];
+    if (!_msg->longitudinal.empty() && _msg->longitudinal[k] >= 0)
+      this->requested_longitudinal_[i] = _msg->longitudinal[k];
+  }
+  this->requested_ = true;
+}
+
 /////////////////////////////////////////////////
 // Load the controller
 void GazeboRosWheelSlip::Load(physics::ModelPtr _parent, sdf::ElementPtr _sdf)
 {
+  GAZEBO_ROS_STARTUP_PHASE("load");
   // Load the plugin
   WheelSlipPlugin::Load(_parent, _sdf);
 
+  // the wheels as WheelSlipPlugin reads them, with their own compliance
+  if (_sdf->HasElement("wheel"))
+  {
+    for (sdf::ElementPtr wheel = _sdf->GetElement("wheel"); wheel;
+         wheel = wheel->GetNextElement("wheel"))
+    {
+      std::string name = wheel->Get<std::string>("link_name");
+      physics::LinkPtr link = _parent->GetLink(name);
+      if (!link || link->GetCollisions().size() != 1)
+        continue;
+
+      physics::CollisionPtr collision = link->GetCollisions()[0];
+      this->wheel_names_.push_back(name);
+      this->collisions_.push_back(collision.get());
+      this->collision_names_.push_back(collision->GetScopedName());
+      this->surfaces_.push_back(
+        boost::dynamic_pointer_cast<physics::ODESurfaceParams>(
+          collision->GetSurface()).get());
+      this->lateral_.push_back(wheel->HasElement("slip_compliance_lateral") ?
+        wheel->Get<double>("slip_compliance_lateral") : 0.0);
+      this->longitudinal_.push_back(wheel->HasElement("slip_compliance_longitudinal") ?
+        wheel->Get<double>("slip_compliance_longitudinal") : 0.0);
+    }
+  }
+  this->requested_lateral_ = this->lateral_;
+  this->requested_longitudinal_ = this->longitudinal_;
+
+  // slip is linear in the compliance, Update() scales it per wheel
+  this->SetSlipComplianceLateral(1.0);
+  this->SetSlipComplianceLongitudinal(1.0);
+
+  std::string compliance_topic = "slip_compliance";
+  if (_sdf->HasElement("complianceTopic"))
+    compliance_topic = _sdf->Get<std::string>("complianceTopic");
+
+  std::string contact_topic = "wheel_contacts";
+  if (_sdf->HasElement("contactTopic"))
+    contact_topic = _sdf->Get<std::string>("contactTopic");
+
+  double contact_update_rate = 50.0;
+  if (_sdf->HasElement("contactUpdateRate"))
+    contact_update_rate = _sdf->Get<double>("contactUpdateRate");
+  if (contact_update_rate > 0.0)
+    this->contact_update_period_ = 1.0 / contact_update_rate;
+
+  this->contact_msg_.wheel_name = this->wheel_names_;
+  this->contact_msg_.surface.resize(this->wheel_names_.size());
+  this->contact_msg_.lateral_slip.resize(this->wheel_names_.size());
+  this->contact_msg_.longitudinal_slip.resize(this->wheel_names_.size());
+
   if (_sdf->HasElement("robotNamespace"))
   {
     this->robotNamespace_ = _sdf->Get<std::string>("robotNamespace") + "/";
@@ -103,19 +220,135 @@ void GazeboRosWheelSlip::Load(physics::ModelPtr _parent, sdf::ElementPtr _sdf)
     boost::bind(&GazeboRosWheelSlip::configCallback, this, _1, _2);
   dyn_srv_->setCallback(f);
 
-  // Custom Callback Queue
-  this->callbackQueueThread_ =
-    boost::thread(boost::bind(&GazeboRosWheelSlip::QueueThread, this));
+  this->rosnode_->setParam("wheels", this->wheel_names_);
+
+  ros::SubscribeOptions so =
+    ros::SubscribeOptions::create<gazebo_msgs::WheelSlipCompliance>(
+      compliance_topic, 1,
+      boost::bind(&GazeboRosWheelSlip::OnCompliance, this, _1),
+      ros::VoidPtr(), &this->queue_);
+  GetSubscriptionHints(*this->rosnode_, _sdf).apply(so);
+  this->compliance_sub_ = this->rosnode_->subscribe(so);
+
+  ros::AdvertiseOptions ao =
+    ros::AdvertiseOptions::create<gazebo_msgs::WheelContacts>(
+      contact_topic, 1,
+      boost::bind(&GazeboRosWheelSlip::ContactConnect, this),
+      boost::bind(&GazeboRosWheelSlip::ContactDisconnect, this),
+      ros::VoidPtr(), &this->queue_);
+  this->contact_pub_ = this->rosnode_->advertise(ao);
 }
 
 /////////////////////////////////////////////////
-void GazeboRosWheelSlip::QueueThread()
+// Apply the compliance of each wheel
+void GazeboRosWheelSlip::Update()
 {
-  static const double timeout = 0.01;
+  GAZEBO_ROS_PROFILE("GazeboRosWheelSlip::Update");
+  bool contacts_wanted;
+  {
+    boost::mutex::scoped_lock lock(this->lock_);
+    if (this->requested_)
+    {
+      this->lateral_ = this->requested_lateral_;
+      this->longitudinal_ = this->requested_longitudinal_;
+      this->requested_ = false;
+    }
+    contacts_wanted = this->contact_connect_count_ > 0;
+  }
+
+  // sets slip1 and slip2 of each surface for a compliance of 1
+  WheelSlipPlugin::Update();
 
-  while (this->rosnode_->ok())
+  for (size_t i = 0; i < this->surfaces_.size(); ++i)
   {
-    this->queue_.callAvailable(ros::WallDuration(timeout));
+    if (!this->surfaces_[i])
+      continue;
+    this->surfaces_[i]->slip1 *= this->lateral_[i];
+    this->surfaces_[i]->slip2 *= this->longitudinal_[i];
   }
+
+  physics::WorldPtr world = this->GetParentModel()->GetWorld();
+  physics::ContactManager *contact_manager =
+    world->Physics()->GetContactManager();
+
+  // contacts of the wheels are only generated while there is a filter
+  if (contacts_wanted && this->contact_filter_.empty())
+  {
+    this->contact_filter_ = this->GetParentModel()->GetScopedName() + "/wheel_slip";
+    contact_manager->CreateFilter(this->contact_filter_, this->collision_names_);
+  }
+  else if (!contacts_wanted && !this->contact_filter_.empty())
+  {
+    contact_manager->RemoveFilter(this->contact_filter_);
+    this->contact_filter_.clear();
+  }
+  if (!contacts_wanted)
+    return;
+
+  common::Time cur_time = world->SimTime();
+  if (this->contact_update_period_ > 0 &&
+      (cur_time - this->last_contact_time_).Double() < this->contact_update_period_)
+    return;
+  this->last_contact_time_ = cur_time;
+  this->PublishContacts(cur_time);
 }
+
+/////////////////////////////////////////////////
+// Publish what each wheel touches, from the contacts of the last step
+void GazeboRosWheelSlip::PublishContacts(const common::Time &_time)
+{
+  physics::ContactManager *contact_manager =
+    this->GetParentModel()->GetWorld()->Physics()->GetContactManager();
+
+  for (size_t i = 0; i < this->wheel_names_.size(); ++i)
+    this->contact_msg_.surface[i].clear();
+
+  // one pass over the contacts for all wheels
+  const std::vector<physics::Contact *> &contacts = contact_manager->GetContacts();
+  const unsigned int count = contact_manager->GetContactCount();
+  for (unsigned int c = 0; c < count; ++c)
+  {
+    const physics::Contact *contact = contacts[c];
+    for (size_t i = 0; i < this->collisions_.size(); ++i)
+    {
+      if (contact->collision1 == this->collisions_[i])
+        this->contact_msg_.surface[i] = contact->collision2->GetScopedName();
+      else if (contact->collision2 == this->collisions_[i])
+        this->contact_msg_.surface[i] = contact->collision1->GetScopedName();
+    }
+  }
+
+  std::map<std::string, ignition::math::Vector3d> slips;
+  this->GetSlips(slips);
+  for (size_t i = 0; i < this->wheel_names_.size(); ++i)
+  {
+    std::map<std::string, ignition::math::Vector3d>::const_iterator slip =
+      slips.find(this->wheel_names_[i]);
+    if (slip == slips.end())
+      continue;
+    this->contact_msg_.longitudinal_slip[i] = slip->second.X();
+    this->contact_msg_.lateral_slip[i] = slip->second.Y();
+  }
+
+  this->contact_msg_.header.stamp.sec = _time.sec;
+  this->contact_msg_.header.stamp.nsec = _time.nsec;
+  this->contact_pub_.publish(this->contact_msg_);
+}
+
+/////////////////////////////////////////////////
+// Someone subscribes to the contacts
+void GazeboRosWheelSlip::ContactConnect()
+{
+  boost::mutex::scoped_lock lock(this->lock_);
+  ++this->contact_connect_count_;
+}
+
+/////////////////////////////////////////////////
+// Someone unsubscribes from the contacts
+void GazeboRosWheelSlip::ContactDisconnect()
+{
+  boost::mutex::scoped_lock lock(this->lock_);
+  --this->contact_connect_count_;
+}
+
 }
@@ -0,0 +1,566 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <cstdlib>
+#include <cstring>
+
+#include <boost/thread/once.hpp>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define IMAGE_KERNELS_X86 1
+#include <immintrin.h>
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define IMAGE_KERNELS_NEON 1
+#include <arm_neon.h>
+#endif
+
+#include <gazebo_plugins/image_format_kernels.h>
+
+namespace gazebo
+{
+namespace image_kernels
+{
+namespace
+{
+/// \brief BT.601 luma weights, summing to 256
+const unsigned int kRed = 77;
+const unsigned int kGreen = 150;
+const unsigned int kBlue = 29;
+
+////////////////////////////////////////////////////////////////////////////////
+// scalar reference implementations, also used for the tails of the vector
+// ones
+void SwapRedBlueScalar(const uint8_t *_src, uint8_t *_dst, size_t _n)
+{
+  for (size_t i = 0; i < _n; ++i, _src += 3, _dst += 3)
+  {
+    _dst[0] = _src[2];
+    _dst[1] = _src[1];
+    _dst[2] = _src[0];
+  }
+}
+
+void ColorToMonoScalar(const uint8_t *_src, uint8_t *_dst, size_t _n,
+                       bool _bgr)
+{
+  const int r = _bgr ? 2 : 0;
+  const int b = _bgr ? 0 : 2;
+  for (size_t i = 0; i < _n; ++i, _src += 3)
+  {
+    _dst[i] = static_cast<uint8_t>(
+      (kRed * _src[r] + kGreen * _src[1] + kBlue * _src[b] + 128) >> 8);
+  }
+}
+
+void ColorToBayerRowScalar(const uint8_t *_src, uint8_t *_dst, size_t _n,
+                           int _even, int _odd)
+{
+  size_t i = 0;
+  for (; i + 2 <= _n; i += 2)
+  {
+    _dst[i] = _src[3 * i + _even];
+    _dst[i + 1] = _src[3 * i + 3 + _odd];
+  }
+  if (i < _n)
+    _dst[i] = _src[3 * i + _even];
+}
+
+void Expand8To16Scalar(const uint8_t *_src, uint16_t *_dst, size_t _n)
+{
+  for (size_t i = 0; i < _n; ++i)
+    _dst[i] = static_cast<uint16_t>(_src[i] * 257);
+}
+
+template<class T>
+void Downsample2x2Scalar(const T *_row0, const T *_row1, T *_dst, size_t _n,
+                         int _channels)
+{
+  const size_t c = _channels;
+  for (size_t i = 0; i < _n * c; ++i)
+  {
+    // byte i of the output starts at byte k of the 2x2 block
+    size_t k = (i / c) * 2 * c + i % c;
+    uint32_t sum = static_cast<uint32_t>(_row0[k]) + _row0[k + c] +
+                   _row1[k] + _row1[k + c];
+    _dst[i] = static_cast<T>((sum + 2) >> 2);
+  }
+}
+
+void Downsample2x2Scalar8(const uint8_t *_row0, const uint8_t *_row1,
+                          uint8_t *_dst, size_t _n, int _channels)
+{
+  Downsample2x2Scalar(_row0, _row1, _dst, _n, _channels);
+}
+
+#ifdef IMAGE_KERNELS_X86
+////////////////////////////////////////////////////////////////////////////////
+// SSSE3, compiled for that target only and picked at runtime.  The 3 byte
+// pixels are rearranged 16 at a time: every output vector gathers its bytes
+// out of the three 16 byte loads of the 48 source bytes with pshufb.
+
+/// \brief Shuffle masks picking bytes _index[0..15] of 48 source bytes
+struct Gather48
+{
+  __m128i mask[3];
+};
+
+void MakeGather48(const uint8_t _index[16], Gather48 &_gather)
+{
+  for (int k = 0; k < 3; ++k)
+  {
+    uint8_t mask[16];
+    for (int j = 0; j < 16; ++j)
+    {
+      int from = static_cast<int>(_index[j]) - 16 * k;
+      // pshufb writes 0 where the mask byte has its high bit set
+      mask[j] = (from >= 0 && from < 16) ? static_cast<uint8_t>(from) : 0x80;
+    }
+    _gather.mask[k] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(mask));
+  }
+}
+
+__attribute__((target("ssse3")))
+inline __m128i Gather(const __m128i _src[3], const Gather48 &_gather)
+{
+  return _mm_or_si128(
+    _mm_or_si128(_mm_shuffle_epi8(_src[0], _gather.mask[0]),
+                 _mm_shuffle_epi8(_src[1], _gather.mask[1])),
+    _mm_shuffle_epi8(_src[2], _gather.mask[2]));
+}
+
+__attribute__((target("ssse3")))
+inline void Load48(const uint8_t *_src, __m128i _out[3])
+{
+  const __m128i *src = reinterpret_cast<const __m128i *>(_src);
+  _out[0] = _mm_loadu_si128(src);
+  _out[1] = _mm_loadu_si128(src + 1);
+  _out[2] = _mm_loadu_si128(src + 2);
+}
+
+/// \brief Gather of byte _channel of each of 16 pixels
+void MakePlane(int _channel, Gather48 &_gather)
+{
+  uint8_t index[16];
+  for (int j = 0; j < 16; ++j)
+    index[j] = static_cast<uint8_t>(3 * j + _channel);
+  MakeGather48(index, _gather);
+}
+
+__attribute__((target("ssse3")))
+void SwapRedBlueSSSE3(const uint8_t *_src, uint8_t *_dst, size_t _n)
+{
+  Gather48 out[3];
+  for (int m = 0; m < 3; ++m)
+  {
+    uint8_t index[16];
+    for (int j = 0; j < 16; ++j)
+    {
+      int o = 16 * m + j;
+      index[j] = static_cast<uint8_t>(3 * (o / 3) + 2 - o % 3);
+    }
+    MakeGather48(index, out[m]);
+  }
+
+  size_t i = 0;
+  for (; i + 16 <= _n; i += 16)
+  {
+    __m128i src[3];
+    Load48(_src + 3 * i, src);
+    __m128i *dst = reinterpret_cast<__m128i *>(_dst + 3 * i);
+    _mm_storeu_si128(dst, Gather(src, out[0]));
+    _mm_storeu_si128(dst + 1, Gather(src, out[1]));
+    _mm_storeu_si128(dst + 2, Gather(src, out[2]));
+  }
+  SwapRedBlueScalar(_src + 3 * i, _dst + 3 * i, _n - i);
+}
+
+__attribute__((target("ssse3")))
+void ColorToMonoSSSE3(const uint8_t *_src, uint8_t *_dst, size_t _n,
+                      bool _bgr)
+{
+  Gather48 red, green, blue;
+  MakePlane(_bgr ? 2 : 0, red);
+  MakePlane(1, green);
+  MakePlane(_bgr ? 0 : 2, blue);
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i wr = _mm_set1_epi16(kRed);
+  const __m128i wg = _mm_set1_epi16(kGreen);
+  const __m128i wb = _mm_set1_epi16(kBlue);
+  const __m128i half = _mm_set1_epi16(128);
+
+  size_t i = 0;
+  for (; i + 16 <= _n; i += 16)
+  {
+    __m128i src[3];
+    Load48(_src + 3 * i, src);
+    __m128i r = Gather(src, red);
+    __m128i g = Gather(src, green);
+    __m128i b = Gather(src, blue);
+    // the weighted sum of 8 bit values stays below 65536
+    __m128i lo = _mm_add_epi16(
+      _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(r, zero), wr),
+                    _mm_mullo_epi16(_mm_unpacklo_epi8(g, zero), wg)),
+      _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(b, zero), wb), half));
+    __m128i hi = _mm_add_epi16(
+      _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(r, zero), wr),
+                    _mm_mullo_epi16(_mm_unpackhi_epi8(g, zero), wg)),
+      _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(b, zero), wb), half));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(_dst + i),
+      _mm_packus_epi16(_mm_srli_epi16(lo, 8), _mm_srli_epi16(hi, 8)));
+  }
+  ColorToMonoScalar(_src + 3 * i, _dst + i, _n - i, _bgr);
+}
+
+__attribute__((target("ssse3")))
+void ColorToBayerRowSSSE3(const uint8_t *_src, uint8_t *_dst, size_t _n,
+                          int _even, int _odd)
+{
+  Gather48 mosaic;
+  uint8_t index[16];
+  for (int j = 0; j < 16; ++j)
+    index[j] = static_cast<uint8_t>(3 * j + ((j % 2) ? _odd : _even));
+  MakeGather48(index, mosaic);
+
+  size_t i = 0;
+  for (; i + 16 <= _n; i += 16)
+  {
+    __m128i src[3];
+    Load48(_src + 3 * i, src);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(_dst + i),
+                     Gather(src, mosaic));
+  }
+  ColorToBayerRowScalar(_src + 3 * i, _dst + i, _n - i, _even, _odd);
+}
+
+__attribute__((target("ssse3")))
+void Expand8To16SSSE3(const uint8_t *_src, uint16_t *_dst, size_t _n)
+{
+  size_t i = 0;
+  for (; i + 16 <= _n; i += 16)
+  {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(_src + i));
+    // v | v << 8 == v * 257
+    __m128i *dst = reinterpret_cast<__m128i *>(_dst + i);
+    _mm_storeu_si128(dst, _mm_unpacklo_epi8(v, v));
+    _mm_storeu_si128(dst + 1, _mm_unpackhi_epi8(v, v));
+  }
+  Expand8To16Scalar(_src + i, _dst + i, _n - i);
+}
+
+__attribute__((target("ssse3")))
+void Downsample2x2SSSE3(const uint8_t *_row0, const uint8_t *_row1,
+                        uint8_t *_dst, size_t _n, int _channels)
+{
+  const size_t c = _channels;
+  if (c < 1 || c > 4)
+  {
+    Downsample2x2Scalar8(_row0, _row1, _dst, _n, _channels);
+    return;
+  }
+
+  // every window of source bytes holds whole pixel pairs: 16 bytes for 1,
+  // 2 and 4 channels, 12 for 3.  Adding the window to itself shifted by
+  // one pixel sums the pairs at the bytes of the even pixels, which pshufb
+  // then packs to the front.
+  const size_t period = 2 * c;
+  const size_t step = period * (16 / period);
+  uint8_t mask[16];
+  size_t m = 0;
+  for (size_t j = 0; j < 16; ++j)
+    mask[j] = 0x80;
+  for (size_t j = 0; j < step; ++j)
+  {
+    if (j % period < c)
+      mask[m++] = static_cast<uint8_t>(j);
+  }
+  const __m128i compact =
+    _mm_loadu_si128(reinterpret_cast<const __m128i *>(mask));
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i two = _mm_set1_epi16(2);
+
+  const size_t src_bytes = 2 * c * _n;
+  const size_t dst_bytes = c * _n;
+  size_t x = 0;
+  size_t o = 0;
+  // the loads read up to byte x + c + 15, the store writes 16 bytes
+  for (; x + c + 16 <= src_bytes && o + 16 <= dst_bytes; x += step, o += step / 2)
+  {
+    __m128i a0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(_row0 + x));
+    __m128i b0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(_row0 + x + c));
+    __m128i a1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(_row1 + x));
+    __m128i b1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(_row1 + x + c));
+    __m128i lo = _mm_add_epi16(
+      _mm_add_epi16(_mm_unpacklo_epi8(a0, zero), _mm_unpacklo_epi8(b0, zero)),
+      _mm_add_epi16(_mm_unpacklo_epi8(a1, zero), _mm_unpacklo_epi8(b1, zero)));
+    __m128i hi = _mm_add_epi16(
+      _mm_add_epi16(_mm_unpackhi_epi8(a0, zero), _mm_unpackhi_epi8(b0, zero)),
+      _mm_add_epi16(_mm_unpackhi_epi8(a1, zero), _mm_unpackhi_epi8(b1, zero)));
+    lo = _mm_srli_epi16(_mm_add_epi16(lo, two), 2);
+    hi = _mm_srli_epi16(_mm_add_epi16(hi, two), 2);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(_dst + o),
+      _mm_shuffle_epi8(_mm_packus_epi16(lo, hi), compact));
+  }
+  Downsample2x2Scalar8(_row0 + x, _row1 + x, _dst + o, _n - o / c, _channels);
+}
+#endif
+
+#ifdef IMAGE_KERNELS_NEON
+////////////////////////////////////////////////////////////////////////////////
+// NEON, vld3 / vst3 split the 3 byte pixels into planes for free
+void SwapRedBlueNEON(const uint8_t *_src, uint8_t *_dst, size_t _n)
+{
+  size_t i = 0;
+  for (; i + 16 <= _n; i += 16)
+  {
+    uint8x16x3_t v = vld3q_u8(_src + 3 * i);
+    uint8x16_t r = v.val[0];
+    v.val[0] = v.val[2];
+    v.val[2] = r;
+    vst3q_u8(_dst + 3 * i, v);
+  }
+  SwapRedBlueScalar(_src + 3 * i, _dst + 3 * i, _n - i);
+}
+
+void ColorToMonoNEON(const uint8_t *_src, uint8_t *_dst, size_t _n,
+                     bool _bgr)
+{
+  const uint8x8_t wr = vdup_n_u8(kRed);
+  const uint8x8_t wg = vdup_n_u8(kGreen);
+  const uint8x8_t wb = vdup_n_u8(kBlue);
+  size_t i = 0;
+  for (; i + 16 <= _n; i += 16)
+  {
+    uint8x16x3_t v = vld3q_u8(_src + 3 * i);
+    uint8x16_t r = v.val[_bgr ? 2 : 0];
+    uint8x16_t b = v.val[_bgr ? 0 : 2];
+    uint16x8_t lo = vmull_u8(vget_low_u8(r), wr);
+    lo = vmlal_u8(lo, vget_low_u8(v.val[1]), wg);
+    lo = vmlal_u8(lo, vget_low_u8(b), wb);
+    uint16x8_t hi = vmull_u8(vget_high_u8(r), wr);
+    hi = vmlal_u8(hi, vget_high_u8(v.val[1]), wg);
+    hi = vmlal_u8(hi, vget_high_u8(b), wb);
+    // rounding shift, (x + 128) >> 8
+    vst1q_u8(_dst + i, vcombine_u8(vrshrn_n_u16(lo, 8), vrshrn_n_u16(hi, 8)));
+  }
+  ColorToMonoScalar(_src + 3 * i, _dst + i, _n - i, _bgr);
+}
+
+void ColorToBayerRowNEON(const uint8_t *_src, uint8_t *_dst, size_t _n,
+                         int _even, int _odd)
+{
+  static const uint8_t even_lanes[16] =
+    {0xFF, 0, 0xFF, 0, 0xFF, 0, 0xFF, 0, 0xFF, 0, 0xFF, 0, 0xFF, 0, 0xFF, 0};
+  const uint8x16_t even = vld1q_u8(even_lanes);
+  size_t i = 0;
+  for (; i + 16 <= _n; i += 16)
+  {
+    uint8x16x3_t v = vld3q_u8(_src + 3 * i);
+    vst1q_u8(_dst + i, vbslq_u8(even, v.val[_even], v.val[_odd]));
+  }
+  ColorToBayerRowScalar(_src + 3 * i, _dst + i, _n - i, _even, _odd);
+}
+
+void Expand8To16NEON(const uint8_t *_src, uint16_t *_dst, size_t _n)
+{
+  size_t i = 0;
+  for (; i + 16 <= _n; i += 16)
+  {
+    uint8x16_t v = vld1q_u8(_src + i);
+    uint8x16x2_t z = vzipq_u8(v, v);
+    uint8_t *dst = reinterpret_cast<uint8_t *>(_dst + i);
+    vst1q_u8(dst, z.val[0]);
+    vst1q_u8(dst + 16, z.val[1]);
+  }
+  Expand8To16Scalar(_src + i, _dst + i, _n - i);
+}
+
+/// \brief Rounded mean of the pixel pairs of plane _p of two rows
+#define DOWNSAMPLE_PLANE(_r0, _r1, _p) \
+  vrshrn_n_u16(vpadalq_u8(vpaddlq_u8((_r0).val[_p]), (_r1).val[_p]), 2)
+
+void Downsample2x2NEON(const uint8_t *_row0, const uint8_t *_row1,
+                       uint8_t *_dst, size_t _n, int _channels)
+{
+  size_t i = 0;
+  if (_channels == 1)
+  {
+    for (; i + 8 <= _n; i += 8)
+    {
+      uint16x8_t sum = vpaddlq_u8(vld1q_u8(_row0 + 2 * i));
+      sum = vpadalq_u8(sum, vld1q_u8(_row1 + 2 * i));
+      vst1_u8(_dst + i, vrshrn_n_u16(sum, 2));
+    }
+  }
+  else if (_channels == 3)
+  {
+    for (; i + 8 <= _n; i += 8)
+    {
+      uint8x16x3_t r0 = vld3q_u8(_row0 + 6 * i);
+      uint8x16x3_t r1 = vld3q_u8(_row1 + 6 * i);
+      uint8x8x3_t out;
+      out.val[0] = DOWNSAMPLE_PLANE(r0, r1, 0);
+      out.val[1] = DOWNSAMPLE_PLANE(r0, r1, 1);
+      out.val[2] = DOWNSAMPLE_PLANE(r0, r1, 2);
+      vst3_u8(_dst + 3 * i, out);
+    }
+  }
+  else if (_channels == 4)
+  {
+    for (; i + 8 <= _n; i += 8)
+    {
+      uint8x16x4_t r0 = vld4q_u8(_row0 + 8 * i);
+      uint8x16x4_t r1 = vld4q_u8(_row1 + 8 * i);
+      uint8x8x4_t out;
+      out.val[0] = DOWNSAMPLE_PLANE(r0, r1, 0);
+      out.val[1] = DOWNSAMPLE_PLANE(r0, r1, 1);
+      out.val[2] = DOWNSAMPLE_PLANE(r0, r1, 2);
+      out.val[3] = DOWNSAMPLE_PLANE(r0, r1, 3);
+      vst4_u8(_dst + 4 * i, out);
+    }
+  }
+  const size_t c = _channels;
+  Downsample2x2Scalar8(_row0 + 2 * c * i, _row1 + 2 * c * i, _dst + c * i,
+                       _n - i, _channels);
+}
+#undef DOWNSAMPLE_PLANE
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+struct Kernels
+{
+  const char *name;
+  void (*swap)(const uint8_t *, uint8_t *, size_t);
+  void (*mono)(const uint8_t *, uint8_t *, size_t, bool);
+  void (*bayer)(const uint8_t *, uint8_t *, size_t, int, int);
+  void (*expand)(const uint8_t *, uint16_t *, size_t);
+  void (*downsample)(const uint8_t *, const uint8_t *, uint8_t *, size_t, int);
+};
+
+const Kernels kScalar = {"scalar", &SwapRedBlueScalar, &ColorToMonoScalar,
+  &ColorToBayerRowScalar, &Expand8To16Scalar, &Downsample2x2Scalar8};
+#ifdef IMAGE_KERNELS_X86
+const Kernels kSSSE3 = {"ssse3", &SwapRedBlueSSSE3, &ColorToMonoSSSE3,
+  &ColorToBayerRowSSSE3, &Expand8To16SSSE3, &Downsample2x2SSSE3};
+#endif
+#ifdef IMAGE_KERNELS_NEON
+const Kernels kNEON = {"neon", &SwapRedBlueNEON, &ColorToMonoNEON,
+  &ColorToBayerRowNEON, &Expand8To16NEON, &Downsample2x2NEON};
+#endif
+
+const Kernels *Find(const char *_name)
+{
+  if (!strcmp(_name, "scalar"))
+    return &kScalar;
+#ifdef IMAGE_KERNELS_X86
+  if (!strcmp(_name, "ssse3") && __builtin_cpu_supports("ssse3"))
+    return &kSSSE3;
+#endif
+#ifdef IMAGE_KERNELS_NEON
+  if (!strcmp(_name, "neon"))
+    return &kNEON;
+#endif
+  return NULL;
+}
+
+const Kernels *g_kernels = NULL;
+boost::once_flag g_kernels_once = BOOST_ONCE_INIT;
+
+void SelectKernels()
+{
+  const char *forced = getenv("GAZEBO_ROS_IMAGE_KERNELS");
+  if (forced && Find(forced))
+  {
+    g_kernels = Find(forced);
+    return;
+  }
+  const char *best[] = {"ssse3", "neon"};
+  for (size_t i = 0; i < sizeof(best) / sizeof(best[0]); ++i)
+  {
+    if (const Kernels *k = Find(best[i]))
+    {
+      g_kernels = k;
+      return;
+    }
+  }
+  g_kernels = &kScalar;
+}
+
+const Kernels &Get()
+{
+  boost::call_once(&SelectKernels, g_kernels_once);
+  return *g_kernels;
+}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+const char *Implementation()
+{
+  return Get().name;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool SetImplementation(const char *_name)
+{
+  Get();
+  const Kernels *k = Find(_name);
+  if (!k)
+    return false;
+  g_kernels = k;
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void SwapRedBlue(const uint8_t *_src, uint8_t *_dst, size_t _n)
+{
+  Get().swap(_src, _dst, _n);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ColorToMono(const uint8_t *_src, uint8_t *_dst, size_t _n, bool _bgr)
+{
+  Get().mono(_src, _dst, _n, _bgr);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ColorToBayerRow(const uint8_t *_src, uint8_t *_dst, size_t _n,
+                     int _even, int _odd)
+{
+  Get().bayer(_src, _dst, _n, _even, _odd);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void Expand8To16(const uint8_t *_src, uint16_t *_dst, size_t _n)
+{
+  Get().expand(_src, _dst, _n);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void Downsample2x2(const uint8_t *_row0, const uint8_t *_row1, uint8_t *_dst,
+                   size_t _n, int _channels)
+{
+  Get().downsample(_row0, _row1, _dst, _n, _channels);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void Downsample2x2(const uint16_t *_row0, const uint16_t *_row1,
+                   uint16_t *_dst, size_t _n, int _channels)
+{
+  Downsample2x2Scalar(_row0, _row1, _dst, _n, _channels);
+}
+}
+}
@@ -0,0 +1,94 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gazebo_plugins/imu_batch.h>
+
+namespace gazebo
+{
+////////////////////////////////////////////////////////////////////////////////
+ImuBatch::ImuBatch()
+  : count_(0), decimation_(1), skipped_(0)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ImuBatch::Load(sdf::ElementPtr _sdf, const std::string &_topic_name)
+{
+  int size = 0;
+  if (_sdf->HasElement("batchSize"))
+    size = _sdf->Get<int>("batchSize");
+  this->msg_.imu.resize(size > 0 ? size : 0);
+  this->count_ = 0;
+
+  this->topic_name_ = _topic_name + "_batch";
+  if (_sdf->HasElement("batchTopicName"))
+    this->topic_name_ = _sdf->Get<std::string>("batchTopicName");
+
+  int decimation = 1;
+  if (_sdf->HasElement("sampleDecimation"))
+    decimation = _sdf->Get<int>("sampleDecimation");
+  this->decimation_ = decimation > 1 ? decimation : 1;
+  this->skipped_ = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ImuBatch::Advertise(ros::NodeHandle &_node)
+{
+  if (this->msg_.imu.empty() || this->topic_name_.empty())
+    return;
+  this->pub_ = _node.advertise<gazebo_msgs::ImuArray>(this->topic_name_, 1);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool ImuBatch::Active() const
+{
+  return this->pub_ && this->pub_.getNumSubscribers() > 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool ImuBatch::SingleDue()
+{
+  if (++this->skipped_ < this->decimation_)
+    return false;
+  this->skipped_ = 0;
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ImuBatch::Add(const sensor_msgs::Imu &_sample)
+{
+  if (this->msg_.imu.empty())
+    return;
+  if (this->count_ > 0 &&
+      this->msg_.imu[this->count_ - 1].header.stamp == _sample.header.stamp)
+    return;
+
+  this->msg_.imu[this->count_++] = _sample;
+  if (this->count_ < this->msg_.imu.size())
+    return;
+
+  this->msg_.header = _sample.header;
+  this->pub_.publish(this->msg_);
+  this->count_ = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ImuBatch::Reset()
+{
+  this->count_ = 0;
+}
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <ros/ros.h>
+#include <sensor_msgs/point_cloud2_iterator.h>
+
+#include <gazebo_plugins/laser_intensity.h>
+
+namespace gazebo
+{
+////////////////////////////////////////////////////////////////////////////////
+void LaserIntensity::Load(sdf::ElementPtr _sdf, const std::string &_logger)
+{
+  if (_sdf->HasElement("intensities"))
+  {
+    std::string mode = _sdf->Get<std::string>("intensities");
+    if (mode == "false" || mode == "0")
+      this->mode_ = NEVER;
+    else if (mode == "auto")
+      this->mode_ = NONZERO;
+    else if (mode == "true" || mode == "1")
+      this->mode_ = ALWAYS;
+    else
+      ROS_WARN_NAMED(_logger, "Unknown <intensities> %s, use true, false or auto", mode.c_str());
+  }
+
+  if (_sdf->HasElement("intensityType"))
+  {
+    std::string type = _sdf->Get<std::string>("intensityType");
+    if (type == "uint8")
+      this->datatype_ = sensor_msgs::PointField::UINT8;
+    else if (type == "uint16")
+      this->datatype_ = sensor_msgs::PointField::UINT16;
+    else if (type != "float32")
+      ROS_WARN_NAMED(_logger, "Unknown <intensityType> %s, use float32, uint16 or uint8", type.c_str());
+  }
+
+  if (_sdf->HasElement("intensityScale"))
+    this->scale_ = _sdf->Get<double>("intensityScale");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void LaserIntensity::SetFields(sensor_msgs::PointCloud2 &_cloud,
+                               bool _intensity) const
+{
+  const size_t fields = _intensity ? 4 : 3;
+  if (_cloud.fields.size() == fields &&
+      (!_intensity || _cloud.fields[3].datatype == this->datatype_))
+    return;
+
+  sensor_msgs::PointCloud2Modifier modifier(_cloud);
+  if (_intensity)
+  {
+    modifier.setPointCloud2Fields(4,
+        "x", 1, sensor_msgs::PointField::FLOAT32,
+        "y", 1, sensor_msgs::PointField::FLOAT32,
+        "z", 1, sensor_msgs::PointField::FLOAT32,
+        "intensity", 1, this->datatype_);
+  }
+  else
+  {
+    modifier.setPointCloud2Fields(3,
+        "x", 1, sensor_msgs::PointField::FLOAT32,
+        "y", 1, sensor_msgs::PointField::FLOAT32,
+        "z", 1, sensor_msgs::PointField::FLOAT32);
+  }
+}
+}
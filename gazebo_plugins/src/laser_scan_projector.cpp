@@ -0,0 +1,135 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <cmath>
+#include <cstring>
+
+#include <gazebo_plugins/laser_scan_projector.h>
+
+namespace gazebo
+{
+////////////////////////////////////////////////////////////////////////////////
+LaserScanProjector::LaserScanProjector()
+  : count_(0), vertical_count_(0), angle_min_(0), angle_step_(0),
+    vertical_angle_min_(0), vertical_angle_step_(0)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void LaserScanProjector::UpdateTables(const msgs::LaserScan &_scan,
+                                      int _count, int _vertical_count)
+{
+  double vertical_angle_min = 0;
+  double vertical_angle_step = 0;
+  if (_vertical_count > 1)
+  {
+    vertical_angle_min = _scan.vertical_angle_min();
+    vertical_angle_step = _scan.vertical_angle_step();
+  }
+
+  if (_count == this->count_ && _vertical_count == this->vertical_count_ &&
+      _scan.angle_min() == this->angle_min_ &&
+      _scan.angle_step() == this->angle_step_ &&
+      vertical_angle_min == this->vertical_angle_min_ &&
+      vertical_angle_step == this->vertical_angle_step_)
+    return;
+
+  this->count_ = _count;
+  this->vertical_count_ = _vertical_count;
+  this->angle_min_ = _scan.angle_min();
+  this->angle_step_ = _scan.angle_step();
+  this->vertical_angle_min_ = vertical_angle_min;
+  this->vertical_angle_step_ = vertical_angle_step;
+
+  this->cos_yaw_.resize(_count);
+  this->sin_yaw_.resize(_count);
+  for (int i = 0; i < _count; ++i)
+  {
+    double yaw = this->angle_min_ + i * this->angle_step_;
+    this->cos_yaw_[i] = cos(yaw);
+    this->sin_yaw_[i] = sin(yaw);
+  }
+
+  this->cos_pitch_.resize(_vertical_count);
+  this->sin_pitch_.resize(_vertical_count);
+  for (int j = 0; j < _vertical_count; ++j)
+  {
+    double pitch = this->vertical_angle_min_ + j * this->vertical_angle_step_;
+    this->cos_pitch_[j] = cos(pitch);
+    this->sin_pitch_[j] = sin(pitch);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void LaserScanProjector::Project(const msgs::LaserScan &_scan,
+                                 sensor_msgs::PointCloud2 &_cloud,
+                                 const LaserIntensity &_intensity)
+{
+  const int n = _scan.ranges_size();
+  int count = static_cast<int>(_scan.count());
+  int vertical_count = static_cast<int>(_scan.vertical_count());
+  if (vertical_count < 1)
+    vertical_count = 1;
+  if (count <= 0 || count * vertical_count != n)
+  {
+    // unknown layout, take it as a single row
+    count = n;
+    vertical_count = 1;
+  }
+  this->UpdateTables(_scan, count, vertical_count);
+
+  const bool intensities = _scan.intensities_size() == n &&
+    _intensity.Output(_scan.intensities().begin(), _scan.intensities().end());
+  _intensity.SetFields(_cloud, intensities);
+  _cloud.data.resize(n * _cloud.point_step);
+
+  const float range_min = _scan.range_min();
+  const float range_max = _scan.range_max();
+  const uint32_t step = _cloud.point_step;
+  uint8_t *out = _cloud.data.data();
+  int kept = 0;
+  for (int j = 0; j < vertical_count; ++j)
+  {
+    const float cos_pitch = this->cos_pitch_[j];
+    const float sin_pitch = this->sin_pitch_[j];
+    for (int i = 0; i < count; ++i)
+    {
+      const int k = j * count + i;
+      const float r = _scan.ranges(k);
+      // also drops NaN and +-inf
+      if (!(r >= range_min && r <= range_max))
+        continue;
+      const float planar = r * cos_pitch;
+      // a quantized intensity leaves the floats unaligned
+      const float xyz[3] = {planar * this->cos_yaw_[i],
+                            planar * this->sin_yaw_[i], r * sin_pitch};
+      uint8_t *point = out + kept * step;
+      memcpy(point, xyz, sizeof(xyz));
+      if (intensities)
+        _intensity.Write(point + sizeof(xyz), _scan.intensities(k));
+      ++kept;
+    }
+  }
+
+  _cloud.data.resize(kept * _cloud.point_step);
+  _cloud.height = 1;
+  _cloud.width = kept;
+  _cloud.row_step = kept * _cloud.point_step;
+  _cloud.is_bigendian = false;
+  _cloud.is_dense = true;
+}
+}
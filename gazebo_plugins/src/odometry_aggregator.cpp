@@ -0,0 +1,110 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gazebo_plugins/odometry_aggregator.h>
+
+namespace gazebo
+{
+////////////////////////////////////////////////////////////////////////////////
+OdometryAggregator &OdometryAggregator::Instance()
+{
+  static OdometryAggregator instance;
+  return instance;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+OdometryAggregator::OdometryAggregator()
+  : updated_(false), active_(false)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool OdometryAggregator::Active() const
+{
+  return this->active_.load(std::memory_order_relaxed);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void OdometryAggregator::SetActive(bool _active)
+{
+  this->active_ = _active;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int OdometryAggregator::Register(const std::string &_name)
+{
+  boost::mutex::scoped_lock lock(this->mutex_);
+  size_t slot = 0;
+  while (slot < this->slots_.size() && this->slots_[slot].used)
+    ++slot;
+  if (slot == this->slots_.size())
+    this->slots_.push_back(Slot());
+  this->slots_[slot].name = _name;
+  this->slots_[slot].used = true;
+  this->slots_[slot].valid = false;
+  return static_cast<int>(slot);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void OdometryAggregator::Unregister(int _slot)
+{
+  boost::mutex::scoped_lock lock(this->mutex_);
+  if (_slot < 0 || static_cast<size_t>(_slot) >= this->slots_.size())
+    return;
+  this->slots_[_slot].used = false;
+  this->slots_[_slot].valid = false;
+  this->updated_ = true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void OdometryAggregator::Submit(int _slot, const nav_msgs::Odometry &_odom)
+{
+  boost::mutex::scoped_lock lock(this->mutex_);
+  Slot &slot = this->slots_[_slot];
+  slot.odom = _odom;
+  slot.valid = true;
+  this->updated_ = true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool OdometryAggregator::Collect(gazebo_msgs::OdometryArray &_msg)
+{
+  boost::mutex::scoped_lock lock(this->mutex_);
+  if (!this->updated_)
+    return false;
+  this->updated_ = false;
+
+  size_t count = 0;
+  for (size_t i = 0; i < this->slots_.size(); ++i)
+    if (this->slots_[i].used && this->slots_[i].valid)
+      ++count;
+  _msg.name.resize(count);
+  _msg.odometry.resize(count);
+
+  size_t n = 0;
+  for (size_t i = 0; i < this->slots_.size(); ++i)
+  {
+    const Slot &slot = this->slots_[i];
+    if (!slot.used || !slot.valid)
+      continue;
+    _msg.name[n] = slot.name;
+    _msg.odometry[n] = slot.odom;
+    ++n;
+  }
+  return true;
+}
+}
@@ -0,0 +1,481 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <bzlib.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include <gazebo_plugins/point_cloud_codec.h>
+
+namespace gazebo
+{
+namespace
+{
+const uint8_t VERSION = 1;
+
+/// \brief Bytes of a sensor_msgs::PointField datatype, 0 if unknown
+size_t TypeSize(uint8_t _datatype)
+{
+  switch (_datatype)
+  {
+    case sensor_msgs::PointField::INT8:
+    case sensor_msgs::PointField::UINT8:
+      return 1;
+    case sensor_msgs::PointField::INT16:
+    case sensor_msgs::PointField::UINT16:
+      return 2;
+    case sensor_msgs::PointField::INT32:
+    case sensor_msgs::PointField::UINT32:
+    case sensor_msgs::PointField::FLOAT32:
+      return 4;
+    case sensor_msgs::PointField::FLOAT64:
+      return 8;
+    default:
+      return 0;
+  }
+}
+
+/// \brief Spread the low 21 bits of _v to every third bit
+uint64_t Spread(uint64_t _v)
+{
+  _v &= 0x1fffff;
+  _v = (_v | _v << 32) & 0x1f00000000ffffull;
+  _v = (_v | _v << 16) & 0x1f0000ff0000ffull;
+  _v = (_v | _v << 8) & 0x100f00f00f00f00full;
+  _v = (_v | _v << 4) & 0x10c30c30c30c30c3ull;
+  _v = (_v | _v << 2) & 0x1249249249249249ull;
+  return _v;
+}
+
+void PutVarint(std::vector<uint8_t> &_out, uint64_t _v)
+{
+  while (_v >= 0x80)
+  {
+    _out.push_back(static_cast<uint8_t>(_v | 0x80));
+    _v >>= 7;
+  }
+  _out.push_back(static_cast<uint8_t>(_v));
+}
+
+void PutU32(std::vector<uint8_t> &_out, uint32_t _v)
+{
+  for (int i = 0; i < 4; ++i)
+    _out.push_back(static_cast<uint8_t>(_v >> (8 * i)));
+}
+
+/// \brief Reads the stream, every read fails once past its end
+class Reader
+{
+  public: Reader(const uint8_t *_data, size_t _size)
+    : p_(_data), end_(_data + _size) {}
+
+  public: bool Byte(uint8_t &_v)
+  {
+    if (this->p_ >= this->end_)
+      return false;
+    _v = *this->p_++;
+    return true;
+  }
+
+  public: bool U32(uint32_t &_v)
+  {
+    _v = 0;
+    uint8_t b;
+    for (int i = 0; i < 4; ++i)
+    {
+      if (!this->Byte(b))
+        return false;
+      _v |= static_cast<uint32_t>(b) << (8 * i);
+    }
+    return true;
+  }
+
+  public: bool Varint(uint64_t &_v)
+  {
+    _v = 0;
+    uint8_t b;
+    for (int shift = 0; shift < 64; shift += 7)
+    {
+      if (!this->Byte(b))
+        return false;
+      _v |= static_cast<uint64_t>(b & 0x7f) << shift;
+      if (!(b & 0x80))
+        return true;
+    }
+    return false;
+  }
+
+  public: size_t Remaining() const
+  {
+    return this->end_ - this->p_;
+  }
+
+  public: bool Bytes(uint8_t *_out, size_t _n)
+  {
+    if (static_cast<size_t>(this->end_ - this->p_) < _n)
+      return false;
+    memcpy(_out, this->p_, _n);
+    this->p_ += _n;
+    return true;
+  }
+
+  private: const uint8_t *p_;
+  private: const uint8_t *end_;
+};
+
+/// \brief Inflate the bzip2 stream _data into _out, which is grown as the
+/// stream is read rather than sized by the untrusted _raw_size up front.
+/// \return False unless the stream is valid and inflates to _raw_size bytes
+bool Inflate(const uint8_t *_data, size_t _size, uint32_t _raw_size,
+             std::vector<uint8_t> &_out)
+{
+  bz_stream stream;
+  memset(&stream, 0, sizeof(stream));
+  if (BZ2_bzDecompressInit(&stream, 0, 0) != BZ_OK)
+    return false;
+  stream.next_in = const_cast<char *>(reinterpret_cast<const char *>(_data));
+  stream.avail_in = _size;
+
+  int ret = BZ_OK;
+  size_t used = 0;
+  _out.clear();
+  while (ret == BZ_OK)
+  {
+    if (used == _out.size())
+    {
+      // a byte past _raw_size tells a stream inflating to more apart
+      const size_t cap = static_cast<size_t>(_raw_size) + 1;
+      if (used == cap)
+        break;
+      _out.resize(std::min(cap, std::max<size_t>(2 * used, 1 << 16)));
+    }
+    stream.next_out = reinterpret_cast<char *>(&_out[used]);
+    stream.avail_out = _out.size() - used;
+    ret = BZ2_bzDecompress(&stream);
+    used = _out.size() - stream.avail_out;
+    // out of input with room left, the stream is truncated
+    if (ret == BZ_OK && stream.avail_in == 0 && stream.avail_out > 0)
+      break;
+  }
+  BZ2_bzDecompressEnd(&stream);
+  _out.resize(used);
+  return ret == BZ_STREAM_END && used == _raw_size;
+}
+
+/// \brief Fields of a cloud other than x, y and z
+struct Extra
+{
+  std::string name;
+  uint8_t datatype;
+  uint32_t count;
+  uint32_t offset;
+  size_t size;
+};
+}
+
+////////////////////////////////////////////////////////////////////////////////
+PointCloudCodec::PointCloudCodec(float _resolution, bool _entropy)
+  : resolution_(_resolution > 0 ? _resolution : 0.001f), entropy_(_entropy)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool PointCloudCodec::Encode(const sensor_msgs::PointCloud2 &_cloud,
+                             gazebo_msgs::CompressedPointCloud &_msg)
+{
+  int xyz[3] = { -1, -1, -1 };
+  std::vector<Extra> extras;
+  for (size_t i = 0; i < _cloud.fields.size(); ++i)
+  {
+    const sensor_msgs::PointField &field = _cloud.fields[i];
+    const int axis = field.name == "x" ? 0 : field.name == "y" ? 1 :
+                     field.name == "z" ? 2 : -1;
+    if (axis >= 0 && field.datatype == sensor_msgs::PointField::FLOAT32 &&
+        field.count == 1)
+    {
+      xyz[axis] = field.offset;
+      continue;
+    }
+    Extra extra;
+    extra.name = field.name;
+    extra.datatype = field.datatype;
+    extra.count = field.count;
+    extra.offset = field.offset;
+    extra.size = TypeSize(field.datatype) * field.count;
+    if (extra.size == 0 || extra.name.size() > 255 ||
+        extra.offset + extra.size > _cloud.point_step)
+      continue;
+    extras.push_back(extra);
+  }
+  if (xyz[0] < 0 || xyz[1] < 0 || xyz[2] < 0 || _cloud.is_bigendian ||
+      _cloud.point_step < 12 ||
+      _cloud.data.size() < static_cast<size_t>(_cloud.row_step) * _cloud.height)
+    return false;
+  if (extras.size() > 255)
+    extras.resize(255);
+
+  // quantize the finite points
+  const size_t n = static_cast<size_t>(_cloud.width) * _cloud.height;
+  const double scale = 1.0 / this->resolution_;
+  const double limit = std::numeric_limits<int32_t>::max();
+  this->points_.clear();
+  this->points_.reserve(n);
+  int32_t lo[3] = { std::numeric_limits<int32_t>::max(),
+                    std::numeric_limits<int32_t>::max(),
+                    std::numeric_limits<int32_t>::max() };
+  for (size_t r = 0; r < _cloud.height; ++r)
+  {
+    const uint8_t *row = &_cloud.data[0] + r * _cloud.row_step;
+    for (size_t c = 0; c < _cloud.width; ++c)
+    {
+      const uint8_t *p = row + c * _cloud.point_step;
+      Point point;
+      bool finite = true;
+      for (int k = 0; k < 3; ++k)
+      {
+        float v;
+        memcpy(&v, p + xyz[k], sizeof(v));
+        if (!std::isfinite(v))
+        {
+          finite = false;
+          break;
+        }
+        const double q = std::max(std::min(std::round(v * scale), limit), -limit);
+        point.q_[k] = static_cast<int32_t>(q);
+        lo[k] = std::min(lo[k], point.q_[k]);
+      }
+      if (!finite)
+        continue;
+      point.index_ = static_cast<uint32_t>(r * _cloud.width + c);
+      this->points_.push_back(point);
+    }
+  }
+
+  // octree order; beyond 2^21 cells per axis neighbours are only less
+  // likely to follow each other
+  for (size_t i = 0; i < this->points_.size(); ++i)
+  {
+    Point &point = this->points_[i];
+    point.key_ = Spread(static_cast<int64_t>(point.q_[0]) - lo[0]) |
+                 Spread(static_cast<int64_t>(point.q_[1]) - lo[1]) << 1 |
+                 Spread(static_cast<int64_t>(point.q_[2]) - lo[2]) << 2;
+  }
+  std::sort(this->points_.begin(), this->points_.end(),
+            [](const Point &_a, const Point &_b) { return _a.key_ < _b.key_; });
+
+  std::vector<uint8_t> &raw = this->raw_;
+  raw.clear();
+  raw.push_back(VERSION);
+  raw.push_back(static_cast<uint8_t>(extras.size()));
+  for (size_t e = 0; e < extras.size(); ++e)
+  {
+    raw.push_back(static_cast<uint8_t>(extras[e].name.size()));
+    raw.insert(raw.end(), extras[e].name.begin(), extras[e].name.end());
+    raw.push_back(extras[e].datatype);
+    PutU32(raw, extras[e].count);
+  }
+
+  int64_t previous[3] = { 0, 0, 0 };
+  for (size_t i = 0; i < this->points_.size(); ++i)
+  {
+    for (int k = 0; k < 3; ++k)
+    {
+      const int64_t d = this->points_[i].q_[k] - previous[k];
+      PutVarint(raw, (static_cast<uint64_t>(d) << 1) ^
+                     static_cast<uint64_t>(d >> 63));
+      previous[k] = this->points_[i].q_[k];
+    }
+  }
+
+  // byte planes of the other fields
+  for (size_t e = 0; e < extras.size(); ++e)
+  {
+    for (size_t b = 0; b < extras[e].size; ++b)
+    {
+      const size_t start = raw.size();
+      raw.resize(start + this->points_.size());
+      uint8_t *out = &raw[start];
+      for (size_t i = 0; i < this->points_.size(); ++i)
+      {
+        const size_t index = this->points_[i].index_;
+        const size_t r = index / _cloud.width;
+        const size_t c = index % _cloud.width;
+        out[i] = _cloud.data[r * _cloud.row_step + c * _cloud.point_step +
+                             extras[e].offset + b];
+      }
+    }
+  }
+
+  _msg.header = _cloud.header;
+  _msg.resolution = this->resolution_;
+  _msg.points = static_cast<uint32_t>(this->points_.size());
+  if (!this->entropy_)
+  {
+    _msg.format = "gzpc";
+    _msg.data.assign(raw.begin(), raw.end());
+    return true;
+  }
+
+  // the raw size first, for the decoder to size its buffer
+  unsigned int size = raw.size() + raw.size() / 100 + 600;
+  _msg.data.resize(4 + size);
+  std::vector<uint8_t> head;
+  PutU32(head, static_cast<uint32_t>(raw.size()));
+  memcpy(&_msg.data[0], &head[0], 4);
+  if (BZ2_bzBuffToBuffCompress(reinterpret_cast<char *>(&_msg.data[4]), &size,
+        reinterpret_cast<char *>(&raw[0]), raw.size(), 9, 0, 0) != BZ_OK)
+    return false;
+  _msg.data.resize(4 + size);
+  _msg.format = "gzpc+bz2";
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool PointCloudCodec::Decode(const gazebo_msgs::CompressedPointCloud &_msg,
+                             sensor_msgs::PointCloud2 &_cloud,
+                             std::string &_error)
+{
+  std::vector<uint8_t> inflated;
+  const uint8_t *data = _msg.data.empty() ? NULL : &_msg.data[0];
+  size_t size = _msg.data.size();
+  if (_msg.format == "gzpc+bz2")
+  {
+    Reader head(data, size);
+    uint32_t raw_size;
+    if (!head.U32(raw_size))
+    {
+      _error = "truncated message";
+      return false;
+    }
+    if (raw_size == 0 || !Inflate(data + 4, size - 4, raw_size, inflated))
+    {
+      _error = "corrupt bzip2 stream";
+      return false;
+    }
+    data = &inflated[0];
+    size = inflated.size();
+  }
+  else if (_msg.format != "gzpc")
+  {
+    _error = "unknown format " + _msg.format;
+    return false;
+  }
+
+  Reader in(data, size);
+  uint8_t version, count;
+  if (!in.Byte(version) || version != VERSION || !in.Byte(count))
+  {
+    _error = "unsupported version";
+    return false;
+  }
+
+  _cloud.header = _msg.header;
+  _cloud.fields.resize(3 + count);
+  const char *names[3] = { "x", "y", "z" };
+  for (int k = 0; k < 3; ++k)
+  {
+    _cloud.fields[k].name = names[k];
+    _cloud.fields[k].offset = 4 * k;
+    _cloud.fields[k].datatype = sensor_msgs::PointField::FLOAT32;
+    _cloud.fields[k].count = 1;
+  }
+  uint32_t offset = 12;
+  for (size_t e = 0; e < count; ++e)
+  {
+    sensor_msgs::PointField &field = _cloud.fields[3 + e];
+    uint8_t length;
+    if (!in.Byte(length))
+    {
+      _error = "truncated field list";
+      return false;
+    }
+    field.name.resize(length);
+    if ((length > 0 && !in.Bytes(reinterpret_cast<uint8_t *>(&field.name[0]), length)) ||
+        !in.Byte(field.datatype) || !in.U32(field.count) ||
+        TypeSize(field.datatype) == 0 || field.count > 0xffff)
+    {
+      _error = "bad field list";
+      return false;
+    }
+    field.offset = offset;
+    offset += TypeSize(field.datatype) * field.count;
+  }
+
+  // every point takes at least a byte per coordinate and its bytes of the
+  // other fields, check _msg.points against what is left before allocating
+  const size_t n = _msg.points;
+  const size_t min_point_size = 3 + (offset - 12);
+  if (n > in.Remaining() / min_point_size)
+  {
+    _error = "truncated positions";
+    return false;
+  }
+  const size_t row_step = static_cast<size_t>(offset) * n;
+  if (row_step > std::numeric_limits<uint32_t>::max())
+  {
+    _error = "cloud too large";
+    return false;
+  }
+  _cloud.height = 1;
+  _cloud.width = n;
+  _cloud.point_step = offset;
+  _cloud.row_step = row_step;
+  _cloud.is_bigendian = false;
+  _cloud.is_dense = true;
+  _cloud.data.resize(row_step);
+
+  const float resolution = _msg.resolution;
+  int64_t q[3] = { 0, 0, 0 };
+  for (size_t i = 0; i < n; ++i)
+  {
+    uint8_t *p = &_cloud.data[i * offset];
+    for (int k = 0; k < 3; ++k)
+    {
+      uint64_t z;
+      if (!in.Varint(z))
+      {
+        _error = "truncated positions";
+        return false;
+      }
+      q[k] += static_cast<int64_t>(z >> 1) ^ -static_cast<int64_t>(z & 1);
+      const float v = static_cast<float>(q[k] * static_cast<double>(resolution));
+      memcpy(p + 4 * k, &v, sizeof(v));
+    }
+  }
+
+  std::vector<uint8_t> plane(n);
+  for (size_t e = 0; e < count; ++e)
+  {
+    const sensor_msgs::PointField &field = _cloud.fields[3 + e];
+    const size_t bytes = TypeSize(field.datatype) * field.count;
+    for (size_t b = 0; b < bytes; ++b)
+    {
+      if (n > 0 && !in.Bytes(&plane[0], n))
+      {
+        _error = "truncated fields";
+        return false;
+      }
+      for (size_t i = 0; i < n; ++i)
+        _cloud.data[i * offset + field.offset + b] = plane[i];
+    }
+  }
+  return true;
+}
+}
@@ -0,0 +1,215 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <algorithm>
+
+#include <boost/bind.hpp>
+
+#include <ros/ros.h>
+
+#include <gazebo_plugins/pub_service_pool.h>
+#include <gazebo_ros/thread_policy.h>
+
+////////////////////////////////////////////////////////////////////////////////
+PubServicePool& PubServicePool::instance()
+{
+  static PubServicePool *pool = NULL;
+  static boost::mutex instance_lock;
+
+  boost::mutex::scoped_lock lock(instance_lock);
+  if (!pool)
+  {
+    int threads = std::max(1u, boost::thread::hardware_concurrency());
+    if (ros::isInitialized())
+      ros::param::param<int>("gazebo/pub_service_pool_threads", threads, threads);
+    // intentionally leaked, see SharedCallbackExecutor::Instance()
+    pool = new PubServicePool(std::max(threads, 1));
+  }
+  return *pool;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool PubServicePool::enabled()
+{
+  bool use_pool = false;
+  if (ros::isInitialized())
+    ros::param::param<bool>("gazebo/use_pub_service_pool", use_pool, false);
+  return use_pool;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+PubServicePool::PubServicePool(size_t _threads) :
+  workers_(new Worker[_threads]), worker_count_(_threads), next_(0),
+  pending_(0), sleepers_(0), stop_(false)
+{
+  ROS_INFO_NAMED("pub_service_pool", "Starting publisher pool with %lu threads",
+                 static_cast<unsigned long>(_threads));
+  for (size_t i = 0; i < _threads; ++i)
+    this->threads_.create_thread(boost::bind(&PubServicePool::work, this, i));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+PubServicePool::~PubServicePool()
+{
+  {
+    boost::mutex::scoped_lock lock(this->sleep_lock_);
+    this->stop_ = true;
+  }
+  this->sleep_cond_.notify_all();
+  this->threads_.join_all();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+size_t PubServicePool::threadCount() const
+{
+  return this->worker_count_;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void PubServicePool::submit(PubServiceTask *_task)
+{
+  int state = _task->state_.load();
+  for (;;)
+  {
+    if (state == PubServiceTask::IDLE)
+    {
+      if (_task->state_.compare_exchange_weak(state, PubServiceTask::SCHEDULED))
+      {
+        this->enqueue(this->next_++ % this->worker_count_,
+                      _task->shared_from_this());
+        return;
+      }
+    }
+    else if (state == PubServiceTask::RUNNING)
+    {
+      // the worker may already be past the messages we just pushed, have it
+      // run the task once more when it is done
+      if (_task->state_.compare_exchange_weak(state,
+            PubServiceTask::RUNNING_DIRTY))
+        return;
+    }
+    else
+    {
+      // already scheduled, already dirty or cancelled
+      return;
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void PubServicePool::cancel(const PubServiceTask::Ptr& _task)
+{
+  int state = _task->state_.load();
+  for (;;)
+  {
+    if (state == PubServiceTask::IDLE || state == PubServiceTask::SCHEDULED)
+    {
+      // a scheduled task is dropped by the worker that pops it
+      if (_task->state_.compare_exchange_weak(state, PubServiceTask::CANCELLED))
+        return;
+    }
+    else if (state == PubServiceTask::CANCELLED)
+    {
+      return;
+    }
+    else
+    {
+      // running, a single publishAll() is short
+      boost::this_thread::yield();
+      state = _task->state_.load();
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void PubServicePool::enqueue(size_t _worker, const PubServiceTask::Ptr& _task)
+{
+  {
+    boost::mutex::scoped_lock lock(this->workers_[_worker].lock_);
+    this->workers_[_worker].tasks_.push_back(_task);
+  }
+  ++this->pending_;
+  // pairs with the sleepers_/pending_ checks in work(), both sequentially
+  // consistent, so either we see the sleeper or it sees the task
+  if (this->sleepers_.load() > 0)
+  {
+    boost::mutex::scoped_lock lock(this->sleep_lock_);
+    this->sleep_cond_.notify_one();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+PubServiceTask::Ptr PubServicePool::take(size_t _worker)
+{
+  PubServiceTask::Ptr task;
+  {
+    Worker &own = this->workers_[_worker];
+    boost::mutex::scoped_lock lock(own.lock_);
+    if (!own.tasks_.empty())
+    {
+      task = own.tasks_.front();
+      own.tasks_.pop_front();
+    }
+  }
+  for (size_t i = 1; !task && i < this->worker_count_; ++i)
+  {
+    Worker &victim = this->workers_[(_worker + i) % this->worker_count_];
+    boost::mutex::scoped_lock lock(victim.lock_, boost::try_to_lock);
+    if (lock.owns_lock() && !victim.tasks_.empty())
+    {
+      task = victim.tasks_.back();
+      victim.tasks_.pop_back();
+    }
+  }
+  if (task)
+    --this->pending_;
+  return task;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void PubServicePool::work(size_t _worker)
+{
+  gazebo::ThreadPolicy::instance().apply("publishing", "gzros_pub");
+  while (!this->stop_)
+  {
+    PubServiceTask::Ptr task = this->take(_worker);
+    if (!task)
+    {
+      boost::mutex::scoped_lock lock(this->sleep_lock_);
+      ++this->sleepers_;
+      // a steal can miss a task behind a busy try_lock, pending_ does not
+      while (this->pending_.load() == 0 && !this->stop_)
+        this->sleep_cond_.wait(lock);
+      --this->sleepers_;
+      continue;
+    }
+
+    int state = PubServiceTask::SCHEDULED;
+    if (!task->state_.compare_exchange_strong(state, PubServiceTask::RUNNING))
+      continue;  // cancelled while queued
+
+    task->run_();
+
+    state = PubServiceTask::RUNNING;
+    if (!task->state_.compare_exchange_strong(state, PubServiceTask::IDLE))
+    {
+      // RUNNING_DIRTY, only cancel() could change it and it waits for us
+      task->state_.store(PubServiceTask::SCHEDULED);
+      this->enqueue(_worker, task);
+    }
+  }
+}
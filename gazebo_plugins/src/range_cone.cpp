@@ -0,0 +1,203 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <limits>
+
+#include <boost/thread/once.hpp>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define RANGE_CONE_X86 1
+#include <immintrin.h>
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define RANGE_CONE_NEON 1
+#include <arm_neon.h>
+#endif
+
+#include <ros/ros.h>
+
+#include <gazebo_plugins/range_cone.h>
+
+namespace gazebo
+{
+namespace
+{
+////////////////////////////////////////////////////////////////////////////////
+// d < m is false for a NaN d, which keeps m: the semantics of minps, so the
+// vector versions agree with this one
+float MinRangeScalar(const float *_ranges, size_t _n, float _m)
+{
+  for (size_t i = 0; i < _n; ++i)
+  {
+    const float d = _ranges[i];
+    _m = d < _m ? d : _m;
+  }
+  return _m;
+}
+
+#ifdef RANGE_CONE_X86
+////////////////////////////////////////////////////////////////////////////////
+// SSE2 is part of x86-64, no target attribute needed.  Two accumulators hide
+// the latency of minps.
+float MinRangeSSE2(const float *_ranges, size_t _n)
+{
+  __m128 m0 = _mm_set1_ps(std::numeric_limits<float>::infinity());
+  __m128 m1 = m0;
+  size_t i = 0;
+  for (; i + 8 <= _n; i += 8)
+  {
+    m0 = _mm_min_ps(_mm_loadu_ps(_ranges + i), m0);
+    m1 = _mm_min_ps(_mm_loadu_ps(_ranges + i + 4), m1);
+  }
+  float lanes[4];
+  _mm_storeu_ps(lanes, _mm_min_ps(m0, m1));
+  return MinRangeScalar(_ranges + i, _n - i, MinRangeScalar(lanes, 4,
+    std::numeric_limits<float>::infinity()));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+__attribute__((target("avx2")))
+float MinRangeAVX2(const float *_ranges, size_t _n)
+{
+  __m256 m0 = _mm256_set1_ps(std::numeric_limits<float>::infinity());
+  __m256 m1 = m0;
+  size_t i = 0;
+  for (; i + 16 <= _n; i += 16)
+  {
+    m0 = _mm256_min_ps(_mm256_loadu_ps(_ranges + i), m0);
+    m1 = _mm256_min_ps(_mm256_loadu_ps(_ranges + i + 8), m1);
+  }
+  float lanes[8];
+  _mm256_storeu_ps(lanes, _mm256_min_ps(m0, m1));
+  return MinRangeScalar(_ranges + i, _n - i, MinRangeScalar(lanes, 8,
+    std::numeric_limits<float>::infinity()));
+}
+#endif
+
+#ifdef RANGE_CONE_NEON
+////////////////////////////////////////////////////////////////////////////////
+// vminq_f32 propagates NaN, select on the comparison instead
+float MinRangeNEON(const float *_ranges, size_t _n)
+{
+  float32x4_t m0 = vdupq_n_f32(std::numeric_limits<float>::infinity());
+  float32x4_t m1 = m0;
+  size_t i = 0;
+  for (; i + 8 <= _n; i += 8)
+  {
+    float32x4_t d0 = vld1q_f32(_ranges + i);
+    float32x4_t d1 = vld1q_f32(_ranges + i + 4);
+    m0 = vbslq_f32(vcltq_f32(d0, m0), d0, m0);
+    m1 = vbslq_f32(vcltq_f32(d1, m1), d1, m1);
+  }
+  float lanes[4];
+  vst1q_f32(lanes, vminq_f32(m0, m1));
+  return MinRangeScalar(_ranges + i, _n - i, MinRangeScalar(lanes, 4,
+    std::numeric_limits<float>::infinity()));
+}
+#endif
+
+float MinRangeDefault(const float *_ranges, size_t _n)
+{
+  return MinRangeScalar(_ranges, _n, std::numeric_limits<float>::infinity());
+}
+
+float (*g_min_range)(const float *, size_t) = NULL;
+boost::once_flag g_min_range_once = BOOST_ONCE_INIT;
+
+void SelectMinRange()
+{
+  g_min_range = &MinRangeDefault;
+#ifdef RANGE_CONE_X86
+  if (__builtin_cpu_supports("avx2"))
+    g_min_range = &MinRangeAVX2;
+  else if (__builtin_cpu_supports("sse2"))
+    g_min_range = &MinRangeSSE2;
+#endif
+#ifdef RANGE_CONE_NEON
+  g_min_range = &MinRangeNEON;
+#endif
+}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+RangeCone::RangeCone()
+  : radiation_type_(sensor_msgs::Range::ULTRASOUND), fov_(0.05),
+    gaussian_noise_(0)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void RangeCone::Load(sdf::ElementPtr _sdf, const std::string &_scope,
+                     const std::string &_logger)
+{
+  std::string radiation;
+  if (!_sdf->HasElement("radiation"))
+  {
+    ROS_WARN_NAMED(_logger, "Range plugin missing <radiation>, defaults to ultrasound");
+    radiation = "ultrasound";
+  }
+  else
+    radiation = _sdf->GetElement("radiation")->Get<std::string>();
+  if (radiation == std::string("ultrasound"))
+    this->radiation_type_ = sensor_msgs::Range::ULTRASOUND;
+  else
+    this->radiation_type_ = sensor_msgs::Range::INFRARED;
+
+  if (!_sdf->HasElement("fov"))
+  {
+    ROS_WARN_NAMED(_logger, "Range plugin missing <fov>, defaults to 0.05");
+    this->fov_ = 0.05;
+  }
+  else
+    this->fov_ = _sdf->GetElement("fov")->Get<double>();
+
+  if (!_sdf->HasElement("gaussianNoise"))
+  {
+    ROS_INFO_NAMED(_logger, "Range plugin missing <gaussianNoise>, defaults to 0.0");
+    this->gaussian_noise_ = 0;
+  }
+  else
+    this->gaussian_noise_ = _sdf->Get<double>("gaussianNoise");
+  this->noise_.Seed(GaussianNoise::SeedFromSdf(_sdf, _scope));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void RangeCone::Fill(const float *_ranges, size_t _n, float _range_min,
+                     float _range_max, sensor_msgs::Range &_msg)
+{
+  _msg.radiation_type = this->radiation_type_;
+  _msg.field_of_view = this->fov_;
+  _msg.max_range = _range_max;
+  _msg.min_range = _range_min;
+
+  // GPU rays that hit nothing are +inf, CPU ones _range_max
+  _msg.range = std::min(MinRange(_ranges, _n), _range_max);
+
+  // add Gaussian noise and limit to min/max range
+  if (_msg.range < _range_max)
+    _msg.range = std::min(_msg.range + this->noise_.Gaussian(0, this->gaussian_noise_),
+                          static_cast<double>(_range_max));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+float RangeCone::MinRange(const float *_ranges, size_t _n)
+{
+  boost::call_once(&SelectMinRange, g_min_range_once);
+  return g_min_range(_ranges, _n);
+}
+}
@@ -0,0 +1,339 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <limits>
+
+#include <gazebo/sensors/CameraSensor.hh>
+#include <gazebo/sensors/GpuRaySensor.hh>
+#include <gazebo/sensors/MultiCameraSensor.hh>
+
+#include <gazebo_plugins/render_scheduler.h>
+
+namespace gazebo
+{
+namespace
+{
+/// \brief Longest cycle searched for phases, in steps. Beyond it the
+/// periods are placed on the cycle of the longest one.
+const uint64_t kMaxCycle = 100000;
+
+////////////////////////////////////////////////////////////////////////////////
+uint64_t gcd(uint64_t _a, uint64_t _b)
+{
+  while (_b != 0)
+  {
+    uint64_t t = _a % _b;
+    _a = _b;
+    _b = t;
+  }
+  return _a;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+double renderCost(const sensors::SensorPtr &_sensor)
+{
+  GAZEBO_SENSORS_USING_DYNAMIC_POINTER_CAST;
+  sensors::CameraSensorPtr camera =
+    dynamic_pointer_cast<sensors::CameraSensor>(_sensor);
+  if (camera)
+    return static_cast<double>(camera->ImageWidth()) * camera->ImageHeight();
+
+  sensors::MultiCameraSensorPtr multi_camera =
+    dynamic_pointer_cast<sensors::MultiCameraSensor>(_sensor);
+  if (multi_camera && multi_camera->CameraCount() > 0)
+    return static_cast<double>(multi_camera->CameraCount()) *
+      multi_camera->ImageWidth(0) * multi_camera->ImageHeight(0);
+
+  sensors::GpuRaySensorPtr gpu_ray =
+    dynamic_pointer_cast<sensors::GpuRaySensor>(_sensor);
+  if (gpu_ray)
+    return static_cast<double>(gpu_ray->RangeCount()) *
+      std::max(gpu_ray->VerticalRangeCount(), 1);
+
+  return 1.0;
+}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+RenderScheduler &RenderScheduler::Instance()
+{
+  static RenderScheduler instance;
+  return instance;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+RenderScheduler::RenderScheduler()
+  : dirty_(false), step_size_(0.0)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool RenderScheduler::Add(const sensors::SensorPtr &_sensor)
+{
+  if (!_sensor)
+    return false;
+
+  // parked and triggered sensors have a rate of DBL_MIN, unlimited ones 0
+  double rate = _sensor->UpdateRate();
+  if (!(rate > 1e-6) || std::isinf(rate))
+    return false;
+
+  boost::mutex::scoped_lock lock(this->mutex_);
+  for (size_t i = 0; i < this->entries_.size(); ++i)
+    if (this->entries_[i].sensor.lock() == _sensor)
+      return false;
+
+  Entry entry;
+  entry.sensor = _sensor;
+  entry.rate = rate;
+  entry.cost = renderCost(_sensor);
+  entry.period = 1;
+  entry.phase = 0;
+  entry.armed = false;
+  this->entries_.push_back(entry);
+  this->dirty_ = true;
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void RenderScheduler::Remove(const sensors::SensorPtr &_sensor)
+{
+  boost::mutex::scoped_lock lock(this->mutex_);
+  for (size_t i = 0; i < this->entries_.size(); ++i)
+  {
+    if (this->entries_[i].sensor.lock() != _sensor)
+      continue;
+    Release(this->entries_[i]);
+    this->entries_.erase(this->entries_.begin() + i);
+    this->dirty_ = true;
+    return;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void RenderScheduler::Clear()
+{
+  boost::mutex::scoped_lock lock(this->mutex_);
+  for (size_t i = 0; i < this->entries_.size(); ++i)
+    Release(this->entries_[i]);
+  this->entries_.clear();
+  this->dirty_ = false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool RenderScheduler::Contains(const sensors::SensorPtr &_sensor)
+{
+  boost::mutex::scoped_lock lock(this->mutex_);
+  for (size_t i = 0; i < this->entries_.size(); ++i)
+    if (this->entries_[i].sensor.lock() == _sensor)
+      return true;
+  return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+size_t RenderScheduler::Size()
+{
+  boost::mutex::scoped_lock lock(this->mutex_);
+  return this->entries_.size();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool RenderScheduler::SetUpdateRate(const sensors::SensorPtr &_sensor,
+                                    double _rate)
+{
+  boost::mutex::scoped_lock lock(this->mutex_);
+  for (size_t i = 0; i < this->entries_.size(); ++i)
+  {
+    Entry &entry = this->entries_[i];
+    if (entry.sensor.lock() != _sensor)
+      continue;
+
+    if (!(_rate > 1e-6) || std::isinf(_rate))
+    {
+      _sensor->SetUpdateRate(_rate);
+      this->entries_.erase(this->entries_.begin() + i);
+    }
+    else
+    {
+      entry.rate = _rate;
+    }
+    this->dirty_ = true;
+    return true;
+  }
+  return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool RenderScheduler::UpdateRate(const sensors::SensorPtr &_sensor,
+                                 double &_rate)
+{
+  boost::mutex::scoped_lock lock(this->mutex_);
+  for (size_t i = 0; i < this->entries_.size(); ++i)
+  {
+    if (this->entries_[i].sensor.lock() != _sensor)
+      continue;
+    _rate = this->entries_[i].rate;
+    return true;
+  }
+  return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void RenderScheduler::Step(uint64_t _iteration, double _step_size)
+{
+  boost::mutex::scoped_lock lock(this->mutex_);
+  if (this->entries_.empty())
+    return;
+
+  if (_step_size != this->step_size_)
+  {
+    this->step_size_ = _step_size;
+    this->dirty_ = true;
+  }
+  if (this->dirty_)
+  {
+    this->Assign();
+    this->dirty_ = false;
+  }
+
+  for (size_t i = 0; i < this->entries_.size();)
+  {
+    Entry &entry = this->entries_[i];
+    if (entry.period <= 1)
+    {
+      ++i;
+      continue;
+    }
+
+    bool due = _iteration % entry.period == entry.phase;
+    if (!entry.armed && !due)
+    {
+      ++i;
+      continue;
+    }
+
+    sensors::SensorPtr sensor = entry.sensor.lock();
+    if (!sensor)
+    {
+      // the sensor was removed, the others keep their phases until the
+      // next assignment
+      this->entries_.erase(this->entries_.begin() + i);
+      this->dirty_ = true;
+      continue;
+    }
+
+    // park the sensor once it rendered
+    if (entry.armed &&
+        sensor->LastMeasurementTime() != entry.armed_measurement)
+    {
+      sensor->SetUpdateRate(DBL_MIN);
+      entry.armed = false;
+    }
+
+    // an armed sensor that has not rendered yet, because it is inactive or
+    // the render thread is behind, stays armed
+    if (due && !entry.armed)
+    {
+      entry.armed_measurement = sensor->LastMeasurementTime();
+      sensor->SetUpdateRate(2.0 * entry.rate);
+      entry.armed = true;
+    }
+    ++i;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void RenderScheduler::Assign()
+{
+  // a cycle that holds a whole number of every period, so that the load of
+  // each of its steps is the load of that step in every cycle
+  uint64_t cycle = 1;
+  uint64_t longest = 1;
+  for (size_t i = 0; i < this->entries_.size(); ++i)
+  {
+    Entry &entry = this->entries_[i];
+    double period = 1.0 / (entry.rate * this->step_size_);
+    entry.period = period < 1.0 ? 1 : static_cast<uint64_t>(std::llround(period));
+    if (entry.period <= 1)
+      continue;
+    longest = std::max(longest, entry.period);
+    if (cycle <= kMaxCycle)
+      cycle = cycle / gcd(cycle, entry.period) * entry.period;
+  }
+  if (cycle > kMaxCycle)
+    cycle = longest;
+
+  // place the most expensive sensors first, each on the phase whose
+  // busiest step is the least busy
+  std::vector<size_t> order(this->entries_.size());
+  for (size_t i = 0; i < order.size(); ++i)
+    order[i] = i;
+  std::stable_sort(order.begin(), order.end(),
+    [this](size_t _a, size_t _b)
+    {
+      return this->entries_[_a].cost > this->entries_[_b].cost;
+    });
+
+  std::vector<double> load(cycle, 0.0);
+  for (size_t n = 0; n < order.size(); ++n)
+  {
+    Entry &entry = this->entries_[order[n]];
+    sensors::SensorPtr sensor = entry.sensor.lock();
+    if (!sensor)
+      continue;
+
+    if (entry.period <= 1)
+    {
+      // staggering needs at least two steps per period
+      Release(entry);
+      entry.armed = false;
+      continue;
+    }
+
+    uint64_t best_phase = 0;
+    double best_peak = std::numeric_limits<double>::infinity();
+    for (uint64_t phase = 0; phase < entry.period; ++phase)
+    {
+      double peak = 0.0;
+      for (uint64_t step = phase; step < cycle; step += entry.period)
+        peak = std::max(peak, load[step]);
+      if (peak < best_peak)
+      {
+        best_peak = peak;
+        best_phase = phase;
+      }
+    }
+    for (uint64_t step = best_phase; step < cycle; step += entry.period)
+      load[step] += entry.cost;
+
+    entry.phase = best_phase;
+    if (!entry.armed)
+      sensor->SetUpdateRate(DBL_MIN);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void RenderScheduler::Release(const Entry &_entry)
+{
+  sensors::SensorPtr sensor = _entry.sensor.lock();
+  if (sensor)
+    sensor->SetUpdateRate(_entry.rate);
+}
+}
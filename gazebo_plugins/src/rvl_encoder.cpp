@@ -0,0 +1,161 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <cstring>
+
+#include <gazebo_plugins/rvl_encoder.h>
+
+namespace gazebo
+{
+namespace
+{
+/// \brief Packs nibbles into words, first nibble in the high bits
+class NibbleWriter
+{
+  public: explicit NibbleWriter(std::vector<uint32_t> &_words)
+    : words_(_words), word_(0), count_(0) {}
+
+  public: void Nibble(uint32_t _nibble)
+  {
+    this->word_ = (this->word_ << 4) | _nibble;
+    if (++this->count_ == 8)
+    {
+      this->words_.push_back(this->word_);
+      this->word_ = 0;
+      this->count_ = 0;
+    }
+  }
+
+  public: void Word(uint32_t _word)
+  {
+    if (this->count_ == 0)
+    {
+      this->words_.push_back(_word);
+      return;
+    }
+    // the count_ pending nibbles, then the 8 of _word
+    uint64_t joined = (static_cast<uint64_t>(this->word_) << 32) | _word;
+    this->words_.push_back(static_cast<uint32_t>(joined >> (4 * this->count_)));
+    this->word_ = static_cast<uint32_t>(
+      joined & ((static_cast<uint64_t>(1) << (4 * this->count_)) - 1));
+  }
+
+  public: void Flush()
+  {
+    if (this->count_ == 0)
+      return;
+    this->words_.push_back(this->word_ << (4 * (8 - this->count_)));
+    this->word_ = 0;
+    this->count_ = 0;
+  }
+
+  private: std::vector<uint32_t> &words_;
+  private: uint32_t word_;
+  private: size_t count_;
+};
+}
+
+////////////////////////////////////////////////////////////////////////////////
+RvlEncoder::RvlEncoder(uint16_t _previous)
+  : word_(0), nibbles_(0), previous_(_previous)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void RvlEncoder::EncodeVLE(uint32_t _value)
+{
+  do
+  {
+    uint32_t nibble = _value & 0x7;
+    _value >>= 3;
+    if (_value)
+      nibble |= 0x8;
+    this->word_ = (this->word_ << 4) | nibble;
+    if (++this->nibbles_ % 8 == 0)
+    {
+      this->words_.push_back(this->word_);
+      this->word_ = 0;
+    }
+  }
+  while (_value);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void RvlEncoder::Encode(const uint16_t *_depth, size_t _n)
+{
+  const uint16_t *end = _depth + _n;
+  while (_depth != end)
+  {
+    uint32_t zeros = 0;
+    for (; _depth != end && !*_depth; ++_depth)
+      ++zeros;
+    this->EncodeVLE(zeros);
+
+    uint32_t nonzeros = 0;
+    for (const uint16_t *p = _depth; p != end && *p; ++p)
+      ++nonzeros;
+    this->EncodeVLE(nonzeros);
+
+    for (uint32_t i = 0; i < nonzeros; ++i, ++_depth)
+    {
+      int32_t delta = static_cast<int32_t>(*_depth) - this->previous_;
+      // zigzag, small differences of either sign get short codes
+      this->EncodeVLE(static_cast<uint32_t>((delta << 1) ^ (delta >> 31)));
+      this->previous_ = *_depth;
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+size_t RvlEncoder::Nibbles() const
+{
+  return this->nibbles_;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+uint16_t RvlEncoder::Previous() const
+{
+  return this->previous_;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void RvlEncoder::Join(const std::vector<const RvlEncoder *> &_encoders,
+                      std::vector<uint8_t> &_out, size_t _offset)
+{
+  size_t nibbles = 0;
+  for (size_t i = 0; i < _encoders.size(); ++i)
+    nibbles += _encoders[i]->nibbles_;
+
+  std::vector<uint32_t> words;
+  words.reserve((nibbles + 7) / 8);
+  NibbleWriter writer(words);
+  for (size_t i = 0; i < _encoders.size(); ++i)
+  {
+    const RvlEncoder &encoder = *_encoders[i];
+    for (size_t w = 0; w < encoder.words_.size(); ++w)
+      writer.Word(encoder.words_[w]);
+    for (size_t k = encoder.nibbles_ % 8; k > 0; --k)
+      writer.Nibble((encoder.word_ >> (4 * (k - 1))) & 0xF);
+  }
+  writer.Flush();
+
+  // decoders read the words in host byte order
+  _out.resize(_offset + words.size() * sizeof(uint32_t));
+  if (!words.empty())
+    memcpy(&_out[_offset], &words[0], words.size() * sizeof(uint32_t));
+}
+}
@@ -0,0 +1,43 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gazebo_plugins/sensor_lod.h>
+
+namespace gazebo
+{
+////////////////////////////////////////////////////////////////////////////////
+SensorLod &SensorLod::Instance()
+{
+  static SensorLod instance;
+  return instance;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+SensorLod::SensorLod()
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+SensorLod::Factor SensorLod::Decimation(const std::string &_sensor)
+{
+  boost::mutex::scoped_lock lock(this->mutex_);
+  Factor &factor = this->decimation_[_sensor];
+  if (!factor)
+    factor.reset(new std::atomic<unsigned int>(1));
+  return factor;
+}
+}
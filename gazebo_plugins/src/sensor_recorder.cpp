@@ -0,0 +1,728 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include <boost/bind.hpp>
+
+#include <bzlib.h>
+
+#include <gazebo_plugins/sensor_recorder.h>
+#include <gazebo_ros/thread_policy.h>
+
+namespace gazebo
+{
+namespace
+{
+// rosbag 2.0 op codes
+const uint8_t kOpMessageData = 0x02;
+const uint8_t kOpBagHeader = 0x03;
+const uint8_t kOpIndexData = 0x04;
+const uint8_t kOpChunk = 0x05;
+const uint8_t kOpChunkInfo = 0x06;
+const uint8_t kOpConnection = 0x07;
+
+const char kVersion[] = "#ROSBAG V2.0\n";
+const size_t kVersionLength = sizeof(kVersion) - 1;
+
+// the bag header record is padded to this size, so that it can be rewritten
+// in place once the index position is known
+const uint32_t kBagHeaderLength = 4096;
+
+// the only chunk of a file follows the padded bag header record
+const size_t kChunkPos = kVersionLength + 4 + kBagHeaderLength + 4;
+
+// length of the header of a message data record: op, conn and time fields
+const uint32_t kMessageHeaderLength = (4 + 3 + 1) + (4 + 5 + 4) + (4 + 5 + 8);
+
+////////////////////////////////////////////////////////////////////////////////
+uint8_t *PutUint32(uint8_t *_p, uint32_t _v)
+{
+  memcpy(_p, &_v, 4);
+  return _p + 4;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Write a name=value header field
+uint8_t *PutField(uint8_t *_p, const char *_name, const void *_value,
+                  uint32_t _size)
+{
+  uint32_t name_len = strlen(_name);
+  _p = PutUint32(_p, name_len + 1 + _size);
+  memcpy(_p, _name, name_len);
+  _p += name_len;
+  *_p++ = '=';
+  memcpy(_p, _value, _size);
+  return _p + _size;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void AppendField(std::vector<uint8_t> &_buf, const char *_name,
+                 const void *_value, uint32_t _size)
+{
+  size_t old = _buf.size();
+  _buf.resize(old + 4 + strlen(_name) + 1 + _size);
+  PutField(&_buf[old], _name, _value, _size);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void AppendString(std::vector<uint8_t> &_buf, const char *_name,
+                  const std::string &_value)
+{
+  AppendField(_buf, _name, _value.data(), _value.size());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+template<class T>
+void AppendValue(std::vector<uint8_t> &_buf, const char *_name, T _value)
+{
+  AppendField(_buf, _name, &_value, sizeof(T));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Append a record made of a header and data
+void AppendRecord(std::vector<uint8_t> &_out,
+                  const std::vector<uint8_t> &_header,
+                  const uint8_t *_data, uint32_t _len)
+{
+  size_t old = _out.size();
+  _out.resize(old + 4 + _header.size() + 4 + _len);
+  uint8_t *p = PutUint32(&_out[old], _header.size());
+  if (!_header.empty())
+    memcpy(p, &_header[0], _header.size());
+  p = PutUint32(p + _header.size(), _len);
+  if (_len)
+    memcpy(p, _data, _len);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// rosbag stores a time as 32 bit seconds followed by 32 bit nanoseconds
+uint64_t PackTime(const ros::Time &_t)
+{
+  return static_cast<uint64_t>(_t.sec) |
+         (static_cast<uint64_t>(_t.nsec) << 32);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Header of the chunk record
+std::vector<uint8_t> ChunkHeader(const std::string &_compression,
+                                 uint32_t _size)
+{
+  std::vector<uint8_t> header;
+  AppendValue(header, "op", kOpChunk);
+  AppendString(header, "compression", _compression);
+  AppendValue(header, "size", _size);
+  return header;
+}
+
+// the data of an uncompressed chunk starts here, the longest chunk header
+const size_t kDataBegin = kChunkPos + 4 + ChunkHeader("none", 0).size() + 4;
+}
+
+/// \brief A memory mapped chunk file.
+struct SensorRecorder::Chunk
+{
+  /// \brief An index entry of a message.
+  struct Entry
+  {
+    uint32_t conn;
+    ros::Time time;
+    uint32_t offset;
+  };
+
+  std::string path;
+  int fd;
+  uint8_t *map;
+  size_t map_size;
+
+  /// \brief Bytes of chunk data written at map + kDataBegin.
+  size_t used;
+
+  /// \brief Messages reserved but not serialized yet.
+  std::atomic<int> writers;
+
+  /// \brief Connections written into the chunk, in order.
+  std::vector<const Connection *> conns;
+
+  /// \brief conn_written[id] is true if conns holds connection id.
+  std::vector<bool> conn_written;
+
+  std::vector<Entry> index;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+SensorRecorder::Options::Options()
+  : prefix("sensors"), chunk_size(64 << 20), chunk_count(4),
+    compression(COMPRESSION_NONE), threads(2)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+SensorRecorder &SensorRecorder::Instance()
+{
+  // intentionally leaked, the sources may not outlive it, see
+  // SharedCallbackExecutor::Instance()
+  static SensorRecorder *recorder = new SensorRecorder;
+  return *recorder;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+SensorRecorder::SensorRecorder()
+  : current_(NULL), finishing_(0), next_seq_(0), stop_(false),
+    next_source_(0), recording_(false), recorded_(0), dropped_(0),
+    chunks_written_(0)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool SensorRecorder::Start(const Options &_options)
+{
+  {
+    boost::mutex::scoped_lock lock(this->mutex_);
+    if (this->recording_)
+      return false;
+
+    this->options_ = _options;
+    this->options_.chunk_count = std::max<size_t>(this->options_.chunk_count, 2);
+    this->options_.threads = std::max<size_t>(this->options_.threads, 1);
+    // at least 1 MB, a chunk should hold many messages
+    this->options_.chunk_size = std::max<size_t>(this->options_.chunk_size,
+                                                 1 << 20);
+    this->connections_.clear();
+    this->next_seq_ = 0;
+    this->stop_ = false;
+    this->recorded_ = 0;
+    this->dropped_ = 0;
+    this->chunks_written_ = 0;
+
+    for (size_t i = 0; i < this->options_.chunk_count; ++i)
+    {
+      Chunk *chunk = this->OpenChunk(this->next_seq_++);
+      if (!chunk)
+      {
+        while (!this->free_.empty())
+        {
+          DiscardChunk(this->free_.front());
+          this->free_.pop_front();
+        }
+        return false;
+      }
+      this->free_.push_back(chunk);
+    }
+
+    for (size_t i = 0; i < this->options_.threads; ++i)
+      this->threads_.create_thread(boost::bind(&SensorRecorder::Work, this));
+
+    this->recording_ = true;
+  }
+
+  ROS_INFO_NAMED("sensor_recorder", "Recording to %s_*.bag in %lu MB chunks",
+    this->options_.prefix.c_str(),
+    static_cast<unsigned long>(this->options_.chunk_size >> 20));
+  this->NotifySources(true);
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void SensorRecorder::Stop()
+{
+  {
+    boost::mutex::scoped_lock lock(this->mutex_);
+    if (!this->recording_)
+      return;
+    this->recording_ = false;
+
+    this->SealCurrent();
+    while (!this->sealed_.empty() || this->finishing_ > 0)
+      this->cond_.wait(lock);
+    this->stop_ = true;
+    this->cond_.notify_all();
+  }
+  this->threads_.join_all();
+
+  {
+    boost::mutex::scoped_lock lock(this->mutex_);
+    if (this->current_)
+      this->free_.push_back(this->current_);
+    this->current_ = NULL;
+    while (!this->free_.empty())
+    {
+      DiscardChunk(this->free_.front());
+      this->free_.pop_front();
+    }
+  }
+
+  ROS_INFO_NAMED("sensor_recorder", "Recorded %lu messages in %lu chunks, "
+    "dropped %lu", this->Recorded(), this->ChunksWritten(), this->Dropped());
+  this->NotifySources(false);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool SensorRecorder::Recording() const
+{
+  return this->recording_.load(std::memory_order_relaxed);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool SensorRecorder::Wants(const std::string &_topic) const
+{
+  boost::mutex::scoped_lock lock(this->mutex_);
+  return this->WantsLocked(_topic);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool SensorRecorder::WantsLocked(const std::string &_topic) const
+{
+  if (this->options_.topics.empty())
+    return true;
+  for (size_t i = 0; i < this->options_.topics.size(); ++i)
+  {
+    const std::string &t = this->options_.topics[i];
+    if (!t.empty() && t[t.size() - 1] == '*')
+    {
+      if (_topic.compare(0, t.size() - 1, t, 0, t.size() - 1) == 0)
+        return true;
+    }
+    else if (t == _topic)
+      return true;
+  }
+  return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int SensorRecorder::AddSource(const std::string &_topic,
+                              const boost::function<void()> &_connect,
+                              const boost::function<void()> &_disconnect)
+{
+  boost::mutex::scoped_lock lock(this->sources_mutex_);
+  int id = this->next_source_++;
+  Source &source = this->sources_[id];
+  source.topic = _topic;
+  source.connect = _connect;
+  source.disconnect = _disconnect;
+  source.connected = this->Recording() && this->Wants(_topic);
+  if (source.connected)
+    source.connect();
+  return id;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void SensorRecorder::RemoveSource(int _source)
+{
+  boost::mutex::scoped_lock lock(this->sources_mutex_);
+  std::map<int, Source>::iterator it = this->sources_.find(_source);
+  if (it == this->sources_.end())
+    return;
+  if (it->second.connected)
+    it->second.disconnect();
+  this->sources_.erase(it);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void SensorRecorder::NotifySources(bool _recording)
+{
+  boost::mutex::scoped_lock lock(this->sources_mutex_);
+  for (std::map<int, Source>::iterator it = this->sources_.begin();
+       it != this->sources_.end(); ++it)
+  {
+    Source &source = it->second;
+    if (_recording && !source.connected && this->Wants(source.topic))
+    {
+      source.connected = true;
+      source.connect();
+    }
+    else if (!_recording && source.connected)
+    {
+      source.connected = false;
+      source.disconnect();
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+unsigned long SensorRecorder::Recorded() const
+{
+  return this->recorded_.load(std::memory_order_relaxed);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+unsigned long SensorRecorder::Dropped() const
+{
+  return this->dropped_.load(std::memory_order_relaxed);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+unsigned long SensorRecorder::ChunksWritten() const
+{
+  return this->chunks_written_.load(std::memory_order_relaxed);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+SensorRecorder::Reservation SensorRecorder::Reserve(const std::string &_topic,
+    const std::string &_type, const std::string &_md5sum,
+    const std::string &_definition, uint32_t _len)
+{
+  Reservation r;
+  r.data = NULL;
+  r.chunk = NULL;
+
+  boost::mutex::scoped_lock lock(this->mutex_);
+  if (!this->recording_)
+    return r;
+
+  std::map<std::string, Connection>::iterator it =
+    this->connections_.find(_topic);
+  if (it == this->connections_.end())
+  {
+    Connection conn;
+    conn.id = this->connections_.size();
+    conn.topic = _topic;
+    conn.wanted = this->WantsLocked(_topic);
+
+    std::vector<uint8_t> header;
+    AppendValue(header, "op", kOpConnection);
+    AppendValue(header, "conn", conn.id);
+    AppendString(header, "topic", _topic);
+    std::vector<uint8_t> data;
+    AppendString(data, "topic", _topic);
+    AppendString(data, "type", _type);
+    AppendString(data, "md5sum", _md5sum);
+    AppendString(data, "message_definition", _definition);
+    AppendRecord(conn.record, header, data.empty() ? NULL : &data[0],
+                 data.size());
+
+    it = this->connections_.insert(std::make_pair(_topic, conn)).first;
+  }
+  const Connection &conn = it->second;
+  if (!conn.wanted)
+    return r;
+
+  size_t record_size = 4 + kMessageHeaderLength + 4 + _len;
+  if (record_size + conn.record.size() > this->options_.chunk_size)
+  {
+    ROS_WARN_ONCE_NAMED("sensor_recorder", "A message on [%s] does not fit "
+      "a chunk, increase <chunkSize>", _topic.c_str());
+    ++this->dropped_;
+    return r;
+  }
+
+  Chunk *chunk = this->current_;
+  if (chunk)
+  {
+    size_t needed = record_size;
+    if (conn.id >= chunk->conn_written.size() || !chunk->conn_written[conn.id])
+      needed += conn.record.size();
+    if (chunk->used + needed > this->options_.chunk_size)
+      this->SealCurrent();
+  }
+  if (!this->current_)
+  {
+    if (this->free_.empty())
+    {
+      // the background threads are behind, never stall the simulation
+      ++this->dropped_;
+      return r;
+    }
+    this->current_ = this->free_.front();
+    this->free_.pop_front();
+  }
+  chunk = this->current_;
+
+  if (conn.id >= chunk->conn_written.size())
+    chunk->conn_written.resize(conn.id + 1, false);
+  if (!chunk->conn_written[conn.id])
+    this->WriteConnection(chunk, conn);
+
+  Chunk::Entry entry;
+  entry.conn = conn.id;
+  entry.time = ros::Time::now();
+  entry.offset = chunk->used;
+  chunk->index.push_back(entry);
+
+  uint8_t *p = chunk->map + kDataBegin + chunk->used;
+  uint64_t time = PackTime(entry.time);
+  p = PutUint32(p, kMessageHeaderLength);
+  p = PutField(p, "op", &kOpMessageData, 1);
+  p = PutField(p, "conn", &conn.id, 4);
+  p = PutField(p, "time", &time, 8);
+  p = PutUint32(p, _len);
+  chunk->used += record_size;
+
+  ++chunk->writers;
+  ++this->recorded_;
+  r.data = p;
+  r.chunk = chunk;
+  return r;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void SensorRecorder::Commit(const Reservation &_reservation)
+{
+  _reservation.chunk->writers.fetch_sub(1, std::memory_order_release);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void SensorRecorder::WriteConnection(Chunk *_chunk, const Connection &_conn)
+{
+  memcpy(_chunk->map + kDataBegin + _chunk->used, &_conn.record[0],
+         _conn.record.size());
+  _chunk->used += _conn.record.size();
+  _chunk->conn_written[_conn.id] = true;
+  _chunk->conns.push_back(&_conn);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void SensorRecorder::SealCurrent()
+{
+  if (!this->current_ || this->current_->index.empty())
+    return;
+  this->sealed_.push_back(this->current_);
+  this->current_ = NULL;
+  this->cond_.notify_all();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+SensorRecorder::Chunk *SensorRecorder::OpenChunk(unsigned int _seq)
+{
+  char name[32];
+  snprintf(name, sizeof(name), "_%06u.bag", _seq);
+  std::string path = this->options_.prefix + name;
+
+  int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0)
+  {
+    ROS_ERROR_NAMED("sensor_recorder", "Unable to create [%s]: %s",
+      path.c_str(), strerror(errno));
+    return NULL;
+  }
+
+  // allocate the blocks now rather than on the first page fault
+  size_t size = kDataBegin + this->options_.chunk_size;
+  if (posix_fallocate(fd, 0, size) != 0 && ftruncate(fd, size) != 0)
+  {
+    ROS_ERROR_NAMED("sensor_recorder", "Unable to allocate %lu bytes for "
+      "[%s]: %s", static_cast<unsigned long>(size), path.c_str(),
+      strerror(errno));
+    close(fd);
+    unlink(path.c_str());
+    return NULL;
+  }
+
+  void *map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (map == MAP_FAILED)
+  {
+    ROS_ERROR_NAMED("sensor_recorder", "Unable to map [%s]: %s",
+      path.c_str(), strerror(errno));
+    close(fd);
+    unlink(path.c_str());
+    return NULL;
+  }
+  madvise(map, size, MADV_SEQUENTIAL);
+
+  Chunk *chunk = new Chunk;
+  chunk->path = path;
+  chunk->fd = fd;
+  chunk->map = static_cast<uint8_t *>(map);
+  chunk->map_size = size;
+  chunk->used = 0;
+  chunk->writers = 0;
+  chunk->index.reserve(4096);
+  return chunk;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void SensorRecorder::DiscardChunk(Chunk *_chunk)
+{
+  munmap(_chunk->map, _chunk->map_size);
+  close(_chunk->fd);
+  unlink(_chunk->path.c_str());
+  delete _chunk;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void SensorRecorder::Work()
+{
+  ThreadPolicy::instance().apply("io", "gzros_recorder");
+  for (;;)
+  {
+    Chunk *chunk = NULL;
+    {
+      boost::mutex::scoped_lock lock(this->mutex_);
+      while (!this->stop_ && this->sealed_.empty())
+        this->cond_.wait(lock);
+      if (this->sealed_.empty())
+        return;
+      chunk = this->sealed_.front();
+      this->sealed_.pop_front();
+      ++this->finishing_;
+    }
+
+    this->Finish(chunk);
+
+    // map a replacement while the recording threads fill the others
+    Chunk *next = NULL;
+    unsigned int seq = 0;
+    bool refill = false;
+    {
+      boost::mutex::scoped_lock lock(this->mutex_);
+      refill = this->recording_;
+      if (refill)
+        seq = this->next_seq_++;
+    }
+    if (refill)
+      next = this->OpenChunk(seq);
+
+    boost::mutex::scoped_lock lock(this->mutex_);
+    if (next)
+    {
+      if (this->recording_)
+        this->free_.push_back(next);
+      else
+        DiscardChunk(next);
+    }
+    --this->finishing_;
+    ++this->chunks_written_;
+    this->cond_.notify_all();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void SensorRecorder::Finish(Chunk *_chunk)
+{
+  // messages reserved before the chunk was sealed may still be serialized
+  while (_chunk->writers.load(std::memory_order_acquire) > 0)
+    boost::this_thread::yield();
+
+  uint8_t *data = _chunk->map + kDataBegin;
+  uint32_t used = _chunk->used;
+
+  // compress into a scratch buffer, then move it right behind the (one byte
+  // shorter) bz2 chunk header
+  std::vector<uint8_t> header = ChunkHeader("none", used);
+  uint32_t data_len = used;
+  if (this->options_.compression == COMPRESSION_BZ2)
+  {
+    std::vector<char> compressed(used + used / 100 + 600);
+    unsigned int compressed_len = compressed.size();
+    int rc = BZ2_bzBuffToBuffCompress(&compressed[0], &compressed_len,
+        reinterpret_cast<char *>(data), used, 9, 0, 30);
+    if (rc == BZ_OK && compressed_len < used)
+    {
+      header = ChunkHeader("bz2", used);
+      data_len = compressed_len;
+      memcpy(_chunk->map + kChunkPos + 4 + header.size() + 4, &compressed[0],
+             compressed_len);
+    }
+    else
+    {
+      ROS_WARN_NAMED("sensor_recorder", "Storing [%s] uncompressed",
+        _chunk->path.c_str());
+    }
+  }
+  uint8_t *p = PutUint32(_chunk->map + kChunkPos, header.size());
+  memcpy(p, &header[0], header.size());
+  PutUint32(p + header.size(), data_len);
+  size_t data_end = kChunkPos + 4 + header.size() + 4 + data_len;
+
+  // index data records of each connection, then the index section:
+  // connection records and the chunk info record
+  std::vector<uint8_t> tail;
+  std::vector<uint8_t> info_data;
+  ros::Time start_time = _chunk->index.front().time;
+  ros::Time end_time = start_time;
+  for (size_t c = 0; c < _chunk->conns.size(); ++c)
+  {
+    uint32_t id = _chunk->conns[c]->id;
+    std::vector<uint8_t> entries;
+    for (size_t i = 0; i < _chunk->index.size(); ++i)
+    {
+      const Chunk::Entry &e = _chunk->index[i];
+      if (e.conn != id)
+        continue;
+      start_time = std::min(start_time, e.time);
+      end_time = std::max(end_time, e.time);
+      size_t old = entries.size();
+      entries.resize(old + 12);
+      uint64_t time = PackTime(e.time);
+      memcpy(&entries[old], &time, 8);
+      PutUint32(&entries[old + 8], e.offset);
+    }
+    uint32_t count = entries.size() / 12;
+    std::vector<uint8_t> index_header;
+    AppendValue(index_header, "op", kOpIndexData);
+    AppendValue(index_header, "ver", static_cast<uint32_t>(1));
+    AppendValue(index_header, "conn", id);
+    AppendValue(index_header, "count", count);
+    AppendRecord(tail, index_header, entries.empty() ? NULL : &entries[0],
+                 entries.size());
+
+    size_t old = info_data.size();
+    info_data.resize(old + 8);
+    PutUint32(PutUint32(&info_data[old], id), count);
+  }
+
+  uint64_t index_pos = data_end + tail.size();
+  for (size_t c = 0; c < _chunk->conns.size(); ++c)
+  {
+    const std::vector<uint8_t> &record = _chunk->conns[c]->record;
+    tail.insert(tail.end(), record.begin(), record.end());
+  }
+
+  std::vector<uint8_t> info_header;
+  AppendValue(info_header, "op", kOpChunkInfo);
+  AppendValue(info_header, "ver", static_cast<uint32_t>(1));
+  AppendValue(info_header, "chunk_pos", static_cast<uint64_t>(kChunkPos));
+  AppendValue(info_header, "start_time", PackTime(start_time));
+  AppendValue(info_header, "end_time", PackTime(end_time));
+  AppendValue(info_header, "count",
+              static_cast<uint32_t>(_chunk->conns.size()));
+  AppendRecord(tail, info_header, &info_data[0], info_data.size());
+
+  // the bag header, padded with spaces like rosbag does
+  std::vector<uint8_t> bag_header;
+  AppendValue(bag_header, "op", kOpBagHeader);
+  AppendValue(bag_header, "index_pos", index_pos);
+  AppendValue(bag_header, "conn_count",
+              static_cast<uint32_t>(_chunk->conns.size()));
+  AppendValue(bag_header, "chunk_count", static_cast<uint32_t>(1));
+  memcpy(_chunk->map, kVersion, kVersionLength);
+  p = PutUint32(_chunk->map + kVersionLength, bag_header.size());
+  memcpy(p, &bag_header[0], bag_header.size());
+  p += bag_header.size();
+  uint32_t padding = kBagHeaderLength - bag_header.size();
+  p = PutUint32(p, padding);
+  memset(p, ' ', padding);
+
+  munmap(_chunk->map, _chunk->map_size);
+  if (pwrite(_chunk->fd, &tail[0], tail.size(), data_end) !=
+        static_cast<ssize_t>(tail.size()) ||
+      ftruncate(_chunk->fd, data_end + tail.size()) != 0)
+  {
+    ROS_ERROR_NAMED("sensor_recorder", "Unable to write the index of [%s]: %s",
+      _chunk->path.c_str(), strerror(errno));
+  }
+  close(_chunk->fd);
+  delete _chunk;
+}
+}
@@ -0,0 +1,228 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+
+#include <boost/bind.hpp>
+
+#include <gazebo_plugins/shared_callback_executor.h>
+#include <gazebo_ros/thread_policy.h>
+
+namespace gazebo
+{
+////////////////////////////////////////////////////////////////////////////////
+SharedCallbackExecutor &SharedCallbackExecutor::Instance()
+{
+  static SharedCallbackExecutor *executor = NULL;
+  static boost::mutex instance_mutex;
+
+  boost::mutex::scoped_lock lock(instance_mutex);
+  if (!executor)
+  {
+    int threads = 2;
+    int max_threads = 0;
+    if (ros::isInitialized())
+    {
+      ros::param::param<int>("gazebo/shared_callback_threads", threads, 2);
+      ros::param::param<int>("gazebo/shared_callback_max_threads",
+                             max_threads, 0);
+      // no-op if gazebo_ros_api_plugin read it already
+      ThreadPolicy::instance().configure("gazebo/thread_policy");
+    }
+    // intentionally leaked: plugins may still be unloading during static
+    // destruction, the process is going away anyway
+    executor = new SharedCallbackExecutor(std::max(threads, 1),
+                                          std::max(max_threads, 0));
+  }
+  return *executor;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+SharedCallbackExecutor::SharedCallbackExecutor(size_t _threads,
+                                               size_t _max_threads)
+  : stop_(false), idle_(0), queue_count_(0), max_threads_(_max_threads)
+{
+  if (this->max_threads_ > 0)
+    _threads = std::min(_threads, this->max_threads_);
+  ROS_INFO_NAMED("shared_callback_executor",
+                 "Starting shared callback executor with %lu threads",
+                 static_cast<unsigned long>(_threads));
+  for (size_t i = 0; i < _threads; ++i)
+    this->workers_.create_thread(
+      boost::bind(&SharedCallbackExecutor::Worker, this));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+SharedCallbackExecutor::~SharedCallbackExecutor()
+{
+  {
+    boost::mutex::scoped_lock lock(this->mutex_);
+    this->stop_ = true;
+  }
+  this->ready_cond_.notify_all();
+  this->workers_.join_all();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+size_t SharedCallbackExecutor::ThreadCount() const
+{
+  return this->workers_.size();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void SharedCallbackExecutor::Register()
+{
+  boost::mutex::scoped_lock lock(this->mutex_);
+  this->queue_count_++;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void SharedCallbackExecutor::Unregister()
+{
+  boost::mutex::scoped_lock lock(this->mutex_);
+  this->queue_count_--;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void SharedCallbackExecutor::Grow()
+{
+  const size_t limit = this->max_threads_ > 0 ?
+    this->max_threads_ : this->queue_count_;
+  if (this->idle_ > 0 || this->stop_ || this->workers_.size() >= limit)
+    return;
+  ROS_DEBUG_NAMED("shared_callback_executor", "All %lu callback threads are "
+    "busy, starting another one", static_cast<unsigned long>(
+    this->workers_.size()));
+  // the new worker waits for mutex_, which we hold, before it looks at ready_
+  this->workers_.create_thread(
+    boost::bind(&SharedCallbackExecutor::Worker, this));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void SharedCallbackExecutor::Schedule(SharedCallbackQueue *_queue)
+{
+  {
+    boost::mutex::scoped_lock lock(this->mutex_);
+    if (_queue->scheduled_ || _queue->stopped_)
+      return;
+    _queue->scheduled_ = true;
+    this->ready_.push_back(_queue);
+    this->Grow();
+  }
+  this->ready_cond_.notify_one();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void SharedCallbackExecutor::Cancel(SharedCallbackQueue *_queue)
+{
+  boost::mutex::scoped_lock lock(this->mutex_);
+  _queue->stopped_ = true;
+  this->ready_.erase(
+    std::remove(this->ready_.begin(), this->ready_.end(), _queue),
+    this->ready_.end());
+  while (this->running_.count(_queue))
+    this->idle_cond_.wait(lock);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void SharedCallbackExecutor::Worker()
+{
+  ThreadPolicy::instance().apply("callbacks", "gzros_callback");
+  boost::mutex::scoped_lock lock(this->mutex_);
+  while (true)
+  {
+    this->idle_++;
+    while (this->ready_.empty() && !this->stop_)
+      this->ready_cond_.wait(lock);
+    this->idle_--;
+    if (this->stop_)
+      return;
+
+    SharedCallbackQueue *queue = this->ready_.front();
+    this->ready_.pop_front();
+    this->running_.insert(queue);
+
+    lock.unlock();
+    queue->callAvailable(ros::WallDuration());
+    lock.lock();
+
+    this->running_.erase(queue);
+    // a callback added while we were running left scheduled_ set without
+    // queueing again, pick it up now
+    if (!queue->stopped_ && queue->isEnabled() && !queue->isEmpty())
+    {
+      this->ready_.push_back(queue);
+      this->Grow();
+    }
+    else
+      queue->scheduled_ = false;
+    this->idle_cond_.notify_all();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+SharedCallbackQueue::SharedCallbackQueue(bool _dedicated)
+  : executor_(SharedCallbackExecutor::Instance()),
+    dedicated_(_dedicated), scheduled_(false), stopped_(false),
+    spinning_(_dedicated)
+{
+  if (_dedicated)
+    this->thread_ = boost::thread(boost::bind(&SharedCallbackQueue::Spin, this));
+  else
+    this->executor_.Register();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+SharedCallbackQueue::~SharedCallbackQueue()
+{
+  this->Stop();
+  if (!this->dedicated_)
+    this->executor_.Unregister();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void SharedCallbackQueue::addCallback(
+  const ros::CallbackInterfacePtr &_callback, uint64_t _owner_id)
+{
+  ros::CallbackQueue::addCallback(_callback, _owner_id);
+  if (!this->dedicated_)
+    this->executor_.Schedule(this);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void SharedCallbackQueue::Stop()
+{
+  if (this->dedicated_)
+  {
+    this->spinning_ = false;
+    if (this->thread_.joinable())
+      this->thread_.join();
+    return;
+  }
+  this->executor_.Cancel(this);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Block in callAvailable() until a callback arrives, the timeout only bounds
+// how long Stop() waits
+void SharedCallbackQueue::Spin()
+{
+  ThreadPolicy::instance().apply("callbacks", "gzros_callback");
+  while (this->spinning_)
+    this->callAvailable(ros::WallDuration(0.1));
+}
+}
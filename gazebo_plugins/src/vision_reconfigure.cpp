@@ -33,38 +33,98 @@
 *********************************************************************/
 
 #include <gazebo_plugins/vision_reconfigure.h>
+#include <gazebo_ros/thread_policy.h>
 
-VisionReconfigure::VisionReconfigure() : nh_("")
-{
-  this->nh_.setCallbackQueue(&this->queue_);
+#include <algorithm>
 
-  // Custom Callback Queue
-  this->callback_queue_thread_ = boost::thread( boost::bind( &VisionReconfigure::QueueThread,this ) );
+namespace
+{
+int gcd(int a, int b)
+{
+  while (b != 0)
+  {
+    const int r = a % b;
+    a = b;
+    b = r;
+  }
+  return a;
+}
+}
 
+VisionReconfigure::VisionReconfigure() : nh_(""), projector_on_(false), slot_(0), slot_step_(1)
+{
   // this code needs to be rewritten
   // for now, it publishes on pub_projector_ which is used by gazebo_ros_projector plugin directly
   //          and it publishes pub_header_, which is published by projector_controller in ethercat_trigger_controllers package in real life
   this->pub_projector_ = this->nh_.advertise<std_msgs::Int32>("/projector_wg6802418_controller/projector", 1,true); // publish latched for sim
   this->pub_header_ = this->nh_.advertise<std_msgs::Header>("/projector_controller/rising_edge_timestamps", 1,true); // publish latched for sim
+
+  // trigger topics of the cameras, in the order of the trigger modes handled by ReconfigureCallback
+  std::vector<std::string> topics;
+  topics.push_back("/wide_stereo/left/image_trigger");
+  topics.push_back("/wide_stereo/right/image_trigger");
+  this->AddCamera("wide_stereo", topics);
+  topics.clear();
+  topics.push_back("/narrow_stereo/left/image_trigger");
+  topics.push_back("/narrow_stereo/right/image_trigger");
+  this->AddCamera("narrow_stereo", topics);
+  this->AddCamera("forearm_r", std::vector<std::string>(1, "/r_forearm_cam/image_trigger"));
+  this->AddCamera("forearm_l", std::vector<std::string>(1, "/l_forearm_cam/image_trigger"));
+
+  // the timer is started by ReconfigureCallback when something needs triggering
+  this->trigger_timer_ = this->nh_.createTimer(ros::Duration(1.0),
+      &VisionReconfigure::TriggerTimer, this, false, false);
+
   dynamic_reconfigure::Server<gazebo_plugins::CameraSynchronizerConfig>::CallbackType f = boost::bind(&VisionReconfigure::ReconfigureCallback, this, _1, _2);
   this->srv_.setCallback(f);
 
 
   // initialize from relevant params on server
   gazebo_plugins::CameraSynchronizerConfig config;
+  this->srv_.getConfigDefault(config);
   this->nh_.getParam("/camera_synchronizer_node/projector_mode",config.projector_mode);
   this->nh_.getParam("/camera_synchronizer_node/forearm_l_trig_mode",config.forearm_l_trig_mode);
   this->nh_.getParam("/camera_synchronizer_node/forearm_r_trig_mode",config.forearm_r_trig_mode);
   this->nh_.getParam("/camera_synchronizer_node/narrow_stereo_trig_mode",config.narrow_stereo_trig_mode);
   this->nh_.getParam("/camera_synchronizer_node/wide_stereo_trig_mode",config.wide_stereo_trig_mode);
   this->ReconfigureCallback(config,0);
+  this->srv_.updateConfig(config);
 
 }
 
 VisionReconfigure::~VisionReconfigure()
 {
+  this->trigger_timer_.stop();
   this->nh_.shutdown();
-  this->callback_queue_thread_.join();
+}
+
+void VisionReconfigure::AddCamera(const std::string &name, const std::vector<std::string> &default_topics)
+{
+  TriggeredCamera camera;
+  camera.name = name;
+  camera.trig_mode = gazebo_plugins::CameraSynchronizer_InternalTrigger;
+  camera.divisor = 1;
+
+  // ~<name>_trigger_topics overrides the default image_trigger topics of the camera
+  std::vector<std::string> topics;
+  if (!ros::param::get("~" + name + "_trigger_topics", topics))
+    topics = default_topics;
+  for (unsigned int i = 0; i < topics.size(); ++i)
+    camera.trigger_pubs.push_back(this->nh_.advertise<std_msgs::Empty>(topics[i], 1));
+
+  this->cameras_.push_back(camera);
+}
+
+void VisionReconfigure::SetCamera(TriggeredCamera &camera, int trig_mode, double rate, double projector_rate)
+{
+  camera.trig_mode = trig_mode;
+  // as on the real robot, the frame rate is rounded to a divisor of the projector rate
+  camera.divisor = 1;
+  if (rate > 0.0)
+    camera.divisor = std::max(1, static_cast<int>(projector_rate / rate + 0.5));
+  if (trig_mode != gazebo_plugins::CameraSynchronizer_InternalTrigger)
+    ROS_DEBUG_NAMED("vision_reconfigure", "Triggering %s at %f Hz in mode %d",
+                    camera.name.c_str(), projector_rate / camera.divisor, trig_mode);
 }
 
 void VisionReconfigure::ReconfigureCallback(gazebo_plugins::CameraSynchronizerConfig &config, uint32_t level)
@@ -109,36 +169,111 @@ void VisionReconfigure::ReconfigureCallback(gazebo_plugins::CameraSynchronizerCo
   }
 
   this->pub_projector_.publish(projector_msg_);
-}
 
-void VisionReconfigure::QueueThread()
-{
-  // FIXME: hardcoded to 100Hz update rate for ros callback queue
-  static const double timeout = 0.01;
-  while (this->nh_.ok())
+  // reschedule the triggers, projector pulses are the reference for all cameras
+  bool run_timer = false;
+  double projector_rate = 0.0;
+  unsigned int slot_step = 1;
   {
-    this->queue_.callAvailable(ros::WallDuration(timeout));
+    boost::mutex::scoped_lock lock(this->mutex_);
+    projector_rate = config.projector_rate > 0.0 ? config.projector_rate : 60.0;
+    this->SetCamera(this->cameras_[0], config.wide_stereo_trig_mode, config.stereo_rate, projector_rate);
+    this->SetCamera(this->cameras_[1], config.narrow_stereo_trig_mode, config.stereo_rate, projector_rate);
+    this->SetCamera(this->cameras_[2], config.forearm_r_trig_mode, config.forearm_r_rate, projector_rate);
+    this->SetCamera(this->cameras_[3], config.forearm_l_trig_mode, config.forearm_l_rate, projector_rate);
+
+    this->projector_on_ = this->projector_msg_.data == 1;
+
+    // fire only in the slots where something is published: every slot if a camera is exposed
+    // between two pulses, otherwise every n-th pulse, n the gcd of the pulse divisors
+    bool between_pulses = false;
+    int pulses = this->projector_on_ ? 1 : 0;
+    for (unsigned int i = 0; i < this->cameras_.size(); ++i)
+    {
+      switch (this->cameras_[i].trig_mode)
+      {
+        case gazebo_plugins::CameraSynchronizer_IgnoreProjector:
+        case gazebo_plugins::CameraSynchronizer_WithProjector:
+          pulses = gcd(pulses, this->cameras_[i].divisor);
+          break;
+        case gazebo_plugins::CameraSynchronizer_WithoutProjector:
+        case gazebo_plugins::CameraSynchronizer_AlternateProjector:
+          between_pulses = true;
+          break;
+        default:
+          break;
+      }
+    }
+    run_timer = between_pulses || pulses > 0;
+    slot_step = between_pulses ? 1 : 2 * std::max(pulses, 1);
+    this->slot_step_ = slot_step;
+    this->slot_ = 0;
+  }
+
+  // outside of the lock, stopping the timer waits for a TriggerTimer call in progress
+  if (run_timer)
+  {
+    this->trigger_timer_.setPeriod(ros::Duration(0.5 * slot_step / projector_rate));
+    this->trigger_timer_.start();
+  }
+  else
+  {
+    this->trigger_timer_.stop();
   }
 }
 
-void VisionReconfigure::spinOnce()
+void VisionReconfigure::TriggerTimer(const ros::TimerEvent &event)
 {
-  if (projector_msg_.data == 1)
+  boost::mutex::scoped_lock lock(this->mutex_);
+
+  // even slots are projector pulses, odd slots lie half way between them
+  bool projector_slot = (this->slot_ % 2) == 0;
+  int pulse = static_cast<int>(this->slot_ / 2);
+  this->slot_ += this->slot_step_;
+
+  if (projector_slot && this->projector_on_)
   {
     std_msgs::Header rh;
-    rh.stamp = ros::Time::now();
+    rh.stamp = event.current_expected;
     rh.frame_id = "projector_wg6802418_frame";
     this->pub_header_.publish(rh);
   }
-}
 
-void VisionReconfigure::spin(double spin_frequency)
-{
-  ros::Rate loop_rate(spin_frequency);
-  while(this->nh_.ok())
+  std_msgs::Empty trigger;
+  for (unsigned int i = 0; i < this->cameras_.size(); ++i)
   {
-    ros::spinOnce();
-    this->spinOnce();
-    loop_rate.sleep();
+    const TriggeredCamera &camera = this->cameras_[i];
+    if (pulse % camera.divisor != 0)
+      continue;
+
+    bool due = false;
+    switch (camera.trig_mode)
+    {
+      case gazebo_plugins::CameraSynchronizer_IgnoreProjector:
+      case gazebo_plugins::CameraSynchronizer_WithProjector:
+        due = projector_slot;
+        break;
+      case gazebo_plugins::CameraSynchronizer_WithoutProjector:
+        due = !projector_slot;
+        break;
+      case gazebo_plugins::CameraSynchronizer_AlternateProjector:
+        // every other frame is exposed between two pulses
+        due = projector_slot == ((pulse / camera.divisor) % 2 == 0);
+        break;
+      default:
+        break;
+    }
+    if (!due)
+      continue;
+
+    for (unsigned int j = 0; j < camera.trigger_pubs.size(); ++j)
+      camera.trigger_pubs[j].publish(trigger);
   }
 }
+
+void VisionReconfigure::spin()
+{
+  // reconfigure requests and the trigger timer share the global queue
+  gazebo::ThreadPolicy::instance().apply("callbacks", "");
+  ros::spin();
+}
@@ -0,0 +1,286 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <cmath>
+#include <sstream>
+
+#include <gazebo_plugins/wrench_filter.h>
+
+namespace gazebo
+{
+////////////////////////////////////////////////////////////////////////////////
+// Per axis, the value of largest magnitude
+static ignition::math::Vector3d ExtremumOf(const ignition::math::Vector3d &_a,
+                                           const ignition::math::Vector3d &_b)
+{
+  return ignition::math::Vector3d(
+    std::fabs(_b.X()) > std::fabs(_a.X()) ? _b.X() : _a.X(),
+    std::fabs(_b.Y()) > std::fabs(_a.Y()) ? _b.Y() : _a.Y(),
+    std::fabs(_b.Z()) > std::fabs(_a.Z()) ? _b.Z() : _a.Z());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+WrenchFilter::WrenchFilter()
+  : type_(NONE), count_(0), cutoff_(0), primed_(false), head_(0),
+    raw_head_(0), raw_count_(0), raw_active_(false)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void WrenchFilter::Load(sdf::ElementPtr _sdf, const std::string &_log_name)
+{
+  std::string type = "none";
+  if (_sdf->HasElement("filterType"))
+    type = _sdf->Get<std::string>("filterType");
+
+  this->type_ = NONE;
+  if (type == "mean")
+    this->type_ = MEAN;
+  else if (type == "max")
+    this->type_ = MAX;
+  else if (type == "lowpass")
+  {
+    if (_sdf->HasElement("filterCutoff"))
+      this->cutoff_ = _sdf->Get<double>("filterCutoff");
+    if (this->cutoff_ > 0)
+      this->type_ = LOWPASS;
+    else
+      ROS_ERROR_NAMED(_log_name, "%s plugin: lowpass <filterType> needs a "
+        "positive <filterCutoff>, not filtering", _log_name.c_str());
+  }
+  else if (type == "fir")
+  {
+    std::istringstream coefficients;
+    if (_sdf->HasElement("filterCoefficients"))
+      coefficients.str(_sdf->Get<std::string>("filterCoefficients"));
+    this->coefficients_.clear();
+    double coefficient;
+    while (coefficients >> coefficient)
+      this->coefficients_.push_back(coefficient);
+    if (!this->coefficients_.empty())
+    {
+      this->type_ = FIR;
+      this->history_.resize(this->coefficients_.size());
+    }
+    else
+      ROS_ERROR_NAMED(_log_name, "%s plugin: fir <filterType> needs "
+        "<filterCoefficients>, not filtering", _log_name.c_str());
+  }
+  else if (type != "none")
+    ROS_ERROR_NAMED(_log_name, "%s plugin: unknown <filterType> [%s], not "
+      "filtering", _log_name.c_str(), type.c_str());
+
+  if (_sdf->HasElement("rawTopicName"))
+    this->raw_topic_name_ = _sdf->Get<std::string>("rawTopicName");
+
+  int raw_size = 1000;
+  if (_sdf->HasElement("rawBufferSize"))
+    raw_size = _sdf->Get<int>("rawBufferSize");
+  if (raw_size < 1)
+    raw_size = 1;
+  this->raw_stamps_.resize(raw_size);
+  this->raw_samples_.resize(raw_size);
+  this->raw_msg_.stamp.reserve(raw_size);
+  this->raw_msg_.wrench.reserve(raw_size);
+
+  this->Reset();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void WrenchFilter::Advertise(ros::NodeHandle &_node,
+                             const std::string &_frame_name)
+{
+  this->raw_msg_.header.frame_id = _frame_name;
+  if (this->raw_topic_name_ != "")
+    this->raw_pub_ = _node.advertise<gazebo_msgs::WrenchArray>(
+      this->raw_topic_name_, 1);
+  this->raw_active_ = this->RawActive();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool WrenchFilter::Enabled() const
+{
+  return this->type_ != NONE || this->raw_pub_;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool WrenchFilter::RawActive() const
+{
+  return this->raw_pub_ && this->raw_pub_.getNumSubscribers() > 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void WrenchFilter::Add(const common::Time &_stamp,
+                       const ignition::math::Vector3d &_force,
+                       const ignition::math::Vector3d &_torque)
+{
+  switch (this->type_)
+  {
+    case MEAN:
+      if (this->count_ == 0)
+      {
+        this->state_.force = _force;
+        this->state_.torque = _torque;
+      }
+      else
+      {
+        this->state_.force += _force;
+        this->state_.torque += _torque;
+      }
+      break;
+
+    case NONE:
+    case MAX:
+      if (this->count_ == 0)
+      {
+        this->state_.force = _force;
+        this->state_.torque = _torque;
+      }
+      else if (this->type_ == MAX)
+      {
+        this->state_.force = ExtremumOf(this->state_.force, _force);
+        this->state_.torque = ExtremumOf(this->state_.torque, _torque);
+      }
+      else
+      {
+        // latest sample
+        this->state_.force = _force;
+        this->state_.torque = _torque;
+      }
+      break;
+
+    case LOWPASS:
+      if (!this->primed_)
+      {
+        this->state_.force = _force;
+        this->state_.torque = _torque;
+      }
+      else
+      {
+        double dt = (_stamp - this->last_stamp_).Double();
+        if (dt > 0)
+        {
+          double rc = 1.0 / (2.0 * M_PI * this->cutoff_);
+          double alpha = dt / (rc + dt);
+          this->state_.force += (_force - this->state_.force) * alpha;
+          this->state_.torque += (_torque - this->state_.torque) * alpha;
+        }
+      }
+      break;
+
+    case FIR:
+      if (!this->primed_)
+      {
+        // start from steady state
+        for (size_t i = 0; i < this->history_.size(); ++i)
+        {
+          this->history_[i].force = _force;
+          this->history_[i].torque = _torque;
+        }
+      }
+      this->head_ = (this->head_ + 1) % this->history_.size();
+      this->history_[this->head_].force = _force;
+      this->history_[this->head_].torque = _torque;
+      break;
+  }
+  this->primed_ = true;
+  this->last_stamp_ = _stamp;
+  ++this->count_;
+
+  if (this->raw_active_)
+  {
+    this->raw_stamps_[this->raw_head_].sec = _stamp.sec;
+    this->raw_stamps_[this->raw_head_].nsec = _stamp.nsec;
+    this->raw_samples_[this->raw_head_].force = _force;
+    this->raw_samples_[this->raw_head_].torque = _torque;
+    this->raw_head_ = (this->raw_head_ + 1) % this->raw_samples_.size();
+    if (this->raw_count_ < this->raw_samples_.size())
+      ++this->raw_count_;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool WrenchFilter::Output(ignition::math::Vector3d &_force,
+                          ignition::math::Vector3d &_torque)
+{
+  if (this->raw_count_ > 0)
+  {
+    // oldest sample first
+    size_t size = this->raw_samples_.size();
+    size_t first = (this->raw_head_ + size - this->raw_count_) % size;
+    this->raw_msg_.stamp.resize(this->raw_count_);
+    this->raw_msg_.wrench.resize(this->raw_count_);
+    for (size_t i = 0; i < this->raw_count_; ++i)
+    {
+      const Sample &sample = this->raw_samples_[(first + i) % size];
+      geometry_msgs::Wrench &wrench = this->raw_msg_.wrench[i];
+      this->raw_msg_.stamp[i] = this->raw_stamps_[(first + i) % size];
+      wrench.force.x = sample.force.X();
+      wrench.force.y = sample.force.Y();
+      wrench.force.z = sample.force.Z();
+      wrench.torque.x = sample.torque.X();
+      wrench.torque.y = sample.torque.Y();
+      wrench.torque.z = sample.torque.Z();
+    }
+    this->raw_msg_.header.stamp = this->raw_msg_.stamp.back();
+    this->raw_pub_.publish(this->raw_msg_);
+    this->raw_count_ = 0;
+  }
+  this->raw_active_ = this->RawActive();
+
+  if (this->count_ == 0)
+    return false;
+
+  switch (this->type_)
+  {
+    case MEAN:
+      _force = this->state_.force / this->count_;
+      _torque = this->state_.torque / this->count_;
+      break;
+
+    case FIR:
+      _force = ignition::math::Vector3d::Zero;
+      _torque = ignition::math::Vector3d::Zero;
+      for (size_t i = 0; i < this->coefficients_.size(); ++i)
+      {
+        const Sample &sample = this->history_[
+          (this->head_ + this->history_.size() - i) % this->history_.size()];
+        _force += sample.force * this->coefficients_[i];
+        _torque += sample.torque * this->coefficients_[i];
+      }
+      break;
+
+    default:
+      _force = this->state_.force;
+      _torque = this->state_.torque;
+      break;
+  }
+  this->count_ = 0;
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void WrenchFilter::Reset()
+{
+  this->count_ = 0;
+  this->primed_ = false;
+  this->head_ = 0;
+  this->raw_head_ = 0;
+  this->raw_count_ = 0;
+  this->raw_active_ = this->RawActive();
+}
+}
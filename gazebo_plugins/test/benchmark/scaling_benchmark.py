@@ -0,0 +1,598 @@
+#!/usr/bin/env python
+#
+# Copyright 2026 Open Source Robotics Foundation
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+# Desc: end-to-end scaling benchmark of the ROS plugins
+#
+# For each robot count, a world is generated with that many robots (diff
+# drive, IMU, laser and, unless --no-cameras, a depth camera), a number of
+# static models and a pile of contact-rich objects. gzserver runs it
+# headless through gazebo_ros/empty_world.launch for a fixed simulation
+# duration while the benchmark records:
+#
+#   startup_s       wall time from launch until every robot published odometry
+#   rtf             simulation time over wall time during the measurement
+#   rss_mb          resident memory of gzserver at the end, and its peak
+#   rates           mean publish rate per robot of each topic [Hz]
+#   plugins         CPU time of each plugin stage per simulated second [s],
+#                   from gazebo_msgs/PerformanceMetrics of the api plugin
+#
+# With --large-model, one of the articulated pendulum chains of
+# test2/large_models is spawned through gazebo_ros/spawn_model once the
+# robots are up, which adds its spawn time (spawn_s) to the results and its
+# many joints to the measured world.
+#
+# The results are written as JSON. With --baseline, they are compared with
+# an earlier run, and the exit code is 1 if any metric got worse than the
+# tolerance, so that scaling regressions show up as the robot count grows.
+#
+#   ./scaling_benchmark.py --robots 1 4 16 -o run.json
+#   ./scaling_benchmark.py --robots 1 4 16 --baseline run.json --tolerance 0.15
+#
+# A ROS master is started for the whole sweep unless one is already running.
+#
+import argparse
+import json
+import os
+import signal
+import subprocess
+import sys
+import tempfile
+import time
+
+import rosgraph
+import rospy
+from geometry_msgs.msg import Twist
+from gazebo_msgs.msg import PerformanceMetrics
+from rosgraph_msgs.msg import Clock
+
+# topics of each robot, relative to its namespace
+ROBOT_TOPICS = ['odom', 'imu', 'scan']
+CAMERA_TOPICS = ['camera/depth/image_raw', 'camera/points']
+
+# metrics where a higher value is a regression, and the ones where a lower
+# value is
+HIGHER_IS_WORSE = ['startup_s', 'spawn_s', 'rss_mb', 'peak_rss_mb']
+
+# xacro files of --large-model, the setups of test2/large_models
+LARGE_MODELS_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                                os.pardir, os.pardir, 'test2', 'large_models')
+LARGE_MODELS = {
+    'large': 'large_model.urdf.xacro',
+    'smaller': 'smaller_large_model.urdf.xacro',
+}
+LOWER_IS_WORSE = ['rtf']
+
+
+def box_geometry(x, y, z):
+    return '<geometry><box><size>%g %g %g</size></box></geometry>' % (x, y, z)
+
+
+def link_inertial(mass, i):
+    return ('<inertial><mass>%g</mass><inertia><ixx>%g</ixx><iyy>%g</iyy>'
+            '<izz>%g</izz><ixy>0</ixy><ixz>0</ixz><iyz>0</iyz></inertia>'
+            '</inertial>' % (mass, i, i, i))
+
+
+def robot_model(index, x, y, cameras):
+    ns = '/robot_%d' % index
+    wheels = ''
+    for side, offset in (('left', 0.17), ('right', -0.17)):
+        wheels += '''
+      <link name="%(side)s_wheel">
+        <pose>0 %(offset)g 0.08 -1.5708 0 0</pose>
+        %(inertial)s
+        <collision name="collision">
+          <geometry><cylinder><radius>0.08</radius><length>0.04</length></cylinder></geometry>
+        </collision>
+        <visual name="visual">
+          <geometry><cylinder><radius>0.08</radius><length>0.04</length></cylinder></geometry>
+        </visual>
+      </link>
+      <joint name="%(side)s_wheel_joint" type="revolute">
+        <parent>chassis</parent>
+        <child>%(side)s_wheel</child>
+        <axis><xyz>0 0 1</xyz></axis>
+      </joint>''' % {'side': side, 'offset': offset,
+                     'inertial': link_inertial(0.5, 0.001)}
+
+    camera = ''
+    if cameras:
+        camera = '''
+        <sensor type="depth" name="camera">
+          <pose>0.2 0 0.15 0 0 0</pose>
+          <update_rate>10</update_rate>
+          <camera>
+            <horizontal_fov>1.047</horizontal_fov>
+            <image><width>320</width><height>240</height><format>R8G8B8</format></image>
+            <clip><near>0.05</near><far>10</far></clip>
+          </camera>
+          <plugin name="camera" filename="libgazebo_ros_openni_kinect.so">
+            <robotNamespace>%(ns)s</robotNamespace>
+            <cameraName>camera</cameraName>
+            <imageTopicName>rgb/image_raw</imageTopicName>
+            <cameraInfoTopicName>rgb/camera_info</cameraInfoTopicName>
+            <depthImageTopicName>depth/image_raw</depthImageTopicName>
+            <depthImageCameraInfoTopicName>depth/camera_info</depthImageCameraInfoTopicName>
+            <pointCloudTopicName>points</pointCloudTopicName>
+            <frameName>camera_link</frameName>
+            <pointCloudCutoff>0.05</pointCloudCutoff>
+          </plugin>
+        </sensor>''' % {'ns': ns}
+
+    return '''
+    <model name="robot_%(index)d">
+      <pose>%(x)g %(y)g 0 0 0 0</pose>
+      <link name="chassis">
+        <pose>0 0 0.12 0 0 0</pose>
+        %(chassis_inertial)s
+        <collision name="collision">%(chassis)s</collision>
+        <visual name="visual">%(chassis)s</visual>
+        <collision name="caster">
+          <pose>-0.15 0 -0.07 0 0 0</pose>
+          <geometry><sphere><radius>0.05</radius></sphere></geometry>
+          <surface><friction><ode><mu>0</mu><mu2>0</mu2></ode></friction></surface>
+        </collision>
+        <sensor type="imu" name="imu">
+          <always_on>true</always_on>
+          <update_rate>100</update_rate>
+          <plugin name="imu" filename="libgazebo_ros_imu_sensor.so">
+            <robotNamespace>%(ns)s</robotNamespace>
+            <topicName>imu</topicName>
+            <frameName>imu_link</frameName>
+            <updateRateHZ>100</updateRateHZ>
+            <gaussianNoise>0.001</gaussianNoise>
+          </plugin>
+        </sensor>
+        <sensor type="ray" name="laser">
+          <pose>0.15 0 0.1 0 0 0</pose>
+          <update_rate>20</update_rate>
+          <ray>
+            <scan><horizontal><samples>720</samples><resolution>1</resolution>
+              <min_angle>-2.35</min_angle><max_angle>2.35</max_angle></horizontal></scan>
+            <range><min>0.1</min><max>20</max><resolution>0.01</resolution></range>
+          </ray>
+          <plugin name="laser" filename="libgazebo_ros_laser.so">
+            <robotNamespace>%(ns)s</robotNamespace>
+            <topicName>scan</topicName>
+            <frameName>laser_link</frameName>
+          </plugin>
+        </sensor>%(camera)s
+      </link>%(wheels)s
+      <plugin name="diff_drive" filename="libgazebo_ros_diff_drive.so">
+        <robotNamespace>%(ns)s</robotNamespace>
+        <leftJoint>left_wheel_joint</leftJoint>
+        <rightJoint>right_wheel_joint</rightJoint>
+        <wheelSeparation>0.34</wheelSeparation>
+        <wheelDiameter>0.16</wheelDiameter>
+        <wheelTorque>5</wheelTorque>
+        <updateRate>50</updateRate>
+        <commandTopic>cmd_vel</commandTopic>
+        <odometryTopic>odom</odometryTopic>
+        <odometryFrame>odom</odometryFrame>
+        <robotBaseFrame>base_link</robotBaseFrame>
+        <publishWheelTF>false</publishWheelTF>
+        <publishWheelJointState>false</publishWheelJointState>
+      </plugin>
+    </model>''' % {'index': index, 'x': x, 'y': y, 'ns': ns,
+                   'chassis': box_geometry(0.4, 0.3, 0.1),
+                   'chassis_inertial': link_inertial(5.0, 0.1),
+                   'camera': camera, 'wheels': wheels}
+
+
+def static_model(index, x, y):
+    return '''
+    <model name="static_%(index)d">
+      <static>true</static>
+      <pose>%(x)g %(y)g 0.5 0 0 0</pose>
+      <link name="link">
+        <collision name="collision">%(box)s</collision>
+        <visual name="visual">%(box)s</visual>
+      </link>
+    </model>''' % {'index': index, 'x': x, 'y': y,
+                   'box': box_geometry(0.5, 0.5, 1.0)}
+
+
+def contact_object(index, x, y, z):
+    # small boxes dropped onto each other keep many contacts active
+    return '''
+    <model name="object_%(index)d">
+      <pose>%(x)g %(y)g %(z)g 0 0 0</pose>
+      <link name="link">
+        %(inertial)s
+        <collision name="collision">%(box)s</collision>
+        <visual name="visual">%(box)s</visual>
+      </link>
+    </model>''' % {'index': index, 'x': x, 'y': y, 'z': z,
+                   'inertial': link_inertial(0.2, 0.0003),
+                   'box': box_geometry(0.1, 0.1, 0.1)}
+
+
+def generate_world(robots, statics, objects, cameras):
+    """Lay the robots out on a grid at the origin, the static models on a
+    ring around them and the contact objects in a pile in a corner."""
+    models = []
+    side = 1
+    while side * side < robots:
+        side += 1
+    for i in range(robots):
+        models.append(robot_model(i, 2.0 * (i % side), 2.0 * (i // side),
+                                  cameras))
+    ring = 2.0 * side + 3.0
+    for i in range(statics):
+        models.append(static_model(i, -ring + (i % 20) * ring / 10.0,
+                                   -ring - 2.0 * (i // 20)))
+    for i in range(objects):
+        layer, cell = divmod(i, 25)
+        models.append(contact_object(i, -ring + 0.12 * (cell % 5),
+                                     ring + 0.12 * (cell // 5),
+                                     0.05 + 0.11 * layer))
+    return '''<?xml version="1.0"?>
+<sdf version="1.6">
+  <world name="default">
+    <include><uri>model://ground_plane</uri></include>
+    <include><uri>model://sun</uri></include>
+    <physics type="ode">
+      <max_step_size>0.001</max_step_size>
+      <real_time_factor>0</real_time_factor>
+      <real_time_update_rate>0</real_time_update_rate>
+    </physics>%s
+  </world>
+</sdf>
+''' % ''.join(models)
+
+
+def large_model_urdf(name):
+    """Expand the xacro of a test2/large_models model into a URDF file."""
+    xacro = os.path.join(LARGE_MODELS_DIR, LARGE_MODELS[name])
+    urdf = tempfile.NamedTemporaryFile(
+        mode='w', prefix='large_model_', suffix='.urdf', delete=False)
+    try:
+        subprocess.check_call(['rosrun', 'xacro', 'xacro', xacro],
+                              stdout=urdf)
+    finally:
+        urdf.close()
+    return urdf.name
+
+
+def spawn_large_model(urdf, x, y, timeout):
+    """Spawn the URDF next to the robots, return the wall time it took."""
+    start = time.time()
+    spawn = subprocess.Popen(
+        ['rosrun', 'gazebo_ros', 'spawn_model', '-urdf', '-file', urdf,
+         '-model', 'large_model', '-x', str(x), '-y', str(y), '-z', '1.0',
+         '-timeout', str(timeout)],
+        stdout=open(os.devnull, 'w'), stderr=subprocess.STDOUT)
+    if spawn.wait() != 0:
+        raise RuntimeError('spawning %s failed' % urdf)
+    return time.time() - start
+
+
+def children(pid):
+    """All descendants of pid, from /proc."""
+    parents = {}
+    for entry in os.listdir('/proc'):
+        if not entry.isdigit():
+            continue
+        try:
+            with open('/proc/%s/stat' % entry) as f:
+                stat = f.read()
+        except IOError:
+            continue
+        # the command name is in parentheses and may contain spaces
+        ppid = int(stat[stat.rfind(')') + 2:].split()[1])
+        parents.setdefault(ppid, []).append(int(entry))
+    result = []
+    pending = [pid]
+    while pending:
+        for child in parents.get(pending.pop(), []):
+            result.append(child)
+            pending.append(child)
+    return result
+
+
+def find_gzserver(launch_pid):
+    for pid in children(launch_pid):
+        try:
+            with open('/proc/%d/comm' % pid) as f:
+                if f.read().strip() == 'gzserver':
+                    return pid
+        except IOError:
+            pass
+    return None
+
+
+def memory_mb(pid):
+    """Resident and peak resident memory of pid [MB]."""
+    rss = peak = 0.0
+    with open('/proc/%d/status' % pid) as f:
+        for line in f:
+            if line.startswith('VmRSS:'):
+                rss = int(line.split()[1]) / 1024.0
+            elif line.startswith('VmHWM:'):
+                peak = int(line.split()[1]) / 1024.0
+    return rss, peak
+
+
+class Recorder(object):
+    """Count messages and track the clock and the plugin timings."""
+
+    def __init__(self, robots, cameras):
+        self.topics = ROBOT_TOPICS + (CAMERA_TOPICS if cameras else [])
+        self.counts = {}
+        self.subscribers = []
+        self.sim_time = None
+        self.metrics = None
+        self.rtf = []
+        for i in range(robots):
+            for topic in self.topics:
+                name = '/robot_%d/%s' % (i, topic)
+                self.counts[name] = 0
+                self.subscribers.append(rospy.Subscriber(
+                    name, rospy.AnyMsg, self.count, name, queue_size=100))
+        self.subscribers.append(rospy.Subscriber(
+            '/clock', Clock, self.clock, queue_size=1))
+        self.subscribers.append(rospy.Subscriber(
+            '/gazebo/performance_metrics', PerformanceMetrics, self.metric,
+            queue_size=10))
+        self.commands = [rospy.Publisher('/robot_%d/cmd_vel' % i, Twist,
+                                         queue_size=1)
+                         for i in range(robots)]
+
+    def count(self, msg, name):
+        self.counts[name] += 1
+
+    def clock(self, msg):
+        self.sim_time = msg.clock.to_sec()
+
+    def metric(self, msg):
+        self.metrics = msg
+        self.rtf.append(msg.real_time_factor)
+
+    def started(self):
+        """True once every robot published odometry."""
+        if self.sim_time is None:
+            return False
+        return all(self.counts[name] > 0 for name in self.counts
+                   if name.endswith('/odom'))
+
+    def drive(self):
+        # drive in circles so that the wheels and contacts do some work
+        cmd = Twist()
+        cmd.linear.x = 0.3
+        cmd.angular.z = 0.5
+        for pub in self.commands:
+            pub.publish(cmd)
+
+    def plugin_times(self):
+        """Total time of each plugin stage since load [s]."""
+        times = {}
+        if self.metrics is not None:
+            for p in self.metrics.plugins:
+                key = '%s/%s' % (p.plugin, p.stage)
+                times[key] = times.get(key, 0.0) + p.count * p.mean
+        return times
+
+    def close(self):
+        for sub in self.subscribers:
+            sub.unregister()
+        for pub in self.commands:
+            pub.unregister()
+
+
+def wait_for(condition, timeout):
+    end = time.time() + timeout
+    while not condition():
+        if time.time() > end or rospy.is_shutdown():
+            return False
+        time.sleep(0.05)
+    return True
+
+
+def run_once(args, robots):
+    world = generate_world(robots, args.statics, args.objects, args.cameras)
+    world_file = tempfile.NamedTemporaryFile(
+        mode='w', prefix='scaling_%d_' % robots, suffix='.world',
+        delete=False)
+    world_file.write(world)
+    world_file.close()
+
+    launch = subprocess.Popen(
+        ['roslaunch', 'gazebo_ros', 'empty_world.launch',
+         'world_name:=' + world_file.name, 'gui:=false', 'paused:=false',
+         'use_sim_time:=true'],
+        stdout=open(os.devnull, 'w'), stderr=subprocess.STDOUT,
+        preexec_fn=os.setsid)
+    launch_time = time.time()
+    result = {'robots': robots, 'statics': args.statics,
+              'objects': args.objects, 'cameras': args.cameras}
+    if args.large_model:
+        result['large_model'] = args.large_model
+    recorder = None
+    try:
+        recorder = Recorder(robots, args.cameras)
+        if not wait_for(recorder.started, args.timeout):
+            raise RuntimeError('robots did not start within %g s'
+                               % args.timeout)
+        result['startup_s'] = time.time() - launch_time
+        gzserver = find_gzserver(launch.pid)
+
+        if args.large_model_urdf:
+            # beyond the robot grid, on the side of the static models
+            result['spawn_s'] = spawn_large_model(
+                args.large_model_urdf, -4.0, 0.0, args.timeout)
+
+        # let the contact objects settle before measuring
+        settle = recorder.sim_time + args.warmup
+        wait_for(lambda: recorder.sim_time >= settle, args.timeout)
+
+        counts = dict(recorder.counts)
+        plugins = recorder.plugin_times()
+        del recorder.rtf[:]
+        sim_start = recorder.sim_time
+        wall_start = time.time()
+        next_command = 0.0
+        while recorder.sim_time - sim_start < args.duration:
+            if time.time() - wall_start > args.timeout:
+                raise RuntimeError('measurement did not finish within %g s'
+                                   % args.timeout)
+            if time.time() > next_command:
+                recorder.drive()
+                next_command = time.time() + 0.1
+            time.sleep(0.01)
+        sim_elapsed = recorder.sim_time - sim_start
+        wall_elapsed = time.time() - wall_start
+
+        result['sim_s'] = sim_elapsed
+        result['rtf'] = sim_elapsed / wall_elapsed
+        if recorder.rtf:
+            result['reported_rtf'] = sum(recorder.rtf) / len(recorder.rtf)
+        if gzserver is not None:
+            result['rss_mb'], result['peak_rss_mb'] = memory_mb(gzserver)
+
+        # mean rate per robot, in simulation time
+        rates = {}
+        for topic in recorder.topics:
+            total = sum(recorder.counts[name] - counts[name]
+                        for name in counts if name.endswith('/' + topic))
+            rates[topic] = total / float(max(robots, 1)) / sim_elapsed
+        result['rates'] = rates
+
+        result['plugins'] = {}
+        for key, total in recorder.plugin_times().items():
+            result['plugins'][key] = \
+                (total - plugins.get(key, 0.0)) / sim_elapsed
+    finally:
+        if recorder is not None:
+            recorder.close()
+        os.killpg(launch.pid, signal.SIGINT)
+        try:
+            wait_for(lambda: launch.poll() is not None, 20.0)
+        finally:
+            if launch.poll() is None:
+                os.killpg(launch.pid, signal.SIGKILL)
+            os.unlink(world_file.name)
+    return result
+
+
+def compare(results, baseline, tolerance):
+    """Print and return the metrics that got worse than the baseline."""
+    regressions = []
+    previous = dict((r['robots'], r) for r in baseline['results'])
+    for r in results:
+        b = previous.get(r['robots'])
+        if b is None:
+            continue
+        checks = []
+        for key in HIGHER_IS_WORSE:
+            if key in r and key in b:
+                checks.append((key, b[key], r[key], 1.0))
+        for key in LOWER_IS_WORSE:
+            if key in r and key in b:
+                checks.append((key, b[key], r[key], -1.0))
+        for key, value in r.get('plugins', {}).items():
+            if key in b.get('plugins', {}):
+                checks.append(('plugins/' + key, b['plugins'][key], value,
+                               1.0))
+        for key, value in r.get('rates', {}).items():
+            if key in b.get('rates', {}):
+                checks.append(('rates/' + key, b['rates'][key], value, -1.0))
+        for key, old, new, sign in checks:
+            if old <= 0.0:
+                continue
+            change = (new - old) / old
+            if sign * change > tolerance:
+                regressions.append((r['robots'], key, old, new))
+                print('REGRESSION robots=%d %s: %g -> %g (%+.1f%%)'
+                      % (r['robots'], key, old, new, 100.0 * change))
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='End-to-end scaling benchmark of the gazebo ROS plugins')
+    parser.add_argument('--robots', type=int, nargs='+', default=[1, 4, 16],
+                        help='robot counts to run')
+    parser.add_argument('--statics', type=int, default=50,
+                        help='number of static models')
+    parser.add_argument('--objects', type=int, default=100,
+                        help='number of contact-rich objects')
+    parser.add_argument('--no-cameras', dest='cameras', action='store_false',
+                        help='leave the depth cameras out')
+    parser.add_argument('--large-model', choices=sorted(LARGE_MODELS),
+                        help='also spawn this model of test2/large_models')
+    parser.add_argument('--duration', type=float, default=20.0,
+                        help='measured simulation time [s]')
+    parser.add_argument('--warmup', type=float, default=2.0,
+                        help='simulation time before the measurement [s]')
+    parser.add_argument('--timeout', type=float, default=300.0,
+                        help='wall time limit of each phase [s]')
+    parser.add_argument('-o', '--output', help='JSON file of the results')
+    parser.add_argument('--baseline', help='JSON file of an earlier run')
+    parser.add_argument('--tolerance', type=float, default=0.1,
+                        help='relative change allowed against the baseline')
+    parser.add_argument('--world', metavar='FILE',
+                        help='only write the world of the first robot count')
+    args = parser.parse_args(rospy.myargv()[1:])
+
+    if args.world:
+        with open(args.world, 'w') as f:
+            f.write(generate_world(args.robots[0], args.statics,
+                                   args.objects, args.cameras))
+        return 0
+
+    roscore = None
+    if not rosgraph.is_master_online():
+        roscore = subprocess.Popen(['roscore'], stdout=open(os.devnull, 'w'),
+                                   stderr=subprocess.STDOUT,
+                                   preexec_fn=os.setsid)
+        if not wait_for(rosgraph.is_master_online, 30.0):
+            sys.stderr.write('the ROS master did not start\n')
+            return 2
+    results = []
+    args.large_model_urdf = None
+    try:
+        if args.large_model:
+            args.large_model_urdf = large_model_urdf(args.large_model)
+        rospy.init_node('scaling_benchmark', anonymous=True,
+                        disable_signals=True)
+        for robots in args.robots:
+            print('running %d robots' % robots)
+            r = run_once(args, robots)
+            print(json.dumps(r, indent=2, sort_keys=True))
+            results.append(r)
+    finally:
+        if args.large_model_urdf:
+            os.unlink(args.large_model_urdf)
+        if roscore is not None:
+            os.killpg(roscore.pid, signal.SIGINT)
+            roscore.wait()
+
+    report = {'duration': args.duration, 'results': results}
+    if args.output:
+        with open(args.output, 'w') as f:
+            json.dump(report, f, indent=2, sort_keys=True)
+
+    if args.baseline:
+        with open(args.baseline) as f:
+            baseline = json.load(f)
+        if compare(results, baseline, args.tolerance):
+            return 1
+        print('no regression beyond %g%%' % (100.0 * args.tolerance))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,237 @@
+// Microbenchmarks of the sensor conversion paths of gazebo_plugins, driven
+// with synthetic frames, no gzserver needed. Results as JSON:
+//   sensor_conversion_benchmark --benchmark_out=results.json
+//                               --benchmark_out_format=json
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <ignition/math/Pose3.hh>
+
+#include <gazebo/msgs/msgs.hh>
+#include <sensor_msgs/Image.h>
+#include <sensor_msgs/LaserScan.h>
+#include <sensor_msgs/PointCloud2.h>
+#include <sensor_msgs/fill_image.h>
+#include <sensor_msgs/image_encodings.h>
+
+#include <gazebo_plugins/PubQueue.h>
+#include <gazebo_plugins/depth_image_kernels.h>
+#include <gazebo_plugins/depth_ray_lut.h>
+#include <gazebo_plugins/gazebo_ros_noise.h>
+#include <gazebo_plugins/image_buffer_pool.h>
+#include <gazebo_plugins/laser_scan_projector.h>
+
+using namespace gazebo;
+
+namespace
+{
+// depth ramp with some invalid pixels, like a view of a wall and the sky
+std::vector<float> SyntheticDepth(size_t _rows, size_t _cols)
+{
+  std::vector<float> depth(_rows * _cols);
+  for (size_t i = 0; i < depth.size(); ++i)
+  {
+    if (i % 17 == 0)
+      depth[i] = std::numeric_limits<float>::quiet_NaN();
+    else
+      depth[i] = 0.5f + 9.0f * static_cast<float>(i % _cols) / _cols;
+  }
+  return depth;
+}
+
+msgs::LaserScan SyntheticScan(int _count, int _vertical_count)
+{
+  msgs::LaserScan scan;
+  msgs::Set(scan.mutable_world_pose(), ignition::math::Pose3d::Zero);
+  scan.set_frame("laser");
+  scan.set_angle_min(-M_PI / 2);
+  scan.set_angle_max(M_PI / 2);
+  scan.set_angle_step(M_PI / (_count - 1));
+  scan.set_count(_count);
+  scan.set_vertical_angle_min(-0.2);
+  scan.set_vertical_angle_max(0.2);
+  scan.set_vertical_angle_step(
+      _vertical_count > 1 ? 0.4 / (_vertical_count - 1) : 0.0);
+  scan.set_vertical_count(_vertical_count);
+  scan.set_range_min(0.1);
+  scan.set_range_max(30.0);
+  for (int i = 0; i < _count * _vertical_count; ++i)
+  {
+    scan.add_ranges(i % 23 == 0 ? 31.0 : 1.0 + (i % _count) * 0.01);
+    scan.add_intensities(i % 255);
+  }
+  return scan;
+}
+
+void ImageSizes(benchmark::internal::Benchmark *_b)
+{
+  _b->Args({320, 240})->Args({640, 480})->Args({1280, 720})
+    ->Args({1920, 1080});
+}
+
+void ScanSizes(benchmark::internal::Benchmark *_b)
+{
+  _b->Args({360, 1})->Args({1080, 1})->Args({1440, 16})->Args({2048, 64});
+}
+}
+
+// FillDepthImageHelper: clip to the range, and the 16UC1 variant
+static void BM_ClipDepth(benchmark::State &_state)
+{
+  size_t cols = _state.range(0), rows = _state.range(1);
+  std::vector<float> depth = SyntheticDepth(rows, cols);
+  std::vector<float> out(depth.size());
+  for (auto _ : _state)
+  {
+    depth_kernels::ClipDepth(depth.data(), out.data(), depth.size(),
+                             0.4f, 8.0f);
+    benchmark::DoNotOptimize(out.data());
+  }
+  _state.SetItemsProcessed(_state.iterations() * depth.size());
+  _state.SetLabel(depth_kernels::Implementation());
+}
+BENCHMARK(BM_ClipDepth)->Apply(ImageSizes);
+
+static void BM_DepthToMillimeters(benchmark::State &_state)
+{
+  size_t cols = _state.range(0), rows = _state.range(1);
+  std::vector<float> depth = SyntheticDepth(rows, cols);
+  std::vector<uint16_t> out(depth.size());
+  for (auto _ : _state)
+  {
+    depth_kernels::DepthToMillimeters(depth.data(), out.data(), depth.size(),
+                                      0.4f, 8.0f);
+    benchmark::DoNotOptimize(out.data());
+  }
+  _state.SetItemsProcessed(_state.iterations() * depth.size());
+  _state.SetLabel(depth_kernels::Implementation());
+}
+BENCHMARK(BM_DepthToMillimeters)->Apply(ImageSizes);
+
+// FillPointCloudHelper: unproject every row and pack it with its colors
+static void BM_FillPointCloud(benchmark::State &_state)
+{
+  size_t cols = _state.range(0), rows = _state.range(1);
+  std::vector<float> depth = SyntheticDepth(rows, cols);
+  std::vector<uint8_t> color(rows * cols * 3, 128);
+  DepthRayLUT lut;
+  lut.Update(rows, cols, 1.047);
+
+  const size_t point_step = 32, rgb_offset = 16;
+  std::vector<uint8_t> cloud(rows * cols * point_step);
+  for (auto _ : _state)
+  {
+    depth_kernels::ParallelRows(rows, cols,
+      [&](size_t _first, size_t _end)
+      {
+        std::vector<float> x(cols), y(cols), z(cols);
+        for (size_t row = _first; row < _end; ++row)
+        {
+          const float *d = &depth[row * cols];
+          depth_kernels::ClipDepth(d, z.data(), cols, 0.4f, 8.0f);
+          lut.UnprojectRow(row, z.data(), x.data(), y.data());
+          depth_kernels::PackXYZRGB(x.data(), y.data(), z.data(),
+                                    &color[row * cols * 3], 3, cols,
+                                    &cloud[row * cols * point_step],
+                                    point_step, rgb_offset);
+        }
+      });
+    benchmark::DoNotOptimize(cloud.data());
+  }
+  _state.SetItemsProcessed(_state.iterations() * rows * cols);
+  _state.SetLabel(depth_kernels::Implementation());
+}
+BENCHMARK(BM_FillPointCloud)->Apply(ImageSizes)->UseRealTime();
+
+// PutCameraData: copy a rendered RGB frame into a pooled image
+static void BM_PutCameraData(benchmark::State &_state)
+{
+  size_t cols = _state.range(0), rows = _state.range(1);
+  std::vector<uint8_t> frame(rows * cols * 3, 77);
+  ImageBufferPool pool;
+  for (auto _ : _state)
+  {
+    sensor_msgs::ImagePtr image = pool.Acquire();
+    fillImage(*image, sensor_msgs::image_encodings::RGB8, rows, cols,
+              3 * cols, frame.data());
+    benchmark::DoNotOptimize(image->data.data());
+  }
+  _state.SetBytesProcessed(_state.iterations() * frame.size());
+}
+BENCHMARK(BM_PutCameraData)->Apply(ImageSizes);
+
+// GazeboRosLaser::OnScan, LaserScan part: protobuf to a pooled ROS scan
+static void BM_LaserOnScan(benchmark::State &_state)
+{
+  msgs::LaserScan scan = SyntheticScan(_state.range(0), _state.range(1));
+  MessagePool<sensor_msgs::LaserScan> pool;
+  for (auto _ : _state)
+  {
+    sensor_msgs::LaserScanPtr msg = pool.Acquire();
+    msg->angle_min = scan.angle_min();
+    msg->angle_max = scan.angle_max();
+    msg->angle_increment = scan.angle_step();
+    msg->range_min = scan.range_min();
+    msg->range_max = scan.range_max();
+    msg->ranges.assign(scan.ranges().begin(), scan.ranges().end());
+    msg->intensities.assign(scan.intensities().begin(),
+                            scan.intensities().end());
+    benchmark::DoNotOptimize(msg->ranges.data());
+  }
+  _state.SetItemsProcessed(_state.iterations() * scan.ranges_size());
+}
+BENCHMARK(BM_LaserOnScan)->Apply(ScanSizes);
+
+// GazeboRosLaser::OnScan cloud part and the multi-row scans of the block
+// laser: projection into a PointCloud2
+static void BM_LaserProject(benchmark::State &_state)
+{
+  msgs::LaserScan scan = SyntheticScan(_state.range(0), _state.range(1));
+  LaserScanProjector projector;
+  LaserIntensity intensity;
+  sensor_msgs::PointCloud2 cloud;
+  for (auto _ : _state)
+  {
+    projector.Project(scan, cloud, intensity);
+    benchmark::DoNotOptimize(cloud.data.data());
+  }
+  _state.SetItemsProcessed(_state.iterations() * scan.ranges_size());
+}
+BENCHMARK(BM_LaserProject)->Apply(ScanSizes);
+
+// PubQueue::push of a scan into its preallocated ring; the service thread is
+// not started, so the ring overwrites its oldest message once full
+static void BM_PubQueuePush(benchmark::State &_state)
+{
+  PubMultiQueue queues(PUBQUEUE_DEFAULT_CAPACITY);
+  PubQueue<sensor_msgs::LaserScan>::Ptr queue =
+    queues.addPub<sensor_msgs::LaserScan>();
+  ros::Publisher pub;
+  sensor_msgs::LaserScan scan;
+  scan.ranges.resize(_state.range(0));
+  for (auto _ : _state)
+  {
+    sensor_msgs::LaserScan msg = scan;
+    queue->push(std::move(msg), pub);
+  }
+  _state.SetItemsProcessed(_state.iterations());
+}
+BENCHMARK(BM_PubQueuePush)->Arg(360)->Arg(1080)->Arg(23040);
+
+// GaussianKernel: noise of a whole scan or depth image
+static void BM_GaussianNoiseAdd(benchmark::State &_state)
+{
+  std::vector<float> data(_state.range(0), 1.0f);
+  GaussianNoise noise(42);
+  for (auto _ : _state)
+  {
+    noise.Add(data.data(), data.size(), 0.01);
+    benchmark::DoNotOptimize(data.data());
+  }
+  _state.SetItemsProcessed(_state.iterations() * data.size());
+}
+BENCHMARK(BM_GaussianNoiseAdd)->Arg(360)->Arg(1080)->Arg(640 * 480);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,305 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gazebo_plugins/depth_image_kernels.h>
+
+namespace depth_kernels = gazebo::depth_kernels;
+
+namespace
+{
+const float MIN_DEPTH = 0.05f;
+const float MAX_DEPTH = 100.0f;
+
+/// \brief Depths covering every branch of the kernels: the valid range and
+/// its bounds, NaN, infinities, zero, negatives and depths that saturate
+/// 16 bit millimetres.
+std::vector<float> MakeDepths(size_t _n, unsigned int _seed)
+{
+  const float special[] = {
+    std::numeric_limits<float>::quiet_NaN(),
+    std::numeric_limits<float>::infinity(),
+    -std::numeric_limits<float>::infinity(),
+    0.0f, -1.0f, MIN_DEPTH, MAX_DEPTH,
+    65.535f, 65.5355f, 80.0f, 0.0501f, 99.999f};
+  const size_t n_special = sizeof(special) / sizeof(special[0]);
+
+  std::mt19937 rng(_seed);
+  std::uniform_real_distribution<float> depth(-1.0f, 110.0f);
+  std::vector<float> d(_n);
+  for (size_t i = 0; i < _n; ++i)
+    d[i] = (rng() % 4 == 0) ? special[rng() % n_special] : depth(rng);
+  return d;
+}
+
+/// \brief Bitwise equal, or both NaN.
+bool SameFloat(float _a, float _b)
+{
+  if (_a != _a || _b != _b)
+    return _a != _a && _b != _b;
+  return memcmp(&_a, &_b, sizeof(_a)) == 0;
+}
+
+/// \brief The vector implementations this CPU supports.
+std::vector<std::string> VectorImplementations()
+{
+  const char *names[] = {"sse2", "avx2", "neon"};
+  std::vector<std::string> supported;
+  for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); ++i)
+  {
+    if (depth_kernels::SetImplementation(names[i]))
+      supported.push_back(names[i]);
+  }
+  return supported;
+}
+
+/// \brief Lengths around every vector width, to cover the scalar tails.
+const size_t MAX_LENGTH = 67;
+
+class DepthKernels : public testing::Test
+{
+  protected: virtual void SetUp()
+  {
+    this->initial_ = depth_kernels::Implementation();
+    this->vector_ = VectorImplementations();
+  }
+
+  protected: virtual void TearDown()
+  {
+    depth_kernels::SetImplementation(this->initial_.c_str());
+  }
+
+  protected: std::string initial_;
+  protected: std::vector<std::string> vector_;
+};
+}
+
+////////////////////////////////////////////////////////////////////////////////
+TEST_F(DepthKernels, ScalarReference)
+{
+  ASSERT_TRUE(depth_kernels::SetImplementation("scalar"));
+  EXPECT_EQ(std::string("scalar"), depth_kernels::Implementation());
+  EXPECT_FALSE(depth_kernels::SetImplementation("mmx"));
+  EXPECT_EQ(std::string("scalar"), depth_kernels::Implementation());
+
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  const float src[] = {nan, 0.0f, MIN_DEPTH, 1.5f, 70.0f, MAX_DEPTH};
+  float clipped[6];
+  uint16_t mm[6];
+  float disparity[6];
+  depth_kernels::ClipDepth(src, clipped, 6, MIN_DEPTH, MAX_DEPTH);
+  depth_kernels::DepthToMillimeters(src, mm, 6, MIN_DEPTH, MAX_DEPTH);
+  depth_kernels::DepthToDisparity(src, disparity, 6, 3.0f,
+                                  MIN_DEPTH, MAX_DEPTH);
+
+  const bool valid[] = {false, false, false, true, true, false};
+  for (size_t i = 0; i < 6; ++i)
+  {
+    EXPECT_EQ(valid[i], clipped[i] == clipped[i]) << i;
+    EXPECT_EQ(valid[i], disparity[i] == disparity[i]) << i;
+  }
+  EXPECT_FLOAT_EQ(1.5f, clipped[3]);
+  EXPECT_EQ(0, mm[0]);
+  EXPECT_EQ(0, mm[2]);
+  EXPECT_EQ(1500, mm[3]);
+  EXPECT_EQ(65535, mm[4]);
+  EXPECT_EQ(0, mm[5]);
+  EXPECT_FLOAT_EQ(2.0f, disparity[3]);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+TEST_F(DepthKernels, ClipDepthMatchesScalar)
+{
+  for (size_t v = 0; v < this->vector_.size(); ++v)
+  {
+    for (size_t n = 0; n <= MAX_LENGTH; ++n)
+    {
+      std::vector<float> src = MakeDepths(n, n);
+      std::vector<float> expected(n + 1, -7.0f), actual(n + 1, -7.0f);
+      depth_kernels::SetImplementation("scalar");
+      depth_kernels::ClipDepth(src.data(), expected.data(), n,
+                               MIN_DEPTH, MAX_DEPTH);
+      depth_kernels::SetImplementation(this->vector_[v].c_str());
+      depth_kernels::ClipDepth(src.data(), actual.data(), n,
+                               MIN_DEPTH, MAX_DEPTH);
+      for (size_t i = 0; i <= n; ++i)
+      {
+        ASSERT_TRUE(SameFloat(expected[i], actual[i]))
+          << this->vector_[v] << " n " << n << " i " << i
+          << " depth " << (i < n ? src[i] : 0.0f);
+      }
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+TEST_F(DepthKernels, DepthToMillimetersMatchesScalar)
+{
+  for (size_t v = 0; v < this->vector_.size(); ++v)
+  {
+    for (size_t n = 0; n <= MAX_LENGTH; ++n)
+    {
+      std::vector<float> src = MakeDepths(n, 100 + n);
+      std::vector<uint16_t> expected(n + 1, 7), actual(n + 1, 7);
+      depth_kernels::SetImplementation("scalar");
+      depth_kernels::DepthToMillimeters(src.data(), expected.data(), n,
+                                        MIN_DEPTH, MAX_DEPTH);
+      depth_kernels::SetImplementation(this->vector_[v].c_str());
+      depth_kernels::DepthToMillimeters(src.data(), actual.data(), n,
+                                        MIN_DEPTH, MAX_DEPTH);
+      for (size_t i = 0; i <= n; ++i)
+      {
+        ASSERT_EQ(expected[i], actual[i])
+          << this->vector_[v] << " n " << n << " i " << i
+          << " depth " << (i < n ? src[i] : 0.0f);
+      }
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+TEST_F(DepthKernels, DepthToDisparityMatchesScalar)
+{
+  for (size_t v = 0; v < this->vector_.size(); ++v)
+  {
+    for (size_t n = 0; n <= MAX_LENGTH; ++n)
+    {
+      std::vector<float> src = MakeDepths(n, 200 + n);
+      std::vector<float> expected(n + 1, -7.0f), actual(n + 1, -7.0f);
+      depth_kernels::SetImplementation("scalar");
+      depth_kernels::DepthToDisparity(src.data(), expected.data(), n, 0.075f,
+                                      MIN_DEPTH, MAX_DEPTH);
+      depth_kernels::SetImplementation(this->vector_[v].c_str());
+      depth_kernels::DepthToDisparity(src.data(), actual.data(), n, 0.075f,
+                                      MIN_DEPTH, MAX_DEPTH);
+      for (size_t i = 0; i <= n; ++i)
+      {
+        ASSERT_TRUE(SameFloat(expected[i], actual[i]))
+          << this->vector_[v] << " n " << n << " i " << i
+          << " depth " << (i < n ? src[i] : 0.0f);
+      }
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+TEST_F(DepthKernels, PackXYZRGBMatchesScalar)
+{
+  // the PCL xyz + rgb layout the depth camera publishes, a padded one with
+  // a wider step and a tight one the vector stores must not be used for
+  const size_t layouts[][2] = {{32, 16}, {48, 20}, {16, 12}};
+  const int channels[] = {3, 1, 0};
+
+  for (size_t v = 0; v < this->vector_.size(); ++v)
+  {
+    for (size_t l = 0; l < 3; ++l)
+    {
+      const size_t step = layouts[l][0];
+      const size_t rgb_offset = layouts[l][1];
+      for (size_t c = 0; c < 3; ++c)
+      {
+        for (size_t n = 0; n <= MAX_LENGTH; ++n)
+        {
+          std::vector<float> x = MakeDepths(n, 300 + n);
+          std::vector<float> y = MakeDepths(n, 400 + n);
+          std::vector<float> z = MakeDepths(n, 500 + n);
+          std::vector<uint8_t> color(n * 3 + 1);
+          for (size_t i = 0; i < color.size(); ++i)
+            color[i] = static_cast<uint8_t>(i * 37 + n);
+          const uint8_t *color_ptr = channels[c] ? color.data() : NULL;
+
+          // one spare point checks nothing is written past the row
+          std::vector<uint8_t> expected((n + 1) * step, 0xAB);
+          std::vector<uint8_t> actual((n + 1) * step, 0xAB);
+          depth_kernels::SetImplementation("scalar");
+          size_t expected_invalid = depth_kernels::PackXYZRGB(x.data(),
+              y.data(), z.data(), color_ptr, channels[c], n,
+              expected.data(), step, rgb_offset);
+          depth_kernels::SetImplementation(this->vector_[v].c_str());
+          size_t actual_invalid = depth_kernels::PackXYZRGB(x.data(),
+              y.data(), z.data(), color_ptr, channels[c], n,
+              actual.data(), step, rgb_offset);
+
+          size_t nans = 0;
+          for (size_t i = 0; i < n; ++i)
+            nans += z[i] != z[i];
+          ASSERT_EQ(nans, expected_invalid);
+          ASSERT_EQ(expected_invalid, actual_invalid)
+            << this->vector_[v] << " n " << n;
+          for (size_t i = 0; i < n; ++i)
+          {
+            for (size_t k = 0; k < 3; ++k)
+            {
+              float e, a;
+              memcpy(&e, &expected[i * step + 4 * k], sizeof(e));
+              memcpy(&a, &actual[i * step + 4 * k], sizeof(a));
+              ASSERT_TRUE(SameFloat(e, a))
+                << this->vector_[v] << " n " << n << " point " << i;
+            }
+            // everything else, padding and color included, bytewise
+            ASSERT_EQ(0, memcmp(&expected[i * step + 12],
+                                &actual[i * step + 12], step - 12))
+              << this->vector_[v] << " step " << step << " channels "
+              << channels[c] << " n " << n << " point " << i;
+          }
+          ASSERT_EQ(0, memcmp(&expected[n * step], &actual[n * step], step));
+        }
+      }
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+TEST_F(DepthKernels, PackXYZRGBColors)
+{
+  ASSERT_TRUE(depth_kernels::SetImplementation("scalar"));
+  const float x[] = {1.0f}, y[] = {2.0f}, z[] = {3.0f};
+  const uint8_t rgb[] = {10, 20, 30};
+  std::vector<uint8_t> out(32, 0xAB);
+
+  depth_kernels::PackXYZRGB(x, y, z, rgb, 3, 1, out.data(), 32, 16);
+  EXPECT_EQ(10, out[16]);
+  EXPECT_EQ(20, out[17]);
+  EXPECT_EQ(30, out[18]);
+  EXPECT_EQ(0, out[19]);
+  float pad;
+  memcpy(&pad, &out[12], sizeof(pad));
+  EXPECT_EQ(0.0f, pad);
+  EXPECT_EQ(0xAB, out[20]);
+
+  depth_kernels::PackXYZRGB(x, y, z, rgb, 1, 1, out.data(), 32, 16);
+  EXPECT_EQ(10, out[16]);
+  EXPECT_EQ(10, out[17]);
+  EXPECT_EQ(10, out[18]);
+
+  depth_kernels::PackXYZRGB(x, y, z, NULL, 3, 1, out.data(), 32, 16);
+  EXPECT_EQ(0, out[16]);
+  EXPECT_EQ(0, out[18]);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,322 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <random>
+#include <string>
+
+#include <gazebo_plugins/point_cloud_codec.h>
+
+using gazebo::PointCloudCodec;
+
+namespace
+{
+// x, y, z, then an id to find each point again in the unordered decoded
+// cloud and an rgb like byte field
+const uint32_t POINT_STEP = 20;
+
+void AddField(sensor_msgs::PointCloud2 &_cloud, const std::string &_name,
+              uint32_t _offset, uint8_t _datatype, uint32_t _count)
+{
+  sensor_msgs::PointField field;
+  field.name = _name;
+  field.offset = _offset;
+  field.datatype = _datatype;
+  field.count = _count;
+  _cloud.fields.push_back(field);
+}
+
+sensor_msgs::PointCloud2 MakeCloud(uint32_t _width, uint32_t _height)
+{
+  sensor_msgs::PointCloud2 cloud;
+  cloud.width = _width;
+  cloud.height = _height;
+  AddField(cloud, "x", 0, sensor_msgs::PointField::FLOAT32, 1);
+  AddField(cloud, "y", 4, sensor_msgs::PointField::FLOAT32, 1);
+  AddField(cloud, "z", 8, sensor_msgs::PointField::FLOAT32, 1);
+  AddField(cloud, "id", 12, sensor_msgs::PointField::UINT32, 1);
+  AddField(cloud, "rgb", 16, sensor_msgs::PointField::UINT8, 4);
+  cloud.is_bigendian = false;
+  cloud.point_step = POINT_STEP;
+  cloud.row_step = POINT_STEP * _width;
+  cloud.data.resize(cloud.row_step * _height);
+  cloud.is_dense = false;
+  return cloud;
+}
+
+void SetPoint(sensor_msgs::PointCloud2 &_cloud, uint32_t _i,
+              float _x, float _y, float _z)
+{
+  uint8_t *p = &_cloud.data[_i * POINT_STEP];
+  memcpy(p, &_x, 4);
+  memcpy(p + 4, &_y, 4);
+  memcpy(p + 8, &_z, 4);
+  memcpy(p + 12, &_i, 4);
+  for (int b = 0; b < 4; ++b)
+    p[16 + b] = static_cast<uint8_t>(_i * 7 + b);
+}
+
+float Coordinate(const sensor_msgs::PointCloud2 &_cloud, size_t _i, int _k,
+                 uint32_t _offset)
+{
+  float v;
+  memcpy(&v, &_cloud.data[_i * _cloud.point_step + _offset + 4 * _k], 4);
+  return v;
+}
+
+/// \brief Check that _decoded holds the finite points of _cloud, within
+/// half the resolution, with their other fields unchanged
+void ExpectRoundTrip(const sensor_msgs::PointCloud2 &_cloud,
+                     const sensor_msgs::PointCloud2 &_decoded,
+                     float _resolution)
+{
+  ASSERT_EQ(5u, _decoded.fields.size());
+  EXPECT_EQ("id", _decoded.fields[3].name);
+  EXPECT_EQ("rgb", _decoded.fields[4].name);
+  EXPECT_EQ(4u, _decoded.fields[4].count);
+  EXPECT_EQ(1u, _decoded.height);
+  EXPECT_TRUE(_decoded.is_dense);
+  const uint32_t id_offset = _decoded.fields[3].offset;
+  const uint32_t rgb_offset = _decoded.fields[4].offset;
+
+  std::map<uint32_t, size_t> decoded;
+  for (size_t i = 0; i < _decoded.width; ++i)
+  {
+    uint32_t id;
+    memcpy(&id, &_decoded.data[i * _decoded.point_step + id_offset], 4);
+    EXPECT_TRUE(decoded.insert(std::make_pair(id, i)).second);
+  }
+
+  size_t finite = 0;
+  const size_t n = static_cast<size_t>(_cloud.width) * _cloud.height;
+  for (uint32_t i = 0; i < n; ++i)
+  {
+    bool is_finite = true;
+    for (int k = 0; k < 3; ++k)
+      is_finite = is_finite && std::isfinite(Coordinate(_cloud, i, k, 0));
+    if (!is_finite)
+    {
+      EXPECT_EQ(0u, decoded.count(i));
+      continue;
+    }
+    ++finite;
+    std::map<uint32_t, size_t>::const_iterator it = decoded.find(i);
+    ASSERT_NE(decoded.end(), it);
+    for (int k = 0; k < 3; ++k)
+    {
+      const float v = Coordinate(_cloud, i, k, 0);
+      // half the resolution, plus the float rounding of the result
+      const float tolerance = _resolution / 2 +
+        4 * std::numeric_limits<float>::epsilon() * std::fabs(v);
+      EXPECT_NEAR(v, Coordinate(_decoded, it->second, k, 0), tolerance);
+    }
+    EXPECT_EQ(0, memcmp(&_cloud.data[i * POINT_STEP + 16],
+      &_decoded.data[it->second * _decoded.point_step + rgb_offset], 4));
+  }
+  EXPECT_EQ(finite, _decoded.width);
+}
+
+sensor_msgs::PointCloud2 RoundTrip(const sensor_msgs::PointCloud2 &_cloud,
+                                   float _resolution, bool _entropy)
+{
+  PointCloudCodec codec(_resolution, _entropy);
+  gazebo_msgs::CompressedPointCloud msg;
+  EXPECT_TRUE(codec.Encode(_cloud, msg));
+  EXPECT_EQ(_entropy ? "gzpc+bz2" : "gzpc", msg.format);
+
+  sensor_msgs::PointCloud2 decoded;
+  std::string error;
+  EXPECT_TRUE(PointCloudCodec::Decode(msg, decoded, error)) << error;
+  return decoded;
+}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+TEST(PointCloudCodec, RandomClouds)
+{
+  std::mt19937 rng(1234);
+  std::uniform_real_distribution<float> position(-50.0f, 50.0f);
+  const float resolutions[] = { 0.001f, 0.01f, 0.37f };
+  for (float resolution : resolutions)
+  {
+    for (int entropy = 0; entropy < 2; ++entropy)
+    {
+      sensor_msgs::PointCloud2 cloud = MakeCloud(64, 48);
+      for (uint32_t i = 0; i < cloud.width * cloud.height; ++i)
+        SetPoint(cloud, i, position(rng), position(rng), position(rng));
+      ExpectRoundTrip(cloud, RoundTrip(cloud, resolution, entropy),
+                      resolution);
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+TEST(PointCloudCodec, NonFinitePoints)
+{
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  const float inf = std::numeric_limits<float>::infinity();
+  sensor_msgs::PointCloud2 cloud = MakeCloud(8, 2);
+  for (uint32_t i = 0; i < 16; ++i)
+    SetPoint(cloud, i, 0.1f * i, -0.2f * i, 1.0f);
+  SetPoint(cloud, 0, nan, 0, 0);
+  SetPoint(cloud, 5, 0, nan, 0);
+  SetPoint(cloud, 9, 0, 0, inf);
+  SetPoint(cloud, 15, -inf, nan, nan);
+
+  for (int entropy = 0; entropy < 2; ++entropy)
+  {
+    sensor_msgs::PointCloud2 decoded = RoundTrip(cloud, 0.001f, entropy);
+    EXPECT_EQ(12u, decoded.width);
+    ExpectRoundTrip(cloud, decoded, 0.001f);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+TEST(PointCloudCodec, EmptyClouds)
+{
+  for (int entropy = 0; entropy < 2; ++entropy)
+  {
+    sensor_msgs::PointCloud2 cloud = MakeCloud(0, 0);
+    sensor_msgs::PointCloud2 decoded = RoundTrip(cloud, 0.001f, entropy);
+    EXPECT_EQ(0u, decoded.width);
+    EXPECT_EQ(0u, decoded.row_step);
+    EXPECT_TRUE(decoded.data.empty());
+
+    // nothing but NaNs
+    cloud = MakeCloud(3, 1);
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    for (uint32_t i = 0; i < 3; ++i)
+      SetPoint(cloud, i, nan, nan, nan);
+    EXPECT_EQ(0u, RoundTrip(cloud, 0.001f, entropy).width);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Neighbours far apart in both directions, and on the same spot, exercise
+// the sign of the zigzag deltas
+TEST(PointCloudCodec, LargeDeltas)
+{
+  sensor_msgs::PointCloud2 cloud = MakeCloud(6, 1);
+  SetPoint(cloud, 0, -100000.0f, 100000.0f, 0.0f);
+  SetPoint(cloud, 1, 100000.0f, -100000.0f, 0.0f);
+  SetPoint(cloud, 2, 0.0f, 0.0f, -100000.0f);
+  SetPoint(cloud, 3, 0.0f, 0.0f, -100000.0f);
+  SetPoint(cloud, 4, -0.0005f, 0.0004f, 99999.999f);
+  SetPoint(cloud, 5, 1.0f, -1.0f, 0.5f);
+  for (int entropy = 0; entropy < 2; ++entropy)
+    ExpectRoundTrip(cloud, RoundTrip(cloud, 0.001f, entropy), 0.001f);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+TEST(PointCloudCodec, RejectsUnknownClouds)
+{
+  PointCloudCodec codec;
+  gazebo_msgs::CompressedPointCloud msg;
+  sensor_msgs::PointCloud2 cloud = MakeCloud(2, 1);
+  cloud.fields[2].name = "w";
+  EXPECT_FALSE(codec.Encode(cloud, msg));
+
+  cloud = MakeCloud(2, 1);
+  cloud.data.resize(cloud.data.size() - 1);
+  EXPECT_FALSE(codec.Encode(cloud, msg));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Every prefix of a valid message is rejected, none is read past its end
+TEST(PointCloudCodec, RejectsTruncatedMessages)
+{
+  sensor_msgs::PointCloud2 cloud = MakeCloud(16, 1);
+  for (uint32_t i = 0; i < 16; ++i)
+    SetPoint(cloud, i, 0.3f * i, 0.1f * i * i, -0.2f * i);
+
+  for (int entropy = 0; entropy < 2; ++entropy)
+  {
+    PointCloudCodec codec(0.001f, entropy);
+    gazebo_msgs::CompressedPointCloud msg;
+    ASSERT_TRUE(codec.Encode(cloud, msg));
+    const std::vector<uint8_t> data = msg.data;
+    for (size_t size = 0; size < data.size(); ++size)
+    {
+      msg.data.assign(data.begin(), data.begin() + size);
+      sensor_msgs::PointCloud2 decoded;
+      std::string error;
+      EXPECT_FALSE(PointCloudCodec::Decode(msg, decoded, error))
+        << "prefix of " << size << " bytes";
+      EXPECT_FALSE(error.empty());
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+TEST(PointCloudCodec, RejectsOversizedHeaders)
+{
+  sensor_msgs::PointCloud2 decoded;
+  std::string error;
+
+  // a point count the payload can not hold is rejected before the cloud is
+  // allocated
+  gazebo_msgs::CompressedPointCloud msg;
+  msg.format = "gzpc";
+  msg.resolution = 0.001f;
+  msg.points = 400000000;
+  msg.data.push_back(1);
+  msg.data.push_back(0);
+  EXPECT_FALSE(PointCloudCodec::Decode(msg, decoded, error));
+  EXPECT_EQ("truncated positions", error);
+  EXPECT_TRUE(decoded.data.empty());
+
+  // one point too many for the positions of a valid message
+  sensor_msgs::PointCloud2 cloud = MakeCloud(4, 1);
+  for (uint32_t i = 0; i < 4; ++i)
+    SetPoint(cloud, i, 1.0f * i, 2.0f, 3.0f);
+  PointCloudCodec codec(0.001f, false);
+  ASSERT_TRUE(codec.Encode(cloud, msg));
+  msg.points += 1;
+  EXPECT_FALSE(PointCloudCodec::Decode(msg, decoded, error));
+
+  // a bzip2 header promising far more than the stream inflates to
+  PointCloudCodec bz2(0.001f, true);
+  ASSERT_TRUE(bz2.Encode(cloud, msg));
+  msg.data[0] = msg.data[1] = msg.data[2] = msg.data[3] = 0xff;
+  EXPECT_FALSE(PointCloudCodec::Decode(msg, decoded, error));
+  EXPECT_EQ("corrupt bzip2 stream", error);
+
+  // and one promising less
+  ASSERT_TRUE(bz2.Encode(cloud, msg));
+  msg.data[0] = 1;
+  msg.data[1] = msg.data[2] = msg.data[3] = 0;
+  EXPECT_FALSE(PointCloudCodec::Decode(msg, decoded, error));
+
+  // unknown format and version
+  ASSERT_TRUE(codec.Encode(cloud, msg));
+  msg.format = "draco";
+  EXPECT_FALSE(PointCloudCodec::Decode(msg, decoded, error));
+  ASSERT_TRUE(codec.Encode(cloud, msg));
+  msg.data[0] = 2;
+  EXPECT_FALSE(PointCloudCodec::Decode(msg, decoded, error));
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,70 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef __GAZEBO_ROS_BACKLOG_REGISTRY_HH__
+#define __GAZEBO_ROS_BACKLOG_REGISTRY_HH__
+
+#include <stddef.h>
+
+#include <functional>
+#include <map>
+#include <string>
+
+#include <boost/thread/mutex.hpp>
+
+namespace gazebo
+{
+
+/// \brief Process wide registry of the outgoing message queues of the
+/// plugins, e.g. PubMultiQueue and AsyncImagePublisher queues.  In its
+/// backpressure mode gazebo_ros_api_plugin holds the next world step while
+/// they are deeper than allowed.
+class BacklogRegistry
+{
+public:
+  /// \brief Returns the number of messages waiting in a queue
+  typedef std::function<size_t()> DepthFunction;
+
+  static BacklogRegistry &instance();
+
+  /// \brief Register a queue.  depth is called from the world update
+  /// thread until remove() returns.
+  /// \return Handle for remove()
+  int add(const std::string &name, const DepthFunction &depth);
+
+  void remove(int id);
+
+  /// \brief Depth of the deepest queue
+  /// \param[out] name Name of that queue, if not null
+  size_t maxDepth(std::string *name = NULL);
+
+private:
+  BacklogRegistry() : next_id_(0) {}
+
+  struct Queue
+  {
+    std::string name;
+    DepthFunction depth;
+  };
+
+  boost::mutex mutex_;
+  std::map<int, Queue> queues_;
+  int next_id_;
+};
+
+}
+#endif
@@ -0,0 +1,84 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef __GAZEBO_ROS_COALESCING_QUEUE_HH__
+#define __GAZEBO_ROS_COALESCING_QUEUE_HH__
+
+#include <string>
+#include <vector>
+
+#include <boost/unordered_map.hpp>
+
+namespace gazebo
+{
+
+/// \brief Queue keeping only the latest message of each entity name.
+///
+/// A message for a name already queued replaces the queued one in place,
+/// so the queue is taken in order of first arrival.  Not thread safe, the
+/// owner locks around push() and take().
+template <class M>
+class CoalescingQueue
+{
+public:
+  CoalescingQueue() :
+    received_(0),
+    coalesced_(0)
+  {
+  }
+
+  /// \brief Queue msg for name, replacing the one queued for it
+  void push(const std::string &name, const M &msg)
+  {
+    ++received_;
+    std::pair<typename Index::iterator, bool> it = index_.emplace(name, messages_.size());
+    if (it.second)
+    {
+      messages_.push_back(msg);
+      return;
+    }
+    messages_[it.first->second] = msg;
+    ++coalesced_;
+  }
+
+  /// \brief Move all queued messages to out, which is cleared first
+  void take(std::vector<M> &out)
+  {
+    out.clear();
+    out.swap(messages_);
+    index_.clear();
+  }
+
+  bool empty() const { return messages_.empty(); }
+
+  /// \brief Messages pushed so far
+  unsigned long received() const { return received_; }
+
+  /// \brief Messages replaced by a later one before being taken
+  unsigned long coalesced() const { return coalesced_; }
+
+private:
+  typedef boost::unordered_map<std::string, size_t> Index;
+
+  std::vector<M> messages_;
+  Index index_;
+  unsigned long received_;
+  unsigned long coalesced_;
+};
+
+}
+#endif
@@ -0,0 +1,87 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef __GAZEBO_ROS_ENTITY_INDEX_HH__
+#define __GAZEBO_ROS_ENTITY_INDEX_HH__
+
+#include <string>
+
+#include <boost/thread/mutex.hpp>
+#include <boost/unordered_map.hpp>
+#include <boost/weak_ptr.hpp>
+
+#include <gazebo/physics/physics.hh>
+#include <gazebo/common/Events.hh>
+
+namespace gazebo
+{
+
+/// \brief Name to entity index of a world, answering the lookups of the
+/// gazebo_ros_api_plugin services in constant time.
+///
+/// Entities are indexed by name and by scoped name, the first one in world
+/// order winning like World::EntityByName does, joints as Model::GetJoint
+/// finds them in the first model having one of that name.  The index is
+/// rebuilt on the next lookup after the world adds or deletes an entity.
+/// Names it does not know are still looked up in the world, so an entity
+/// created without an event is found too, only slower.
+///
+/// Entities are held weakly, the index never keeps a deleted one alive.
+class EntityIndex
+{
+public:
+  /// \brief Constructor
+  explicit EntityIndex(gazebo::physics::WorldPtr world);
+
+  /// \brief Lookups, null if there is no such entity
+  gazebo::physics::EntityPtr entity(const std::string &name);
+  gazebo::physics::ModelPtr model(const std::string &name);
+  gazebo::physics::LinkPtr link(const std::string &name);
+  gazebo::physics::JointPtr joint(const std::string &name);
+
+  /// \brief Rebuild the index on the next lookup
+  void invalidate();
+
+private:
+  typedef boost::unordered_map<std::string, boost::weak_ptr<gazebo::physics::Entity> > EntityMap;
+  typedef boost::unordered_map<std::string, boost::weak_ptr<gazebo::physics::Joint> > JointMap;
+
+  /// \brief Rebuild the maps if invalidated, mutex_ held
+  void update();
+
+  /// \brief Add _entity and its descendants in depth first order
+  void addEntity(const gazebo::physics::BasePtr &base);
+
+  /// \brief Add the joints of a model
+  void addJoints(const gazebo::physics::ModelPtr &model);
+
+  /// \brief Events invalidating the index
+  void onEntityChange(const std::string &name);
+
+  gazebo::physics::WorldPtr world_;
+
+  boost::mutex mutex_;
+  bool dirty_;
+  EntityMap entities_;
+  JointMap joints_;
+
+  gazebo::event::ConnectionPtr add_entity_event_;
+  gazebo::event::ConnectionPtr delete_entity_event_;
+};
+
+}
+#endif
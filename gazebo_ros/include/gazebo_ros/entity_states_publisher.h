@@ -0,0 +1,244 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef __GAZEBO_ROS_ENTITY_STATES_PUBLISHER_HH__
+#define __GAZEBO_ROS_ENTITY_STATES_PUBLISHER_HH__
+
+#include <regex>
+#include <string>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/weak_ptr.hpp>
+#include <boost/thread.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <ignition/math/Pose3.hh>
+#include <ignition/math/Vector3.hh>
+
+#include <gazebo/physics/physics.hh>
+#include <gazebo/common/Time.hh>
+
+#include <ros/ros.h>
+#include "gazebo_msgs/ModelStates.h"
+#include "gazebo_msgs/LinkStates.h"
+#include "gazebo_msgs/EntityStatesDelta.h"
+#include "gazebo_msgs/EntityStatesNames.h"
+#include "gazebo_msgs/CompactEntityStates.h"
+
+#include <gazebo_ros/plugin_timing.h>
+#include <gazebo_ros/profiler.h>
+#include <gazebo_ros/shm_states_writer.h>
+
+namespace gazebo
+{
+
+/// \brief Publishes gazebo_msgs/ModelStates or gazebo_msgs/LinkStates of
+/// the whole world at a given sim time rate, off the physics thread.
+///
+/// capture() runs in WorldUpdateBegin and only copies the poses and twists
+/// into a snapshot.  The message is built and serialized by a worker
+/// thread, the physics loop never waits for it: when the worker is behind,
+/// the snapshot it has not picked up yet is replaced by the newer one.
+///
+/// The same snapshots can also go out as gazebo_msgs/EntityStatesDelta:
+/// a keyframe with all names and states every keyframe_interval, and in
+/// between only the entities that moved beyond the thresholds since they
+/// were last sent.
+///
+/// Or as gazebo_msgs/CompactEntityStates, float32 arrays whose names go out
+/// on a latched gazebo_msgs/EntityStatesNames only when they change.
+///
+/// A filter restricts the states to the entities whose name, the scoped
+/// one of links, starts with a prefix and matches a regular expression.  It
+/// is applied when the entity list is rebuilt, i.e. only when models were
+/// added or removed.
+///
+/// With a ShmStatesWriter set, the worker also writes every snapshot to
+/// shared memory for readers on the same host.
+class EntityStatesPublisher
+{
+public:
+  enum Kind
+  {
+    MODELS,
+    LINKS
+  };
+
+  /// \brief When the delta stream sends an entity again
+  struct DeltaOptions
+  {
+    DeltaOptions() :
+      keyframe_interval(1.0),
+      position_threshold(1e-4),
+      orientation_threshold(1e-4),
+      velocity_threshold(1e-3)
+    {
+    }
+
+    /// \brief Sim time between keyframes [s]
+    double keyframe_interval;
+    /// \brief [m]
+    double position_threshold;
+    /// \brief Rotation angle [rad]
+    double orientation_threshold;
+    /// \brief Of each component of the twist [m/s, rad/s]
+    double velocity_threshold;
+  };
+
+  /// \brief Constructor, starts the worker
+  /// \param kind Whether to publish the models or the links of world
+  /// \param rate Sim time rate in Hz, 0 to publish every world update
+  EntityStatesPublisher(Kind kind, gazebo::physics::WorldPtr world, double rate);
+
+  /// \brief Destructor, stops the worker
+  ~EntityStatesPublisher();
+
+  /// \brief Set the publisher the states go out on
+  void setPublisher(const ros::Publisher &pub);
+
+  /// \brief Set the publisher of the delta stream
+  void setDeltaPublisher(const ros::Publisher &pub, const DeltaOptions &options);
+
+  /// \brief Only publish the entities whose name starts with prefix and, if
+  /// regex is not empty, matches it.  Call before the first capture().
+  /// \throw std::regex_error if regex is invalid
+  void setFilter(const std::string &prefix, const std::string &regex);
+
+  /// \brief Name the stages of this publisher are timed under in the
+  /// TimingRegistry, the kind by default.  Call before the first capture().
+  void setTimingName(const std::string &name);
+
+  /// \brief Set the shared memory segment every snapshot is written to
+  void setShmWriter(const boost::shared_ptr<ShmStatesWriter> &writer);
+
+  /// \brief Set the publishers of the compact states and their names,
+  /// names_pub should be latched
+  void setCompactPublishers(const ros::Publisher &names_pub, const ros::Publisher &pub);
+
+  /// \brief Send a keyframe next, e.g. for a new delta subscriber
+  void requestKeyframe();
+
+  /// \brief Take a snapshot if the period elapsed, call on WorldUpdateBegin
+  void capture();
+
+private:
+  typedef boost::shared_ptr<const std::vector<std::string> > NamesPtr;
+
+  /// \brief Poses and twists of all entities at one time.  The names are
+  /// shared by all snapshots until the set of entities changes.
+  struct Snapshot
+  {
+    gazebo::common::Time stamp;
+    NamesPtr names;
+    std::vector<ignition::math::Pose3d> pose;
+    std::vector<ignition::math::Vector3d> linear_vel;
+    std::vector<ignition::math::Vector3d> angular_vel;
+  };
+
+  /// \brief Rebuild the entity list if models were added or removed
+  void refreshEntities();
+
+  /// \brief True if name passes the filter
+  bool selected(const std::string &name) const;
+
+  /// \brief Worker thread body
+  void workerThread();
+
+  /// \brief Fill msg from snapshot
+  template <class M>
+  void fillMessage(const Snapshot &snapshot, M &msg);
+
+  /// \brief Publish the delta of snapshot to the states last sent
+  void publishDelta(const Snapshot &snapshot, const ros::Publisher &pub, bool keyframe);
+
+  /// \brief Publish snapshot as compact states, and the names if changed
+  void publishCompact(const Snapshot &snapshot, const ros::Publisher &names_pub,
+                      const ros::Publisher &pub);
+
+  /// \brief True if entity i moved beyond the thresholds since last sent
+  bool changed(const Snapshot &snapshot, size_t i) const;
+
+  Kind kind_;
+  gazebo::physics::WorldPtr world_;
+  double period_;
+  gazebo::common::Time last_capture_time_;
+  bool captured_;
+
+  /// \brief Entities of the snapshots, touched by the physics thread only.
+  /// The models are held weakly so that deleted ones are not kept alive, the
+  /// entities are only dereferenced once models_ matched the world.
+  std::vector<boost::weak_ptr<gazebo::physics::Model> > models_;
+  std::vector<gazebo::physics::Entity *> entities_;
+  NamesPtr names_;
+
+  std::string filter_prefix_;
+  std::regex filter_regex_;
+  bool filter_has_regex_;
+
+  /// \brief back_ is filled by capture(), ready_ waits for the worker and
+  /// front_ is read by it.  capture() and the worker only swap them under
+  /// mutex_, so neither ever waits on the other's copy.
+  Snapshot buffers_[3];
+  Snapshot *back_;
+  Snapshot *ready_;
+  Snapshot *front_;
+  bool pending_;
+  bool stop_;
+  boost::mutex mutex_;
+  boost::condition_variable cond_;
+
+  ros::Publisher pub_;
+  ros::Publisher delta_pub_;
+  DeltaOptions delta_options_;
+  bool keyframe_requested_;
+  boost::shared_ptr<ShmStatesWriter> shm_writer_;
+  ros::Publisher compact_names_pub_;
+  ros::Publisher compact_pub_;
+
+  /// \brief Messages reused by the worker, the names are only copied in
+  /// when they change
+  gazebo_msgs::ModelStates model_states_;
+  gazebo_msgs::LinkStates link_states_;
+  NamesPtr msg_names_;
+
+  /// \brief Delta stream state of the worker: the message, the last
+  /// keyframe and the states last sent of every entity
+  gazebo_msgs::EntityStatesDelta delta_msg_;
+  NamesPtr delta_names_;
+  gazebo::common::Time last_keyframe_time_;
+  std::vector<ignition::math::Pose3d> sent_pose_;
+  std::vector<ignition::math::Vector3d> sent_linear_vel_;
+  std::vector<ignition::math::Vector3d> sent_angular_vel_;
+
+  /// \brief Compact stream state of the worker
+  gazebo_msgs::CompactEntityStates compact_msg_;
+  NamesPtr compact_names_;
+
+  /// \brief Copy of the states, building and publishing of the legacy
+  /// message, and the delta, compact and shared memory exports
+  TimingStage *capture_timing_;
+  TimingStage *convert_timing_;
+  TimingStage *publish_timing_;
+  TimingStage *export_timing_;
+
+  boost::thread worker_;
+};
+
+}
+#endif
@@ -28,6 +28,9 @@
 #include <signal.h>
 #include <errno.h>
 #include <iostream>
+#include <deque>
+#include <map>
+#include <set>
 
 #include <tinyxml.h>
 
@@ -44,12 +47,19 @@
 
 // Services
 #include "std_srvs/Empty.h"
+#include "std_srvs/SetBool.h"
 
 #include "gazebo_msgs/JointRequest.h"
 #include "gazebo_msgs/BodyRequest.h"
 
 #include "gazebo_msgs/SpawnModel.h"
 #include "gazebo_msgs/DeleteModel.h"
+#include "gazebo_msgs/SpawnModels.h"
+#include "gazebo_msgs/DeleteModels.h"
+#include "gazebo_msgs/DeleteEntitiesAsync.h"
+#include "gazebo_msgs/AwaitDeletion.h"
+#include "gazebo_msgs/SetModelTemplate.h"
+#include "gazebo_msgs/SpawnModelTemplate.h"
 #include "gazebo_msgs/DeleteLight.h"
 
 #include "gazebo_msgs/ApplyBodyWrench.h"
@@ -60,10 +70,18 @@
 #include "gazebo_msgs/SetJointProperties.h"
 
 #include "gazebo_msgs/GetWorldProperties.h"
+#include "gazebo_msgs/GetOccupancyGrid.h"
 
 #include "gazebo_msgs/GetModelProperties.h"
 #include "gazebo_msgs/GetModelState.h"
 #include "gazebo_msgs/SetModelState.h"
+#include "gazebo_msgs/SetModelStates.h"
+#include "gazebo_msgs/GetModelStates.h"
+#include "gazebo_msgs/RegisterRelativeStates.h"
+#include "gazebo_msgs/StepWorld.h"
+#include "gazebo_msgs/WorldState.h"
+#include "gazebo_msgs/SaveWorldState.h"
+#include "gazebo_msgs/RestoreWorldState.h"
 
 #include "gazebo_msgs/GetJointProperties.h"
 #include "gazebo_msgs/ApplyJointEffort.h"
@@ -81,7 +99,9 @@
 #include "gazebo_msgs/LinkState.h"
 #include "gazebo_msgs/ModelStates.h"
 #include "gazebo_msgs/LinkStates.h"
+#include "gazebo_msgs/EntityStatesDelta.h"
 #include "gazebo_msgs/PerformanceMetrics.h"
+#include "gazebo_msgs/PluginPerformanceMetric.h"
 
 #include "geometry_msgs/Vector3.h"
 #include "geometry_msgs/Wrench.h"
@@ -91,7 +111,11 @@
 // For model pose transform to set custom joint angles
 #include <ros/ros.h>
 #include <gazebo_msgs/SetModelConfiguration.h>
+#include <gazebo_msgs/SetModelConfigurations.h>
 #include <boost/shared_ptr.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/unordered_map.hpp>
+#include <boost/functional/hash.hpp>
 
 // For physics dynamics reconfigure
 #include <dynamic_reconfigure/server.h>
@@ -101,6 +125,22 @@
 
 #include <boost/algorithm/string.hpp>
 
+#include <gazebo_ros/backlog_registry.h>
+#include <gazebo_ros/coalescing_queue.h>
+#include <gazebo_ros/entity_index.h>
+#include <gazebo_ros/job_scheduler.h>
+#include <gazebo_ros/latency_tracer.h>
+#include <gazebo_ros/occupancy_rasterizer.h>
+#include <gazebo_ros/plugin_timing.h>
+#include <gazebo_ros/profiler.h>
+#include <gazebo_ros/sensor_buffer_pool.h>
+#include <gazebo_ros/startup_trace.h>
+#include <gazebo_ros/subscription_hints.h>
+#include <gazebo_ros/thread_policy.h>
+#include <gazebo_ros/shm_states_writer.h>
+#include <gazebo_ros/entity_states_publisher.h>
+#include <gazebo_ros/relative_states_publisher.h>
+
 #ifndef GAZEBO_ROS_HAS_PERFORMANCE_METRICS
 #if (GAZEBO_MAJOR_VERSION == 11 && GAZEBO_MINOR_VERSION > 1) || \
     (GAZEBO_MAJOR_VERSION == 9 && GAZEBO_MINOR_VERSION > 14)
@@ -112,6 +152,14 @@ namespace gazebo
 {
 
 /// \brief A plugin loaded within the gzserver on startup.
+///
+/// Its node is gazebo in the namespace of the process.  Several gzservers,
+/// each with its own GAZEBO_MASTER_URI, share one ROS master when started in
+/// different namespaces, e.g. `gzserver __ns:=/sim3` or ROS_NAMESPACE=sim3:
+/// the topics, services and parameters are then under /sim3/gazebo, the
+/// shared memory names are prefixed with sim3_, and with ~shared_clock set
+/// to false the sim time goes to /sim3/clock rather than to /clock.  Clients
+/// of that world remap /clock:=/sim3/clock.
 class GazeboRosApiPlugin : public SystemPlugin
 {
 public:
@@ -147,9 +195,37 @@ public:
   /// \brief Callback for a subscriber disconnecting from LinkStates ros topic.
   void onLinkStatesDisconnect();
 
+  /// \brief Callback for a subscriber connecting to the incremental LinkStates
+  /// topic, disconnecting is handled by onLinkStatesDisconnect.
+  void onLinkStatesDeltaConnect();
+
+  /// \brief Callback for a subscriber connecting to the incremental ModelStates
+  /// topic, disconnecting is handled by onModelStatesDisconnect.
+  void onModelStatesDeltaConnect();
+
   /// \brief Callback for a subscriber disconnecting from ModelStates ros topic.
   void onModelStatesDisconnect();
 
+  /// \brief A topic of the states of the links or models of filtered_states
+  struct FilteredStates
+  {
+    FilteredStates() : connection_count(0) {}
+
+    boost::shared_ptr<EntityStatesPublisher> publisher;
+    ros::Publisher pub;
+    int connection_count;
+    gazebo::event::ConnectionPtr event;
+  };
+  typedef boost::shared_ptr<FilteredStates> FilteredStatesPtr;
+
+  /// \brief Advertise the topics of the filtered_states parameter
+  void advertiseFilteredStates();
+
+  /// \brief Callbacks for a subscriber connecting to or disconnecting from
+  /// a filtered states topic
+  void onFilteredStatesConnect(FilteredStates *filtered);
+  void onFilteredStatesDisconnect(FilteredStates *filtered);
+
 #ifdef GAZEBO_ROS_HAS_PERFORMANCE_METRICS
   /// \brief Callback for a subscriber connecting to PerformanceMetrics ros topic.
   void onPerformanceMetricsConnect();
@@ -166,12 +242,70 @@ public:
   bool spawnSDFModel(gazebo_msgs::SpawnModel::Request &req,
                      gazebo_msgs::SpawnModel::Response &res);
 
+  /// \brief resolve package:// paths and strip the declaration and comments of a URDF
+  bool resolveURDF(std::string &model_xml, std::string &status_message);
+
+  /// \brief Model xml as parsed for spawning, before the name, pose and namespace of an instance
+  struct ParsedModel
+  {
+    std::string source;
+    bool resolve_urdf;
+    TiXmlDocument doc;
+    bool is_sdf;
+    bool is_urdf;
+  };
+  typedef boost::shared_ptr<const ParsedModel> ParsedModelConstPtr;
+  typedef boost::unordered_map<std::size_t, ParsedModelConstPtr> ParsedModelMap;
+
+  /// \brief parse model xml, or take it from the cache keyed by its content hash.
+  /// \param resolve_urdf resolve package:// paths of a URDF first
+  /// \return null with status_message set if a URDF package does not exist
+  ParsedModelConstPtr parseModel(const std::string &model_xml, bool resolve_urdf,
+                                 std::string &status_message);
+
+  /// \brief set or remove a model template to spawn by name
+  bool setModelTemplate(gazebo_msgs::SetModelTemplate::Request &req,
+                        gazebo_msgs::SetModelTemplate::Response &res);
+
+  /// \brief spawn an instance of a model template
+  bool spawnModelTemplate(gazebo_msgs::SpawnModelTemplate::Request &req,
+                          gazebo_msgs::SpawnModelTemplate::Response &res);
+
+  /// \brief build the model xml sent to spawn, false with res set if the request is invalid
+  bool buildSpawnXml(gazebo_msgs::SpawnModel::Request &req, const ParsedModel &parsed,
+                     TiXmlDocument &gazebo_model_xml, gazebo_msgs::SpawnModel::Response &res);
+
+  /// \brief spawn many models at once, waiting for all of them together
+  bool spawnModels(gazebo_msgs::SpawnModels::Request &req,gazebo_msgs::SpawnModels::Response &res);
+
   /// \brief delete model given name
   bool deleteModel(gazebo_msgs::DeleteModel::Request &req,gazebo_msgs::DeleteModel::Response &res);
 
+  /// \brief clear the jobs of a model and send its delete request, false if there is no such model
+  bool pushDelete(const std::string &model_name, std::string &status_message);
+
+  /// \brief delete many models at once, waiting for all of them together
+  bool deleteModels(gazebo_msgs::DeleteModels::Request &req,gazebo_msgs::DeleteModels::Response &res);
+
   /// \brief delete a given light by name
   bool deleteLight(gazebo_msgs::DeleteLight::Request &req,gazebo_msgs::DeleteLight::Response &res);
 
+  /// \brief send the delete request of a light, false if there is no such light
+  bool pushDeleteLight(const std::string &light_name, std::string &status_message);
+
+  /// \brief true if the world has a light of that name
+  bool lightExists(const std::string &light_name);
+
+  /// \brief send the delete requests of models and lights and return a ticket for awaitDeletion
+  bool deleteEntitiesAsync(gazebo_msgs::DeleteEntitiesAsync::Request &req,
+                           gazebo_msgs::DeleteEntitiesAsync::Response &res);
+
+  /// \brief wait until the entities of a deleteEntitiesAsync ticket are gone
+  bool awaitDeletion(gazebo_msgs::AwaitDeletion::Request &req,gazebo_msgs::AwaitDeletion::Response &res);
+
+  /// \brief drop the wrench and effort jobs of every link and joint of a model
+  void clearModelJobs(const std::string &model_name);
+
   /// \brief
   bool getModelState(gazebo_msgs::GetModelState::Request &req,gazebo_msgs::GetModelState::Response &res);
 
@@ -181,6 +315,9 @@ public:
   /// \brief
   bool getWorldProperties(gazebo_msgs::GetWorldProperties::Request &req,gazebo_msgs::GetWorldProperties::Response &res);
 
+  /// \brief rasterize the collision geometry of models into an occupancy or voxel grid
+  bool getOccupancyGrid(gazebo_msgs::GetOccupancyGrid::Request &req,gazebo_msgs::GetOccupancyGrid::Response &res);
+
   /// \brief
   bool getJointProperties(gazebo_msgs::GetJointProperties::Request &req,gazebo_msgs::GetJointProperties::Response &res);
 
@@ -199,9 +336,16 @@ public:
   /// \brief
   bool setLinkProperties(gazebo_msgs::SetLinkProperties::Request &req,gazebo_msgs::SetLinkProperties::Response &res);
 
-  /// \brief
+  /// \brief stage physics properties for the next world update and wait for them, without pausing
   bool setPhysicsProperties(gazebo_msgs::SetPhysicsProperties::Request &req,gazebo_msgs::SetPhysicsProperties::Response &res);
 
+  /// \brief stage physics properties for the next world update, replacing any staged ones, returns the batch
+  /// number to wait for
+  unsigned int queuePhysicsProperties(const gazebo_msgs::SetPhysicsProperties::Request &properties);
+
+  /// \brief set gravity, step size, update rate and the ODE solver, from the world update
+  void applyPhysicsProperties(const gazebo_msgs::SetPhysicsProperties::Request &properties);
+
   /// \brief
   bool getPhysicsProperties(gazebo_msgs::GetPhysicsProperties::Request &req,gazebo_msgs::GetPhysicsProperties::Response &res);
 
@@ -214,6 +358,67 @@ public:
   /// \brief
   void updateModelState(const gazebo_msgs::ModelState::ConstPtr& model_state);
 
+  /// \brief A model state resolved to the world frame
+  struct ModelStateCommand
+  {
+    gazebo::physics::ModelPtr model;
+    ignition::math::Pose3d pose;
+    ignition::math::Vector3d linear_vel;
+    ignition::math::Vector3d angular_vel;
+  };
+
+  /// \brief look up the model and reference frame of a model state, false with status_message set if either does not exist
+  bool resolveModelState(const gazebo_msgs::ModelState &model_state, ModelStateCommand &command,
+                         std::string &status_message);
+
+  /// \brief set the pose and twist of a model
+  void applyModelState(const ModelStateCommand &command);
+
+  /// \brief queue model states for the next world update, returns the batch number to wait for
+  unsigned int queueModelStates(const std::vector<ModelStateCommand> &commands);
+
+  /// \brief Callback to WorldUpdateBegin applying the staged physics properties and all queued model and link
+  /// states at once
+  void applyQueuedModelStates();
+
+  /// \brief block until a queued batch was applied, applying it here if the world is paused
+  void waitForModelStates(unsigned int batch);
+
+  /// \brief set many model states in the same world update
+  bool setModelStates(gazebo_msgs::SetModelStates::Request &req,gazebo_msgs::SetModelStates::Response &res);
+
+  /// \brief topic version of setModelStates, world frame states without waiting
+  void updateModelStates(const gazebo_msgs::ModelStates::ConstPtr& model_states);
+
+  /// \brief A link state resolved to the world frame
+  struct LinkStateCommand
+  {
+    gazebo::physics::LinkPtr link;
+    ignition::math::Pose3d pose;
+    ignition::math::Vector3d linear_vel;
+    ignition::math::Vector3d angular_vel;
+  };
+
+  /// \brief look up the link and reference frame of a link state, false with status_message set if either does not exist
+  bool resolveLinkState(const gazebo_msgs::LinkState &link_state, LinkStateCommand &command,
+                        std::string &status_message);
+
+  /// \brief queue link states with the model states, returns the batch number to wait for
+  unsigned int queueLinkStates(const std::vector<LinkStateCommand> &commands);
+
+  /// \brief save the inertial pose, twist and wrench of every link and the joint positions of every
+  /// model to a slot
+  bool saveWorldState(gazebo_msgs::SaveWorldState::Request &req,gazebo_msgs::SaveWorldState::Response &res);
+
+  /// \brief restore a saved or given world state, all links in the same world update
+  bool restoreWorldState(gazebo_msgs::RestoreWorldState::Request &req,gazebo_msgs::RestoreWorldState::Response &res);
+
+  /// \brief Callback to WorldUpdateBegin applying the latest set_model_state and set_link_state topic messages
+  void applyStateTopics();
+
+  /// \brief get many model states of the same sim time
+  bool getModelStates(gazebo_msgs::GetModelStates::Request &req,gazebo_msgs::GetModelStates::Response &res);
+
   /// \brief
   bool applyJointEffort(gazebo_msgs::ApplyJointEffort::Request &req,gazebo_msgs::ApplyJointEffort::Response &res);
 
@@ -223,6 +428,14 @@ public:
   /// \brief
   bool resetWorld(std_srvs::Empty::Request &req,std_srvs::Empty::Response &res);
 
+  /// \brief Switch the profiling of the ROS plugins on or off, off writes
+  /// ~profiling_trace_file if set
+  bool setProfiling(std_srvs::SetBool::Request &req,std_srvs::SetBool::Response &res);
+
+  /// \brief Switch the latency tracing of the sensor plugins on or off, off
+  /// writes ~latency_trace_file if set
+  bool setLatencyTracing(std_srvs::SetBool::Request &req,std_srvs::SetBool::Response &res);
+
   /// \brief
   bool pausePhysics(std_srvs::Empty::Request &req,std_srvs::Empty::Response &res);
 
@@ -240,6 +453,31 @@ public:
   /// \brief
   bool setModelConfiguration(gazebo_msgs::SetModelConfiguration::Request &req,gazebo_msgs::SetModelConfiguration::Response &res);
 
+  /// \brief Joint positions of a model, by scoped joint name as
+  /// Model::SetJointPositions takes them
+  struct ModelConfigurationCommand
+  {
+    gazebo::physics::ModelPtr model;
+    std::map<std::string, double> positions;
+  };
+
+  /// \brief look up the model and joints of a model configuration through the entity index, false with
+  /// status_message set if any does not exist
+  bool resolveModelConfiguration(const gazebo_msgs::ModelConfiguration &configuration,
+                                 ModelConfigurationCommand &command, std::string &status_message);
+
+  /// \brief queue model configurations with the model states, returns the batch number to wait for
+  unsigned int queueModelConfigurations(const std::vector<ModelConfigurationCommand> &commands);
+
+  /// \brief queue link states and model configurations for the same world update, returns the batch
+  /// number to wait for
+  unsigned int queueWorldState(const std::vector<LinkStateCommand> &link_commands,
+                               const std::vector<ModelConfigurationCommand> &configuration_commands);
+
+  /// \brief set the joint positions of many models in the same world update
+  bool setModelConfigurations(gazebo_msgs::SetModelConfigurations::Request &req,
+                              gazebo_msgs::SetModelConfigurations::Response &res);
+
   /// \brief
   bool setLinkState(gazebo_msgs::SetLinkState::Request &req,gazebo_msgs::SetLinkState::Response &res);
 
@@ -257,17 +495,61 @@ private:
   /// \brief
   void forceJointSchedulerSlot();
 
-  /// \brief Callback to WorldUpdateBegin that publishes /clock.
+  /// \brief Callback to WorldUpdateBegin applying the efforts and wrenches of a running stepWorld
+  void stepCommandSlot();
+
+  /// \brief apply efforts, wrenches and states, run the world a number of steps and return a snapshot
+  bool stepWorld(gazebo_msgs::StepWorld::Request &req,gazebo_msgs::StepWorld::Response &res);
+
+  /// \brief Callback to WorldUpdateBegin that publishes /clock, or clock in
+  /// the namespace of the process without ~shared_clock, and then also sets
+  /// the ros::Time of the process.
   /// If pub_clock_frequency_ <= 0 (default behavior), it publishes every time step.
-  /// Otherwise, it attempts to publish at that frequency in Hz.
+  /// Otherwise, it attempts to publish at that frequency in Hz, with
+  /// pub_clock_aligned_ once per period of sim time.  The shared memory
+  /// clock is written every time step.
   void publishSimTime();
 
-  /// \brief
+  /// \brief Callback to WorldUpdateEnd of the ~backpressure mode, holds the
+  /// next step until the plugin publish queues are at most
+  /// ~backpressure_max_queue_depth deep and every critical consumer acked a
+  /// sim time at most ~backpressure_max_lag old, or ~backpressure_max_stall
+  /// wall seconds passed (0 waits indefinitely)
+  void backpressureSlot();
+
+  /// \brief True if the next step may run, otherwise what it waits for.
+  /// Call with backpressure_mutex_ held
+  bool backpressureClear(const gazebo::common::Time &sim_time, std::string &waiting_for);
+
+  /// \brief A critical consumer reports the sim time it has processed
+  void onConsumerAck(const rosgraph_msgs::Clock::ConstPtr &msg, size_t consumer);
+
+  /// \brief Log the StartupTrace report of the plugin loads once they are
+  /// over, and write ~startup_trace_file if set
+  void startupReportTimer(const ros::WallTimerEvent &event);
+
+  /// \brief Callback to WorldUpdateBegin that snapshots the link states for
+  /// link_states_publisher_
   void publishLinkStates();
 
-  /// \brief
+  /// \brief Callback to WorldUpdateBegin that snapshots the model states for
+  /// model_states_publisher_
   void publishModelStates();
 
+  /// \brief Callbacks for a subscriber connecting to or disconnecting from
+  /// relative_states
+  void onRelativeStatesConnect();
+  void onRelativeStatesDisconnect();
+
+  /// \brief Callback to WorldUpdateBegin that snapshots the registered
+  /// entities for relative_states_publisher_
+  void publishRelativeStates();
+
+  /// \brief register (entity, reference frame) pairs for relative_states,
+  /// resolved once through the entity index
+  bool registerRelativeStates(gazebo_msgs::RegisterRelativeStates::Request &req,
+                              gazebo_msgs::RegisterRelativeStates::Response &res);
+
   /// \brief
   void stripXmlDeclaration(std::string &model_xml);
 
@@ -292,6 +574,16 @@ private:
   bool spawnAndConform(TiXmlDocument &gazebo_model_xml, const std::string &model_name,
                        gazebo_msgs::SpawnModel::Response &res);
 
+  /// \brief publish the spawn of an entity without waiting for it, false if it already exists
+  bool pushSpawn(TiXmlDocument &gazebo_model_xml, const std::string &model_name,
+                 bool &is_light, std::string &status_message);
+
+  /// \brief true if the world has the spawned entity
+  bool entitySpawned(const std::string &model_name, bool is_light);
+
+  /// \brief true if the world has a model of that name
+  bool modelExists(const std::string &model_name);
+
   /// \brief helper function for applyBodyWrench
   ///        shift wrench from reference frame to target frame
   void transformWrench(ignition::math::Vector3d &target_force, ignition::math::Vector3d &target_torque,
@@ -299,7 +591,8 @@ private:
                        const ignition::math::Vector3d &reference_torque,
                        const ignition::math::Pose3d &target_to_reference );
 
-  /// \brief Used for the dynamic reconfigure callback function template
+  /// \brief Used for the dynamic reconfigure callback function template, stages changed properties without
+  /// waiting for them, so changes made before the next world update are applied together
   void physicsReconfigureCallback(gazebo_ros::PhysicsConfig &config, uint32_t level);
 
   /// \brief waits for the rest of Gazebo to be ready before initializing the dynamic reconfigure services
@@ -308,6 +601,15 @@ private:
   /// \brief Unused
   void onResponse(ConstResponsePtr &response);
 
+  /// \brief World entity add and delete events, wake the services waiting for a spawn or delete
+  void onEntityEvent(const std::string &name);
+
+  /// \brief Number of entity events so far
+  unsigned int entityEventCount();
+
+  /// \brief Block until an entity event after the count seen, or at most 100 ms
+  void waitForEntityEvent(unsigned int seen);
+
 #ifdef GAZEBO_ROS_HAS_PERFORMANCE_METRICS
   /// \brief Subscriber callback for performance metrics. This will be send in the ROS network
   void onPerformanceMetrics(const boost::shared_ptr<gazebo::msgs::PerformanceMetrics const> &msg);
@@ -346,24 +648,121 @@ private:
   gazebo::transport::SubscriberPtr response_sub_;
 
   boost::shared_ptr<ros::NodeHandle> nh_;
+  /// \brief Transport of the set_*_state topics and backpressure acks,
+  /// from ~transport_hints
+  SubscriptionHints subscription_hints_;
   ros::CallbackQueue gazebo_queue_;
   boost::shared_ptr<boost::thread> gazebo_callback_queue_thread_;
+  /// \brief Queue of the read only services and its threads
+  ros::CallbackQueue gazebo_read_queue_;
+  boost::shared_ptr<ros::AsyncSpinner> read_queue_spinner_;
 
   gazebo::physics::WorldPtr world_;
+
+  /// \brief Name to model, link and joint lookups shared by the services
+  boost::shared_ptr<EntityIndex> entity_index_;
+
+  /// \brief Voxels of the models rasterized by getOccupancyGrid, cached per model
+  OccupancyRasterizer occupancy_rasterizer_;
   gazebo::event::ConnectionPtr wrench_update_event_;
   gazebo::event::ConnectionPtr force_update_event_;
   gazebo::event::ConnectionPtr time_update_event_;
   gazebo::event::ConnectionPtr pub_link_states_event_;
   gazebo::event::ConnectionPtr pub_model_states_event_;
+  gazebo::event::ConnectionPtr pub_relative_states_event_;
   gazebo::event::ConnectionPtr load_gazebo_ros_api_plugin_event_;
+  gazebo::event::ConnectionPtr add_entity_event_;
+  gazebo::event::ConnectionPtr delete_entity_event_;
+
+  /// \brief Entity event count, signalled on entity_event_cond_
+  boost::mutex entity_event_mutex_;
+  boost::condition_variable entity_event_cond_;
+  unsigned int entity_event_count_;
+
+  /// \brief Entities of a deleteEntitiesAsync call, still to be confirmed gone
+  class DeletionTicket
+  {
+  public:
+    std::vector<std::string> models;
+    std::vector<std::string> lights;
+    ros::WallTime created;
+  };
+  /// \brief Open tickets by number, guarded by deletion_tickets_mutex_.  A ticket is closed once
+  /// awaitDeletion saw all of its entities gone, or after deletion_ticket_lifetime_ seconds.
+  std::map<uint32_t, DeletionTicket> deletion_tickets_;
+  uint32_t next_deletion_ticket_;
+  boost::mutex deletion_tickets_mutex_;
+  static const double deletion_ticket_lifetime_;
+
+  /// \brief Seconds the spawn services wait for the entity to appear
+  double spawn_timeout_;
+
+  /// \brief Parsed models of recent spawns, oldest dropped first beyond model_cache_size_
+  ParsedModelMap parsed_models_;
+  std::deque<std::size_t> parsed_model_order_;
+  int model_cache_size_;
+
+  /// \brief Model and link states waiting for the next world update, batches are numbered as queued
+  std::vector<ModelStateCommand> model_state_commands_;
+  std::vector<LinkStateCommand> link_state_commands_;
+  std::vector<ModelConfigurationCommand> model_configuration_commands_;
+  /// \brief Physics properties waiting for the next world update, the latest request wins
+  gazebo_msgs::SetPhysicsProperties::Request physics_properties_command_;
+  bool physics_properties_pending_;
+  unsigned int model_state_batches_queued_;
+  unsigned int model_state_batches_applied_;
+  boost::mutex model_state_mutex_;
+  boost::condition_variable model_state_cond_;
+  gazebo::event::ConnectionPtr model_state_update_event_;
+
+  /// \brief Latest set_model_state and set_link_state topic message of each entity
+  CoalescingQueue<gazebo_msgs::ModelState> model_state_topic_queue_;
+  CoalescingQueue<gazebo_msgs::LinkState> link_state_topic_queue_;
+  boost::mutex state_topic_mutex_;
+  gazebo::event::ConnectionPtr state_topic_update_event_;
+
+  /// \brief Name lists of get_model_properties results by requested name,
+  /// cleared when entities are added or deleted.  Mass, inertia and
+  /// gravity can change behind the plugin's back and are always read live.
+  /// The model is kept to check the name still refers to it.
+  struct CachedModelProperties
+  {
+    boost::weak_ptr<gazebo::physics::Model> model;
+    gazebo_msgs::GetModelProperties::Response res;
+  };
+  boost::unordered_map<std::string, CachedModelProperties> model_properties_cache_;
+  /// \brief Bumped on every clear, a result is only cached if it did not
+  /// change while the result was gathered
+  uint64_t properties_cache_generation_;
+  boost::mutex properties_cache_mutex_;
+
+  /// \brief A world state saved with save_world_state
+  struct SavedWorldState
+  {
+    gazebo_msgs::WorldState state;
+    std::vector<gazebo_msgs::ModelConfiguration> model_configurations;
+  };
+
+  /// \brief World states saved by slot name
+  std::map<std::string, SavedWorldState> world_state_slots_;
+
+  /// \brief Models spawned by template name
+  std::map<std::string, ParsedModelConstPtr> model_templates_;
 
   ros::ServiceServer spawn_sdf_model_service_;
   ros::ServiceServer spawn_urdf_model_service_;
   ros::ServiceServer delete_model_service_;
+  ros::ServiceServer spawn_models_service_;
+  ros::ServiceServer delete_models_service_;
+  ros::ServiceServer set_model_template_service_;
+  ros::ServiceServer spawn_model_template_service_;
   ros::ServiceServer delete_light_service_;
+  ros::ServiceServer delete_entities_async_service_;
+  ros::ServiceServer await_deletion_service_;
   ros::ServiceServer get_model_state_service_;
   ros::ServiceServer get_model_properties_service_;
   ros::ServiceServer get_world_properties_service_;
+  ros::ServiceServer get_occupancy_grid_service_;
   ros::ServiceServer get_joint_properties_service_;
   ros::ServiceServer get_link_properties_service_;
   ros::ServiceServer get_link_state_service_;
@@ -375,22 +774,44 @@ private:
   ros::ServiceServer apply_body_wrench_service_;
   ros::ServiceServer set_joint_properties_service_;
   ros::ServiceServer set_model_state_service_;
+  ros::ServiceServer set_model_states_service_;
+  ros::ServiceServer get_model_states_service_;
+  ros::ServiceServer register_relative_states_service_;
+  ros::ServiceServer step_world_service_;
+  ros::ServiceServer save_world_state_service_;
+  ros::ServiceServer restore_world_state_service_;
   ros::ServiceServer apply_joint_effort_service_;
   ros::ServiceServer set_model_configuration_service_;
+  ros::ServiceServer set_model_configurations_service_;
   ros::ServiceServer set_link_state_service_;
   ros::ServiceServer reset_simulation_service_;
   ros::ServiceServer reset_world_service_;
+  ros::ServiceServer set_profiling_service_;
+  ros::ServiceServer set_latency_tracing_service_;
   ros::ServiceServer pause_physics_service_;
   ros::ServiceServer unpause_physics_service_;
   ros::ServiceServer clear_joint_forces_service_;
   ros::ServiceServer clear_body_wrenches_service_;
   ros::Subscriber    set_link_state_topic_;
   ros::Subscriber    set_model_state_topic_;
+  ros::Subscriber    set_model_states_topic_;
   ros::Publisher     pub_link_states_;
   ros::Publisher     pub_model_states_;
+  ros::Publisher     pub_link_states_delta_;
+  ros::Publisher     pub_model_states_delta_;
+  ros::Publisher     pub_link_states_compact_;
+  ros::Publisher     pub_link_states_compact_names_;
+  ros::Publisher     pub_model_states_compact_;
+  ros::Publisher     pub_model_states_compact_names_;
   ros::Publisher     pub_performance_metrics_;
   int                pub_link_states_connection_count_;
   int                pub_model_states_connection_count_;
+  boost::shared_ptr<EntityStatesPublisher> link_states_publisher_;
+  boost::shared_ptr<EntityStatesPublisher> model_states_publisher_;
+  ros::Publisher     pub_relative_states_;
+  int                pub_relative_states_connection_count_;
+  boost::shared_ptr<RelativeStatesPublisher> relative_states_publisher_;
+  std::vector<FilteredStatesPtr> filtered_states_;
   int                pub_performance_metrics_connection_count_;
 
   // ROS comm
@@ -400,13 +821,37 @@ private:
   boost::shared_ptr<boost::thread> physics_reconfigure_thread_;
   bool physics_reconfigure_initialized_;
   ros::ServiceClient physics_reconfigure_set_client_;
-  ros::ServiceClient physics_reconfigure_get_client_;
   boost::shared_ptr< dynamic_reconfigure::Server<gazebo_ros::PhysicsConfig> > physics_reconfigure_srv_;
   dynamic_reconfigure::Server<gazebo_ros::PhysicsConfig>::CallbackType physics_reconfigure_callback_;
 
   ros::Publisher     pub_clock_;
   int pub_clock_frequency_;
+  bool pub_clock_aligned_;
+  bool shared_clock_;
   gazebo::common::Time last_pub_clock_time_;
+  int64_t last_pub_clock_period_;
+  boost::shared_ptr<ShmClockWriter> clock_shm_writer_;
+  ros::WallTimer startup_report_timer_;
+  double startup_report_quiet_;
+  std::string startup_trace_file_;
+  TimingStage *clock_timing_;
+
+  /// \brief Backpressure mode, see backpressureSlot()
+  bool backpressure_;
+  int backpressure_max_queue_depth_;
+  double backpressure_max_lag_;
+  double backpressure_max_stall_;
+  gazebo::event::ConnectionPtr backpressure_event_;
+  /// \brief Ack topics of the critical consumers and their last acks,
+  /// guarded by backpressure_mutex_
+  std::vector<std::string> backpressure_consumers_;
+  std::vector<ros::Subscriber> backpressure_ack_subs_;
+  std::vector<gazebo::common::Time> backpressure_acks_;
+  std::vector<bool> backpressure_acked_;
+  boost::mutex backpressure_mutex_;
+  boost::condition_variable backpressure_cond_;
+  unsigned long backpressure_stalls_;
+  TimingStage *backpressure_timing_;
 
   /// \brief A mutex to lock access to fields that are used in ROS message callbacks
   boost::mutex lock_;
@@ -432,11 +877,42 @@ private:
     ros::Duration duration;
   };
 
-  std::vector<GazeboRosApiPlugin::WrenchBodyJob*> wrench_body_jobs_;
-  std::vector<GazeboRosApiPlugin::ForceJointJob*> force_joint_jobs_;
+  /// \brief apply a job, false to drop it
+  static bool applyWrenchBodyJob(const WrenchBodyJob &job);
+  static bool applyForceJointJob(const ForceJointJob &job);
+
+  /// \brief job matches for clearBodyWrenches, clearJointForces and clearModelJobs
+  static bool isBodyJob(const WrenchBodyJob &job, const std::string &body_name);
+  static bool isJointJob(const ForceJointJob &job, const std::string &joint_name);
+  static bool isModelBodyJob(const WrenchBodyJob &job, const std::string &model_prefix);
+  static bool isModelJointJob(const ForceJointJob &job, const std::string &model_prefix);
+
+  /// \brief top level model of a scoped link or joint name, the key of model_jobs_
+  static std::string jobModel(const std::string &scoped_name);
+
+  /// \brief Efforts and wrenches applied on every step of a running stepWorld, guarded by lock_
+  class StepWrench
+  {
+  public:
+    gazebo::physics::LinkPtr body;
+    ignition::math::Vector3d force;
+    ignition::math::Vector3d torque;
+  };
+  std::vector<std::pair<gazebo::physics::JointPtr, double> > step_joint_efforts_;
+  std::vector<StepWrench> step_wrenches_;
+  gazebo::event::ConnectionPtr step_command_event_;
+
+  /// \brief body wrench and joint effort jobs, guarded by lock_
+  JobScheduler<GazeboRosApiPlugin::WrenchBodyJob> wrench_body_jobs_;
+  JobScheduler<GazeboRosApiPlugin::ForceJointJob> force_joint_jobs_;
+
+  /// \brief top level models that jobs were added for since their last clearModelJobs, guarded by
+  /// lock_.  Deleting a model without jobs then skips both job lists.
+  std::set<std::string> model_jobs_;
 
   /// \brief index counters to count the accesses on models via GetModelState
   std::map<std::string, unsigned int> access_count_get_model_state_;
+  boost::mutex access_count_mutex_;
 
   /// \brief enable the communication of gazebo information using ROS service/topics
   bool enable_ros_network_;
@@ -0,0 +1,159 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef __GAZEBO_ROS_JOB_SCHEDULER_HH__
+#define __GAZEBO_ROS_JOB_SCHEDULER_HH__
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+
+#include <ros/time.h>
+
+namespace gazebo
+{
+
+/// \brief Time ordered store of jobs that run every step from their
+/// start_time for their duration, or forever if the duration is negative.
+///
+/// Jobs that have not started wait in a min-heap on start_time, so a step
+/// only looks at the jobs due and the ones running.  Running jobs keep the
+/// order they were added in, which decides which one wins when two of them
+/// set the same force.  Jobs are held by value, J needs
+/// ros::Time start_time and ros::Duration duration members.  Not thread
+/// safe, the owner locks around all calls.
+template <class J>
+class JobScheduler
+{
+public:
+  JobScheduler() :
+    next_seq_(0)
+  {
+  }
+
+  /// \brief Add a job
+  void add(const J &job)
+  {
+    Entry entry;
+    entry.job = job;
+    entry.seq = next_seq_++;
+    pending_.push_back(entry);
+    std::push_heap(pending_.begin(), pending_.end(), LaterStart());
+  }
+
+  /// \brief Run the jobs due at now, call every step.
+  /// \param apply Called with each running job, returns false to drop it
+  template <class F>
+  void update(const ros::Time &now, F apply)
+  {
+    // start the jobs that are due, merged into the running ones by age
+    const size_t running = active_.size();
+    while (!pending_.empty() && pending_.front().job.start_time <= now)
+    {
+      std::pop_heap(pending_.begin(), pending_.end(), LaterStart());
+      active_.push_back(pending_.back());
+      pending_.pop_back();
+    }
+    if (active_.size() > running)
+    {
+      std::sort(active_.begin() + running, active_.end(), Older());
+      std::inplace_merge(active_.begin(), active_.begin() + running, active_.end(), Older());
+    }
+
+    size_t kept = 0;
+    for (size_t i = 0; i < active_.size(); ++i)
+    {
+      const J &job = active_[i].job;
+      const bool forever = job.duration.toSec() < 0.0;
+      if (!forever && now > job.start_time + job.duration)
+        continue;  // expired
+      if (!apply(job))
+        continue;
+      if (kept != i)
+        active_[kept] = active_[i];
+      ++kept;
+    }
+    active_.resize(kept);
+  }
+
+  /// \brief Drop all jobs for which pred is true
+  template <class P>
+  void remove(P pred)
+  {
+    typename Entries::iterator it = std::remove_if(pending_.begin(), pending_.end(), Matches<P>(pred));
+    if (it != pending_.end())
+    {
+      pending_.erase(it, pending_.end());
+      std::make_heap(pending_.begin(), pending_.end(), LaterStart());
+    }
+    active_.erase(std::remove_if(active_.begin(), active_.end(), Matches<P>(pred)), active_.end());
+  }
+
+  /// \brief Drop all jobs
+  void clear()
+  {
+    pending_.clear();
+    active_.clear();
+  }
+
+  /// \brief Number of jobs, started or not
+  size_t size() const { return pending_.size() + active_.size(); }
+
+private:
+  struct Entry
+  {
+    J job;
+    boost::uint64_t seq;
+  };
+  typedef std::vector<Entry> Entries;
+
+  /// \brief Heap order, the earliest start on top
+  struct LaterStart
+  {
+    bool operator()(const Entry &a, const Entry &b) const
+    {
+      if (a.job.start_time != b.job.start_time)
+        return a.job.start_time > b.job.start_time;
+      return a.seq > b.seq;
+    }
+  };
+
+  struct Older
+  {
+    bool operator()(const Entry &a, const Entry &b) const
+    {
+      return a.seq < b.seq;
+    }
+  };
+
+  template <class P>
+  struct Matches
+  {
+    explicit Matches(P &pred) : pred(pred) {}
+    bool operator()(const Entry &entry) const { return pred(entry.job); }
+    P &pred;
+  };
+
+  Entries pending_;
+  Entries active_;
+  boost::uint64_t next_seq_;
+};
+
+}
+#endif
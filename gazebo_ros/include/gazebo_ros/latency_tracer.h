@@ -0,0 +1,121 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef __GAZEBO_ROS_LATENCY_TRACER_HH__
+#define __GAZEBO_ROS_LATENCY_TRACER_HH__
+
+#include <stdint.h>
+
+#include <atomic>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <boost/scoped_array.hpp>
+#include <boost/thread/mutex.hpp>
+
+namespace gazebo
+{
+
+/// \brief Tracer of the way of sensor messages from the sensor callback to
+/// their publication, switched on and off at run time by
+/// gazebo_ros_api_plugin (~latency_tracing, ~set_latency_tracing).
+///
+/// Each trace point records the topic, the header stamp of the message, the
+/// sim time and a monotonic wall time into a fixed ring of events, the
+/// oldest being overwritten once it is full.  The stamp ties the points of
+/// one message together.  While disabled a trace point costs a relaxed
+/// atomic load, while enabled an atomic increment and no lock.
+///
+/// Stopping writes the events as CSV to the trace file if set,
+/// `rosrun gazebo_ros latency_report` summarizes them per topic.
+class LatencyTracer
+{
+public:
+  enum Point
+  {
+    /// \brief New sensor data reached the plugin
+    SENSOR_CALLBACK,
+    /// \brief The message is filled
+    CONVERTED,
+    /// \brief The message was handed to a publishing queue
+    ENQUEUED,
+    /// \brief publish() returned
+    PUBLISHED
+  };
+
+  static LatencyTracer &instance();
+
+  static bool enabled()
+  {
+    return enabled_.load(std::memory_order_relaxed);
+  }
+
+  /// \brief Start or stop tracing, stopping writes the trace file if set
+  void setEnabled(bool enabled);
+
+  /// \brief Write the events as CSV to path when stopping, empty for none
+  void setTraceFile(const std::string &path);
+
+  /// \brief Write the events recorded since the last write
+  /// \return false with error set if the file could not be written
+  bool writeTrace(std::string &error);
+
+  /// \brief Id of a topic for record(), look it up once when advertising
+  uint32_t topic(const std::string &name);
+
+  /// \brief Record a trace point of the message stamped stamp_nsec
+  void record(uint32_t topic, Point point, int64_t stamp_nsec, int64_t sim_nsec);
+
+private:
+  LatencyTracer();
+
+  struct Event
+  {
+    /// \brief Index of the event plus 1 once written, 0 before
+    std::atomic<uint64_t> seq;
+    int64_t stamp_nsec;
+    int64_t sim_nsec;
+    int64_t wall_nsec;
+    uint32_t topic;
+    uint32_t point;
+  };
+
+  static std::atomic<bool> enabled_;
+
+  /// \brief Allocated when first enabled, never freed
+  boost::scoped_array<Event> events_;
+  std::atomic<uint64_t> next_;
+
+  /// \brief Guards the members below
+  boost::mutex mutex_;
+  std::string trace_file_;
+  std::map<std::string, uint32_t> topic_ids_;
+  std::vector<std::string> topics_;
+  /// \brief Index of the first event not written yet
+  uint64_t written_;
+};
+
+}
+
+/// \brief Record a trace point of the message stamped stamp (a ros::Time) on
+/// the topic id, at the current ros::Time
+#define GAZEBO_ROS_LATENCY_TRACE(topic, point, stamp) \
+  do { if (gazebo::LatencyTracer::enabled()) gazebo::LatencyTracer::instance().record( \
+    topic, gazebo::LatencyTracer::point, (stamp).toNSec(), ros::Time::now().toNSec()); } while (0)
+
+#endif
@@ -0,0 +1,127 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef __GAZEBO_ROS_OCCUPANCY_RASTERIZER_HH__
+#define __GAZEBO_ROS_OCCUPANCY_RASTERIZER_HH__
+
+#include <stdint.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <boost/thread/mutex.hpp>
+#include <boost/weak_ptr.hpp>
+
+#include <ignition/math/Box.hh>
+#include <ignition/math/Pose3.hh>
+#include <ignition/math/Vector3.hh>
+
+#include <gazebo/physics/physics.hh>
+
+namespace gazebo
+{
+
+/// \brief Ground truth voxel grids of the collision geometry of models,
+/// for the get_occupancy_grid service of gazebo_ros_api_plugin.
+///
+/// A voxel is occupied if its center, grown by half a voxel, lies in a
+/// collision: boxes, spheres and cylinders are tested exactly, any other
+/// shape (meshes, heightmaps, polylines) by its axis aligned bounding box,
+/// and planes are left out.  The collision shapes are read from the world in
+/// the calling thread, then the voxels are tested in tiles of the x/y plane
+/// on a few threads.
+///
+/// The occupied voxels of each model are cached with the poses of its links,
+/// so a model is only rasterized again when it moved, was replaced or the
+/// grid changed; static models are rasterized once per grid.
+class OccupancyRasterizer
+{
+public:
+  /// \brief A voxel grid in the world frame
+  struct Grid
+  {
+    /// \brief Lower corner of voxel 0
+    ignition::math::Vector3d origin;
+    double resolution;
+    uint32_t size_x;
+    uint32_t size_y;
+    uint32_t size_z;
+
+    bool operator==(const Grid &other) const;
+  };
+
+  OccupancyRasterizer();
+
+  /// \brief Rasterize models into grid
+  /// \param[out] voxels size_x * size_y * size_z voxels, 1 if occupied,
+  /// index x + size_x * (y + size_y * z)
+  void rasterize(const std::vector<gazebo::physics::ModelPtr> &models,
+                 const Grid &grid, std::vector<uint8_t> &voxels);
+
+private:
+  enum ShapeType { BOX, SPHERE, CYLINDER, BOUNDS };
+
+  /// \brief A collision in the world frame
+  struct Primitive
+  {
+    ShapeType type;
+    ignition::math::Pose3d pose;
+    /// \brief Box size, or radius and length in x and z
+    ignition::math::Vector3d size;
+    ignition::math::Box bounds;
+  };
+
+  /// \brief Occupied voxels of a model
+  struct ModelVoxels
+  {
+    boost::weak_ptr<gazebo::physics::Model> model;
+    std::vector<ignition::math::Pose3d> link_poses;
+    Grid grid;
+    std::vector<uint32_t> voxels;
+  };
+
+  /// \brief Part of a model to rasterize: its primitives in a range of
+  /// x/y voxels
+  struct Tile
+  {
+    size_t model;
+    uint32_t x0, x1, y0, y1;
+    std::vector<uint32_t> voxels;
+  };
+
+  /// \brief Collisions of a model, and the world poses of its links
+  static void readModel(const gazebo::physics::ModelPtr &model,
+                        std::vector<Primitive> &primitives,
+                        std::vector<ignition::math::Pose3d> &link_poses);
+
+  /// \brief Occupied voxels of primitives in a tile
+  static void rasterizeTile(const std::vector<Primitive> &primitives,
+                            const Grid &grid, Tile &tile);
+
+  /// \brief Whether point, in the world frame, lies in primitive grown by pad
+  static bool contains(const Primitive &primitive,
+                       const ignition::math::Vector3d &point, double pad);
+
+  boost::mutex mutex_;
+
+  /// \brief Cache by scoped model name
+  std::map<std::string, ModelVoxels> cache_;
+};
+
+}
+#endif
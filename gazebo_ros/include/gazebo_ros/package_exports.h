@@ -0,0 +1,108 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef __GAZEBO_ROS_PACKAGE_EXPORTS_HH__
+#define __GAZEBO_ROS_PACKAGE_EXPORTS_HH__
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace gazebo
+{
+
+/// \brief Export attributes of the packages depending on a package, as
+/// `rospack plugins --attrib=<attribute> <package>` finds them, for several
+/// attributes from a single crawl of ROS_PACKAGE_PATH.
+///
+/// The result is cached in a file, keyed by ROS_PACKAGE_PATH and by the
+/// modification times of every directory crawled and every package.xml
+/// read. While none of them changed, loading only stats those paths
+/// instead of listing the directories and parsing the manifests again. A
+/// package added, removed, ignored or edited changes one of them.
+///
+/// Only catkin packages, with a package.xml, are found. A package found
+/// twice keeps its first location, following the ROS_PACKAGE_PATH order.
+class PackageExports
+{
+public:
+  /// \brief Constructor
+  /// \param package Package whose dependents export the attributes.
+  /// \param attributes Export attributes to collect.
+  PackageExports(const std::string &package, const std::vector<std::string> &attributes);
+
+  /// \brief Find the exports, from the cache file if it is still valid.
+  /// \param cache_file Cache file, empty to always crawl.
+  /// \return False if ROS_PACKAGE_PATH is not set or does not hold the
+  /// package; the caller then falls back to ros::package.
+  bool load(const std::string &cache_file);
+
+  /// \brief Values of an attribute, with ${prefix} replaced by the
+  /// directory of the exporting package.
+  const std::vector<std::string> &values(const std::string &attribute) const;
+
+  /// \brief Directory of the package itself.
+  const std::string &path() const;
+
+  /// \brief True if load() used the cache file.
+  bool fromCache() const;
+
+  /// \brief $GAZEBO_ROS_PATHS_CACHE if it is set, an empty value disabling
+  /// the cache, else gazebo_ros_paths_cache in $ROS_HOME or ~/.ros.
+  static std::string defaultCacheFile();
+
+private:
+  /// \brief Modification time of a crawled path.
+  struct Stamp
+  {
+    std::string path;
+    long long sec;
+    long nsec;
+  };
+
+  /// \brief Crawl ROS_PACKAGE_PATH.
+  bool crawl();
+
+  /// \brief Crawl a directory and its subdirectories.
+  void crawlDirectory(const std::string &dir, std::set<std::string> &names, int depth);
+
+  /// \brief Read the name, dependency and exports of a package.
+  void readManifest(const std::string &dir, const std::string &manifest,
+                    std::set<std::string> &names);
+
+  /// \brief Record the modification time of a path.
+  bool stamp(const std::string &path);
+
+  /// \brief Load the cache file if it matches the environment and all
+  /// modification times.
+  bool readCache(const std::string &file);
+
+  /// \brief Replace the cache file, atomically for concurrent servers.
+  void writeCache(const std::string &file) const;
+
+  std::string package_;
+  std::vector<std::string> attributes_;
+  std::string package_path_env_;
+  std::string path_;
+  std::map<std::string, std::vector<std::string> > values_;
+  std::vector<Stamp> stamps_;
+  bool from_cache_;
+};
+
+}
+#endif
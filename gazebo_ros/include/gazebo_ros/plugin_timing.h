@@ -0,0 +1,118 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+
+#ifndef __GAZEBO_ROS_PLUGIN_TIMING_HH__
+#define __GAZEBO_ROS_PLUGIN_TIMING_HH__
+
+#include <stdint.h>
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include <boost/thread/mutex.hpp>
+
+namespace gazebo
+{
+
+/// \brief Timing of one stage of one plugin, e.g. the update callback of a
+/// p3d.  Recording is lock free and can happen from any thread.
+class TimingStage
+{
+public:
+  /// \brief Histogram bucket i counts durations below 2^i us, the last
+  /// one all longer ones
+  static const unsigned int BUCKETS = 20;
+
+  TimingStage(const std::string &plugin, const std::string &stage);
+
+  /// \brief Record one run of the stage
+  void record(int64_t nsec);
+
+  const std::string plugin;
+  const std::string stage;
+
+  std::atomic<uint64_t> count;
+  std::atomic<uint64_t> total_nsec;
+  std::atomic<uint64_t> max_nsec;
+  std::atomic<uint64_t> histogram[BUCKETS];
+};
+
+/// \brief Counters of a TimingStage at one time
+struct TimingStats
+{
+  std::string plugin;
+  std::string stage;
+  uint64_t count;
+  uint64_t total_nsec;
+  uint64_t max_nsec;
+  std::vector<uint64_t> histogram;
+};
+
+/// \brief Process wide registry of the TimingStage of all plugins, shown
+/// by gazebo_ros_api_plugin on ~performance_metrics
+class TimingRegistry
+{
+public:
+  static TimingRegistry &instance();
+
+  /// \brief The stage of plugin, created on first use.  The pointer stays
+  /// valid for the lifetime of the process, look it up once at load.
+  TimingStage *stage(const std::string &plugin, const std::string &stage);
+
+  /// \brief Counters of all stages since they were created
+  void stats(std::vector<TimingStats> &stats);
+
+private:
+  TimingRegistry() {}
+
+  boost::mutex mutex_;
+  std::deque<TimingStage> stages_;
+};
+
+/// \brief Records the time from construction to destruction into a stage,
+/// nothing if it is null
+class ScopedTiming
+{
+public:
+  explicit ScopedTiming(TimingStage *stage) :
+    stage_(stage)
+  {
+    if (stage_)
+      start_ = std::chrono::steady_clock::now();
+  }
+
+  ~ScopedTiming()
+  {
+    if (stage_)
+      stage_->record(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start_).count());
+  }
+
+private:
+  ScopedTiming(const ScopedTiming &);
+  ScopedTiming &operator=(const ScopedTiming &);
+
+  TimingStage *stage_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+}
+#endif
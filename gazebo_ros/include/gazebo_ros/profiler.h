@@ -0,0 +1,125 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+
+#ifndef __GAZEBO_ROS_PROFILER_HH__
+#define __GAZEBO_ROS_PROFILER_HH__
+
+#include <stdint.h>
+
+#include <atomic>
+#include <string>
+
+namespace gazebo
+{
+
+/// \brief Profiler of the ROS plugins, switched on and off at run time by
+/// gazebo_ros_api_plugin (~profiling, ~set_profiling).
+///
+/// While disabled a sample costs a relaxed atomic load.  While enabled the
+/// samples go to the sink, e.g. the Ignition profiler gazebo_ros_utils
+/// installs when built with it, and, if a trace file is set, are collected
+/// per thread and written as a Chrome trace (chrome://tracing, Perfetto)
+/// when profiling is switched off.
+///
+/// Use the GAZEBO_ROS_PROFILE macros, sample names must be string literals.
+class Profiler
+{
+public:
+  typedef void (*BeginSink)(const char *name);
+  typedef void (*EndSink)();
+
+  static Profiler &instance();
+
+  static bool enabled()
+  {
+    return enabled_.load(std::memory_order_relaxed);
+  }
+
+  /// \brief Start or stop profiling, stopping writes the trace file if set
+  void setEnabled(bool enabled);
+
+  /// \brief Collect a Chrome trace written to path, empty for none
+  void setTraceFile(const std::string &path);
+
+  /// \brief Write the trace collected so far and clear it
+  /// \return false with error set if the file could not be written
+  bool writeTrace(std::string &error);
+
+  /// \brief Forward the samples to another profiler as well
+  void setSink(BeginSink begin, EndSink end);
+
+  /// \brief Open a sample on this thread
+  void begin(const char *name);
+
+  /// \brief Close the last sample this thread opened
+  void end();
+
+  /// \brief Samples this thread opened and did not close yet
+  static unsigned int openSamples()
+  {
+    return open_samples_;
+  }
+
+private:
+  Profiler();
+
+  static std::atomic<bool> enabled_;
+  static thread_local unsigned int open_samples_;
+};
+
+/// \brief Sample of the enclosing scope
+class ProfileScope
+{
+public:
+  explicit ProfileScope(const char *name) :
+    active_(Profiler::enabled())
+  {
+    if (active_)
+      Profiler::instance().begin(name);
+  }
+
+  ~ProfileScope()
+  {
+    if (active_)
+      Profiler::instance().end();
+  }
+
+private:
+  ProfileScope(const ProfileScope &);
+  ProfileScope &operator=(const ProfileScope &);
+
+  bool active_;
+};
+
+}
+
+#define GAZEBO_ROS_PROFILE_CONCAT_(a, b) a ## b
+#define GAZEBO_ROS_PROFILE_CONCAT(a, b) GAZEBO_ROS_PROFILE_CONCAT_(a, b)
+
+/// \brief Profile the rest of the enclosing scope
+#define GAZEBO_ROS_PROFILE(name) \
+  gazebo::ProfileScope GAZEBO_ROS_PROFILE_CONCAT(gazebo_ros_profile_, __LINE__)(name)
+
+/// \brief Profile up to the matching GAZEBO_ROS_PROFILE_END().  Switching
+/// profiling off in between still closes the sample.
+#define GAZEBO_ROS_PROFILE_BEGIN(name) \
+  do { if (gazebo::Profiler::enabled()) gazebo::Profiler::instance().begin(name); } while (0)
+#define GAZEBO_ROS_PROFILE_END() \
+  do { if (gazebo::Profiler::openSamples() > 0) gazebo::Profiler::instance().end(); } while (0)
+
+#endif
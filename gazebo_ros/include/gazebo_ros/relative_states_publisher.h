@@ -0,0 +1,152 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef __GAZEBO_ROS_RELATIVE_STATES_PUBLISHER_HH__
+#define __GAZEBO_ROS_RELATIVE_STATES_PUBLISHER_HH__
+
+#include <string>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/weak_ptr.hpp>
+#include <boost/thread.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <ignition/math/Pose3.hh>
+#include <ignition/math/Vector3.hh>
+
+#include <gazebo/physics/physics.hh>
+#include <gazebo/common/Time.hh>
+
+#include <ros/ros.h>
+#include "gazebo_msgs/RelativeStates.h"
+
+#include <gazebo_ros/plugin_timing.h>
+#include <gazebo_ros/profiler.h>
+
+namespace gazebo
+{
+
+/// \brief Publishes gazebo_msgs/RelativeStates, the poses and twists of
+/// registered entities relative to registered reference entities, at a
+/// given sim time rate.
+///
+/// The pairs are resolved once, when registered.  capture() runs in
+/// WorldUpdateBegin and only copies the world states of the distinct
+/// entities of all pairs, a reference frame shared by many pairs is read
+/// once.  A worker thread computes the relative states of all pairs and
+/// publishes them, replacing a snapshot it has not picked up yet by the
+/// newer one like EntityStatesPublisher.
+class RelativeStatesPublisher
+{
+public:
+  /// \brief An entity and the entity its state is relative to, null for
+  /// the world frame
+  struct Pair
+  {
+    gazebo::physics::EntityPtr entity;
+    gazebo::physics::EntityPtr frame;
+    std::string entity_name;
+    std::string reference_frame;
+  };
+
+  /// \brief Constructor, starts the worker
+  /// \param rate Sim time rate in Hz, 0 to publish every world update
+  RelativeStatesPublisher(gazebo::physics::WorldPtr world, double rate);
+
+  /// \brief Destructor, stops the worker
+  ~RelativeStatesPublisher();
+
+  /// \brief Set the publisher the states go out on
+  void setPublisher(const ros::Publisher &pub);
+
+  /// \brief Publish the states of pairs, after those registered before if
+  /// append.  The entities are held weakly.
+  void setPairs(const std::vector<Pair> &pairs, bool append);
+
+  /// \brief Number of pairs registered
+  size_t size();
+
+  /// \brief Take a snapshot if the period elapsed and pairs are
+  /// registered, call on WorldUpdateBegin
+  void capture();
+
+private:
+  /// \brief Registered pairs as indices into entities, -1 for the world
+  /// frame.  Replaced, never changed, once shared with a snapshot.
+  struct Layout
+  {
+    std::vector<boost::weak_ptr<gazebo::physics::Entity> > entities;
+    std::vector<int> entity;
+    std::vector<int> frame;
+    gazebo_msgs::RelativeStates names;
+  };
+  typedef boost::shared_ptr<const Layout> LayoutPtr;
+
+  /// \brief World states of the distinct entities of a layout at one time
+  struct Snapshot
+  {
+    gazebo::common::Time stamp;
+    LayoutPtr layout;
+    std::vector<char> valid;
+    std::vector<ignition::math::Pose3d> pose;
+    std::vector<ignition::math::Vector3d> linear_vel;
+    std::vector<ignition::math::Vector3d> angular_vel;
+  };
+
+  /// \brief Worker thread body
+  void workerThread();
+
+  /// \brief Fill msg_ with the relative states of snapshot
+  void fillMessage(const Snapshot &snapshot);
+
+  gazebo::physics::WorldPtr world_;
+  double period_;
+  gazebo::common::Time last_capture_time_;
+  bool captured_;
+
+  /// \brief back_ is filled by capture(), ready_ waits for the worker and
+  /// front_ is read by it, swapped under mutex_ as by EntityStatesPublisher
+  Snapshot buffers_[3];
+  Snapshot *back_;
+  Snapshot *ready_;
+  Snapshot *front_;
+  bool pending_;
+  bool stop_;
+  boost::mutex mutex_;
+  boost::condition_variable cond_;
+
+  /// \brief Current layout, guarded by mutex_
+  LayoutPtr layout_;
+
+  ros::Publisher pub_;
+
+  /// \brief Message reused by the worker, the names are only copied in
+  /// when the layout changes
+  gazebo_msgs::RelativeStates msg_;
+  LayoutPtr msg_layout_;
+
+  TimingStage *capture_timing_;
+  TimingStage *convert_timing_;
+  TimingStage *publish_timing_;
+
+  boost::thread worker_;
+};
+
+}
+#endif
@@ -0,0 +1,92 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef __GAZEBO_ROS_SENSOR_BUFFER_POOL_HH__
+#define __GAZEBO_ROS_SENSOR_BUFFER_POOL_HH__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <list>
+#include <vector>
+
+#include <boost/thread/mutex.hpp>
+
+namespace gazebo
+{
+
+/// \brief Process wide pool of the full frame buffers of the sensor plugins,
+/// e.g. the data of the image and point cloud messages a camera keeps.
+///
+/// A plugin grows its buffers with resize() and hands them back with
+/// release() once its last subscriber left, so an idle sensor holds no
+/// frame sized memory and the next sensor to start reuses it.  The pool
+/// keeps released buffers only while the buffers in use and in the pool fit
+/// the capacity; beyond it they are freed, oldest first.  Buffers in use
+/// are never taken back, usage() shows when they alone exceed the
+/// capacity.
+///
+/// gazebo_ros_api_plugin sets the capacity from ~sensor_buffer_capacity_mb
+/// and shows usage() on ~performance_metrics.
+class SensorBufferPool
+{
+public:
+  struct Usage
+  {
+    /// \brief Bytes of the buffers grown with resize() and not released
+    size_t used_bytes;
+    /// \brief Bytes of the released buffers kept for reuse
+    size_t pooled_bytes;
+    size_t pooled_buffers;
+    size_t capacity_bytes;
+  };
+
+  static SensorBufferPool &instance();
+
+  /// \brief Bytes of the buffers in use and in the pool above which
+  /// released buffers are freed
+  void setCapacity(size_t bytes);
+
+  /// \brief Resize buffer to size bytes.  If it has to grow its storage,
+  /// it takes the smallest pooled buffer large enough instead.  The
+  /// content of buffer is not kept when a pooled buffer replaces it.
+  void resize(std::vector<uint8_t> &buffer, size_t size);
+
+  /// \brief Give the storage of buffer to the pool, buffer is left empty
+  /// and without capacity
+  void release(std::vector<uint8_t> &buffer);
+
+  Usage usage() const;
+
+private:
+  SensorBufferPool();
+
+  /// \brief Free pooled buffers, oldest first, until the used and pooled
+  /// bytes fit the capacity.  Call with mutex_ held.
+  void trim();
+
+  mutable boost::mutex mutex_;
+
+  /// \brief Released buffers, oldest first
+  std::list<std::vector<uint8_t> > pooled_;
+  size_t pooled_bytes_;
+  size_t used_bytes_;
+  size_t capacity_;
+};
+
+}
+#endif
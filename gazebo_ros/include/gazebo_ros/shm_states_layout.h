@@ -0,0 +1,102 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef __GAZEBO_ROS_SHM_STATES_LAYOUT_HH__
+#define __GAZEBO_ROS_SHM_STATES_LAYOUT_HH__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+
+namespace gazebo
+{
+/// \brief Layout of the POSIX shared memory segments the states are
+/// exported to, shared by the writer in gazebo_ros_api_plugin and
+/// ShmStatesReader.
+///
+/// A segment is a ShmStatesHeader, then capacity names of
+/// SHM_STATES_NAME_SIZE characters, then capacity ShmState.  It is a
+/// seqlock: the writer makes seq odd, writes, and makes it even again, a
+/// reader retries until it read the same even seq before and after its
+/// copy.  The names only change, and names_version only goes up, when the
+/// set of entities does.
+///
+/// The sim time segment is a single Clock.
+namespace shm_states
+{
+
+const uint32_t MAGIC = 0x53534752;  // "GRSS"
+const uint32_t VERSION = 1;
+const size_t NAME_SIZE = 128;
+
+struct Header
+{
+  uint32_t magic;
+  uint32_t version;
+  /// \brief Entries the segment has room for, fixed at creation
+  uint32_t capacity;
+  /// \brief Entries of the current snapshot
+  uint32_t count;
+  std::atomic<uint64_t> seq;
+  uint64_t names_version;
+  /// \brief Sim time of the snapshot
+  int32_t stamp_sec;
+  int32_t stamp_nsec;
+};
+
+/// \brief Inertial pose and twist of one entity
+struct State
+{
+  /// \brief x y z, qx qy qz qw
+  double pose[7];
+  /// \brief linear x y z, angular x y z
+  double twist[6];
+};
+
+/// \brief Sim time segment, a seqlock as well
+const uint32_t CLOCK_MAGIC = 0x43534752;  // "GRSC"
+
+struct Clock
+{
+  uint32_t magic;
+  uint32_t version;
+  std::atomic<uint64_t> seq;
+  int32_t sec;
+  int32_t nsec;
+  /// \brief World iterations
+  uint64_t iterations;
+};
+
+inline size_t namesOffset()
+{
+  return (sizeof(Header) + 63) & ~static_cast<size_t>(63);
+}
+
+inline size_t statesOffset(uint32_t capacity)
+{
+  return (namesOffset() + capacity * NAME_SIZE + 63) & ~static_cast<size_t>(63);
+}
+
+inline size_t segmentSize(uint32_t capacity)
+{
+  return statesOffset(capacity) + capacity * sizeof(State);
+}
+
+}
+}
+#endif
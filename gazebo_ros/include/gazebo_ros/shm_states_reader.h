@@ -0,0 +1,102 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef __GAZEBO_ROS_SHM_STATES_READER_HH__
+#define __GAZEBO_ROS_SHM_STATES_READER_HH__
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include <boost/unordered_map.hpp>
+
+#include <gazebo_ros/shm_states_layout.h>
+
+namespace gazebo
+{
+
+/// \brief Reads the link or model states gazebo_ros_api_plugin exports to
+/// shared memory when ~shm_states is set, without ROS or Gazebo.
+///
+///   gazebo::ShmStatesReader reader;
+///   gazebo::ShmStatesReader::Snapshot snapshot;
+///   if (reader.open("/gazebo_link_states") && reader.read(snapshot))
+///     int i = snapshot.index("robot::base_link");
+///
+/// A snapshot is reused across reads, the names are only copied when the
+/// set of entities changed.
+class ShmStatesReader
+{
+public:
+  struct Snapshot
+  {
+    Snapshot() : stamp_sec(0), stamp_nsec(0), names_version(0) {}
+
+    /// \brief Index of name in names and states, -1 if it is not there
+    int index(const std::string &name) const;
+
+    /// \brief Sim time of the states
+    int32_t stamp_sec;
+    int32_t stamp_nsec;
+    std::vector<std::string> names;
+    std::vector<shm_states::State> states;
+    uint64_t names_version;
+    boost::unordered_map<std::string, int> indices;
+  };
+
+  ShmStatesReader();
+  ~ShmStatesReader();
+
+  /// \brief Map a segment, false if it does not exist or has another layout
+  bool open(const std::string &name);
+  void close();
+  bool isOpen() const;
+
+  /// \brief Copy the latest states into snapshot
+  /// \return false if not open, or if the writer kept changing the
+  /// segment for too long
+  bool read(Snapshot &snapshot) const;
+
+private:
+  void *segment_;
+  size_t size_;
+  const shm_states::Header *header_;
+};
+
+/// \brief Reads the sim time gazebo_ros_api_plugin exports to shared
+/// memory when ~clock_shm is set, e.g. /gazebo_clock
+class ShmClockReader
+{
+public:
+  ShmClockReader();
+  ~ShmClockReader();
+
+  bool open(const std::string &name);
+  void close();
+  bool isOpen() const;
+
+  /// \brief Latest sim time and world iterations
+  /// \return false if not open or the writer kept changing it
+  bool read(int32_t &sec, int32_t &nsec, uint64_t &iterations) const;
+
+private:
+  const shm_states::Clock *clock_;
+};
+
+}
+#endif
@@ -0,0 +1,90 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef __GAZEBO_ROS_SHM_STATES_WRITER_HH__
+#define __GAZEBO_ROS_SHM_STATES_WRITER_HH__
+
+#include <string>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include <ignition/math/Pose3.hh>
+#include <ignition/math/Vector3.hh>
+
+#include <gazebo/common/Time.hh>
+
+#include <gazebo_ros/shm_states_layout.h>
+
+namespace gazebo
+{
+
+/// \brief Writes entity states to a named POSIX shared memory segment,
+/// see shm_states_layout.h.  The segment is created, or replaced, on
+/// construction and unlinked on destruction.
+class ShmStatesWriter
+{
+public:
+  /// \brief Constructor, check isOpen()
+  /// \param name Segment name, e.g. /gazebo_link_states
+  /// \param capacity Entities the segment has room for
+  ShmStatesWriter(const std::string &name, unsigned int capacity);
+
+  /// \brief Destructor, unlinks the segment
+  ~ShmStatesWriter();
+
+  bool isOpen() const;
+
+  /// \brief Write a snapshot, the names are only copied when the pointer
+  /// differs from the previous write.  Entities beyond capacity are left out.
+  void write(const gazebo::common::Time &stamp,
+             const boost::shared_ptr<const std::vector<std::string> > &names,
+             const std::vector<ignition::math::Pose3d> &pose,
+             const std::vector<ignition::math::Vector3d> &linear_vel,
+             const std::vector<ignition::math::Vector3d> &angular_vel);
+
+private:
+  std::string name_;
+  unsigned int capacity_;
+  size_t size_;
+  void *segment_;
+  shm_states::Header *header_;
+  char *names_;
+  shm_states::State *states_;
+  boost::shared_ptr<const std::vector<std::string> > written_names_;
+  bool warned_;
+};
+
+/// \brief Writes the sim time to a named POSIX shared memory segment, see
+/// shm_states_layout.h
+class ShmClockWriter
+{
+public:
+  explicit ShmClockWriter(const std::string &name);
+  ~ShmClockWriter();
+
+  bool isOpen() const;
+
+  void write(const gazebo::common::Time &time, uint64_t iterations);
+
+private:
+  std::string name_;
+  shm_states::Clock *clock_;
+};
+
+}
+#endif
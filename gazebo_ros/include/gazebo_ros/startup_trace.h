@@ -0,0 +1,118 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+
+#ifndef __GAZEBO_ROS_STARTUP_TRACE_HH__
+#define __GAZEBO_ROS_STARTUP_TRACE_HH__
+
+#include <stdint.h>
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <boost/thread/mutex.hpp>
+
+namespace gazebo
+{
+
+/// \brief Wall clock trace of the load of the ROS plugins.
+///
+/// Plugins record the phases of their load with ScopedStartupPhase, from
+/// any thread.  Deferred loads are counted as pending from the time they
+/// are queued, so the load of a world is over once the world runs, nothing
+/// is pending and no phase was recorded for a moment.  gazebo_ros_api_plugin
+/// then logs the report of the phases and, if ~startup_trace_file is set,
+/// writes them as a Chrome trace (chrome://tracing, Perfetto).  Models
+/// spawned later are reported the same way, each batch on its own.
+class StartupTrace
+{
+public:
+  /// \brief One phase of the load of one plugin
+  struct Phase
+  {
+    std::string plugin;
+    std::string phase;
+    unsigned int tid;
+    int64_t start_usec;
+    int64_t duration_usec;
+  };
+
+  static StartupTrace &instance();
+
+  /// \brief Record a phase that ran from start to end on this thread
+  void record(const std::string &plugin, const std::string &phase,
+              std::chrono::steady_clock::time_point start,
+              std::chrono::steady_clock::time_point end);
+
+  /// \brief A deferred load was queued, respectively finished or dropped
+  void addPending();
+  void removePending();
+
+  /// \brief The phases recorded since the last report, if the load they
+  /// belong to is over
+  /// \param quiet Time without a new phase after which the load is over
+  /// \return false if there is nothing to report yet
+  bool takeReport(std::vector<Phase> &phases, std::chrono::steady_clock::duration quiet);
+
+  /// \brief Report of the phases, one line per plugin, slowest first
+  /// \param max_plugins Plugins listed at most
+  static std::string report(const std::vector<Phase> &phases, size_t max_plugins);
+
+  /// \brief Write all phases recorded so far as a Chrome trace
+  /// \return false with error set if the file could not be written
+  bool writeTrace(const std::string &path, std::string &error);
+
+private:
+  StartupTrace();
+
+  boost::mutex mutex_;
+  std::vector<Phase> phases_;
+  size_t reported_;
+  std::atomic<int> pending_;
+  std::chrono::steady_clock::time_point last_record_;
+};
+
+/// \brief Records the time from construction to destruction as a phase of
+/// a plugin
+class ScopedStartupPhase
+{
+public:
+  ScopedStartupPhase(const std::string &plugin, const char *phase) :
+    plugin_(plugin),
+    phase_(phase),
+    start_(std::chrono::steady_clock::now())
+  {
+  }
+
+  ~ScopedStartupPhase()
+  {
+    StartupTrace::instance().record(plugin_, phase_, start_, std::chrono::steady_clock::now());
+  }
+
+private:
+  ScopedStartupPhase(const ScopedStartupPhase &);
+  ScopedStartupPhase &operator=(const ScopedStartupPhase &);
+
+  const std::string plugin_;
+  const char *phase_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+}
+#endif
@@ -0,0 +1,120 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef __GAZEBO_ROS_SUBSCRIPTION_HINTS_HH__
+#define __GAZEBO_ROS_SUBSCRIPTION_HINTS_HH__
+
+#include <string>
+
+#include <ros/console.h>
+#include <ros/node_handle.h>
+#include <ros/subscribe_options.h>
+#include <ros/transport_hints.h>
+#include <XmlRpcValue.h>
+
+namespace gazebo
+{
+
+/// \brief Transport of the topics gazebo_ros_api_plugin and the plugins
+/// subscribe to, e.g. cmd_vel or set_model_state.
+///
+/// Read from the parameter transport_hints in the namespace of the node
+/// handle subscribing, /gazebo/transport_hints for gazebo_ros_api_plugin
+/// and <robotNamespace>/transport_hints for the plugins, which may
+/// override it with a <transportHints> element of the same fields:
+///
+///   transport_hints:
+///     tcp_no_delay: true       # disable Nagle, the default
+///     udp: false               # prefer UDPROS, TCPROS as fallback
+///     max_datagram_size: 0     # of UDPROS, 0 for the default
+///     queue_size: 0            # of every subscription, 0 to keep its own
+///
+/// ROS services have no transport hints, their connections are set up by
+/// the caller.
+struct SubscriptionHints
+{
+  SubscriptionHints() :
+    tcp_no_delay(true),
+    udp(false),
+    max_datagram_size(0),
+    queue_size(0)
+  {
+  }
+
+  bool tcp_no_delay;
+  bool udp;
+  int max_datagram_size;
+  int queue_size;
+
+  /// \brief Override the fields set in the parameter param of nh
+  /// \return false if the parameter is not set
+  bool readParam(const ros::NodeHandle &nh, const std::string &param = "transport_hints");
+
+  ros::TransportHints transportHints() const;
+
+  /// \brief Set the transport hints of so, and its queue size if
+  /// queue_size is set
+  void apply(ros::SubscribeOptions &so) const;
+};
+
+inline bool SubscriptionHints::readParam(const ros::NodeHandle &nh, const std::string &param)
+{
+  XmlRpc::XmlRpcValue value;
+  if (!nh.getParam(param, value))
+    return false;
+  if (value.getType() != XmlRpc::XmlRpcValue::TypeStruct)
+  {
+    ROS_WARN_NAMED("transport_hints", "%s is not a dictionary, ignored", nh.resolveName(param).c_str());
+    return false;
+  }
+
+  if (value.hasMember("tcp_no_delay") && value["tcp_no_delay"].getType() == XmlRpc::XmlRpcValue::TypeBoolean)
+    tcp_no_delay = static_cast<bool>(value["tcp_no_delay"]);
+  if (value.hasMember("udp") && value["udp"].getType() == XmlRpc::XmlRpcValue::TypeBoolean)
+    udp = static_cast<bool>(value["udp"]);
+  if (value.hasMember("max_datagram_size") && value["max_datagram_size"].getType() == XmlRpc::XmlRpcValue::TypeInt)
+    max_datagram_size = static_cast<int>(value["max_datagram_size"]);
+  if (value.hasMember("queue_size") && value["queue_size"].getType() == XmlRpc::XmlRpcValue::TypeInt)
+    queue_size = static_cast<int>(value["queue_size"]);
+  return true;
+}
+
+inline ros::TransportHints SubscriptionHints::transportHints() const
+{
+  ros::TransportHints hints;
+  if (udp)
+  {
+    hints.udp();
+    if (max_datagram_size > 0)
+      hints.maxDatagramSize(max_datagram_size);
+  }
+  // listed after UDPROS, TCPROS is the fallback of publishers without it
+  hints.tcp();
+  if (tcp_no_delay)
+    hints.tcpNoDelay();
+  return hints;
+}
+
+inline void SubscriptionHints::apply(ros::SubscribeOptions &so) const
+{
+  so.transport_hints = transportHints();
+  if (queue_size > 0)
+    so.queue_size = queue_size;
+}
+
+}
+#endif
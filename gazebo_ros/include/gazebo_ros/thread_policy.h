@@ -0,0 +1,175 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef __GAZEBO_ROS_THREAD_POLICY_HH__
+#define __GAZEBO_ROS_THREAD_POLICY_HH__
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <boost/thread/mutex.hpp>
+
+#include <ros/console.h>
+#include <ros/param.h>
+#include <XmlRpcValue.h>
+
+namespace gazebo
+{
+
+/// \brief CPU affinity, real time priority and name of the threads of the
+/// ROS plugins, by thread class.
+///
+/// Every thread the plugins and gazebo_ros_api_plugin create calls apply()
+/// with its class when it starts:
+///  - physics: the gazebo world update thread, on its first update
+///  - render: the gazebo thread rendering cameras, on its first frame
+///  - control: controller update threads of gazebo_ros_control
+///  - services: the queue threads of the gazebo_ros_api_plugin services
+///  - callbacks: SharedCallbackExecutor workers and plugin queue threads
+///  - publishing: publisher queues, PubServicePool and state serialization
+///  - compute: worker pools of image kernels and rasterization
+///  - io: recording and deferred loading
+///
+/// The classes are configured from the ROS parameter gazebo/thread_policy
+/// in the namespace of the process, /gazebo/thread_policy by default,
+/// read once by gazebo_ros_api_plugin or by the first plugin using the
+/// shared callback executor, e.g.
+///
+///   thread_policy:
+///     physics: {cpus: "2-3", priority: 80}
+///     control: {cpus: "2-3", priority: 70, name: "ctrl"}
+///     publishing: {cpus: "8-15"}
+///
+/// Threads of an unconfigured class, and threads that started before the
+/// configuration, keep the affinity and priority they inherited.  A
+/// priority above 0 selects SCHED_FIFO, which needs CAP_SYS_NICE or an
+/// rtprio limit; failures are reported once per class on stderr.
+class ThreadPolicy
+{
+public:
+  struct Settings
+  {
+    Settings() : priority(0) {}
+
+    /// \brief CPUs the threads may run on, all if empty
+    std::vector<int> cpus;
+    /// \brief SCHED_FIFO priority, 0 to leave the scheduler alone
+    int priority;
+    /// \brief Thread name, at most 15 characters are kept
+    std::string name;
+  };
+
+  static ThreadPolicy &instance();
+
+  /// \brief Set the settings of a thread class
+  void set(const std::string &thread_class, const Settings &settings);
+
+  /// \brief Whether configure() ran, or set() was called
+  bool configured() const;
+
+  /// \brief Apply the settings of thread_class to the calling thread.
+  /// Cheap after the first call of a thread with the same class.
+  /// \param default_name Name of the thread unless the class sets one,
+  /// empty to keep the name, e.g. of threads gazebo created
+  void apply(const std::string &thread_class, const std::string &default_name);
+
+  /// \brief Parse a CPU list like "0-3,8"
+  /// \return false if spec is malformed
+  static bool parseCpus(const std::string &spec, std::vector<int> &cpus);
+
+  /// \brief Read the thread classes from a parameter, once per process
+  void configure(const std::string &param);
+
+private:
+  ThreadPolicy();
+
+  mutable boost::mutex mutex_;
+  bool configured_;
+  std::map<std::string, Settings> classes_;
+
+  /// \brief Classes whose settings failed, reported once
+  std::set<std::string> failed_;
+};
+
+inline void ThreadPolicy::configure(const std::string &param)
+{
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    if (configured_)
+      return;
+    configured_ = true;
+  }
+
+  XmlRpc::XmlRpcValue classes;
+  if (!ros::param::get(param, classes))
+    return;
+  if (classes.getType() != XmlRpc::XmlRpcValue::TypeStruct)
+  {
+    ROS_WARN_NAMED("thread_policy", "%s is not a dictionary of thread classes, ignored", param.c_str());
+    return;
+  }
+
+  for (XmlRpc::XmlRpcValue::iterator it = classes.begin(); it != classes.end(); ++it)
+  {
+    XmlRpc::XmlRpcValue &value = it->second;
+    if (value.getType() != XmlRpc::XmlRpcValue::TypeStruct)
+    {
+      ROS_WARN_NAMED("thread_policy", "%s/%s is not a dictionary, ignored", param.c_str(), it->first.c_str());
+      continue;
+    }
+
+    Settings settings;
+    if (value.hasMember("cpus"))
+    {
+      XmlRpc::XmlRpcValue &cpus = value["cpus"];
+      bool valid = true;
+      if (cpus.getType() == XmlRpc::XmlRpcValue::TypeString)
+        valid = parseCpus(static_cast<std::string>(cpus), settings.cpus);
+      else if (cpus.getType() == XmlRpc::XmlRpcValue::TypeInt)
+        settings.cpus.push_back(static_cast<int>(cpus));
+      else if (cpus.getType() == XmlRpc::XmlRpcValue::TypeArray)
+      {
+        for (int i = 0; i < cpus.size() && valid; ++i)
+        {
+          valid = cpus[i].getType() == XmlRpc::XmlRpcValue::TypeInt;
+          if (valid)
+            settings.cpus.push_back(static_cast<int>(cpus[i]));
+        }
+      }
+      else
+        valid = false;
+      if (!valid)
+      {
+        ROS_WARN_NAMED("thread_policy", "%s/%s/cpus is malformed, ignored", param.c_str(), it->first.c_str());
+        settings.cpus.clear();
+      }
+    }
+    if (value.hasMember("priority") && value["priority"].getType() == XmlRpc::XmlRpcValue::TypeInt)
+      settings.priority = static_cast<int>(value["priority"]);
+    if (value.hasMember("name") && value["name"].getType() == XmlRpc::XmlRpcValue::TypeString)
+      settings.name = static_cast<std::string>(value["name"]);
+
+    set(it->first, settings);
+    ROS_INFO_NAMED("thread_policy", "Thread class %s: %lu cpus, priority %d",
+      it->first.c_str(), static_cast<unsigned long>(settings.cpus.size()), settings.priority);
+  }
+}
+
+}
+#endif
@@ -0,0 +1,62 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gazebo_ros/backlog_registry.h>
+
+namespace gazebo
+{
+
+BacklogRegistry &BacklogRegistry::instance()
+{
+  static BacklogRegistry registry;
+  return registry;
+}
+
+int BacklogRegistry::add(const std::string &name, const DepthFunction &depth)
+{
+  boost::mutex::scoped_lock lock(mutex_);
+  int id = next_id_++;
+  Queue &queue = queues_[id];
+  queue.name = name;
+  queue.depth = depth;
+  return id;
+}
+
+void BacklogRegistry::remove(int id)
+{
+  boost::mutex::scoped_lock lock(mutex_);
+  queues_.erase(id);
+}
+
+size_t BacklogRegistry::maxDepth(std::string *name)
+{
+  boost::mutex::scoped_lock lock(mutex_);
+  size_t max = 0;
+  for (std::map<int, Queue>::iterator it = queues_.begin(); it != queues_.end(); ++it)
+  {
+    const size_t depth = it->second.depth();
+    if (depth > max)
+    {
+      max = depth;
+      if (name)
+        *name = it->second.name;
+    }
+  }
+  return max;
+}
+
+}
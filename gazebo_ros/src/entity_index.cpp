@@ -0,0 +1,165 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gazebo/gazebo_config.h>
+#include <gazebo_ros/entity_index.h>
+
+namespace gazebo
+{
+
+EntityIndex::EntityIndex(gazebo::physics::WorldPtr world) :
+  world_(world),
+  dirty_(true)
+{
+  add_entity_event_ = gazebo::event::Events::ConnectAddEntity(
+    boost::bind(&EntityIndex::onEntityChange, this, _1));
+  delete_entity_event_ = gazebo::event::Events::ConnectDeleteEntity(
+    boost::bind(&EntityIndex::onEntityChange, this, _1));
+}
+
+void EntityIndex::onEntityChange(const std::string &/*name*/)
+{
+  invalidate();
+}
+
+void EntityIndex::invalidate()
+{
+  boost::mutex::scoped_lock lock(mutex_);
+  dirty_ = true;
+}
+
+void EntityIndex::addEntity(const gazebo::physics::BasePtr &base)
+{
+  gazebo::physics::EntityPtr entity = boost::dynamic_pointer_cast<gazebo::physics::Entity>(base);
+  if (entity)
+  {
+    // emplace keeps the first entity of a name, as the world lookup does
+    entities_.emplace(entity->GetScopedName(), entity);
+    entities_.emplace(entity->GetName(), entity);
+  }
+
+  for (unsigned int i = 0; i < base->GetChildCount(); ++i)
+    addEntity(base->GetChild(i));
+}
+
+void EntityIndex::addJoints(const gazebo::physics::ModelPtr &model)
+{
+  const gazebo::physics::Joint_V &joints = model->GetJoints();
+  for (unsigned int i = 0; i < joints.size(); ++i)
+  {
+    joints_.emplace(joints[i]->GetScopedName(), joints[i]);
+    joints_.emplace(joints[i]->GetName(), joints[i]);
+  }
+}
+
+void EntityIndex::update()
+{
+  if (!dirty_)
+    return;
+  dirty_ = false;
+
+  entities_.clear();
+  joints_.clear();
+#if GAZEBO_MAJOR_VERSION >= 8
+  const unsigned int model_count = world_->ModelCount();
+#else
+  const unsigned int model_count = world_->GetModelCount();
+#endif
+  for (unsigned int i = 0; i < model_count; ++i)
+  {
+#if GAZEBO_MAJOR_VERSION >= 8
+    gazebo::physics::ModelPtr model = world_->ModelByIndex(i);
+#else
+    gazebo::physics::ModelPtr model = world_->GetModel(i);
+#endif
+    addEntity(model);
+    addJoints(model);
+  }
+}
+
+gazebo::physics::EntityPtr EntityIndex::entity(const std::string &name)
+{
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    update();
+    EntityMap::iterator it = entities_.find(name);
+    if (it != entities_.end())
+    {
+      gazebo::physics::EntityPtr entity = it->second.lock();
+      if (entity)
+        return entity;
+      entities_.erase(it);
+    }
+  }
+
+  // unknown name, the world has the final say
+#if GAZEBO_MAJOR_VERSION >= 8
+  gazebo::physics::EntityPtr entity = world_->EntityByName(name);
+#else
+  gazebo::physics::EntityPtr entity = world_->GetEntity(name);
+#endif
+  if (entity)
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    entities_[name] = entity;
+  }
+  return entity;
+}
+
+gazebo::physics::ModelPtr EntityIndex::model(const std::string &name)
+{
+  return boost::dynamic_pointer_cast<gazebo::physics::Model>(entity(name));
+}
+
+gazebo::physics::LinkPtr EntityIndex::link(const std::string &name)
+{
+  return boost::dynamic_pointer_cast<gazebo::physics::Link>(entity(name));
+}
+
+gazebo::physics::JointPtr EntityIndex::joint(const std::string &name)
+{
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    update();
+    JointMap::iterator it = joints_.find(name);
+    if (it != joints_.end())
+    {
+      gazebo::physics::JointPtr joint = it->second.lock();
+      if (joint)
+        return joint;
+      joints_.erase(it);
+    }
+  }
+
+  // unknown name, look in every model as the services used to
+  gazebo::physics::JointPtr joint;
+#if GAZEBO_MAJOR_VERSION >= 8
+  for (unsigned int i = 0; i < world_->ModelCount() && !joint; i ++)
+    joint = world_->ModelByIndex(i)->GetJoint(name);
+#else
+  for (unsigned int i = 0; i < world_->GetModelCount() && !joint; i ++)
+    joint = world_->GetModel(i)->GetJoint(name);
+#endif
+  if (joint)
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    joints_[name] = joint;
+  }
+  return joint;
+}
+
+}
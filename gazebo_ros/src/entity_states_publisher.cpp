@@ -0,0 +1,463 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <cmath>
+
+#include <gazebo/gazebo_config.h>
+#include <gazebo_ros/entity_states_publisher.h>
+#include <gazebo_ros/thread_policy.h>
+
+namespace gazebo
+{
+
+EntityStatesPublisher::EntityStatesPublisher(Kind kind, gazebo::physics::WorldPtr world,
+                                             double rate) :
+  kind_(kind),
+  world_(world),
+  period_(rate > 0 ? 1.0/rate : 0),
+  captured_(false),
+  filter_has_regex_(false),
+  back_(&buffers_[0]),
+  ready_(&buffers_[1]),
+  front_(&buffers_[2]),
+  pending_(false),
+  stop_(false),
+  keyframe_requested_(true)
+{
+  setTimingName(kind_ == MODELS ? "model_states" : "link_states");
+  worker_ = boost::thread(boost::bind(&EntityStatesPublisher::workerThread, this));
+}
+
+EntityStatesPublisher::~EntityStatesPublisher()
+{
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    stop_ = true;
+  }
+  cond_.notify_one();
+  worker_.join();
+}
+
+void EntityStatesPublisher::setPublisher(const ros::Publisher &pub)
+{
+  boost::mutex::scoped_lock lock(mutex_);
+  pub_ = pub;
+}
+
+void EntityStatesPublisher::setDeltaPublisher(const ros::Publisher &pub,
+                                              const DeltaOptions &options)
+{
+  boost::mutex::scoped_lock lock(mutex_);
+  delta_pub_ = pub;
+  delta_options_ = options;
+}
+
+void EntityStatesPublisher::setFilter(const std::string &prefix, const std::string &regex)
+{
+  filter_prefix_ = prefix;
+  filter_has_regex_ = !regex.empty();
+  if (filter_has_regex_)
+    filter_regex_.assign(regex, std::regex::ECMAScript | std::regex::optimize);
+  names_.reset();
+}
+
+bool EntityStatesPublisher::selected(const std::string &name) const
+{
+  if (name.compare(0, filter_prefix_.size(), filter_prefix_) != 0)
+    return false;
+  return !filter_has_regex_ || std::regex_match(name, filter_regex_);
+}
+
+void EntityStatesPublisher::setTimingName(const std::string &name)
+{
+  TimingRegistry &registry = TimingRegistry::instance();
+  capture_timing_ = registry.stage("gazebo_ros_api_plugin", name + " capture");
+  convert_timing_ = registry.stage("gazebo_ros_api_plugin", name + " convert");
+  publish_timing_ = registry.stage("gazebo_ros_api_plugin", name + " publish");
+  export_timing_ = registry.stage("gazebo_ros_api_plugin", name + " export");
+}
+
+void EntityStatesPublisher::setShmWriter(const boost::shared_ptr<ShmStatesWriter> &writer)
+{
+  boost::mutex::scoped_lock lock(mutex_);
+  shm_writer_ = writer;
+}
+
+void EntityStatesPublisher::setCompactPublishers(const ros::Publisher &names_pub,
+                                                 const ros::Publisher &pub)
+{
+  boost::mutex::scoped_lock lock(mutex_);
+  compact_names_pub_ = names_pub;
+  compact_pub_ = pub;
+}
+
+void EntityStatesPublisher::requestKeyframe()
+{
+  boost::mutex::scoped_lock lock(mutex_);
+  keyframe_requested_ = true;
+}
+
+void EntityStatesPublisher::refreshEntities()
+{
+#if GAZEBO_MAJOR_VERSION >= 8
+  const unsigned int model_count = world_->ModelCount();
+#else
+  const unsigned int model_count = world_->GetModelCount();
+#endif
+
+  // models are only compared by pointer, a changed set is rare.  Links are
+  // taken to only come and go with their models.
+  bool changed = !names_ || models_.size() != model_count;
+  for (unsigned int i = 0; !changed && i < model_count; ++i)
+  {
+#if GAZEBO_MAJOR_VERSION >= 8
+    changed = models_[i].lock() != world_->ModelByIndex(i);
+#else
+    changed = models_[i].lock() != world_->GetModel(i);
+#endif
+  }
+  if (!changed)
+    return;
+
+  boost::shared_ptr<std::vector<std::string> > names(new std::vector<std::string>());
+  models_.resize(model_count);
+  entities_.clear();
+  for (unsigned int i = 0; i < model_count; ++i)
+  {
+#if GAZEBO_MAJOR_VERSION >= 8
+    gazebo::physics::ModelPtr model = world_->ModelByIndex(i);
+#else
+    gazebo::physics::ModelPtr model = world_->GetModel(i);
+#endif
+    models_[i] = model;
+
+    if (kind_ == MODELS)
+    {
+      if (selected(model->GetName()))
+      {
+        entities_.push_back(model.get());
+        names->push_back(model->GetName());
+      }
+      continue;
+    }
+
+    for (unsigned int j = 0 ; j < model->GetChildCount(); j ++)
+    {
+      gazebo::physics::LinkPtr body = boost::dynamic_pointer_cast<gazebo::physics::Link>(model->GetChild(j));
+      if (body && selected(body->GetScopedName()))
+      {
+        entities_.push_back(body.get());
+        names->push_back(body->GetScopedName());
+      }
+    }
+  }
+  names_ = names;
+}
+
+void EntityStatesPublisher::capture()
+{
+#if GAZEBO_MAJOR_VERSION >= 8
+  gazebo::common::Time sim_time = world_->SimTime();
+#else
+  gazebo::common::Time sim_time = world_->GetSimTime();
+#endif
+  // a world reset takes sim time back
+  if (captured_ && sim_time < last_capture_time_)
+    last_capture_time_ = sim_time;
+  if (captured_ && period_ > 0 && (sim_time - last_capture_time_).Double() < period_)
+    return;
+  captured_ = true;
+  last_capture_time_ = sim_time;
+
+  GAZEBO_ROS_PROFILE("EntityStatesPublisher::capture");
+  ScopedTiming timing(capture_timing_);
+  refreshEntities();
+
+  const size_t n = entities_.size();
+  Snapshot &snapshot = *back_;
+  snapshot.stamp = sim_time;
+  snapshot.names = names_;
+  snapshot.pose.resize(n);
+  snapshot.linear_vel.resize(n);
+  snapshot.angular_vel.resize(n);
+  for (size_t i = 0; i < n; ++i)
+  {
+    const gazebo::physics::Entity *entity = entities_[i];
+#if GAZEBO_MAJOR_VERSION >= 8
+    snapshot.pose[i] = entity->WorldPose();
+    snapshot.linear_vel[i] = entity->WorldLinearVel();
+    snapshot.angular_vel[i] = entity->WorldAngularVel();
+#else
+    snapshot.pose[i] = entity->GetWorldPose().Ign();
+    snapshot.linear_vel[i] = entity->GetWorldLinearVel().Ign();
+    snapshot.angular_vel[i] = entity->GetWorldAngularVel().Ign();
+#endif
+  }
+
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    std::swap(back_, ready_);
+    pending_ = true;
+  }
+  cond_.notify_one();
+}
+
+namespace
+{
+void toPose(const ignition::math::Pose3d &in, geometry_msgs::Pose &pose)
+{
+  const ignition::math::Vector3d &pos = in.Pos();
+  const ignition::math::Quaterniond &rot = in.Rot();
+  pose.position.x = pos.X();
+  pose.position.y = pos.Y();
+  pose.position.z = pos.Z();
+  pose.orientation.w = rot.W();
+  pose.orientation.x = rot.X();
+  pose.orientation.y = rot.Y();
+  pose.orientation.z = rot.Z();
+}
+
+void toTwist(const ignition::math::Vector3d &linear_vel,
+             const ignition::math::Vector3d &angular_vel, geometry_msgs::Twist &twist)
+{
+  twist.linear.x = linear_vel.X();
+  twist.linear.y = linear_vel.Y();
+  twist.linear.z = linear_vel.Z();
+  twist.angular.x = angular_vel.X();
+  twist.angular.y = angular_vel.Y();
+  twist.angular.z = angular_vel.Z();
+}
+
+bool exceeds(const ignition::math::Vector3d &a, const ignition::math::Vector3d &b,
+             double threshold)
+{
+  return std::abs(a.X() - b.X()) > threshold ||
+         std::abs(a.Y() - b.Y()) > threshold ||
+         std::abs(a.Z() - b.Z()) > threshold;
+}
+}
+
+template <class M>
+void EntityStatesPublisher::fillMessage(const Snapshot &snapshot, M &msg)
+{
+  if (snapshot.names != msg_names_)
+  {
+    msg.name = *snapshot.names;
+    msg_names_ = snapshot.names;
+  }
+
+  const size_t n = snapshot.pose.size();
+  msg.pose.resize(n);
+  msg.twist.resize(n);
+  for (size_t i = 0; i < n; ++i)
+  {
+    toPose(snapshot.pose[i], msg.pose[i]);
+    toTwist(snapshot.linear_vel[i], snapshot.angular_vel[i], msg.twist[i]);
+  }
+}
+
+bool EntityStatesPublisher::changed(const Snapshot &snapshot, size_t i) const
+{
+  const DeltaOptions &options = delta_options_;
+  if (snapshot.pose[i].Pos().Distance(sent_pose_[i].Pos()) > options.position_threshold)
+    return true;
+
+  // angle of the rotation between the two orientations
+  double dot = std::abs(snapshot.pose[i].Rot().Dot(sent_pose_[i].Rot()));
+  if (2 * std::acos(std::min(dot, 1.0)) > options.orientation_threshold)
+    return true;
+
+  return exceeds(snapshot.linear_vel[i], sent_linear_vel_[i], options.velocity_threshold) ||
+         exceeds(snapshot.angular_vel[i], sent_angular_vel_[i], options.velocity_threshold);
+}
+
+void EntityStatesPublisher::publishDelta(const Snapshot &snapshot, const ros::Publisher &pub,
+                                         bool keyframe)
+{
+  const size_t n = snapshot.pose.size();
+
+  // new entities or a world reset need a keyframe too
+  keyframe = keyframe || snapshot.names != delta_names_ ||
+             snapshot.stamp < last_keyframe_time_ ||
+             (snapshot.stamp - last_keyframe_time_).Double() >= delta_options_.keyframe_interval;
+
+  delta_msg_.header.stamp.sec = snapshot.stamp.sec;
+  delta_msg_.header.stamp.nsec = snapshot.stamp.nsec;
+  delta_msg_.keyframe = keyframe;
+  delta_msg_.index.clear();
+  delta_msg_.pose.clear();
+  delta_msg_.twist.clear();
+
+  if (keyframe)
+  {
+    delta_names_ = snapshot.names;
+    last_keyframe_time_ = snapshot.stamp;
+    ++delta_msg_.keyframe_seq;
+    delta_msg_.name = *snapshot.names;
+    delta_msg_.pose.resize(n);
+    delta_msg_.twist.resize(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+      toPose(snapshot.pose[i], delta_msg_.pose[i]);
+      toTwist(snapshot.linear_vel[i], snapshot.angular_vel[i], delta_msg_.twist[i]);
+    }
+    sent_pose_ = snapshot.pose;
+    sent_linear_vel_ = snapshot.linear_vel;
+    sent_angular_vel_ = snapshot.angular_vel;
+    pub.publish(delta_msg_);
+    return;
+  }
+
+  delta_msg_.name.clear();
+  for (size_t i = 0; i < n; ++i)
+  {
+    if (!changed(snapshot, i))
+      continue;
+    delta_msg_.index.push_back(i);
+    delta_msg_.pose.push_back(geometry_msgs::Pose());
+    toPose(snapshot.pose[i], delta_msg_.pose.back());
+    delta_msg_.twist.push_back(geometry_msgs::Twist());
+    toTwist(snapshot.linear_vel[i], snapshot.angular_vel[i], delta_msg_.twist.back());
+    sent_pose_[i] = snapshot.pose[i];
+    sent_linear_vel_[i] = snapshot.linear_vel[i];
+    sent_angular_vel_[i] = snapshot.angular_vel[i];
+  }
+
+  // nothing moved, the next keyframe tells the stream is alive
+  if (!delta_msg_.index.empty())
+    pub.publish(delta_msg_);
+}
+
+void EntityStatesPublisher::publishCompact(const Snapshot &snapshot,
+                                           const ros::Publisher &names_pub,
+                                           const ros::Publisher &pub)
+{
+  if (snapshot.names != compact_names_)
+  {
+    gazebo_msgs::EntityStatesNames names;
+    names.header.stamp.sec = snapshot.stamp.sec;
+    names.header.stamp.nsec = snapshot.stamp.nsec;
+    names.names_seq = compact_msg_.names_seq + 1;
+    names.name = *snapshot.names;
+    names_pub.publish(names);
+    compact_msg_.names_seq = names.names_seq;
+    compact_names_ = snapshot.names;
+  }
+
+  if (!pub || pub.getNumSubscribers() == 0)
+    return;
+
+  const size_t n = snapshot.pose.size();
+  compact_msg_.header.stamp.sec = snapshot.stamp.sec;
+  compact_msg_.header.stamp.nsec = snapshot.stamp.nsec;
+  compact_msg_.position.resize(3 * n);
+  compact_msg_.orientation.resize(4 * n);
+  compact_msg_.linear_velocity.resize(3 * n);
+  compact_msg_.angular_velocity.resize(3 * n);
+  float *position = compact_msg_.position.data();
+  float *orientation = compact_msg_.orientation.data();
+  float *linear = compact_msg_.linear_velocity.data();
+  float *angular = compact_msg_.angular_velocity.data();
+  for (size_t i = 0; i < n; ++i)
+  {
+    const ignition::math::Pose3d &pose = snapshot.pose[i];
+    *position++ = pose.Pos().X();
+    *position++ = pose.Pos().Y();
+    *position++ = pose.Pos().Z();
+    *orientation++ = pose.Rot().X();
+    *orientation++ = pose.Rot().Y();
+    *orientation++ = pose.Rot().Z();
+    *orientation++ = pose.Rot().W();
+    *linear++ = snapshot.linear_vel[i].X();
+    *linear++ = snapshot.linear_vel[i].Y();
+    *linear++ = snapshot.linear_vel[i].Z();
+    *angular++ = snapshot.angular_vel[i].X();
+    *angular++ = snapshot.angular_vel[i].Y();
+    *angular++ = snapshot.angular_vel[i].Z();
+  }
+  pub.publish(compact_msg_);
+}
+
+void EntityStatesPublisher::workerThread()
+{
+  ThreadPolicy::instance().apply("publishing", "gzros_states");
+  for (;;)
+  {
+    ros::Publisher pub;
+    ros::Publisher delta_pub;
+    boost::shared_ptr<ShmStatesWriter> shm_writer;
+    ros::Publisher compact_names_pub;
+    ros::Publisher compact_pub;
+    bool keyframe;
+    {
+      boost::mutex::scoped_lock lock(mutex_);
+      while (!pending_ && !stop_)
+        cond_.wait(lock);
+      if (stop_)
+        return;
+      std::swap(ready_, front_);
+      pending_ = false;
+      pub = pub_;
+      delta_pub = delta_pub_;
+      shm_writer = shm_writer_;
+      compact_names_pub = compact_names_pub_;
+      compact_pub = compact_pub_;
+      keyframe = keyframe_requested_;
+      keyframe_requested_ = false;
+    }
+
+    GAZEBO_ROS_PROFILE("EntityStatesPublisher::publish");
+
+    // the snapshots are taken while either topic has subscribers
+    if (pub && pub.getNumSubscribers() > 0)
+    {
+      if (kind_ == MODELS)
+      {
+        {
+          ScopedTiming timing(convert_timing_);
+          fillMessage(*front_, model_states_);
+        }
+        ScopedTiming timing(publish_timing_);
+        pub.publish(model_states_);
+      }
+      else
+      {
+        {
+          ScopedTiming timing(convert_timing_);
+          fillMessage(*front_, link_states_);
+        }
+        ScopedTiming timing(publish_timing_);
+        pub.publish(link_states_);
+      }
+    }
+
+    ScopedTiming timing(export_timing_);
+    if (delta_pub && delta_pub.getNumSubscribers() > 0)
+      publishDelta(*front_, delta_pub, keyframe);
+
+    // the names are latched, they go out whether or not anyone listens
+    if (compact_names_pub)
+      publishCompact(*front_, compact_names_pub, compact_pub);
+
+    if (shm_writer)
+      shm_writer->write(front_->stamp, front_->names, front_->pose,
+                        front_->linear_vel, front_->angular_vel);
+  }
+}
+
+}
@@ -23,12 +23,31 @@
 #include <gazebo/common/Events.hh>
 #include <gazebo/gazebo_config.h>
 #include <gazebo_ros/gazebo_ros_api_plugin.h>
+#include <algorithm>
+#include <cmath>
 #include <chrono>
+#include <set>
 #include <thread>
 
 namespace gazebo
 {
 
+namespace
+{
+
+/// \brief Default name of a shared memory segment, prefixed with the
+/// namespace of the process, e.g. /sim3_gazebo_clock in /sim3, so that the
+/// gzservers of one host do not share it
+std::string defaultShmName(const std::string &base)
+{
+  std::string prefix = ros::this_node::getNamespace();
+  prefix.erase(0, prefix.find_first_not_of('/'));
+  std::replace(prefix.begin(), prefix.end(), '/', '_');
+  return "/" + (prefix.empty() ? base : prefix + "_" + base);
+}
+
+}
+
 GazeboRosApiPlugin::GazeboRosApiPlugin() :
   physics_reconfigure_initialized_(false),
   world_created_(false),
@@ -36,11 +55,29 @@ GazeboRosApiPlugin::GazeboRosApiPlugin() :
   plugin_loaded_(false),
   pub_link_states_connection_count_(0),
   pub_model_states_connection_count_(0),
+  pub_relative_states_connection_count_(0),
   pub_performance_metrics_connection_count_(0),
   pub_clock_frequency_(0),
-  enable_ros_network_(true)
+  pub_clock_aligned_(false),
+  shared_clock_(true),
+  backpressure_(false),
+  backpressure_max_queue_depth_(0),
+  backpressure_max_lag_(0.0),
+  backpressure_max_stall_(1.0),
+  backpressure_stalls_(0),
+  enable_ros_network_(true),
+  entity_event_count_(0),
+  next_deletion_ticket_(1),
+  spawn_timeout_(10.0),
+  model_cache_size_(16),
+  physics_properties_pending_(false),
+  model_state_batches_queued_(0),
+  model_state_batches_applied_(0),
+  properties_cache_generation_(0)
 {
   robot_namespace_.clear();
+  clock_timing_ = TimingRegistry::instance().stage("gazebo_ros_api_plugin", "clock publish");
+  backpressure_timing_ = TimingRegistry::instance().stage("gazebo_ros_api_plugin", "backpressure hold");
 }
 
 GazeboRosApiPlugin::~GazeboRosApiPlugin()
@@ -60,17 +97,31 @@ GazeboRosApiPlugin::~GazeboRosApiPlugin()
 
   // Disconnect slots
   load_gazebo_ros_api_plugin_event_.reset();
+  add_entity_event_.reset();
+  delete_entity_event_.reset();
   wrench_update_event_.reset();
   force_update_event_.reset();
   time_update_event_.reset();
+  model_state_update_event_.reset();
+  state_topic_update_event_.reset();
+  step_command_event_.reset();
+  backpressure_event_.reset();
   ROS_DEBUG_STREAM_NAMED("api_plugin","Slots disconnected");
 
   if (pub_link_states_connection_count_ > 0) // disconnect if there are subscribers on exit
     pub_link_states_event_.reset();
   if (pub_model_states_connection_count_ > 0) // disconnect if there are subscribers on exit
     pub_model_states_event_.reset();
+  pub_relative_states_event_.reset();
   ROS_DEBUG_STREAM_NAMED("api_plugin","Disconnected World Updates");
 
+  // Stop the model and link states workers
+  filtered_states_.clear();
+  link_states_publisher_.reset();
+  model_states_publisher_.reset();
+  relative_states_publisher_.reset();
+  ROS_DEBUG_STREAM_NAMED("api_plugin","States publishers stopped");
+
   // Stop the multi threaded ROS spinner
   async_ros_spin_->stop();
   ROS_DEBUG_STREAM_NAMED("api_plugin","Async ROS Spin Stopped");
@@ -79,7 +130,9 @@ GazeboRosApiPlugin::~GazeboRosApiPlugin()
   nh_->shutdown();
   ROS_DEBUG_STREAM_NAMED("api_plugin","Node Handle Shutdown");
 
-  // Shutdown ROS queue
+  // Shutdown ROS queues
+  if (read_queue_spinner_)
+    read_queue_spinner_->stop();
   gazebo_callback_queue_thread_->join();
   ROS_DEBUG_STREAM_NAMED("api_plugin","Callback Queue Joined");
 
@@ -89,22 +142,16 @@ GazeboRosApiPlugin::~GazeboRosApiPlugin()
 
   // Delete Force and Wrench Jobs
   lock_.lock();
-  for (std::vector<GazeboRosApiPlugin::ForceJointJob*>::iterator iter=force_joint_jobs_.begin();iter!=force_joint_jobs_.end();)
-  {
-    delete (*iter);
-    iter = force_joint_jobs_.erase(iter);
-  }
   force_joint_jobs_.clear();
   ROS_DEBUG_STREAM_NAMED("api_plugin","ForceJointJobs deleted");
-  for (std::vector<GazeboRosApiPlugin::WrenchBodyJob*>::iterator iter=wrench_body_jobs_.begin();iter!=wrench_body_jobs_.end();)
-  {
-    delete (*iter);
-    iter = wrench_body_jobs_.erase(iter);
-  }
   wrench_body_jobs_.clear();
+  model_jobs_.clear();
   lock_.unlock();
   ROS_DEBUG_STREAM_NAMED("api_plugin","WrenchBodyJobs deleted");
 
+  // a trace still running is written on exit
+  LatencyTracer::instance().setEnabled(false);
+
   ROS_DEBUG_STREAM_NAMED("api_plugin","Unloaded");
 }
 
@@ -112,6 +159,7 @@ void GazeboRosApiPlugin::shutdownSignal()
 {
   ROS_DEBUG_STREAM_NAMED("api_plugin","shutdownSignal() recieved");
   stop_ = true;
+  backpressure_cond_.notify_all();
 }
 
 void GazeboRosApiPlugin::Load(int argc, char** argv)
@@ -144,6 +192,12 @@ void GazeboRosApiPlugin::Load(int argc, char** argv)
 
   nh_.reset(new ros::NodeHandle("~")); // advertise topics and services in this node's namespace
 
+  // affinity and priority of the threads of all ROS plugins, before any starts
+  ThreadPolicy::instance().configure("gazebo/thread_policy");
+
+  // Nagle off for the command topics unless ~transport_hints says otherwise
+  subscription_hints_.readParam(*nh_);
+
   // Built-in multi-threaded ROS spinning
   async_ros_spin_.reset(new ros::AsyncSpinner(0)); // will use a thread for each CPU core
   async_ros_spin_->start();
@@ -186,6 +240,48 @@ void GazeboRosApiPlugin::loadGazeboRosApiPlugin(std::string world_name)
     return;
   }
 
+  // name lookups of all service handlers
+  entity_index_.reset(new EntityIndex(world_));
+
+  // spawn and delete services wait on these
+  add_entity_event_ = gazebo::event::Events::ConnectAddEntity(boost::bind(&GazeboRosApiPlugin::onEntityEvent,this,_1));
+  delete_entity_event_ = gazebo::event::Events::ConnectDeleteEntity(boost::bind(&GazeboRosApiPlugin::onEntityEvent,this,_1));
+  nh_->getParam("spawn_timeout", spawn_timeout_);
+  nh_->getParam("model_cache_size", model_cache_size_);
+
+  // profiling of the ROS plugins, also switched by ~set_profiling
+  bool profiling = false;
+  std::string profiling_trace_file;
+  nh_->getParam("profiling", profiling);
+  nh_->getParam("profiling_trace_file", profiling_trace_file);
+  Profiler::instance().setTraceFile(profiling_trace_file);
+  Profiler::instance().setEnabled(profiling);
+
+  // sensor callback to publish latencies, also switched by
+  // ~set_latency_tracing, see scripts/latency_report
+  bool latency_tracing = false;
+  std::string latency_trace_file;
+  nh_->getParam("latency_tracing", latency_tracing);
+  nh_->getParam("latency_trace_file", latency_trace_file);
+  LatencyTracer::instance().setTraceFile(latency_trace_file);
+  LatencyTracer::instance().setEnabled(latency_tracing);
+
+  // frame buffers the idle sensors keep for reuse, see SensorBufferPool
+  int sensor_buffer_capacity_mb = 512;
+  nh_->getParam("sensor_buffer_capacity_mb", sensor_buffer_capacity_mb);
+  SensorBufferPool::instance().setCapacity(
+    static_cast<size_t>(std::max(sensor_buffer_capacity_mb, 0)) << 20);
+
+  // report of the plugin loads, logged once no load happened for
+  // ~startup_report_quiet seconds, see StartupTrace
+  startup_report_quiet_ = 2.0;
+  nh_->getParam("startup_report_quiet", startup_report_quiet_);
+  nh_->getParam("startup_trace_file", startup_trace_file_);
+  startup_report_timer_ = nh_->createWallTimer(
+    ros::WallTimerOptions(ros::WallDuration(0.5),
+                          boost::bind(&GazeboRosApiPlugin::startupReportTimer, this, _1),
+                          &gazebo_queue_));
+
   gazebonode_ = gazebo::transport::NodePtr(new gazebo::transport::Node());
   gazebonode_->Init(world_name);
   factory_pub_ = gazebonode_->Advertise<gazebo::msgs::Factory>("~/factory");
@@ -196,10 +292,16 @@ void GazeboRosApiPlugin::loadGazeboRosApiPlugin(std::string world_name)
   // reset topic connection counts
   pub_link_states_connection_count_ = 0;
   pub_model_states_connection_count_ = 0;
+  pub_relative_states_connection_count_ = 0;
   pub_performance_metrics_connection_count_ = 0;
 
-  // Manage clock for simulated ros time
-  pub_clock_ = nh_->advertise<rosgraph_msgs::Clock>("/clock", 10);
+  // Manage clock for simulated ros time.  Without a shared clock it goes
+  // to clock in the namespace of the process, e.g. /sim3/clock, and the
+  // time of this process is set here instead of from /clock.
+  nh_->getParam("shared_clock", shared_clock_);
+  pub_clock_ = ros::NodeHandle().advertise<rosgraph_msgs::Clock>(shared_clock_ ? "/clock" : "clock", 10);
+  if (!shared_clock_)
+    ROS_INFO_NAMED("api_plugin", "Publishing sim time on %s", pub_clock_.getTopic().c_str());
 
   /// \brief advertise all services
   if (enable_ros_network_)
@@ -210,22 +312,94 @@ void GazeboRosApiPlugin::loadGazeboRosApiPlugin(std::string world_name)
     nh_->setParam("/use_sim_time", true);
 
   nh_->getParam("pub_clock_frequency", pub_clock_frequency_);
+  // pub_clock_aligned publishes at the first update at or past every
+  // multiple of 1/pub_clock_frequency of sim time, so clients running
+  // controllers at that period wake up once per period and not in between
+  nh_->getParam("pub_clock_aligned", pub_clock_aligned_);
 #if GAZEBO_MAJOR_VERSION >= 8
   last_pub_clock_time_ = world_->SimTime();
 #else
   last_pub_clock_time_ = world_->GetSimTime();
 #endif
+  last_pub_clock_period_ = -1;
+
+  // sim time in shared memory for clients on the same host, written every
+  // world update, see ShmClockReader
+  bool clock_shm = false;
+  std::string clock_shm_name = defaultShmName("gazebo_clock");
+  nh_->getParam("clock_shm", clock_shm);
+  nh_->getParam("clock_shm_name", clock_shm_name);
+  if (clock_shm)
+  {
+    clock_shm_writer_.reset(new ShmClockWriter(clock_shm_name));
+    if (!clock_shm_writer_->isOpen())
+      clock_shm_writer_.reset();
+  }
 
   // hooks for applying forces, publishing simtime on /clock
   wrench_update_event_ = gazebo::event::Events::ConnectWorldUpdateBegin(boost::bind(&GazeboRosApiPlugin::wrenchBodySchedulerSlot,this));
   force_update_event_  = gazebo::event::Events::ConnectWorldUpdateBegin(boost::bind(&GazeboRosApiPlugin::forceJointSchedulerSlot,this));
   time_update_event_   = gazebo::event::Events::ConnectWorldUpdateBegin(boost::bind(&GazeboRosApiPlugin::publishSimTime,this));
+  model_state_update_event_ = gazebo::event::Events::ConnectWorldUpdateBegin(boost::bind(&GazeboRosApiPlugin::applyQueuedModelStates,this));
+  state_topic_update_event_ = gazebo::event::Events::ConnectWorldUpdateBegin(boost::bind(&GazeboRosApiPlugin::applyStateTopics,this));
+  step_command_event_ = gazebo::event::Events::ConnectWorldUpdateBegin(boost::bind(&GazeboRosApiPlugin::stepCommandSlot,this));
+
+  // backpressure for faster than real time runs (real_time_update_rate 0):
+  // the world waits for the plugin publish queues to drain and for the
+  // critical consumers, which publish the sim time they have processed as a
+  // rosgraph_msgs/Clock on their ~backpressure_consumers topic
+  nh_->getParam("backpressure", backpressure_);
+  if (backpressure_)
+  {
+    nh_->getParam("backpressure_max_queue_depth", backpressure_max_queue_depth_);
+    nh_->getParam("backpressure_max_lag", backpressure_max_lag_);
+    nh_->getParam("backpressure_max_stall", backpressure_max_stall_);
+    nh_->getParam("backpressure_consumers", backpressure_consumers_);
+    backpressure_acks_.resize(backpressure_consumers_.size());
+    backpressure_acked_.resize(backpressure_consumers_.size(), false);
+    // acks arrive on the spinner threads, never behind the held world
+    for (size_t i = 0; i < backpressure_consumers_.size(); ++i)
+      backpressure_ack_subs_.push_back(nh_->subscribe<rosgraph_msgs::Clock>(
+        backpressure_consumers_[i], 10,
+        boost::bind(&GazeboRosApiPlugin::onConsumerAck, this, _1, i),
+        ros::VoidPtr(), subscription_hints_.transportHints()));
+    backpressure_event_ = gazebo::event::Events::ConnectWorldUpdateEnd(boost::bind(&GazeboRosApiPlugin::backpressureSlot,this));
+    ROS_INFO_NAMED("api_plugin", "Backpressure: steps wait for queues of at most %d messages and %lu critical consumers",
+                   backpressure_max_queue_depth_, static_cast<unsigned long>(backpressure_consumers_.size()));
+  }
 }
 
 void GazeboRosApiPlugin::onResponse(ConstResponsePtr &response)
 {
 
 }
+
+void GazeboRosApiPlugin::onEntityEvent(const std::string &name)
+{
+  {
+    // a new model may have the name of a deleted one
+    boost::mutex::scoped_lock lock(properties_cache_mutex_);
+    model_properties_cache_.clear();
+    properties_cache_generation_++;
+  }
+  boost::mutex::scoped_lock lock(entity_event_mutex_);
+  entity_event_count_++;
+  entity_event_cond_.notify_all();
+}
+
+unsigned int GazeboRosApiPlugin::entityEventCount()
+{
+  boost::mutex::scoped_lock lock(entity_event_mutex_);
+  return entity_event_count_;
+}
+
+void GazeboRosApiPlugin::waitForEntityEvent(unsigned int seen)
+{
+  // the world spawns lights without an event, the slice bounds their wait
+  boost::mutex::scoped_lock lock(entity_event_mutex_);
+  if (entity_event_count_ == seen)
+    entity_event_cond_.timed_wait(lock, boost::posix_time::milliseconds(100));
+}
 #ifdef GAZEBO_ROS_HAS_PERFORMANCE_METRICS
 void GazeboRosApiPlugin::onPerformanceMetrics(const boost::shared_ptr<gazebo::msgs::PerformanceMetrics const> &msg)
 {
@@ -250,12 +424,33 @@ void GazeboRosApiPlugin::onPerformanceMetrics(const boost::shared_ptr<gazebo::ms
     msg_ros.sensors.push_back(sensor_msgs);
   }
 
+  // timing of the ROS plugins, cumulative since each was loaded
+  std::vector<TimingStats> timing;
+  TimingRegistry::instance().stats(timing);
+  msg_ros.plugins.resize(timing.size());
+  for (size_t i = 0; i < timing.size(); ++i)
+  {
+    gazebo_msgs::PluginPerformanceMetric &plugin = msg_ros.plugins[i];
+    plugin.plugin = timing[i].plugin;
+    plugin.stage = timing[i].stage;
+    plugin.count = timing[i].count;
+    plugin.mean = timing[i].count > 0 ? 1e-9 * timing[i].total_nsec / timing[i].count : 0;
+    plugin.max = 1e-9 * timing[i].max_nsec;
+    plugin.histogram = timing[i].histogram;
+  }
+
+  SensorBufferPool::Usage buffers = SensorBufferPool::instance().usage();
+  msg_ros.sensor_buffer_used_bytes = buffers.used_bytes;
+  msg_ros.sensor_buffer_pooled_bytes = buffers.pooled_bytes;
+  msg_ros.sensor_buffer_capacity_bytes = buffers.capacity_bytes;
+
   pub_performance_metrics_.publish(msg_ros);
 }
 #endif
 
 void GazeboRosApiPlugin::gazeboQueueThread()
 {
+  ThreadPolicy::instance().apply("services", "gzros_services");
   static const double timeout = 0.001;
   while (nh_->ok())
   {
@@ -271,6 +466,19 @@ void GazeboRosApiPlugin::advertiseServices()
     return;
   }
 
+  // the getters only read the world and are served by read_service_threads
+  // threads off their own queue, so they are not stuck behind a spawn.
+  // 0 serves them with the mutating services on gazebo_queue_.
+  int read_service_threads = 4;
+  nh_->getParam("read_service_threads", read_service_threads);
+  ros::CallbackQueue *read_queue = &gazebo_queue_;
+  if (read_service_threads > 0)
+  {
+    read_queue = &gazebo_read_queue_;
+    read_queue_spinner_.reset(new ros::AsyncSpinner(read_service_threads, read_queue));
+    read_queue_spinner_->start();
+  }
+
   // Advertise spawn services on the custom queue
   std::string spawn_sdf_model_service_name("spawn_sdf_model");
   ros::AdvertiseServiceOptions spawn_sdf_model_aso =
@@ -298,6 +506,40 @@ void GazeboRosApiPlugin::advertiseServices()
                                                                    ros::VoidPtr(), &gazebo_queue_);
   delete_model_service_ = nh_->advertiseService(delete_aso);
 
+  // Advertise batch spawn and delete services on the custom queue
+  std::string spawn_models_service_name("spawn_models");
+  ros::AdvertiseServiceOptions spawn_models_aso =
+    ros::AdvertiseServiceOptions::create<gazebo_msgs::SpawnModels>(
+                                                                   spawn_models_service_name,
+                                                                   boost::bind(&GazeboRosApiPlugin::spawnModels,this,_1,_2),
+                                                                   ros::VoidPtr(), &gazebo_queue_);
+  spawn_models_service_ = nh_->advertiseService(spawn_models_aso);
+
+  std::string delete_models_service_name("delete_models");
+  ros::AdvertiseServiceOptions delete_models_aso =
+    ros::AdvertiseServiceOptions::create<gazebo_msgs::DeleteModels>(
+                                                                    delete_models_service_name,
+                                                                    boost::bind(&GazeboRosApiPlugin::deleteModels,this,_1,_2),
+                                                                    ros::VoidPtr(), &gazebo_queue_);
+  delete_models_service_ = nh_->advertiseService(delete_models_aso);
+
+  // Advertise model template services on the custom queue
+  std::string set_model_template_service_name("set_model_template");
+  ros::AdvertiseServiceOptions set_model_template_aso =
+    ros::AdvertiseServiceOptions::create<gazebo_msgs::SetModelTemplate>(
+                                                                        set_model_template_service_name,
+                                                                        boost::bind(&GazeboRosApiPlugin::setModelTemplate,this,_1,_2),
+                                                                        ros::VoidPtr(), &gazebo_queue_);
+  set_model_template_service_ = nh_->advertiseService(set_model_template_aso);
+
+  std::string spawn_model_template_service_name("spawn_model_template");
+  ros::AdvertiseServiceOptions spawn_model_template_aso =
+    ros::AdvertiseServiceOptions::create<gazebo_msgs::SpawnModelTemplate>(
+                                                                          spawn_model_template_service_name,
+                                                                          boost::bind(&GazeboRosApiPlugin::spawnModelTemplate,this,_1,_2),
+                                                                          ros::VoidPtr(), &gazebo_queue_);
+  spawn_model_template_service_ = nh_->advertiseService(spawn_model_template_aso);
+
   // Advertise delete service for lights on the custom queue
   std::string delete_light_service_name("delete_light");
   ros::AdvertiseServiceOptions delete_light_aso =
@@ -307,13 +549,30 @@ void GazeboRosApiPlugin::advertiseServices()
                                                                    ros::VoidPtr(), &gazebo_queue_);
   delete_light_service_ = nh_->advertiseService(delete_light_aso);
 
+  // Advertise the non-blocking delete service and its wait on the custom queue
+  std::string delete_entities_async_service_name("delete_entities_async");
+  ros::AdvertiseServiceOptions delete_entities_async_aso =
+    ros::AdvertiseServiceOptions::create<gazebo_msgs::DeleteEntitiesAsync>(
+                                                                           delete_entities_async_service_name,
+                                                                           boost::bind(&GazeboRosApiPlugin::deleteEntitiesAsync,this,_1,_2),
+                                                                           ros::VoidPtr(), &gazebo_queue_);
+  delete_entities_async_service_ = nh_->advertiseService(delete_entities_async_aso);
+
+  std::string await_deletion_service_name("await_deletion");
+  ros::AdvertiseServiceOptions await_deletion_aso =
+    ros::AdvertiseServiceOptions::create<gazebo_msgs::AwaitDeletion>(
+                                                                     await_deletion_service_name,
+                                                                     boost::bind(&GazeboRosApiPlugin::awaitDeletion,this,_1,_2),
+                                                                     ros::VoidPtr(), &gazebo_queue_);
+  await_deletion_service_ = nh_->advertiseService(await_deletion_aso);
+
   // Advertise more services on the custom queue
   std::string get_model_properties_service_name("get_model_properties");
   ros::AdvertiseServiceOptions get_model_properties_aso =
     ros::AdvertiseServiceOptions::create<gazebo_msgs::GetModelProperties>(
                                                                           get_model_properties_service_name,
                                                                           boost::bind(&GazeboRosApiPlugin::getModelProperties,this,_1,_2),
-                                                                          ros::VoidPtr(), &gazebo_queue_);
+                                                                          ros::VoidPtr(), read_queue);
   get_model_properties_service_ = nh_->advertiseService(get_model_properties_aso);
 
   // Advertise more services on the custom queue
@@ -322,7 +581,7 @@ void GazeboRosApiPlugin::advertiseServices()
     ros::AdvertiseServiceOptions::create<gazebo_msgs::GetModelState>(
                                                                      get_model_state_service_name,
                                                                      boost::bind(&GazeboRosApiPlugin::getModelState,this,_1,_2),
-                                                                     ros::VoidPtr(), &gazebo_queue_);
+                                                                     ros::VoidPtr(), read_queue);
   get_model_state_service_ = nh_->advertiseService(get_model_state_aso);
 
   // Advertise more services on the custom queue
@@ -331,16 +590,25 @@ void GazeboRosApiPlugin::advertiseServices()
     ros::AdvertiseServiceOptions::create<gazebo_msgs::GetWorldProperties>(
                                                                           get_world_properties_service_name,
                                                                           boost::bind(&GazeboRosApiPlugin::getWorldProperties,this,_1,_2),
-                                                                          ros::VoidPtr(), &gazebo_queue_);
+                                                                          ros::VoidPtr(), read_queue);
   get_world_properties_service_ = nh_->advertiseService(get_world_properties_aso);
 
+  // Advertise more services on the custom queue
+  std::string get_occupancy_grid_service_name("get_occupancy_grid");
+  ros::AdvertiseServiceOptions get_occupancy_grid_aso =
+    ros::AdvertiseServiceOptions::create<gazebo_msgs::GetOccupancyGrid>(
+                                                                        get_occupancy_grid_service_name,
+                                                                        boost::bind(&GazeboRosApiPlugin::getOccupancyGrid,this,_1,_2),
+                                                                        ros::VoidPtr(), read_queue);
+  get_occupancy_grid_service_ = nh_->advertiseService(get_occupancy_grid_aso);
+
   // Advertise more services on the custom queue
   std::string get_joint_properties_service_name("get_joint_properties");
   ros::AdvertiseServiceOptions get_joint_properties_aso =
     ros::AdvertiseServiceOptions::create<gazebo_msgs::GetJointProperties>(
                                                                           get_joint_properties_service_name,
                                                                           boost::bind(&GazeboRosApiPlugin::getJointProperties,this,_1,_2),
-                                                                          ros::VoidPtr(), &gazebo_queue_);
+                                                                          ros::VoidPtr(), read_queue);
   get_joint_properties_service_ = nh_->advertiseService(get_joint_properties_aso);
 
   // Advertise more services on the custom queue
@@ -349,7 +617,7 @@ void GazeboRosApiPlugin::advertiseServices()
     ros::AdvertiseServiceOptions::create<gazebo_msgs::GetLinkProperties>(
                                                                          get_link_properties_service_name,
                                                                          boost::bind(&GazeboRosApiPlugin::getLinkProperties,this,_1,_2),
-                                                                         ros::VoidPtr(), &gazebo_queue_);
+                                                                         ros::VoidPtr(), read_queue);
   get_link_properties_service_ = nh_->advertiseService(get_link_properties_aso);
 
   // Advertise more services on the custom queue
@@ -358,7 +626,7 @@ void GazeboRosApiPlugin::advertiseServices()
     ros::AdvertiseServiceOptions::create<gazebo_msgs::GetLinkState>(
                                                                     get_link_state_service_name,
                                                                     boost::bind(&GazeboRosApiPlugin::getLinkState,this,_1,_2),
-                                                                    ros::VoidPtr(), &gazebo_queue_);
+                                                                    ros::VoidPtr(), read_queue);
   get_link_state_service_ = nh_->advertiseService(get_link_state_aso);
 
   // Advertise more services on the custom queue
@@ -367,7 +635,7 @@ void GazeboRosApiPlugin::advertiseServices()
     ros::AdvertiseServiceOptions::create<gazebo_msgs::GetLightProperties>(
                                                                           get_light_properties_service_name,
                                                                           boost::bind(&GazeboRosApiPlugin::getLightProperties,this,_1,_2),
-                                                                          ros::VoidPtr(), &gazebo_queue_);
+                                                                          ros::VoidPtr(), read_queue);
   get_light_properties_service_ = nh_->advertiseService(get_light_properties_aso);
 
   // Advertise more services on the custom queue
@@ -385,26 +653,149 @@ void GazeboRosApiPlugin::advertiseServices()
     ros::AdvertiseServiceOptions::create<gazebo_msgs::GetPhysicsProperties>(
                                                                             get_physics_properties_service_name,
                                                                             boost::bind(&GazeboRosApiPlugin::getPhysicsProperties,this,_1,_2),
-                                                                            ros::VoidPtr(), &gazebo_queue_);
+                                                                            ros::VoidPtr(), read_queue);
   get_physics_properties_service_ = nh_->advertiseService(get_physics_properties_aso);
 
-  // publish complete link states in world frame
-  ros::AdvertiseOptions pub_link_states_ao =
-    ros::AdvertiseOptions::create<gazebo_msgs::LinkStates>(
-                                                           "link_states",10,
-                                                           boost::bind(&GazeboRosApiPlugin::onLinkStatesConnect,this),
-                                                           boost::bind(&GazeboRosApiPlugin::onLinkStatesDisconnect,this),
-                                                           ros::VoidPtr(), &gazebo_queue_);
-  pub_link_states_ = nh_->advertise(pub_link_states_ao);
-
-  // publish complete model states in world frame
-  ros::AdvertiseOptions pub_model_states_ao =
-    ros::AdvertiseOptions::create<gazebo_msgs::ModelStates>(
-                                                            "model_states",10,
-                                                            boost::bind(&GazeboRosApiPlugin::onModelStatesConnect,this),
-                                                            boost::bind(&GazeboRosApiPlugin::onModelStatesDisconnect,this),
-                                                            ros::VoidPtr(), &gazebo_queue_);
-  pub_model_states_ = nh_->advertise(pub_model_states_ao);
+  // model and link states are built and published by worker threads, at
+  // link_states_publish_rate and model_states_publish_rate Hz of sim time
+  // (0, the default, for every world update)
+  double link_states_publish_rate = 0;
+  double model_states_publish_rate = 0;
+  nh_->getParam("link_states_publish_rate", link_states_publish_rate);
+  nh_->getParam("model_states_publish_rate", model_states_publish_rate);
+  link_states_publisher_.reset(new EntityStatesPublisher(EntityStatesPublisher::LINKS, world_,
+                                                         link_states_publish_rate));
+  model_states_publisher_.reset(new EntityStatesPublisher(EntityStatesPublisher::MODELS, world_,
+                                                          model_states_publish_rate));
+
+  // legacy_states false leaves out link_states and model_states, e.g. when
+  // all consumers read the compact ones
+  bool legacy_states = true;
+  nh_->getParam("legacy_states", legacy_states);
+
+  if (legacy_states)
+  {
+    // publish complete link states in world frame
+    ros::AdvertiseOptions pub_link_states_ao =
+      ros::AdvertiseOptions::create<gazebo_msgs::LinkStates>(
+                                                             "link_states",10,
+                                                             boost::bind(&GazeboRosApiPlugin::onLinkStatesConnect,this),
+                                                             boost::bind(&GazeboRosApiPlugin::onLinkStatesDisconnect,this),
+                                                             ros::VoidPtr(), &gazebo_queue_);
+    pub_link_states_ = nh_->advertise(pub_link_states_ao);
+    link_states_publisher_->setPublisher(pub_link_states_);
+
+    // publish complete model states in world frame
+    ros::AdvertiseOptions pub_model_states_ao =
+      ros::AdvertiseOptions::create<gazebo_msgs::ModelStates>(
+                                                              "model_states",10,
+                                                              boost::bind(&GazeboRosApiPlugin::onModelStatesConnect,this),
+                                                              boost::bind(&GazeboRosApiPlugin::onModelStatesDisconnect,this),
+                                                              ros::VoidPtr(), &gazebo_queue_);
+    pub_model_states_ = nh_->advertise(pub_model_states_ao);
+    model_states_publisher_->setPublisher(pub_model_states_);
+  }
+
+  // incremental link and model states, they share the world update hooks
+  // and connection counts of link_states and model_states
+  EntityStatesPublisher::DeltaOptions delta_options;
+  nh_->getParam("states_delta_keyframe_interval", delta_options.keyframe_interval);
+  nh_->getParam("states_delta_position_threshold", delta_options.position_threshold);
+  nh_->getParam("states_delta_orientation_threshold", delta_options.orientation_threshold);
+  nh_->getParam("states_delta_velocity_threshold", delta_options.velocity_threshold);
+
+  ros::AdvertiseOptions pub_link_states_delta_ao =
+    ros::AdvertiseOptions::create<gazebo_msgs::EntityStatesDelta>(
+                                                                  "link_states_delta",10,
+                                                                  boost::bind(&GazeboRosApiPlugin::onLinkStatesDeltaConnect,this),
+                                                                  boost::bind(&GazeboRosApiPlugin::onLinkStatesDisconnect,this),
+                                                                  ros::VoidPtr(), &gazebo_queue_);
+  pub_link_states_delta_ = nh_->advertise(pub_link_states_delta_ao);
+  link_states_publisher_->setDeltaPublisher(pub_link_states_delta_, delta_options);
+
+  ros::AdvertiseOptions pub_model_states_delta_ao =
+    ros::AdvertiseOptions::create<gazebo_msgs::EntityStatesDelta>(
+                                                                  "model_states_delta",10,
+                                                                  boost::bind(&GazeboRosApiPlugin::onModelStatesDeltaConnect,this),
+                                                                  boost::bind(&GazeboRosApiPlugin::onModelStatesDisconnect,this),
+                                                                  ros::VoidPtr(), &gazebo_queue_);
+  pub_model_states_delta_ = nh_->advertise(pub_model_states_delta_ao);
+  model_states_publisher_->setDeltaPublisher(pub_model_states_delta_, delta_options);
+
+  // float32 link and model states, their names on latched topics.  They
+  // share the world update hooks and connection counts too.
+  bool compact_states = false;
+  nh_->getParam("compact_states", compact_states);
+  if (compact_states)
+  {
+    pub_link_states_compact_names_ = nh_->advertise<gazebo_msgs::EntityStatesNames>("link_states_compact_names", 1, true);
+    ros::AdvertiseOptions pub_link_states_compact_ao =
+      ros::AdvertiseOptions::create<gazebo_msgs::CompactEntityStates>(
+                                                                      "link_states_compact",10,
+                                                                      boost::bind(&GazeboRosApiPlugin::onLinkStatesConnect,this),
+                                                                      boost::bind(&GazeboRosApiPlugin::onLinkStatesDisconnect,this),
+                                                                      ros::VoidPtr(), &gazebo_queue_);
+    pub_link_states_compact_ = nh_->advertise(pub_link_states_compact_ao);
+    link_states_publisher_->setCompactPublishers(pub_link_states_compact_names_, pub_link_states_compact_);
+
+    pub_model_states_compact_names_ = nh_->advertise<gazebo_msgs::EntityStatesNames>("model_states_compact_names", 1, true);
+    ros::AdvertiseOptions pub_model_states_compact_ao =
+      ros::AdvertiseOptions::create<gazebo_msgs::CompactEntityStates>(
+                                                                      "model_states_compact",10,
+                                                                      boost::bind(&GazeboRosApiPlugin::onModelStatesConnect,this),
+                                                                      boost::bind(&GazeboRosApiPlugin::onModelStatesDisconnect,this),
+                                                                      ros::VoidPtr(), &gazebo_queue_);
+    pub_model_states_compact_ = nh_->advertise(pub_model_states_compact_ao);
+    model_states_publisher_->setCompactPublishers(pub_model_states_compact_names_, pub_model_states_compact_);
+  }
+
+  advertiseFilteredStates();
+
+  // states of the pairs registered with register_relative_states, at
+  // relative_states_publish_rate Hz of sim time (0, the default, for every
+  // world update)
+  double relative_states_publish_rate = 0;
+  nh_->getParam("relative_states_publish_rate", relative_states_publish_rate);
+  relative_states_publisher_.reset(new RelativeStatesPublisher(world_, relative_states_publish_rate));
+  ros::AdvertiseOptions pub_relative_states_ao =
+    ros::AdvertiseOptions::create<gazebo_msgs::RelativeStates>(
+                                                               "relative_states",10,
+                                                               boost::bind(&GazeboRosApiPlugin::onRelativeStatesConnect,this),
+                                                               boost::bind(&GazeboRosApiPlugin::onRelativeStatesDisconnect,this),
+                                                               ros::VoidPtr(), &gazebo_queue_);
+  pub_relative_states_ = nh_->advertise(pub_relative_states_ao);
+  relative_states_publisher_->setPublisher(pub_relative_states_);
+
+  // link and model states in shared memory for readers on the same host,
+  // see ShmStatesReader.  The snapshots are then taken all the time.
+  bool shm_states = false;
+  nh_->getParam("shm_states", shm_states);
+  if (shm_states)
+  {
+    std::string shm_link_states_name = defaultShmName("gazebo_link_states");
+    std::string shm_model_states_name = defaultShmName("gazebo_model_states");
+    int shm_states_capacity = 4096;
+    nh_->getParam("shm_link_states_name", shm_link_states_name);
+    nh_->getParam("shm_model_states_name", shm_model_states_name);
+    nh_->getParam("shm_states_capacity", shm_states_capacity);
+    if (shm_states_capacity < 1)
+      shm_states_capacity = 1;
+
+    boost::shared_ptr<ShmStatesWriter> link_writer(new ShmStatesWriter(shm_link_states_name,
+                                                                       shm_states_capacity));
+    boost::shared_ptr<ShmStatesWriter> model_writer(new ShmStatesWriter(shm_model_states_name,
+                                                                        shm_states_capacity));
+    if (link_writer->isOpen())
+    {
+      link_states_publisher_->setShmWriter(link_writer);
+      onLinkStatesConnect();
+    }
+    if (model_writer->isOpen())
+    {
+      model_states_publisher_->setShmWriter(model_writer);
+      onModelStatesConnect();
+    }
+  }
 
 #ifdef GAZEBO_ROS_HAS_PERFORMANCE_METRICS
   // publish performance metrics
@@ -444,6 +835,31 @@ void GazeboRosApiPlugin::advertiseServices()
                                                                      ros::VoidPtr(), &gazebo_queue_);
   set_model_state_service_ = nh_->advertiseService(set_model_state_aso);
 
+  // Advertise batch model state services on the custom queue
+  std::string set_model_states_service_name("set_model_states");
+  ros::AdvertiseServiceOptions set_model_states_aso =
+    ros::AdvertiseServiceOptions::create<gazebo_msgs::SetModelStates>(
+                                                                      set_model_states_service_name,
+                                                                      boost::bind(&GazeboRosApiPlugin::setModelStates,this,_1,_2),
+                                                                      ros::VoidPtr(), &gazebo_queue_);
+  set_model_states_service_ = nh_->advertiseService(set_model_states_aso);
+
+  std::string get_model_states_service_name("get_model_states");
+  ros::AdvertiseServiceOptions get_model_states_aso =
+    ros::AdvertiseServiceOptions::create<gazebo_msgs::GetModelStates>(
+                                                                      get_model_states_service_name,
+                                                                      boost::bind(&GazeboRosApiPlugin::getModelStates,this,_1,_2),
+                                                                      ros::VoidPtr(), read_queue);
+  get_model_states_service_ = nh_->advertiseService(get_model_states_aso);
+
+  std::string register_relative_states_service_name("register_relative_states");
+  ros::AdvertiseServiceOptions register_relative_states_aso =
+    ros::AdvertiseServiceOptions::create<gazebo_msgs::RegisterRelativeStates>(
+                                                                              register_relative_states_service_name,
+                                                                              boost::bind(&GazeboRosApiPlugin::registerRelativeStates,this,_1,_2),
+                                                                              ros::VoidPtr(), &gazebo_queue_);
+  register_relative_states_service_ = nh_->advertiseService(register_relative_states_aso);
+
   // Advertise more services on the custom queue
   std::string set_model_configuration_service_name("set_model_configuration");
   ros::AdvertiseServiceOptions set_model_configuration_aso =
@@ -453,6 +869,15 @@ void GazeboRosApiPlugin::advertiseServices()
                                                                              ros::VoidPtr(), &gazebo_queue_);
   set_model_configuration_service_ = nh_->advertiseService(set_model_configuration_aso);
 
+  // Advertise the batch version, applied with the queued model states
+  std::string set_model_configurations_service_name("set_model_configurations");
+  ros::AdvertiseServiceOptions set_model_configurations_aso =
+    ros::AdvertiseServiceOptions::create<gazebo_msgs::SetModelConfigurations>(
+                                                                              set_model_configurations_service_name,
+                                                                              boost::bind(&GazeboRosApiPlugin::setModelConfigurations,this,_1,_2),
+                                                                              ros::VoidPtr(), &gazebo_queue_);
+  set_model_configurations_service_ = nh_->advertiseService(set_model_configurations_aso);
+
   // Advertise more services on the custom queue
   std::string set_joint_properties_service_name("set_joint_properties");
   ros::AdvertiseServiceOptions set_joint_properties_aso =
@@ -478,6 +903,7 @@ void GazeboRosApiPlugin::advertiseServices()
                                                           "set_link_state",10,
                                                           boost::bind( &GazeboRosApiPlugin::updateLinkState,this,_1),
                                                           ros::VoidPtr(), &gazebo_queue_);
+  subscription_hints_.apply(link_state_so);
   set_link_state_topic_ = nh_->subscribe(link_state_so);
 
   // topic callback version for set_model_state
@@ -486,8 +912,44 @@ void GazeboRosApiPlugin::advertiseServices()
                                                            "set_model_state",10,
                                                            boost::bind( &GazeboRosApiPlugin::updateModelState,this,_1),
                                                            ros::VoidPtr(), &gazebo_queue_);
+  subscription_hints_.apply(model_state_so);
   set_model_state_topic_ = nh_->subscribe(model_state_so);
 
+  // topic callback version for set_model_states, world frame states applied together
+  ros::SubscribeOptions model_states_so =
+    ros::SubscribeOptions::create<gazebo_msgs::ModelStates>(
+                                                            "set_model_states",10,
+                                                            boost::bind( &GazeboRosApiPlugin::updateModelStates,this,_1),
+                                                            ros::VoidPtr(), &gazebo_queue_);
+  subscription_hints_.apply(model_states_so);
+  set_model_states_topic_ = nh_->subscribe(model_states_so);
+
+  // Advertise lockstep stepping on the custom queue
+  std::string step_world_service_name("step_world");
+  ros::AdvertiseServiceOptions step_world_aso =
+    ros::AdvertiseServiceOptions::create<gazebo_msgs::StepWorld>(
+                                                                 step_world_service_name,
+                                                                 boost::bind(&GazeboRosApiPlugin::stepWorld,this,_1,_2),
+                                                                 ros::VoidPtr(), &gazebo_queue_);
+  step_world_service_ = nh_->advertiseService(step_world_aso);
+
+  // Advertise world state slots on the custom queue
+  std::string save_world_state_service_name("save_world_state");
+  ros::AdvertiseServiceOptions save_world_state_aso =
+    ros::AdvertiseServiceOptions::create<gazebo_msgs::SaveWorldState>(
+                                                                      save_world_state_service_name,
+                                                                      boost::bind(&GazeboRosApiPlugin::saveWorldState,this,_1,_2),
+                                                                      ros::VoidPtr(), &gazebo_queue_);
+  save_world_state_service_ = nh_->advertiseService(save_world_state_aso);
+
+  std::string restore_world_state_service_name("restore_world_state");
+  ros::AdvertiseServiceOptions restore_world_state_aso =
+    ros::AdvertiseServiceOptions::create<gazebo_msgs::RestoreWorldState>(
+                                                                         restore_world_state_service_name,
+                                                                         boost::bind(&GazeboRosApiPlugin::restoreWorldState,this,_1,_2),
+                                                                         ros::VoidPtr(), &gazebo_queue_);
+  restore_world_state_service_ = nh_->advertiseService(restore_world_state_aso);
+
   // Advertise more services on the custom queue
   std::string pause_physics_service_name("pause_physics");
   ros::AdvertiseServiceOptions pause_physics_aso =
@@ -559,6 +1021,22 @@ void GazeboRosApiPlugin::advertiseServices()
                                                           boost::bind(&GazeboRosApiPlugin::resetWorld,this,_1,_2),
                                                           ros::VoidPtr(), &gazebo_queue_);
   reset_world_service_ = nh_->advertiseService(reset_world_aso);
+
+  std::string set_profiling_service_name("set_profiling");
+  ros::AdvertiseServiceOptions set_profiling_aso =
+    ros::AdvertiseServiceOptions::create<std_srvs::SetBool>(
+                                                            set_profiling_service_name,
+                                                            boost::bind(&GazeboRosApiPlugin::setProfiling,this,_1,_2),
+                                                            ros::VoidPtr(), &gazebo_queue_);
+  set_profiling_service_ = nh_->advertiseService(set_profiling_aso);
+
+  std::string set_latency_tracing_service_name("set_latency_tracing");
+  ros::AdvertiseServiceOptions set_latency_tracing_aso =
+    ros::AdvertiseServiceOptions::create<std_srvs::SetBool>(
+                                                            set_latency_tracing_service_name,
+                                                            boost::bind(&GazeboRosApiPlugin::setLatencyTracing,this,_1,_2),
+                                                            ros::VoidPtr(), &gazebo_queue_);
+  set_latency_tracing_service_ = nh_->advertiseService(set_latency_tracing_aso);
 }
 
 void GazeboRosApiPlugin::onLinkStatesConnect()
@@ -575,6 +1053,141 @@ void GazeboRosApiPlugin::onModelStatesConnect()
     pub_model_states_event_   = gazebo::event::Events::ConnectWorldUpdateBegin(boost::bind(&GazeboRosApiPlugin::publishModelStates,this));
 }
 
+void GazeboRosApiPlugin::onRelativeStatesConnect()
+{
+  pub_relative_states_connection_count_++;
+  if (pub_relative_states_connection_count_ == 1) // connect on first subscriber
+    pub_relative_states_event_ = gazebo::event::Events::ConnectWorldUpdateBegin(boost::bind(&GazeboRosApiPlugin::publishRelativeStates,this));
+}
+
+void GazeboRosApiPlugin::onRelativeStatesDisconnect()
+{
+  pub_relative_states_connection_count_--;
+  if (pub_relative_states_connection_count_ <= 0) // disconnect with no subscribers
+  {
+    pub_relative_states_event_.reset();
+    if (pub_relative_states_connection_count_ < 0) // should not be possible
+      ROS_ERROR_NAMED("api_plugin", "One too many disconnect from pub_relative_states_ in gazebo_ros.cpp? something weird");
+  }
+}
+
+void GazeboRosApiPlugin::advertiseFilteredStates()
+{
+  // e.g.
+  //   filtered_states:
+  //     - {topic: robot/link_states, type: links, prefix: "robot::", rate: 100}
+  //     - {topic: boxes/model_states, type: models, regex: "box_[0-9]+"}
+  // each topic is built by its own worker at its own sim time rate
+  XmlRpc::XmlRpcValue filtered_states;
+  if (!nh_->getParam("filtered_states", filtered_states))
+    return;
+  if (filtered_states.getType() != XmlRpc::XmlRpcValue::TypeArray)
+  {
+    ROS_ERROR_NAMED("api_plugin", "filtered_states must be a list");
+    return;
+  }
+
+  for (int i = 0; i < filtered_states.size(); ++i)
+  {
+    XmlRpc::XmlRpcValue &entry = filtered_states[i];
+    if (entry.getType() != XmlRpc::XmlRpcValue::TypeStruct || !entry.hasMember("topic") ||
+        entry["topic"].getType() != XmlRpc::XmlRpcValue::TypeString)
+    {
+      ROS_ERROR_NAMED("api_plugin", "filtered_states[%d] needs a topic", i);
+      continue;
+    }
+    const std::string topic = entry["topic"];
+    std::string type = "links";
+    std::string prefix;
+    std::string regex;
+    double rate = 0;
+    if (entry.hasMember("type") && entry["type"].getType() == XmlRpc::XmlRpcValue::TypeString)
+      type = static_cast<std::string>(entry["type"]);
+    if (entry.hasMember("prefix") && entry["prefix"].getType() == XmlRpc::XmlRpcValue::TypeString)
+      prefix = static_cast<std::string>(entry["prefix"]);
+    if (entry.hasMember("regex") && entry["regex"].getType() == XmlRpc::XmlRpcValue::TypeString)
+      regex = static_cast<std::string>(entry["regex"]);
+    if (entry.hasMember("rate"))
+    {
+      if (entry["rate"].getType() == XmlRpc::XmlRpcValue::TypeDouble)
+        rate = entry["rate"];
+      else if (entry["rate"].getType() == XmlRpc::XmlRpcValue::TypeInt)
+        rate = static_cast<int>(entry["rate"]);
+    }
+    if (type != "links" && type != "models")
+    {
+      ROS_ERROR_NAMED("api_plugin", "filtered_states topic %s: type must be links or models", topic.c_str());
+      continue;
+    }
+
+    FilteredStatesPtr filtered(new FilteredStates());
+    filtered->publisher.reset(new EntityStatesPublisher(
+      type == "links" ? EntityStatesPublisher::LINKS : EntityStatesPublisher::MODELS, world_, rate));
+    filtered->publisher->setTimingName(topic);
+    try
+    {
+      filtered->publisher->setFilter(prefix, regex);
+    }
+    catch (const std::regex_error &e)
+    {
+      ROS_ERROR_NAMED("api_plugin", "filtered_states topic %s: invalid regex [%s]: %s",
+                      topic.c_str(), regex.c_str(), e.what());
+      continue;
+    }
+
+    if (type == "links")
+    {
+      ros::AdvertiseOptions ao =
+        ros::AdvertiseOptions::create<gazebo_msgs::LinkStates>(
+          topic, 10,
+          boost::bind(&GazeboRosApiPlugin::onFilteredStatesConnect, this, filtered.get()),
+          boost::bind(&GazeboRosApiPlugin::onFilteredStatesDisconnect, this, filtered.get()),
+          ros::VoidPtr(), &gazebo_queue_);
+      filtered->pub = nh_->advertise(ao);
+    }
+    else
+    {
+      ros::AdvertiseOptions ao =
+        ros::AdvertiseOptions::create<gazebo_msgs::ModelStates>(
+          topic, 10,
+          boost::bind(&GazeboRosApiPlugin::onFilteredStatesConnect, this, filtered.get()),
+          boost::bind(&GazeboRosApiPlugin::onFilteredStatesDisconnect, this, filtered.get()),
+          ros::VoidPtr(), &gazebo_queue_);
+      filtered->pub = nh_->advertise(ao);
+    }
+    filtered->publisher->setPublisher(filtered->pub);
+    filtered_states_.push_back(filtered);
+  }
+}
+
+void GazeboRosApiPlugin::onFilteredStatesConnect(FilteredStates *filtered)
+{
+  filtered->connection_count++;
+  if (filtered->connection_count == 1) // connect on first subscriber
+    filtered->event = gazebo::event::Events::ConnectWorldUpdateBegin(
+      boost::bind(&EntityStatesPublisher::capture, filtered->publisher.get()));
+}
+
+void GazeboRosApiPlugin::onFilteredStatesDisconnect(FilteredStates *filtered)
+{
+  filtered->connection_count--;
+  if (filtered->connection_count <= 0) // disconnect with no subscribers
+    filtered->event.reset();
+}
+
+void GazeboRosApiPlugin::onLinkStatesDeltaConnect()
+{
+  // a new subscriber needs the names first
+  link_states_publisher_->requestKeyframe();
+  onLinkStatesConnect();
+}
+
+void GazeboRosApiPlugin::onModelStatesDeltaConnect()
+{
+  model_states_publisher_->requestKeyframe();
+  onModelStatesConnect();
+}
+
 #ifdef GAZEBO_ROS_HAS_PERFORMANCE_METRICS
 void GazeboRosApiPlugin::onPerformanceMetricsConnect()
 {
@@ -626,10 +1239,15 @@ bool GazeboRosApiPlugin::spawnURDFModel(gazebo_msgs::SpawnModel::Request &req,
   // get namespace for the corresponding model plugins
   robot_namespace_ = req.robot_namespace;
 
-  // incoming entity string
-  std::string model_xml = req.model_xml;
+  // incoming entity string, resolved and parsed once per distinct xml
+  ParsedModelConstPtr parsed = parseModel(req.model_xml, true, res.status_message);
+  if (!parsed)
+  {
+    res.success = false;
+    return false;
+  }
 
-  if (!isURDF(model_xml))
+  if (!parsed->is_urdf)
   {
     ROS_ERROR_NAMED("api_plugin", "SpawnModel: Failure - entity format is invalid.");
     res.success = false;
@@ -637,6 +1255,16 @@ bool GazeboRosApiPlugin::spawnURDFModel(gazebo_msgs::SpawnModel::Request &req,
     return false;
   }
 
+  // Model is now considered convert to SDF
+  TiXmlDocument gazebo_model_xml;
+  if (!buildSpawnXml(req, *parsed, gazebo_model_xml, res))
+    return true;
+
+  return spawnAndConform(gazebo_model_xml, req.model_name, res);
+}
+
+bool GazeboRosApiPlugin::resolveURDF(std::string &model_xml, std::string &status_message)
+{
   /// STRIP DECLARATION <? ... xml version="1.0" ... ?> from model_xml
   /// @todo: does tinyxml have functionality for this?
   /// @todo: should gazebo take care of the declaration?
@@ -681,8 +1309,7 @@ bool GazeboRosApiPlugin::spawnURDFModel(gazebo_msgs::SpawnModel::Request &req,
       if (package_path.empty())
       {
         ROS_FATAL_NAMED("api_plugin", "Package[%s] does not have a path",package_name.c_str());
-        res.success = false;
-        res.status_message = "urdf reference package name does not exist: " + package_name;
+        status_message = "urdf reference package name does not exist: " + package_name;
         return false;
       }
       ROS_DEBUG_ONCE_NAMED("api_plugin", "Package name [%s] has path [%s]", package_name.c_str(), package_path.c_str());
@@ -693,14 +1320,133 @@ bool GazeboRosApiPlugin::spawnURDFModel(gazebo_msgs::SpawnModel::Request &req,
   }
   // ROS_DEBUG_NAMED("api_plugin", "Model XML\n\n%s\n\n ",model_xml.c_str());
 
-  req.model_xml = model_xml;
-
-  // Model is now considered convert to SDF
-  return spawnSDFModel(req,res);
+  return true;
 }
 
 bool GazeboRosApiPlugin::spawnSDFModel(gazebo_msgs::SpawnModel::Request &req,
                                        gazebo_msgs::SpawnModel::Response &res)
+{
+  ParsedModelConstPtr parsed = parseModel(req.model_xml, false, res.status_message);
+
+  TiXmlDocument gazebo_model_xml;
+  if (!buildSpawnXml(req, *parsed, gazebo_model_xml, res))
+    return true;
+
+  // do spawning check if spawn worked, return response
+  return spawnAndConform(gazebo_model_xml, req.model_name, res);
+}
+
+GazeboRosApiPlugin::ParsedModelConstPtr GazeboRosApiPlugin::parseModel(const std::string &model_xml,
+                                                                       bool resolve_urdf,
+                                                                       std::string &status_message)
+{
+  boost::hash<std::string> hasher;
+  std::size_t key = hasher(model_xml);
+  boost::hash_combine(key, resolve_urdf);
+
+  ParsedModelMap::const_iterator it = parsed_models_.find(key);
+  if (it != parsed_models_.end() && it->second->source == model_xml &&
+      it->second->resolve_urdf == resolve_urdf)
+    return it->second;
+
+  boost::shared_ptr<ParsedModel> parsed(new ParsedModel());
+  parsed->source = model_xml;
+  parsed->resolve_urdf = resolve_urdf;
+
+  std::string xml = model_xml;
+  if (resolve_urdf && isURDF(xml) && !resolveURDF(xml, status_message))
+    return ParsedModelConstPtr();
+
+  // store resulting Gazebo Model XML to be sent to spawn queue
+  // get incoming string containg either an URDF or a Gazebo Model XML
+  // grab from parameter server if necessary convert to SDF if necessary
+  stripXmlDeclaration(xml);
+
+  // put string in TiXmlDocument for manipulation
+  parsed->doc.Parse(xml.c_str());
+  parsed->is_sdf = isSDF(xml);
+  parsed->is_urdf = isURDF(xml);
+
+  if (model_cache_size_ <= 0)
+    return parsed;
+
+  // oldest out first, a hash collision just replaces the entry
+  if (it == parsed_models_.end())
+  {
+    while (parsed_model_order_.size() >= static_cast<size_t>(model_cache_size_))
+    {
+      parsed_models_.erase(parsed_model_order_.front());
+      parsed_model_order_.pop_front();
+    }
+    parsed_model_order_.push_back(key);
+  }
+  parsed_models_[key] = parsed;
+  return parsed;
+}
+
+bool GazeboRosApiPlugin::setModelTemplate(gazebo_msgs::SetModelTemplate::Request &req,
+                                          gazebo_msgs::SetModelTemplate::Response &res)
+{
+  if (req.model_xml.empty())
+  {
+    model_templates_.erase(req.template_name);
+    res.success = true;
+    res.status_message = "SetModelTemplate: template removed";
+    return true;
+  }
+
+  // the template keeps its parse when the cache drops it
+  std::string status_message;
+  ParsedModelConstPtr parsed = parseModel(req.model_xml, true, status_message);
+  if (!parsed)
+  {
+    res.success = false;
+    res.status_message = status_message;
+    return true;
+  }
+  if (!parsed->is_sdf && !parsed->is_urdf)
+  {
+    res.success = false;
+    res.status_message = "SetModelTemplate: Failure - model_xml not SDF or URDF";
+    return true;
+  }
+
+  model_templates_[req.template_name] = parsed;
+  res.success = true;
+  res.status_message = "SetModelTemplate: template set";
+  return true;
+}
+
+bool GazeboRosApiPlugin::spawnModelTemplate(gazebo_msgs::SpawnModelTemplate::Request &req,
+                                            gazebo_msgs::SpawnModelTemplate::Response &res)
+{
+  std::map<std::string, ParsedModelConstPtr>::const_iterator it = model_templates_.find(req.template_name);
+  if (it == model_templates_.end())
+  {
+    res.success = false;
+    res.status_message = "SpawnModelTemplate: Failure - no template " + req.template_name;
+    return true;
+  }
+
+  gazebo_msgs::SpawnModel::Request spawn_req;
+  gazebo_msgs::SpawnModel::Response spawn_res;
+  spawn_req.model_name = req.model_name;
+  spawn_req.robot_namespace = req.robot_namespace;
+  spawn_req.initial_pose = req.initial_pose;
+  spawn_req.reference_frame = req.reference_frame;
+
+  TiXmlDocument gazebo_model_xml;
+  if (buildSpawnXml(spawn_req, *it->second, gazebo_model_xml, spawn_res))
+    spawnAndConform(gazebo_model_xml, spawn_req.model_name, spawn_res);
+  res.success = spawn_res.success;
+  res.status_message = spawn_res.status_message;
+  return true;
+}
+
+bool GazeboRosApiPlugin::buildSpawnXml(gazebo_msgs::SpawnModel::Request &req,
+                                       const ParsedModel &parsed,
+                                       TiXmlDocument &gazebo_model_xml,
+                                       gazebo_msgs::SpawnModel::Response &res)
 {
   // incoming entity name
   std::string model_name = req.model_name;
@@ -714,11 +1460,7 @@ bool GazeboRosApiPlugin::spawnSDFModel(gazebo_msgs::SpawnModel::Request &req,
   ignition::math::Quaterniond initial_q(req.initial_pose.orientation.w,req.initial_pose.orientation.x,req.initial_pose.orientation.y,req.initial_pose.orientation.z);
 
   // refernce frame for initial pose definition, modify initial pose if defined
-#if GAZEBO_MAJOR_VERSION >= 8
-  gazebo::physics::EntityPtr frame = world_->EntityByName(req.reference_frame);
-#else
-  gazebo::physics::EntityPtr frame = world_->GetEntity(req.reference_frame);
-#endif
+  gazebo::physics::EntityPtr frame = entity_index_->entity(req.reference_frame);
   if (frame)
   {
     // convert to relative pose
@@ -740,23 +1482,14 @@ bool GazeboRosApiPlugin::spawnSDFModel(gazebo_msgs::SpawnModel::Request &req,
   {
     res.success = false;
     res.status_message = "SpawnModel: reference reference_frame not found, did you forget to scope the link by model name?";
-    return true;
+    return false;
   }
 
-  // incoming robot model string
-  std::string model_xml = req.model_xml;
-
-  // store resulting Gazebo Model XML to be sent to spawn queue
-  // get incoming string containg either an URDF or a Gazebo Model XML
-  // grab from parameter server if necessary convert to SDF if necessary
-  stripXmlDeclaration(model_xml);
-
-  // put string in TiXmlDocument for manipulation
-  TiXmlDocument gazebo_model_xml;
-  gazebo_model_xml.Parse(model_xml.c_str());
+  // copy of the parsed model for manipulation
+  gazebo_model_xml = parsed.doc;
 
   // optional model manipulations: update initial pose && replace model name
-  if (isSDF(model_xml))
+  if (parsed.is_sdf)
   {
     updateSDFAttributes(gazebo_model_xml, model_name, initial_xyz, initial_q);
 
@@ -779,7 +1512,7 @@ bool GazeboRosApiPlugin::spawnSDFModel(gazebo_msgs::SpawnModel::Request &req,
       }
     }
   }
-  else if (isURDF(model_xml))
+  else if (parsed.is_urdf)
   {
     updateURDFModelPose(gazebo_model_xml, initial_xyz, initial_q);
     updateURDFName(gazebo_model_xml, model_name);
@@ -805,76 +1538,58 @@ bool GazeboRosApiPlugin::spawnSDFModel(gazebo_msgs::SpawnModel::Request &req,
     ROS_ERROR_NAMED("api_plugin", "GazeboRosApiPlugin SpawnModel Failure: input xml format not recognized");
     res.success = false;
     res.status_message = "GazeboRosApiPlugin SpawnModel Failure: input model_xml not SDF or URDF, or cannot be converted to Gazebo compatible format.";
-    return true;
+    return false;
   }
 
-  // do spawning check if spawn worked, return response
-  return spawnAndConform(gazebo_model_xml, model_name, res);
+  return true;
 }
 
-bool GazeboRosApiPlugin::deleteModel(gazebo_msgs::DeleteModel::Request &req,
-                                     gazebo_msgs::DeleteModel::Response &res)
+bool GazeboRosApiPlugin::pushDelete(const std::string &model_name, std::string &status_message)
 {
   // clear forces, etc for the body in question
-#if GAZEBO_MAJOR_VERSION >= 8
-  gazebo::physics::ModelPtr model = world_->ModelByName(req.model_name);
-#else
-  gazebo::physics::ModelPtr model = world_->GetModel(req.model_name);
-#endif
+  gazebo::physics::ModelPtr model = entity_index_->model(model_name);
   if (!model)
   {
-    ROS_ERROR_NAMED("api_plugin", "DeleteModel: model [%s] does not exist",req.model_name.c_str());
-    res.success = false;
-    res.status_message = "DeleteModel: model does not exist";
-    return true;
-  }
-
-  // delete wrench jobs on bodies
-  for (unsigned int i = 0 ; i < model->GetChildCount(); i ++)
-  {
-    gazebo::physics::LinkPtr body = boost::dynamic_pointer_cast<gazebo::physics::Link>(model->GetChild(i));
-    if (body)
-    {
-      // look for it in jobs, delete body wrench jobs
-      clearBodyWrenches(body->GetScopedName());
-    }
+    ROS_ERROR_NAMED("api_plugin", "DeleteModel: model [%s] does not exist",model_name.c_str());
+    status_message = "DeleteModel: model does not exist";
+    return false;
   }
 
-  // delete force jobs on joints
-  gazebo::physics::Joint_V joints = model->GetJoints();
-  for (unsigned int i=0;i< joints.size(); i++)
-  {
-    // look for it in jobs, delete joint force jobs
-    clearJointForces(joints[i]->GetName());
-  }
+  // delete wrench jobs on its bodies and force jobs on its joints
+  clearModelJobs(model->GetName());
 
   // send delete model request
-  gazebo::msgs::Request *msg = gazebo::msgs::CreateRequest("entity_delete",req.model_name);
+  gazebo::msgs::Request *msg = gazebo::msgs::CreateRequest("entity_delete",model_name);
   request_pub_->Publish(*msg,true);
   delete msg;
   msg = nullptr;
+  return true;
+}
+
+bool GazeboRosApiPlugin::deleteModel(gazebo_msgs::DeleteModel::Request &req,
+                                     gazebo_msgs::DeleteModel::Response &res)
+{
+  if (!pushDelete(req.model_name, res.status_message))
+  {
+    res.success = false;
+    return true;
+  }
 
   ros::Duration model_spawn_timeout(60.0);
   ros::Time timeout = ros::Time::now() + model_spawn_timeout;
-  // wait and verify that model is deleted
+  // wait and verify that model is deleted, woken by the world's entity events
   while (true)
   {
+    unsigned int seen = entityEventCount();
+    if (!modelExists(req.model_name)) break;
     if (ros::Time::now() > timeout)
     {
       res.success = false;
       res.status_message = "DeleteModel: Model pushed to delete queue, but delete service timed out waiting for model to disappear from simulation";
       return true;
     }
-    {
-      //boost::recursive_mutex::scoped_lock lock(*world->GetMRMutex());
-#if GAZEBO_MAJOR_VERSION >= 8
-      if (!world_->ModelByName(req.model_name)) break;
-#else
-      if (!world_->GetModel(req.model_name)) break;
-#endif
-    }
     ROS_DEBUG_NAMED("api_plugin", "Waiting for model deletion (%s)",req.model_name.c_str());
-    std::this_thread::sleep_for(std::chrono::microseconds(1000));
+    waitForEntityEvent(seen);
   }
 
   // set result
@@ -883,63 +1598,168 @@ bool GazeboRosApiPlugin::deleteModel(gazebo_msgs::DeleteModel::Request &req,
   return true;
 }
 
+bool GazeboRosApiPlugin::pushDeleteLight(const std::string &light_name, std::string &status_message)
+{
+  if (!lightExists(light_name))
+  {
+    status_message = "DeleteLight: Requested light " + light_name + " not found!";
+    return false;
+  }
+
+  gazebo::msgs::Request* msg = gazebo::msgs::CreateRequest("entity_delete", light_name);
+  request_pub_->Publish(*msg, true);
+  delete msg;
+  msg = nullptr;
+  return true;
+}
+
 bool GazeboRosApiPlugin::deleteLight(gazebo_msgs::DeleteLight::Request &req,
                                      gazebo_msgs::DeleteLight::Response &res)
 {
-#if GAZEBO_MAJOR_VERSION >= 8
-  gazebo::physics::LightPtr phy_light = world_->LightByName(req.light_name);
-#else
-  gazebo::physics::LightPtr phy_light = world_->Light(req.light_name);
-#endif
+  res.success = false;
+  if (!pushDeleteLight(req.light_name, res.status_message))
+    return true;
 
-  if (phy_light == NULL)
+  // wait and verify that the light is deleted, woken by the world's entity events
+  ros::Time timeout = ros::Time::now() + ros::Duration(10.0);
+  while (ros::ok())
   {
-    res.success = false;
-    res.status_message = "DeleteLight: Requested light " + req.light_name + " not found!";
+    unsigned int seen = entityEventCount();
+    if (!lightExists(req.light_name))
+    {
+      res.success = true;
+      res.status_message = "DeleteLight: " + req.light_name + " successfully deleted";
+      return true;
+    }
+    if (ros::Time::now() > timeout)
+      break;
+    waitForEntityEvent(seen);
   }
-  else
+
+  res.status_message = "DeleteLight: Timeout reached while removing light \"" + req.light_name
+                       + "\"";
+
+  return true;
+}
+
+const double GazeboRosApiPlugin::deletion_ticket_lifetime_ = 600.0;
+
+bool GazeboRosApiPlugin::deleteEntitiesAsync(gazebo_msgs::DeleteEntitiesAsync::Request &req,
+                                             gazebo_msgs::DeleteEntitiesAsync::Response &res)
+{
+  const size_t n_models = req.model_name.size();
+  const size_t n_lights = req.light_name.size();
+  res.model_success.assign(n_models, false);
+  res.light_success.assign(n_lights, false);
+
+  DeletionTicket ticket;
+  std::vector<std::string> failures;
+  std::string status;
+  for (size_t i = 0; i < n_models; ++i)
+  {
+    res.model_success[i] = pushDelete(req.model_name[i], status);
+    if (res.model_success[i])
+      ticket.models.push_back(req.model_name[i]);
+    else
+      failures.push_back(req.model_name[i]);
+  }
+  for (size_t i = 0; i < n_lights; ++i)
   {
-    gazebo::msgs::Request* msg = gazebo::msgs::CreateRequest("entity_delete", req.light_name);
-    request_pub_->Publish(*msg, true);
-    delete msg;
-    msg = nullptr;
+    res.light_success[i] = pushDeleteLight(req.light_name[i], status);
+    if (res.light_success[i])
+      ticket.lights.push_back(req.light_name[i]);
+    else
+      failures.push_back(req.light_name[i]);
+  }
 
-    res.success = false;
+  res.success = failures.empty();
+  res.ticket = 0;
+  std::ostringstream message;
+  message << "DeleteEntitiesAsync: sent " << ticket.models.size() + ticket.lights.size() << " of "
+          << n_models + n_lights << " delete requests";
+  if (!failures.empty())
+  {
+    message << ", not found:";
+    for (size_t i = 0; i < failures.size(); ++i)
+      message << " " << failures[i];
+  }
+  res.status_message = message.str();
+  if (ticket.models.empty() && ticket.lights.empty())
+    return true;
+
+  ticket.created = ros::WallTime::now();
+  boost::mutex::scoped_lock lock(deletion_tickets_mutex_);
+  // forget tickets nobody came back for
+  for (std::map<uint32_t, DeletionTicket>::iterator it = deletion_tickets_.begin();
+       it != deletion_tickets_.end();)
+  {
+    if ((ticket.created - it->second.created).toSec() > deletion_ticket_lifetime_)
+      deletion_tickets_.erase(it++);
+    else
+      ++it;
+  }
+  res.ticket = next_deletion_ticket_++;
+  if (next_deletion_ticket_ == 0)
+    next_deletion_ticket_ = 1;
+  deletion_tickets_[res.ticket] = ticket;
+  return true;
+}
 
-    for (int i = 0; i < 100; i++)
+bool GazeboRosApiPlugin::awaitDeletion(gazebo_msgs::AwaitDeletion::Request &req,
+                                       gazebo_msgs::AwaitDeletion::Response &res)
+{
+  DeletionTicket ticket;
+  {
+    boost::mutex::scoped_lock lock(deletion_tickets_mutex_);
+    std::map<uint32_t, DeletionTicket>::const_iterator it = deletion_tickets_.find(req.ticket);
+    if (it == deletion_tickets_.end())
     {
-#if GAZEBO_MAJOR_VERSION >= 8
-      phy_light = world_->LightByName(req.light_name);
-#else
-      phy_light = world_->Light(req.light_name);
-#endif
-      if (phy_light == NULL)
-      {
-        res.success = true;
-        res.status_message = "DeleteLight: " + req.light_name + " successfully deleted";
-        return true;
-      }
-      // Check every 100ms
-      std::this_thread::sleep_for(std::chrono::microseconds(100000));
+      res.done = false;
+      res.success = false;
+      res.status_message = "AwaitDeletion: unknown ticket, it was never issued, already completed or expired";
+      return true;
     }
+    ticket = it->second;
   }
 
-  res.status_message = "DeleteLight: Timeout reached while removing light \"" + req.light_name
-                       + "\"";
+  res.success = true;
+  ros::WallTime timeout = ros::WallTime::now() + ros::WallDuration(std::min(std::max(req.timeout, 0.0), 60.0));
+  while (true)
+  {
+    unsigned int seen = entityEventCount();
+    res.pending.clear();
+    for (size_t i = 0; i < ticket.models.size(); ++i)
+      if (modelExists(ticket.models[i]))
+        res.pending.push_back(ticket.models[i]);
+    for (size_t i = 0; i < ticket.lights.size(); ++i)
+      if (lightExists(ticket.lights[i]))
+        res.pending.push_back(ticket.lights[i]);
+    if (res.pending.empty() || ros::WallTime::now() >= timeout || !ros::ok())
+      break;
+    waitForEntityEvent(seen);
+  }
 
+  res.done = res.pending.empty();
+  if (res.done)
+  {
+    boost::mutex::scoped_lock lock(deletion_tickets_mutex_);
+    deletion_tickets_.erase(req.ticket);
+    res.status_message = "AwaitDeletion: all entities deleted";
+  }
+  else
+  {
+    std::ostringstream message;
+    message << "AwaitDeletion: " << res.pending.size() << " entities not deleted yet";
+    res.status_message = message.str();
+  }
   return true;
 }
 
 bool GazeboRosApiPlugin::getModelState(gazebo_msgs::GetModelState::Request &req,
                                        gazebo_msgs::GetModelState::Response &res)
 {
-#if GAZEBO_MAJOR_VERSION >= 8
-  gazebo::physics::ModelPtr model = world_->ModelByName(req.model_name);
-  gazebo::physics::EntityPtr frame = world_->EntityByName(req.relative_entity_name);
-#else
-  gazebo::physics::ModelPtr model = world_->GetModel(req.model_name);
-  gazebo::physics::EntityPtr frame = world_->GetEntity(req.relative_entity_name);
-#endif
+  gazebo::physics::ModelPtr model = entity_index_->model(req.model_name);
+  gazebo::physics::EntityPtr frame = entity_index_->entity(req.relative_entity_name);
   if (!model)
   {
     ROS_ERROR_NAMED("api_plugin", "GetModelState: model [%s] does not exist",req.model_name.c_str());
@@ -955,6 +1775,7 @@ bool GazeboRosApiPlugin::getModelState(gazebo_msgs::GetModelState::Request &req,
      * @date 21th Nov 2014
      **/
     {
+      boost::mutex::scoped_lock lock(access_count_mutex_);
       std::map<std::string, unsigned int>::iterator it = access_count_get_model_state_.find(req.model_name);
       if(it == access_count_get_model_state_.end())
       {
@@ -1042,11 +1863,7 @@ bool GazeboRosApiPlugin::getModelState(gazebo_msgs::GetModelState::Request &req,
 bool GazeboRosApiPlugin::getModelProperties(gazebo_msgs::GetModelProperties::Request &req,
                                             gazebo_msgs::GetModelProperties::Response &res)
 {
-#if GAZEBO_MAJOR_VERSION >= 8
-  gazebo::physics::ModelPtr model = world_->ModelByName(req.model_name);
-#else
-  gazebo::physics::ModelPtr model = world_->GetModel(req.model_name);
-#endif
+  gazebo::physics::ModelPtr model = entity_index_->model(req.model_name);
   if (!model)
   {
     ROS_ERROR_NAMED("api_plugin", "GetModelProperties: model [%s] does not exist",req.model_name.c_str());
@@ -1056,43 +1873,70 @@ bool GazeboRosApiPlugin::getModelProperties(gazebo_msgs::GetModelProperties::Req
   }
   else
   {
-    // get model parent name
-    gazebo::physics::ModelPtr parent_model = boost::dynamic_pointer_cast<gazebo::physics::Model>(model->GetParent());
-    if (parent_model) res.parent_model_name = parent_model->GetName();
+    bool cached = false;
+    uint64_t generation;
+    {
+      boost::mutex::scoped_lock lock(properties_cache_mutex_);
+      generation = properties_cache_generation_;
+      boost::unordered_map<std::string, CachedModelProperties>::const_iterator it =
+        model_properties_cache_.find(req.model_name);
+      if (it != model_properties_cache_.end() && it->second.model.lock() == model)
+      {
+        res = it->second.res;
+        cached = true;
+      }
+    }
 
-    // get list of child bodies, geoms
-    res.body_names.clear();
-    res.geom_names.clear();
-    for (unsigned int i = 0 ; i < model->GetChildCount(); i ++)
+    if (!cached)
     {
-      gazebo::physics::LinkPtr body = boost::dynamic_pointer_cast<gazebo::physics::Link>(model->GetChild(i));
-      if (body)
+      // get model parent name
+      gazebo::physics::ModelPtr parent_model = boost::dynamic_pointer_cast<gazebo::physics::Model>(model->GetParent());
+      if (parent_model) res.parent_model_name = parent_model->GetName();
+
+      // get list of child bodies, geoms
+      res.body_names.clear();
+      res.geom_names.clear();
+      for (unsigned int i = 0 ; i < model->GetChildCount(); i ++)
       {
-        res.body_names.push_back(body->GetName());
-        // get list of geoms
-        for (unsigned int j = 0; j < body->GetChildCount() ; j++)
+        gazebo::physics::LinkPtr body = boost::dynamic_pointer_cast<gazebo::physics::Link>(model->GetChild(i));
+        if (body)
         {
-          gazebo::physics::CollisionPtr geom = boost::dynamic_pointer_cast<gazebo::physics::Collision>(body->GetChild(j));
-          if (geom)
-            res.geom_names.push_back(geom->GetName());
+          res.body_names.push_back(body->GetName());
+          // get list of geoms
+          for (unsigned int j = 0; j < body->GetChildCount() ; j++)
+          {
+            gazebo::physics::CollisionPtr geom = boost::dynamic_pointer_cast<gazebo::physics::Collision>(body->GetChild(j));
+            if (geom)
+              res.geom_names.push_back(geom->GetName());
+          }
         }
       }
-    }
 
-    // get list of joints
-    res.joint_names.clear();
+      // get list of joints
+      res.joint_names.clear();
 
-    gazebo::physics::Joint_V joints = model->GetJoints();
-    for (unsigned int i=0;i< joints.size(); i++)
-      res.joint_names.push_back( joints[i]->GetName() );
+      gazebo::physics::Joint_V joints = model->GetJoints();
+      for (unsigned int i=0;i< joints.size(); i++)
+        res.joint_names.push_back( joints[i]->GetName() );
 
-    // get children model names
-    res.child_model_names.clear();
-    for (unsigned int j = 0; j < model->GetChildCount(); j++)
-    {
-      gazebo::physics::ModelPtr child_model = boost::dynamic_pointer_cast<gazebo::physics::Model>(model->GetChild(j));
-      if (child_model)
-        res.child_model_names.push_back(child_model->GetName() );
+      // get children model names
+      res.child_model_names.clear();
+      for (unsigned int j = 0; j < model->GetChildCount(); j++)
+      {
+        gazebo::physics::ModelPtr child_model = boost::dynamic_pointer_cast<gazebo::physics::Model>(model->GetChild(j));
+        if (child_model)
+          res.child_model_names.push_back(child_model->GetName() );
+      }
+
+      // the read queue is multi-threaded, an entity event while the lists
+      // were gathered means they may be stale already
+      boost::mutex::scoped_lock lock(properties_cache_mutex_);
+      if (generation == properties_cache_generation_)
+      {
+        CachedModelProperties &entry = model_properties_cache_[req.model_name];
+        entry.model = model;
+        entry.res = res;
+      }
     }
 
     // is model static
@@ -1125,21 +1969,93 @@ bool GazeboRosApiPlugin::getWorldProperties(gazebo_msgs::GetWorldProperties::Req
   return true;
 }
 
-bool GazeboRosApiPlugin::getJointProperties(gazebo_msgs::GetJointProperties::Request &req,
-                                            gazebo_msgs::GetJointProperties::Response &res)
+bool GazeboRosApiPlugin::getOccupancyGrid(gazebo_msgs::GetOccupancyGrid::Request &req,
+                                          gazebo_msgs::GetOccupancyGrid::Response &res)
 {
-  gazebo::physics::JointPtr joint;
-#if GAZEBO_MAJOR_VERSION >= 8
-  for (unsigned int i = 0; i < world_->ModelCount(); i ++)
+  const geometry_msgs::Point &min = req.min_corner;
+  const geometry_msgs::Point &max = req.max_corner;
+  if (!(req.resolution > 0) || !(max.x > min.x) || !(max.y > min.y) || !(max.z > min.z))
   {
-    joint = world_->ModelByIndex(i)->GetJoint(req.joint_name);
-#else
-  for (unsigned int i = 0; i < world_->GetModelCount(); i ++)
+    res.success = false;
+    res.status_message = "GetOccupancyGrid: resolution must be positive and max_corner above min_corner";
+    return true;
+  }
+
+  const double cells_x = std::ceil((max.x - min.x) / req.resolution);
+  const double cells_y = std::ceil((max.y - min.y) / req.resolution);
+  const double cells_z = std::ceil((max.z - min.z) / req.resolution);
+  // one byte per voxel
+  if (cells_x * cells_y * cells_z > 256.0 * 1024 * 1024)
+  {
+    res.success = false;
+    res.status_message = "GetOccupancyGrid: more than 2^28 voxels, use a coarser resolution or a smaller region";
+    return true;
+  }
+
+  std::vector<gazebo::physics::ModelPtr> models;
+  if (req.model_names.empty())
   {
-    joint = world_->GetModel(i)->GetJoint(req.joint_name);
+#if GAZEBO_MAJOR_VERSION >= 8
+    models = world_->Models();
+#else
+    models = world_->GetModels();
 #endif
-    if (joint) break;
   }
+  for (size_t i = 0; i < req.model_names.size(); ++i)
+  {
+    gazebo::physics::ModelPtr model = entity_index_->model(req.model_names[i]);
+    if (!model)
+    {
+      res.success = false;
+      res.status_message = "GetOccupancyGrid: model [" + req.model_names[i] + "] does not exist";
+      return true;
+    }
+    models.push_back(model);
+  }
+
+  OccupancyRasterizer::Grid grid;
+  grid.origin.Set(min.x, min.y, min.z);
+  grid.resolution = req.resolution;
+  grid.size_x = static_cast<uint32_t>(cells_x);
+  grid.size_y = static_cast<uint32_t>(cells_y);
+  grid.size_z = static_cast<uint32_t>(cells_z);
+
+  std::vector<uint8_t> voxels;
+  occupancy_rasterizer_.rasterize(models, grid, voxels);
+
+  nav_msgs::OccupancyGrid &map = res.grid;
+  map.header.stamp = ros::Time::now();
+  map.header.frame_id = req.frame_id;
+  map.info.map_load_time = map.header.stamp;
+  map.info.resolution = req.resolution;
+  map.info.width = grid.size_x;
+  map.info.height = grid.size_y;
+  map.info.origin.position = min;
+  map.info.origin.orientation.w = 1.0;
+
+  // a cell is occupied if any voxel above it is
+  const size_t cells = static_cast<size_t>(grid.size_x) * grid.size_y;
+  map.data.assign(cells, 0);
+  for (uint32_t z = 0; z < grid.size_z; ++z)
+    for (size_t c = 0; c < cells; ++c)
+      if (voxels[c + cells * z])
+        map.data[c] = 100;
+
+  res.layers = 0;
+  if (req.voxels)
+  {
+    res.layers = grid.size_z;
+    res.voxel_data.swap(voxels);
+  }
+  res.success = true;
+  res.status_message = "GetOccupancyGrid: rasterized " + boost::lexical_cast<std::string>(models.size()) + " models";
+  return true;
+}
+
+bool GazeboRosApiPlugin::getJointProperties(gazebo_msgs::GetJointProperties::Request &req,
+                                            gazebo_msgs::GetJointProperties::Response &res)
+{
+  gazebo::physics::JointPtr joint = entity_index_->joint(req.joint_name);
 
   if (!joint)
   {
@@ -1174,11 +2090,7 @@ bool GazeboRosApiPlugin::getJointProperties(gazebo_msgs::GetJointProperties::Req
 bool GazeboRosApiPlugin::getLinkProperties(gazebo_msgs::GetLinkProperties::Request &req,
                                            gazebo_msgs::GetLinkProperties::Response &res)
 {
-#if GAZEBO_MAJOR_VERSION >= 8
-  gazebo::physics::LinkPtr body = boost::dynamic_pointer_cast<gazebo::physics::Link>(world_->EntityByName(req.link_name));
-#else
-  gazebo::physics::LinkPtr body = boost::dynamic_pointer_cast<gazebo::physics::Link>(world_->GetEntity(req.link_name));
-#endif
+  gazebo::physics::LinkPtr body = entity_index_->link(req.link_name);
   if (!body)
   {
     res.success = false;
@@ -1232,13 +2144,8 @@ bool GazeboRosApiPlugin::getLinkProperties(gazebo_msgs::GetLinkProperties::Reque
 bool GazeboRosApiPlugin::getLinkState(gazebo_msgs::GetLinkState::Request &req,
                                       gazebo_msgs::GetLinkState::Response &res)
 {
-#if GAZEBO_MAJOR_VERSION >= 8
-  gazebo::physics::LinkPtr body = boost::dynamic_pointer_cast<gazebo::physics::Link>(world_->EntityByName(req.link_name));
-  gazebo::physics::EntityPtr frame = world_->EntityByName(req.reference_frame);
-#else
-  gazebo::physics::LinkPtr body = boost::dynamic_pointer_cast<gazebo::physics::Link>(world_->GetEntity(req.link_name));
-  gazebo::physics::EntityPtr frame = world_->GetEntity(req.reference_frame);
-#endif
+  gazebo::physics::LinkPtr body = entity_index_->link(req.link_name);
+  gazebo::physics::EntityPtr frame = entity_index_->entity(req.reference_frame);
 
   if (!body)
   {
@@ -1402,11 +2309,7 @@ bool GazeboRosApiPlugin::setLightProperties(gazebo_msgs::SetLightProperties::Req
 bool GazeboRosApiPlugin::setLinkProperties(gazebo_msgs::SetLinkProperties::Request &req,
                                            gazebo_msgs::SetLinkProperties::Response &res)
 {
-#if GAZEBO_MAJOR_VERSION >= 8
-  gazebo::physics::LinkPtr body = boost::dynamic_pointer_cast<gazebo::physics::Link>(world_->EntityByName(req.link_name));
-#else
-  gazebo::physics::LinkPtr body = boost::dynamic_pointer_cast<gazebo::physics::Link>(world_->GetEntity(req.link_name));
-#endif
+  gazebo::physics::LinkPtr body = entity_index_->link(req.link_name);
   if (!body)
   {
     res.success = false;
@@ -1432,37 +2335,17 @@ bool GazeboRosApiPlugin::setLinkProperties(gazebo_msgs::SetLinkProperties::Reque
 bool GazeboRosApiPlugin::setPhysicsProperties(gazebo_msgs::SetPhysicsProperties::Request &req,
                                               gazebo_msgs::SetPhysicsProperties::Response &res)
 {
-  // pause simulation if requested
-  bool is_paused = world_->IsPaused();
-  world_->SetPaused(true);
-  world_->SetGravity(ignition::math::Vector3d(req.gravity.x,req.gravity.y,req.gravity.z));
-
-  // supported updates
 #if GAZEBO_MAJOR_VERSION >= 8
   gazebo::physics::PhysicsEnginePtr pe = (world_->Physics());
 #else
   gazebo::physics::PhysicsEnginePtr pe = (world_->GetPhysicsEngine());
 #endif
-  pe->SetMaxStepSize(req.time_step);
-  pe->SetRealTimeUpdateRate(req.max_update_rate);
+
+  // applied between two steps by the world update, which never pauses it
+  waitForModelStates(queuePhysicsProperties(req));
 
   if (pe->GetType() == "ode")
   {
-    // stuff only works in ODE right now
-    pe->SetAutoDisableFlag(req.ode_config.auto_disable_bodies);
-    pe->SetParam("precon_iters", int(req.ode_config.sor_pgs_precon_iters));
-    pe->SetParam("iters", int(req.ode_config.sor_pgs_iters));
-    pe->SetParam("sor", req.ode_config.sor_pgs_w);
-    pe->SetParam("cfm", req.ode_config.cfm);
-    pe->SetParam("erp", req.ode_config.erp);
-    pe->SetParam("contact_surface_layer",
-        req.ode_config.contact_surface_layer);
-    pe->SetParam("contact_max_correcting_vel",
-        req.ode_config.contact_max_correcting_vel);
-    pe->SetParam("max_contacts", int(req.ode_config.max_contacts));
-
-    world_->SetPaused(is_paused);
-
     res.success = true;
     res.status_message = "physics engine updated";
   }
@@ -1476,6 +2359,44 @@ bool GazeboRosApiPlugin::setPhysicsProperties(gazebo_msgs::SetPhysicsProperties:
   return res.success;
 }
 
+unsigned int GazeboRosApiPlugin::queuePhysicsProperties(const gazebo_msgs::SetPhysicsProperties::Request &properties)
+{
+  boost::mutex::scoped_lock lock(model_state_mutex_);
+  physics_properties_command_ = properties;
+  physics_properties_pending_ = true;
+  return ++model_state_batches_queued_;
+}
+
+void GazeboRosApiPlugin::applyPhysicsProperties(const gazebo_msgs::SetPhysicsProperties::Request &properties)
+{
+  world_->SetGravity(ignition::math::Vector3d(properties.gravity.x,properties.gravity.y,properties.gravity.z));
+
+  // supported updates
+#if GAZEBO_MAJOR_VERSION >= 8
+  gazebo::physics::PhysicsEnginePtr pe = (world_->Physics());
+#else
+  gazebo::physics::PhysicsEnginePtr pe = (world_->GetPhysicsEngine());
+#endif
+  pe->SetMaxStepSize(properties.time_step);
+  pe->SetRealTimeUpdateRate(properties.max_update_rate);
+
+  if (pe->GetType() == "ode")
+  {
+    // stuff only works in ODE right now
+    pe->SetAutoDisableFlag(properties.ode_config.auto_disable_bodies);
+    pe->SetParam("precon_iters", int(properties.ode_config.sor_pgs_precon_iters));
+    pe->SetParam("iters", int(properties.ode_config.sor_pgs_iters));
+    pe->SetParam("sor", properties.ode_config.sor_pgs_w);
+    pe->SetParam("cfm", properties.ode_config.cfm);
+    pe->SetParam("erp", properties.ode_config.erp);
+    pe->SetParam("contact_surface_layer",
+        properties.ode_config.contact_surface_layer);
+    pe->SetParam("contact_max_correcting_vel",
+        properties.ode_config.contact_max_correcting_vel);
+    pe->SetParam("max_contacts", int(properties.ode_config.max_contacts));
+  }
+}
+
 bool GazeboRosApiPlugin::getPhysicsProperties(gazebo_msgs::GetPhysicsProperties::Request &req,
                                               gazebo_msgs::GetPhysicsProperties::Response &res)
 {
@@ -1532,18 +2453,7 @@ bool GazeboRosApiPlugin::setJointProperties(gazebo_msgs::SetJointProperties::Req
                                             gazebo_msgs::SetJointProperties::Response &res)
 {
   /// @todo: current settings only allows for setting of 1DOF joints (e.g. HingeJoint and SliderJoint) correctly.
-  gazebo::physics::JointPtr joint;
-#if GAZEBO_MAJOR_VERSION >= 8
-  for (unsigned int i = 0; i < world_->ModelCount(); i ++)
-  {
-    joint = world_->ModelByIndex(i)->GetJoint(req.joint_name);
-#else
-  for (unsigned int i = 0; i < world_->GetModelCount(); i ++)
-  {
-    joint = world_->GetModel(i)->GetJoint(req.joint_name);
-#endif
-    if (joint) break;
-  }
+  gazebo::physics::JointPtr joint = entity_index_->joint(req.joint_name);
 
   if (!joint)
   {
@@ -1580,188 +2490,507 @@ bool GazeboRosApiPlugin::setJointProperties(gazebo_msgs::SetJointProperties::Req
   }
 }
 
-bool GazeboRosApiPlugin::setModelState(gazebo_msgs::SetModelState::Request &req,
-                                       gazebo_msgs::SetModelState::Response &res)
+bool GazeboRosApiPlugin::resolveModelState(const gazebo_msgs::ModelState &model_state,
+                                           ModelStateCommand &command, std::string &status_message)
 {
-  ignition::math::Vector3d target_pos(req.model_state.pose.position.x,req.model_state.pose.position.y,req.model_state.pose.position.z);
-  ignition::math::Quaterniond target_rot(req.model_state.pose.orientation.w,req.model_state.pose.orientation.x,req.model_state.pose.orientation.y,req.model_state.pose.orientation.z);
+  ignition::math::Vector3d target_pos(model_state.pose.position.x,model_state.pose.position.y,model_state.pose.position.z);
+  ignition::math::Quaterniond target_rot(model_state.pose.orientation.w,model_state.pose.orientation.x,model_state.pose.orientation.y,model_state.pose.orientation.z);
   target_rot.Normalize(); // eliminates invalid rotation (0, 0, 0, 0)
   ignition::math::Pose3d target_pose(target_pos,target_rot);
-  ignition::math::Vector3d target_pos_dot(req.model_state.twist.linear.x,req.model_state.twist.linear.y,req.model_state.twist.linear.z);
-  ignition::math::Vector3d target_rot_dot(req.model_state.twist.angular.x,req.model_state.twist.angular.y,req.model_state.twist.angular.z);
+  ignition::math::Vector3d target_pos_dot(model_state.twist.linear.x,model_state.twist.linear.y,model_state.twist.linear.z);
+  ignition::math::Vector3d target_rot_dot(model_state.twist.angular.x,model_state.twist.angular.y,model_state.twist.angular.z);
 
-#if GAZEBO_MAJOR_VERSION >= 8
-  gazebo::physics::ModelPtr model = world_->ModelByName(req.model_state.model_name);
-#else
-  gazebo::physics::ModelPtr model = world_->GetModel(req.model_state.model_name);
-#endif
+  gazebo::physics::ModelPtr model = entity_index_->model(model_state.model_name);
   if (!model)
   {
-    ROS_ERROR_NAMED("api_plugin", "Updating ModelState: model [%s] does not exist",req.model_state.model_name.c_str());
-    res.success = false;
-    res.status_message = "SetModelState: model does not exist";
-    return true;
+    ROS_ERROR_NAMED("api_plugin", "Updating ModelState: model [%s] does not exist",model_state.model_name.c_str());
+    status_message = "SetModelState: model does not exist";
+    return false;
   }
-  else
-  {
-#if GAZEBO_MAJOR_VERSION >= 8
-    gazebo::physics::EntityPtr relative_entity = world_->EntityByName(req.model_state.reference_frame);
-#else
-    gazebo::physics::EntityPtr relative_entity = world_->GetEntity(req.model_state.reference_frame);
-#endif
-    if (relative_entity)
-    {
-#if GAZEBO_MAJOR_VERSION >= 8
-      ignition::math::Pose3d  frame_pose = relative_entity->WorldPose(); // - myBody->GetCoMPose();
-#else
-      ignition::math::Pose3d  frame_pose = relative_entity->GetWorldPose().Ign(); // - myBody->GetCoMPose();
-#endif
-
-      target_pose = target_pose + frame_pose;
 
-      // Velocities should be commanded in the requested reference
-      // frame, so we need to translate them to the world frame
-      target_pos_dot = frame_pose.Rot().RotateVector(target_pos_dot);
-      target_rot_dot = frame_pose.Rot().RotateVector(target_rot_dot);
-    }
-    /// @todo: FIXME map is really wrong, need to use tf here somehow
-    else if (req.model_state.reference_frame == "" || req.model_state.reference_frame == "world" || req.model_state.reference_frame == "map" || req.model_state.reference_frame == "/map" )
-    {
-      ROS_DEBUG_NAMED("api_plugin", "Updating ModelState: reference frame is empty/world/map, usig inertial frame");
-    }
-    else
-    {
-      ROS_ERROR_NAMED("api_plugin", "Updating ModelState: for model[%s], specified reference frame entity [%s] does not exist",
-                req.model_state.model_name.c_str(),req.model_state.reference_frame.c_str());
-      res.success = false;
-      res.status_message = "SetModelState: specified reference frame entity does not exist";
-      return true;
-    }
-
-    //ROS_ERROR_NAMED("api_plugin", "target state: %f %f %f",target_pose.Pos().X(),target_pose.Pos().Y(),target_pose.Pos().Z());
-    bool is_paused = world_->IsPaused();
-    world_->SetPaused(true);
-    model->SetWorldPose(target_pose);
-    world_->SetPaused(is_paused);
+  gazebo::physics::EntityPtr relative_entity = entity_index_->entity(model_state.reference_frame);
+  if (relative_entity)
+  {
 #if GAZEBO_MAJOR_VERSION >= 8
-    //ignition::math::Pose3d p3d = model->WorldPose();
+    ignition::math::Pose3d  frame_pose = relative_entity->WorldPose(); // - myBody->GetCoMPose();
 #else
-    //ignition::math::Pose3d p3d = model->GetWorldPose().Ign();
+    ignition::math::Pose3d  frame_pose = relative_entity->GetWorldPose().Ign(); // - myBody->GetCoMPose();
 #endif
-    //ROS_ERROR_NAMED("api_plugin", "model updated state: %f %f %f",p3d.Pos().X(),p3d.Pos().Y(),p3d.Pos().Z());
 
-    // set model velocity
-    model->SetLinearVel(target_pos_dot);
-    model->SetAngularVel(target_rot_dot);
+    target_pose = target_pose + frame_pose;
 
-    res.success = true;
-    res.status_message = "SetModelState: set model state done";
-    return true;
+    // Velocities should be commanded in the requested reference
+    // frame, so we need to translate them to the world frame
+    target_pos_dot = frame_pose.Rot().RotateVector(target_pos_dot);
+    target_rot_dot = frame_pose.Rot().RotateVector(target_rot_dot);
   }
+  /// @todo: FIXME map is really wrong, need to use tf here somehow
+  else if (model_state.reference_frame == "" || model_state.reference_frame == "world" || model_state.reference_frame == "map" || model_state.reference_frame == "/map" )
+  {
+    ROS_DEBUG_NAMED("api_plugin", "Updating ModelState: reference frame is empty/world/map, usig inertial frame");
+  }
+  else
+  {
+    ROS_ERROR_NAMED("api_plugin", "Updating ModelState: for model[%s], specified reference frame entity [%s] does not exist",
+              model_state.model_name.c_str(),model_state.reference_frame.c_str());
+    status_message = "SetModelState: specified reference frame entity does not exist";
+    return false;
+  }
+
+  command.model = model;
+  command.pose = target_pose;
+  command.linear_vel = target_pos_dot;
+  command.angular_vel = target_rot_dot;
+  return true;
 }
 
-void GazeboRosApiPlugin::updateModelState(const gazebo_msgs::ModelState::ConstPtr& model_state)
+void GazeboRosApiPlugin::applyModelState(const ModelStateCommand &command)
 {
-  gazebo_msgs::SetModelState::Response res;
-  gazebo_msgs::SetModelState::Request req;
-  req.model_state = *model_state;
-  /*bool success =*/ setModelState(req,res);
+  command.model->SetWorldPose(command.pose);
+
+  // set model velocity
+  command.model->SetLinearVel(command.linear_vel);
+  command.model->SetAngularVel(command.angular_vel);
 }
 
-bool GazeboRosApiPlugin::applyJointEffort(gazebo_msgs::ApplyJointEffort::Request &req,
-                                          gazebo_msgs::ApplyJointEffort::Response &res)
+bool GazeboRosApiPlugin::setModelState(gazebo_msgs::SetModelState::Request &req,
+                                       gazebo_msgs::SetModelState::Response &res)
 {
-  gazebo::physics::JointPtr joint;
-#if GAZEBO_MAJOR_VERSION >= 8
-  for (unsigned int i = 0; i < world_->ModelCount(); i ++)
-  {
-    joint = world_->ModelByIndex(i)->GetJoint(req.joint_name);
-#else
-  for (unsigned int i = 0; i < world_->GetModelCount(); i ++)
+  ModelStateCommand command;
+  if (!resolveModelState(req.model_state, command, res.status_message))
   {
-    joint = world_->GetModel(i)->GetJoint(req.joint_name);
-#endif
-    if (joint)
-    {
-      GazeboRosApiPlugin::ForceJointJob* fjj = new GazeboRosApiPlugin::ForceJointJob;
-      fjj->joint = joint;
-      fjj->force = req.effort;
-      fjj->start_time = req.start_time;
-#if GAZEBO_MAJOR_VERSION >= 8
-      if (fjj->start_time < ros::Time(world_->SimTime().Double()))
-        fjj->start_time = ros::Time(world_->SimTime().Double());
-#else
-      if (fjj->start_time < ros::Time(world_->GetSimTime().Double()))
-        fjj->start_time = ros::Time(world_->GetSimTime().Double());
-#endif
-      fjj->duration = req.duration;
-      lock_.lock();
-      force_joint_jobs_.push_back(fjj);
-      lock_.unlock();
-
-      res.success = true;
-      res.status_message = "ApplyJointEffort: effort set";
-      return true;
-    }
+    res.success = false;
+    return true;
   }
 
-  res.success = false;
-  res.status_message = "ApplyJointEffort: joint not found";
-  return true;
-}
+  //ROS_ERROR_NAMED("api_plugin", "target state: %f %f %f",target_pose.Pos().X(),target_pose.Pos().Y(),target_pose.Pos().Z());
+  bool is_paused = world_->IsPaused();
+  world_->SetPaused(true);
+  command.model->SetWorldPose(command.pose);
+  world_->SetPaused(is_paused);
 
-bool GazeboRosApiPlugin::resetSimulation(std_srvs::Empty::Request &req,std_srvs::Empty::Response &res)
-{
-  world_->Reset();
+  // set model velocity
+  command.model->SetLinearVel(command.linear_vel);
+  command.model->SetAngularVel(command.angular_vel);
+
+  res.success = true;
+  res.status_message = "SetModelState: set model state done";
   return true;
 }
 
-bool GazeboRosApiPlugin::resetWorld(std_srvs::Empty::Request &req,std_srvs::Empty::Response &res)
+unsigned int GazeboRosApiPlugin::queueModelStates(const std::vector<ModelStateCommand> &commands)
 {
-  world_->ResetEntities(gazebo::physics::Base::MODEL);
-  return true;
+  boost::mutex::scoped_lock lock(model_state_mutex_);
+  model_state_commands_.insert(model_state_commands_.end(), commands.begin(), commands.end());
+  return ++model_state_batches_queued_;
 }
 
-bool GazeboRosApiPlugin::pausePhysics(std_srvs::Empty::Request &req,std_srvs::Empty::Response &res)
+unsigned int GazeboRosApiPlugin::queueLinkStates(const std::vector<LinkStateCommand> &commands)
 {
-  world_->SetPaused(true);
-  return true;
+  boost::mutex::scoped_lock lock(model_state_mutex_);
+  link_state_commands_.insert(link_state_commands_.end(), commands.begin(), commands.end());
+  return ++model_state_batches_queued_;
 }
 
-bool GazeboRosApiPlugin::unpausePhysics(std_srvs::Empty::Request &req,std_srvs::Empty::Response &res)
+unsigned int GazeboRosApiPlugin::queueModelConfigurations(const std::vector<ModelConfigurationCommand> &commands)
 {
-  world_->SetPaused(false);
-  return true;
+  boost::mutex::scoped_lock lock(model_state_mutex_);
+  model_configuration_commands_.insert(model_configuration_commands_.end(), commands.begin(), commands.end());
+  return ++model_state_batches_queued_;
 }
 
-bool GazeboRosApiPlugin::clearJointForces(gazebo_msgs::JointRequest::Request &req,
-                                          gazebo_msgs::JointRequest::Response &res)
+unsigned int GazeboRosApiPlugin::queueWorldState(const std::vector<LinkStateCommand> &link_commands,
+                                                 const std::vector<ModelConfigurationCommand> &configuration_commands)
 {
-  return clearJointForces(req.joint_name);
+  boost::mutex::scoped_lock lock(model_state_mutex_);
+  link_state_commands_.insert(link_state_commands_.end(), link_commands.begin(), link_commands.end());
+  model_configuration_commands_.insert(model_configuration_commands_.end(),
+                                       configuration_commands.begin(), configuration_commands.end());
+  return ++model_state_batches_queued_;
 }
-bool GazeboRosApiPlugin::clearJointForces(std::string joint_name)
+
+void GazeboRosApiPlugin::applyQueuedModelStates()
 {
-  bool search = true;
-  lock_.lock();
-  while(search)
+  GAZEBO_ROS_PROFILE("GazeboRosApiPlugin::applyQueuedModelStates");
+  std::vector<ModelStateCommand> commands;
+  std::vector<LinkStateCommand> link_commands;
+  std::vector<ModelConfigurationCommand> configuration_commands;
+  gazebo_msgs::SetPhysicsProperties::Request physics_properties;
+  bool physics_properties_pending;
+  unsigned int batch;
   {
-    search = false;
-    for (std::vector<GazeboRosApiPlugin::ForceJointJob*>::iterator iter=force_joint_jobs_.begin();iter!=force_joint_jobs_.end();++iter)
-    {
-      if ((*iter)->joint->GetName() == joint_name)
-      {
-        // found one, search through again
-        search = true;
-        delete (*iter);
-        force_joint_jobs_.erase(iter);
-        break;
-      }
-    }
+    boost::mutex::scoped_lock lock(model_state_mutex_);
+    if (model_state_batches_applied_ == model_state_batches_queued_)
+      return;
+    commands.swap(model_state_commands_);
+    link_commands.swap(link_state_commands_);
+    configuration_commands.swap(model_configuration_commands_);
+    physics_properties_pending = physics_properties_pending_;
+    if (physics_properties_pending)
+      physics_properties = physics_properties_command_;
+    physics_properties_pending_ = false;
+    batch = model_state_batches_queued_;
   }
+
+  // before the states, so that the step they are stepped with is the new one
+  if (physics_properties_pending)
+    applyPhysicsProperties(physics_properties);
+
+  for (size_t i = 0; i < commands.size(); ++i)
+    applyModelState(commands[i]);
+  // joint positions move the child links relative to the model pose just set
+  for (size_t i = 0; i < configuration_commands.size(); ++i)
+    configuration_commands[i].model->SetJointPositions(configuration_commands[i].positions);
+  for (size_t i = 0; i < link_commands.size(); ++i)
+  {
+    link_commands[i].link->SetWorldPose(link_commands[i].pose);
+    link_commands[i].link->SetLinearVel(link_commands[i].linear_vel);
+    link_commands[i].link->SetAngularVel(link_commands[i].angular_vel);
+  }
+
+  {
+    boost::mutex::scoped_lock lock(model_state_mutex_);
+    model_state_batches_applied_ = std::max(model_state_batches_applied_, batch);
+  }
+  model_state_cond_.notify_all();
+}
+
+void GazeboRosApiPlugin::waitForModelStates(unsigned int batch)
+{
+  boost::mutex::scoped_lock lock(model_state_mutex_);
+  while (model_state_batches_applied_ < batch && ros::ok())
+  {
+    // a paused world has no updates, its states are set right here
+    if (world_->IsPaused())
+    {
+      lock.unlock();
+      applyQueuedModelStates();
+      lock.lock();
+      continue;
+    }
+    model_state_cond_.timed_wait(lock, boost::posix_time::milliseconds(100));
+  }
+}
+
+bool GazeboRosApiPlugin::setModelStates(gazebo_msgs::SetModelStates::Request &req,
+                                        gazebo_msgs::SetModelStates::Response &res)
+{
+  const size_t n = req.model_states.size();
+  res.model_success.assign(n, false);
+  res.model_status_message.assign(n, "");
+
+  std::vector<ModelStateCommand> commands;
+  commands.reserve(n);
+  for (size_t i = 0; i < n; ++i)
+  {
+    ModelStateCommand command;
+    if (!resolveModelState(req.model_states[i], command, res.model_status_message[i]))
+      continue;
+    commands.push_back(command);
+    res.model_success[i] = true;
+    res.model_status_message[i] = "SetModelState: set model state done";
+  }
+
+  // all of them in the same world update
+  if (!commands.empty())
+    waitForModelStates(queueModelStates(commands));
+
+  res.success = commands.size() == n;
+  std::ostringstream status;
+  status << "SetModelStates: set " << commands.size() << " of " << n << " model states";
+  res.status_message = status.str();
+  return true;
+}
+
+void GazeboRosApiPlugin::updateModelStates(const gazebo_msgs::ModelStates::ConstPtr& model_states)
+{
+  const size_t n = std::min(model_states->name.size(),
+                            std::min(model_states->pose.size(), model_states->twist.size()));
+  std::vector<ModelStateCommand> commands;
+  commands.reserve(n);
+  for (size_t i = 0; i < n; ++i)
+  {
+    gazebo_msgs::ModelState model_state;
+    model_state.model_name = model_states->name[i];
+    model_state.pose = model_states->pose[i];
+    model_state.twist = model_states->twist[i];
+
+    ModelStateCommand command;
+    std::string status_message;
+    if (resolveModelState(model_state, command, status_message))
+      commands.push_back(command);
+  }
+
+  // applied with the next world update, or now if paused
+  if (!commands.empty())
+  {
+    queueModelStates(commands);
+    if (world_->IsPaused())
+      applyQueuedModelStates();
+  }
+}
+
+bool GazeboRosApiPlugin::registerRelativeStates(gazebo_msgs::RegisterRelativeStates::Request &req,
+                                                gazebo_msgs::RegisterRelativeStates::Response &res)
+{
+  const size_t n = req.entity_names.size();
+  res.entity_success.assign(n, false);
+  res.entity_status_message.assign(n, "");
+  if (req.reference_frames.size() != n)
+  {
+    res.success = false;
+    res.status_message = "RegisterRelativeStates: entity name and reference frame list have different lengths";
+    return true;
+  }
+
+  std::vector<RelativeStatesPublisher::Pair> pairs;
+  pairs.reserve(n);
+  for (size_t i = 0; i < n; ++i)
+  {
+    RelativeStatesPublisher::Pair pair;
+    pair.entity_name = req.entity_names[i];
+    pair.entity = entity_index_->entity(pair.entity_name);
+    if (!pair.entity)
+    {
+      res.entity_status_message[i] = "RegisterRelativeStates: entity does not exist";
+      continue;
+    }
+    const std::string &frame = req.reference_frames[i];
+    /// @todo: FIXME map is really wrong, need to use tf here somehow
+    if (!(frame == "" || frame == "world" || frame == "map" || frame == "/map"))
+    {
+      pair.frame = entity_index_->entity(frame);
+      if (!pair.frame)
+      {
+        res.entity_status_message[i] = "RegisterRelativeStates: reference frame not found, did you forget to scope the body by model name?";
+        continue;
+      }
+      pair.reference_frame = frame;
+    }
+    pairs.push_back(pair);
+    res.entity_success[i] = true;
+    res.entity_status_message[i] = "RegisterRelativeStates: registered";
+  }
+
+  relative_states_publisher_->setPairs(pairs, req.append);
+
+  res.success = pairs.size() == n;
+  std::ostringstream status;
+  status << "RegisterRelativeStates: registered " << pairs.size() << " of " << n
+         << " pairs, " << relative_states_publisher_->size() << " in all";
+  res.status_message = status.str();
+  return true;
+}
+
+bool GazeboRosApiPlugin::getModelStates(gazebo_msgs::GetModelStates::Request &req,
+                                        gazebo_msgs::GetModelStates::Response &res)
+{
+  const size_t n = req.model_name.size();
+  res.pose.resize(n);
+  res.twist.resize(n);
+  res.model_success.assign(n, false);
+  res.header.frame_id = req.relative_entity_name;
+
+  gazebo::physics::EntityPtr frame = entity_index_->entity(req.relative_entity_name);
+  /// @todo: FIXME map is really wrong, need to use tf here somehow
+  if (!frame && !(req.relative_entity_name == "" || req.relative_entity_name == "world" ||
+                  req.relative_entity_name == "map" || req.relative_entity_name == "/map"))
+  {
+    res.success = false;
+    res.status_message = "GetModelStates: reference relative_entity_name not found, did you forget to scope the body by model name?";
+    return true;
+  }
+
+  std::vector<gazebo::physics::ModelPtr> models(n);
+  for (size_t i = 0; i < n; ++i)
+    models[i] = entity_index_->model(req.model_name[i]);
+
+  // read all states between two physics updates
+#if GAZEBO_MAJOR_VERSION >= 8
+  gazebo::physics::PhysicsEnginePtr pe = world_->Physics();
+#else
+  gazebo::physics::PhysicsEnginePtr pe = world_->GetPhysicsEngine();
+#endif
+  size_t found = 0;
+  {
+    boost::recursive_mutex::scoped_lock lock(*pe->GetPhysicsUpdateMutex());
+#if GAZEBO_MAJOR_VERSION >= 8
+    gazebo::common::Time sim_time = world_->SimTime();
+#else
+    gazebo::common::Time sim_time = world_->GetSimTime();
+#endif
+    res.header.stamp.sec = sim_time.sec;
+    res.header.stamp.nsec = sim_time.nsec;
+
+    ignition::math::Pose3d frame_pose;
+    ignition::math::Vector3d frame_vpos;
+    ignition::math::Vector3d frame_veul;
+    if (frame)
+    {
+#if GAZEBO_MAJOR_VERSION >= 8
+      frame_pose = frame->WorldPose();
+      frame_vpos = frame->WorldLinearVel(); // get velocity in gazebo frame
+      frame_veul = frame->WorldAngularVel(); // get velocity in gazebo frame
+#else
+      frame_pose = frame->GetWorldPose().Ign();
+      frame_vpos = frame->GetWorldLinearVel().Ign(); // get velocity in gazebo frame
+      frame_veul = frame->GetWorldAngularVel().Ign(); // get velocity in gazebo frame
+#endif
+    }
+
+    for (size_t i = 0; i < n; ++i)
+    {
+      if (!models[i])
+        continue;
+#if GAZEBO_MAJOR_VERSION >= 8
+      ignition::math::Pose3d      model_pose = models[i]->WorldPose();
+      ignition::math::Vector3d model_linear_vel  = models[i]->WorldLinearVel();
+      ignition::math::Vector3d model_angular_vel = models[i]->WorldAngularVel();
+#else
+      ignition::math::Pose3d      model_pose = models[i]->GetWorldPose().Ign();
+      ignition::math::Vector3d model_linear_vel  = models[i]->GetWorldLinearVel().Ign();
+      ignition::math::Vector3d model_angular_vel = models[i]->GetWorldAngularVel().Ign();
+#endif
+      if (frame)
+      {
+        // convert to relative pose, rates
+        model_pose = model_pose - frame_pose;
+        model_linear_vel = frame_pose.Rot().RotateVectorReverse(model_linear_vel - frame_vpos);
+        model_angular_vel = frame_pose.Rot().RotateVectorReverse(model_angular_vel - frame_veul);
+      }
+
+      geometry_msgs::Pose &pose = res.pose[i];
+      pose.position.x = model_pose.Pos().X();
+      pose.position.y = model_pose.Pos().Y();
+      pose.position.z = model_pose.Pos().Z();
+      pose.orientation.w = model_pose.Rot().W();
+      pose.orientation.x = model_pose.Rot().X();
+      pose.orientation.y = model_pose.Rot().Y();
+      pose.orientation.z = model_pose.Rot().Z();
+
+      geometry_msgs::Twist &twist = res.twist[i];
+      twist.linear.x = model_linear_vel.X();
+      twist.linear.y = model_linear_vel.Y();
+      twist.linear.z = model_linear_vel.Z();
+      twist.angular.x = model_angular_vel.X();
+      twist.angular.y = model_angular_vel.Y();
+      twist.angular.z = model_angular_vel.Z();
+
+      res.model_success[i] = true;
+      ++found;
+    }
+  }
+
+  res.success = found == n;
+  std::ostringstream status;
+  status << "GetModelStates: got " << found << " of " << n << " model states";
+  res.status_message = status.str();
+  return true;
+}
+
+void GazeboRosApiPlugin::updateModelState(const gazebo_msgs::ModelState::ConstPtr& model_state)
+{
+  // only the latest state of each model is applied, at the next world update
+  {
+    boost::mutex::scoped_lock lock(state_topic_mutex_);
+    model_state_topic_queue_.push(model_state->model_name, *model_state);
+  }
+  // a paused world has no updates to apply it with
+  if (world_->IsPaused())
+    applyStateTopics();
+}
+
+bool GazeboRosApiPlugin::applyJointEffort(gazebo_msgs::ApplyJointEffort::Request &req,
+                                          gazebo_msgs::ApplyJointEffort::Response &res)
+{
+  gazebo::physics::JointPtr joint = entity_index_->joint(req.joint_name);
+  if (joint)
+  {
+    GazeboRosApiPlugin::ForceJointJob fjj;
+    fjj.joint = joint;
+    fjj.force = req.effort;
+    fjj.start_time = req.start_time;
+#if GAZEBO_MAJOR_VERSION >= 8
+    if (fjj.start_time < ros::Time(world_->SimTime().Double()))
+      fjj.start_time = ros::Time(world_->SimTime().Double());
+#else
+    if (fjj.start_time < ros::Time(world_->GetSimTime().Double()))
+      fjj.start_time = ros::Time(world_->GetSimTime().Double());
+#endif
+    fjj.duration = req.duration;
+    lock_.lock();
+    force_joint_jobs_.add(fjj);
+    model_jobs_.insert(jobModel(joint->GetScopedName()));
+    lock_.unlock();
+
+    res.success = true;
+    res.status_message = "ApplyJointEffort: effort set";
+    return true;
+  }
+
+  res.success = false;
+  res.status_message = "ApplyJointEffort: joint not found";
+  return true;
+}
+
+bool GazeboRosApiPlugin::resetSimulation(std_srvs::Empty::Request &req,std_srvs::Empty::Response &res)
+{
+  world_->Reset();
+  return true;
+}
+
+bool GazeboRosApiPlugin::resetWorld(std_srvs::Empty::Request &req,std_srvs::Empty::Response &res)
+{
+  world_->ResetEntities(gazebo::physics::Base::MODEL);
+  return true;
+}
+
+bool GazeboRosApiPlugin::setProfiling(std_srvs::SetBool::Request &req,std_srvs::SetBool::Response &res)
+{
+  Profiler::instance().setEnabled(req.data);
+  res.success = true;
+  res.message = req.data ? "profiling enabled" : "profiling disabled";
+  return true;
+}
+
+bool GazeboRosApiPlugin::setLatencyTracing(std_srvs::SetBool::Request &req,std_srvs::SetBool::Response &res)
+{
+  LatencyTracer::instance().setEnabled(req.data);
+  res.success = true;
+  res.message = req.data ? "latency tracing enabled" : "latency tracing disabled";
+  return true;
+}
+
+bool GazeboRosApiPlugin::pausePhysics(std_srvs::Empty::Request &req,std_srvs::Empty::Response &res)
+{
+  world_->SetPaused(true);
+  return true;
+}
+
+bool GazeboRosApiPlugin::unpausePhysics(std_srvs::Empty::Request &req,std_srvs::Empty::Response &res)
+{
+  world_->SetPaused(false);
+  return true;
+}
+
+bool GazeboRosApiPlugin::clearJointForces(gazebo_msgs::JointRequest::Request &req,
+                                          gazebo_msgs::JointRequest::Response &res)
+{
+  return clearJointForces(req.joint_name);
+}
+bool GazeboRosApiPlugin::clearJointForces(std::string joint_name)
+{
+  lock_.lock();
+  force_joint_jobs_.remove(boost::bind(&GazeboRosApiPlugin::isJointJob, _1, boost::cref(joint_name)));
   lock_.unlock();
   return true;
 }
 
+bool GazeboRosApiPlugin::isJointJob(const ForceJointJob &job, const std::string &joint_name)
+{
+  return job.joint->GetName() == joint_name;
+}
+
 bool GazeboRosApiPlugin::clearBodyWrenches(gazebo_msgs::BodyRequest::Request &req,
                                            gazebo_msgs::BodyRequest::Response &res)
 {
@@ -1769,26 +2998,43 @@ bool GazeboRosApiPlugin::clearBodyWrenches(gazebo_msgs::BodyRequest::Request &re
 }
 bool GazeboRosApiPlugin::clearBodyWrenches(std::string body_name)
 {
-  bool search = true;
   lock_.lock();
-  while(search)
+  wrench_body_jobs_.remove(boost::bind(&GazeboRosApiPlugin::isBodyJob, _1, boost::cref(body_name)));
+  lock_.unlock();
+  return true;
+}
+
+bool GazeboRosApiPlugin::isBodyJob(const WrenchBodyJob &job, const std::string &body_name)
+{
+  return job.body->GetScopedName() == body_name;
+}
+
+void GazeboRosApiPlugin::clearModelJobs(const std::string &model_name)
+{
+  // one pass over each job list, and none for a model that never had a job
+  const std::string prefix = model_name + "::";
+  lock_.lock();
+  if (model_jobs_.erase(model_name))
   {
-    search = false;
-    for (std::vector<GazeboRosApiPlugin::WrenchBodyJob*>::iterator iter=wrench_body_jobs_.begin();iter!=wrench_body_jobs_.end();++iter)
-    {
-      //ROS_ERROR_NAMED("api_plugin", "search %s %s",(*iter)->body->GetScopedName().c_str(), body_name.c_str());
-      if ((*iter)->body->GetScopedName() == body_name)
-      {
-        // found one, search through again
-        search = true;
-        delete (*iter);
-        wrench_body_jobs_.erase(iter);
-        break;
-      }
-    }
+    wrench_body_jobs_.remove(boost::bind(&GazeboRosApiPlugin::isModelBodyJob, _1, boost::cref(prefix)));
+    force_joint_jobs_.remove(boost::bind(&GazeboRosApiPlugin::isModelJointJob, _1, boost::cref(prefix)));
   }
   lock_.unlock();
-  return true;
+}
+
+bool GazeboRosApiPlugin::isModelBodyJob(const WrenchBodyJob &job, const std::string &model_prefix)
+{
+  return job.body->GetScopedName().compare(0, model_prefix.size(), model_prefix) == 0;
+}
+
+bool GazeboRosApiPlugin::isModelJointJob(const ForceJointJob &job, const std::string &model_prefix)
+{
+  return job.joint->GetScopedName().compare(0, model_prefix.size(), model_prefix) == 0;
+}
+
+std::string GazeboRosApiPlugin::jobModel(const std::string &scoped_name)
+{
+  return scoped_name.substr(0, scoped_name.find("::"));
 }
 
 bool GazeboRosApiPlugin::setModelConfiguration(gazebo_msgs::SetModelConfiguration::Request &req,
@@ -1797,11 +3043,7 @@ bool GazeboRosApiPlugin::setModelConfiguration(gazebo_msgs::SetModelConfiguratio
   std::string gazebo_model_name = req.model_name;
 
   // search for model with name
-#if GAZEBO_MAJOR_VERSION >= 8
-  gazebo::physics::ModelPtr gazebo_model = world_->ModelByName(req.model_name);
-#else
-  gazebo::physics::ModelPtr gazebo_model = world_->GetModel(req.model_name);
-#endif
+  gazebo::physics::ModelPtr gazebo_model = entity_index_->model(req.model_name);
   if (!gazebo_model)
   {
     ROS_ERROR_NAMED("api_plugin", "SetModelConfiguration: model [%s] does not exist",gazebo_model_name.c_str());
@@ -1839,32 +3081,96 @@ bool GazeboRosApiPlugin::setModelConfiguration(gazebo_msgs::SetModelConfiguratio
   }
 }
 
-bool GazeboRosApiPlugin::setLinkState(gazebo_msgs::SetLinkState::Request &req,
-                                      gazebo_msgs::SetLinkState::Response &res)
+bool GazeboRosApiPlugin::resolveModelConfiguration(const gazebo_msgs::ModelConfiguration &configuration,
+                                                   ModelConfigurationCommand &command, std::string &status_message)
+{
+  command.model = entity_index_->model(configuration.model_name);
+  if (!command.model)
+  {
+    ROS_ERROR_NAMED("api_plugin", "SetModelConfigurations: model [%s] does not exist",configuration.model_name.c_str());
+    status_message = "SetModelConfigurations: model does not exist";
+    return false;
+  }
+  if (configuration.joint_names.size() != configuration.joint_positions.size())
+  {
+    status_message = "SetModelConfigurations: joint name and position list have different lengths";
+    return false;
+  }
+
+  command.positions.clear();
+  const std::string scope = command.model->GetScopedName() + "::";
+  for (size_t i = 0; i < configuration.joint_names.size(); ++i)
+  {
+    // scoped, a joint of the same name in another model is not ours
+    gazebo::physics::JointPtr joint = entity_index_->joint(scope + configuration.joint_names[i]);
+    if (!joint)
+      joint = command.model->GetJoint(configuration.joint_names[i]);
+    if (!joint || joint->GetScopedName().compare(0, scope.size(), scope) != 0)
+    {
+      ROS_ERROR_NAMED("api_plugin", "SetModelConfigurations: joint [%s] of model [%s] does not exist",
+                      configuration.joint_names[i].c_str(), configuration.model_name.c_str());
+      status_message = "SetModelConfigurations: joint " + configuration.joint_names[i] + " does not exist";
+      return false;
+    }
+    command.positions[joint->GetScopedName()] = configuration.joint_positions[i];
+  }
+  return true;
+}
+
+bool GazeboRosApiPlugin::setModelConfigurations(gazebo_msgs::SetModelConfigurations::Request &req,
+                                                gazebo_msgs::SetModelConfigurations::Response &res)
 {
+  const size_t n = req.model_configurations.size();
+  res.model_success.assign(n, false);
+  res.model_status_message.assign(n, "");
+
+  std::vector<ModelConfigurationCommand> commands;
+  commands.reserve(n);
+  for (size_t i = 0; i < n; ++i)
+  {
+    ModelConfigurationCommand command;
+    if (!resolveModelConfiguration(req.model_configurations[i], command, res.model_status_message[i]))
+      continue;
+    commands.push_back(command);
+    res.model_success[i] = true;
+    res.model_status_message[i] = "SetModelConfigurations: success";
+  }
+
+  // all of them in the same world update, no pause cycle per model
+  if (!commands.empty())
+    waitForModelStates(queueModelConfigurations(commands));
+
+  res.success = commands.size() == n;
+  std::ostringstream status;
+  status << "SetModelConfigurations: set " << commands.size() << " of " << n << " model configurations";
+  res.status_message = status.str();
+  return true;
+}
+
+bool GazeboRosApiPlugin::resolveLinkState(const gazebo_msgs::LinkState &link_state,
+                                          LinkStateCommand &command, std::string &status_message)
+{
+  gazebo::physics::LinkPtr body = entity_index_->link(link_state.link_name);
 #if GAZEBO_MAJOR_VERSION >= 8
-  gazebo::physics::LinkPtr body = boost::dynamic_pointer_cast<gazebo::physics::Link>(world_->EntityByName(req.link_state.link_name));
-  gazebo::physics::LinkPtr frame = boost::dynamic_pointer_cast<gazebo::physics::Link>(world_->EntityByName(req.link_state.reference_frame));
+  gazebo::physics::LinkPtr frame = entity_index_->link(link_state.reference_frame);
 #else
-  gazebo::physics::LinkPtr body = boost::dynamic_pointer_cast<gazebo::physics::Link>(world_->GetEntity(req.link_state.link_name));
-  gazebo::physics::EntityPtr frame = world_->GetEntity(req.link_state.reference_frame);
+  gazebo::physics::EntityPtr frame = entity_index_->entity(link_state.reference_frame);
 #endif
   if (!body)
   {
-    ROS_ERROR_NAMED("api_plugin", "Updating LinkState: link [%s] does not exist",req.link_state.link_name.c_str());
-    res.success = false;
-    res.status_message = "SetLinkState: link does not exist";
-    return true;
+    ROS_ERROR_NAMED("api_plugin", "Updating LinkState: link [%s] does not exist",link_state.link_name.c_str());
+    status_message = "SetLinkState: link does not exist";
+    return false;
   }
 
   /// @todo: FIXME map is really wrong, unless using tf here somehow
   // get reference frame (body/model(link)) pose and
   // transform target pose to absolute world frame
-  ignition::math::Vector3d target_pos(req.link_state.pose.position.x,req.link_state.pose.position.y,req.link_state.pose.position.z);
-  ignition::math::Quaterniond target_rot(req.link_state.pose.orientation.w,req.link_state.pose.orientation.x,req.link_state.pose.orientation.y,req.link_state.pose.orientation.z);
+  ignition::math::Vector3d target_pos(link_state.pose.position.x,link_state.pose.position.y,link_state.pose.position.z);
+  ignition::math::Quaterniond target_rot(link_state.pose.orientation.w,link_state.pose.orientation.x,link_state.pose.orientation.y,link_state.pose.orientation.z);
   ignition::math::Pose3d target_pose(target_pos,target_rot);
-  ignition::math::Vector3d target_linear_vel(req.link_state.twist.linear.x,req.link_state.twist.linear.y,req.link_state.twist.linear.z);
-  ignition::math::Vector3d target_angular_vel(req.link_state.twist.angular.x,req.link_state.twist.angular.y,req.link_state.twist.angular.z);
+  ignition::math::Vector3d target_linear_vel(link_state.twist.linear.x,link_state.twist.linear.y,link_state.twist.linear.z);
+  ignition::math::Vector3d target_angular_vel(link_state.twist.angular.x,link_state.twist.angular.y,link_state.twist.angular.z);
 
   if (frame)
   {
@@ -1877,8 +3183,6 @@ bool GazeboRosApiPlugin::setLinkState(gazebo_msgs::SetLinkState::Request &req,
     ignition::math::Vector3d frame_linear_vel = frame->GetWorldLinearVel().Ign();
     ignition::math::Vector3d frame_angular_vel = frame->GetWorldAngularVel().Ign();
 #endif
-    ignition::math::Vector3d frame_pos = frame_pose.Pos();
-    ignition::math::Quaterniond frame_rot = frame_pose.Rot();
 
     //std::cout << " debug : " << frame->GetName() << " : " << frame_pose << " : " << target_pose << std::endl;
     target_pose = target_pose + frame_pose;
@@ -1886,15 +3190,31 @@ bool GazeboRosApiPlugin::setLinkState(gazebo_msgs::SetLinkState::Request &req,
     target_linear_vel -= frame_linear_vel;
     target_angular_vel -= frame_angular_vel;
   }
-  else if (req.link_state.reference_frame == "" || req.link_state.reference_frame == "world" || req.link_state.reference_frame == "map" || req.link_state.reference_frame == "/map")
+  else if (link_state.reference_frame == "" || link_state.reference_frame == "world" || link_state.reference_frame == "map" || link_state.reference_frame == "/map")
   {
     ROS_INFO_NAMED("api_plugin", "Updating LinkState: reference_frame is empty/world/map, using inertial frame");
   }
   else
   {
     ROS_ERROR_NAMED("api_plugin", "Updating LinkState: reference_frame is not a valid entity name");
+    status_message = "SetLinkState: failed";
+    return false;
+  }
+
+  command.link = body;
+  command.pose = target_pose;
+  command.linear_vel = target_linear_vel;
+  command.angular_vel = target_angular_vel;
+  return true;
+}
+
+bool GazeboRosApiPlugin::setLinkState(gazebo_msgs::SetLinkState::Request &req,
+                                      gazebo_msgs::SetLinkState::Response &res)
+{
+  LinkStateCommand command;
+  if (!resolveLinkState(req.link_state, command, res.status_message))
+  {
     res.success = false;
-    res.status_message = "SetLinkState: failed";
     return true;
   }
 
@@ -1903,12 +3223,12 @@ bool GazeboRosApiPlugin::setLinkState(gazebo_msgs::SetLinkState::Request &req,
 
   bool is_paused = world_->IsPaused();
   if (!is_paused) world_->SetPaused(true);
-  body->SetWorldPose(target_pose);
+  command.link->SetWorldPose(command.pose);
   world_->SetPaused(is_paused);
 
   // set body velocity to desired twist
-  body->SetLinearVel(target_linear_vel);
-  body->SetAngularVel(target_angular_vel);
+  command.link->SetLinearVel(command.linear_vel);
+  command.link->SetAngularVel(command.angular_vel);
 
   res.success = true;
   res.status_message = "SetLinkState: success";
@@ -1917,10 +3237,50 @@ bool GazeboRosApiPlugin::setLinkState(gazebo_msgs::SetLinkState::Request &req,
 
 void GazeboRosApiPlugin::updateLinkState(const gazebo_msgs::LinkState::ConstPtr& link_state)
 {
-  gazebo_msgs::SetLinkState::Request req;
-  gazebo_msgs::SetLinkState::Response res;
-  req.link_state = *link_state;
-  /*bool success = */ setLinkState(req,res);
+  {
+    boost::mutex::scoped_lock lock(state_topic_mutex_);
+    link_state_topic_queue_.push(link_state->link_name, *link_state);
+  }
+  // a paused world has no updates to apply it with
+  if (world_->IsPaused())
+    applyStateTopics();
+}
+
+void GazeboRosApiPlugin::applyStateTopics()
+{
+  GAZEBO_ROS_PROFILE("GazeboRosApiPlugin::applyStateTopics");
+  std::vector<gazebo_msgs::ModelState> model_states;
+  std::vector<gazebo_msgs::LinkState> link_states;
+  {
+    boost::mutex::scoped_lock lock(state_topic_mutex_);
+    if (model_state_topic_queue_.empty() && link_state_topic_queue_.empty())
+      return;
+    model_state_topic_queue_.take(model_states);
+    link_state_topic_queue_.take(link_states);
+    ROS_DEBUG_STREAM_THROTTLE_NAMED(10, "api_plugin", "State topics: "
+      << model_state_topic_queue_.coalesced() << " of " << model_state_topic_queue_.received()
+      << " set_model_state and " << link_state_topic_queue_.coalesced() << " of "
+      << link_state_topic_queue_.received() << " set_link_state messages coalesced");
+  }
+
+  // models before links, a link state refines the pose of its model
+  std::string status_message;
+  for (size_t i = 0; i < model_states.size(); ++i)
+  {
+    ModelStateCommand command;
+    if (resolveModelState(model_states[i], command, status_message))
+      applyModelState(command);
+  }
+  for (size_t i = 0; i < link_states.size(); ++i)
+  {
+    LinkStateCommand command;
+    if (resolveLinkState(link_states[i], command, status_message))
+    {
+      command.link->SetWorldPose(command.pose);
+      command.link->SetLinearVel(command.linear_vel);
+      command.link->SetAngularVel(command.angular_vel);
+    }
+  }
 }
 
 void GazeboRosApiPlugin::transformWrench( ignition::math::Vector3d &target_force, ignition::math::Vector3d &target_torque,
@@ -1940,13 +3300,8 @@ void GazeboRosApiPlugin::transformWrench( ignition::math::Vector3d &target_force
 bool GazeboRosApiPlugin::applyBodyWrench(gazebo_msgs::ApplyBodyWrench::Request &req,
                                          gazebo_msgs::ApplyBodyWrench::Response &res)
 {
-#if GAZEBO_MAJOR_VERSION >= 8
-  gazebo::physics::LinkPtr body = boost::dynamic_pointer_cast<gazebo::physics::Link>(world_->EntityByName(req.body_name));
-  gazebo::physics::EntityPtr frame = world_->EntityByName(req.reference_frame);
-#else
-  gazebo::physics::LinkPtr body = boost::dynamic_pointer_cast<gazebo::physics::Link>(world_->GetEntity(req.body_name));
-  gazebo::physics::EntityPtr frame = world_->GetEntity(req.reference_frame);
-#endif
+  gazebo::physics::LinkPtr body = entity_index_->link(req.body_name);
+  gazebo::physics::EntityPtr frame = entity_index_->entity(req.reference_frame);
   if (!body)
   {
     ROS_ERROR_NAMED("api_plugin", "ApplyBodyWrench: body [%s] does not exist",req.body_name.c_str());
@@ -2044,258 +3399,583 @@ bool GazeboRosApiPlugin::applyBodyWrench(gazebo_msgs::ApplyBodyWrench::Request &
     return true;
   }
 
-  // apply wrench
-  // schedule a job to do below at appropriate times:
-  // body->SetForce(force)
-  // body->SetTorque(torque)
-  GazeboRosApiPlugin::WrenchBodyJob* wej = new GazeboRosApiPlugin::WrenchBodyJob;
-  wej->body = body;
-  wej->force = target_force;
-  wej->torque = target_torque;
-  wej->start_time = req.start_time;
+  // apply wrench
+  // schedule a job to do below at appropriate times:
+  // body->SetForce(force)
+  // body->SetTorque(torque)
+  GazeboRosApiPlugin::WrenchBodyJob wej;
+  wej.body = body;
+  wej.force = target_force;
+  wej.torque = target_torque;
+  wej.start_time = req.start_time;
+#if GAZEBO_MAJOR_VERSION >= 8
+  if (wej.start_time < ros::Time(world_->SimTime().Double()))
+    wej.start_time = ros::Time(world_->SimTime().Double());
+#else
+  if (wej.start_time < ros::Time(world_->GetSimTime().Double()))
+    wej.start_time = ros::Time(world_->GetSimTime().Double());
+#endif
+  wej.duration = req.duration;
+  lock_.lock();
+  wrench_body_jobs_.add(wej);
+  model_jobs_.insert(jobModel(wej.body->GetScopedName()));
+  lock_.unlock();
+
+  res.success = true;
+  res.status_message = "";
+  return true;
+}
+
+bool GazeboRosApiPlugin::isURDF(std::string model_xml)
+{
+  TiXmlDocument doc_in;
+  doc_in.Parse(model_xml.c_str());
+  if (doc_in.FirstChild("robot"))
+    return true;
+  else
+    return false;
+}
+
+bool GazeboRosApiPlugin::isSDF(std::string model_xml)
+{
+  // FIXME: very crude check
+  TiXmlDocument doc_in;
+  doc_in.Parse(model_xml.c_str());
+  if (doc_in.FirstChild("gazebo") ||
+      doc_in.FirstChild("sdf")) // sdf
+    return true;
+  else
+    return false;
+}
+
+void GazeboRosApiPlugin::wrenchBodySchedulerSlot()
+{
+  GAZEBO_ROS_PROFILE("GazeboRosApiPlugin::wrenchBodySchedulerSlot");
+  // MDMutex locks in case model is getting deleted, don't have to do this if we delete jobs first
+  // boost::recursive_mutex::scoped_lock lock(*world->GetMDMutex());
+#if GAZEBO_MAJOR_VERSION >= 8
+  ros::Time simTime = ros::Time(world_->SimTime().Double());
+#else
+  ros::Time simTime = ros::Time(world_->GetSimTime().Double());
+#endif
+  lock_.lock();
+  wrench_body_jobs_.update(simTime, &GazeboRosApiPlugin::applyWrenchBodyJob);
+  lock_.unlock();
+}
+
+bool GazeboRosApiPlugin::applyWrenchBodyJob(const WrenchBodyJob &job)
+{
+  if (!job.body) // drop the job once the body is gone
+    return false;
+  job.body->SetForce(job.force);
+  job.body->SetTorque(job.torque);
+  return true;
+}
+
+void GazeboRosApiPlugin::forceJointSchedulerSlot()
+{
+  GAZEBO_ROS_PROFILE("GazeboRosApiPlugin::forceJointSchedulerSlot");
+  // MDMutex locks in case model is getting deleted, don't have to do this if we delete jobs first
+  // boost::recursive_mutex::scoped_lock lock(*world->GetMDMutex());
+#if GAZEBO_MAJOR_VERSION >= 8
+  ros::Time simTime = ros::Time(world_->SimTime().Double());
+#else
+  ros::Time simTime = ros::Time(world_->GetSimTime().Double());
+#endif
+  lock_.lock();
+  force_joint_jobs_.update(simTime, &GazeboRosApiPlugin::applyForceJointJob);
+  lock_.unlock();
+}
+
+bool GazeboRosApiPlugin::applyForceJointJob(const ForceJointJob &job)
+{
+  if (!job.joint) // drop the job once the joint is gone
+    return false;
+  job.joint->SetForce(0,job.force);
+  return true;
+}
+
+void GazeboRosApiPlugin::stepCommandSlot()
+{
+  GAZEBO_ROS_PROFILE("GazeboRosApiPlugin::stepCommandSlot");
+  lock_.lock();
+  for (size_t i = 0; i < step_joint_efforts_.size(); ++i)
+    step_joint_efforts_[i].first->SetForce(0, step_joint_efforts_[i].second);
+  for (size_t i = 0; i < step_wrenches_.size(); ++i)
+  {
+    step_wrenches_[i].body->AddForce(step_wrenches_[i].force);
+    step_wrenches_[i].body->AddTorque(step_wrenches_[i].torque);
+  }
+  lock_.unlock();
+}
+
+namespace
+{
+void fillState(const gazebo::physics::Entity &entity, geometry_msgs::Pose &pose,
+               geometry_msgs::Twist &twist)
+{
+#if GAZEBO_MAJOR_VERSION >= 8
+  ignition::math::Pose3d world_pose = entity.WorldPose();
+  ignition::math::Vector3d linear_vel = entity.WorldLinearVel();
+  ignition::math::Vector3d angular_vel = entity.WorldAngularVel();
+#else
+  ignition::math::Pose3d world_pose = entity.GetWorldPose().Ign();
+  ignition::math::Vector3d linear_vel = entity.GetWorldLinearVel().Ign();
+  ignition::math::Vector3d angular_vel = entity.GetWorldAngularVel().Ign();
+#endif
+  pose.position.x = world_pose.Pos().X();
+  pose.position.y = world_pose.Pos().Y();
+  pose.position.z = world_pose.Pos().Z();
+  pose.orientation.w = world_pose.Rot().W();
+  pose.orientation.x = world_pose.Rot().X();
+  pose.orientation.y = world_pose.Rot().Y();
+  pose.orientation.z = world_pose.Rot().Z();
+  twist.linear.x = linear_vel.X();
+  twist.linear.y = linear_vel.Y();
+  twist.linear.z = linear_vel.Z();
+  twist.angular.x = angular_vel.X();
+  twist.angular.y = angular_vel.Y();
+  twist.angular.z = angular_vel.Z();
+}
+}
+
+bool GazeboRosApiPlugin::stepWorld(gazebo_msgs::StepWorld::Request &req,
+                                   gazebo_msgs::StepWorld::Response &res)
+{
+  if (req.joint_name.size() != req.effort.size() || req.body_name.size() != req.wrench.size())
+  {
+    res.success = false;
+    res.status_message = "StepWorld: joint_name and effort, or body_name and wrench, differ in size";
+    return true;
+  }
+
+  // resolve everything first, nothing is applied if a name is missing
+  std::vector<ModelStateCommand> model_states(req.model_states.size());
+  for (size_t i = 0; i < req.model_states.size(); ++i)
+  {
+    if (!resolveModelState(req.model_states[i], model_states[i], res.status_message))
+    {
+      res.success = false;
+      return true;
+    }
+  }
+  std::vector<std::pair<gazebo::physics::JointPtr, double> > joint_efforts(req.joint_name.size());
+  for (size_t i = 0; i < req.joint_name.size(); ++i)
+  {
+    joint_efforts[i].first = entity_index_->joint(req.joint_name[i]);
+    joint_efforts[i].second = req.effort[i];
+    if (!joint_efforts[i].first)
+    {
+      res.success = false;
+      res.status_message = "StepWorld: joint not found: " + req.joint_name[i];
+      return true;
+    }
+  }
+  std::vector<StepWrench> wrenches(req.body_name.size());
+  for (size_t i = 0; i < req.body_name.size(); ++i)
+  {
+    wrenches[i].body = entity_index_->link(req.body_name[i]);
+    wrenches[i].force.Set(req.wrench[i].force.x, req.wrench[i].force.y, req.wrench[i].force.z);
+    wrenches[i].torque.Set(req.wrench[i].torque.x, req.wrench[i].torque.y, req.wrench[i].torque.z);
+    if (!wrenches[i].body)
+    {
+      res.success = false;
+      res.status_message = "StepWorld: body not found: " + req.body_name[i];
+      return true;
+    }
+  }
+  std::vector<gazebo::physics::ModelPtr> snapshot_models(req.snapshot_model_name.size());
+  for (size_t i = 0; i < req.snapshot_model_name.size(); ++i)
+  {
+    snapshot_models[i] = entity_index_->model(req.snapshot_model_name[i]);
+    if (!snapshot_models[i])
+    {
+      res.success = false;
+      res.status_message = "StepWorld: snapshot model not found: " + req.snapshot_model_name[i];
+      return true;
+    }
+  }
+  std::vector<gazebo::physics::LinkPtr> snapshot_links(req.snapshot_link_name.size());
+  for (size_t i = 0; i < req.snapshot_link_name.size(); ++i)
+  {
+    snapshot_links[i] = entity_index_->link(req.snapshot_link_name[i]);
+    if (!snapshot_links[i])
+    {
+      res.success = false;
+      res.status_message = "StepWorld: snapshot link not found: " + req.snapshot_link_name[i];
+      return true;
+    }
+  }
+
+  // the world only steps on request from here on
+  world_->SetPaused(true);
+
+  for (size_t i = 0; i < model_states.size(); ++i)
+    applyModelState(model_states[i]);
+
+  if (req.steps > 0)
+  {
+    lock_.lock();
+    step_joint_efforts_.swap(joint_efforts);
+    step_wrenches_.swap(wrenches);
+    lock_.unlock();
+
+    // blocks until the world ran them
+    world_->Step(req.steps);
+
+    lock_.lock();
+    step_joint_efforts_.clear();
+    step_wrenches_.clear();
+    lock_.unlock();
+  }
+
 #if GAZEBO_MAJOR_VERSION >= 8
-  if (wej->start_time < ros::Time(world_->SimTime().Double()))
-    wej->start_time = ros::Time(world_->SimTime().Double());
+  gazebo::common::Time sim_time = world_->SimTime();
 #else
-  if (wej->start_time < ros::Time(world_->GetSimTime().Double()))
-    wej->start_time = ros::Time(world_->GetSimTime().Double());
+  gazebo::common::Time sim_time = world_->GetSimTime();
 #endif
-  wej->duration = req.duration;
-  lock_.lock();
-  wrench_body_jobs_.push_back(wej);
-  lock_.unlock();
+  res.sim_time.sec = sim_time.sec;
+  res.sim_time.nsec = sim_time.nsec;
 
-  res.success = true;
-  res.status_message = "";
-  return true;
-}
+  res.model_states.name = req.snapshot_model_name;
+  res.model_states.pose.resize(snapshot_models.size());
+  res.model_states.twist.resize(snapshot_models.size());
+  for (size_t i = 0; i < snapshot_models.size(); ++i)
+    fillState(*snapshot_models[i], res.model_states.pose[i], res.model_states.twist[i]);
 
-bool GazeboRosApiPlugin::isURDF(std::string model_xml)
-{
-  TiXmlDocument doc_in;
-  doc_in.Parse(model_xml.c_str());
-  if (doc_in.FirstChild("robot"))
-    return true;
-  else
-    return false;
-}
+  res.link_states.name = req.snapshot_link_name;
+  res.link_states.pose.resize(snapshot_links.size());
+  res.link_states.twist.resize(snapshot_links.size());
+  for (size_t i = 0; i < snapshot_links.size(); ++i)
+    fillState(*snapshot_links[i], res.link_states.pose[i], res.link_states.twist[i]);
 
-bool GazeboRosApiPlugin::isSDF(std::string model_xml)
-{
-  // FIXME: very crude check
-  TiXmlDocument doc_in;
-  doc_in.Parse(model_xml.c_str());
-  if (doc_in.FirstChild("gazebo") ||
-      doc_in.FirstChild("sdf")) // sdf
-    return true;
-  else
-    return false;
+  res.success = true;
+  res.status_message = "StepWorld: stepped";
+  return true;
 }
 
-void GazeboRosApiPlugin::wrenchBodySchedulerSlot()
+bool GazeboRosApiPlugin::saveWorldState(gazebo_msgs::SaveWorldState::Request &req,
+                                        gazebo_msgs::SaveWorldState::Response &res)
 {
-  // MDMutex locks in case model is getting deleted, don't have to do this if we delete jobs first
-  // boost::recursive_mutex::scoped_lock lock(*world->GetMDMutex());
-  lock_.lock();
-  for (std::vector<GazeboRosApiPlugin::WrenchBodyJob*>::iterator iter=wrench_body_jobs_.begin();iter!=wrench_body_jobs_.end();)
+  SavedWorldState &saved = world_state_slots_[req.slot];
+  gazebo_msgs::WorldState &state = saved.state;
+  state.name.clear();
+  state.pose.clear();
+  state.twist.clear();
+  state.wrench.clear();
+  saved.model_configurations.clear();
+
+  // all links between two physics updates
+#if GAZEBO_MAJOR_VERSION >= 8
+  gazebo::physics::PhysicsEnginePtr pe = world_->Physics();
+#else
+  gazebo::physics::PhysicsEnginePtr pe = world_->GetPhysicsEngine();
+#endif
   {
-    // check times and apply wrench if necessary
+    boost::recursive_mutex::scoped_lock lock(*pe->GetPhysicsUpdateMutex());
 #if GAZEBO_MAJOR_VERSION >= 8
-    ros::Time simTime = ros::Time(world_->SimTime().Double());
+    gazebo::common::Time sim_time = world_->SimTime();
+    const unsigned int model_count = world_->ModelCount();
 #else
-    ros::Time simTime = ros::Time(world_->GetSimTime().Double());
+    gazebo::common::Time sim_time = world_->GetSimTime();
+    const unsigned int model_count = world_->GetModelCount();
 #endif
-    if (simTime >= (*iter)->start_time)
-      if (simTime <= (*iter)->start_time+(*iter)->duration ||
-          (*iter)->duration.toSec() < 0.0)
-      {
-        if ((*iter)->body) // if body exists
-        {
-          (*iter)->body->SetForce((*iter)->force);
-          (*iter)->body->SetTorque((*iter)->torque);
-        }
-        else
-          (*iter)->duration.fromSec(0.0); // mark for delete
-      }
+    state.header.stamp.sec = sim_time.sec;
+    state.header.stamp.nsec = sim_time.nsec;
+    state.header.frame_id = "world";
 
-    if (simTime > (*iter)->start_time+(*iter)->duration &&
-        (*iter)->duration.toSec() >= 0.0)
+    for (unsigned int i = 0; i < model_count; ++i)
     {
-      // remove from queue once expires
-      delete (*iter);
-      iter = wrench_body_jobs_.erase(iter);
-    }
-    else
-      ++iter;
-  }
-  lock_.unlock();
-}
+#if GAZEBO_MAJOR_VERSION >= 8
+      gazebo::physics::ModelPtr model = world_->ModelByIndex(i);
+#else
+      gazebo::physics::ModelPtr model = world_->GetModel(i);
+#endif
+      const gazebo::physics::Link_V &links = model->GetLinks();
+      for (unsigned int j = 0; j < links.size(); ++j)
+      {
+        state.name.push_back(links[j]->GetScopedName());
+        state.pose.push_back(geometry_msgs::Pose());
+        state.twist.push_back(geometry_msgs::Twist());
+        fillState(*links[j], state.pose.back(), state.twist.back());
+
+        // SetLinearVel() on restore sets the velocity of the center of mass, not that of the link origin
+#if GAZEBO_MAJOR_VERSION >= 8
+        ignition::math::Vector3d cog_vel = links[j]->WorldCoGLinearVel();
+#else
+        ignition::math::Vector3d cog_vel = links[j]->GetWorldCoGLinearVel().Ign();
+#endif
+        state.twist.back().linear.x = cog_vel.X();
+        state.twist.back().linear.y = cog_vel.Y();
+        state.twist.back().linear.z = cog_vel.Z();
 
-void GazeboRosApiPlugin::forceJointSchedulerSlot()
-{
-  // MDMutex locks in case model is getting deleted, don't have to do this if we delete jobs first
-  // boost::recursive_mutex::scoped_lock lock(*world->GetMDMutex());
-  lock_.lock();
-  for (std::vector<GazeboRosApiPlugin::ForceJointJob*>::iterator iter=force_joint_jobs_.begin();iter!=force_joint_jobs_.end();)
-  {
-    // check times and apply force if necessary
 #if GAZEBO_MAJOR_VERSION >= 8
-    ros::Time simTime = ros::Time(world_->SimTime().Double());
+        ignition::math::Vector3d force = links[j]->WorldForce();
+        ignition::math::Vector3d torque = links[j]->WorldTorque();
 #else
-    ros::Time simTime = ros::Time(world_->GetSimTime().Double());
+        ignition::math::Vector3d force = links[j]->GetWorldForce().Ign();
+        ignition::math::Vector3d torque = links[j]->GetWorldTorque().Ign();
 #endif
-    if (simTime >= (*iter)->start_time)
-      if (simTime <= (*iter)->start_time+(*iter)->duration ||
-          (*iter)->duration.toSec() < 0.0)
+        state.wrench.push_back(geometry_msgs::Wrench());
+        state.wrench.back().force.x = force.X();
+        state.wrench.back().force.y = force.Y();
+        state.wrench.back().force.z = force.Z();
+        state.wrench.back().torque.x = torque.X();
+        state.wrench.back().torque.y = torque.Y();
+        state.wrench.back().torque.z = torque.Z();
+      }
+
+      // joint positions by name relative to the model, as set_model_configurations takes them
+      const gazebo::physics::Joint_V &joints = model->GetJoints();
+      const std::string scope = model->GetScopedName() + "::";
+      gazebo_msgs::ModelConfiguration configuration;
+      configuration.model_name = model->GetName();
+      for (unsigned int j = 0; j < joints.size(); ++j)
       {
-        if ((*iter)->joint) // if joint exists
-          (*iter)->joint->SetForce(0,(*iter)->force);
-        else
-          (*iter)->duration.fromSec(0.0); // mark for delete
+#if GAZEBO_MAJOR_VERSION >= 8
+        if (joints[j]->DOF() == 0)
+          continue;
+        const double position = joints[j]->Position(0);
+#else
+        if (joints[j]->GetAngleCount() == 0)
+          continue;
+        const double position = joints[j]->GetAngle(0).Radian();
+#endif
+        std::string name = joints[j]->GetScopedName();
+        if (name.compare(0, scope.size(), scope) == 0)
+          name.erase(0, scope.size());
+        configuration.joint_names.push_back(name);
+        configuration.joint_positions.push_back(position);
       }
+      if (!configuration.joint_names.empty())
+        saved.model_configurations.push_back(configuration);
+    }
+  }
+
+  if (req.return_state)
+  {
+    res.state = state;
+    res.model_configurations = saved.model_configurations;
+  }
+  res.success = true;
+  res.status_message = "SaveWorldState: saved";
+  return true;
+}
 
-    if (simTime > (*iter)->start_time+(*iter)->duration &&
-        (*iter)->duration.toSec() >= 0.0)
+bool GazeboRosApiPlugin::restoreWorldState(gazebo_msgs::RestoreWorldState::Request &req,
+                                           gazebo_msgs::RestoreWorldState::Response &res)
+{
+  const gazebo_msgs::WorldState *state = &req.state;
+  const std::vector<gazebo_msgs::ModelConfiguration> *model_configurations = &req.model_configurations;
+  if (!req.slot.empty())
+  {
+    std::map<std::string, SavedWorldState>::const_iterator it = world_state_slots_.find(req.slot);
+    if (it == world_state_slots_.end())
     {
-      // remove from queue once expires
-      iter = force_joint_jobs_.erase(iter);
+      res.success = false;
+      res.status_message = "RestoreWorldState: no saved state in slot " + req.slot;
+      return true;
     }
-    else
-      ++iter;
+    state = &it->second.state;
+    model_configurations = &it->second.model_configurations;
   }
-  lock_.unlock();
+
+  std::vector<ModelConfigurationCommand> configuration_commands;
+  configuration_commands.reserve(model_configurations->size());
+  for (size_t i = 0; i < model_configurations->size(); ++i)
+  {
+    ModelConfigurationCommand command;
+    std::string status_message;
+    if (resolveModelConfiguration((*model_configurations)[i], command, status_message))
+      configuration_commands.push_back(command);  // otherwise deleted since
+  }
+
+  const size_t n = std::min(state->name.size(), std::min(state->pose.size(), state->twist.size()));
+  std::vector<LinkStateCommand> commands;
+  commands.reserve(n);
+  for (size_t i = 0; i < n; ++i)
+  {
+    LinkStateCommand command;
+    command.link = entity_index_->link(state->name[i]);
+    if (!command.link)
+      continue;  // deleted since
+    const geometry_msgs::Pose &pose = state->pose[i];
+    const geometry_msgs::Twist &twist = state->twist[i];
+    command.pose.Set(ignition::math::Vector3d(pose.position.x, pose.position.y, pose.position.z),
+                     ignition::math::Quaterniond(pose.orientation.w, pose.orientation.x,
+                                                 pose.orientation.y, pose.orientation.z));
+    command.linear_vel.Set(twist.linear.x, twist.linear.y, twist.linear.z);
+    command.angular_vel.Set(twist.angular.x, twist.angular.y, twist.angular.z);
+    commands.push_back(command);
+  }
+
+  if (req.clear_jobs)
+  {
+    lock_.lock();
+    wrench_body_jobs_.clear();
+    force_joint_jobs_.clear();
+    model_jobs_.clear();
+    lock_.unlock();
+  }
+
+  // every joint and link in the same world update, the joint positions first as with set_model_configurations
+  if (!commands.empty() || !configuration_commands.empty())
+    waitForModelStates(queueWorldState(commands, configuration_commands));
+
+  res.success = commands.size() == n && configuration_commands.size() == model_configurations->size();
+  std::ostringstream status;
+  status << "RestoreWorldState: restored " << commands.size() << " of " << n << " links and "
+         << configuration_commands.size() << " of " << model_configurations->size() << " model configurations";
+  res.status_message = status.str();
+  return true;
+}
+
+void GazeboRosApiPlugin::startupReportTimer(const ros::WallTimerEvent &event)
+{
+  std::vector<StartupTrace::Phase> phases;
+  const std::chrono::duration<double> quiet(startup_report_quiet_);
+  if (!StartupTrace::instance().takeReport(
+        phases, std::chrono::duration_cast<std::chrono::steady_clock::duration>(quiet)))
+    return;
+
+  ROS_INFO_STREAM_NAMED("api_plugin", StartupTrace::report(phases, 20));
+  std::string error;
+  if (!startup_trace_file_.empty() && !StartupTrace::instance().writeTrace(startup_trace_file_, error))
+    ROS_WARN_NAMED("api_plugin", "startup trace: %s", error.c_str());
 }
 
 void GazeboRosApiPlugin::publishSimTime()
 {
+  // the world update thread is gazebo's, its name is left alone
+  ThreadPolicy::instance().apply("physics", "");
 #if GAZEBO_MAJOR_VERSION >= 8
   gazebo::common::Time sim_time = world_->SimTime();
 #else
   gazebo::common::Time sim_time = world_->GetSimTime();
 #endif
-  if (pub_clock_frequency_ > 0 && (sim_time - last_pub_clock_time_).Double() < 1.0/pub_clock_frequency_)
-    return;
-
+  if (clock_shm_writer_)
 #if GAZEBO_MAJOR_VERSION >= 8
-  gazebo::common::Time currentTime = world_->SimTime();
+    clock_shm_writer_->write(sim_time, world_->Iterations());
 #else
-  gazebo::common::Time currentTime = world_->GetSimTime();
+    clock_shm_writer_->write(sim_time, world_->GetIterations());
 #endif
-  rosgraph_msgs::Clock ros_time_;
-  ros_time_.clock.fromSec(currentTime.Double());
-  //  publish time to ros
+
+  // what the /clock subscription of roscpp would do with a shared clock
+  if (!shared_clock_)
+    ros::Time::setNow(ros::Time(sim_time.sec, sim_time.nsec));
+
+  if (pub_clock_frequency_ > 0 && pub_clock_aligned_)
+  {
+    const int64_t period = static_cast<int64_t>(std::floor(sim_time.Double() * pub_clock_frequency_));
+    if (period == last_pub_clock_period_)
+      return;
+    last_pub_clock_period_ = period;
+  }
+  // a world reset takes sim time back, publish it right away
+  else if (pub_clock_frequency_ > 0 && sim_time >= last_pub_clock_time_ &&
+           (sim_time - last_pub_clock_time_).Double() < 1.0/pub_clock_frequency_)
+    return;
   last_pub_clock_time_ = sim_time;
-  pub_clock_.publish(ros_time_);
+
+  if (pub_clock_.getNumSubscribers() == 0)
+    return;
+
+  GAZEBO_ROS_PROFILE("GazeboRosApiPlugin::publishSimTime");
+  ScopedTiming timing(clock_timing_);
+  // published by pointer, in process subscribers get it without a copy
+  rosgraph_msgs::ClockPtr ros_time(new rosgraph_msgs::Clock());
+  ros_time->clock.sec = sim_time.sec;
+  ros_time->clock.nsec = sim_time.nsec;
+  pub_clock_.publish(ros_time);
 }
 
-void GazeboRosApiPlugin::publishLinkStates()
+void GazeboRosApiPlugin::onConsumerAck(const rosgraph_msgs::Clock::ConstPtr &msg, size_t consumer)
 {
-  gazebo_msgs::LinkStates link_states;
-
-  // fill link_states
-#if GAZEBO_MAJOR_VERSION >= 8
-  for (unsigned int i = 0; i < world_->ModelCount(); i ++)
-  {
-    gazebo::physics::ModelPtr model = world_->ModelByIndex(i);
-#else
-  for (unsigned int i = 0; i < world_->GetModelCount(); i ++)
   {
-    gazebo::physics::ModelPtr model = world_->GetModel(i);
-#endif
+    boost::mutex::scoped_lock lock(backpressure_mutex_);
+    backpressure_acks_[consumer] = gazebo::common::Time(msg->clock.sec, msg->clock.nsec);
+    backpressure_acked_[consumer] = true;
+  }
+  backpressure_cond_.notify_all();
+}
 
-    for (unsigned int j = 0 ; j < model->GetChildCount(); j ++)
+bool GazeboRosApiPlugin::backpressureClear(const gazebo::common::Time &sim_time, std::string &waiting_for)
+{
+  for (size_t i = 0; i < backpressure_consumers_.size(); ++i)
+  {
+    if (!backpressure_acked_[i] || (sim_time - backpressure_acks_[i]).Double() > backpressure_max_lag_)
     {
-      gazebo::physics::LinkPtr body = boost::dynamic_pointer_cast<gazebo::physics::Link>(model->GetChild(j));
+      waiting_for = backpressure_consumers_[i];
+      return false;
+    }
+  }
+  if (BacklogRegistry::instance().maxDepth(&waiting_for) > static_cast<size_t>(std::max(backpressure_max_queue_depth_, 0)))
+    return false;
+  return true;
+}
 
-      if (body)
-      {
-        link_states.name.push_back(body->GetScopedName());
-        geometry_msgs::Pose pose;
+void GazeboRosApiPlugin::backpressureSlot()
+{
 #if GAZEBO_MAJOR_VERSION >= 8
-        ignition::math::Pose3d  body_pose = body->WorldPose(); // - myBody->GetCoMPose();
-        ignition::math::Vector3d linear_vel  = body->WorldLinearVel();
-        ignition::math::Vector3d angular_vel = body->WorldAngularVel();
+  gazebo::common::Time sim_time = world_->SimTime();
 #else
-        ignition::math::Pose3d  body_pose = body->GetWorldPose().Ign(); // - myBody->GetCoMPose();
-        ignition::math::Vector3d linear_vel  = body->GetWorldLinearVel().Ign();
-        ignition::math::Vector3d angular_vel = body->GetWorldAngularVel().Ign();
+  gazebo::common::Time sim_time = world_->GetSimTime();
 #endif
-        ignition::math::Vector3d pos = body_pose.Pos();
-        ignition::math::Quaterniond rot = body_pose.Rot();
-        pose.position.x = pos.X();
-        pose.position.y = pos.Y();
-        pose.position.z = pos.Z();
-        pose.orientation.w = rot.W();
-        pose.orientation.x = rot.X();
-        pose.orientation.y = rot.Y();
-        pose.orientation.z = rot.Z();
-        link_states.pose.push_back(pose);
-        geometry_msgs::Twist twist;
-        twist.linear.x = linear_vel.X();
-        twist.linear.y = linear_vel.Y();
-        twist.linear.z = linear_vel.Z();
-        twist.angular.x = angular_vel.X();
-        twist.angular.y = angular_vel.Y();
-        twist.angular.z = angular_vel.Z();
-        link_states.twist.push_back(twist);
-      }
+
+  GAZEBO_ROS_PROFILE("GazeboRosApiPlugin::backpressureSlot");
+  ScopedTiming timing(backpressure_timing_);
+  const ros::WallTime deadline = ros::WallTime::now() + ros::WallDuration(backpressure_max_stall_);
+  std::string waiting_for;
+  boost::unique_lock<boost::mutex> lock(backpressure_mutex_);
+  while (!backpressureClear(sim_time, waiting_for))
+  {
+    if (stop_ || !ros::ok())
+      return;
+    if (backpressure_max_stall_ > 0 && ros::WallTime::now() >= deadline)
+    {
+      ++backpressure_stalls_;
+      ROS_WARN_THROTTLE_NAMED(5.0, "api_plugin", "Backpressure: waited %.2f s for [%s], stepping anyway (%lu times so far)",
+                              backpressure_max_stall_, waiting_for.c_str(), backpressure_stalls_);
+      return;
     }
+    // queue depths are polled, acks wake us up right away
+    backpressure_cond_.timed_wait(lock, boost::posix_time::milliseconds(1));
   }
+}
 
-  pub_link_states_.publish(link_states);
+void GazeboRosApiPlugin::publishLinkStates()
+{
+  link_states_publisher_->capture();
 }
 
 void GazeboRosApiPlugin::publishModelStates()
 {
-  gazebo_msgs::ModelStates model_states;
+  model_states_publisher_->capture();
+}
 
-  // fill model_states
-#if GAZEBO_MAJOR_VERSION >= 8
-  for (unsigned int i = 0; i < world_->ModelCount(); i ++)
-  {
-    gazebo::physics::ModelPtr model = world_->ModelByIndex(i);
-    ignition::math::Pose3d  model_pose = model->WorldPose(); // - myBody->GetCoMPose();
-    ignition::math::Vector3d linear_vel  = model->WorldLinearVel();
-    ignition::math::Vector3d angular_vel = model->WorldAngularVel();
-#else
-  for (unsigned int i = 0; i < world_->GetModelCount(); i ++)
-  {
-    gazebo::physics::ModelPtr model = world_->GetModel(i);
-    ignition::math::Pose3d  model_pose = model->GetWorldPose().Ign(); // - myBody->GetCoMPose();
-    ignition::math::Vector3d linear_vel  = model->GetWorldLinearVel().Ign();
-    ignition::math::Vector3d angular_vel = model->GetWorldAngularVel().Ign();
-#endif
-    ignition::math::Vector3d pos = model_pose.Pos();
-    ignition::math::Quaterniond rot = model_pose.Rot();
-    geometry_msgs::Pose pose;
-    pose.position.x = pos.X();
-    pose.position.y = pos.Y();
-    pose.position.z = pos.Z();
-    pose.orientation.w = rot.W();
-    pose.orientation.x = rot.X();
-    pose.orientation.y = rot.Y();
-    pose.orientation.z = rot.Z();
-    model_states.pose.push_back(pose);
-    model_states.name.push_back(model->GetName());
-    geometry_msgs::Twist twist;
-    twist.linear.x = linear_vel.X();
-    twist.linear.y = linear_vel.Y();
-    twist.linear.z = linear_vel.Z();
-    twist.angular.x = angular_vel.X();
-    twist.angular.y = angular_vel.Y();
-    twist.angular.z = angular_vel.Z();
-    model_states.twist.push_back(twist);
-  }
-  pub_model_states_.publish(model_states);
+void GazeboRosApiPlugin::publishRelativeStates()
+{
+  relative_states_publisher_->capture();
 }
 
 void GazeboRosApiPlugin::physicsReconfigureCallback(gazebo_ros::PhysicsConfig &config, uint32_t level)
 {
-  if (!physics_reconfigure_initialized_)
+  gazebo_msgs::GetPhysicsProperties srv;
+  getPhysicsProperties(srv.request, srv.response);
   {
-    gazebo_msgs::GetPhysicsProperties srv;
-    physics_reconfigure_get_client_.call(srv);
+    // changes are relative to what the next world update will set
+    boost::mutex::scoped_lock lock(model_state_mutex_);
+    if (physics_properties_pending_)
+    {
+      srv.response.time_step = physics_properties_command_.time_step;
+      srv.response.max_update_rate = physics_properties_command_.max_update_rate;
+      srv.response.gravity = physics_properties_command_.gravity;
+      srv.response.ode_config = physics_properties_command_.ode_config;
+    }
+  }
 
+  if (!physics_reconfigure_initialized_)
+  {
     config.time_step                   = srv.response.time_step;
     config.max_update_rate             = srv.response.max_update_rate;
     config.gravity_x                   = srv.response.gravity.x;
@@ -2316,8 +3996,6 @@ void GazeboRosApiPlugin::physicsReconfigureCallback(gazebo_ros::PhysicsConfig &c
   else
   {
     bool changed = false;
-    gazebo_msgs::GetPhysicsProperties srv;
-    physics_reconfigure_get_client_.call(srv);
 
     // check for changes
     if (config.time_step                      != srv.response.time_step)                                 changed = true;
@@ -2338,38 +4016,40 @@ void GazeboRosApiPlugin::physicsReconfigureCallback(gazebo_ros::PhysicsConfig &c
 
     if (changed)
     {
-      // pause simulation if requested
-      gazebo_msgs::SetPhysicsProperties srv;
-      srv.request.time_step                             = config.time_step                   ;
-      srv.request.max_update_rate                       = config.max_update_rate             ;
-      srv.request.gravity.x                             = config.gravity_x                   ;
-      srv.request.gravity.y                             = config.gravity_y                   ;
-      srv.request.gravity.z                             = config.gravity_z                   ;
-      srv.request.ode_config.auto_disable_bodies        = config.auto_disable_bodies         ;
-      srv.request.ode_config.sor_pgs_precon_iters       = config.sor_pgs_precon_iters        ;
-      srv.request.ode_config.sor_pgs_iters              = config.sor_pgs_iters               ;
-      srv.request.ode_config.sor_pgs_rms_error_tol      = config.sor_pgs_rms_error_tol       ;
-      srv.request.ode_config.sor_pgs_w                  = config.sor_pgs_w                   ;
-      srv.request.ode_config.contact_surface_layer      = config.contact_surface_layer       ;
-      srv.request.ode_config.contact_max_correcting_vel = config.contact_max_correcting_vel  ;
-      srv.request.ode_config.cfm                        = config.cfm                         ;
-      srv.request.ode_config.erp                        = config.erp                         ;
-      srv.request.ode_config.max_contacts               = config.max_contacts                ;
-      physics_reconfigure_set_client_.call(srv);
-      ROS_INFO_NAMED("api_plugin", "physics dynamics reconfigure update complete");
+      gazebo_msgs::SetPhysicsProperties::Request properties;
+      properties.time_step                             = config.time_step                   ;
+      properties.max_update_rate                       = config.max_update_rate             ;
+      properties.gravity.x                             = config.gravity_x                   ;
+      properties.gravity.y                             = config.gravity_y                   ;
+      properties.gravity.z                             = config.gravity_z                   ;
+      properties.ode_config.auto_disable_bodies        = config.auto_disable_bodies         ;
+      properties.ode_config.sor_pgs_precon_iters       = config.sor_pgs_precon_iters        ;
+      properties.ode_config.sor_pgs_iters              = config.sor_pgs_iters               ;
+      properties.ode_config.sor_pgs_rms_error_tol      = config.sor_pgs_rms_error_tol       ;
+      properties.ode_config.sor_pgs_w                  = config.sor_pgs_w                   ;
+      properties.ode_config.contact_surface_layer      = config.contact_surface_layer       ;
+      properties.ode_config.contact_max_correcting_vel = config.contact_max_correcting_vel  ;
+      properties.ode_config.cfm                        = config.cfm                         ;
+      properties.ode_config.erp                        = config.erp                         ;
+      properties.ode_config.max_contacts               = config.max_contacts                ;
+      // a later change before the next world update replaces this one, the
+      // paused world has none and applies it here
+      queuePhysicsProperties(properties);
+      if (world_->IsPaused())
+        applyQueuedModelStates();
+      ROS_DEBUG_NAMED("api_plugin", "physics dynamics reconfigure update staged");
     }
-    ROS_INFO_NAMED("api_plugin", "physics dynamics reconfigure complete");
   }
 }
 
 void GazeboRosApiPlugin::physicsReconfigureThread()
 {
+  ThreadPolicy::instance().apply("services", "gzros_physcfg");
   physics_reconfigure_set_client_ = nh_->serviceClient<gazebo_msgs::SetPhysicsProperties>("set_physics_properties");
-  physics_reconfigure_get_client_ = nh_->serviceClient<gazebo_msgs::GetPhysicsProperties>("get_physics_properties");
 
-  // Wait until the rest of this plugin is loaded and the services are being offered
+  // Wait until the rest of this plugin is loaded and the services are being offered, the callback then
+  // reads and stages the properties directly
   physics_reconfigure_set_client_.waitForExistence();
-  physics_reconfigure_get_client_.waitForExistence();
 
   physics_reconfigure_srv_.reset(new dynamic_reconfigure::Server<gazebo_ros::PhysicsConfig>());
 
@@ -2648,14 +4328,14 @@ void GazeboRosApiPlugin::walkChildAddRobotNamespace(TiXmlNode* model_xml)
   }
 }
 
-bool GazeboRosApiPlugin::spawnAndConform(TiXmlDocument &gazebo_model_xml, const std::string &model_name,
-                                         gazebo_msgs::SpawnModel::Response &res)
+bool GazeboRosApiPlugin::pushSpawn(TiXmlDocument &gazebo_model_xml, const std::string &model_name,
+                                   bool &is_light, std::string &status_message)
 {
   std::string entity_type = gazebo_model_xml.RootElement()->FirstChild()->Value();
   // Convert the entity type to lower case
   std::transform(entity_type.begin(), entity_type.end(), entity_type.begin(), ::tolower);
 
-  bool isLight = (entity_type == "light");
+  is_light = (entity_type == "light");
 
   // push to factory iface
   std::ostringstream stream;
@@ -2678,23 +4358,15 @@ bool GazeboRosApiPlugin::spawnAndConform(TiXmlDocument &gazebo_model_xml, const
   entity_info_msg = nullptr;
   // todo: should wait for response response_sub_, check to see that if _msg->response == "nonexistant"
 
-#if GAZEBO_MAJOR_VERSION >= 8
-  gazebo::physics::ModelPtr model = world_->ModelByName(model_name);
-  gazebo::physics::LightPtr light = world_->LightByName(model_name);
-#else
-  gazebo::physics::ModelPtr model = world_->GetModel(model_name);
-  gazebo::physics::LightPtr light = world_->Light(model_name);
-#endif
-  if ((isLight && light != NULL) || (model != NULL))
+  if (entitySpawned(model_name, is_light))
   {
     ROS_ERROR_NAMED("api_plugin", "SpawnModel: Failure - model name %s already exist.",model_name.c_str());
-    res.success = false;
-    res.status_message = "SpawnModel: Failure - entity already exists.";
-    return true;
+    status_message = "SpawnModel: Failure - entity already exists.";
+    return false;
   }
 
   // for Gazebo 7 and up, use a different method to spawn lights
-  if (isLight)
+  if (is_light)
   {
     // Publish the light message to spawn the light (Gazebo 7 and up)
     sdf::SDF sdf_light;
@@ -2708,15 +4380,57 @@ bool GazeboRosApiPlugin::spawnAndConform(TiXmlDocument &gazebo_model_xml, const
     // Publish the factory message
     factory_pub_->Publish(msg);
   }
-  /// FIXME: should change publish to direct invocation World::LoadModel() and/or
-  ///        change the poll for Model existence to common::Events based check.
+  return true;
+}
 
-  /// \brief poll and wait, verify that the model is spawned within Hardcoded 10 seconds
-  ros::Duration model_spawn_timeout(10.0);
-  ros::Time timeout = ros::Time::now() + model_spawn_timeout;
+bool GazeboRosApiPlugin::modelExists(const std::string &model_name)
+{
+#if GAZEBO_MAJOR_VERSION >= 8
+  return world_->ModelByName(model_name) != NULL;
+#else
+  return world_->GetModel(model_name) != NULL;
+#endif
+}
+
+bool GazeboRosApiPlugin::lightExists(const std::string &light_name)
+{
+#if GAZEBO_MAJOR_VERSION >= 8
+  return world_->LightByName(light_name) != NULL;
+#else
+  return world_->Light(light_name) != NULL;
+#endif
+}
+
+bool GazeboRosApiPlugin::entitySpawned(const std::string &model_name, bool is_light)
+{
+#if GAZEBO_MAJOR_VERSION >= 8
+  if (is_light && world_->LightByName(model_name) != NULL)
+#else
+  if (is_light && world_->Light(model_name) != NULL)
+#endif
+    return true;
+  return modelExists(model_name);
+}
+
+bool GazeboRosApiPlugin::spawnAndConform(TiXmlDocument &gazebo_model_xml, const std::string &model_name,
+                                         gazebo_msgs::SpawnModel::Response &res)
+{
+  bool is_light;
+  if (!pushSpawn(gazebo_model_xml, model_name, is_light, res.status_message))
+  {
+    res.success = false;
+    return true;
+  }
+
+  /// \brief wait for the entity to appear, woken by the world's entity events
+  ros::Time timeout = ros::Time::now() + ros::Duration(spawn_timeout_);
 
   while (ros::ok())
   {
+    unsigned int seen = entityEventCount();
+    if (entitySpawned(model_name, is_light))
+      break;
+
     if (ros::Time::now() > timeout)
     {
       res.success = false;
@@ -2724,22 +4438,10 @@ bool GazeboRosApiPlugin::spawnAndConform(TiXmlDocument &gazebo_model_xml, const
       return true;
     }
 
-    {
-      //boost::recursive_mutex::scoped_lock lock(*world->GetMRMutex());
-#if GAZEBO_MAJOR_VERSION >= 8
-      if ((isLight && world_->LightByName(model_name) != NULL)
-          || (world_->ModelByName(model_name) != NULL))
-#else
-      if ((isLight && world_->Light(model_name) != NULL)
-          || (world_->GetModel(model_name) != NULL))
-#endif
-        break;
-    }
-
     ROS_DEBUG_STREAM_ONCE_NAMED("api_plugin","Waiting for " << timeout - ros::Time::now()
       << " for entity " << model_name << " to spawn");
 
-    std::this_thread::sleep_for(std::chrono::microseconds(2000));
+    waitForEntityEvent(seen);
   }
 
   // set result
@@ -2748,6 +4450,154 @@ bool GazeboRosApiPlugin::spawnAndConform(TiXmlDocument &gazebo_model_xml, const
   return true;
 }
 
+bool GazeboRosApiPlugin::spawnModels(gazebo_msgs::SpawnModels::Request &req,
+                                     gazebo_msgs::SpawnModels::Response &res)
+{
+  const size_t n = req.model_name.size();
+  res.model_success.assign(n, false);
+  res.model_status_message.assign(n, "");
+
+  // the per model fields are either given for all models or shared by all of them
+  if ((req.model_xml.size() != n && req.model_xml.size() != 1) ||
+      (req.robot_namespace.size() > 1 && req.robot_namespace.size() != n) ||
+      (!req.initial_pose.empty() && req.initial_pose.size() != n) ||
+      (req.reference_frame.size() > 1 && req.reference_frame.size() != n))
+  {
+    res.success = false;
+    res.status_message = "SpawnModels: Failure - request fields do not match the number of model names";
+    return true;
+  }
+
+  // push all models to the factory back to back, the world takes them in one update
+  std::vector<bool> is_light(n, false);
+  std::vector<bool> pushed(n, false);
+  std::set<std::string> names;
+  for (size_t i = 0; i < n; ++i)
+  {
+    gazebo_msgs::SpawnModel::Request one;
+    gazebo_msgs::SpawnModel::Response one_res;
+    one.model_name = req.model_name[i];
+    one.model_xml = req.model_xml.size() == 1 ? req.model_xml[0] : req.model_xml[i];
+    if (!req.robot_namespace.empty())
+      one.robot_namespace = req.robot_namespace.size() == 1 ? req.robot_namespace[0] : req.robot_namespace[i];
+    if (!req.reference_frame.empty())
+      one.reference_frame = req.reference_frame.size() == 1 ? req.reference_frame[0] : req.reference_frame[i];
+    if (!req.initial_pose.empty())
+      one.initial_pose = req.initial_pose[i];
+    else
+      one.initial_pose.orientation.w = 1.0;
+
+    if (!names.insert(one.model_name).second)
+    {
+      res.model_status_message[i] = "SpawnModels: Failure - model name appears more than once in the request";
+      continue;
+    }
+
+    ParsedModelConstPtr parsed = parseModel(one.model_xml, true, res.model_status_message[i]);
+    if (!parsed)
+      continue;
+
+    TiXmlDocument gazebo_model_xml;
+    if (!buildSpawnXml(one, *parsed, gazebo_model_xml, one_res))
+    {
+      res.model_status_message[i] = one_res.status_message;
+      continue;
+    }
+
+    bool light;
+    pushed[i] = pushSpawn(gazebo_model_xml, one.model_name, light, res.model_status_message[i]);
+    is_light[i] = light;
+  }
+
+  // wait for all of them together
+  size_t waiting = std::count(pushed.begin(), pushed.end(), true);
+  ros::Time timeout = ros::Time::now() + ros::Duration(spawn_timeout_);
+  while (ros::ok() && waiting > 0 && ros::Time::now() <= timeout)
+  {
+    unsigned int seen = entityEventCount();
+    for (size_t i = 0; i < n; ++i)
+    {
+      if (pushed[i] && !res.model_success[i] && entitySpawned(req.model_name[i], is_light[i]))
+      {
+        res.model_success[i] = true;
+        res.model_status_message[i] = "SpawnModel: Successfully spawned entity";
+        --waiting;
+      }
+    }
+    if (waiting > 0)
+      waitForEntityEvent(seen);
+  }
+
+  size_t spawned = 0;
+  for (size_t i = 0; i < n; ++i)
+  {
+    if (res.model_success[i])
+      ++spawned;
+    else if (pushed[i])
+      res.model_status_message[i] = "SpawnModel: Entity pushed to spawn queue, but spawn service timed out waiting for entity to appear in simulation under the name " + req.model_name[i];
+  }
+
+  res.success = spawned == n;
+  std::ostringstream status;
+  status << "SpawnModels: spawned " << spawned << " of " << n << " entities";
+  res.status_message = status.str();
+  return true;
+}
+
+bool GazeboRosApiPlugin::deleteModels(gazebo_msgs::DeleteModels::Request &req,
+                                      gazebo_msgs::DeleteModels::Response &res)
+{
+  const size_t n = req.model_name.size();
+  res.model_success.assign(n, false);
+  res.model_status_message.assign(n, "");
+
+  // send all delete requests before waiting for any
+  std::vector<bool> pushed(n, false);
+  std::set<std::string> names;
+  for (size_t i = 0; i < n; ++i)
+  {
+    if (!names.insert(req.model_name[i]).second)
+    {
+      res.model_status_message[i] = "DeleteModels: Failure - model name appears more than once in the request";
+      continue;
+    }
+    pushed[i] = pushDelete(req.model_name[i], res.model_status_message[i]);
+  }
+
+  size_t waiting = std::count(pushed.begin(), pushed.end(), true);
+  ros::Time timeout = ros::Time::now() + ros::Duration(60.0);
+  while (ros::ok() && waiting > 0 && ros::Time::now() <= timeout)
+  {
+    unsigned int seen = entityEventCount();
+    for (size_t i = 0; i < n; ++i)
+    {
+      if (pushed[i] && !res.model_success[i] && !modelExists(req.model_name[i]))
+      {
+        res.model_success[i] = true;
+        res.model_status_message[i] = "DeleteModel: successfully deleted model";
+        --waiting;
+      }
+    }
+    if (waiting > 0)
+      waitForEntityEvent(seen);
+  }
+
+  size_t deleted = 0;
+  for (size_t i = 0; i < n; ++i)
+  {
+    if (res.model_success[i])
+      ++deleted;
+    else if (pushed[i])
+      res.model_status_message[i] = "DeleteModel: Model pushed to delete queue, but delete service timed out waiting for model to disappear from simulation";
+  }
+
+  res.success = deleted == n;
+  std::ostringstream status;
+  status << "DeleteModels: deleted " << deleted << " of " << n << " models";
+  res.status_message = status.str();
+  return true;
+}
+
 // Register this plugin with the simulator
 GZ_REGISTER_SYSTEM_PLUGIN(GazeboRosApiPlugin)
 }
@@ -25,6 +25,8 @@
 #include <ros/ros.h>
 #include <ros/package.h>
 
+#include <gazebo_ros/package_exports.h>
+
 #include <map>
 
 #ifdef _WIN32
@@ -68,14 +70,41 @@ public:
 
   /**
    * @brief Set Gazebo Path/Resources Configurations GAZEBO_MODEL_PATH, PLUGIN_PATH and
-            GAZEBO_MEDIA_PATH by adding paths to GazeboConfig based on ros::package
+            GAZEBO_MEDIA_PATH by adding paths to GazeboConfig based on the packages that
+            export "gazebo_media_path", "plugin_path" and "gazebo_model_path" for gazebo
    */
   void LoadPaths()
   {
+    std::vector<std::string> gazebo_media_paths;
+    std::vector<std::string> plugin_paths;
+    std::vector<std::string> model_paths;
+    std::string gazebo_ros_path;
+
+    // one crawl for the three attributes, reused from the cache while no package changed
+    std::vector<std::string> attributes;
+    attributes.push_back("gazebo_media_path");
+    attributes.push_back("plugin_path");
+    attributes.push_back("gazebo_model_path");
+    PackageExports exports("gazebo_ros", attributes);
+    if (exports.load(PackageExports::defaultCacheFile()))
+    {
+      ROS_DEBUG_NAMED("paths_plugin", "Package exports %s", exports.fromCache() ? "from cache" : "crawled");
+      gazebo_media_paths = exports.values("gazebo_media_path");
+      plugin_paths = exports.values("plugin_path");
+      model_paths = exports.values("gazebo_model_path");
+      gazebo_ros_path = exports.path();
+    }
+    else
+    {
+      // each of these runs a rospack crawl
+      ros::package::getPlugins("gazebo_ros","gazebo_media_path",gazebo_media_paths);
+      ros::package::getPlugins("gazebo_ros","plugin_path",plugin_paths);
+      ros::package::getPlugins("gazebo_ros","gazebo_model_path",model_paths);
+      gazebo_ros_path = ros::package::getPath("gazebo_ros");
+    }
+
     // set gazebo media paths by adding all packages that exports "gazebo_media_path" for gazebo
     gazebo::common::SystemPaths::Instance()->gazeboPathsFromEnv = false;
-    std::vector<std::string> gazebo_media_paths;
-    ros::package::getPlugins("gazebo_ros","gazebo_media_path",gazebo_media_paths);
     for (std::vector<std::string>::iterator iter=gazebo_media_paths.begin(); iter != gazebo_media_paths.end(); iter++)
     {
       ROS_DEBUG_NAMED("paths_plugin", "Media path %s",iter->c_str());
@@ -84,8 +113,6 @@ public:
 
     // set gazebo plugins paths by adding all packages that exports "plugin_path" for gazebo
     gazebo::common::SystemPaths::Instance()->pluginPathsFromEnv = false;
-    std::vector<std::string> plugin_paths;
-    ros::package::getPlugins("gazebo_ros","plugin_path",plugin_paths);
     for (std::vector<std::string>::iterator iter=plugin_paths.begin(); iter != plugin_paths.end(); iter++)
     {
       ROS_DEBUG_NAMED("paths_plugin", "plugin path %s",(*iter).c_str());
@@ -94,8 +121,6 @@ public:
 
     // set model paths by adding all packages that exports "gazebo_model_path" for gazebo
     gazebo::common::SystemPaths::Instance()->modelPathsFromEnv = false;
-    std::vector<std::string> model_paths;
-    ros::package::getPlugins("gazebo_ros","gazebo_model_path",model_paths);
     for (std::vector<std::string>::iterator iter=model_paths.begin(); iter != model_paths.end(); iter++)
     {
       ROS_DEBUG_NAMED("paths_plugin", "Model path %s",(*iter).c_str());
@@ -103,7 +128,7 @@ public:
     }
 
     // set .gazeborc path to something else, so we don't pick up default ~/.gazeborc
-    std::string gazeborc = ros::package::getPath("gazebo_ros")+"/.do_not_use_gazeborc";
+    std::string gazeborc = gazebo_ros_path+"/.do_not_use_gazeborc";
     setenv("GAZEBORC",gazeborc.c_str(),1);
   }
 
@@ -0,0 +1,162 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <errno.h>
+#include <stdio.h>
+
+#include <chrono>
+#include <cstring>
+
+#include <ros/console.h>
+
+#include <gazebo_ros/latency_tracer.h>
+
+namespace gazebo
+{
+
+namespace
+{
+
+/// \brief Events kept, the oldest are overwritten beyond that
+const uint64_t EVENT_COUNT = 1 << 20;
+
+const char *POINT_NAMES[] = { "callback", "converted", "enqueued", "published" };
+
+}
+
+std::atomic<bool> LatencyTracer::enabled_(false);
+
+LatencyTracer::LatencyTracer() :
+  next_(0),
+  written_(0)
+{
+}
+
+LatencyTracer &LatencyTracer::instance()
+{
+  static LatencyTracer tracer;
+  return tracer;
+}
+
+void LatencyTracer::setEnabled(bool enabled)
+{
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    if (enabled && !events_)
+    {
+      events_.reset(new Event[EVENT_COUNT]);
+      for (uint64_t i = 0; i < EVENT_COUNT; ++i)
+        events_[i].seq.store(0, std::memory_order_relaxed);
+    }
+  }
+
+  const bool was_enabled = enabled_.exchange(enabled);
+  if (!was_enabled || enabled)
+    return;
+
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    if (trace_file_.empty())
+      return;
+  }
+  std::string error;
+  if (!writeTrace(error))
+    ROS_ERROR_NAMED("latency_tracer", "Latency trace not written: %s", error.c_str());
+}
+
+void LatencyTracer::setTraceFile(const std::string &path)
+{
+  boost::mutex::scoped_lock lock(mutex_);
+  trace_file_ = path;
+}
+
+uint32_t LatencyTracer::topic(const std::string &name)
+{
+  boost::mutex::scoped_lock lock(mutex_);
+  std::map<std::string, uint32_t>::iterator it = topic_ids_.find(name);
+  if (it != topic_ids_.end())
+    return it->second;
+  const uint32_t id = topics_.size();
+  topics_.push_back(name);
+  topic_ids_[name] = id;
+  return id;
+}
+
+void LatencyTracer::record(uint32_t topic, Point point, int64_t stamp_nsec, int64_t sim_nsec)
+{
+  const uint64_t index = next_.fetch_add(1, std::memory_order_relaxed);
+  Event &event = events_[index % EVENT_COUNT];
+  event.seq.store(0, std::memory_order_relaxed);
+  event.stamp_nsec = stamp_nsec;
+  event.sim_nsec = sim_nsec;
+  event.wall_nsec = std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+  event.topic = topic;
+  event.point = point;
+  event.seq.store(index + 1, std::memory_order_release);
+}
+
+bool LatencyTracer::writeTrace(std::string &error)
+{
+  boost::mutex::scoped_lock lock(mutex_);
+  if (trace_file_.empty())
+  {
+    error = "no trace file set";
+    return false;
+  }
+  FILE *file = fopen(trace_file_.c_str(), "w");
+  if (!file)
+  {
+    error = "unable to open " + trace_file_ + ": " + strerror(errno);
+    return false;
+  }
+
+  const uint64_t end = next_.load(std::memory_order_acquire);
+  uint64_t begin = written_;
+  unsigned long overwritten = 0;
+  if (end - begin > EVENT_COUNT)
+  {
+    overwritten = end - begin - EVENT_COUNT;
+    begin = end - EVENT_COUNT;
+  }
+
+  fputs("topic,point,stamp_ns,sim_ns,wall_ns\n", file);
+  unsigned long count = 0;
+  for (uint64_t i = begin; events_ && i < end; ++i)
+  {
+    const Event &event = events_[i % EVENT_COUNT];
+    // skip events still being written, or already overwritten
+    if (event.seq.load(std::memory_order_acquire) != i + 1 || event.topic >= topics_.size())
+      continue;
+    fprintf(file, "%s,%s,%lld,%lld,%lld\n", topics_[event.topic].c_str(),
+            POINT_NAMES[event.point], static_cast<long long>(event.stamp_nsec),
+            static_cast<long long>(event.sim_nsec), static_cast<long long>(event.wall_nsec));
+    ++count;
+  }
+  written_ = end;
+
+  const bool ok = fclose(file) == 0;
+  if (!ok)
+    error = "unable to write " + trace_file_;
+  else
+    ROS_INFO_NAMED("latency_tracer", "Wrote %lu latency events to %s", count, trace_file_.c_str());
+  if (overwritten > 0)
+    ROS_WARN_NAMED("latency_tracer", "%lu latency events were overwritten before they were written", overwritten);
+  return ok;
+}
+
+}
@@ -0,0 +1,307 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <cmath>
+
+#include <boost/atomic.hpp>
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <gazebo/gazebo_config.h>
+#include <gazebo_ros/occupancy_rasterizer.h>
+#include <gazebo_ros/thread_policy.h>
+
+namespace gazebo
+{
+
+namespace
+{
+/// \brief Edge length of the x/y tiles rasterized by one thread [voxels]
+const uint32_t kTileSize = 64;
+
+/// \brief Voxel range [begin, end) of the interval [min, max] along an axis
+void voxelRange(double min, double max, double origin, double resolution,
+                uint32_t size, uint32_t &begin, uint32_t &end)
+{
+  double first = std::floor((min - origin) / resolution);
+  double last = std::ceil((max - origin) / resolution);
+  begin = static_cast<uint32_t>(std::min<double>(std::max(first, 0.0), size));
+  end = static_cast<uint32_t>(std::min<double>(std::max(last, 0.0), size));
+}
+}
+
+bool OccupancyRasterizer::Grid::operator==(const Grid &other) const
+{
+  return origin == other.origin && resolution == other.resolution &&
+    size_x == other.size_x && size_y == other.size_y && size_z == other.size_z;
+}
+
+OccupancyRasterizer::OccupancyRasterizer()
+{
+}
+
+void OccupancyRasterizer::readModel(const gazebo::physics::ModelPtr &model,
+                                    std::vector<Primitive> &primitives,
+                                    std::vector<ignition::math::Pose3d> &link_poses)
+{
+  gazebo::physics::Link_V links = model->GetLinks();
+  for (size_t l = 0; l < links.size(); ++l)
+  {
+#if GAZEBO_MAJOR_VERSION >= 8
+    link_poses.push_back(links[l]->WorldPose());
+#else
+    link_poses.push_back(links[l]->GetWorldPose().Ign());
+#endif
+
+    gazebo::physics::Collision_V collisions = links[l]->GetCollisions();
+    for (size_t c = 0; c < collisions.size(); ++c)
+    {
+      gazebo::physics::ShapePtr shape = collisions[c]->GetShape();
+      if (!shape || shape->HasType(gazebo::physics::Base::PLANE_SHAPE))
+        continue;
+
+      Primitive primitive;
+      primitive.type = BOUNDS;
+#if GAZEBO_MAJOR_VERSION >= 8
+      primitive.pose = collisions[c]->WorldPose();
+      primitive.bounds = collisions[c]->BoundingBox();
+#else
+      primitive.pose = collisions[c]->GetWorldPose().Ign();
+      primitive.bounds = collisions[c]->GetBoundingBox().Ign();
+#endif
+      if (shape->HasType(gazebo::physics::Base::BOX_SHAPE))
+      {
+        gazebo::physics::BoxShapePtr box =
+          boost::dynamic_pointer_cast<gazebo::physics::BoxShape>(shape);
+        primitive.type = BOX;
+#if GAZEBO_MAJOR_VERSION >= 8
+        primitive.size = box->Size();
+#else
+        primitive.size = box->GetSize().Ign();
+#endif
+      }
+      else if (shape->HasType(gazebo::physics::Base::SPHERE_SHAPE))
+      {
+        gazebo::physics::SphereShapePtr sphere =
+          boost::dynamic_pointer_cast<gazebo::physics::SphereShape>(shape);
+        primitive.type = SPHERE;
+        primitive.size.Set(sphere->GetRadius(), 0, 0);
+      }
+      else if (shape->HasType(gazebo::physics::Base::CYLINDER_SHAPE))
+      {
+        gazebo::physics::CylinderShapePtr cylinder =
+          boost::dynamic_pointer_cast<gazebo::physics::CylinderShape>(shape);
+        primitive.type = CYLINDER;
+        primitive.size.Set(cylinder->GetRadius(), 0, cylinder->GetLength());
+      }
+      primitives.push_back(primitive);
+    }
+  }
+}
+
+bool OccupancyRasterizer::contains(const Primitive &primitive,
+                                   const ignition::math::Vector3d &point, double pad)
+{
+  if (primitive.type == BOUNDS)
+  {
+    const ignition::math::Vector3d &min = primitive.bounds.Min();
+    const ignition::math::Vector3d &max = primitive.bounds.Max();
+    return point.X() >= min.X() - pad && point.X() <= max.X() + pad &&
+      point.Y() >= min.Y() - pad && point.Y() <= max.Y() + pad &&
+      point.Z() >= min.Z() - pad && point.Z() <= max.Z() + pad;
+  }
+
+  ignition::math::Vector3d local =
+    primitive.pose.Rot().RotateVectorReverse(point - primitive.pose.Pos());
+  switch (primitive.type)
+  {
+    case BOX:
+      return std::abs(local.X()) <= primitive.size.X() / 2 + pad &&
+        std::abs(local.Y()) <= primitive.size.Y() / 2 + pad &&
+        std::abs(local.Z()) <= primitive.size.Z() / 2 + pad;
+    case SPHERE:
+      return local.Length() <= primitive.size.X() + pad;
+    case CYLINDER:
+      return std::hypot(local.X(), local.Y()) <= primitive.size.X() + pad &&
+        std::abs(local.Z()) <= primitive.size.Z() / 2 + pad;
+    default:
+      return false;
+  }
+}
+
+void OccupancyRasterizer::rasterizeTile(const std::vector<Primitive> &primitives,
+                                        const Grid &grid, Tile &tile)
+{
+  const double pad = grid.resolution / 2;
+  const uint32_t width = tile.x1 - tile.x0;
+  const uint32_t height = tile.y1 - tile.y0;
+
+  // occupancy of the tile, so voxels of overlapping primitives count once
+  std::vector<uint8_t> occupied(static_cast<size_t>(width) * height * grid.size_z, 0);
+  for (size_t p = 0; p < primitives.size(); ++p)
+  {
+    const Primitive &primitive = primitives[p];
+    const ignition::math::Vector3d &min = primitive.bounds.Min();
+    const ignition::math::Vector3d &max = primitive.bounds.Max();
+    uint32_t x0, x1, y0, y1, z0, z1;
+    voxelRange(min.X() - pad, max.X() + pad, grid.origin.X(), grid.resolution, grid.size_x, x0, x1);
+    voxelRange(min.Y() - pad, max.Y() + pad, grid.origin.Y(), grid.resolution, grid.size_y, y0, y1);
+    voxelRange(min.Z() - pad, max.Z() + pad, grid.origin.Z(), grid.resolution, grid.size_z, z0, z1);
+    x0 = std::max(x0, tile.x0);
+    x1 = std::min(x1, tile.x1);
+    y0 = std::max(y0, tile.y0);
+    y1 = std::min(y1, tile.y1);
+
+    for (uint32_t z = z0; z < z1; ++z)
+    {
+      for (uint32_t y = y0; y < y1; ++y)
+      {
+        for (uint32_t x = x0; x < x1; ++x)
+        {
+          uint8_t &voxel = occupied[(x - tile.x0) + width * ((y - tile.y0) + height * z)];
+          if (voxel)
+            continue;
+          ignition::math::Vector3d center = grid.origin + grid.resolution *
+            ignition::math::Vector3d(x + 0.5, y + 0.5, z + 0.5);
+          voxel = contains(primitive, center, pad);
+        }
+      }
+    }
+  }
+
+  for (uint32_t z = 0; z < grid.size_z; ++z)
+    for (uint32_t y = 0; y < height; ++y)
+      for (uint32_t x = 0; x < width; ++x)
+        if (occupied[x + width * (y + height * z)])
+          tile.voxels.push_back((tile.x0 + x) + grid.size_x * ((tile.y0 + y) + grid.size_y * z));
+}
+
+void OccupancyRasterizer::rasterize(const std::vector<gazebo::physics::ModelPtr> &models,
+                                    const Grid &grid, std::vector<uint8_t> &voxels)
+{
+  boost::mutex::scoped_lock lock(mutex_);
+
+  for (std::map<std::string, ModelVoxels>::iterator it = cache_.begin(); it != cache_.end();)
+  {
+    if (it->second.model.expired())
+      cache_.erase(it++);
+    else
+      ++it;
+  }
+
+  // read the models that moved since they were cached
+  std::vector<ModelVoxels *> entries;
+  std::vector<ModelVoxels *> dirty;
+  std::vector<std::vector<Primitive> > dirty_primitives;
+  for (size_t m = 0; m < models.size(); ++m)
+  {
+    const gazebo::physics::ModelPtr &model = models[m];
+    ModelVoxels &entry = cache_[model->GetScopedName()];
+    entries.push_back(&entry);
+    bool valid = entry.model.lock() == model && entry.grid == grid;
+    if (valid && model->IsStatic())
+      continue;
+
+    std::vector<Primitive> primitives;
+    std::vector<ignition::math::Pose3d> link_poses;
+    readModel(model, primitives, link_poses);
+    if (valid && link_poses == entry.link_poses)
+      continue;
+
+    entry.model = model;
+    entry.grid = grid;
+    entry.link_poses.swap(link_poses);
+    entry.voxels.clear();
+    dirty.push_back(&entry);
+    dirty_primitives.push_back(std::vector<Primitive>());
+    dirty_primitives.back().swap(primitives);
+  }
+
+  // tiles of the x/y extent of each moved model
+  const double pad = grid.resolution / 2;
+  std::vector<Tile> tiles;
+  for (size_t d = 0; d < dirty.size(); ++d)
+  {
+    const std::vector<Primitive> &primitives = dirty_primitives[d];
+    if (primitives.empty())
+      continue;
+    ignition::math::Vector3d min = primitives[0].bounds.Min();
+    ignition::math::Vector3d max = primitives[0].bounds.Max();
+    for (size_t p = 1; p < primitives.size(); ++p)
+    {
+      min.Min(primitives[p].bounds.Min());
+      max.Max(primitives[p].bounds.Max());
+    }
+    uint32_t x0, x1, y0, y1;
+    voxelRange(min.X() - pad, max.X() + pad, grid.origin.X(), grid.resolution, grid.size_x, x0, x1);
+    voxelRange(min.Y() - pad, max.Y() + pad, grid.origin.Y(), grid.resolution, grid.size_y, y0, y1);
+    for (uint32_t y = y0; y < y1; y += kTileSize)
+    {
+      for (uint32_t x = x0; x < x1; x += kTileSize)
+      {
+        Tile tile;
+        tile.model = d;
+        tile.x0 = x;
+        tile.x1 = std::min(x + kTileSize, x1);
+        tile.y0 = y;
+        tile.y1 = std::min(y + kTileSize, y1);
+        tiles.push_back(tile);
+      }
+    }
+  }
+
+  boost::atomic<size_t> next(0);
+  struct Worker
+  {
+    static void run(const std::vector<std::vector<Primitive> > *primitives,
+                    const Grid *grid, std::vector<Tile> *tiles,
+                    boost::atomic<size_t> *next)
+    {
+      ThreadPolicy::instance().apply("compute", "gzros_raster");
+      for (size_t t = (*next)++; t < tiles->size(); t = (*next)++)
+        rasterizeTile((*primitives)[(*tiles)[t].model], *grid, (*tiles)[t]);
+    }
+  };
+  unsigned int threads = std::min<size_t>(
+    std::max(1u, boost::thread::hardware_concurrency()), tiles.size());
+  if (threads > 1)
+  {
+    boost::thread_group group;
+    for (unsigned int i = 0; i < threads; ++i)
+      group.create_thread(boost::bind(&Worker::run, &dirty_primitives, &grid, &tiles, &next));
+    group.join_all();
+  }
+  else
+    Worker::run(&dirty_primitives, &grid, &tiles, &next);
+
+  for (size_t t = 0; t < tiles.size(); ++t)
+  {
+    std::vector<uint32_t> &model_voxels = dirty[tiles[t].model]->voxels;
+    model_voxels.insert(model_voxels.end(), tiles[t].voxels.begin(), tiles[t].voxels.end());
+  }
+
+  voxels.assign(static_cast<size_t>(grid.size_x) * grid.size_y * grid.size_z, 0);
+  for (size_t e = 0; e < entries.size(); ++e)
+  {
+    const std::vector<uint32_t> &model_voxels = entries[e]->voxels;
+    for (size_t v = 0; v < model_voxels.size(); ++v)
+      voxels[model_voxels[v]] = 1;
+  }
+}
+
+}
@@ -0,0 +1,383 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <dirent.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#include <tinyxml.h>
+
+#include <ros/console.h>
+
+#include <gazebo_ros/package_exports.h>
+
+namespace gazebo
+{
+
+namespace
+{
+const char *const CACHE_VERSION = "gazebo_ros_paths_cache 1";
+
+/// \brief Crawl depth limit, against symbolic link loops
+const int MAX_DEPTH = 100;
+
+bool exists(const std::string &path)
+{
+  struct stat st;
+  return ::stat(path.c_str(), &st) == 0;
+}
+
+/// \brief Text of a child element, empty if there is none
+std::string childText(TiXmlElement *parent, const char *name)
+{
+  TiXmlElement *child = parent->FirstChildElement(name);
+  if (!child || !child->GetText())
+    return std::string();
+  std::string text = child->GetText();
+  size_t begin = text.find_first_not_of(" \t\r\n");
+  size_t end = text.find_last_not_of(" \t\r\n");
+  return begin == std::string::npos ? std::string() : text.substr(begin, end - begin + 1);
+}
+}
+
+PackageExports::PackageExports(const std::string &package,
+                               const std::vector<std::string> &attributes)
+  : package_(package), attributes_(attributes), from_cache_(false)
+{
+}
+
+bool PackageExports::load(const std::string &cache_file)
+{
+  const char *env = getenv("ROS_PACKAGE_PATH");
+  package_path_env_ = env ? env : "";
+  if (package_path_env_.empty())
+    return false;
+
+  if (!cache_file.empty() && readCache(cache_file))
+  {
+    from_cache_ = true;
+    return true;
+  }
+
+  if (!crawl())
+    return false;
+  if (!cache_file.empty())
+    writeCache(cache_file);
+  return true;
+}
+
+const std::vector<std::string> &PackageExports::values(const std::string &attribute) const
+{
+  static const std::vector<std::string> none;
+  std::map<std::string, std::vector<std::string> >::const_iterator it = values_.find(attribute);
+  return it == values_.end() ? none : it->second;
+}
+
+const std::string &PackageExports::path() const
+{
+  return path_;
+}
+
+bool PackageExports::fromCache() const
+{
+  return from_cache_;
+}
+
+std::string PackageExports::defaultCacheFile()
+{
+  const char *file = getenv("GAZEBO_ROS_PATHS_CACHE");
+  if (file)
+    return file;
+
+  const char *ros_home = getenv("ROS_HOME");
+  if (ros_home && *ros_home)
+    return std::string(ros_home) + "/gazebo_ros_paths_cache";
+  const char *home = getenv("HOME");
+  if (home && *home)
+    return std::string(home) + "/.ros/gazebo_ros_paths_cache";
+  return std::string();
+}
+
+bool PackageExports::crawl()
+{
+  path_.clear();
+  values_.clear();
+  stamps_.clear();
+
+  std::set<std::string> names;
+  std::istringstream entries(package_path_env_);
+  std::string entry;
+  while (std::getline(entries, entry, ':'))
+  {
+    if (entry.empty())
+      continue;
+    // a missing entry is stamped too, creating it changes the result
+    if (!stamp(entry))
+    {
+      Stamp missing = {entry, -1, 0};
+      stamps_.push_back(missing);
+      continue;
+    }
+    crawlDirectory(entry, names, 0);
+  }
+
+  if (path_.empty())
+  {
+    ROS_DEBUG_NAMED("paths_plugin", "Package %s is not in ROS_PACKAGE_PATH", package_.c_str());
+    return false;
+  }
+  return true;
+}
+
+void PackageExports::crawlDirectory(const std::string &dir, std::set<std::string> &names,
+                                    int depth)
+{
+  if (depth > MAX_DEPTH)
+    return;
+
+  // same rules as rospack: a package is not searched further, CATKIN_IGNORE
+  // hides a directory and rospack_nosubdirs its subdirectories
+  if (exists(dir + "/CATKIN_IGNORE"))
+    return;
+  const std::string manifest = dir + "/package.xml";
+  if (exists(manifest))
+  {
+    readManifest(dir, manifest, names);
+    return;
+  }
+  if (exists(dir + "/rospack_nosubdirs"))
+    return;
+
+  DIR *handle = opendir(dir.c_str());
+  if (!handle)
+    return;
+  std::vector<std::string> children;
+  while (struct dirent *child = readdir(handle))
+  {
+    if (child->d_name[0] == '.')
+      continue;
+    std::string path = dir + "/" + child->d_name;
+    struct stat st;
+    if (::stat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode))
+      children.push_back(path);
+  }
+  closedir(handle);
+
+  // readdir order is arbitrary, keep the result stable
+  std::sort(children.begin(), children.end());
+  for (size_t i = 0; i < children.size(); ++i)
+  {
+    stamp(children[i]);
+    crawlDirectory(children[i], names, depth + 1);
+  }
+}
+
+void PackageExports::readManifest(const std::string &dir, const std::string &manifest,
+                                  std::set<std::string> &names)
+{
+  stamp(manifest);
+
+  TiXmlDocument doc;
+  if (!doc.LoadFile(manifest))
+  {
+    ROS_DEBUG_NAMED("paths_plugin", "Cannot parse %s: %s", manifest.c_str(), doc.ErrorDesc());
+    return;
+  }
+  TiXmlElement *root = doc.RootElement();
+  if (!root || std::string(root->Value()) != "package")
+    return;
+
+  std::string name = childText(root, "name");
+  if (name.empty() || !names.insert(name).second)
+    return;
+
+  bool is_package = name == package_;
+  if (is_package)
+    path_ = dir;
+
+  // the package itself and its direct dependents, as for rospack plugins
+  bool depends = is_package;
+  static const char *const tags[] = {"depend", "build_depend", "build_export_depend",
+                                     "exec_depend", "run_depend"};
+  for (size_t t = 0; !depends && t < sizeof(tags) / sizeof(tags[0]); ++t)
+  {
+    for (TiXmlElement *dep = root->FirstChildElement(tags[t]); dep && !depends;
+         dep = dep->NextSiblingElement(tags[t]))
+      depends = dep->GetText() && std::string(dep->GetText()) == package_;
+  }
+  if (!depends)
+    return;
+
+  TiXmlElement *exp = root->FirstChildElement("export");
+  if (!exp)
+    return;
+  for (TiXmlElement *elem = exp->FirstChildElement(package_); elem;
+       elem = elem->NextSiblingElement(package_))
+  {
+    for (size_t a = 0; a < attributes_.size(); ++a)
+    {
+      const char *value = elem->Attribute(attributes_[a].c_str());
+      if (!value)
+        continue;
+      std::string resolved = value;
+      size_t pos;
+      while ((pos = resolved.find("${prefix}")) != std::string::npos)
+        resolved.replace(pos, 9, dir);
+      values_[attributes_[a]].push_back(resolved);
+    }
+  }
+}
+
+bool PackageExports::stamp(const std::string &path)
+{
+  struct stat st;
+  if (::stat(path.c_str(), &st) != 0)
+    return false;
+  Stamp s;
+  s.path = path;
+  s.sec = st.st_mtime;
+#ifdef __APPLE__
+  s.nsec = st.st_mtimespec.tv_nsec;
+#else
+  s.nsec = st.st_mtim.tv_nsec;
+#endif
+  stamps_.push_back(s);
+  return true;
+}
+
+bool PackageExports::readCache(const std::string &file)
+{
+  std::ifstream in(file.c_str());
+  if (!in)
+    return false;
+
+  std::string line;
+  if (!std::getline(in, line) || line != CACHE_VERSION)
+    return false;
+  if (!std::getline(in, line) || line != "package " + package_)
+    return false;
+  if (!std::getline(in, line) || line != "env " + package_path_env_)
+    return false;
+  std::string attributes = "attributes";
+  for (size_t a = 0; a < attributes_.size(); ++a)
+    attributes += " " + attributes_[a];
+  if (!std::getline(in, line) || line != attributes)
+    return false;
+  if (!std::getline(in, line) || line.compare(0, 5, "path ") != 0)
+    return false;
+  std::string path = line.substr(5);
+
+  std::map<std::string, std::vector<std::string> > values;
+  while (std::getline(in, line))
+  {
+    std::istringstream fields(line);
+    std::string kind;
+    fields >> kind;
+    if (kind == "stamp")
+    {
+      long long sec = 0;
+      long nsec = 0;
+      std::string stamped;
+      fields >> sec >> nsec;
+      std::getline(fields >> std::ws, stamped);
+      if (stamped.empty())
+        return false;
+
+      // any change invalidates the whole cache
+      struct stat st;
+      if (::stat(stamped.c_str(), &st) != 0)
+      {
+        if (sec != -1)
+          return false;
+        continue;
+      }
+#ifdef __APPLE__
+      long current_nsec = st.st_mtimespec.tv_nsec;
+#else
+      long current_nsec = st.st_mtim.tv_nsec;
+#endif
+      if (sec != static_cast<long long>(st.st_mtime) || nsec != current_nsec)
+        return false;
+    }
+    else if (kind == "value")
+    {
+      std::string attribute, value;
+      fields >> attribute;
+      std::getline(fields >> std::ws, value);
+      values[attribute].push_back(value);
+    }
+    else if (kind == "end")
+    {
+      path_ = path;
+      values_.swap(values);
+      return true;
+    }
+    else
+      return false;
+  }
+  // truncated
+  return false;
+}
+
+void PackageExports::writeCache(const std::string &file) const
+{
+  // written next to the cache file and renamed over it, so a concurrent
+  // server reads either the old or the new one
+  std::ostringstream tmp_name;
+  tmp_name << file << "." << getpid() << ".tmp";
+  const std::string tmp = tmp_name.str();
+  {
+    std::ofstream out(tmp.c_str());
+    if (!out)
+    {
+      ROS_DEBUG_NAMED("paths_plugin", "Cannot write package export cache %s", tmp.c_str());
+      return;
+    }
+    out << CACHE_VERSION << "\n";
+    out << "package " << package_ << "\n";
+    out << "env " << package_path_env_ << "\n";
+    out << "attributes";
+    for (size_t a = 0; a < attributes_.size(); ++a)
+      out << " " << attributes_[a];
+    out << "\n";
+    out << "path " << path_ << "\n";
+    for (size_t i = 0; i < stamps_.size(); ++i)
+      out << "stamp " << stamps_[i].sec << " " << stamps_[i].nsec << " " << stamps_[i].path << "\n";
+    for (size_t a = 0; a < attributes_.size(); ++a)
+    {
+      const std::vector<std::string> &v = values(attributes_[a]);
+      for (size_t i = 0; i < v.size(); ++i)
+        out << "value " << attributes_[a] << " " << v[i] << "\n";
+    }
+    out << "end\n";
+    if (!out)
+    {
+      std::remove(tmp.c_str());
+      return;
+    }
+  }
+  if (std::rename(tmp.c_str(), file.c_str()) != 0)
+    std::remove(tmp.c_str());
+}
+
+}
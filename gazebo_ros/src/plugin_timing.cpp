@@ -0,0 +1,91 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+
+#include <gazebo_ros/plugin_timing.h>
+
+namespace gazebo
+{
+
+TimingStage::TimingStage(const std::string &_plugin, const std::string &_stage) :
+  plugin(_plugin),
+  stage(_stage),
+  count(0),
+  total_nsec(0),
+  max_nsec(0)
+{
+  for (unsigned int i = 0; i < BUCKETS; ++i)
+    histogram[i] = 0;
+}
+
+void TimingStage::record(int64_t nsec)
+{
+  const uint64_t duration = nsec > 0 ? nsec : 0;
+  count.fetch_add(1, std::memory_order_relaxed);
+  total_nsec.fetch_add(duration, std::memory_order_relaxed);
+
+  uint64_t max = max_nsec.load(std::memory_order_relaxed);
+  while (duration > max &&
+         !max_nsec.compare_exchange_weak(max, duration, std::memory_order_relaxed))
+  {
+  }
+
+  unsigned int bucket = 0;
+  for (uint64_t usec = duration / 1000; usec > 0 && bucket < BUCKETS - 1; usec >>= 1)
+    ++bucket;
+  histogram[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+TimingRegistry &TimingRegistry::instance()
+{
+  static TimingRegistry registry;
+  return registry;
+}
+
+TimingStage *TimingRegistry::stage(const std::string &plugin, const std::string &stage)
+{
+  boost::mutex::scoped_lock lock(mutex_);
+  for (std::deque<TimingStage>::iterator it = stages_.begin(); it != stages_.end(); ++it)
+  {
+    if (it->plugin == plugin && it->stage == stage)
+      return &*it;
+  }
+  // a deque never moves its elements on emplace_back
+  stages_.emplace_back(plugin, stage);
+  return &stages_.back();
+}
+
+void TimingRegistry::stats(std::vector<TimingStats> &stats)
+{
+  boost::mutex::scoped_lock lock(mutex_);
+  stats.resize(stages_.size());
+  for (size_t i = 0; i < stages_.size(); ++i)
+  {
+    const TimingStage &stage = stages_[i];
+    TimingStats &s = stats[i];
+    s.plugin = stage.plugin;
+    s.stage = stage.stage;
+    s.count = stage.count.load(std::memory_order_relaxed);
+    s.total_nsec = stage.total_nsec.load(std::memory_order_relaxed);
+    s.max_nsec = stage.max_nsec.load(std::memory_order_relaxed);
+    s.histogram.resize(TimingStage::BUCKETS);
+    for (unsigned int j = 0; j < TimingStage::BUCKETS; ++j)
+      s.histogram[j] = stage.histogram[j].load(std::memory_order_relaxed);
+  }
+}
+
+}
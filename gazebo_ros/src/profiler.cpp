@@ -0,0 +1,236 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+
+#include <stdio.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <ros/console.h>
+
+#include <gazebo_ros/profiler.h>
+
+namespace gazebo
+{
+
+namespace
+{
+
+/// \brief Samples of one thread, kept after the thread ends until written
+struct ThreadTrace
+{
+  struct Event
+  {
+    const char *name;
+    int64_t start_usec;
+    int64_t duration_usec;
+  };
+
+  boost::mutex mutex;
+  unsigned int tid;
+  std::vector<Event> events;
+  std::vector<Event> open;
+  unsigned long dropped;
+};
+
+/// \brief Events a thread keeps before dropping more, bounding the memory
+/// of a forgotten trace
+const size_t MAX_EVENTS_PER_THREAD = 1000000;
+
+boost::mutex g_mutex;
+std::string g_trace_file;
+std::vector<boost::shared_ptr<ThreadTrace> > g_threads;
+std::atomic<bool> g_collect(false);
+std::atomic<Profiler::BeginSink> g_begin_sink(NULL);
+std::atomic<Profiler::EndSink> g_end_sink(NULL);
+const std::chrono::steady_clock::time_point g_epoch = std::chrono::steady_clock::now();
+
+int64_t nowUsec()
+{
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+    std::chrono::steady_clock::now() - g_epoch).count();
+}
+
+ThreadTrace &threadTrace()
+{
+  thread_local boost::shared_ptr<ThreadTrace> trace;
+  if (!trace)
+  {
+    trace.reset(new ThreadTrace());
+    trace->dropped = 0;
+    boost::mutex::scoped_lock lock(g_mutex);
+    trace->tid = g_threads.size() + 1;
+    g_threads.push_back(trace);
+  }
+  return *trace;
+}
+
+/// \brief JSON string of a sample name
+void writeName(FILE *file, const char *name)
+{
+  fputc('"', file);
+  for (const char *c = name; *c; ++c)
+  {
+    if (*c == '"' || *c == '\\')
+      fputc('\\', file);
+    if (static_cast<unsigned char>(*c) >= 0x20)
+      fputc(*c, file);
+  }
+  fputc('"', file);
+}
+
+}
+
+std::atomic<bool> Profiler::enabled_(false);
+thread_local unsigned int Profiler::open_samples_ = 0;
+
+Profiler::Profiler()
+{
+}
+
+Profiler &Profiler::instance()
+{
+  static Profiler profiler;
+  return profiler;
+}
+
+void Profiler::setEnabled(bool enabled)
+{
+  const bool was_enabled = enabled_.exchange(enabled);
+  if (!was_enabled || enabled)
+    return;
+
+  {
+    boost::mutex::scoped_lock lock(g_mutex);
+    if (g_trace_file.empty())
+      return;
+  }
+  std::string error;
+  if (!writeTrace(error))
+    ROS_ERROR_NAMED("profiler", "Profile trace not written: %s", error.c_str());
+}
+
+void Profiler::setTraceFile(const std::string &path)
+{
+  boost::mutex::scoped_lock lock(g_mutex);
+  g_trace_file = path;
+  g_collect = !path.empty();
+}
+
+bool Profiler::writeTrace(std::string &error)
+{
+  boost::mutex::scoped_lock lock(g_mutex);
+  if (g_trace_file.empty())
+  {
+    error = "no trace file set";
+    return false;
+  }
+  FILE *file = fopen(g_trace_file.c_str(), "w");
+  if (!file)
+  {
+    error = "unable to open " + g_trace_file + ": " + strerror(errno);
+    return false;
+  }
+
+  const int pid = getpid();
+  bool first = true;
+  unsigned long dropped = 0;
+  fputs("{\"traceEvents\":[", file);
+  for (size_t i = 0; i < g_threads.size(); ++i)
+  {
+    ThreadTrace &trace = *g_threads[i];
+    boost::mutex::scoped_lock trace_lock(trace.mutex);
+    for (size_t j = 0; j < trace.events.size(); ++j)
+    {
+      const ThreadTrace::Event &event = trace.events[j];
+      fputs(first ? "\n" : ",\n", file);
+      first = false;
+      fputs("{\"name\":", file);
+      writeName(file, event.name);
+      fprintf(file, ",\"ph\":\"X\",\"pid\":%d,\"tid\":%u,\"ts\":%lld,\"dur\":%lld}",
+              pid, trace.tid, static_cast<long long>(event.start_usec),
+              static_cast<long long>(event.duration_usec));
+    }
+    dropped += trace.dropped;
+    trace.events.clear();
+    trace.dropped = 0;
+  }
+  fputs("\n]}\n", file);
+  const bool ok = fclose(file) == 0;
+  if (!ok)
+    error = "unable to write " + g_trace_file;
+  else
+    ROS_INFO_NAMED("profiler", "Wrote profile trace to %s", g_trace_file.c_str());
+  if (dropped > 0)
+    ROS_WARN_NAMED("profiler", "%lu samples beyond the per thread limit were dropped", dropped);
+  return ok;
+}
+
+void Profiler::setSink(BeginSink begin, EndSink end)
+{
+  g_begin_sink = begin;
+  g_end_sink = end;
+}
+
+void Profiler::begin(const char *name)
+{
+  ++open_samples_;
+  BeginSink sink = g_begin_sink.load(std::memory_order_relaxed);
+  if (sink)
+    sink(name);
+  if (!g_collect.load(std::memory_order_relaxed))
+    return;
+
+  ThreadTrace &trace = threadTrace();
+  ThreadTrace::Event event = {name, nowUsec(), 0};
+  boost::mutex::scoped_lock lock(trace.mutex);
+  trace.open.push_back(event);
+}
+
+void Profiler::end()
+{
+  if (open_samples_ == 0)
+    return;
+  --open_samples_;
+  EndSink sink = g_end_sink.load(std::memory_order_relaxed);
+  if (sink)
+    sink();
+  if (!g_collect.load(std::memory_order_relaxed))
+    return;
+
+  ThreadTrace &trace = threadTrace();
+  const int64_t now = nowUsec();
+  boost::mutex::scoped_lock lock(trace.mutex);
+  // the sample was opened before the trace file was set
+  if (trace.open.size() > open_samples_)
+  {
+    ThreadTrace::Event event = trace.open.back();
+    trace.open.pop_back();
+    event.duration_usec = now - event.start_usec;
+    if (trace.events.size() < MAX_EVENTS_PER_THREAD)
+      trace.events.push_back(event);
+    else
+      ++trace.dropped;
+  }
+}
+
+}
@@ -0,0 +1,251 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <map>
+
+#include <gazebo/gazebo_config.h>
+#include <gazebo_ros/relative_states_publisher.h>
+#include <gazebo_ros/thread_policy.h>
+
+namespace gazebo
+{
+
+RelativeStatesPublisher::RelativeStatesPublisher(gazebo::physics::WorldPtr world, double rate) :
+  world_(world),
+  period_(rate > 0 ? 1.0/rate : 0),
+  captured_(false),
+  back_(&buffers_[0]),
+  ready_(&buffers_[1]),
+  front_(&buffers_[2]),
+  pending_(false),
+  stop_(false),
+  layout_(new Layout())
+{
+  TimingRegistry &registry = TimingRegistry::instance();
+  capture_timing_ = registry.stage("gazebo_ros_api_plugin", "relative_states capture");
+  convert_timing_ = registry.stage("gazebo_ros_api_plugin", "relative_states convert");
+  publish_timing_ = registry.stage("gazebo_ros_api_plugin", "relative_states publish");
+  worker_ = boost::thread(boost::bind(&RelativeStatesPublisher::workerThread, this));
+}
+
+RelativeStatesPublisher::~RelativeStatesPublisher()
+{
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    stop_ = true;
+  }
+  cond_.notify_one();
+  worker_.join();
+}
+
+void RelativeStatesPublisher::setPublisher(const ros::Publisher &pub)
+{
+  boost::mutex::scoped_lock lock(mutex_);
+  pub_ = pub;
+}
+
+void RelativeStatesPublisher::setPairs(const std::vector<Pair> &pairs, bool append)
+{
+  // held throughout so that two appends do not lose one, capture() only
+  // waits for it when pairs are registered
+  boost::mutex::scoped_lock lock(mutex_);
+  boost::shared_ptr<Layout> layout(append ? new Layout(*layout_) : new Layout());
+  // the distinct entities, an entity deleted since is not shared any more
+  std::map<const gazebo::physics::Entity *, int> index;
+  for (size_t i = 0; i < layout->entities.size(); ++i)
+  {
+    gazebo::physics::EntityPtr entity = layout->entities[i].lock();
+    if (entity)
+      index[entity.get()] = i;
+  }
+  for (size_t i = 0; i < pairs.size(); ++i)
+  {
+    const gazebo::physics::EntityPtr *entities[2] = { &pairs[i].entity, &pairs[i].frame };
+    int ids[2] = { -1, -1 };
+    for (int k = 0; k < 2; ++k)
+    {
+      if (!*entities[k])
+        continue;
+      std::map<const gazebo::physics::Entity *, int>::iterator it = index.find(entities[k]->get());
+      if (it == index.end())
+      {
+        it = index.insert(std::make_pair(entities[k]->get(),
+                                         static_cast<int>(layout->entities.size()))).first;
+        layout->entities.push_back(*entities[k]);
+      }
+      ids[k] = it->second;
+    }
+    layout->entity.push_back(ids[0]);
+    layout->frame.push_back(ids[1]);
+    layout->names.entity_name.push_back(pairs[i].entity_name);
+    layout->names.reference_frame.push_back(pairs[i].reference_frame);
+  }
+
+  layout_ = layout;
+}
+
+size_t RelativeStatesPublisher::size()
+{
+  boost::mutex::scoped_lock lock(mutex_);
+  return layout_->entity.size();
+}
+
+void RelativeStatesPublisher::capture()
+{
+  LayoutPtr layout;
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    layout = layout_;
+  }
+  if (layout->entity.empty())
+    return;
+
+#if GAZEBO_MAJOR_VERSION >= 8
+  gazebo::common::Time sim_time = world_->SimTime();
+#else
+  gazebo::common::Time sim_time = world_->GetSimTime();
+#endif
+  // a world reset takes sim time back
+  if (captured_ && sim_time < last_capture_time_)
+    last_capture_time_ = sim_time;
+  if (captured_ && period_ > 0 && (sim_time - last_capture_time_).Double() < period_)
+    return;
+  captured_ = true;
+  last_capture_time_ = sim_time;
+
+  GAZEBO_ROS_PROFILE("RelativeStatesPublisher::capture");
+  ScopedTiming timing(capture_timing_);
+
+  const size_t n = layout->entities.size();
+  Snapshot &snapshot = *back_;
+  snapshot.stamp = sim_time;
+  snapshot.layout = layout;
+  snapshot.valid.resize(n);
+  snapshot.pose.resize(n);
+  snapshot.linear_vel.resize(n);
+  snapshot.angular_vel.resize(n);
+  for (size_t i = 0; i < n; ++i)
+  {
+    gazebo::physics::EntityPtr entity = layout->entities[i].lock();
+    snapshot.valid[i] = entity ? 1 : 0;
+    if (!entity)
+      continue;
+#if GAZEBO_MAJOR_VERSION >= 8
+    snapshot.pose[i] = entity->WorldPose();
+    snapshot.linear_vel[i] = entity->WorldLinearVel();
+    snapshot.angular_vel[i] = entity->WorldAngularVel();
+#else
+    snapshot.pose[i] = entity->GetWorldPose().Ign();
+    snapshot.linear_vel[i] = entity->GetWorldLinearVel().Ign();
+    snapshot.angular_vel[i] = entity->GetWorldAngularVel().Ign();
+#endif
+  }
+
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    std::swap(back_, ready_);
+    pending_ = true;
+  }
+  cond_.notify_one();
+}
+
+void RelativeStatesPublisher::fillMessage(const Snapshot &snapshot)
+{
+  const Layout &layout = *snapshot.layout;
+  if (snapshot.layout != msg_layout_)
+  {
+    msg_.entity_name = layout.names.entity_name;
+    msg_.reference_frame = layout.names.reference_frame;
+    msg_layout_ = snapshot.layout;
+  }
+  msg_.header.stamp.sec = snapshot.stamp.sec;
+  msg_.header.stamp.nsec = snapshot.stamp.nsec;
+
+  const size_t n = layout.entity.size();
+  msg_.pose.resize(n);
+  msg_.twist.resize(n);
+  msg_.valid.resize(n);
+  for (size_t i = 0; i < n; ++i)
+  {
+    const int e = layout.entity[i];
+    const int f = layout.frame[i];
+    const bool valid = snapshot.valid[e] && (f < 0 || snapshot.valid[f]);
+    msg_.valid[i] = valid;
+    if (!valid)
+      continue;
+
+    ignition::math::Pose3d pose = snapshot.pose[e];
+    ignition::math::Vector3d linear_vel = snapshot.linear_vel[e];
+    ignition::math::Vector3d angular_vel = snapshot.angular_vel[e];
+    // as getModelState and getLinkState convert them
+    if (f >= 0)
+    {
+      const ignition::math::Quaterniond &frame_rot = snapshot.pose[f].Rot();
+      pose = pose - snapshot.pose[f];
+      linear_vel = frame_rot.RotateVectorReverse(linear_vel - snapshot.linear_vel[f]);
+      angular_vel = frame_rot.RotateVectorReverse(angular_vel - snapshot.angular_vel[f]);
+    }
+
+    geometry_msgs::Pose &out = msg_.pose[i];
+    out.position.x = pose.Pos().X();
+    out.position.y = pose.Pos().Y();
+    out.position.z = pose.Pos().Z();
+    out.orientation.w = pose.Rot().W();
+    out.orientation.x = pose.Rot().X();
+    out.orientation.y = pose.Rot().Y();
+    out.orientation.z = pose.Rot().Z();
+    geometry_msgs::Twist &twist = msg_.twist[i];
+    twist.linear.x = linear_vel.X();
+    twist.linear.y = linear_vel.Y();
+    twist.linear.z = linear_vel.Z();
+    twist.angular.x = angular_vel.X();
+    twist.angular.y = angular_vel.Y();
+    twist.angular.z = angular_vel.Z();
+  }
+}
+
+void RelativeStatesPublisher::workerThread()
+{
+  ThreadPolicy::instance().apply("publishing", "gzros_relative");
+  for (;;)
+  {
+    ros::Publisher pub;
+    {
+      boost::mutex::scoped_lock lock(mutex_);
+      while (!pending_ && !stop_)
+        cond_.wait(lock);
+      if (stop_)
+        return;
+      std::swap(ready_, front_);
+      pending_ = false;
+      pub = pub_;
+    }
+
+    if (!pub || pub.getNumSubscribers() == 0)
+      continue;
+
+    GAZEBO_ROS_PROFILE("RelativeStatesPublisher::publish");
+    {
+      ScopedTiming timing(convert_timing_);
+      fillMessage(*front_);
+    }
+    ScopedTiming timing(publish_timing_);
+    pub.publish(msg_);
+  }
+}
+
+}
@@ -0,0 +1,119 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+
+#include <gazebo_ros/sensor_buffer_pool.h>
+
+namespace gazebo
+{
+
+SensorBufferPool &SensorBufferPool::instance()
+{
+  static SensorBufferPool pool;
+  return pool;
+}
+
+SensorBufferPool::SensorBufferPool() :
+  pooled_bytes_(0),
+  used_bytes_(0),
+  capacity_(512ul << 20)
+{
+}
+
+void SensorBufferPool::setCapacity(size_t bytes)
+{
+  boost::mutex::scoped_lock lock(mutex_);
+  capacity_ = bytes;
+  trim();
+}
+
+void SensorBufferPool::resize(std::vector<uint8_t> &buffer, size_t size)
+{
+  const size_t before = buffer.capacity();
+  if (size > before)
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    std::list<std::vector<uint8_t> >::iterator best = pooled_.end();
+    for (std::list<std::vector<uint8_t> >::iterator it = pooled_.begin(); it != pooled_.end(); ++it)
+    {
+      if (it->capacity() >= size && (best == pooled_.end() || it->capacity() < best->capacity()))
+        best = it;
+    }
+    if (best != pooled_.end())
+    {
+      // the buffer given up goes to the pool in its place
+      pooled_bytes_ += before;
+      pooled_bytes_ -= best->capacity();
+      buffer.swap(*best);
+      best->clear();
+      if (best->capacity() == 0)
+        pooled_.erase(best);
+      else
+        pooled_.splice(pooled_.end(), pooled_, best);
+    }
+  }
+
+  buffer.resize(size);
+
+  // a vector never shrinks its storage on resize
+  const size_t after = buffer.capacity();
+  if (after > before)
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    used_bytes_ += after - before;
+    trim();
+  }
+}
+
+void SensorBufferPool::release(std::vector<uint8_t> &buffer)
+{
+  const size_t bytes = buffer.capacity();
+  if (bytes == 0)
+    return;
+
+  buffer.clear();
+  boost::mutex::scoped_lock lock(mutex_);
+  // buffers grown outside resize() were not counted
+  used_bytes_ -= std::min(bytes, used_bytes_);
+  pooled_.push_back(std::vector<uint8_t>());
+  pooled_.back().swap(buffer);
+  pooled_bytes_ += bytes;
+  trim();
+}
+
+SensorBufferPool::Usage SensorBufferPool::usage() const
+{
+  boost::mutex::scoped_lock lock(mutex_);
+  Usage usage;
+  usage.used_bytes = used_bytes_;
+  usage.pooled_bytes = pooled_bytes_;
+  usage.pooled_buffers = pooled_.size();
+  usage.capacity_bytes = capacity_;
+  return usage;
+}
+
+void SensorBufferPool::trim()
+{
+  while (!pooled_.empty() && used_bytes_ + pooled_bytes_ > capacity_)
+  {
+    pooled_bytes_ -= pooled_.front().capacity();
+    pooled_.pop_front();
+  }
+}
+
+}
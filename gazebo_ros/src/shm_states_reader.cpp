@@ -0,0 +1,225 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include <gazebo_ros/shm_states_reader.h>
+
+namespace gazebo
+{
+
+int ShmStatesReader::Snapshot::index(const std::string &name) const
+{
+  boost::unordered_map<std::string, int>::const_iterator it = indices.find(name);
+  return it == indices.end() ? -1 : it->second;
+}
+
+ShmStatesReader::ShmStatesReader() :
+  segment_(NULL),
+  size_(0),
+  header_(NULL)
+{
+}
+
+ShmStatesReader::~ShmStatesReader()
+{
+  close();
+}
+
+bool ShmStatesReader::open(const std::string &name)
+{
+  close();
+
+  int fd = shm_open(name.c_str(), O_RDONLY, 0);
+  if (fd < 0)
+    return false;
+  struct stat st;
+  if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(shm_states::Header))
+  {
+    ::close(fd);
+    return false;
+  }
+  void *segment = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (segment == MAP_FAILED)
+    return false;
+
+  const shm_states::Header *header = static_cast<const shm_states::Header *>(segment);
+  const bool valid = header->magic == shm_states::MAGIC;
+  std::atomic_thread_fence(std::memory_order_acquire);
+  if (!valid || header->version != shm_states::VERSION ||
+      shm_states::segmentSize(header->capacity) > static_cast<size_t>(st.st_size))
+  {
+    munmap(segment, st.st_size);
+    return false;
+  }
+
+  segment_ = segment;
+  size_ = st.st_size;
+  header_ = header;
+  return true;
+}
+
+void ShmStatesReader::close()
+{
+  if (!segment_)
+    return;
+  munmap(segment_, size_);
+  segment_ = NULL;
+  header_ = NULL;
+  size_ = 0;
+}
+
+bool ShmStatesReader::isOpen() const
+{
+  return segment_ != NULL;
+}
+
+bool ShmStatesReader::read(Snapshot &snapshot) const
+{
+  if (!header_)
+    return false;
+
+  const char *base = static_cast<const char *>(segment_);
+  const char *names = base + shm_states::namesOffset();
+  const shm_states::State *states =
+    reinterpret_cast<const shm_states::State *>(base + shm_states::statesOffset(header_->capacity));
+
+  // the writer holds the seqlock for microseconds, a few retries do
+  for (int attempt = 0; attempt < 10000; ++attempt)
+  {
+    const uint64_t seq = header_->seq.load(std::memory_order_acquire);
+    if (seq & 1)
+      continue;
+
+    const uint32_t count = std::min(header_->count, header_->capacity);
+    const uint64_t names_version = header_->names_version;
+    snapshot.stamp_sec = header_->stamp_sec;
+    snapshot.stamp_nsec = header_->stamp_nsec;
+    snapshot.states.resize(count);
+    memcpy(snapshot.states.data(), states, count * sizeof(shm_states::State));
+    const bool names_changed = names_version != snapshot.names_version ||
+                               snapshot.names.size() != count;
+    if (names_changed)
+    {
+      snapshot.names.resize(count);
+      for (uint32_t i = 0; i < count; ++i)
+      {
+        const char *name = names + i * shm_states::NAME_SIZE;
+        snapshot.names[i].assign(name, strnlen(name, shm_states::NAME_SIZE));
+      }
+    }
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (header_->seq.load(std::memory_order_relaxed) != seq)
+    {
+      // torn copy, the names are taken again too
+      snapshot.names_version = 0;
+      continue;
+    }
+
+    if (names_changed)
+    {
+      snapshot.names_version = names_version;
+      snapshot.indices.clear();
+      for (uint32_t i = 0; i < count; ++i)
+        snapshot.indices.emplace(snapshot.names[i], i);
+    }
+    return true;
+  }
+  return false;
+}
+
+ShmClockReader::ShmClockReader() :
+  clock_(NULL)
+{
+}
+
+ShmClockReader::~ShmClockReader()
+{
+  close();
+}
+
+bool ShmClockReader::open(const std::string &name)
+{
+  close();
+
+  int fd = shm_open(name.c_str(), O_RDONLY, 0);
+  if (fd < 0)
+    return false;
+  struct stat st;
+  if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(shm_states::Clock))
+  {
+    ::close(fd);
+    return false;
+  }
+  void *segment = mmap(NULL, sizeof(shm_states::Clock), PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (segment == MAP_FAILED)
+    return false;
+
+  const shm_states::Clock *clock = static_cast<const shm_states::Clock *>(segment);
+  const bool valid = clock->magic == shm_states::CLOCK_MAGIC;
+  std::atomic_thread_fence(std::memory_order_acquire);
+  if (!valid || clock->version != shm_states::VERSION)
+  {
+    munmap(segment, sizeof(shm_states::Clock));
+    return false;
+  }
+  clock_ = clock;
+  return true;
+}
+
+void ShmClockReader::close()
+{
+  if (!clock_)
+    return;
+  munmap(const_cast<shm_states::Clock *>(clock_), sizeof(shm_states::Clock));
+  clock_ = NULL;
+}
+
+bool ShmClockReader::isOpen() const
+{
+  return clock_ != NULL;
+}
+
+bool ShmClockReader::read(int32_t &sec, int32_t &nsec, uint64_t &iterations) const
+{
+  if (!clock_)
+    return false;
+  for (int attempt = 0; attempt < 10000; ++attempt)
+  {
+    const uint64_t seq = clock_->seq.load(std::memory_order_acquire);
+    if (seq & 1)
+      continue;
+    sec = clock_->sec;
+    nsec = clock_->nsec;
+    iterations = clock_->iterations;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (clock_->seq.load(std::memory_order_relaxed) == seq)
+      return true;
+  }
+  return false;
+}
+
+}
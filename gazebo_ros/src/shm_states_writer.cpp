@@ -0,0 +1,212 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <new>
+
+#include <ros/ros.h>
+#include <gazebo_ros/shm_states_writer.h>
+
+namespace gazebo
+{
+
+namespace
+{
+
+/// \brief Create and map a segment, null on failure
+void *createSegment(const std::string &name, size_t size)
+{
+  // a stale segment of a crashed server would have the wrong layout
+  shm_unlink(name.c_str());
+  int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+  if (fd < 0)
+  {
+    ROS_ERROR_NAMED("api_plugin", "Unable to create shared memory segment %s: %s", name.c_str(), strerror(errno));
+    return NULL;
+  }
+  if (ftruncate(fd, size) != 0)
+  {
+    ROS_ERROR_NAMED("api_plugin", "Unable to size shared memory segment %s: %s", name.c_str(), strerror(errno));
+    close(fd);
+    shm_unlink(name.c_str());
+    return NULL;
+  }
+  void *segment = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (segment == MAP_FAILED)
+  {
+    ROS_ERROR_NAMED("api_plugin", "Unable to map shared memory segment %s: %s", name.c_str(), strerror(errno));
+    shm_unlink(name.c_str());
+    return NULL;
+  }
+  return segment;
+}
+
+}
+
+ShmStatesWriter::ShmStatesWriter(const std::string &name, unsigned int capacity) :
+  name_(name),
+  capacity_(capacity),
+  size_(shm_states::segmentSize(capacity)),
+  segment_(NULL),
+  header_(NULL),
+  names_(NULL),
+  states_(NULL),
+  warned_(false)
+{
+  void *segment = createSegment(name_, size_);
+  if (!segment)
+    return;
+
+  segment_ = segment;
+  char *base = static_cast<char *>(segment_);
+  header_ = new (base) shm_states::Header();
+  names_ = base + shm_states::namesOffset();
+  states_ = reinterpret_cast<shm_states::State *>(base + shm_states::statesOffset(capacity_));
+  header_->capacity = capacity_;
+  header_->count = 0;
+  header_->seq.store(0);
+  header_->names_version = 0;
+  header_->stamp_sec = 0;
+  header_->stamp_nsec = 0;
+  header_->version = shm_states::VERSION;
+  // readers check the magic last
+  std::atomic_thread_fence(std::memory_order_release);
+  header_->magic = shm_states::MAGIC;
+}
+
+ShmStatesWriter::~ShmStatesWriter()
+{
+  if (!segment_)
+    return;
+  munmap(segment_, size_);
+  shm_unlink(name_.c_str());
+}
+
+bool ShmStatesWriter::isOpen() const
+{
+  return segment_ != NULL;
+}
+
+void ShmStatesWriter::write(const gazebo::common::Time &stamp,
+                            const boost::shared_ptr<const std::vector<std::string> > &names,
+                            const std::vector<ignition::math::Pose3d> &pose,
+                            const std::vector<ignition::math::Vector3d> &linear_vel,
+                            const std::vector<ignition::math::Vector3d> &angular_vel)
+{
+  if (!segment_)
+    return;
+
+  size_t count = pose.size();
+  if (count > capacity_)
+  {
+    if (!warned_)
+      ROS_WARN_NAMED("api_plugin", "Shared memory segment %s holds %u entities, %lu left out",
+                     name_.c_str(), capacity_, static_cast<unsigned long>(count - capacity_));
+    warned_ = true;
+    count = capacity_;
+  }
+
+  const uint64_t seq = header_->seq.load(std::memory_order_relaxed);
+  header_->seq.store(seq + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  if (names != written_names_)
+  {
+    for (size_t i = 0; i < count; ++i)
+    {
+      char *name = names_ + i * shm_states::NAME_SIZE;
+      strncpy(name, (*names)[i].c_str(), shm_states::NAME_SIZE - 1);
+      name[shm_states::NAME_SIZE - 1] = '\0';
+    }
+    ++header_->names_version;
+    written_names_ = names;
+  }
+
+  header_->count = count;
+  header_->stamp_sec = stamp.sec;
+  header_->stamp_nsec = stamp.nsec;
+  for (size_t i = 0; i < count; ++i)
+  {
+    shm_states::State &state = states_[i];
+    state.pose[0] = pose[i].Pos().X();
+    state.pose[1] = pose[i].Pos().Y();
+    state.pose[2] = pose[i].Pos().Z();
+    state.pose[3] = pose[i].Rot().X();
+    state.pose[4] = pose[i].Rot().Y();
+    state.pose[5] = pose[i].Rot().Z();
+    state.pose[6] = pose[i].Rot().W();
+    state.twist[0] = linear_vel[i].X();
+    state.twist[1] = linear_vel[i].Y();
+    state.twist[2] = linear_vel[i].Z();
+    state.twist[3] = angular_vel[i].X();
+    state.twist[4] = angular_vel[i].Y();
+    state.twist[5] = angular_vel[i].Z();
+  }
+
+  header_->seq.store(seq + 2, std::memory_order_release);
+}
+
+ShmClockWriter::ShmClockWriter(const std::string &name) :
+  name_(name),
+  clock_(NULL)
+{
+  void *segment = createSegment(name_, sizeof(shm_states::Clock));
+  if (!segment)
+    return;
+
+  clock_ = new (segment) shm_states::Clock();
+  clock_->seq.store(0);
+  clock_->sec = 0;
+  clock_->nsec = 0;
+  clock_->iterations = 0;
+  clock_->version = shm_states::VERSION;
+  std::atomic_thread_fence(std::memory_order_release);
+  clock_->magic = shm_states::CLOCK_MAGIC;
+}
+
+ShmClockWriter::~ShmClockWriter()
+{
+  if (!clock_)
+    return;
+  munmap(clock_, sizeof(shm_states::Clock));
+  shm_unlink(name_.c_str());
+}
+
+bool ShmClockWriter::isOpen() const
+{
+  return clock_ != NULL;
+}
+
+void ShmClockWriter::write(const gazebo::common::Time &time, uint64_t iterations)
+{
+  if (!clock_)
+    return;
+  const uint64_t seq = clock_->seq.load(std::memory_order_relaxed);
+  clock_->seq.store(seq + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  clock_->sec = time.sec;
+  clock_->nsec = time.nsec;
+  clock_->iterations = iterations;
+  clock_->seq.store(seq + 2, std::memory_order_release);
+}
+
+}
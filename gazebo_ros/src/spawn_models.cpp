@@ -0,0 +1,696 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+/* Desc: spawn many models in gazebo from one process, with one service
+ *       call if the spawn_models service is available
+ *
+ * Takes the arguments of spawn_model, where every -model starts a new
+ * model and the options before the first -model apply to all of them:
+ *
+ *   rosrun gazebo_ros spawn_models -file robot.urdf -z 0.1 \
+ *     -model robot_0 -x 0 -robot_namespace robot_0 \
+ *     -model robot_1 -x 2 -robot_namespace robot_1
+ *
+ * and/or a list of models in the ~models parameter, usually loaded from a
+ * YAML manifest with <rosparam>:
+ *
+ *   models:
+ *     - {model: robot_0, file: robot.urdf, x: 0, robot_namespace: robot_0}
+ *     - {model: robot_1, file: robot.urdf, x: 2, joints: {elbow: 0.5}}
+ */
+
+#include <signal.h>
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <tinyxml.h>
+
+#include <ros/ros.h>
+#include <tf/transform_datatypes.h>
+#include <std_srvs/Empty.h>
+#include <gazebo_msgs/DeleteModel.h>
+#include <gazebo_msgs/DeleteModels.h>
+#include <gazebo_msgs/SetModelConfiguration.h>
+#include <gazebo_msgs/SpawnModel.h>
+#include <gazebo_msgs/SpawnModels.h>
+
+namespace
+{
+
+/// \brief Set by SIGINT, which only shuts ROS down once the models of the
+/// bond are deleted
+volatile sig_atomic_t g_interrupted = 0;
+volatile sig_atomic_t g_bond_waiting = 0;
+
+void on_sigint(int)
+{
+  g_interrupted = 1;
+  if (!g_bond_waiting)
+    ros::requestShutdown();
+}
+
+const char MODEL_DATABASE_TEMPLATE[] =
+  "<sdf version=\"1.4\">\n"
+  "    <world name=\"default\">\n"
+  "        <include>\n"
+  "            <uri>model://%s</uri>\n"
+  "        </include>\n"
+  "    </world>\n"
+  "</sdf>";
+
+/// \brief Where the xml of a model comes from and where it goes
+struct ModelSpec
+{
+  ModelSpec() : x(0), y(0), z(0), roll(0), pitch(0), yaw(0) {}
+
+  std::string name;
+  std::string file;
+  std::string param;
+  std::string database;
+  std::string robot_namespace;
+  std::string reference_frame;
+  double x, y, z, roll, pitch, yaw;
+  std::vector<std::string> joint_names;
+  std::vector<double> joint_positions;
+};
+
+void usage()
+{
+  std::cerr <<
+    "usage: spawn_models [global options] -model NAME [model options] [-model NAME ...]\n"
+    "\n"
+    "Spawns all models at once.  Options before the first -model apply to all\n"
+    "models, options after a -model to that model only.  More models are read\n"
+    "from the ~models parameter, a list of dictionaries with the same keys.\n"
+    "\n"
+    "model options:\n"
+    "  -file FILE_NAME             load model xml from file\n"
+    "  -param PARAM_NAME           load model xml from ROS parameter\n"
+    "  -database MODEL_NAME        load model xml from the Gazebo Model Database\n"
+    "  -robot_namespace NAMESPACE  ROS namespace of the gazebo plugins of the model\n"
+    "  -reference_frame FRAME      model/body the initial pose is defined in\n"
+    "  -x -y -z VALUE              initial position, meters\n"
+    "  -R -P -Y VALUE              initial orientation, radians\n"
+    "  -J JOINT_NAME POSITION      initialize the joint at the position\n"
+    "global options:\n"
+    "  -gazebo_namespace NAMESPACE ROS namespace of gazebo, defaults to /gazebo\n"
+    "  -package_to_model           convert <mesh filename=\"package://...\"> to model://\n"
+    "  -timeout SECONDS            wait this long for the gazebo services, default 0 (forever)\n"
+    "  -unpause                    unpause physics after spawning the models\n"
+    "  -b                          delete the models when this program is interrupted\n"
+    "  -urdf -sdf                  ignored, the format is detected\n";
+}
+
+bool parse_double(const std::string &text, double &value)
+{
+  std::istringstream stream(text);
+  stream >> value;
+  return !stream.fail() && stream.eof();
+}
+
+/// \brief Parse the command line into models, the defaults of all models
+/// are the options before the first -model
+bool parse_arguments(const std::vector<std::string> &args, std::vector<ModelSpec> &models,
+                     ModelSpec &defaults, std::string &gazebo_namespace,
+                     bool &package_to_model, double &timeout, bool &unpause, bool &bond)
+{
+  ModelSpec *spec = &defaults;
+  for (size_t i = 0; i < args.size(); ++i)
+  {
+    const std::string &arg = args[i];
+    if (arg == "-urdf" || arg == "-sdf")
+      continue;
+    if (arg == "-package_to_model")
+    {
+      package_to_model = true;
+      continue;
+    }
+    if (arg == "-unpause")
+    {
+      unpause = true;
+      continue;
+    }
+    if (arg == "-b")
+    {
+      bond = true;
+      continue;
+    }
+
+    if (arg == "-J")
+    {
+      double position;
+      if (i + 2 >= args.size() || !parse_double(args[i + 2], position))
+      {
+        ROS_FATAL("-J takes a joint name and a position");
+        return false;
+      }
+      spec->joint_names.push_back(args[i + 1]);
+      spec->joint_positions.push_back(position);
+      i += 2;
+      continue;
+    }
+
+    if (i + 1 >= args.size())
+    {
+      ROS_FATAL("%s takes a value", arg.c_str());
+      return false;
+    }
+    const std::string &value = args[++i];
+    double *number = NULL;
+    if (arg == "-model")
+    {
+      models.push_back(defaults);
+      spec = &models.back();
+      spec->name = value;
+    }
+    else if (arg == "-file")
+    {
+      spec->file = value;
+      spec->param.clear();
+      spec->database.clear();
+    }
+    else if (arg == "-param")
+    {
+      spec->param = value;
+      spec->file.clear();
+      spec->database.clear();
+    }
+    else if (arg == "-database")
+    {
+      spec->database = value;
+      spec->file.clear();
+      spec->param.clear();
+    }
+    else if (arg == "-robot_namespace")
+      spec->robot_namespace = value;
+    else if (arg == "-reference_frame")
+      spec->reference_frame = value;
+    else if (arg == "-gazebo_namespace")
+      gazebo_namespace = value;
+    else if (arg == "-timeout")
+      number = &timeout;
+    else if (arg == "-x")
+      number = &spec->x;
+    else if (arg == "-y")
+      number = &spec->y;
+    else if (arg == "-z")
+      number = &spec->z;
+    else if (arg == "-R")
+      number = &spec->roll;
+    else if (arg == "-P")
+      number = &spec->pitch;
+    else if (arg == "-Y")
+      number = &spec->yaw;
+    else
+    {
+      ROS_FATAL("unknown option %s", arg.c_str());
+      return false;
+    }
+    if (number && !parse_double(value, *number))
+    {
+      ROS_FATAL("%s takes a number, not %s", arg.c_str(), value.c_str());
+      return false;
+    }
+  }
+  return true;
+}
+
+bool xml_string(XmlRpc::XmlRpcValue &value, std::string &text)
+{
+  if (value.getType() != XmlRpc::XmlRpcValue::TypeString)
+    return false;
+  text = static_cast<std::string>(value);
+  return true;
+}
+
+bool xml_double(XmlRpc::XmlRpcValue &value, double &number)
+{
+  if (value.getType() == XmlRpc::XmlRpcValue::TypeDouble)
+    number = static_cast<double>(value);
+  else if (value.getType() == XmlRpc::XmlRpcValue::TypeInt)
+    number = static_cast<int>(value);
+  else
+    return false;
+  return true;
+}
+
+/// \brief Append the models of a manifest loaded on the parameter server
+bool parse_manifest(XmlRpc::XmlRpcValue &manifest, const ModelSpec &defaults,
+                    std::vector<ModelSpec> &models)
+{
+  if (manifest.getType() != XmlRpc::XmlRpcValue::TypeArray)
+  {
+    ROS_FATAL("~models must be a list");
+    return false;
+  }
+  for (int i = 0; i < manifest.size(); ++i)
+  {
+    XmlRpc::XmlRpcValue &entry = manifest[i];
+    if (entry.getType() != XmlRpc::XmlRpcValue::TypeStruct)
+    {
+      ROS_FATAL("~models[%d] must be a dictionary", i);
+      return false;
+    }
+    ModelSpec spec = defaults;
+    for (XmlRpc::XmlRpcValue::iterator it = entry.begin(); it != entry.end(); ++it)
+    {
+      const std::string &key = it->first;
+      XmlRpc::XmlRpcValue &value = it->second;
+      bool ok;
+      if (key == "model")
+        ok = xml_string(value, spec.name);
+      else if (key == "file")
+        ok = xml_string(value, spec.file);
+      else if (key == "param")
+        ok = xml_string(value, spec.param);
+      else if (key == "database")
+        ok = xml_string(value, spec.database);
+      else if (key == "robot_namespace")
+        ok = xml_string(value, spec.robot_namespace);
+      else if (key == "reference_frame")
+        ok = xml_string(value, spec.reference_frame);
+      else if (key == "x")
+        ok = xml_double(value, spec.x);
+      else if (key == "y")
+        ok = xml_double(value, spec.y);
+      else if (key == "z")
+        ok = xml_double(value, spec.z);
+      else if (key == "R")
+        ok = xml_double(value, spec.roll);
+      else if (key == "P")
+        ok = xml_double(value, spec.pitch);
+      else if (key == "Y")
+        ok = xml_double(value, spec.yaw);
+      else if (key == "joints")
+      {
+        ok = value.getType() == XmlRpc::XmlRpcValue::TypeStruct;
+        for (XmlRpc::XmlRpcValue::iterator joint = value.begin(); ok && joint != value.end(); ++joint)
+        {
+          double position;
+          ok = xml_double(joint->second, position);
+          spec.joint_names.push_back(joint->first);
+          spec.joint_positions.push_back(position);
+        }
+      }
+      else
+      {
+        ROS_FATAL("~models[%d] has unknown key %s", i, key.c_str());
+        return false;
+      }
+      if (!ok)
+      {
+        ROS_FATAL("~models[%d] has a bad value for %s", i, key.c_str());
+        return false;
+      }
+    }
+    // a manifest entry names one source, it replaces the default one
+    if (entry.hasMember("file") || entry.hasMember("param") || entry.hasMember("database"))
+    {
+      if (!entry.hasMember("file"))
+        spec.file.clear();
+      if (!entry.hasMember("param"))
+        spec.param.clear();
+      if (!entry.hasMember("database"))
+        spec.database.clear();
+    }
+    models.push_back(spec);
+  }
+  return true;
+}
+
+/// \brief Replace package:// by model:// in the filename of all meshes
+void package_to_model(TiXmlElement *element)
+{
+  for (; element; element = element->NextSiblingElement())
+  {
+    const char *filename = element->Attribute("filename");
+    if (std::string(element->Value()) == "mesh" && filename &&
+        std::string(filename).compare(0, 10, "package://") == 0)
+      element->SetAttribute("filename", ("model://" + std::string(filename + 10)).c_str());
+    package_to_model(element->FirstChildElement());
+  }
+}
+
+/// \brief The xml of a model, read, checked and converted once per source
+bool load_xml(ros::NodeHandle &nh, const ModelSpec &spec, bool convert,
+              std::map<std::string, std::string> &cache, std::string &xml)
+{
+  std::string key;
+  if (!spec.file.empty())
+    key = "file:" + spec.file;
+  else if (!spec.param.empty())
+    key = "param:" + spec.param;
+  else if (!spec.database.empty())
+    key = "database:" + spec.database;
+  else
+  {
+    ROS_FATAL("model %s has no -file, -param or -database", spec.name.c_str());
+    return false;
+  }
+
+  std::map<std::string, std::string>::const_iterator cached = cache.find(key);
+  if (cached != cache.end())
+  {
+    xml = cached->second;
+    return true;
+  }
+
+  if (!spec.file.empty())
+  {
+    std::ifstream file(spec.file.c_str());
+    if (!file)
+    {
+      ROS_FATAL("unable to read file %s", spec.file.c_str());
+      return false;
+    }
+    std::ostringstream content;
+    content << file.rdbuf();
+    xml = content.str();
+  }
+  else if (!spec.param.empty())
+  {
+    if (!nh.getParam(spec.param, xml))
+      xml.clear();
+  }
+  else
+  {
+    std::vector<char> buffer(sizeof(MODEL_DATABASE_TEMPLATE) + spec.database.size());
+    snprintf(&buffer[0], buffer.size(), MODEL_DATABASE_TEMPLATE, spec.database.c_str());
+    xml = &buffer[0];
+  }
+  if (xml.empty())
+  {
+    ROS_FATAL("the xml of model %s is empty", spec.name.c_str());
+    return false;
+  }
+
+  // detect invalid xml before sending it to gazebo
+  TiXmlDocument document;
+  document.Parse(xml.c_str());
+  if (document.Error())
+  {
+    ROS_FATAL("invalid xml for model %s: %s", spec.name.c_str(), document.ErrorDesc());
+    return false;
+  }
+  if (convert)
+  {
+    package_to_model(document.RootElement());
+    TiXmlPrinter printer;
+    document.Accept(&printer);
+    xml = printer.CStr();
+  }
+  cache[key] = xml;
+  return true;
+}
+
+/// \brief Wait for a service, forever if timeout is 0, or until SIGINT
+bool wait_for(const std::string &service, double timeout)
+{
+  ROS_INFO("waiting for service %s", service.c_str());
+  const ros::WallTime end = ros::WallTime::now() + ros::WallDuration(timeout);
+  while (!g_interrupted && ros::ok())
+  {
+    if (ros::service::waitForService(service, ros::Duration(0.5)))
+      return true;
+    if (timeout > 0 && ros::WallTime::now() > end)
+      return false;
+  }
+  return false;
+}
+
+/// \brief Spawn with one spawn_models call
+bool spawn_batch(ros::NodeHandle &nh, const std::string &gazebo_namespace,
+                 const std::vector<ModelSpec> &models, const std::vector<std::string> &xml)
+{
+  gazebo_msgs::SpawnModels srv;
+  bool shared_xml = true;
+  for (size_t i = 0; i < models.size(); ++i)
+  {
+    const ModelSpec &spec = models[i];
+    srv.request.model_name.push_back(spec.name);
+    shared_xml = shared_xml && xml[i] == xml[0];
+    srv.request.robot_namespace.push_back(spec.robot_namespace);
+    srv.request.reference_frame.push_back(spec.reference_frame);
+    geometry_msgs::Pose pose;
+    pose.position.x = spec.x;
+    pose.position.y = spec.y;
+    pose.position.z = spec.z;
+    pose.orientation = tf::createQuaternionMsgFromRollPitchYaw(spec.roll, spec.pitch, spec.yaw);
+    srv.request.initial_pose.push_back(pose);
+  }
+  // the same robot many times is sent once
+  if (shared_xml)
+    srv.request.model_xml.push_back(xml[0]);
+  else
+    srv.request.model_xml = xml;
+
+  ROS_INFO("spawning %zu models", models.size());
+  ros::ServiceClient client = nh.serviceClient<gazebo_msgs::SpawnModels>(gazebo_namespace + "/spawn_models");
+  if (!client.call(srv))
+  {
+    ROS_ERROR("spawn_models service call failed");
+    return false;
+  }
+  for (size_t i = 0; i < models.size() && i < srv.response.model_success.size(); ++i)
+  {
+    if (!srv.response.model_success[i])
+      ROS_ERROR("%s: %s", models[i].name.c_str(), srv.response.model_status_message[i].c_str());
+  }
+  ROS_INFO("%s", srv.response.status_message.c_str());
+  return srv.response.success;
+}
+
+/// \brief Spawn one model after the other, on one persistent connection
+/// per service
+bool spawn_each(ros::NodeHandle &nh, const std::string &gazebo_namespace,
+                const std::vector<ModelSpec> &models, const std::vector<std::string> &xml,
+                double timeout)
+{
+  ros::ServiceClient urdf_client;
+  ros::ServiceClient sdf_client;
+  bool success = true;
+  for (size_t i = 0; i < models.size(); ++i)
+  {
+    const ModelSpec &spec = models[i];
+    // the format of the xml decides the service, as in spawn_model -urdf/-sdf
+    TiXmlDocument document;
+    document.Parse(xml[i].c_str());
+    const bool urdf = document.RootElement() && std::string(document.RootElement()->Value()) == "robot";
+    ros::ServiceClient &client = urdf ? urdf_client : sdf_client;
+    if (!client.isValid())
+    {
+      const std::string service = gazebo_namespace + (urdf ? "/spawn_urdf_model" : "/spawn_sdf_model");
+      if (!wait_for(service, timeout))
+      {
+        ROS_ERROR("timed out waiting for %s", service.c_str());
+        return false;
+      }
+      client = nh.serviceClient<gazebo_msgs::SpawnModel>(service, true);
+    }
+
+    gazebo_msgs::SpawnModel srv;
+    srv.request.model_name = spec.name;
+    srv.request.model_xml = xml[i];
+    srv.request.robot_namespace = spec.robot_namespace;
+    srv.request.reference_frame = spec.reference_frame;
+    srv.request.initial_pose.position.x = spec.x;
+    srv.request.initial_pose.position.y = spec.y;
+    srv.request.initial_pose.position.z = spec.z;
+    srv.request.initial_pose.orientation =
+      tf::createQuaternionMsgFromRollPitchYaw(spec.roll, spec.pitch, spec.yaw);
+    if (!client.call(srv))
+    {
+      ROS_ERROR("%s: spawn service call failed", spec.name.c_str());
+      success = false;
+    }
+    else if (!srv.response.success)
+    {
+      ROS_ERROR("%s: %s", spec.name.c_str(), srv.response.status_message.c_str());
+      success = false;
+    }
+  }
+  return success;
+}
+
+/// \brief Apply the -J joint positions
+bool set_joints(ros::NodeHandle &nh, const std::string &gazebo_namespace,
+                const std::vector<ModelSpec> &models)
+{
+  ros::ServiceClient client;
+  bool success = true;
+  for (size_t i = 0; i < models.size(); ++i)
+  {
+    const ModelSpec &spec = models[i];
+    if (spec.joint_names.empty())
+      continue;
+    if (!client.isValid())
+      client = nh.serviceClient<gazebo_msgs::SetModelConfiguration>(
+        gazebo_namespace + "/set_model_configuration", true);
+
+    gazebo_msgs::SetModelConfiguration srv;
+    srv.request.model_name = spec.name;
+    srv.request.joint_names = spec.joint_names;
+    srv.request.joint_positions = spec.joint_positions;
+    if (!client.call(srv) || !srv.response.success)
+    {
+      ROS_ERROR("%s: SetModelConfiguration service failed", spec.name.c_str());
+      success = false;
+    }
+  }
+  return success;
+}
+
+void delete_models(ros::NodeHandle &nh, const std::string &gazebo_namespace,
+                   const std::vector<ModelSpec> &models)
+{
+  ROS_INFO("deleting %zu models", models.size());
+  const std::string batch_service = gazebo_namespace + "/delete_models";
+  if (ros::service::exists(batch_service, false))
+  {
+    gazebo_msgs::DeleteModels srv;
+    for (size_t i = 0; i < models.size(); ++i)
+      srv.request.model_name.push_back(models[i].name);
+    if (!ros::service::call(batch_service, srv))
+      ROS_ERROR("delete_models service call failed");
+    return;
+  }
+
+  ros::ServiceClient client = nh.serviceClient<gazebo_msgs::DeleteModel>(
+    gazebo_namespace + "/delete_model", true);
+  for (size_t i = 0; i < models.size(); ++i)
+  {
+    gazebo_msgs::DeleteModel srv;
+    srv.request.model_name = models[i].name;
+    if (!client.call(srv))
+      ROS_ERROR("%s: delete model service call failed", models[i].name.c_str());
+  }
+}
+
+}
+
+int main(int argc, char **argv)
+{
+  // the bond deletes the models on SIGINT, while the node is still up
+  ros::init(argc, argv, "spawn_models",
+            ros::init_options::AnonymousName | ros::init_options::NoSigintHandler);
+  signal(SIGINT, on_sigint);
+  std::vector<std::string> args;
+  ros::removeROSArgs(argc, argv, args);
+  args.erase(args.begin());
+  if (!args.empty() && (args[0] == "-h" || args[0] == "--help"))
+  {
+    usage();
+    return 0;
+  }
+
+  ros::NodeHandle nh;
+  ros::NodeHandle private_nh("~");
+
+  std::vector<ModelSpec> models;
+  ModelSpec defaults;
+  defaults.robot_namespace = ros::this_node::getNamespace();
+  std::string gazebo_namespace = "/gazebo";
+  bool convert = false;
+  bool unpause = false;
+  bool bond = false;
+  double timeout = 0;
+  if (!parse_arguments(args, models, defaults, gazebo_namespace, convert, timeout, unpause, bond))
+  {
+    usage();
+    return 1;
+  }
+  g_bond_waiting = bond;
+  XmlRpc::XmlRpcValue manifest;
+  if (private_nh.getParam("models", manifest) && !parse_manifest(manifest, defaults, models))
+    return 1;
+  if (models.empty())
+  {
+    usage();
+    return 1;
+  }
+
+  std::set<std::string> names;
+  std::vector<std::string> xml(models.size());
+  std::map<std::string, std::string> cache;
+  for (size_t i = 0; i < models.size(); ++i)
+  {
+    if (models[i].name.empty())
+    {
+      ROS_FATAL("a model has no name");
+      return 1;
+    }
+    if (!names.insert(models[i].name).second)
+    {
+      ROS_FATAL("model %s is given more than once", models[i].name.c_str());
+      return 1;
+    }
+    if (!load_xml(nh, models[i], convert, cache, xml[i]))
+      return 1;
+  }
+
+  // spawn_models is advertised right after the other spawn services, if
+  // gazebo has it
+  const std::string batch_service = gazebo_namespace + "/spawn_models";
+  if (!wait_for(gazebo_namespace + "/spawn_sdf_model", timeout))
+  {
+    ROS_FATAL("timed out waiting for gazebo");
+    return 1;
+  }
+  bool success;
+  if (ros::service::waitForService(batch_service, ros::Duration(1.0)))
+    success = spawn_batch(nh, gazebo_namespace, models, xml);
+  else
+    success = spawn_each(nh, gazebo_namespace, models, xml, timeout);
+  if (!success)
+  {
+    ROS_ERROR("Spawn service failed. Exiting.");
+    return 1;
+  }
+
+  if (!set_joints(nh, gazebo_namespace, models))
+    return 1;
+
+  if (unpause)
+  {
+    ROS_INFO("Unpausing physics");
+    std_srvs::Empty srv;
+    if (!wait_for(gazebo_namespace + "/unpause_physics", timeout) ||
+        !ros::service::call(gazebo_namespace + "/unpause_physics", srv))
+    {
+      ROS_ERROR("Unpause physics service call failed");
+      return 1;
+    }
+  }
+
+  if (bond)
+  {
+    ROS_INFO("Waiting for shutdown to delete %zu models", models.size());
+    while (!g_interrupted && ros::ok())
+      ros::WallDuration(0.1).sleep();
+    if (ros::ok())
+      delete_models(nh, gazebo_namespace, models);
+  }
+  ros::shutdown();
+  return 0;
+}
@@ -0,0 +1,236 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+
+#include <stdio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <map>
+#include <set>
+
+#include <gazebo_ros/startup_trace.h>
+
+namespace gazebo
+{
+
+namespace
+{
+
+const std::chrono::steady_clock::time_point g_epoch = std::chrono::steady_clock::now();
+std::atomic<unsigned int> g_next_tid(1);
+
+int64_t usecSinceEpoch(std::chrono::steady_clock::time_point time)
+{
+  return std::chrono::duration_cast<std::chrono::microseconds>(time - g_epoch).count();
+}
+
+unsigned int threadId()
+{
+  thread_local unsigned int tid = g_next_tid.fetch_add(1);
+  return tid;
+}
+
+/// \brief JSON string
+void writeString(FILE *file, const std::string &text)
+{
+  fputc('"', file);
+  for (std::string::const_iterator c = text.begin(); c != text.end(); ++c)
+  {
+    if (*c == '"' || *c == '\\')
+      fputc('\\', file);
+    if (static_cast<unsigned char>(*c) >= 0x20)
+      fputc(*c, file);
+  }
+  fputc('"', file);
+}
+
+/// \brief Phases of one plugin name in a report
+struct PluginSummary
+{
+  std::string plugin;
+  int64_t total_usec;
+  unsigned int loads;
+  std::map<std::string, int64_t> phase_usec;
+};
+
+bool slower(const PluginSummary &a, const PluginSummary &b)
+{
+  return a.total_usec > b.total_usec;
+}
+
+}
+
+StartupTrace::StartupTrace() :
+  reported_(0),
+  pending_(0),
+  last_record_(std::chrono::steady_clock::now())
+{
+}
+
+StartupTrace &StartupTrace::instance()
+{
+  static StartupTrace trace;
+  return trace;
+}
+
+void StartupTrace::record(const std::string &plugin, const std::string &phase,
+                          std::chrono::steady_clock::time_point start,
+                          std::chrono::steady_clock::time_point end)
+{
+  Phase p;
+  p.plugin = plugin;
+  p.phase = phase;
+  p.tid = threadId();
+  p.start_usec = usecSinceEpoch(start);
+  p.duration_usec = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+
+  boost::mutex::scoped_lock lock(mutex_);
+  phases_.push_back(p);
+  last_record_ = std::chrono::steady_clock::now();
+}
+
+void StartupTrace::addPending()
+{
+  pending_.fetch_add(1);
+}
+
+void StartupTrace::removePending()
+{
+  pending_.fetch_sub(1);
+  boost::mutex::scoped_lock lock(mutex_);
+  last_record_ = std::chrono::steady_clock::now();
+}
+
+bool StartupTrace::takeReport(std::vector<Phase> &phases, std::chrono::steady_clock::duration quiet)
+{
+  if (pending_.load() > 0)
+    return false;
+
+  boost::mutex::scoped_lock lock(mutex_);
+  if (reported_ == phases_.size() || std::chrono::steady_clock::now() - last_record_ < quiet)
+    return false;
+  phases.assign(phases_.begin() + reported_, phases_.end());
+  reported_ = phases_.size();
+  return true;
+}
+
+std::string StartupTrace::report(const std::vector<Phase> &phases, size_t max_plugins)
+{
+  if (phases.empty())
+    return std::string();
+
+  std::map<std::string, PluginSummary> plugins;
+  std::map<std::string, int64_t> phase_usec;
+  std::set<unsigned int> threads;
+  int64_t first_usec = phases.front().start_usec;
+  int64_t last_usec = first_usec;
+  for (size_t i = 0; i < phases.size(); ++i)
+  {
+    const Phase &p = phases[i];
+    PluginSummary &summary = plugins[p.plugin];
+    summary.plugin = p.plugin;
+    summary.total_usec += p.duration_usec;
+    summary.phase_usec[p.phase] += p.duration_usec;
+    if (p.phase == "load")
+      ++summary.loads;
+    phase_usec[p.phase] += p.duration_usec;
+    threads.insert(p.tid);
+    first_usec = std::min(first_usec, p.start_usec);
+    last_usec = std::max(last_usec, p.start_usec + p.duration_usec);
+  }
+
+  std::vector<PluginSummary> sorted;
+  for (std::map<std::string, PluginSummary>::const_iterator it = plugins.begin(); it != plugins.end(); ++it)
+    sorted.push_back(it->second);
+  std::sort(sorted.begin(), sorted.end(), slower);
+
+  char line[256];
+  std::string text;
+  snprintf(line, sizeof(line), "loaded %zu plugins in %.3f s on %zu threads:",
+           plugins.size(), (last_usec - first_usec) * 1e-6, threads.size());
+  text += line;
+  for (std::map<std::string, int64_t>::const_iterator it = phase_usec.begin(); it != phase_usec.end(); ++it)
+  {
+    snprintf(line, sizeof(line), "%s %s %.3f s", it == phase_usec.begin() ? "" : ",",
+             it->first.c_str(), it->second * 1e-6);
+    text += line;
+  }
+  for (size_t i = 0; i < sorted.size() && i < max_plugins; ++i)
+  {
+    const PluginSummary &summary = sorted[i];
+    snprintf(line, sizeof(line), "\n  %8.3f s  ", summary.total_usec * 1e-6);
+    text += line + summary.plugin;
+    if (summary.loads > 1)
+    {
+      snprintf(line, sizeof(line), " x%u", summary.loads);
+      text += line;
+    }
+    const char *separator = " (";
+    for (std::map<std::string, int64_t>::const_iterator it = summary.phase_usec.begin();
+         it != summary.phase_usec.end(); ++it)
+    {
+      snprintf(line, sizeof(line), "%s%s %.3f s", separator, it->first.c_str(), it->second * 1e-6);
+      text += line;
+      separator = ", ";
+    }
+    text += ")";
+  }
+  if (sorted.size() > max_plugins)
+  {
+    snprintf(line, sizeof(line), "\n  and %zu more", sorted.size() - max_plugins);
+    text += line;
+  }
+  return text;
+}
+
+bool StartupTrace::writeTrace(const std::string &path, std::string &error)
+{
+  FILE *file = fopen(path.c_str(), "w");
+  if (!file)
+  {
+    error = "unable to open " + path + ": " + strerror(errno);
+    return false;
+  }
+
+  const int pid = getpid();
+  boost::mutex::scoped_lock lock(mutex_);
+  fputs("{\"traceEvents\":[", file);
+  for (size_t i = 0; i < phases_.size(); ++i)
+  {
+    const Phase &p = phases_[i];
+    fputs(i == 0 ? "\n" : ",\n", file);
+    fputs("{\"name\":", file);
+    writeString(file, p.plugin + " " + p.phase);
+    fputs(",\"cat\":", file);
+    writeString(file, p.phase);
+    fprintf(file, ",\"ph\":\"X\",\"pid\":%d,\"tid\":%u,\"ts\":%lld,\"dur\":%lld}",
+            pid, p.tid, static_cast<long long>(p.start_usec),
+            static_cast<long long>(p.duration_usec));
+  }
+  fputs("\n]}\n", file);
+  if (fclose(file) != 0)
+  {
+    error = "unable to write " + path;
+    return false;
+  }
+  return true;
+}
+
+}
@@ -0,0 +1,140 @@
+/*
+ * Copyright 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+
+#include <cstring>
+
+#include <gazebo_ros/thread_policy.h>
+
+namespace gazebo
+{
+
+ThreadPolicy &ThreadPolicy::instance()
+{
+  static ThreadPolicy policy;
+  return policy;
+}
+
+ThreadPolicy::ThreadPolicy() :
+  configured_(false)
+{
+}
+
+void ThreadPolicy::set(const std::string &thread_class, const Settings &settings)
+{
+  boost::mutex::scoped_lock lock(mutex_);
+  configured_ = true;
+  classes_[thread_class] = settings;
+}
+
+bool ThreadPolicy::configured() const
+{
+  boost::mutex::scoped_lock lock(mutex_);
+  return configured_;
+}
+
+bool ThreadPolicy::parseCpus(const std::string &spec, std::vector<int> &cpus)
+{
+  cpus.clear();
+  const char *p = spec.c_str();
+  while (*p)
+  {
+    char *end;
+    long first = strtol(p, &end, 10);
+    if (end == p || first < 0)
+      return false;
+    long last = first;
+    p = end;
+    if (*p == '-')
+    {
+      ++p;
+      last = strtol(p, &end, 10);
+      if (end == p || last < first)
+        return false;
+      p = end;
+    }
+    for (long cpu = first; cpu <= last; ++cpu)
+      cpus.push_back(static_cast<int>(cpu));
+    if (*p == ',')
+      ++p;
+    else if (*p)
+      return false;
+  }
+  return !cpus.empty();
+}
+
+void ThreadPolicy::apply(const std::string &thread_class, const std::string &default_name)
+{
+  // a thread applies its class once, later calls are a string compare
+  thread_local std::string applied;
+  if (applied == thread_class)
+    return;
+  applied = thread_class;
+
+  Settings settings;
+  bool found;
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    std::map<std::string, Settings>::const_iterator it = classes_.find(thread_class);
+    found = it != classes_.end();
+    if (found)
+      settings = it->second;
+  }
+
+  std::string name = found && !settings.name.empty() ? settings.name : default_name;
+  if (!name.empty())
+    pthread_setname_np(pthread_self(), name.substr(0, 15).c_str());
+  if (!found)
+    return;
+
+  std::string error;
+  if (!settings.cpus.empty())
+  {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (size_t i = 0; i < settings.cpus.size(); ++i)
+      if (settings.cpus[i] < CPU_SETSIZE)
+        CPU_SET(settings.cpus[i], &set);
+    int result = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (result)
+      error = std::string("affinity: ") + strerror(result);
+  }
+  if (settings.priority > 0)
+  {
+    sched_param param;
+    memset(&param, 0, sizeof(param));
+    param.sched_priority = settings.priority;
+    int result = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+    if (result)
+      error += (error.empty() ? "" : ", ") + std::string("SCHED_FIFO: ") + strerror(result);
+  }
+
+  if (!error.empty())
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    if (failed_.insert(thread_class).second)
+      ROS_WARN_NAMED("thread_policy", "Thread class %s: %s", thread_class.c_str(), error.c_str());
+  }
+}
+
+}
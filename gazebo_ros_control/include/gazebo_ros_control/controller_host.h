@@ -0,0 +1,123 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Open Source Robotics Foundation
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the Open Source Robotics Foundation
+ *     nor the names of its contributors may be
+ *     used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Shared scheduler that runs the update cycle of many gazebo_ros_control plugins in
+           parallel within each physics step
+*/
+
+#ifndef _GAZEBO_ROS_CONTROL___CONTROLLER_HOST_H_
+#define _GAZEBO_ROS_CONTROL___CONTROLLER_HOST_H_
+
+#include <atomic>
+#include <utility>
+#include <vector>
+
+// Boost
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+namespace gazebo_ros_control
+{
+
+/// \brief Process-wide host for the controller updates of many robots
+///
+/// The host is started by the gazebo_ros_control_host world plugin. Each GazeboRosControlPlugin
+/// then registers its update cycle with the host instead of connecting to the world update event,
+/// and the host runs the cycles of all registered robots, waiting for all of them before the
+/// physics step proceeds. Started without worker threads, the default of the world plugin, it
+/// runs them one after the other on the calling thread; with workers, the cycles of different
+/// robots run concurrently. Every robot keeps its own namespace and controller manager.
+class ControllerHost
+{
+public:
+  typedef boost::function<void()> UpdateFunction;
+
+  /// \brief Get the host of this process
+  static ControllerHost& instance();
+
+  /// \brief Start the thread pool
+  /// \param threads  Number of worker threads in addition to the calling thread, 0 to run the
+  ///                 updates serially on the calling thread.
+  void start(unsigned int threads);
+
+  /// \brief Stop the thread pool. Registered updates are kept but no longer run.
+  void stop();
+
+  /// \brief Return true if the host was started
+  bool running() const;
+
+  /// \brief Register an update cycle and return its id
+  unsigned int add(const UpdateFunction& update);
+
+  /// \brief Unregister an update cycle. Blocks while the updates are running.
+  void remove(unsigned int id);
+
+  /// \brief Run all registered update cycles and wait for them to finish
+  void update();
+
+private:
+  ControllerHost();
+  ~ControllerHost();
+
+  // Worker thread loop
+  void workerThread();
+
+  // Claim and run updates of the current step until none are left
+  void runUpdates();
+
+  std::atomic<bool> running_;
+
+  // Guards updates_ and next_id_, and is held by update() for the whole step
+  boost::mutex updates_mutex_;
+  std::vector<std::pair<unsigned int, UpdateFunction> > updates_;
+  unsigned int next_id_;
+
+  // Thread pool
+  std::vector<boost::shared_ptr<boost::thread> > threads_;
+  boost::mutex pool_mutex_;
+  boost::condition_variable work_cond_;
+  boost::condition_variable done_cond_;
+  unsigned long generation_;  // incremented for every step
+  bool shutdown_;
+  size_t pending_;  // updates of the current step that have not finished
+  size_t next_update_;  // next update of the current step to be claimed
+  size_t update_count_;  // number of updates in the current step
+};
+
+}
+
+#endif // #ifndef _GAZEBO_ROS_CONTROL___CONTROLLER_HOST_H_
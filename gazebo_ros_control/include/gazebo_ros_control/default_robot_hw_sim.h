@@ -67,7 +67,6 @@
 #include <urdf/model.h>
 
 
-
 namespace gazebo_ros_control
 {
 
@@ -88,6 +87,8 @@ public:
 
   virtual void eStopActive(const bool active);
 
+  virtual bool latchCommands(ros::Duration period);
+
 protected:
   // Methods used to control a joint.
   enum ControlMethod {EFFORT, POSITION, POSITION_PID, VELOCITY, VELOCITY_PID};
@@ -103,6 +104,40 @@ protected:
                            int *const joint_type, double *const lower_limit,
                            double *const upper_limit, double *const effort_limit);
 
+  // Joints sharing a control method and joint type, so readSim() and writeSim() can run one
+  // loop per partition instead of switching per joint. The Gazebo joint pointers and limits are
+  // copied in partition order; the per-joint vectors below stay indexed by joint.
+  struct JointPartition
+  {
+    std::vector<unsigned int> joints;
+    std::vector<gazebo::physics::Joint*> sim_joints;
+    std::vector<double> lower_limits;
+    std::vector<double> upper_limits;
+    std::vector<double> effort_limits;
+
+    // Joint state gathered by readSim() and efforts computed by writeSim(), in partition order.
+    std::vector<double> positions;
+    std::vector<double> velocities;
+    std::vector<double> efforts;
+    std::vector<double> commands;
+
+    void add(const unsigned int j, gazebo::physics::Joint *const sim_joint,
+             const double lower_limit, const double upper_limit, const double effort_limit);
+  };
+
+  // Read position, velocity and effort of every joint of p into its state buffers.
+  void gatherState(JointPartition& p) const;
+
+  // Apply p.commands as joint efforts, one SetForce() call per joint.
+  void applyEfforts(const JointPartition& p) const;
+
+  // Enforce the registered joint limits on the command vectors.
+  void enforceLimits(ros::Duration period);
+
+  // Sort the loaded joints into the partitions below. sim_joints holds the Gazebo joint of each
+  // transmission, or NULL if the transmission was skipped. Called once by initSim().
+  void buildPartitions(const std::vector<gazebo::physics::Joint*>& sim_joints);
+
   unsigned int n_dof_;
 
   hardware_interface::JointStateInterface    js_interface_;
@@ -117,6 +152,15 @@ protected:
   joint_limits_interface::VelocityJointSaturationInterface vj_sat_interface_;
   joint_limits_interface::VelocityJointSoftLimitsInterface vj_limits_interface_;
 
+  // Copies of the limits handles registered above, in joint order. enforceLimits() runs over these
+  // contiguous vectors instead of the interfaces' name-keyed maps, and skips empty ones.
+  std::vector<joint_limits_interface::EffortJointSaturationHandle>   ej_sat_handles_;
+  std::vector<joint_limits_interface::EffortJointSoftLimitsHandle>   ej_limits_handles_;
+  std::vector<joint_limits_interface::PositionJointSaturationHandle> pj_sat_handles_;
+  std::vector<joint_limits_interface::PositionJointSoftLimitsHandle> pj_limits_handles_;
+  std::vector<joint_limits_interface::VelocityJointSaturationHandle> vj_sat_handles_;
+  std::vector<joint_limits_interface::VelocityJointSoftLimitsHandle> vj_limits_handles_;
+
   std::vector<std::string> joint_names_;
   std::vector<int> joint_types_;
   std::vector<double> joint_lower_limits_;
@@ -132,10 +176,33 @@ protected:
   std::vector<double> last_joint_position_command_;
   std::vector<double> joint_velocity_command_;
 
+  // Commands used by writeSim() once latchCommands() has been called, so the controllers can
+  // write the command vectors above concurrently.
+  bool latched_commands_;
+  std::vector<double> latched_effort_command_;
+  std::vector<double> latched_position_command_;
+  std::vector<double> latched_velocity_command_;
+
   std::vector<gazebo::physics::JointPtr> sim_joints_;
 
+  // Read partitions: joints whose position is wrapped versus used as-is.
+  JointPartition angular_read_joints_;
+  JointPartition linear_read_joints_;
+
+  // Write partitions, one per control method; POSITION_PID is further split by joint type.
+  JointPartition effort_joints_;
+  JointPartition position_joints_;
+  JointPartition position_pid_revolute_joints_;
+  JointPartition position_pid_continuous_joints_;
+  JointPartition position_pid_linear_joints_;
+  JointPartition velocity_joints_;
+  JointPartition velocity_pid_joints_;
+
   std::string physics_type_;
 
+  // True if velocity commands are applied with SetVelocity() rather than SetParam("vel").
+  bool use_set_velocity_;
+
   // e_stop_active_ is true if the emergency stop is active.
   bool e_stop_active_, last_e_stop_active_;
 };
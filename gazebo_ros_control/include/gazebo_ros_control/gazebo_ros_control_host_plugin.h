@@ -0,0 +1,78 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Open Source Robotics Foundation
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the Open Source Robotics Foundation
+ *     nor the names of its contributors may be
+ *     used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   World plugin that runs the controller updates of all gazebo_ros_control plugins in
+           the world on a shared thread pool
+*/
+
+#ifndef _GAZEBO_ROS_CONTROL___GAZEBO_ROS_CONTROL_HOST_PLUGIN_H_
+#define _GAZEBO_ROS_CONTROL___GAZEBO_ROS_CONTROL_HOST_PLUGIN_H_
+
+// Gazebo
+#include <gazebo/gazebo.hh>
+#include <gazebo/physics/physics.hh>
+#include <gazebo/common/common.hh>
+
+namespace gazebo_ros_control
+{
+
+/// \brief Start the shared ControllerHost and drive it from the world update event
+///
+/// gazebo_ros_control plugins loaded after this plugin register with the host unless they set
+/// <sharedControllerHost> to false. The update cycles run one after the other on the physics
+/// thread unless <parallelUpdates> is true, which runs the cycles of different robots
+/// concurrently: this writes the joints of different models at the same time, which Gazebo
+/// does not document as safe. <threads> then sets the number of worker threads in addition to
+/// the physics thread, and defaults to the number of cores minus one.
+class GazeboRosControlHostPlugin : public gazebo::WorldPlugin
+{
+public:
+
+  virtual ~GazeboRosControlHostPlugin();
+
+  // Overloaded Gazebo entry point
+  virtual void Load(gazebo::physics::WorldPtr world, sdf::ElementPtr sdf);
+
+  // Called by the world update start event
+  void Update();
+
+protected:
+  // Pointer to the update event connection
+  gazebo::event::ConnectionPtr update_connection_;
+};
+
+}
+
+#endif // #ifndef _GAZEBO_ROS_CONTROL___GAZEBO_ROS_CONTROL_HOST_PLUGIN_H_
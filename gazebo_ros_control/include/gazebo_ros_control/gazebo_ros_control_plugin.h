@@ -39,14 +39,19 @@
            using pluginlib
 */
 
+#include <atomic>
+
 // Boost
 #include <boost/shared_ptr.hpp>
 #include <boost/thread.hpp>
+#include <boost/thread/condition_variable.hpp>
 
 // ROS
 #include <ros/ros.h>
 #include <pluginlib/class_loader.h>
 #include <std_msgs/Bool.h>
+#include <diagnostic_msgs/DiagnosticArray.h>
+#include <gazebo_ros/plugin_timing.h>
 
 // Gazebo
 #include <gazebo/gazebo.hh>
@@ -58,6 +63,9 @@
 #include <controller_manager/controller_manager.h>
 #include <transmission_interface/transmission_parser.h>
 
+// URDF
+#include <urdf/model.h>
+
 namespace gazebo_ros_control
 {
 
@@ -65,6 +73,8 @@ class GazeboRosControlPlugin : public gazebo::ModelPlugin
 {
 public:
 
+  GazeboRosControlPlugin();
+
   virtual ~GazeboRosControlPlugin();
 
   // Overloaded Gazebo entry point
@@ -83,8 +93,75 @@ public:
   bool parseTransmissionsFromURDF(const std::string& urdf_string);
 
 protected:
+  // A set of joints whose controllers share a control period. Each group has its own robot
+  // simulation interface and controller manager and runs its own read/update/write cycle, so
+  // slow groups are not updated at the rate of fast ones.
+  struct ControlGroup
+  {
+    ControlGroup();
+
+    std::string name;
+    ros::NodeHandle nh;  // controller manager namespace
+    std::vector<transmission_interface::TransmissionInfo> transmissions;
+    boost::shared_ptr<gazebo_ros_control::RobotHWSim> robot_hw_sim;
+    boost::shared_ptr<controller_manager::ControllerManager> controller_manager;
+
+    // Timing
+    ros::Duration control_period;
+    ros::Time last_update_sim_time_ros;
+    ros::Time last_write_sim_time_ros;
+    bool last_e_stop_active;
+
+    // Asynchronous controller update. The controllers compute their commands on
+    // controller_thread while the physics steps, and the commands are applied at the next
+    // control period. In deterministic mode, physics waits for the controllers at each period.
+    bool async_update;
+    boost::thread controller_thread;
+    boost::mutex controller_mutex;
+    boost::condition_variable controller_cond;
+    std::atomic<bool> controller_busy;
+    bool controller_shutdown;
+    ros::Time controller_time;
+    ros::Duration controller_period;
+    bool controller_reset;
+    unsigned int skipped_updates;
+
+    // Stage timings, also shown on ~performance_metrics of gazebo_ros_api_plugin. The jitter
+    // stage records how far each control period was from control_period, and overruns counts
+    // controller updates that took longer than control_period.
+    std::string timing_name;
+    gazebo::TimingStage *read_timing;
+    gazebo::TimingStage *update_timing;
+    gazebo::TimingStage *write_timing;
+    gazebo::TimingStage *jitter_timing;
+    std::atomic<uint64_t> overruns;
+  };
+  typedef boost::shared_ptr<ControlGroup> ControlGroupPtr;
+
   void eStopCB(const std_msgs::BoolConstPtr& e_stop_active);
 
+  // Create the robot simulation interface and controller manager of a group.
+  bool loadControlGroup(ControlGroup& group, const std::string& robot_ns,
+                        const urdf::Model *const urdf_model);
+
+  // Run the read/update/write cycle of a group for the current simulation step.
+  void updateControlGroup(ControlGroup& group, const ros::Time& sim_time_ros);
+
+  // Asynchronous controller update: hand an update to the controller thread of a group, wait for
+  // the update in progress to finish, stop the thread, and the controller thread loop itself.
+  void startControllerUpdate(ControlGroup& group, const ros::Time& time,
+                             const ros::Duration& period, bool reset);
+  void waitForControllerUpdate(ControlGroup& group);
+  void stopControllerThread(ControlGroup& group);
+  void controllerThread(ControlGroup* group);
+
+  // Run and time the controller update of a group, from either thread.
+  void runControllerUpdate(ControlGroup& group, const ros::Time& time,
+                           const ros::Duration& period, bool reset);
+
+  // Publish the timing of all groups on /diagnostics, if anyone listens.
+  void publishDiagnostics(const ros::Time& sim_time_ros);
+
   // Node Handles
   ros::NodeHandle model_nh_; // namespaces to robot name
 
@@ -98,6 +175,10 @@ protected:
   // Pointer to the update event connection
   gazebo::event::ConnectionPtr update_connection_;
 
+  // True if Update() is run by the shared ControllerHost instead of the update event
+  bool shared_host_;
+  unsigned int host_update_id_;
+
   // Interface loader
   boost::shared_ptr<pluginlib::ClassLoader<gazebo_ros_control::RobotHWSim> > robot_hw_sim_loader_;
   void load_robot_hw_sim_srv();
@@ -111,18 +192,28 @@ protected:
 
   // Robot simulator interface
   std::string robot_hw_sim_type_str_;
-  boost::shared_ptr<gazebo_ros_control::RobotHWSim> robot_hw_sim_;
 
-  // Controller manager
-  boost::shared_ptr<controller_manager::ControllerManager> controller_manager_;
+  // Control groups. The first one is the default group, which holds every transmission that is
+  // not assigned to a <controlGroup> and uses the robot namespace.
+  std::vector<ControlGroupPtr> control_groups_;
 
-  // Timing
+  // Robot simulator interface, controller manager and period of the default group
+  boost::shared_ptr<gazebo_ros_control::RobotHWSim> robot_hw_sim_;
+  boost::shared_ptr<controller_manager::ControllerManager> controller_manager_;
   ros::Duration control_period_;
-  ros::Time last_update_sim_time_ros_;
-  ros::Time last_write_sim_time_ros_;
+
+  // Asynchronous controller update settings, shared by all groups
+  bool async_update_;
+  bool deterministic_update_;
+  int controller_thread_priority_;
+
+  // Timing diagnostics
+  ros::Publisher diagnostics_pub_;
+  ros::Duration diagnostics_period_;
+  ros::Time last_diagnostics_time_;
 
   // e_stop_active_ is true if the emergency stop is active.
-  bool e_stop_active_, last_e_stop_active_;
+  bool e_stop_active_;
   ros::Subscriber e_stop_sub_;  // Emergency stop subscriber
 
 };
@@ -112,6 +112,19 @@ namespace gazebo_ros_control {
     /// \param active  \c true if the emergency stop is active, \c false if not.
     virtual void eStopActive(const bool active) {}
 
+    /// \brief Latch the controller commands for asynchronous controller updates
+    ///
+    /// Copy the commands written by the controllers into the buffers used by writeSim(), so that
+    /// the next controller update can run on another thread while writeSim() is called. The
+    /// plugin calls this at each control period while no controller update is in progress. Once
+    /// this returns \c true, writeSim() must only use latched commands. The default
+    /// implementation returns \c false, meaning only synchronous controller updates are supported.
+    ///
+    /// \param period  Time since the last latch.
+    ///
+    /// \return  \c true if the commands were latched, \c false if this is not supported.
+    virtual bool latchCommands(ros::Duration period) { return false; }
+
   };
 
 }
@@ -0,0 +1,196 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Open Source Robotics Foundation
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the Open Source Robotics Foundation
+ *     nor the names of its contributors may be
+ *     used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Shared scheduler that runs the update cycle of many gazebo_ros_control plugins in
+           parallel within each physics step
+*/
+
+#include <gazebo_ros_control/controller_host.h>
+#include <gazebo_ros/thread_policy.h>
+#include <ros/ros.h>
+
+// Boost
+#include <boost/bind.hpp>
+
+#include <exception>
+
+namespace gazebo_ros_control
+{
+
+ControllerHost::ControllerHost()
+  : running_(false), next_id_(0), generation_(0), shutdown_(false), pending_(0),
+    next_update_(0), update_count_(0)
+{
+}
+
+ControllerHost::~ControllerHost()
+{
+  stop();
+}
+
+ControllerHost& ControllerHost::instance()
+{
+  static ControllerHost host;
+  return host;
+}
+
+void ControllerHost::start(unsigned int threads)
+{
+  boost::mutex::scoped_lock lock(updates_mutex_);
+  if (running_)
+    return;
+
+  {
+    boost::mutex::scoped_lock pool_lock(pool_mutex_);
+    shutdown_ = false;
+  }
+  for (unsigned int i = 0; i < threads; ++i)
+  {
+    threads_.push_back(boost::shared_ptr<boost::thread>(
+      new boost::thread(boost::bind(&ControllerHost::workerThread, this))));
+  }
+  running_ = true;
+}
+
+void ControllerHost::stop()
+{
+  boost::mutex::scoped_lock lock(updates_mutex_);
+  if (!running_)
+    return;
+
+  {
+    boost::mutex::scoped_lock pool_lock(pool_mutex_);
+    shutdown_ = true;
+  }
+  work_cond_.notify_all();
+  for (size_t i = 0; i < threads_.size(); ++i)
+    threads_[i]->join();
+  threads_.clear();
+  running_ = false;
+}
+
+bool ControllerHost::running() const
+{
+  return running_;
+}
+
+unsigned int ControllerHost::add(const UpdateFunction& update)
+{
+  boost::mutex::scoped_lock lock(updates_mutex_);
+  const unsigned int id = next_id_++;
+  updates_.push_back(std::make_pair(id, update));
+  return id;
+}
+
+void ControllerHost::remove(unsigned int id)
+{
+  boost::mutex::scoped_lock lock(updates_mutex_);
+  for (size_t i = 0; i < updates_.size(); ++i)
+  {
+    if (updates_[i].first == id)
+    {
+      updates_.erase(updates_.begin() + i);
+      return;
+    }
+  }
+}
+
+void ControllerHost::update()
+{
+  boost::mutex::scoped_lock lock(updates_mutex_);
+  if (!running_ || updates_.empty())
+    return;
+
+  {
+    boost::mutex::scoped_lock pool_lock(pool_mutex_);
+    pending_ = updates_.size();
+    update_count_ = updates_.size();
+    next_update_ = 0;
+    ++generation_;
+  }
+  if (!threads_.empty())
+    work_cond_.notify_all();
+
+  // The calling thread takes its share of the updates too
+  runUpdates();
+
+  boost::mutex::scoped_lock pool_lock(pool_mutex_);
+  while (pending_ > 0)
+    done_cond_.wait(pool_lock);
+  update_count_ = 0;
+}
+
+void ControllerHost::runUpdates()
+{
+  boost::mutex::scoped_lock pool_lock(pool_mutex_);
+  while (next_update_ < update_count_)
+  {
+    const size_t i = next_update_++;
+    pool_lock.unlock();
+    try
+    {
+      updates_[i].second();
+    }
+    catch (const std::exception& e)
+    {
+      ROS_ERROR_STREAM_NAMED("gazebo_ros_control", "Controller update failed: " << e.what());
+    }
+    pool_lock.lock();
+
+    if (--pending_ == 0)
+      done_cond_.notify_all();
+  }
+}
+
+void ControllerHost::workerThread()
+{
+  gazebo::ThreadPolicy::instance().apply("control", "gzros_control");
+  unsigned long seen = 0;
+  boost::mutex::scoped_lock lock(pool_mutex_);
+  while (true)
+  {
+    while (generation_ == seen && !shutdown_)
+      work_cond_.wait(lock);
+    if (shutdown_)
+      break;
+
+    seen = generation_;
+    lock.unlock();
+    runUpdates();
+    lock.lock();
+  }
+}
+
+}
@@ -83,6 +83,7 @@ bool DefaultRobotHWSim::initSim(
   joint_effort_command_.resize(n_dof_);
   joint_position_command_.resize(n_dof_);
   joint_velocity_command_.resize(n_dof_);
+  std::vector<gazebo::physics::Joint*> partition_joints(n_dof_, NULL);
 
   // Initialize values
   for(unsigned int j=0; j < n_dof_; j++)
@@ -196,6 +197,7 @@ bool DefaultRobotHWSim::initSim(
       return false;
     }
     sim_joints_.push_back(joint);
+    partition_joints[j] = joint.get();
 
     // get physics engine type
 #if GAZEBO_MAJOR_VERSION >= 8
@@ -251,39 +253,144 @@ bool DefaultRobotHWSim::initSim(
   registerInterface(&pj_interface_);
   registerInterface(&vj_interface_);
 
+#if GAZEBO_MAJOR_VERSION > 2
+  use_set_velocity_ = physics_type_.compare("dart") == 0;
+#else
+  use_set_velocity_ = true;
+#endif
+  buildPartitions(partition_joints);
+
   // Initialize the emergency stop code.
   e_stop_active_ = false;
   last_e_stop_active_ = false;
 
+  latched_commands_ = false;
+
   return true;
 }
 
-void DefaultRobotHWSim::readSim(ros::Time time, ros::Duration period)
+void DefaultRobotHWSim::JointPartition::add(const unsigned int j,
+                                            gazebo::physics::Joint *const sim_joint,
+                                            const double lower_limit, const double upper_limit,
+                                            const double effort_limit)
+{
+  joints.push_back(j);
+  sim_joints.push_back(sim_joint);
+  lower_limits.push_back(lower_limit);
+  upper_limits.push_back(upper_limit);
+  effort_limits.push_back(effort_limit);
+  positions.push_back(0.0);
+  velocities.push_back(0.0);
+  efforts.push_back(0.0);
+  commands.push_back(0.0);
+}
+
+void DefaultRobotHWSim::buildPartitions(const std::vector<gazebo::physics::Joint*>& sim_joints)
 {
   for(unsigned int j=0; j < n_dof_; j++)
   {
+    gazebo::physics::Joint *const joint = sim_joints[j];
+    if (!joint)
+      continue;
+
+    const double lower = joint_lower_limits_[j];
+    const double upper = joint_upper_limits_[j];
+    const double effort_limit = joint_effort_limits_[j];
+
+    if (joint_types_[j] == urdf::Joint::PRISMATIC)
+      linear_read_joints_.add(j, joint, lower, upper, effort_limit);
+    else
+      angular_read_joints_.add(j, joint, lower, upper, effort_limit);
+
+    switch (joint_control_methods_[j])
+    {
+      case EFFORT:
+        effort_joints_.add(j, joint, lower, upper, effort_limit);
+        break;
+      case POSITION:
+        position_joints_.add(j, joint, lower, upper, effort_limit);
+        break;
+      case POSITION_PID:
+        switch (joint_types_[j])
+        {
+          case urdf::Joint::REVOLUTE:
+            position_pid_revolute_joints_.add(j, joint, lower, upper, effort_limit);
+            break;
+          case urdf::Joint::CONTINUOUS:
+            position_pid_continuous_joints_.add(j, joint, lower, upper, effort_limit);
+            break;
+          default:
+            position_pid_linear_joints_.add(j, joint, lower, upper, effort_limit);
+        }
+        break;
+      case VELOCITY:
+        velocity_joints_.add(j, joint, lower, upper, effort_limit);
+        break;
+      case VELOCITY_PID:
+        velocity_pid_joints_.add(j, joint, lower, upper, effort_limit);
+        break;
+    }
+  }
+}
+
+void DefaultRobotHWSim::gatherState(JointPartition& p) const
+{
+  for(std::size_t i=0; i < p.joints.size(); i++)
+  {
+    gazebo::physics::Joint *const joint = p.sim_joints[i];
     // Gazebo has an interesting API...
 #if GAZEBO_MAJOR_VERSION >= 8
-    double position = sim_joints_[j]->Position(0);
+    p.positions[i] = joint->Position(0);
 #else
-    double position = sim_joints_[j]->GetAngle(0).Radian();
+    p.positions[i] = joint->GetAngle(0).Radian();
 #endif
-    if (joint_types_[j] == urdf::Joint::PRISMATIC)
+    p.velocities[i] = joint->GetVelocity(0);
+    p.efforts[i] = joint->GetForce((unsigned int)(0));
+  }
+}
+
+void DefaultRobotHWSim::applyEfforts(const JointPartition& p) const
+{
+  for(std::size_t i=0; i < p.joints.size(); i++)
+    p.sim_joints[i]->SetForce(0, p.commands[i]);
+}
+
+void DefaultRobotHWSim::readSim(ros::Time time, ros::Duration period)
+{
+  {
+    JointPartition& p = angular_read_joints_;
+    gatherState(p);
+    for(std::size_t i=0; i < p.joints.size(); i++)
     {
-      joint_position_[j] = position;
+      const unsigned int j = p.joints[i];
+      joint_position_[j] += angles::shortest_angular_distance(joint_position_[j], p.positions[i]);
+      joint_velocity_[j] = p.velocities[i];
+      joint_effort_[j] = p.efforts[i];
     }
-    else
+  }
+  {
+    JointPartition& p = linear_read_joints_;
+    gatherState(p);
+    for(std::size_t i=0; i < p.joints.size(); i++)
     {
-      joint_position_[j] += angles::shortest_angular_distance(joint_position_[j],
-                            position);
+      const unsigned int j = p.joints[i];
+      joint_position_[j] = p.positions[i];
+      joint_velocity_[j] = p.velocities[i];
+      joint_effort_[j] = p.efforts[i];
     }
-    joint_velocity_[j] = sim_joints_[j]->GetVelocity(0);
-    joint_effort_[j] = sim_joints_[j]->GetForce((unsigned int)(0));
   }
 }
 
 void DefaultRobotHWSim::writeSim(ros::Time time, ros::Duration period)
 {
+  // Once commands are latched, limits have already been enforced by latchCommands().
+  const std::vector<double>& effort_command =
+    latched_commands_ ? latched_effort_command_ : joint_effort_command_;
+  std::vector<double>& position_command =
+    latched_commands_ ? latched_position_command_ : joint_position_command_;
+  const std::vector<double>& velocity_command =
+    latched_commands_ ? latched_velocity_command_ : joint_velocity_command_;
+
   // If the E-stop is active, joints controlled by position commands will maintain their positions.
   if (e_stop_active_)
   {
@@ -292,93 +399,105 @@ void DefaultRobotHWSim::writeSim(ros::Time time, ros::Duration period)
       last_joint_position_command_ = joint_position_;
       last_e_stop_active_ = true;
     }
-    joint_position_command_ = last_joint_position_command_;
+    position_command = last_joint_position_command_;
   }
   else
   {
     last_e_stop_active_ = false;
   }
 
-  ej_sat_interface_.enforceLimits(period);
-  ej_limits_interface_.enforceLimits(period);
-  pj_sat_interface_.enforceLimits(period);
-  pj_limits_interface_.enforceLimits(period);
-  vj_sat_interface_.enforceLimits(period);
-  vj_limits_interface_.enforceLimits(period);
+  if (!latched_commands_)
+    enforceLimits(period);
 
-  for(unsigned int j=0; j < n_dof_; j++)
+  // Efforts are computed into each partition's command buffer first and then applied in one pass.
   {
-    switch (joint_control_methods_[j])
-    {
-      case EFFORT:
-        {
-          const double effort = e_stop_active_ ? 0 : joint_effort_command_[j];
-          sim_joints_[j]->SetForce(0, effort);
-        }
-        break;
+    JointPartition& p = effort_joints_;
+    for(std::size_t i=0; i < p.joints.size(); i++)
+      p.commands[i] = e_stop_active_ ? 0 : effort_command[p.joints[i]];
+    applyEfforts(p);
+  }
 
-      case POSITION:
+  {
+    const JointPartition& p = position_joints_;
+    for(std::size_t i=0; i < p.joints.size(); i++)
+    {
 #if GAZEBO_MAJOR_VERSION >= 9
-        sim_joints_[j]->SetPosition(0, joint_position_command_[j], true);
+      p.sim_joints[i]->SetPosition(0, position_command[p.joints[i]], true);
 #else
-        sim_joints_[j]->SetPosition(0, joint_position_command_[j]);
+      p.sim_joints[i]->SetPosition(0, position_command[p.joints[i]]);
 #endif
-        break;
+    }
+  }
 
-      case POSITION_PID:
-        {
-          double error;
-          switch (joint_types_[j])
-          {
-            case urdf::Joint::REVOLUTE:
-              angles::shortest_angular_distance_with_limits(joint_position_[j],
-                                                            joint_position_command_[j],
-                                                            joint_lower_limits_[j],
-                                                            joint_upper_limits_[j],
-                                                            error);
-              break;
-            case urdf::Joint::CONTINUOUS:
-              error = angles::shortest_angular_distance(joint_position_[j],
-                                                        joint_position_command_[j]);
-              break;
-            default:
-              error = joint_position_command_[j] - joint_position_[j];
-          }
-
-          const double effort_limit = joint_effort_limits_[j];
-          const double effort = clamp(pid_controllers_[j].computeCommand(error, period),
-                                      -effort_limit, effort_limit);
-          sim_joints_[j]->SetForce(0, effort);
-        }
-        break;
+  {
+    JointPartition& p = position_pid_revolute_joints_;
+    for(std::size_t i=0; i < p.joints.size(); i++)
+    {
+      const unsigned int j = p.joints[i];
+      double error;
+      angles::shortest_angular_distance_with_limits(joint_position_[j],
+                                                    position_command[j],
+                                                    p.lower_limits[i],
+                                                    p.upper_limits[i],
+                                                    error);
+      p.commands[i] = clamp(pid_controllers_[j].computeCommand(error, period),
+                            -p.effort_limits[i], p.effort_limits[i]);
+    }
+    applyEfforts(p);
+  }
 
-      case VELOCITY:
+  {
+    JointPartition& p = position_pid_continuous_joints_;
+    for(std::size_t i=0; i < p.joints.size(); i++)
+    {
+      const unsigned int j = p.joints[i];
+      const double error = angles::shortest_angular_distance(joint_position_[j],
+                                                             position_command[j]);
+      p.commands[i] = clamp(pid_controllers_[j].computeCommand(error, period),
+                            -p.effort_limits[i], p.effort_limits[i]);
+    }
+    applyEfforts(p);
+  }
+
+  {
+    JointPartition& p = position_pid_linear_joints_;
+    for(std::size_t i=0; i < p.joints.size(); i++)
+    {
+      const unsigned int j = p.joints[i];
+      const double error = position_command[j] - joint_position_[j];
+      p.commands[i] = clamp(pid_controllers_[j].computeCommand(error, period),
+                            -p.effort_limits[i], p.effort_limits[i]);
+    }
+    applyEfforts(p);
+  }
+
+  {
+    const JointPartition& p = velocity_joints_;
+    if (use_set_velocity_)
+    {
+      for(std::size_t i=0; i < p.joints.size(); i++)
+        p.sim_joints[i]->SetVelocity(0, e_stop_active_ ? 0 : velocity_command[p.joints[i]]);
+    }
+    else
+    {
 #if GAZEBO_MAJOR_VERSION > 2
-        if (physics_type_.compare("dart") == 0)
-        {
-          sim_joints_[j]->SetVelocity(0, e_stop_active_ ? 0 : joint_velocity_command_[j]);
-        }
-        else 
-        {
-          sim_joints_[j]->SetParam("vel", 0, e_stop_active_ ? 0 : joint_velocity_command_[j]);
-        }
-#else
-        sim_joints_[j]->SetVelocity(0, e_stop_active_ ? 0 : joint_velocity_command_[j]);
+      for(std::size_t i=0; i < p.joints.size(); i++)
+        p.sim_joints[i]->SetParam("vel", 0, e_stop_active_ ? 0 : velocity_command[p.joints[i]]);
 #endif
-        break;
+    }
+  }
 
-      case VELOCITY_PID:
-        double error;
-        if (e_stop_active_)
-          error = -joint_velocity_[j];
-        else
-          error = joint_velocity_command_[j] - joint_velocity_[j];
-        const double effort_limit = joint_effort_limits_[j];
-        const double effort = clamp(pid_controllers_[j].computeCommand(error, period),
-                                    -effort_limit, effort_limit);
-        sim_joints_[j]->SetForce(0, effort);
-        break;
+  {
+    JointPartition& p = velocity_pid_joints_;
+    for(std::size_t i=0; i < p.joints.size(); i++)
+    {
+      const unsigned int j = p.joints[i];
+      const double error = e_stop_active_ ? -joint_velocity_[j]
+                                         : velocity_command[j] - joint_velocity_[j];
+      p.commands[i] = clamp(pid_controllers_[j].computeCommand(error, period),
+                            -p.effort_limits[i], p.effort_limits[i]);
     }
+    applyEfforts(p);
   }
 }
 
@@ -387,6 +506,33 @@ void DefaultRobotHWSim::eStopActive(const bool active)
   e_stop_active_ = active;
 }
 
+bool DefaultRobotHWSim::latchCommands(ros::Duration period)
+{
+  enforceLimits(period);
+
+  latched_effort_command_ = joint_effort_command_;
+  latched_position_command_ = joint_position_command_;
+  latched_velocity_command_ = joint_velocity_command_;
+  latched_commands_ = true;
+  return true;
+}
+
+void DefaultRobotHWSim::enforceLimits(ros::Duration period)
+{
+  for (std::size_t i = 0; i < ej_sat_handles_.size(); ++i)
+    ej_sat_handles_[i].enforceLimits(period);
+  for (std::size_t i = 0; i < ej_limits_handles_.size(); ++i)
+    ej_limits_handles_[i].enforceLimits(period);
+  for (std::size_t i = 0; i < pj_sat_handles_.size(); ++i)
+    pj_sat_handles_[i].enforceLimits(period);
+  for (std::size_t i = 0; i < pj_limits_handles_.size(); ++i)
+    pj_limits_handles_[i].enforceLimits(period);
+  for (std::size_t i = 0; i < vj_sat_handles_.size(); ++i)
+    vj_sat_handles_[i].enforceLimits(period);
+  for (std::size_t i = 0; i < vj_limits_handles_.size(); ++i)
+    vj_limits_handles_[i].enforceLimits(period);
+}
+
 // Register the limits of the joint specified by joint_name and joint_handle. The limits are
 // retrieved from joint_limit_nh. If urdf_model is not NULL, limits are retrieved from it also.
 // Return the joint's type, lower position limit, upper position limit, and effort limit.
@@ -462,6 +608,7 @@ void DefaultRobotHWSim::registerJointLimits(const std::string& joint_name,
           const joint_limits_interface::EffortJointSoftLimitsHandle
             limits_handle(joint_handle, limits, soft_limits);
           ej_limits_interface_.registerHandle(limits_handle);
+          ej_limits_handles_.push_back(limits_handle);
         }
         break;
       case POSITION:
@@ -469,6 +616,7 @@ void DefaultRobotHWSim::registerJointLimits(const std::string& joint_name,
           const joint_limits_interface::PositionJointSoftLimitsHandle
             limits_handle(joint_handle, limits, soft_limits);
           pj_limits_interface_.registerHandle(limits_handle);
+          pj_limits_handles_.push_back(limits_handle);
         }
         break;
       case VELOCITY:
@@ -476,6 +624,7 @@ void DefaultRobotHWSim::registerJointLimits(const std::string& joint_name,
           const joint_limits_interface::VelocityJointSoftLimitsHandle
             limits_handle(joint_handle, limits, soft_limits);
           vj_limits_interface_.registerHandle(limits_handle);
+          vj_limits_handles_.push_back(limits_handle);
         }
         break;
     }
@@ -489,6 +638,7 @@ void DefaultRobotHWSim::registerJointLimits(const std::string& joint_name,
           const joint_limits_interface::EffortJointSaturationHandle
             sat_handle(joint_handle, limits);
           ej_sat_interface_.registerHandle(sat_handle);
+          ej_sat_handles_.push_back(sat_handle);
         }
         break;
       case POSITION:
@@ -496,6 +646,7 @@ void DefaultRobotHWSim::registerJointLimits(const std::string& joint_name,
           const joint_limits_interface::PositionJointSaturationHandle
             sat_handle(joint_handle, limits);
           pj_sat_interface_.registerHandle(sat_handle);
+          pj_sat_handles_.push_back(sat_handle);
         }
         break;
       case VELOCITY:
@@ -503,6 +654,7 @@ void DefaultRobotHWSim::registerJointLimits(const std::string& joint_name,
           const joint_limits_interface::VelocityJointSaturationHandle
             sat_handle(joint_handle, limits);
           vj_sat_interface_.registerHandle(sat_handle);
+          vj_sat_handles_.push_back(sat_handle);
         }
         break;
     }
@@ -0,0 +1,103 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Open Source Robotics Foundation
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the Open Source Robotics Foundation
+ *     nor the names of its contributors may be
+ *     used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   World plugin that runs the controller updates of all gazebo_ros_control plugins in
+           the world on a shared thread pool
+*/
+
+// Boost
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+
+#include <gazebo_ros_control/gazebo_ros_control_host_plugin.h>
+#include <gazebo_ros_control/controller_host.h>
+#include <ros/ros.h>
+
+namespace gazebo_ros_control
+{
+
+GazeboRosControlHostPlugin::~GazeboRosControlHostPlugin()
+{
+  // Disconnect from gazebo events
+  update_connection_.reset();
+
+  ControllerHost::instance().stop();
+}
+
+// Overloaded Gazebo entry point
+void GazeboRosControlHostPlugin::Load(gazebo::physics::WorldPtr world, sdf::ElementPtr sdf)
+{
+  // Writing the joints of different robots concurrently relies on the physics engine
+  // tolerating it, which Gazebo does not document, so the cycles run one after the other on
+  // the physics thread unless asked otherwise
+  bool parallel = false;
+  if (sdf->HasElement("parallelUpdates"))
+    parallel = sdf->Get<bool>("parallelUpdates");
+
+  unsigned int threads = 0;
+  if (parallel)
+  {
+    threads = boost::thread::hardware_concurrency();
+    threads = threads > 0 ? threads - 1 : 0;
+    if (sdf->HasElement("threads"))
+    {
+      const int sdf_threads = sdf->Get<int>("threads");
+      threads = sdf_threads > 0 ? sdf_threads : 0;
+    }
+  }
+
+  ControllerHost::instance().start(threads);
+  if (parallel)
+    ROS_INFO_STREAM_NAMED("gazebo_ros_control", "Started the shared controller host with "
+      << threads << " worker threads");
+  else
+    ROS_INFO_STREAM_NAMED("gazebo_ros_control", "Started the shared controller host, "
+      "updating the robots one after the other");
+
+  // Listen to the update event. This event is broadcast every simulation iteration.
+  update_connection_ =
+    gazebo::event::Events::ConnectWorldUpdateBegin
+    (boost::bind(&GazeboRosControlHostPlugin::Update, this));
+}
+
+// Called by the world update start event
+void GazeboRosControlHostPlugin::Update()
+{
+  ControllerHost::instance().update();
+}
+
+// Register this plugin with the simulator
+GZ_REGISTER_WORLD_PLUGIN(GazeboRosControlHostPlugin);
+} // namespace
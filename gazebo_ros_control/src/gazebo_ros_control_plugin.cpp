@@ -43,17 +43,47 @@
 #include <boost/bind.hpp>
 
 #include <gazebo_ros_control/gazebo_ros_control_plugin.h>
+#include <gazebo_ros_control/controller_host.h>
+#include <gazebo_ros/subscription_hints.h>
+#include <gazebo_ros/thread_policy.h>
 #include <urdf/model.h>
 #include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <map>
+#include <sstream>
 #include <thread>
+#ifndef _WIN32
+#include <pthread.h>
+#endif
 
 namespace gazebo_ros_control
 {
 
+GazeboRosControlPlugin::ControlGroup::ControlGroup()
+  : last_e_stop_active(false), async_update(false), controller_busy(false),
+    controller_shutdown(false), controller_reset(false), skipped_updates(0),
+    read_timing(NULL), update_timing(NULL), write_timing(NULL), jitter_timing(NULL), overruns(0)
+{
+}
+
+GazeboRosControlPlugin::GazeboRosControlPlugin()
+  : shared_host_(false), host_update_id_(0), async_update_(false), deterministic_update_(true),
+    controller_thread_priority_(0), e_stop_active_(false)
+{
+}
+
 GazeboRosControlPlugin::~GazeboRosControlPlugin()
 {
   // Disconnect from gazebo events
   update_connection_.reset();
+  if (shared_host_)
+    ControllerHost::instance().remove(host_update_id_);
+
+  // Stop the controller threads
+  for (size_t i = 0; i < control_groups_.size(); ++i)
+    stopControllerThread(*control_groups_[i]);
 }
 
 // Overloaded Gazebo entry point
@@ -146,18 +176,38 @@ void GazeboRosControlPlugin::Load(gazebo::physics::ModelPtr parent, sdf::Element
       << control_period_);
   }
 
+  // Decide whether the controllers are updated on their own thread
+  if (sdf_->HasElement("asyncControllerUpdate"))
+    async_update_ = sdf_->Get<bool>("asyncControllerUpdate");
+  if (sdf_->HasElement("deterministicControllerUpdate"))
+    deterministic_update_ = sdf_->Get<bool>("deterministicControllerUpdate");
+  if (sdf_->HasElement("controllerThreadPriority"))
+    controller_thread_priority_ = sdf_->Get<int>("controllerThreadPriority");
+
+  // Decide how often the timing diagnostics are published
+  diagnostics_period_ = ros::Duration(1.0);
+  if (sdf_->HasElement("diagnosticsPeriod"))
+    diagnostics_period_ = ros::Duration(sdf_->Get<double>("diagnosticsPeriod"));
+
   // Get parameters/settings for controllers from ROS param server
   model_nh_ = ros::NodeHandle(robot_namespace_);
 
   // Initialize the emergency stop code.
   e_stop_active_ = false;
-  last_e_stop_active_ = false;
   if (sdf_->HasElement("eStopTopic"))
   {
     const std::string e_stop_topic = sdf_->GetElement("eStopTopic")->Get<std::string>();
-    e_stop_sub_ = model_nh_.subscribe(e_stop_topic, 1, &GazeboRosControlPlugin::eStopCB, this);
+    ros::SubscribeOptions so = ros::SubscribeOptions::create<std_msgs::Bool>(
+      e_stop_topic, 1, boost::bind(&GazeboRosControlPlugin::eStopCB, this, _1), ros::VoidPtr(), NULL);
+    gazebo::SubscriptionHints hints;
+    hints.readParam(model_nh_);
+    hints.apply(so);
+    e_stop_sub_ = model_nh_.subscribe(so);
   }
 
+  if (diagnostics_period_ > ros::Duration(0))
+    diagnostics_pub_ = model_nh_.advertise<diagnostic_msgs::DiagnosticArray>("/diagnostics", 1);
+
   ROS_INFO_NAMED("gazebo_ros_control", "Starting gazebo_ros_control plugin in namespace: %s", robot_namespace_.c_str());
 
   // Read urdf from ros parameter server then
@@ -170,6 +220,62 @@ void GazeboRosControlPlugin::Load(gazebo::physics::ModelPtr parent, sdf::Element
     return;
   }
 
+  // Create the default group, then one group per <controlGroup>. Each transmission belongs to
+  // the group that lists its joint, or to the default group.
+  ControlGroupPtr default_group(new ControlGroup);
+  default_group->nh = model_nh_;
+  default_group->control_period = control_period_;
+  control_groups_.push_back(default_group);
+
+  std::map<std::string, ControlGroupPtr> joint_groups;
+  sdf::ElementPtr group_elem = sdf_->HasElement("controlGroup") ? sdf_->GetElement("controlGroup")
+                                                                 : sdf::ElementPtr();
+  while (group_elem)
+  {
+    ControlGroupPtr group(new ControlGroup);
+    if (group_elem->HasElement("name"))
+      group->name = group_elem->Get<std::string>("name");
+    if (group->name.empty())
+    {
+      ROS_ERROR_NAMED("gazebo_ros_control", "A <controlGroup> has no <name>, ignoring it.");
+      group_elem = group_elem->GetNextElement("controlGroup");
+      continue;
+    }
+    group->nh = ros::NodeHandle(model_nh_, group->name);
+    group->control_period = group_elem->HasElement("controlPeriod")
+      ? ros::Duration(group_elem->Get<double>("controlPeriod")) : control_period_;
+    if (group->control_period < gazebo_period)
+    {
+      ROS_ERROR_STREAM_NAMED("gazebo_ros_control","Desired controller update period of group '"
+        << group->name << "' (" << group->control_period << " s) is faster than the gazebo "
+        << "simulation period (" << gazebo_period << " s).");
+    }
+
+    sdf::ElementPtr joint_elem = group_elem->HasElement("joint") ? group_elem->GetElement("joint")
+                                                                 : sdf::ElementPtr();
+    while (joint_elem)
+    {
+      joint_groups[joint_elem->Get<std::string>()] = group;
+      joint_elem = joint_elem->GetNextElement("joint");
+    }
+    control_groups_.push_back(group);
+
+    group_elem = group_elem->GetNextElement("controlGroup");
+  }
+
+  for (size_t i = 0; i < transmissions_.size(); ++i)
+  {
+    ControlGroupPtr group = default_group;
+    if (!transmissions_[i].joints_.empty())
+    {
+      std::map<std::string, ControlGroupPtr>::const_iterator it =
+        joint_groups.find(transmissions_[i].joints_[0].name_);
+      if (it != joint_groups.end())
+        group = it->second;
+    }
+    group->transmissions.push_back(transmissions_[i]);
+  }
+
   // Load the RobotHWSim abstraction to interface the controllers with the gazebo model
   try
   {
@@ -178,25 +284,33 @@ void GazeboRosControlPlugin::Load(gazebo::physics::ModelPtr parent, sdf::Element
         ("gazebo_ros_control",
           "gazebo_ros_control::RobotHWSim"));
 
-    robot_hw_sim_ = robot_hw_sim_loader_->createInstance(robot_hw_sim_type_str_);
     urdf::Model urdf_model;
     const urdf::Model *const urdf_model_ptr = urdf_model.initString(urdf_string) ? &urdf_model : NULL;
 
-    if(!robot_hw_sim_->initSim(robot_ns, model_nh_, parent_model_, urdf_model_ptr, transmissions_))
+    for (size_t i = 0; i < control_groups_.size(); ++i)
     {
-      ROS_FATAL_NAMED("gazebo_ros_control","Could not initialize robot simulation interface");
-      return;
+      if (!loadControlGroup(*control_groups_[i], robot_ns, urdf_model_ptr))
+        return;
+    }
+    robot_hw_sim_ = default_group->robot_hw_sim;
+    controller_manager_ = default_group->controller_manager;
+
+    // Run the update cycle on the shared controller host if the world has one, otherwise
+    // listen to the update event. This event is broadcast every simulation iteration.
+    const bool use_shared_host = sdf_->HasElement("sharedControllerHost") ?
+      sdf_->Get<bool>("sharedControllerHost") : true;
+    if (use_shared_host && ControllerHost::instance().running())
+    {
+      ROS_INFO_NAMED("gazebo_ros_control", "Updating controllers on the shared controller host");
+      host_update_id_ = ControllerHost::instance().add(boost::bind(&GazeboRosControlPlugin::Update, this));
+      shared_host_ = true;
+    }
+    else
+    {
+      update_connection_ =
+        gazebo::event::Events::ConnectWorldUpdateBegin
+        (boost::bind(&GazeboRosControlPlugin::Update, this));
     }
-
-    // Create the controller manager
-    ROS_DEBUG_STREAM_NAMED("ros_control_plugin","Loading controller_manager");
-    controller_manager_.reset
-      (new controller_manager::ControllerManager(robot_hw_sim_.get(), model_nh_));
-
-    // Listen to the update event. This event is broadcast every simulation iteration.
-    update_connection_ =
-      gazebo::event::Events::ConnectWorldUpdateBegin
-      (boost::bind(&GazeboRosControlPlugin::Update, this));
 
   }
   catch(pluginlib::LibraryLoadException &ex)
@@ -207,6 +321,46 @@ void GazeboRosControlPlugin::Load(gazebo::physics::ModelPtr parent, sdf::Element
   ROS_INFO_NAMED("gazebo_ros_control", "Loaded gazebo_ros_control.");
 }
 
+// Create the robot simulation interface and controller manager of a group
+bool GazeboRosControlPlugin::loadControlGroup(ControlGroup& group, const std::string& robot_ns,
+                                              const urdf::Model *const urdf_model)
+{
+  if (!group.name.empty())
+  {
+    ROS_INFO_STREAM_NAMED("gazebo_ros_control", "Loading control group '" << group.name << "' with "
+      << group.transmissions.size() << " transmissions and a period of " << group.control_period << " s");
+  }
+
+  gazebo::TimingRegistry& registry = gazebo::TimingRegistry::instance();
+  group.timing_name = group.name.empty() ? robot_namespace_ : robot_namespace_ + "/" + group.name;
+  group.read_timing = registry.stage("gazebo_ros_control", group.timing_name + " read");
+  group.update_timing = registry.stage("gazebo_ros_control", group.timing_name + " update");
+  group.write_timing = registry.stage("gazebo_ros_control", group.timing_name + " write");
+  group.jitter_timing = registry.stage("gazebo_ros_control", group.timing_name + " period jitter");
+
+  group.robot_hw_sim = robot_hw_sim_loader_->createInstance(robot_hw_sim_type_str_);
+  if(!group.robot_hw_sim->initSim(robot_ns, model_nh_, parent_model_, urdf_model, group.transmissions))
+  {
+    ROS_FATAL_NAMED("gazebo_ros_control","Could not initialize robot simulation interface");
+    return false;
+  }
+
+  // Create the controller manager
+  ROS_DEBUG_STREAM_NAMED("ros_control_plugin","Loading controller_manager");
+  group.controller_manager.reset
+    (new controller_manager::ControllerManager(group.robot_hw_sim.get(), group.nh));
+
+  group.async_update = async_update_;
+  if (group.async_update)
+  {
+    ROS_INFO_STREAM_NAMED("gazebo_ros_control", "Updating controllers asynchronously"
+      << (deterministic_update_ ? " in deterministic mode" : ""));
+    group.controller_thread = boost::thread(
+      boost::bind(&GazeboRosControlPlugin::controllerThread, this, &group));
+  }
+  return true;
+}
+
 // Called by the world update start event
 void GazeboRosControlPlugin::Update()
 {
@@ -217,52 +371,178 @@ void GazeboRosControlPlugin::Update()
   gazebo::common::Time gz_time_now = parent_model_->GetWorld()->GetSimTime();
 #endif
   ros::Time sim_time_ros(gz_time_now.sec, gz_time_now.nsec);
-  ros::Duration sim_period = sim_time_ros - last_update_sim_time_ros_;
 
-  robot_hw_sim_->eStopActive(e_stop_active_);
+  for (size_t i = 0; i < control_groups_.size(); ++i)
+    updateControlGroup(*control_groups_[i], sim_time_ros);
+
+  publishDiagnostics(sim_time_ros);
+}
+
+// Run the read/update/write cycle of a group for the current simulation step
+void GazeboRosControlPlugin::updateControlGroup(ControlGroup& group, const ros::Time& sim_time_ros)
+{
+  ros::Duration sim_period = sim_time_ros - group.last_update_sim_time_ros;
+
+  group.robot_hw_sim->eStopActive(e_stop_active_);
+
+  // Check if we should update the controllers. In non-deterministic asynchronous mode, a control
+  // period is skipped if the controllers are still busy with the previous one.
+  const bool controllers_ready = !group.async_update || deterministic_update_ || !group.controller_busy;
+  if(sim_period >= group.control_period && !controllers_ready)
+  {
+    ++group.skipped_updates;
+    ROS_WARN_STREAM_THROTTLE_NAMED(1.0, "gazebo_ros_control", "Controller update overran the control "
+      "period, " << group.skipped_updates << " control periods skipped so far.");
+  }
+  else if(sim_period >= group.control_period) {
+    // Apply the commands of the previous asynchronous update before reading the new state
+    if (group.async_update)
+    {
+      waitForControllerUpdate(group);
+      if (!group.robot_hw_sim->latchCommands(sim_period))
+      {
+        ROS_WARN_STREAM_NAMED("gazebo_ros_control", "The robot simulation interface "
+          << robot_hw_sim_type_str_ << " does not support asynchronous controller updates, "
+          << "updating controllers synchronously.");
+        group.async_update = false;
+      }
+    }
 
-  // Check if we should update the controllers
-  if(sim_period >= control_period_) {
     // Store this simulation time
-    last_update_sim_time_ros_ = sim_time_ros;
+    if (!group.last_update_sim_time_ros.isZero())
+      group.jitter_timing->record(std::llabs((sim_period - group.control_period).toNSec()));
+    group.last_update_sim_time_ros = sim_time_ros;
 
     // Update the robot simulation with the state of the gazebo model
-    robot_hw_sim_->readSim(sim_time_ros, sim_period);
+    {
+      gazebo::ScopedTiming timing(group.read_timing);
+      group.robot_hw_sim->readSim(sim_time_ros, sim_period);
+    }
 
     // Compute the controller commands
     bool reset_ctrlrs;
     if (e_stop_active_)
     {
       reset_ctrlrs = false;
-      last_e_stop_active_ = true;
+      group.last_e_stop_active = true;
     }
     else
     {
-      if (last_e_stop_active_)
+      if (group.last_e_stop_active)
       {
         reset_ctrlrs = true;
-        last_e_stop_active_ = false;
+        group.last_e_stop_active = false;
       }
       else
       {
         reset_ctrlrs = false;
       }
     }
-    controller_manager_->update(sim_time_ros, sim_period, reset_ctrlrs);
+    if (group.async_update)
+      startControllerUpdate(group, sim_time_ros, sim_period, reset_ctrlrs);
+    else
+      runControllerUpdate(group, sim_time_ros, sim_period, reset_ctrlrs);
   }
 
   // Update the gazebo model with the result of the controller
   // computation
-  robot_hw_sim_->writeSim(sim_time_ros, sim_time_ros - last_write_sim_time_ros_);
-  last_write_sim_time_ros_ = sim_time_ros;
+  {
+    gazebo::ScopedTiming timing(group.write_timing);
+    group.robot_hw_sim->writeSim(sim_time_ros, sim_time_ros - group.last_write_sim_time_ros);
+  }
+  group.last_write_sim_time_ros = sim_time_ros;
+}
+
+// Run and time the controller update of a group
+void GazeboRosControlPlugin::runControllerUpdate(ControlGroup& group, const ros::Time& time,
+                                                 const ros::Duration& period, bool reset)
+{
+  const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  group.controller_manager->update(time, period, reset);
+  const int64_t nsec = std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now() - start).count();
+
+  group.update_timing->record(nsec);
+  if (nsec > group.control_period.toNSec())
+    ++group.overruns;
+}
+
+// Publish the timing of all groups on /diagnostics
+void GazeboRosControlPlugin::publishDiagnostics(const ros::Time& sim_time_ros)
+{
+  if (!diagnostics_pub_ || sim_time_ros - last_diagnostics_time_ < diagnostics_period_)
+    return;
+  last_diagnostics_time_ = sim_time_ros;
+  if (diagnostics_pub_.getNumSubscribers() == 0)
+    return;
+
+  diagnostic_msgs::DiagnosticArrayPtr msg(new diagnostic_msgs::DiagnosticArray);
+  msg->header.stamp = ros::Time::now();
+  for (size_t i = 0; i < control_groups_.size(); ++i)
+  {
+    const ControlGroup& group = *control_groups_[i];
+    diagnostic_msgs::DiagnosticStatus status;
+    status.name = "gazebo_ros_control: " + group.timing_name;
+    status.hardware_id = robot_namespace_;
+
+    const uint64_t overruns = group.overruns;
+    status.level = overruns > 0 || group.skipped_updates > 0 ? diagnostic_msgs::DiagnosticStatus::WARN
+                                                              : diagnostic_msgs::DiagnosticStatus::OK;
+    status.message = status.level == diagnostic_msgs::DiagnosticStatus::OK ? "OK"
+                                                                           : "Controller update overruns";
+
+    const gazebo::TimingStage *const stages[] =
+      {group.read_timing, group.update_timing, group.write_timing, group.jitter_timing};
+    const char *const names[] = {"read", "update", "write", "period jitter"};
+    for (size_t s = 0; s < sizeof(stages) / sizeof(stages[0]); ++s)
+    {
+      const uint64_t count = stages[s]->count;
+      const double mean_us = count > 0 ? stages[s]->total_nsec / (count * 1e3) : 0.0;
+      std::ostringstream mean, max;
+      mean << std::fixed << std::setprecision(1) << mean_us;
+      max << std::fixed << std::setprecision(1) << stages[s]->max_nsec / 1e3;
+
+      diagnostic_msgs::KeyValue value;
+      value.key = std::string(names[s]) + " mean (us)";
+      value.value = mean.str();
+      status.values.push_back(value);
+      value.key = std::string(names[s]) + " max (us)";
+      value.value = max.str();
+      status.values.push_back(value);
+    }
+
+    diagnostic_msgs::KeyValue value;
+    value.key = "control period (s)";
+    value.value = std::to_string(group.control_period.toSec());
+    status.values.push_back(value);
+    value.key = "overruns";
+    value.value = std::to_string(overruns);
+    status.values.push_back(value);
+    value.key = "skipped control periods";
+    value.value = std::to_string(group.skipped_updates);
+    status.values.push_back(value);
+
+    msg->status.push_back(status);
+  }
+  diagnostics_pub_.publish(msg);
 }
 
 // Called on world reset
 void GazeboRosControlPlugin::Reset()
 {
-  // Reset timing variables to not pass negative update periods to controllers on world reset
-  last_update_sim_time_ros_ = ros::Time();
-  last_write_sim_time_ros_ = ros::Time();
+  for (size_t i = 0; i < control_groups_.size(); ++i)
+  {
+    ControlGroup& group = *control_groups_[i];
+
+    // Do not let an update computed before the reset be applied after it
+    if (group.async_update)
+      waitForControllerUpdate(group);
+
+    // Reset timing variables to not pass negative update periods to controllers on world reset
+    group.last_update_sim_time_ros = ros::Time();
+    group.last_write_sim_time_ros = ros::Time();
+  }
+  last_diagnostics_time_ = ros::Time();
 }
 
 // Get the URDF XML from the parameter server
@@ -303,6 +583,87 @@ bool GazeboRosControlPlugin::parseTransmissionsFromURDF(const std::string& urdf_
   return true;
 }
 
+// Hand a controller update to the controller thread of a group
+void GazeboRosControlPlugin::startControllerUpdate(ControlGroup& group, const ros::Time& time,
+                                                   const ros::Duration& period, bool reset)
+{
+  {
+    boost::mutex::scoped_lock lock(group.controller_mutex);
+    group.controller_time = time;
+    group.controller_period = period;
+    group.controller_reset = reset;
+    group.controller_busy = true;
+  }
+  group.controller_cond.notify_all();
+}
+
+// Block until the controller thread of a group has finished the update in progress, if any
+void GazeboRosControlPlugin::waitForControllerUpdate(ControlGroup& group)
+{
+  if (!group.controller_busy)
+    return;
+
+  boost::mutex::scoped_lock lock(group.controller_mutex);
+  while (group.controller_busy && !group.controller_shutdown)
+    group.controller_cond.wait(lock);
+}
+
+// Stop the controller thread of a group, if it has one
+void GazeboRosControlPlugin::stopControllerThread(ControlGroup& group)
+{
+  if (!group.controller_thread.joinable())
+    return;
+
+  {
+    boost::mutex::scoped_lock lock(group.controller_mutex);
+    group.controller_shutdown = true;
+  }
+  group.controller_cond.notify_all();
+  group.controller_thread.join();
+}
+
+// Run controller updates handed over by updateControlGroup(). The robot simulation interface only
+// touches the commands latched by latchCommands() meanwhile, so the controllers need no lock of
+// their own.
+void GazeboRosControlPlugin::controllerThread(ControlGroup* group)
+{
+  gazebo::ThreadPolicy::instance().apply("control", "gzros_control");
+#ifndef _WIN32
+  // set from the thread itself, so the plugin's priority overrides the
+  // priority of the control thread class
+  if (controller_thread_priority_ > 0)
+  {
+    sched_param param;
+    param.sched_priority = controller_thread_priority_;
+    const int ret = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+    if (ret != 0)
+    {
+      ROS_WARN_STREAM_NAMED("gazebo_ros_control", "Could not set the controller thread to realtime "
+        "priority " << controller_thread_priority_ << ": " << strerror(ret));
+    }
+  }
+#endif
+
+  boost::mutex::scoped_lock lock(group->controller_mutex);
+  while (true)
+  {
+    while (!group->controller_busy && !group->controller_shutdown)
+      group->controller_cond.wait(lock);
+    if (group->controller_shutdown)
+      break;
+
+    const ros::Time time = group->controller_time;
+    const ros::Duration period = group->controller_period;
+    const bool reset = group->controller_reset;
+    lock.unlock();
+    runControllerUpdate(*group, time, period, reset);
+    lock.lock();
+
+    group->controller_busy = false;
+    group->controller_cond.notify_all();
+  }
+}
+
 // Emergency stop callback
 void GazeboRosControlPlugin::eStopCB(const std_msgs::BoolConstPtr& e_stop_active)
 {
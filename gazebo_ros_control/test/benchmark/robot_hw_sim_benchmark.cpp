@@ -0,0 +1,460 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Open Source Robotics Foundation
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the Open Source Robotics Foundation
+ *     nor the names of its contributors may be
+ *     used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Throughput and allocations of DefaultRobotHWSim's readSim(), writeSim() and of the
+           whole read/update/write cycle, on synthetic robots of 6 to 300 joints under every
+           control method. Gazebo runs in-process without rendering, no gzserver or gzclient.
+           The PID control methods need their gains on a parameter server, so the benchmark
+           needs a ROS master; the launch file next to this source starts one. Results as JSON:
+             roslaunch robot_hw_sim_benchmark.launch out:=results.json
+*/
+
+#include <gazebo_ros_control/default_robot_hw_sim.h>
+
+#include <controller_interface/controller.h>
+#include <controller_manager/controller_loader_interface.h>
+#include <controller_manager/controller_manager.h>
+#include <gazebo/gazebo.hh>
+#include <gazebo/physics/physics.hh>
+#include <hardware_interface/joint_command_interface.h>
+#include <ros/ros.h>
+#include <sdf/sdf.hh>
+#include <transmission_interface/transmission_parser.h>
+#include <urdf/model.h>
+
+// Boost
+#include <boost/atomic.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+// Allocations of the calling thread, counted by the global operator new below so that ROS's
+// own threads do not show up in the per-cycle numbers.
+static thread_local size_t g_allocations = 0;
+
+void *operator new(size_t size)
+{
+  ++g_allocations;
+  void *p = std::malloc(size ? size : 1);
+  if (!p)
+    throw std::bad_alloc();
+  return p;
+}
+
+void operator delete(void *p) noexcept
+{
+  std::free(p);
+}
+
+namespace
+{
+
+// A control method of DefaultRobotHWSim and how a URDF asks for it
+struct ControlMethod
+{
+  const char *name;
+  const char *hardware_interface;
+  // POSITION_PID and VELOCITY_PID are POSITION and VELOCITY with PID gains on the parameter server
+  bool pid;
+};
+
+const ControlMethod kControlMethods[] = {
+  {"effort", "hardware_interface/EffortJointInterface", false},
+  {"position", "hardware_interface/PositionJointInterface", false},
+  {"position_pid", "hardware_interface/PositionJointInterface", true},
+  {"velocity", "hardware_interface/VelocityJointInterface", false},
+  {"velocity_pid", "hardware_interface/VelocityJointInterface", true},
+};
+
+const int kJointCounts[] = {6, 30, 100, 300};
+
+// Serial chain of n_joints joints, revolute with every third one prismatic and every fifth one
+// continuous, so that all partitions of DefaultRobotHWSim are exercised
+std::string syntheticUrdf(const std::string& name, int n_joints, const ControlMethod& method)
+{
+  std::ostringstream urdf;
+  urdf << "<?xml version=\"1.0\"?>\n<robot name=\"" << name << "\">\n";
+  for (int i = 0; i <= n_joints; ++i)
+  {
+    urdf << "  <link name=\"link_" << i << "\">\n"
+         << "    <inertial><mass value=\"0.1\"/>"
+         << "<inertia ixx=\"0.001\" ixy=\"0\" ixz=\"0\" iyy=\"0.001\" iyz=\"0\" izz=\"0.001\"/>"
+         << "</inertial>\n"
+         << "  </link>\n";
+  }
+  for (int i = 0; i < n_joints; ++i)
+  {
+    const char *type = i % 3 == 2 ? "prismatic" : (i % 5 == 4 ? "continuous" : "revolute");
+    urdf << "  <joint name=\"joint_" << i << "\" type=\"" << type << "\">\n"
+         << "    <parent link=\"link_" << i << "\"/><child link=\"link_" << i + 1 << "\"/>\n"
+         << "    <origin xyz=\"0 0 0.05\"/><axis xyz=\"0 1 0\"/>\n";
+    if (std::string(type) == "prismatic")
+      urdf << "    <limit lower=\"-0.02\" upper=\"0.02\" effort=\"50\" velocity=\"0.5\"/>\n";
+    else
+      urdf << "    <limit lower=\"-1.5\" upper=\"1.5\" effort=\"20\" velocity=\"2\"/>\n";
+    urdf << "  </joint>\n"
+         << "  <transmission name=\"transmission_" << i << "\">\n"
+         << "    <type>transmission_interface/SimpleTransmission</type>\n"
+         << "    <joint name=\"joint_" << i << "\"><hardwareInterface>" << method.hardware_interface
+         << "</hardwareInterface></joint>\n"
+         << "    <actuator name=\"motor_" << i << "\"><mechanicalReduction>1</mechanicalReduction>"
+         << "</actuator>\n"
+         << "  </transmission>\n";
+  }
+  urdf << "</robot>\n";
+  return urdf.str();
+}
+
+// Writes a small sine to every joint command, the cheapest stand-in for a real controller
+template <class Interface>
+class SineController : public controller_interface::Controller<Interface>
+{
+public:
+  bool init(Interface *hw, ros::NodeHandle& /*controller_nh*/)
+  {
+    const std::vector<std::string> names = hw->getNames();
+    for (size_t i = 0; i < names.size(); ++i)
+      joints_.push_back(hw->getHandle(names[i]));
+    return true;
+  }
+
+  void update(const ros::Time& time, const ros::Duration& /*period*/)
+  {
+    const double command = 0.1 * std::sin(time.toSec());
+    for (size_t i = 0; i < joints_.size(); ++i)
+      joints_[i].setCommand(command);
+  }
+
+private:
+  std::vector<hardware_interface::JointHandle> joints_;
+};
+
+// Hands the controller manager the controllers above without going through pluginlib
+class SineControllerLoader : public controller_manager::ControllerLoaderInterface
+{
+public:
+  SineControllerLoader() : controller_manager::ControllerLoaderInterface("sine_controller_loader") {}
+
+  controller_interface::ControllerBaseSharedPtr createInstance(const std::string& type)
+  {
+    if (type == "benchmark/EffortSineController")
+      return controller_interface::ControllerBaseSharedPtr(
+        new SineController<hardware_interface::EffortJointInterface>());
+    if (type == "benchmark/PositionSineController")
+      return controller_interface::ControllerBaseSharedPtr(
+        new SineController<hardware_interface::PositionJointInterface>());
+    if (type == "benchmark/VelocitySineController")
+      return controller_interface::ControllerBaseSharedPtr(
+        new SineController<hardware_interface::VelocityJointInterface>());
+    return controller_interface::ControllerBaseSharedPtr();
+  }
+
+  std::vector<std::string> getDeclaredClasses()
+  {
+    std::vector<std::string> types;
+    types.push_back("benchmark/EffortSineController");
+    types.push_back("benchmark/PositionSineController");
+    types.push_back("benchmark/VelocitySineController");
+    return types;
+  }
+
+  void reload() {}
+};
+
+// A synthetic robot in the benchmark world with its hardware interface and controller manager
+struct Rig
+{
+  boost::shared_ptr<gazebo_ros_control::DefaultRobotHWSim> robot_hw_sim;
+  boost::shared_ptr<controller_manager::ControllerManager> controller_manager;
+  ros::Time time;
+  ros::Duration period;
+  std::string error;
+};
+
+gazebo::physics::WorldPtr g_world;
+std::map<std::string, boost::shared_ptr<Rig> > g_rigs;
+int g_models = 0;
+
+// The world the robots are spawned into: no gravity, so the chains stay put between cycles
+bool loadWorld()
+{
+  char path[] = "/tmp/robot_hw_sim_benchmark_XXXXXX";
+  const int fd = mkstemp(path);
+  if (fd < 0)
+    return false;
+  const std::string world =
+    "<?xml version=\"1.0\"?>\n<sdf version=\"1.6\"><world name=\"benchmark\">"
+    "<gravity>0 0 0</gravity><physics type=\"ode\"><max_step_size>0.001</max_step_size></physics>"
+    "</world></sdf>\n";
+  const bool written = write(fd, world.data(), world.size()) == static_cast<ssize_t>(world.size());
+  close(fd);
+  if (written && gazebo::setupServer())
+    g_world = gazebo::loadWorld(path);
+  unlink(path);
+  return static_cast<bool>(g_world);
+}
+
+gazebo::physics::ModelPtr modelByName(const std::string& name)
+{
+#if GAZEBO_MAJOR_VERSION >= 8
+  return g_world->ModelByName(name);
+#else
+  return g_world->GetModel(name);
+#endif
+}
+
+// Spawn a robot into the world and set up DefaultRobotHWSim and a controller manager for it, the
+// way GazeboRosControlPlugin does
+void createRig(Rig& rig, const ControlMethod& method, int n_joints)
+{
+  std::ostringstream name;
+  name << "robot_" << method.name << "_" << n_joints;
+  const std::string robot_namespace = "robot_hw_sim_benchmark/" + name.str();
+  const std::string urdf_string = syntheticUrdf(name.str(), n_joints, method);
+
+  urdf::Model urdf_model;
+  std::vector<transmission_interface::TransmissionInfo> transmissions;
+  if (!urdf_model.initString(urdf_string) ||
+      !transmission_interface::TransmissionParser::parse(urdf_string, transmissions))
+  {
+    rig.error = "synthetic URDF does not parse";
+    return;
+  }
+
+  sdf::SDFPtr sdf(new sdf::SDF());
+  sdf::init(sdf);
+  if (!sdf::readString(urdf_string, sdf))
+  {
+    rig.error = "synthetic URDF does not convert to SDF";
+    return;
+  }
+  // side by side, well apart
+  sdf->Root()->GetElement("model")->GetElement("pose")->Set(
+    ignition::math::Pose3d(2.0 * g_models++, 0, 0, 0, 0, 0));
+  g_world->InsertModelSDF(*sdf);
+  gazebo::physics::ModelPtr model;
+  for (int i = 0; i < 100 && !model; ++i)
+  {
+    gazebo::runWorld(g_world, 1);
+    model = modelByName(name.str());
+  }
+  if (!model)
+  {
+    rig.error = "synthetic robot was not spawned";
+    return;
+  }
+
+  ros::NodeHandle model_nh(robot_namespace);
+  for (int i = 0; method.pid && i < n_joints; ++i)
+  {
+    std::ostringstream gains;
+    gains << "gazebo_ros_control/pid_gains/joint_" << i;
+    model_nh.setParam(gains.str() + "/p", 100.0);
+    model_nh.setParam(gains.str() + "/i", 0.01);
+    model_nh.setParam(gains.str() + "/d", 1.0);
+  }
+
+  rig.robot_hw_sim.reset(new gazebo_ros_control::DefaultRobotHWSim());
+  if (!rig.robot_hw_sim->initSim(robot_namespace, model_nh, model, &urdf_model, transmissions))
+  {
+    rig.error = "initSim failed";
+    return;
+  }
+
+  rig.controller_manager.reset(
+    new controller_manager::ControllerManager(rig.robot_hw_sim.get(), model_nh));
+  rig.controller_manager->registerControllerLoader(
+    controller_manager::ControllerLoaderInterfaceSharedPtr(new SineControllerLoader()));
+  const std::string hardware_interface = method.hardware_interface;
+  std::string type = "benchmark/EffortSineController";
+  if (hardware_interface.find("Position") != std::string::npos)
+    type = "benchmark/PositionSineController";
+  else if (hardware_interface.find("Velocity") != std::string::npos)
+    type = "benchmark/VelocitySineController";
+  model_nh.setParam("sine_controller/type", type);
+  if (!rig.controller_manager->loadController("sine_controller"))
+  {
+    rig.error = "sine controller did not load";
+    return;
+  }
+
+  // switchController() waits for the switch to happen in update()
+  rig.period = ros::Duration(0.001);
+  boost::atomic<bool> switched(false);
+  boost::thread updater([&rig, &switched]()
+  {
+    while (!switched)
+    {
+      rig.controller_manager->update(rig.time, rig.period);
+      boost::this_thread::sleep_for(boost::chrono::milliseconds(1));
+    }
+  });
+  const std::vector<std::string> start(1, "sine_controller");
+  const bool started = rig.controller_manager->switchController(
+    start, std::vector<std::string>(), controller_manager_msgs::SwitchController::Request::STRICT);
+  switched = true;
+  updater.join();
+  if (!started)
+    rig.error = "sine controller did not start";
+}
+
+Rig& rigFor(const ControlMethod& method, int n_joints)
+{
+  std::ostringstream key;
+  key << method.name << "/" << n_joints;
+  boost::shared_ptr<Rig>& rig = g_rigs[key.str()];
+  if (!rig)
+  {
+    rig.reset(new Rig());
+    createRig(*rig, method, n_joints);
+  }
+  return *rig;
+}
+
+// The per-iteration counters every benchmark reports
+void reportCycles(benchmark::State& state, int n_joints, size_t allocations)
+{
+  state.SetItemsProcessed(state.iterations() * n_joints);
+  state.counters["allocs_per_cycle"] =
+    benchmark::Counter(static_cast<double>(allocations), benchmark::Counter::kAvgIterations);
+}
+
+void BM_ReadSim(benchmark::State& state, const ControlMethod *method, int n_joints)
+{
+  Rig& rig = rigFor(*method, n_joints);
+  if (!rig.error.empty())
+  {
+    state.SkipWithError(rig.error.c_str());
+    return;
+  }
+  const size_t allocations = g_allocations;
+  for (auto _ : state)
+  {
+    rig.time += rig.period;
+    rig.robot_hw_sim->readSim(rig.time, rig.period);
+  }
+  reportCycles(state, n_joints, g_allocations - allocations);
+}
+
+void BM_WriteSim(benchmark::State& state, const ControlMethod *method, int n_joints)
+{
+  Rig& rig = rigFor(*method, n_joints);
+  if (!rig.error.empty())
+  {
+    state.SkipWithError(rig.error.c_str());
+    return;
+  }
+  const size_t allocations = g_allocations;
+  for (auto _ : state)
+  {
+    rig.time += rig.period;
+    rig.robot_hw_sim->writeSim(rig.time, rig.period);
+  }
+  reportCycles(state, n_joints, g_allocations - allocations);
+}
+
+// One control period of GazeboRosControlPlugin with synchronous controller updates
+void BM_Update(benchmark::State& state, const ControlMethod *method, int n_joints)
+{
+  Rig& rig = rigFor(*method, n_joints);
+  if (!rig.error.empty())
+  {
+    state.SkipWithError(rig.error.c_str());
+    return;
+  }
+  const size_t allocations = g_allocations;
+  for (auto _ : state)
+  {
+    rig.time += rig.period;
+    rig.robot_hw_sim->readSim(rig.time, rig.period);
+    rig.controller_manager->update(rig.time, rig.period);
+    rig.robot_hw_sim->writeSim(rig.time, rig.period);
+  }
+  reportCycles(state, n_joints, g_allocations - allocations);
+}
+
+}  // namespace
+
+int main(int argc, char **argv)
+{
+  ros::init(argc, argv, "robot_hw_sim_benchmark", ros::init_options::NoSigintHandler);
+  benchmark::Initialize(&argc, argv);
+  if (!ros::master::check())
+  {
+    std::fprintf(stderr, "robot_hw_sim_benchmark needs a ROS master for the PID gains, "
+                 "run it with robot_hw_sim_benchmark.launch\n");
+    return 1;
+  }
+  if (!loadWorld())
+  {
+    std::fprintf(stderr, "robot_hw_sim_benchmark could not load its Gazebo world\n");
+    return 1;
+  }
+
+  const size_t n_methods = sizeof(kControlMethods) / sizeof(kControlMethods[0]);
+  const size_t n_counts = sizeof(kJointCounts) / sizeof(kJointCounts[0]);
+  for (size_t m = 0; m < n_methods; ++m)
+  {
+    for (size_t c = 0; c < n_counts; ++c)
+    {
+      std::ostringstream suffix;
+      suffix << "/" << kControlMethods[m].name << "/" << kJointCounts[c];
+      benchmark::RegisterBenchmark(("BM_ReadSim" + suffix.str()).c_str(), BM_ReadSim,
+                                   &kControlMethods[m], kJointCounts[c]);
+      benchmark::RegisterBenchmark(("BM_WriteSim" + suffix.str()).c_str(), BM_WriteSim,
+                                   &kControlMethods[m], kJointCounts[c]);
+      benchmark::RegisterBenchmark(("BM_Update" + suffix.str()).c_str(), BM_Update,
+                                   &kControlMethods[m], kJointCounts[c]);
+    }
+  }
+  benchmark::RunSpecifiedBenchmarks();
+
+  g_rigs.clear();
+  g_world.reset();
+  gazebo::shutdown();
+  return 0;
+}